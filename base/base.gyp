@@ -438,6 +438,7 @@
         'ios/crb_protocol_observers_unittest.mm',
         'ios/device_util_unittest.mm',
         'ios/weak_nsobject_unittest.mm',
+        'json/json_document_unittest.cc',
         'json/json_parser_unittest.cc',
         'json/json_reader_unittest.cc',
         'json/json_value_converter_unittest.cc',
@@ -474,6 +475,7 @@
         'memory/singleton_unittest.cc',
         'memory/weak_ptr_unittest.cc',
         'memory/weak_ptr_unittest.nc',
+        'message_loop/lock_free_task_queue_unittest.cc',
         'message_loop/message_loop_task_runner_unittest.cc',
         'message_loop/message_loop_unittest.cc',
         'message_loop/message_pump_glib_unittest.cc',
@@ -798,7 +800,9 @@
         '../testing/gtest.gyp:gtest',
       ],
       'sources': [
+        'json/json_perftest.cc',
         'message_loop/message_pump_perftest.cc',
+        'task_scheduler/scheduler_worker_pool_impl_perftest.cc',
         'test/run_all_unittests.cc',
         'threading/thread_perftest.cc',
         '../testing/perf/perf_test.cc'
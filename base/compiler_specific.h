@@ -100,6 +100,17 @@
 #define NOINLINE
 #endif
 
+// Annotate a function indicating it should always be inlined.
+// Use like:
+//   ALWAYS_INLINE void DoStuff() { ... }
+#if defined(COMPILER_GCC) && defined(NDEBUG)
+#define ALWAYS_INLINE inline __attribute__((__always_inline__))
+#elif defined(COMPILER_MSVC) && defined(NDEBUG)
+#define ALWAYS_INLINE __forceinline
+#else
+#define ALWAYS_INLINE inline
+#endif
+
 // Specify memory alignment for structs, classes, etc.
 // Use like:
 //   class ALIGNAS(16) MyClass { ... }
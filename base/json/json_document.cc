@@ -0,0 +1,357 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_document.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "base/json/json_parser.h"
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+
+namespace base {
+
+namespace {
+
+// Allocate() hands out memory from blocks of this size, except for requests
+// too large to share one.
+const size_t kBlockSize = 64 * 1024;
+
+const size_t kAlignment = alignof(JSONDocument::Member);
+
+bool MemberKeyLess(const JSONDocument::Member& a,
+                   const JSONDocument::Member& b) {
+  return a.key < b.key;
+}
+
+}  // namespace
+
+// Builds the nodes of a JSONDocument from the parser's events. The children
+// of the lists and dictionaries being parsed are collected in |pending_|, and
+// moved to a single allocation once the container ends.
+class JSONDocument::Builder : public JSONReader::Handler {
+ public:
+  explicit Builder(JSONDocument* document) : document_(document) {}
+  ~Builder() override {}
+
+  // JSONReader::Handler implementation.
+  void OnNull() override {
+    Node node;
+    node.type_ = Value::TYPE_NULL;
+    node.size_ = 0;
+    AddNode(node);
+  }
+
+  void OnBoolean(bool value) override {
+    Node node;
+    node.type_ = Value::TYPE_BOOLEAN;
+    node.size_ = 0;
+    node.boolean_value_ = value;
+    AddNode(node);
+  }
+
+  void OnInteger(int value) override {
+    Node node;
+    node.type_ = Value::TYPE_INTEGER;
+    node.size_ = 0;
+    node.integer_value_ = value;
+    AddNode(node);
+  }
+
+  void OnDouble(double value) override {
+    Node node;
+    node.type_ = Value::TYPE_DOUBLE;
+    node.size_ = 0;
+    node.double_value_ = value;
+    AddNode(node);
+  }
+
+  void OnString(StringPiece value) override {
+    StringPiece string = Keep(value);
+    Node node;
+    node.type_ = Value::TYPE_STRING;
+    node.size_ = static_cast<uint32_t>(string.size());
+    node.string_value_ = string.data();
+    AddNode(node);
+  }
+
+  void OnDictionaryStart() override { StartContainer(); }
+
+  void OnDictionaryKey(StringPiece key) override { key_ = Keep(key); }
+
+  void OnDictionaryEnd() override {
+    size_t first = EndContainer();
+    auto begin = pending_.begin() + first;
+
+    // Sort the members by key. Later duplicates replace earlier ones, as with
+    // DictionaryValue::SetWithoutPathExpansion(), so the sort must be stable
+    // and keep the last member of each run of equal keys.
+    std::stable_sort(begin, pending_.end(), &MemberKeyLess);
+    auto out = begin;
+    for (auto it = begin; it != pending_.end(); ++it) {
+      if (it + 1 != pending_.end() && (it + 1)->key == it->key)
+        continue;
+      *out++ = *it;
+    }
+
+    size_t count = out - begin;
+    Member* members = nullptr;
+    if (count) {
+      members =
+          static_cast<Member*>(document_->Allocate(count * sizeof(Member)));
+      std::uninitialized_copy(begin, out, members);
+    }
+    pending_.erase(begin, pending_.end());
+
+    Node node;
+    node.type_ = Value::TYPE_DICTIONARY;
+    node.size_ = static_cast<uint32_t>(count);
+    node.members_ = members;
+    AddNode(node);
+  }
+
+  void OnListStart() override { StartContainer(); }
+
+  void OnListEnd() override {
+    size_t first = EndContainer();
+
+    size_t count = pending_.size() - first;
+    Node* items = nullptr;
+    if (count) {
+      items = static_cast<Node*>(document_->Allocate(count * sizeof(Node)));
+      for (size_t i = 0; i < count; ++i)
+        new (&items[i]) Node(pending_[first + i].value);
+    }
+    pending_.resize(first);
+
+    Node node;
+    node.type_ = Value::TYPE_LIST;
+    node.size_ = static_cast<uint32_t>(count);
+    node.items_ = items;
+    AddNode(node);
+  }
+
+ private:
+  struct Container {
+    // The index in |pending_| of the container's first child.
+    size_t first;
+    // The container's own key in its parent, if that is a dictionary.
+    StringPiece key;
+  };
+
+  void StartContainer() {
+    Container container = {pending_.size(), key_};
+    containers_.push_back(container);
+    key_ = StringPiece();
+  }
+
+  // Closes the innermost container, and returns the index of its first child
+  // in |pending_|.
+  size_t EndContainer() {
+    const Container& container = containers_.back();
+    size_t first = container.first;
+    key_ = container.key;
+    containers_.pop_back();
+    return first;
+  }
+
+  // Adds |node| to the container being parsed, under the last key if it is a
+  // dictionary, or makes it the root of the document.
+  void AddNode(const Node& node) {
+    if (containers_.empty()) {
+      document_->root_ = node;
+      return;
+    }
+    Member member = {key_, node};
+    pending_.push_back(member);
+    key_ = StringPiece();
+  }
+
+  // Returns |string| if it points into the input, or a copy of it that lives
+  // as long as the document otherwise.
+  StringPiece Keep(StringPiece string) {
+    const std::string& json = document_->json_;
+    if (string.data() >= json.data() &&
+        string.data() + string.size() <= json.data() + json.size()) {
+      return string;
+    }
+    if (string.empty())
+      return StringPiece();
+    char* copy = static_cast<char*>(document_->Allocate(string.size()));
+    std::copy(string.begin(), string.end(), copy);
+    return StringPiece(copy, string.size());
+  }
+
+  JSONDocument* const document_;
+
+  // The key of the next dictionary member.
+  StringPiece key_;
+
+  // The children of all open containers, outermost first. List items have
+  // empty keys.
+  std::vector<Member> pending_;
+
+  // The open containers, outermost first.
+  std::vector<Container> containers_;
+
+  DISALLOW_COPY_AND_ASSIGN(Builder);
+};
+
+bool JSONDocument::Node::GetAsBoolean(bool* out_value) const {
+  if (type_ != Value::TYPE_BOOLEAN)
+    return false;
+  if (out_value)
+    *out_value = boolean_value_;
+  return true;
+}
+
+bool JSONDocument::Node::GetAsInteger(int* out_value) const {
+  if (type_ != Value::TYPE_INTEGER)
+    return false;
+  if (out_value)
+    *out_value = integer_value_;
+  return true;
+}
+
+bool JSONDocument::Node::GetAsDouble(double* out_value) const {
+  if (type_ == Value::TYPE_DOUBLE) {
+    if (out_value)
+      *out_value = double_value_;
+    return true;
+  }
+  if (type_ == Value::TYPE_INTEGER) {
+    if (out_value)
+      *out_value = integer_value_;
+    return true;
+  }
+  return false;
+}
+
+bool JSONDocument::Node::GetAsString(StringPiece* out_value) const {
+  if (type_ != Value::TYPE_STRING)
+    return false;
+  if (out_value)
+    *out_value = StringPiece(string_value_, size_);
+  return true;
+}
+
+size_t JSONDocument::Node::size() const {
+  if (type_ != Value::TYPE_LIST && type_ != Value::TYPE_DICTIONARY)
+    return 0;
+  return size_;
+}
+
+const JSONDocument::Node* JSONDocument::Node::GetListItem(size_t index) const {
+  if (type_ != Value::TYPE_LIST || index >= size_)
+    return nullptr;
+  return &items_[index];
+}
+
+const JSONDocument::Node* JSONDocument::Node::FindKey(StringPiece key) const {
+  if (type_ != Value::TYPE_DICTIONARY)
+    return nullptr;
+  const Member* end = members_ + size_;
+  const Member* it = std::lower_bound(
+      members_, end, key,
+      [](const Member& member, StringPiece key) { return member.key < key; });
+  if (it == end || it->key != key)
+    return nullptr;
+  return &it->value;
+}
+
+const JSONDocument::Member* JSONDocument::Node::GetMember(size_t index) const {
+  if (type_ != Value::TYPE_DICTIONARY || index >= size_)
+    return nullptr;
+  return &members_[index];
+}
+
+std::unique_ptr<Value> JSONDocument::Node::CreateValue() const {
+  switch (type_) {
+    case Value::TYPE_NULL:
+      return Value::CreateNullValue();
+    case Value::TYPE_BOOLEAN:
+      return MakeUnique<FundamentalValue>(boolean_value_);
+    case Value::TYPE_INTEGER:
+      return MakeUnique<FundamentalValue>(integer_value_);
+    case Value::TYPE_DOUBLE:
+      return MakeUnique<FundamentalValue>(double_value_);
+    case Value::TYPE_STRING:
+      return MakeUnique<StringValue>(std::string(string_value_, size_));
+    case Value::TYPE_DICTIONARY: {
+      std::unique_ptr<DictionaryValue> dict(new DictionaryValue);
+      for (size_t i = 0; i < size_; ++i) {
+        dict->SetWithoutPathExpansion(members_[i].key.as_string(),
+                                      members_[i].value.CreateValue());
+      }
+      return std::move(dict);
+    }
+    case Value::TYPE_LIST: {
+      std::unique_ptr<ListValue> list(new ListValue);
+      for (size_t i = 0; i < size_; ++i)
+        list->Append(items_[i].CreateValue());
+      return std::move(list);
+    }
+    default:
+      NOTREACHED();
+      return nullptr;
+  }
+}
+
+JSONDocument::JSONDocument()
+    : block_pos_(nullptr), block_remaining_(0), allocated_bytes_(0) {
+  root_.type_ = Value::TYPE_NULL;
+  root_.size_ = 0;
+}
+
+JSONDocument::~JSONDocument() {}
+
+// static
+std::unique_ptr<JSONDocument> JSONDocument::Parse(std::string json,
+                                                  int options,
+                                                  int* error_code_out,
+                                                  std::string* error_msg_out) {
+  // Move the input in before parsing, since moving a std::string may move its
+  // characters.
+  std::unique_ptr<JSONDocument> document(new JSONDocument);
+  document->json_ = std::move(json);
+
+  Builder builder(document.get());
+  internal::JSONParser parser(options);
+  if (!parser.Parse(document->json_, &builder)) {
+    if (error_code_out)
+      *error_code_out = parser.error_code();
+    if (error_msg_out)
+      *error_msg_out = parser.GetErrorMessage();
+    return nullptr;
+  }
+  return document;
+}
+
+void* JSONDocument::Allocate(size_t size) {
+  DCHECK_GT(size, 0u);
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  allocated_bytes_ += size;
+
+  // Give large requests their own block, and keep filling the current one.
+  if (size > kBlockSize / 4) {
+    blocks_.push_back(std::unique_ptr<char[]>(new char[size]));
+    return blocks_.back().get();
+  }
+
+  if (size > block_remaining_) {
+    blocks_.push_back(std::unique_ptr<char[]>(new char[kBlockSize]));
+    block_pos_ = blocks_.back().get();
+    block_remaining_ = kBlockSize;
+  }
+  char* memory = block_pos_;
+  block_pos_ += size;
+  block_remaining_ -= size;
+  return memory;
+}
+
+}  // namespace base
@@ -0,0 +1,137 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_JSON_DOCUMENT_H_
+#define BASE_JSON_JSON_DOCUMENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+// A read-only parsed JSON document, for large inputs that are only read after
+// parsing, such as configuration and policy files.
+//
+// Parsing with JSONReader allocates every Value separately and copies every
+// dictionary key into a std::map. A JSONDocument instead keeps the input and
+// allocates its nodes from a few large blocks that live as long as it does:
+//  - Lists are arrays of nodes, and dictionaries are arrays of key/node pairs
+//    sorted by key, which FindKey() binary searches.
+//  - Strings and keys without escape sequences point into the input. Only the
+//    others are copied, once they have been unescaped.
+//
+// Nodes are owned by the document and must not outlive it. Use CreateValue()
+// to get a Value that can be modified or kept independently.
+class BASE_EXPORT JSONDocument {
+ public:
+  struct Member;
+
+  // A value in the document. Integers, doubles and strings are stored inline,
+  // lists and dictionaries point to their children.
+  class BASE_EXPORT Node {
+   public:
+    Value::Type type() const { return type_; }
+    bool IsType(Value::Type type) const { return type_ == type; }
+
+    // Like the Value accessors, these return false if the node is not of the
+    // right type. Integers can also be read as doubles.
+    bool GetAsBoolean(bool* out_value) const;
+    bool GetAsInteger(int* out_value) const;
+    bool GetAsDouble(double* out_value) const;
+    bool GetAsString(StringPiece* out_value) const;
+
+    // Returns the number of items of a list or members of a dictionary, and
+    // 0 for other types.
+    size_t size() const;
+
+    // Returns the |index|th item of a list, or nullptr if this is not a list
+    // or |index| is out of range.
+    const Node* GetListItem(size_t index) const;
+
+    // Returns the value for |key| in a dictionary, or nullptr if this is not
+    // a dictionary or has no such key. Keys are not path-expanded.
+    const Node* FindKey(StringPiece key) const;
+
+    // Returns the |index|th member of a dictionary in key order, or nullptr
+    // if this is not a dictionary or |index| is out of range.
+    const Member* GetMember(size_t index) const;
+
+    // Returns a deep copy of this node as a Value.
+    std::unique_ptr<Value> CreateValue() const;
+
+   private:
+    friend class JSONDocument;
+
+    Value::Type type_;
+    // The length of a string, or the number of children of a list or
+    // dictionary.
+    uint32_t size_;
+    union {
+      bool boolean_value_;
+      int integer_value_;
+      double double_value_;
+      const char* string_value_;
+      const Node* items_;
+      const Member* members_;
+    };
+  };
+
+  struct Member {
+    StringPiece key;
+    Node value;
+  };
+
+  ~JSONDocument();
+
+  // Parses |json| according to |options| (see JSONParserOptions). The
+  // document takes |json| over, so callers that no longer need it should
+  // std::move() it in. Returns nullptr if |json| is not properly formed, and
+  // fills in |error_code_out| and |error_msg_out| if they are not null.
+  static std::unique_ptr<JSONDocument> Parse(std::string json,
+                                             int options,
+                                             int* error_code_out,
+                                             std::string* error_msg_out);
+
+  const Node& root() const { return root_; }
+
+  // Returns the number of bytes allocated for nodes and unescaped strings,
+  // not counting the input.
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
+ private:
+  class Builder;
+
+  JSONDocument();
+
+  // Returns |size| bytes that live as long as the document, aligned for a
+  // Member or a Node.
+  void* Allocate(size_t size);
+
+  // The parsed input, which strings without escape sequences point into.
+  std::string json_;
+
+  Node root_;
+
+  // The blocks that Allocate() hands out memory from. |block_pos_| is the
+  // free part of the one being filled.
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* block_pos_;
+  size_t block_remaining_;
+  size_t allocated_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONDocument);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_DOCUMENT_H_
@@ -0,0 +1,190 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_document.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/macros.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+std::unique_ptr<JSONDocument> Parse(const std::string& json) {
+  return JSONDocument::Parse(json, JSON_PARSE_RFC, nullptr, nullptr);
+}
+
+}  // namespace
+
+TEST(JSONDocumentTest, Scalars) {
+  std::unique_ptr<JSONDocument> document = Parse("null");
+  ASSERT_TRUE(document);
+  EXPECT_TRUE(document->root().IsType(Value::TYPE_NULL));
+
+  bool boolean_value = false;
+  document = Parse("true");
+  ASSERT_TRUE(document);
+  EXPECT_TRUE(document->root().GetAsBoolean(&boolean_value));
+  EXPECT_TRUE(boolean_value);
+
+  int integer_value = 0;
+  double double_value = 0;
+  document = Parse("-42");
+  ASSERT_TRUE(document);
+  EXPECT_TRUE(document->root().GetAsInteger(&integer_value));
+  EXPECT_EQ(-42, integer_value);
+  EXPECT_TRUE(document->root().GetAsDouble(&double_value));
+  EXPECT_EQ(-42.0, double_value);
+
+  document = Parse("1.5e3");
+  ASSERT_TRUE(document);
+  EXPECT_FALSE(document->root().GetAsInteger(&integer_value));
+  EXPECT_TRUE(document->root().GetAsDouble(&double_value));
+  EXPECT_EQ(1500.0, double_value);
+
+  StringPiece string_value;
+  document = Parse("\"a\\u00e9\\tb\"");
+  ASSERT_TRUE(document);
+  EXPECT_TRUE(document->root().GetAsString(&string_value));
+  EXPECT_EQ("a\xc3\xa9\tb", string_value);
+  EXPECT_FALSE(document->root().GetAsBoolean(&boolean_value));
+  EXPECT_EQ(0u, document->root().size());
+}
+
+TEST(JSONDocumentTest, Containers) {
+  std::unique_ptr<JSONDocument> document =
+      Parse("{\"list\": [1, \"two\", [], {}], \"b\": true, \"a\": null}");
+  ASSERT_TRUE(document);
+  const JSONDocument::Node& root = document->root();
+  ASSERT_TRUE(root.IsType(Value::TYPE_DICTIONARY));
+  EXPECT_EQ(3u, root.size());
+
+  // Members are sorted by key.
+  EXPECT_EQ("a", root.GetMember(0)->key);
+  EXPECT_TRUE(root.GetMember(0)->value.IsType(Value::TYPE_NULL));
+  EXPECT_EQ("b", root.GetMember(1)->key);
+  EXPECT_EQ("list", root.GetMember(2)->key);
+  EXPECT_FALSE(root.GetMember(3));
+
+  const JSONDocument::Node* list = root.FindKey("list");
+  ASSERT_TRUE(list);
+  ASSERT_TRUE(list->IsType(Value::TYPE_LIST));
+  ASSERT_EQ(4u, list->size());
+  int integer_value = 0;
+  EXPECT_TRUE(list->GetListItem(0)->GetAsInteger(&integer_value));
+  EXPECT_EQ(1, integer_value);
+  StringPiece string_value;
+  EXPECT_TRUE(list->GetListItem(1)->GetAsString(&string_value));
+  EXPECT_EQ("two", string_value);
+  EXPECT_TRUE(list->GetListItem(2)->IsType(Value::TYPE_LIST));
+  EXPECT_EQ(0u, list->GetListItem(2)->size());
+  EXPECT_TRUE(list->GetListItem(3)->IsType(Value::TYPE_DICTIONARY));
+  EXPECT_EQ(0u, list->GetListItem(3)->size());
+  EXPECT_FALSE(list->GetListItem(3)->FindKey("a"));
+  EXPECT_FALSE(list->GetListItem(4));
+
+  // Lookups of the wrong kind fail.
+  EXPECT_FALSE(root.FindKey("c"));
+  EXPECT_FALSE(root.FindKey("lis"));
+  EXPECT_FALSE(root.GetListItem(0));
+  EXPECT_FALSE(list->FindKey("list"));
+  EXPECT_FALSE(list->GetMember(0));
+}
+
+TEST(JSONDocumentTest, DuplicateKeys) {
+  // As with JSONReader, the last value for a key wins.
+  std::unique_ptr<JSONDocument> document =
+      Parse("{\"a\": 1, \"b\": 2, \"a\": 3, \"c\": 4, \"a\": 5}");
+  ASSERT_TRUE(document);
+  EXPECT_EQ(3u, document->root().size());
+  int integer_value = 0;
+  EXPECT_TRUE(document->root().FindKey("a")->GetAsInteger(&integer_value));
+  EXPECT_EQ(5, integer_value);
+  EXPECT_TRUE(document->root().FindKey("c")->GetAsInteger(&integer_value));
+  EXPECT_EQ(4, integer_value);
+}
+
+TEST(JSONDocumentTest, EscapedKeys) {
+  std::unique_ptr<JSONDocument> document =
+      Parse("{\"\\u0062\": 1, \"a\\\"\": 2}");
+  ASSERT_TRUE(document);
+  EXPECT_TRUE(document->root().FindKey("b"));
+  EXPECT_TRUE(document->root().FindKey("a\""));
+}
+
+// Only strings with escape sequences are copied out of the input.
+TEST(JSONDocumentTest, StringsReferenceInput) {
+  const std::string long_string(4096, 'x');
+  std::unique_ptr<JSONDocument> plain =
+      Parse("{\"" + long_string + "\": [\"" + long_string + "\"]}");
+  ASSERT_TRUE(plain);
+  std::unique_ptr<JSONDocument> escaped =
+      Parse("{\"" + long_string + "\\n\": [\"" + long_string + "\\n\"]}");
+  ASSERT_TRUE(escaped);
+
+  EXPECT_LT(plain->allocated_bytes(), long_string.size());
+  EXPECT_GT(escaped->allocated_bytes(), 2 * long_string.size());
+
+  const JSONDocument::Node* list = escaped->root().FindKey(long_string + "\n");
+  ASSERT_TRUE(list);
+  StringPiece string_value;
+  EXPECT_TRUE(list->GetListItem(0)->GetAsString(&string_value));
+  EXPECT_EQ(long_string + "\n", string_value);
+}
+
+TEST(JSONDocumentTest, MatchesJSONReader) {
+  const char* const kDocuments[] = {
+      "[]",
+      "{}",
+      "\"string\"",
+      "[1, -2, 3.25, 1e100, 2147483648, true, false, null]",
+      "{\"k\": {\"k\": {\"k\": [[[\"v\"]]]}}, \"x\\u0041\": \"\\/\\b\\f\"}",
+      "\xef\xbb\xbf{\"bom\": 1}",
+      "// Comment\n{\"a\": /* comment */ \"\\u00e9\\ud83d\\ude00\"}",
+  };
+  for (const char* json : kDocuments) {
+    SCOPED_TRACE(json);
+    std::unique_ptr<Value> expected = JSONReader::Read(json);
+    ASSERT_TRUE(expected);
+    std::unique_ptr<JSONDocument> document = Parse(json);
+    ASSERT_TRUE(document);
+    EXPECT_TRUE(expected->Equals(document->root().CreateValue().get()));
+  }
+}
+
+TEST(JSONDocumentTest, Errors) {
+  int error_code = JSONReader::JSON_NO_ERROR;
+  std::string error_message;
+  EXPECT_FALSE(JSONDocument::Parse("{\"a\": [1, 2,]}", JSON_PARSE_RFC,
+                                   &error_code, &error_message));
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, error_code);
+  std::string reader_error_message;
+  EXPECT_FALSE(JSONReader::ReadAndReturnError("{\"a\": [1, 2,]}",
+                                              JSON_PARSE_RFC, nullptr,
+                                              &reader_error_message));
+  EXPECT_EQ(reader_error_message, error_message);
+
+  EXPECT_TRUE(JSONDocument::Parse("{\"a\": [1, 2,]}",
+                                  JSON_ALLOW_TRAILING_COMMAS, nullptr,
+                                  nullptr));
+
+  EXPECT_FALSE(JSONDocument::Parse("{a: 1}", JSON_PARSE_RFC, &error_code,
+                                   nullptr));
+  EXPECT_EQ(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, error_code);
+
+  std::string deep(101, '[');
+  deep.append(101, ']');
+  EXPECT_FALSE(JSONDocument::Parse(deep, JSON_PARSE_RFC, &error_code,
+                                   nullptr));
+  EXPECT_EQ(JSONReader::JSON_TOO_MUCH_NESTING, error_code);
+}
+
+}  // namespace base
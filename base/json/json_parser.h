@@ -55,6 +55,11 @@ class BASE_EXPORT JSONParser {
   // convert to a FooValue at the same time.
   std::unique_ptr<Value> Parse(StringPiece input);
 
+  // Parses the input string according to the set options and reports its
+  // contents to |handler| as they are consumed. Returns false on error. The
+  // input is not copied, and JSON_DETACHABLE_CHILDREN has no effect.
+  bool Parse(StringPiece input, JSONReader::Handler* handler);
+
   // Returns the error code.
   JSONReader::JsonParseError error_code() const;
 
@@ -140,6 +145,14 @@ class BASE_EXPORT JSONParser {
     std::string* string_;
   };
 
+  // Resets the parser state to the start of the |length| bytes at |start|,
+  // skipping a UTF-8 Byte-Order-Mark.
+  void StartInput(const char* start, size_t length);
+
+  // Checks that nothing but whitespace and comments follows the root value,
+  // once it has been consumed.
+  bool ConsumeEndOfInput();
+
   // Quick check that the stream has capacity to consume |length| more bytes.
   bool CanConsume(int length);
 
@@ -199,6 +212,10 @@ class BASE_EXPORT JSONParser {
   // Assuming that the parser is wound to the start of a valid JSON number,
   // this parses and converts it to either an int or double value.
   Value* ConsumeNumber();
+  // Helper for ConsumeNumber() that validates the number, leaving the parser
+  // on its last byte, and returns its text in |out|. Returns false on failure
+  // with error information set.
+  bool ConsumeNumberRaw(StringPiece* out);
   // Helper that reads characters that are ints. Returns true if a number was
   // read and false on error.
   bool ReadInt(bool allow_leading_zeros);
@@ -206,6 +223,18 @@ class BASE_EXPORT JSONParser {
   // Consumes the literal values of |true|, |false|, and |null|, assuming the
   // parser is wound to the first character of any of those.
   Value* ConsumeLiteral();
+  // Helper for ConsumeLiteral() that checks that the input continues with
+  // |literal| and consumes it. Returns false on failure with error
+  // information set.
+  bool ConsumeLiteralRaw(StringPiece literal);
+
+  // Counterparts of ParseNextToken(), ParseToken(), ConsumeDictionary() and
+  // ConsumeList() that report the values to |handler| instead of building
+  // them. Return false on failure with error information set.
+  bool EmitNextToken(JSONReader::Handler* handler);
+  bool EmitToken(Token token, JSONReader::Handler* handler);
+  bool EmitDictionary(JSONReader::Handler* handler);
+  bool EmitList(JSONReader::Handler* handler);
 
   // Compares two string buffers of a given length.
   static bool StringsAreEqual(const char* left, const char* right, size_t len);
@@ -0,0 +1,151 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/format_macros.h"
+#include "base/json/json_document.h"
+#include "base/json/json_reader.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Each document is parsed enough times for about this many bytes in total.
+const size_t kBytesPerTest = 64 * 1024 * 1024;
+
+// Counts the values it is handed, like a streaming consumer that looks at each
+// one but keeps none.
+class CountingHandler : public JSONReader::Handler {
+ public:
+  CountingHandler() : count_(0) {}
+  ~CountingHandler() override {}
+
+  size_t count() const { return count_; }
+
+  // JSONReader::Handler implementation.
+  void OnNull() override { ++count_; }
+  void OnBoolean(bool value) override { ++count_; }
+  void OnInteger(int value) override { ++count_; }
+  void OnDouble(double value) override { ++count_; }
+  void OnString(StringPiece value) override { ++count_; }
+  void OnDictionaryStart() override { ++count_; }
+  void OnDictionaryKey(StringPiece key) override {}
+  void OnDictionaryEnd() override {}
+  void OnListStart() override { ++count_; }
+  void OnListEnd() override {}
+
+ private:
+  size_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingHandler);
+};
+
+// Returns a document shaped like a large enterprise policy blob: a dictionary
+// of policies, most of them long lists of URL patterns, plus nested
+// per-extension settings.
+std::string MakePolicyDocument(int policy_count) {
+  std::string json = "{\n";
+  for (int i = 0; i < policy_count; ++i) {
+    StringAppendF(&json, "  \"URLBlacklist%d\": [\n", i);
+    for (int j = 0; j < 50; ++j) {
+      StringAppendF(&json, "    \"https://host%d.example.com/path/%d/*\",\n", j,
+                    i);
+    }
+    json += "    \"file://*\"\n  ],\n";
+    StringAppendF(
+        &json,
+        "  \"ExtensionSettings%d\": {\n"
+        "    \"installation_mode\": \"force_installed\",\n"
+        "    \"update_url\": "
+        "\"https:\\/\\/clients2.google.com\\/service\\/update2\\/crx\",\n"
+        "    \"blocked_permissions\": [\"downloads\", \"bookmarks\"],\n"
+        "    \"runtime_blocked_hosts\": [\"*://*.example.com\"],\n"
+        "    \"minimum_version_required\": \"1.0.%d\",\n"
+        "    \"allowed_types\": [\"extension\", \"theme\"],\n"
+        "    \"install_sources\": null,\n"
+        "    \"toolbar_pin\": true\n"
+        "  },\n",
+        i, i);
+    StringAppendF(&json, "  \"MaxConnectionsPerProxy%d\": %d,\n", i, 32 + i);
+  }
+  json += "  \"DefaultSearchProviderEnabled\": true\n}\n";
+  return json;
+}
+
+// Returns a document shaped like a large data file: a list of records with
+// numbers, booleans, escaped text and a few nested values.
+std::string MakeRecordsDocument(int record_count) {
+  std::string json = "[\n";
+  for (int i = 0; i < record_count; ++i) {
+    StringAppendF(
+        &json,
+        "  {\"id\": %d, \"name\": \"record %d\", \"score\": %d.%02d, "
+        "\"enabled\": %s, \"tags\": [\"alpha\", \"beta\", \"gamma\"], "
+        "\"description\": \"Line one\\nLine \\\"two\\\" \\u00e9\", "
+        "\"location\": {\"lat\": 37.%04d, \"lng\": -122.%04d}, "
+        "\"parent\": null}%s\n",
+        i, i, i % 100, i % 97, i % 3 ? "true" : "false", i % 10000,
+        (i * 7) % 10000, i + 1 < record_count ? "," : "");
+  }
+  json += "]\n";
+  return json;
+}
+
+void RunParseTests(const std::string& name, const std::string& json) {
+  const int iterations =
+      static_cast<int>(std::max<size_t>(1, kBytesPerTest / json.size()));
+  const std::string suffix =
+      StringPrintf(": %s %" PRIuS " bytes x %d", name.c_str(), json.size(),
+                   iterations);
+
+  {
+    PerfTimeLogger timer(("JSONReader::Read" + suffix).c_str());
+    for (int i = 0; i < iterations; ++i)
+      ASSERT_TRUE(JSONReader::Read(json));
+    timer.Done();
+  }
+
+  {
+    PerfTimeLogger timer(("JSONReader::ReadWithHandler" + suffix).c_str());
+    for (int i = 0; i < iterations; ++i) {
+      CountingHandler handler;
+      ASSERT_TRUE(JSONReader::ReadWithHandler(json, JSON_PARSE_RFC, &handler,
+                                              nullptr, nullptr));
+    }
+    timer.Done();
+  }
+
+  {
+    PerfTimeLogger timer(("JSONDocument::Parse" + suffix).c_str());
+    for (int i = 0; i < iterations; ++i) {
+      // The document gets a copy of |json|, as JSONReader::Read() makes one
+      // for its hidden root.
+      ASSERT_TRUE(JSONDocument::Parse(json, JSON_PARSE_RFC, nullptr, nullptr));
+    }
+    timer.Done();
+  }
+}
+
+}  // namespace
+
+TEST(JSONPerfTest, PolicyDocument) {
+  RunParseTests("policy", MakePolicyDocument(1000));
+}
+
+TEST(JSONPerfTest, RecordsDocument) {
+  RunParseTests("records", MakeRecordsDocument(20000));
+}
+
+}  // namespace base
@@ -83,6 +83,29 @@ class BASE_EXPORT JSONReader {
   static const char kUnsupportedEncoding[];
   static const char kUnquotedDictionaryKey[];
 
+  // Receives the contents of a JSON document as a stream of events, in
+  // document order, from ReadWithHandler(). Dictionaries and lists are
+  // bracketed by their Start and End events, and every dictionary value is
+  // preceded by an OnDictionaryKey() event.
+  //
+  // StringPiece arguments are only valid for the duration of the call. They
+  // point into the input when the JSON string had no escape sequences.
+  class BASE_EXPORT Handler {
+   public:
+    virtual ~Handler() {}
+
+    virtual void OnNull() = 0;
+    virtual void OnBoolean(bool value) = 0;
+    virtual void OnInteger(int value) = 0;
+    virtual void OnDouble(double value) = 0;
+    virtual void OnString(StringPiece value) = 0;
+    virtual void OnDictionaryStart() = 0;
+    virtual void OnDictionaryKey(StringPiece key) = 0;
+    virtual void OnDictionaryEnd() = 0;
+    virtual void OnListStart() = 0;
+    virtual void OnListEnd() = 0;
+  };
+
   // Constructs a reader with the default options, JSON_PARSE_RFC.
   JSONReader();
 
@@ -112,6 +135,17 @@ class BASE_EXPORT JSONReader {
       int* error_line_out = nullptr,
       int* error_column_out = nullptr);
 
+  // Parses |json| like ReadAndReturnError(), but hands its contents to
+  // |handler| as they are parsed instead of building a Value. This avoids
+  // allocating anything for most of the input. Returns false if |json| is not
+  // properly formed, after |handler| has seen the events for everything
+  // before the error.
+  static bool ReadWithHandler(StringPiece json,
+                              int options,  // JSONParserOptions
+                              Handler* handler,
+                              int* error_code_out,
+                              std::string* error_msg_out);
+
   // Converts a JSON parse error code into a human readable message.
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
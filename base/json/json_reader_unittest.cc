@@ -7,6 +7,7 @@
 #include <stddef.h>
 
 #include <memory>
+#include <string>
 
 #include "base/base_paths.h"
 #include "base/files/file_util.h"
@@ -14,6 +15,7 @@
 #include "base/macros.h"
 #include "base/path_service.h"
 #include "base/strings/string_piece.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "build/build_config.h"
@@ -21,6 +23,46 @@
 
 namespace base {
 
+namespace {
+
+// Records the events it receives as a string.
+class RecordingHandler : public JSONReader::Handler {
+ public:
+  RecordingHandler() {}
+  ~RecordingHandler() override {}
+
+  const std::string& events() const { return events_; }
+
+  // JSONReader::Handler implementation.
+  void OnNull() override { events_ += "null "; }
+  void OnBoolean(bool value) override {
+    events_ += value ? "true " : "false ";
+  }
+  void OnInteger(int value) override {
+    events_ += StringPrintf("int:%d ", value);
+  }
+  void OnDouble(double value) override {
+    events_ += StringPrintf("double:%g ", value);
+  }
+  void OnString(StringPiece value) override {
+    events_ += "string:" + value.as_string() + " ";
+  }
+  void OnDictionaryStart() override { events_ += "{ "; }
+  void OnDictionaryKey(StringPiece key) override {
+    events_ += "key:" + key.as_string() + " ";
+  }
+  void OnDictionaryEnd() override { events_ += "} "; }
+  void OnListStart() override { events_ += "[ "; }
+  void OnListEnd() override { events_ += "] "; }
+
+ private:
+  std::string events_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingHandler);
+};
+
+}  // namespace
+
 TEST(JSONReaderTest, Reading) {
   {
     // some whitespace checking
@@ -675,4 +717,39 @@ TEST(JSONReaderTest, IllegalTrailingNull) {
   EXPECT_EQ(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, reader.error_code());
 }
 
+TEST(JSONReaderTest, ReadWithHandler) {
+  RecordingHandler handler;
+  EXPECT_TRUE(JSONReader::ReadWithHandler(
+      "{\"a\": [1, 2.5, \"x\\ny\"], \"b\": {}, \"c\": [null, true, false]}",
+      JSON_PARSE_RFC, &handler, nullptr, nullptr));
+  EXPECT_EQ(
+      "{ key:a [ int:1 double:2.5 string:x\ny ] key:b { } "
+      "key:c [ null true false ] } ",
+      handler.events());
+}
+
+TEST(JSONReaderTest, ReadWithHandlerError) {
+  RecordingHandler handler;
+  int error_code = 0;
+  std::string error_message;
+  EXPECT_FALSE(JSONReader::ReadWithHandler("[1, 2,]", JSON_PARSE_RFC,
+                                           &handler, &error_code,
+                                           &error_message));
+  EXPECT_EQ("[ int:1 int:2 ", handler.events());
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, error_code);
+  EXPECT_NE("", error_message);
+
+  // Options apply as for Read().
+  RecordingHandler lenient_handler;
+  EXPECT_TRUE(JSONReader::ReadWithHandler("[1, 2,]", JSON_ALLOW_TRAILING_COMMAS,
+                                          &lenient_handler, nullptr, nullptr));
+  EXPECT_EQ("[ int:1 int:2 ] ", lenient_handler.events());
+
+  RecordingHandler trailing_handler;
+  EXPECT_FALSE(JSONReader::ReadWithHandler("[] []", JSON_PARSE_RFC,
+                                           &trailing_handler, &error_code,
+                                           nullptr));
+  EXPECT_EQ(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, error_code);
+}
+
 }  // namespace base
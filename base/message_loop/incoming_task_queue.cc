@@ -51,7 +51,6 @@ TimeTicks CalculateDelayedRuntime(TimeDelta delay) {
 IncomingTaskQueue::IncomingTaskQueue(MessageLoop* message_loop)
     : high_res_task_count_(0),
       message_loop_(message_loop),
-      next_sequence_num_(0),
       message_loop_scheduled_(false),
       always_schedule_work_(AlwaysNotifyPump(message_loop_->type())),
       is_ready_for_scheduling_(false) {
@@ -83,33 +82,34 @@ bool IncomingTaskQueue::AddToIncomingQueue(
 }
 
 bool IncomingTaskQueue::HasHighResolutionTasks() {
-  AutoLock lock(incoming_queue_lock_);
-  return high_res_task_count_ > 0;
+  return high_res_task_count_.load() > 0;
 }
 
 bool IncomingTaskQueue::IsIdleForTesting() {
-  AutoLock lock(incoming_queue_lock_);
-  return incoming_queue_.empty();
+  return incoming_queue_.IsEmpty();
 }
 
 int IncomingTaskQueue::ReloadWorkQueue(TaskQueue* work_queue) {
   // Make sure no tasks are lost.
   DCHECK(work_queue->empty());
 
-  // Acquire all we can from the inter-thread queue with one lock acquisition.
-  AutoLock lock(incoming_queue_lock_);
-  if (incoming_queue_.empty()) {
+  // Acquire all we can from the inter-thread queue without taking a lock.
+  if (!incoming_queue_.PopAll(work_queue)) {
     // If the loop attempts to reload but there are no tasks in the incoming
     // queue, that means it will go to sleep waiting for more work. If the
     // incoming queue becomes nonempty we need to schedule it again.
-    message_loop_scheduled_ = false;
-  } else {
-    incoming_queue_.swap(*work_queue);
+    message_loop_scheduled_.store(false);
+
+    // A task pushed before |message_loop_scheduled_| was cleared may not have
+    // scheduled the loop. Its producer linked it into |incoming_queue_| before
+    // reading |message_loop_scheduled_|, so it is either popped here or its
+    // producer schedules the loop.
+    if (incoming_queue_.PopAll(work_queue))
+      message_loop_scheduled_.store(true);
   }
   // Reset the count of high resolution tasks since our queue is now empty.
-  int high_res_tasks = high_res_task_count_;
-  high_res_task_count_ = 0;
-  return high_res_tasks;
+  // Tasks counted after this exchange are counted by the next reload.
+  return high_res_task_count_.exchange(0);
 }
 
 void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
@@ -118,15 +118,13 @@ void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
 }
 
 void IncomingTaskQueue::StartScheduling() {
-  bool schedule_work;
-  {
-    AutoLock lock(incoming_queue_lock_);
-    DCHECK(!is_ready_for_scheduling_);
-    DCHECK(!message_loop_scheduled_);
-    is_ready_for_scheduling_ = true;
-    schedule_work = !incoming_queue_.empty();
-  }
-  if (schedule_work) {
+  DCHECK(!is_ready_for_scheduling_.load());
+  DCHECK(!message_loop_scheduled_.load());
+  is_ready_for_scheduling_.store(true);
+
+  // A producer that read |is_ready_for_scheduling_| before it was set pushed
+  // its task before reading it, so IsEmpty() observes that task.
+  if (!incoming_queue_.IsEmpty()) {
     DCHECK(message_loop_);
     // Don't need to lock |message_loop_lock_| here because this function is
     // called by MessageLoop on its thread.
@@ -152,43 +150,36 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
     return false;
   }
 
-  bool schedule_work = false;
-  {
-    AutoLock hold(incoming_queue_lock_);
-
 #if defined(OS_WIN)
-    if (pending_task->is_high_res)
-      ++high_res_task_count_;
+  if (pending_task->is_high_res)
+    ++high_res_task_count_;
 #endif
 
-    // Initialize the sequence number. The sequence number is used for delayed
-    // tasks (to facilitate FIFO sorting when two tasks have the same
-    // delayed_run_time value) and for identifying the task in about:tracing.
-    pending_task->sequence_num = next_sequence_num_++;
-
-    message_loop_->task_annotator()->DidQueueTask("MessageLoop::PostTask",
-                                                  *pending_task);
-
-    bool was_empty = incoming_queue_.empty();
-    incoming_queue_.push(std::move(*pending_task));
-
-    if (is_ready_for_scheduling_ &&
-        (always_schedule_work_ || (!message_loop_scheduled_ && was_empty))) {
-      schedule_work = true;
-      // After we've scheduled the message loop, we do not need to do so again
-      // until we know it has processed all of the work in our queue and is
-      // waiting for more work again. The message loop will always attempt to
-      // reload from the incoming queue before waiting again so we clear this
-      // flag in ReloadWorkQueue().
-      message_loop_scheduled_ = true;
-    }
-  }
-
-  // Wake up the message loop and schedule work. This is done outside
-  // |incoming_queue_lock_| because signaling the message loop may cause this
-  // thread to be switched. If |incoming_queue_lock_| is held, any other thread
-  // that wants to post a task will be blocked until this thread switches back
-  // in and releases |incoming_queue_lock_|.
+  // Initialize the sequence number. The sequence number is used for delayed
+  // tasks (to facilitate FIFO sorting when two tasks have the same
+  // delayed_run_time value) and for identifying the task in about:tracing.
+  // Tasks posted concurrently from different threads may be queued in a
+  // different order than their sequence numbers.
+  pending_task->sequence_num = next_sequence_num_.GetNext();
+
+  message_loop_->task_annotator()->DidQueueTask("MessageLoop::PostTask",
+                                                *pending_task);
+
+  incoming_queue_.Push(std::move(*pending_task));
+  pending_task->task.Reset();
+
+  // After we've scheduled the message loop, we do not need to do so again
+  // until we know it has processed all of the work in our queue and is
+  // waiting for more work again. The message loop will always attempt to
+  // reload from the incoming queue before waiting again so we clear
+  // |message_loop_scheduled_| in ReloadWorkQueue(). The task must be pushed
+  // before |message_loop_scheduled_| and |is_ready_for_scheduling_| are read
+  // (see ReloadWorkQueue() and StartScheduling()).
+  const bool schedule_work =
+      is_ready_for_scheduling_.load() &&
+      (always_schedule_work_ || !message_loop_scheduled_.exchange(true));
+
+  // Wake up the message loop and schedule work.
   if (schedule_work)
     message_loop_->ScheduleWork();
 
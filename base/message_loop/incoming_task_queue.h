@@ -5,11 +5,14 @@
 #ifndef BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 #define BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 
+#include <atomic>
+
+#include "base/atomic_sequence_num.h"
 #include "base/base_export.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/message_loop/lock_free_task_queue.h"
 #include "base/pending_task.h"
-#include "base/synchronization/lock.h"
 #include "base/synchronization/read_write_lock.h"
 #include "base/time/time.h"
 
@@ -22,7 +25,8 @@ namespace internal {
 
 // Implements a queue of tasks posted to the message loop running on the current
 // thread. This class takes care of synchronizing posting tasks from different
-// threads and together with MessageLoop ensures clean shutdown.
+// threads and together with MessageLoop ensures clean shutdown. Posting a task
+// doesn't acquire any lock other than the read side of |message_loop_lock_|.
 class BASE_EXPORT IncomingTaskQueue
     : public RefCountedThreadSafe<IncomingTaskQueue> {
  public:
@@ -74,37 +78,33 @@ class BASE_EXPORT IncomingTaskQueue
 
   // Number of tasks that require high resolution timing. This value is kept
   // so that ReloadWorkQueue() completes in constant time.
-  int high_res_task_count_;
-
-  // The lock that protects access to the members of this class, except
-  // |message_loop_|.
-  base::Lock incoming_queue_lock_;
+  std::atomic<int> high_res_task_count_;
 
   // Lock that protects |message_loop_| to prevent it from being deleted while a
   // task is being posted.
   base::subtle::ReadWriteLock message_loop_lock_;
 
-  // An incoming queue of tasks that are acquired under a mutex for processing
-  // on this instance's thread. These tasks have not yet been been pushed to
-  // |message_loop_|.
-  TaskQueue incoming_queue_;
+  // An incoming queue of tasks that are pushed without a lock by any thread and
+  // popped for processing on this instance's thread. These tasks have not yet
+  // been been pushed to |message_loop_|.
+  LockFreeTaskQueue incoming_queue_;
 
   // Points to the message loop that owns |this|.
   MessageLoop* message_loop_;
 
   // The next sequence number to use for delayed tasks.
-  int next_sequence_num_;
+  AtomicSequenceNumber next_sequence_num_;
 
   // True if our message loop has already been scheduled and does not need to be
   // scheduled again until an empty reload occurs.
-  bool message_loop_scheduled_;
+  std::atomic<bool> message_loop_scheduled_;
 
   // True if we always need to call ScheduleWork when receiving a new task, even
   // if the incoming queue was not empty.
   const bool always_schedule_work_;
 
   // False until StartScheduling() is called.
-  bool is_ready_for_scheduling_;
+  std::atomic<bool> is_ready_for_scheduling_;
 
   DISALLOW_COPY_AND_ASSIGN(IncomingTaskQueue);
 };
@@ -0,0 +1,216 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/lock_free_task_queue.h"
+
+#include <utility>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/memory/manual_constructor.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// A node that carries a PendingTask.
+struct TaskNode : public LockFreeTaskQueue::Node {
+  ManualConstructor<PendingTask> pending_task;
+
+  // Next node in a free list. Only accessed by the thread that owns the list.
+  TaskNode* next_free;
+};
+
+// Maximum number of nodes kept in the shared free list. Nodes released while
+// the shared free list is at least this large are deleted.
+const size_t kMaxSharedFreeNodes = 4096;
+
+// Maximum number of nodes a thread takes from the shared free list at once,
+// which bounds the size of its cache. A thread that rarely posts tasks doesn't
+// hold on to nodes that other threads need.
+const size_t kMaxThreadCacheNodes = 64;
+
+void DeleteFreeList(TaskNode* first) {
+  while (first) {
+    TaskNode* const next = first->next_free;
+    delete first;
+    first = next;
+  }
+}
+
+void ReleaseThreadCache(void* value);
+
+// Process-wide pool of TaskNodes. Each thread allocates from a cache of free
+// nodes stored in TLS. When its cache is empty, a thread refills it with at
+// most |kMaxThreadCacheNodes| nodes from the shared free list. Consumers return
+// nodes to the shared free list in batches. The shared free list is protected
+// by a lock, which is only taken once per batch of nodes, so the lock isn't
+// taken by most Push() calls.
+class TaskNodePool {
+ public:
+  TaskNodePool() : thread_cache_(&ReleaseThreadCache) {}
+
+  TaskNode* Allocate() {
+    TaskNode* node = static_cast<TaskNode*>(thread_cache_.Get());
+    if (!node) {
+      node = TakeSharedFreeNodes();
+      if (!node)
+        return new TaskNode;
+    }
+    thread_cache_.Set(node->next_free);
+    return node;
+  }
+
+  // Returns the |num_nodes| nodes linked through |next_free| from |first| to
+  // |last| to the pool.
+  void Release(TaskNode* first, TaskNode* last, size_t num_nodes) {
+    DCHECK(first);
+    DCHECK(last);
+    DCHECK(!last->next_free);
+
+    {
+      AutoLock auto_lock(lock_);
+      if (num_shared_free_nodes_ < kMaxSharedFreeNodes) {
+        last->next_free = shared_free_nodes_;
+        shared_free_nodes_ = first;
+        num_shared_free_nodes_ += num_nodes;
+        return;
+      }
+    }
+    DeleteFreeList(first);
+  }
+
+ private:
+  // Removes up to |kMaxThreadCacheNodes| nodes from the shared free list and
+  // returns the first of them, or nullptr if the shared free list is empty.
+  TaskNode* TakeSharedFreeNodes() {
+    AutoLock auto_lock(lock_);
+    TaskNode* const first = shared_free_nodes_;
+    if (!first)
+      return nullptr;
+    TaskNode* last = first;
+    size_t num_nodes = 1;
+    while (last->next_free && num_nodes < kMaxThreadCacheNodes) {
+      last = last->next_free;
+      ++num_nodes;
+    }
+    shared_free_nodes_ = last->next_free;
+    last->next_free = nullptr;
+    DCHECK_GE(num_shared_free_nodes_, num_nodes);
+    num_shared_free_nodes_ -= num_nodes;
+    return first;
+  }
+
+  // Free nodes owned by the current thread.
+  ThreadLocalStorage::Slot thread_cache_;
+
+  Lock lock_;
+  TaskNode* shared_free_nodes_ = nullptr;
+  size_t num_shared_free_nodes_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskNodePool);
+};
+
+LazyInstance<TaskNodePool>::Leaky g_task_node_pool = LAZY_INSTANCE_INITIALIZER;
+
+// Returns the free nodes cached by an exiting thread to the shared free list.
+void ReleaseThreadCache(void* value) {
+  TaskNode* const first = static_cast<TaskNode*>(value);
+  TaskNode* last = first;
+  size_t num_nodes = 1;
+  while (last->next_free) {
+    last = last->next_free;
+    ++num_nodes;
+  }
+  g_task_node_pool.Get().Release(first, last, num_nodes);
+}
+
+}  // namespace
+
+LockFreeTaskQueue::LockFreeTaskQueue() : head_(&stub_), tail_(&stub_) {
+  stub_.next.store(nullptr, std::memory_order_relaxed);
+}
+
+LockFreeTaskQueue::~LockFreeTaskQueue() {
+  TaskQueue discarded_tasks;
+  PopAll(&discarded_tasks);
+  DCHECK(IsEmpty());
+}
+
+void LockFreeTaskQueue::Push(PendingTask pending_task) {
+  TaskNode* const node = g_task_node_pool.Get().Allocate();
+  node->pending_task.Init(std::move(pending_task));
+  PushNode(node);
+}
+
+size_t LockFreeTaskQueue::PopAll(TaskQueue* work_queue) {
+  size_t num_popped = 0;
+  TaskNode* first_free = nullptr;
+  TaskNode* last_free = nullptr;
+  while (Node* const node = PopNode()) {
+    TaskNode* const task_node = static_cast<TaskNode*>(node);
+    work_queue->push(std::move(*task_node->pending_task));
+    task_node->pending_task.Destroy();
+
+    task_node->next_free = first_free;
+    first_free = task_node;
+    if (!last_free)
+      last_free = task_node;
+    ++num_popped;
+  }
+  if (first_free)
+    g_task_node_pool.Get().Release(first_free, last_free, num_popped);
+  return num_popped;
+}
+
+bool LockFreeTaskQueue::IsEmpty() const {
+  return tail_ == &stub_ && head_.load() == &stub_;
+}
+
+void LockFreeTaskQueue::PushNode(Node* node) {
+  node->next.store(nullptr, std::memory_order_relaxed);
+  // Once |head_| points to |node|, the list is non-empty from the point of
+  // view of IsEmpty(). |node| becomes reachable from |tail_| once it is linked
+  // to |previous_head|.
+  Node* const previous_head = head_.exchange(node);
+  previous_head->next.store(node);
+}
+
+LockFreeTaskQueue::Node* LockFreeTaskQueue::PopNode() {
+  Node* tail = tail_;
+  Node* next = tail->next.load();
+  if (tail == &stub_) {
+    if (!next)
+      return nullptr;
+    tail_ = next;
+    tail = next;
+    next = next->next.load();
+  }
+
+  if (next) {
+    tail_ = next;
+    return tail;
+  }
+
+  // |tail| is the last node of the list, unless a producer has exchanged
+  // |head_| but hasn't linked its node yet. In that case, the consumer can't
+  // make progress until the producer is done.
+  if (tail != head_.load())
+    return nullptr;
+
+  // Append |stub_| so that |tail| isn't the last node and can be removed.
+  PushNode(&stub_);
+  next = tail->next.load();
+  if (next) {
+    tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,83 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
+#define BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/pending_task.h"
+
+namespace base {
+namespace internal {
+
+// A multi-producer single-consumer queue of PendingTasks whose list doesn't use
+// locks. Push() can be called from any thread. PopAll() and IsEmpty() must be
+// called from a single consumer thread. Tasks pushed from the same thread are
+// popped in the order in which they were pushed.
+//
+// The queue is an intrusive singly linked list of nodes (Dmitry Vyukov's
+// algorithm): a producer appends a node with a single atomic exchange and the
+// consumer walks the list without any atomic read-modify-write operation.
+// Nodes are recycled through a process-wide free list with small per-thread
+// caches so that Push() doesn't allocate once the number of queued tasks has
+// reached its steady state. Push() only takes the free list's lock when its
+// thread's cache is empty.
+class BASE_EXPORT LockFreeTaskQueue {
+ public:
+  LockFreeTaskQueue();
+
+  // Deletes all tasks that were never popped. Must be called on the consumer
+  // thread or after all producers are done.
+  ~LockFreeTaskQueue();
+
+  // Appends |pending_task| to the queue. Can be called from any thread.
+  void Push(PendingTask pending_task);
+
+  // Moves all tasks that are fully pushed to the back of |work_queue| and
+  // returns how many were moved. A task whose Push() hasn't returned yet may
+  // not be moved; its producer will observe any state published by the
+  // consumer before this call. Must be called from the consumer thread.
+  size_t PopAll(TaskQueue* work_queue);
+
+  // Returns true if no task was pushed since the last PopAll(), including
+  // tasks whose Push() hasn't returned yet. Must be called from the consumer
+  // thread.
+  bool IsEmpty() const;
+
+  // A link in the queue. Defined here so that the queue can own the stub node.
+  struct Node {
+    std::atomic<Node*> next;
+  };
+
+ private:
+  // Appends |node| to the list.
+  void PushNode(Node* node);
+
+  // Removes and returns the oldest fully pushed node, or nullptr if there is
+  // none. Never returns |stub_|.
+  Node* PopNode();
+
+  // Most recently pushed node. Producers exchange it to append to the list.
+  std::atomic<Node*> head_;
+
+  // Oldest node that hasn't been popped. Only accessed by the consumer.
+  Node* tail_;
+
+  // Node without a task that keeps the list non-empty so that producers never
+  // need to update |tail_|. It is re-appended whenever the consumer pops the
+  // last node.
+  Node stub_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeTaskQueue);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
@@ -0,0 +1,172 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/lock_free_task_queue.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+const int kNumProducers = 4;
+const int kNumTasksPerProducer = 10000;
+
+PendingTask CreateTask(int sequence_num) {
+  PendingTask pending_task(FROM_HERE, Bind(&DoNothing));
+  pending_task.sequence_num = sequence_num;
+  return pending_task;
+}
+
+// Sets |*deleted| to true when destroyed.
+class DeletionObserver : public RefCountedThreadSafe<DeletionObserver> {
+ public:
+  explicit DeletionObserver(bool* deleted) : deleted_(deleted) {}
+
+ private:
+  friend class RefCountedThreadSafe<DeletionObserver>;
+  ~DeletionObserver() { *deleted_ = true; }
+
+  bool* const deleted_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeletionObserver);
+};
+
+void ExpectNotRun(scoped_refptr<DeletionObserver> observer) {
+  ADD_FAILURE() << "Unexpected task run.";
+}
+
+// Pushes |kNumTasksPerProducer| tasks whose sequence number encodes
+// |producer_index| and the order in which they were pushed.
+class Producer : public DelegateSimpleThread::Delegate {
+ public:
+  Producer(LockFreeTaskQueue* queue, int producer_index)
+      : queue_(queue), producer_index_(producer_index) {}
+
+  void Run() override {
+    for (int i = 0; i < kNumTasksPerProducer; ++i)
+      queue_->Push(CreateTask(producer_index_ * kNumTasksPerProducer + i));
+  }
+
+ private:
+  LockFreeTaskQueue* const queue_;
+  const int producer_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(Producer);
+};
+
+}  // namespace
+
+TEST(LockFreeTaskQueueTest, Empty) {
+  LockFreeTaskQueue queue;
+  EXPECT_TRUE(queue.IsEmpty());
+
+  TaskQueue work_queue;
+  EXPECT_EQ(0U, queue.PopAll(&work_queue));
+  EXPECT_TRUE(work_queue.empty());
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(LockFreeTaskQueueTest, PushAndPopAll) {
+  LockFreeTaskQueue queue;
+  TaskQueue work_queue;
+
+  // Pop the queue down to its last node several times, to exercise recycling
+  // of the stub node.
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 3; ++i)
+      queue.Push(CreateTask(round * 3 + i));
+    EXPECT_FALSE(queue.IsEmpty());
+
+    EXPECT_EQ(3U, queue.PopAll(&work_queue));
+    EXPECT_TRUE(queue.IsEmpty());
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_FALSE(work_queue.empty());
+      EXPECT_EQ(round * 3 + i, work_queue.front().sequence_num);
+      work_queue.pop();
+    }
+    EXPECT_TRUE(work_queue.empty());
+  }
+}
+
+TEST(LockFreeTaskQueueTest, PopAllAppendsToWorkQueue) {
+  LockFreeTaskQueue queue;
+  TaskQueue work_queue;
+  work_queue.push(CreateTask(0));
+
+  queue.Push(CreateTask(1));
+  EXPECT_EQ(1U, queue.PopAll(&work_queue));
+
+  ASSERT_EQ(2U, work_queue.size());
+  EXPECT_EQ(0, work_queue.front().sequence_num);
+  EXPECT_EQ(1, work_queue.back().sequence_num);
+}
+
+// Verify that tasks that were never popped are deleted with the queue.
+TEST(LockFreeTaskQueueTest, DeleteUnpoppedTasks) {
+  bool deleted = false;
+  {
+    LockFreeTaskQueue queue;
+    queue.Push(PendingTask(
+        FROM_HERE,
+        Bind(&ExpectNotRun, make_scoped_refptr(new DeletionObserver(&deleted)))));
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+// Verify that tasks pushed concurrently by multiple threads are all popped
+// exactly once, in the order in which each thread pushed them.
+TEST(LockFreeTaskQueueTest, MultipleProducers) {
+  LockFreeTaskQueue queue;
+
+  std::vector<std::unique_ptr<Producer>> producers;
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.push_back(WrapUnique(new Producer(&queue, i)));
+    threads.push_back(WrapUnique(
+        new DelegateSimpleThread(producers.back().get(), "Producer")));
+    threads.back()->Start();
+  }
+
+  std::vector<int> next_expected(kNumProducers);
+  for (int i = 0; i < kNumProducers; ++i)
+    next_expected[i] = i * kNumTasksPerProducer;
+
+  int num_popped = 0;
+  while (num_popped < kNumProducers * kNumTasksPerProducer) {
+    TaskQueue work_queue;
+    queue.PopAll(&work_queue);
+    while (!work_queue.empty()) {
+      const int sequence_num = work_queue.front().sequence_num;
+      work_queue.pop();
+      const int producer_index = sequence_num / kNumTasksPerProducer;
+      ASSERT_GE(producer_index, 0);
+      ASSERT_LT(producer_index, kNumProducers);
+      EXPECT_EQ(next_expected[producer_index], sequence_num);
+      next_expected[producer_index] = sequence_num + 1;
+      ++num_popped;
+    }
+  }
+
+  for (const auto& thread : threads)
+    thread->Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+}  // namespace internal
+}  // namespace base
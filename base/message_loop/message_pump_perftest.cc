@@ -14,6 +14,7 @@
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -302,4 +303,88 @@ TEST_F(PostTaskTest, OneHundredTasksPerReload) {
   Run(1000, 100);
 }
 
+// Measures the throughput of IncomingTaskQueue when several threads post to it
+// concurrently while the loop's thread keeps reloading its work queue.
+class ConcurrentPostTaskTest : public testing::Test {
+ public:
+  void Run(int num_posting_threads) {
+    MessageLoop loop(std::unique_ptr<MessagePump>(new FakeMessagePump));
+    scoped_refptr<internal::IncomingTaskQueue> queue(
+        new internal::IncomingTaskQueue(&loop));
+
+    ScopedVector<PostingDelegate> delegates;
+    ScopedVector<DelegateSimpleThread> threads;
+    for (int i = 0; i < num_posting_threads; ++i) {
+      delegates.push_back(new PostingDelegate(queue.get()));
+      threads.push_back(
+          new DelegateSimpleThread(delegates.back(), "PostingThread"));
+    }
+
+    const int num_tasks = num_posting_threads * kTasksPerThread;
+    int num_ran = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (DelegateSimpleThread* thread : threads)
+      thread->Start();
+    while (num_ran < num_tasks) {
+      TaskQueue loop_local_queue;
+      queue->ReloadWorkQueue(&loop_local_queue);
+      while (!loop_local_queue.empty()) {
+        PendingTask t = std::move(loop_local_queue.front());
+        loop_local_queue.pop();
+        loop.RunTask(t);
+        ++num_ran;
+      }
+    }
+    base::TimeTicks now = base::TimeTicks::Now();
+    for (DelegateSimpleThread* thread : threads)
+      thread->Join();
+    queue->WillDestroyCurrentMessageLoop();
+
+    std::string trace =
+        StringPrintf("%d_posting_threads", num_posting_threads);
+    perf_test::PrintResult(
+        "task_concurrent_post",
+        "",
+        trace,
+        (now - start).InMicroseconds() / static_cast<double>(num_tasks),
+        "us/task",
+        true);
+  }
+
+ private:
+  class PostingDelegate : public DelegateSimpleThread::Delegate {
+   public:
+    explicit PostingDelegate(internal::IncomingTaskQueue* queue)
+        : queue_(queue) {}
+
+    void Run() override {
+      for (int i = 0; i < kTasksPerThread; ++i) {
+        queue_->AddToIncomingQueue(
+            FROM_HERE, base::Bind(&DoNothing), base::TimeDelta(), false);
+      }
+    }
+
+   private:
+    internal::IncomingTaskQueue* const queue_;
+  };
+
+  static const int kTasksPerThread = 500000;
+};
+
+TEST_F(ConcurrentPostTaskTest, OnePostingThread) {
+  Run(1);
+}
+
+TEST_F(ConcurrentPostTaskTest, TwoPostingThreads) {
+  Run(2);
+}
+
+TEST_F(ConcurrentPostTaskTest, FourPostingThreads) {
+  Run(4);
+}
+
+TEST_F(ConcurrentPostTaskTest, EightPostingThreads) {
+  Run(8);
+}
+
 }  // namespace base
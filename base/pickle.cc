@@ -360,8 +360,11 @@ void Pickle::Reserve(size_t length) {
 #endif
   DCHECK_LE(write_offset_, std::numeric_limits<uint32_t>::max() - data_len);
   size_t new_size = write_offset_ + data_len;
+  // Reserving exactly what the caller asked for lets a pickle whose size is
+  // known upfront grow just once, while repeated calls still grow
+  // geometrically.
   if (new_size > capacity_after_header_)
-    Resize(capacity_after_header_ * 2 + new_size);
+    Resize(std::max(capacity_after_header_ * 2, new_size));
 }
 
 bool Pickle::WriteAttachment(scoped_refptr<Attachment> attachment) {
@@ -421,6 +421,29 @@ TEST(PickleTest, Resize) {
   EXPECT_EQ(cur_payload, pickle.payload_size());
 }
 
+TEST(PickleTest, Reserve) {
+  size_t unit = Pickle::kPayloadUnit;
+  std::string data(unit * 10, 'G');
+
+  // Reserving the size of upcoming writes allocates just enough for them.
+  PickleSizer sizer;
+  sizer.AddInt();
+  sizer.AddString(data);
+  Pickle pickle;
+  pickle.Reserve(sizer.payload_size());
+  EXPECT_EQ(unit * 11, pickle.capacity_after_header());
+  pickle.WriteInt(1);
+  pickle.WriteString(data);
+  EXPECT_EQ(unit * 11, pickle.capacity_after_header());
+  EXPECT_EQ(sizer.payload_size(), pickle.payload_size());
+
+  // Reserving past the capacity still grows it geometrically.
+  pickle.Reserve(unit * 2);
+  EXPECT_EQ(unit * 22, pickle.capacity_after_header());
+  pickle.Reserve(unit * 11);
+  EXPECT_EQ(unit * 22, pickle.capacity_after_header());
+}
+
 namespace {
 
 struct CustomHeader : Pickle::Header {
@@ -30,7 +30,7 @@ namespace internal {
 namespace {
 
 // SchedulerWorker that owns the current thread, if any.
-LazyInstance<ThreadLocalPointer<const SchedulerWorker>>::Leaky
+LazyInstance<ThreadLocalPointer<SchedulerWorker>>::Leaky
     tls_current_worker = LAZY_INSTANCE_INITIALIZER;
 
 // SchedulerWorkerPool that owns the current thread, if any.
@@ -119,6 +119,21 @@ class SchedulerSequencedTaskRunner : public SequencedTaskRunner {
   DISALLOW_COPY_AND_ASSIGN(SchedulerSequencedTaskRunner);
 };
 
+// Value published as the top priority of a worker's local PriorityQueue when
+// it is empty. Smaller than any TaskPriority.
+constexpr int kNoPriority = -1;
+
+// Stores the priority of the most important Sequence accessible through
+// |transaction|, or kNoPriority if there is none, in |top_priority|.
+void PublishTopPriority(const PriorityQueue::Transaction& transaction,
+                        subtle::Atomic32* top_priority) {
+  subtle::Release_Store(
+      top_priority,
+      transaction.IsEmpty()
+          ? kNoPriority
+          : static_cast<int>(transaction.PeekSortKey().priority()));
+}
+
 // Only used in DCHECKs.
 bool ContainsWorker(
     const std::vector<std::unique_ptr<SchedulerWorker>>& workers,
@@ -187,8 +202,10 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   // |re_enqueue_sequence_callback| is invoked when ReEnqueueSequence() is
   // called with a non-single-threaded Sequence. |shared_priority_queue| is a
   // PriorityQueue whose transactions may overlap with the worker's
-  // single-threaded PriorityQueue's transactions. |index| will be appended to
-  // the pool name to label the underlying worker threads.
+  // single-threaded PriorityQueue's transactions (when work stealing is
+  // enabled, the worker's local PriorityQueue takes that role instead).
+  // |index| will be appended to the pool name to label the underlying worker
+  // threads.
   SchedulerWorkerDelegateImpl(
       SchedulerWorkerPoolImpl* outer,
       const ReEnqueueSequenceCallback& re_enqueue_sequence_callback,
@@ -200,6 +217,23 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
     return &single_threaded_priority_queue_;
   }
 
+  // Inserts |sequence| in |local_priority_queue_|. Only used when work
+  // stealing is enabled.
+  void PushToLocalPriorityQueue(scoped_refptr<Sequence> sequence,
+                                const SequenceSortKey& sequence_sort_key);
+
+  // Removes and returns the most important Sequence of
+  // |local_priority_queue_|, or nullptr if it is empty. Called by other workers
+  // of the pool when they run out of work.
+  scoped_refptr<Sequence> StealFromLocalPriorityQueue();
+
+  // Returns the priority of the most important Sequence in
+  // |local_priority_queue_| as an int, or kNoPriority if it is empty. The
+  // returned value may be stale by the time it is used.
+  int GetLocalTopPriority() const {
+    return subtle::Acquire_Load(&local_top_priority_);
+  }
+
   // SchedulerWorker::Delegate:
   void OnMainEntry(SchedulerWorker* worker) override;
   scoped_refptr<Sequence> GetWork(SchedulerWorker* worker) override;
@@ -216,9 +250,33 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   }
 
  private:
+  // Implementation of GetWork() when work stealing is enabled.
+  scoped_refptr<Sequence> GetWorkWithStealing(SchedulerWorker* worker);
+
+  // Returns a Sequence from |local_priority_queue_| or
+  // |single_threaded_priority_queue_|, stealing from the local PriorityQueue
+  // of another worker when it holds a Sequence of higher priority or when this
+  // worker has no work of its own. Returns nullptr if no Sequence was found.
+  scoped_refptr<Sequence> GetLocalOrStolenSequence();
+
+  // Pops the most important Sequence from |local_priority_queue_| and
+  // |single_threaded_priority_queue_| if its priority is at least
+  // |min_priority|. Returns nullptr otherwise.
+  scoped_refptr<Sequence> PopLocalSequence(int min_priority);
+
   SchedulerWorkerPoolImpl* outer_;
   const ReEnqueueSequenceCallback re_enqueue_sequence_callback_;
 
+  // PriorityQueue of Sequences dispatched to this worker when work stealing is
+  // enabled. Other workers of the pool may steal Sequences from it.
+  PriorityQueue local_priority_queue_;
+
+  // Priority of the most important Sequence in |local_priority_queue_|, or
+  // kNoPriority if it is empty. Updated within every Transaction that modifies
+  // |local_priority_queue_| so that other workers can pick a worker to steal
+  // from without acquiring the lock of every local PriorityQueue.
+  subtle::Atomic32 local_top_priority_ = kNoPriority;
+
   // Single-threaded PriorityQueue for the worker.
   PriorityQueue single_threaded_priority_queue_;
 
@@ -252,6 +310,7 @@ std::unique_ptr<SchedulerWorkerPoolImpl> SchedulerWorkerPoolImpl::Create(
       new SchedulerWorkerPoolImpl(params.name(),
                                   params.io_restriction(),
                                   params.suggested_reclaim_time(),
+                                  params.sequence_dispatch_mode(),
                                   task_tracker, delayed_task_manager));
   if (worker_pool->Initialize(params.thread_priority(),
                               params.max_threads(),
@@ -314,6 +373,22 @@ scoped_refptr<TaskRunner> SchedulerWorkerPoolImpl::CreateTaskRunnerWithTraits(
 void SchedulerWorkerPoolImpl::ReEnqueueSequence(
     scoped_refptr<Sequence> sequence,
     const SequenceSortKey& sequence_sort_key) {
+  if (IsWorkStealingEnabled()) {
+    // A Sequence re-enqueued by a worker of this pool stays in that worker's
+    // local PriorityQueue. Other workers can steal it if they become idle.
+    SchedulerWorkerDelegateImpl* const current_delegate =
+        GetCurrentThreadWorkerDelegate();
+    if (current_delegate) {
+      current_delegate->PushToLocalPriorityQueue(std::move(sequence),
+                                                 sequence_sort_key);
+      return;
+    }
+    GetDelegateForExternalSequence()->PushToLocalPriorityQueue(
+        std::move(sequence), sequence_sort_key);
+    WakeUpOneWorker();
+    return;
+  }
+
   shared_priority_queue_.BeginTransaction()->Push(std::move(sequence),
                                                   sequence_sort_key);
 
@@ -362,6 +437,25 @@ void SchedulerWorkerPoolImpl::PostTaskWithSequenceNow(
   // in the past).
   DCHECK_LE(task->delayed_run_time, delayed_task_manager_->Now());
 
+  const bool sequence_was_empty = sequence->PushTask(std::move(task));
+
+  if (!worker && IsWorkStealingEnabled()) {
+    if (sequence_was_empty) {
+      // Keep Sequences posted from a worker of this pool close to that worker.
+      // Spread Sequences posted from other threads across all workers. In both
+      // cases, wake up a worker which will steal |sequence| if the worker that
+      // owns the local PriorityQueue is busy.
+      SchedulerWorkerDelegateImpl* delegate = GetCurrentThreadWorkerDelegate();
+      if (!delegate)
+        delegate = GetDelegateForExternalSequence();
+      const auto sequence_sort_key = sequence->GetSortKey();
+      delegate->PushToLocalPriorityQueue(std::move(sequence),
+                                         sequence_sort_key);
+      WakeUpOneWorker();
+    }
+    return;
+  }
+
   // Because |worker| belongs to this worker pool, we know that the type
   // of its delegate is SchedulerWorkerDelegateImpl.
   PriorityQueue* const priority_queue =
@@ -371,7 +465,6 @@ void SchedulerWorkerPoolImpl::PostTaskWithSequenceNow(
           : &shared_priority_queue_;
   DCHECK(priority_queue);
 
-  const bool sequence_was_empty = sequence->PushTask(std::move(task));
   if (sequence_was_empty) {
     // Insert |sequence| in |priority_queue| if it was empty before |task| was
     // inserted into it. Otherwise, one of these must be true:
@@ -418,7 +511,9 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
         int index)
     : outer_(outer),
       re_enqueue_sequence_callback_(re_enqueue_sequence_callback),
-      single_threaded_priority_queue_(shared_priority_queue),
+      single_threaded_priority_queue_(outer->IsWorkStealingEnabled()
+                                          ? &local_priority_queue_
+                                          : shared_priority_queue),
       index_(index) {}
 
 SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
@@ -454,6 +549,9 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
     SchedulerWorker* worker) {
   DCHECK(ContainsWorker(outer_->workers_, worker));
 
+  if (outer_->IsWorkStealingEnabled())
+    return GetWorkWithStealing(worker);
+
   scoped_refptr<Sequence> sequence;
   {
     std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
@@ -509,6 +607,149 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
   return sequence;
 }
 
+void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    PushToLocalPriorityQueue(scoped_refptr<Sequence> sequence,
+                             const SequenceSortKey& sequence_sort_key) {
+  DCHECK(outer_->IsWorkStealingEnabled());
+  std::unique_ptr<PriorityQueue::Transaction> transaction(
+      local_priority_queue_.BeginTransaction());
+  transaction->Push(std::move(sequence), sequence_sort_key);
+  PublishTopPriority(*transaction, &local_top_priority_);
+}
+
+scoped_refptr<Sequence> SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    StealFromLocalPriorityQueue() {
+  DCHECK(outer_->IsWorkStealingEnabled());
+  std::unique_ptr<PriorityQueue::Transaction> transaction(
+      local_priority_queue_.BeginTransaction());
+  if (transaction->IsEmpty())
+    return nullptr;
+  scoped_refptr<Sequence> sequence = transaction->PopSequence();
+  PublishTopPriority(*transaction, &local_top_priority_);
+  return sequence;
+}
+
+scoped_refptr<Sequence>
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWorkWithStealing(
+    SchedulerWorker* worker) {
+  scoped_refptr<Sequence> sequence = GetLocalOrStolenSequence();
+  if (!sequence) {
+    // |worker| is added to |idle_workers_stack_| before looking for work one
+    // last time to avoid this race:
+    // 1. This thread finds all PriorityQueues empty.
+    // 2. Other thread inserts a Sequence into a local PriorityQueue and calls
+    //    WakeUpOneWorker(). No thread is woken up because
+    //    |idle_workers_stack_| is empty.
+    // 3. This thread adds itself to |idle_workers_stack_| and goes to sleep.
+    //    No thread runs the Sequence inserted in step 2.
+    // With this ordering, either the last look below finds the Sequence or
+    // step 2 wakes up |worker|.
+    outer_->AddToIdleWorkersStack(worker);
+    sequence = GetLocalOrStolenSequence();
+    if (!sequence) {
+      if (idle_start_time_.is_null())
+        idle_start_time_ = TimeTicks::Now();
+      return nullptr;
+    }
+  }
+
+  idle_start_time_ = TimeTicks();
+
+  outer_->RemoveFromIdleWorkersStack(worker);
+  return sequence;
+}
+
+scoped_refptr<Sequence> SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    GetLocalOrStolenSequence() {
+  // Find the other worker whose local PriorityQueue holds the most important
+  // Sequence. Published priorities are read without locks: TaskPriority
+  // ordering across workers is best-effort while SequenceSortKey ordering
+  // within a PriorityQueue is strict.
+  const size_t num_workers = outer_->NumWorkersForWorkStealing();
+  const size_t own_index = static_cast<size_t>(index_);
+  int best_victim_priority = kNoPriority;
+  size_t best_victim_index = own_index;
+  for (size_t i = 1; i <= num_workers; ++i) {
+    const size_t victim_index = (own_index + i) % num_workers;
+    if (victim_index == own_index)
+      continue;
+    const int victim_priority =
+        outer_->GetWorkerDelegate(victim_index)->GetLocalTopPriority();
+    if (victim_priority > best_victim_priority) {
+      best_victim_priority = victim_priority;
+      best_victim_index = victim_index;
+    }
+  }
+
+  // Prefer work that belongs to this worker unless another worker holds a
+  // Sequence of strictly higher priority.
+  scoped_refptr<Sequence> sequence = PopLocalSequence(best_victim_priority);
+  if (sequence)
+    return sequence;
+
+  if (best_victim_priority != kNoPriority) {
+    sequence = outer_->GetWorkerDelegate(best_victim_index)
+                   ->StealFromLocalPriorityQueue();
+    if (sequence) {
+      last_sequence_is_single_threaded_ = false;
+      return sequence;
+    }
+
+    // The Sequence was taken by another worker. Steal from any worker that
+    // still has work.
+    for (size_t i = 1; i <= num_workers; ++i) {
+      const size_t victim_index = (own_index + i) % num_workers;
+      if (victim_index == own_index)
+        continue;
+      SchedulerWorkerDelegateImpl* const victim =
+          outer_->GetWorkerDelegate(victim_index);
+      if (victim->GetLocalTopPriority() == kNoPriority)
+        continue;
+      sequence = victim->StealFromLocalPriorityQueue();
+      if (sequence) {
+        last_sequence_is_single_threaded_ = false;
+        return sequence;
+      }
+    }
+  }
+
+  return PopLocalSequence(kNoPriority);
+}
+
+scoped_refptr<Sequence>
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::PopLocalSequence(
+    int min_priority) {
+  std::unique_ptr<PriorityQueue::Transaction> local_transaction(
+      local_priority_queue_.BeginTransaction());
+  std::unique_ptr<PriorityQueue::Transaction> single_threaded_transaction(
+      single_threaded_priority_queue_.BeginTransaction());
+
+  if (local_transaction->IsEmpty() && single_threaded_transaction->IsEmpty())
+    return nullptr;
+
+  const bool local_sequence_is_more_important =
+      !local_transaction->IsEmpty() &&
+      (single_threaded_transaction->IsEmpty() ||
+       local_transaction->PeekSortKey() >
+           single_threaded_transaction->PeekSortKey());
+  const SequenceSortKey& sort_key =
+      local_sequence_is_more_important
+          ? local_transaction->PeekSortKey()
+          : single_threaded_transaction->PeekSortKey();
+  if (static_cast<int>(sort_key.priority()) < min_priority)
+    return nullptr;
+
+  if (!local_sequence_is_more_important) {
+    last_sequence_is_single_threaded_ = true;
+    return single_threaded_transaction->PopSequence();
+  }
+
+  last_sequence_is_single_threaded_ = false;
+  scoped_refptr<Sequence> sequence = local_transaction->PopSequence();
+  PublishTopPriority(*local_transaction, &local_top_priority_);
+  return sequence;
+}
+
 void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
     ReEnqueueSequence(scoped_refptr<Sequence> sequence) {
   if (last_sequence_is_single_threaded_) {
@@ -548,9 +789,11 @@ SchedulerWorkerPoolImpl::SchedulerWorkerPoolImpl(
     StringPiece name,
     SchedulerWorkerPoolParams::IORestriction io_restriction,
     const TimeDelta& suggested_reclaim_time,
+    SchedulerWorkerPoolParams::SequenceDispatchMode sequence_dispatch_mode,
     TaskTracker* task_tracker,
     DelayedTaskManager* delayed_task_manager)
     : name_(name.as_string()),
+      sequence_dispatch_mode_(sequence_dispatch_mode),
       io_restriction_(io_restriction),
       suggested_reclaim_time_(suggested_reclaim_time),
       idle_workers_stack_lock_(shared_priority_queue_.container_lock()),
@@ -576,6 +819,10 @@ bool SchedulerWorkerPoolImpl::Initialize(
 
   DCHECK(workers_.empty());
 
+  // Workers may access |workers_| to steal work while it is being filled.
+  // Reserving its storage ensures that it is never reallocated.
+  workers_.reserve(max_threads);
+
   for (size_t i = 0; i < max_threads; ++i) {
     std::unique_ptr<SchedulerWorker> worker =
         SchedulerWorker::Create(
@@ -590,6 +837,8 @@ bool SchedulerWorkerPoolImpl::Initialize(
       break;
     idle_workers_stack_.Push(worker.get());
     workers_.push_back(std::move(worker));
+    subtle::Release_Store(&num_workers_created_,
+                          static_cast<subtle::AtomicWord>(workers_.size()));
   }
 
 #if DCHECK_IS_ON()
@@ -640,5 +889,36 @@ bool SchedulerWorkerPoolImpl::CanWorkerDetachForTesting() {
   return !worker_detachment_disallowed_.IsSet();
 }
 
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl*
+SchedulerWorkerPoolImpl::GetCurrentThreadWorkerDelegate() const {
+  if (tls_current_worker_pool.Get().Get() != this)
+    return nullptr;
+  SchedulerWorker* const worker = tls_current_worker.Get().Get();
+  DCHECK(worker);
+  return static_cast<SchedulerWorkerDelegateImpl*>(worker->delegate());
+}
+
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl*
+SchedulerWorkerPoolImpl::GetWorkerDelegate(size_t index) const {
+  DCHECK_LT(index, NumWorkersForWorkStealing());
+  // Because all workers belong to this worker pool, we know that the type of
+  // their delegate is SchedulerWorkerDelegateImpl.
+  return static_cast<SchedulerWorkerDelegateImpl*>(
+      workers_[index]->delegate());
+}
+
+size_t SchedulerWorkerPoolImpl::NumWorkersForWorkStealing() const {
+  return static_cast<size_t>(subtle::Acquire_Load(&num_workers_created_));
+}
+
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl*
+SchedulerWorkerPoolImpl::GetDelegateForExternalSequence() {
+  const size_t num_workers = NumWorkersForWorkStealing();
+  DCHECK_GT(num_workers, 0U);
+  const uint32_t index = static_cast<uint32_t>(
+      subtle::NoBarrier_AtomicIncrement(&next_local_queue_index_, 1));
+  return GetWorkerDelegate(index % num_workers);
+}
+
 }  // namespace internal
 }  // namespace base
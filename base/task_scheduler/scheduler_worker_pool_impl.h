@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/callback.h"
 #include "base/logging.h"
@@ -100,6 +101,8 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
                           SchedulerWorkerPoolParams::IORestriction
                               io_restriction,
                           const TimeDelta& suggested_reclaim_time,
+                          SchedulerWorkerPoolParams::SequenceDispatchMode
+                              sequence_dispatch_mode,
                           TaskTracker* task_tracker,
                           DelayedTaskManager* delayed_task_manager);
 
@@ -123,6 +126,28 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // Returns true if worker thread detachment is permitted.
   bool CanWorkerDetachForTesting();
 
+  // Returns true if Sequences are dispatched to per-worker PriorityQueues.
+  bool IsWorkStealingEnabled() const {
+    return sequence_dispatch_mode_ ==
+           SchedulerWorkerPoolParams::SequenceDispatchMode::WORK_STEALING;
+  }
+
+  // Returns the delegate of the worker that runs on the current thread if it
+  // belongs to this worker pool, nullptr otherwise.
+  SchedulerWorkerDelegateImpl* GetCurrentThreadWorkerDelegate() const;
+
+  // Returns the delegate of the worker at |index| in |workers_|. |index| must
+  // be smaller than NumWorkersForWorkStealing().
+  SchedulerWorkerDelegateImpl* GetWorkerDelegate(size_t index) const;
+
+  // Returns the number of workers whose local PriorityQueue can be accessed
+  // by other workers. Can be called while Initialize() is filling |workers_|.
+  size_t NumWorkersForWorkStealing() const;
+
+  // Returns the delegate whose local PriorityQueue should receive a Sequence
+  // posted from a thread that doesn't belong to this worker pool.
+  SchedulerWorkerDelegateImpl* GetDelegateForExternalSequence();
+
   // The name of this worker pool, used to label its worker threads.
   const std::string name_;
 
@@ -137,9 +162,23 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // TaskRunner returned by this pool.
   size_t next_worker_index_ = 0;
 
-  // PriorityQueue from which all threads of this worker pool get work.
+  // PriorityQueue from which all threads of this worker pool get work. Unused
+  // when work stealing is enabled.
   PriorityQueue shared_priority_queue_;
 
+  // Indicates how Sequences are dispatched to the workers of this pool.
+  const SchedulerWorkerPoolParams::SequenceDispatchMode sequence_dispatch_mode_;
+
+  // Number of elements of |workers_| that are fully constructed. Written with
+  // release semantics by Initialize() so that workers can steal from each
+  // other before all workers have been created. |workers_| never reallocates
+  // its storage after Initialize() has reserved it.
+  subtle::AtomicWord num_workers_created_ = 0;
+
+  // Incremented every time a Sequence posted from outside this pool is
+  // dispatched to a worker's local PriorityQueue, to spread them evenly.
+  subtle::Atomic32 next_local_queue_index_ = 0;
+
   // Indicates whether Tasks on this worker pool are allowed to make I/O calls.
   const SchedulerWorkerPoolParams::IORestriction io_restriction_;
 
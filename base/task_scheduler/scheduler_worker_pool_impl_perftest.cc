@@ -0,0 +1,211 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_scheduler/scheduler_worker_pool_impl.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/format_macros.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/task_runner.h"
+#include "base/task_scheduler/delayed_task_manager.h"
+#include "base/task_scheduler/scheduler_worker_pool_params.h"
+#include "base/task_scheduler/sequence.h"
+#include "base/task_scheduler/sequence_sort_key.h"
+#include "base/task_scheduler/task_tracker.h"
+#include "base/task_scheduler/task_traits.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+using SequenceDispatchMode = SchedulerWorkerPoolParams::SequenceDispatchMode;
+
+constexpr size_t kNumPostingThreads = 4;
+constexpr size_t kNumTasksPerPostingThread = 25000;
+
+// Measures the throughput and the post-to-run latency of a
+// SchedulerWorkerPoolImpl under bursts of short PARALLEL tasks.
+class TaskSchedulerWorkerPoolPerfTest : public testing::Test {
+ public:
+  enum class PostingPattern {
+    // Tasks are posted by threads that don't belong to the pool.
+    EXTERNAL_THREADS,
+    // Each external thread posts one task which posts all other tasks from a
+    // worker of the pool.
+    FAN_OUT,
+  };
+
+ protected:
+  TaskSchedulerWorkerPoolPerfTest()
+      : delayed_task_manager_(Bind(&DoNothing)),
+        all_tasks_ran_(WaitableEvent::ResetPolicy::MANUAL,
+                       WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  void RunTest(SequenceDispatchMode sequence_dispatch_mode,
+               PostingPattern posting_pattern) {
+    const size_t num_workers = SysInfo::NumberOfProcessors();
+    worker_pool_ = SchedulerWorkerPoolImpl::Create(
+        SchedulerWorkerPoolParams("PerfTestWorkerPool", ThreadPriority::NORMAL,
+                                  SchedulerWorkerPoolParams::IORestriction::
+                                      DISALLOWED,
+                                  num_workers, TimeDelta::Max(),
+                                  sequence_dispatch_mode),
+        Bind(&TaskSchedulerWorkerPoolPerfTest::ReEnqueueSequenceCallback,
+             Unretained(this)),
+        &task_tracker_, &delayed_task_manager_);
+    ASSERT_TRUE(worker_pool_);
+    worker_pool_->DisallowWorkerDetachmentForTesting();
+    task_runner_ = worker_pool_->CreateTaskRunnerWithTraits(
+        TaskTraits(), ExecutionMode::PARALLEL);
+
+    num_tasks_ = kNumPostingThreads * kNumTasksPerPostingThread;
+    latencies_.reset(new TimeDelta[num_tasks_]);
+
+    std::vector<std::unique_ptr<DelegateSimpleThread>> posting_threads;
+    std::vector<std::unique_ptr<PostingDelegate>> posting_delegates;
+    for (size_t i = 0; i < kNumPostingThreads; ++i) {
+      posting_delegates.push_back(
+          WrapUnique(new PostingDelegate(this, i, posting_pattern)));
+      posting_threads.push_back(WrapUnique(new DelegateSimpleThread(
+          posting_delegates.back().get(), "PostingThread")));
+    }
+
+    const TimeTicks start = TimeTicks::Now();
+    for (const auto& posting_thread : posting_threads)
+      posting_thread->Start();
+    for (const auto& posting_thread : posting_threads)
+      posting_thread->Join();
+    all_tasks_ran_.Wait();
+    const TimeDelta total_time = TimeTicks::Now() - start;
+
+    worker_pool_->WaitForAllWorkersIdleForTesting();
+    worker_pool_->JoinForTesting();
+
+    std::sort(latencies_.get(), latencies_.get() + num_tasks_);
+    const std::string trace = StringPrintf(
+        "%s_%s_%" PRIuS "_workers",
+        sequence_dispatch_mode == SequenceDispatchMode::WORK_STEALING
+            ? "work_stealing"
+            : "shared_priority_queue",
+        posting_pattern == PostingPattern::FAN_OUT ? "fan_out"
+                                                   : "external_threads",
+        num_workers);
+    perf_test::PrintResult("task_scheduler_throughput", "", trace,
+                           num_tasks_ / total_time.InSecondsF(), "tasks/s",
+                           true);
+    perf_test::PrintResult(
+        "task_scheduler_post_to_run_latency", "_p50", trace,
+        static_cast<double>(latencies_[num_tasks_ / 2].InMicroseconds()), "us",
+        true);
+    perf_test::PrintResult(
+        "task_scheduler_post_to_run_latency", "_p99", trace,
+        static_cast<double>(latencies_[num_tasks_ * 99 / 100].InMicroseconds()),
+        "us", true);
+  }
+
+ private:
+  class PostingDelegate : public DelegateSimpleThread::Delegate {
+   public:
+    PostingDelegate(TaskSchedulerWorkerPoolPerfTest* outer,
+                    size_t index,
+                    PostingPattern posting_pattern)
+        : outer_(outer), index_(index), posting_pattern_(posting_pattern) {}
+
+    void Run() override {
+      const size_t first_task_index = index_ * kNumTasksPerPostingThread;
+      if (posting_pattern_ == PostingPattern::FAN_OUT) {
+        outer_->task_runner_->PostTask(
+            FROM_HERE, Bind(&TaskSchedulerWorkerPoolPerfTest::PostTasks,
+                            Unretained(outer_), first_task_index));
+      } else {
+        outer_->PostTasks(first_task_index);
+      }
+    }
+
+   private:
+    TaskSchedulerWorkerPoolPerfTest* const outer_;
+    const size_t index_;
+    const PostingPattern posting_pattern_;
+
+    DISALLOW_COPY_AND_ASSIGN(PostingDelegate);
+  };
+
+  void PostTasks(size_t first_task_index) {
+    for (size_t i = 0; i < kNumTasksPerPostingThread; ++i) {
+      task_runner_->PostTask(
+          FROM_HERE, Bind(&TaskSchedulerWorkerPoolPerfTest::RecordLatency,
+                          Unretained(this), first_task_index + i,
+                          TimeTicks::Now()));
+    }
+  }
+
+  void RecordLatency(size_t task_index, TimeTicks posted_time) {
+    latencies_[task_index] = TimeTicks::Now() - posted_time;
+    if (static_cast<size_t>(subtle::Barrier_AtomicIncrement(
+            &num_tasks_ran_, 1)) == num_tasks_) {
+      all_tasks_ran_.Signal();
+    }
+  }
+
+  void ReEnqueueSequenceCallback(scoped_refptr<Sequence> sequence) {
+    const SequenceSortKey sort_key(sequence->GetSortKey());
+    worker_pool_->ReEnqueueSequence(std::move(sequence), sort_key);
+  }
+
+  TaskTracker task_tracker_;
+  DelayedTaskManager delayed_task_manager_;
+  std::unique_ptr<SchedulerWorkerPoolImpl> worker_pool_;
+  scoped_refptr<TaskRunner> task_runner_;
+
+  size_t num_tasks_ = 0;
+  std::unique_ptr<TimeDelta[]> latencies_;
+  subtle::Atomic32 num_tasks_ran_ = 0;
+  WaitableEvent all_tasks_ran_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerWorkerPoolPerfTest);
+};
+
+using PostingPattern = TaskSchedulerWorkerPoolPerfTest::PostingPattern;
+
+}  // namespace
+
+TEST_F(TaskSchedulerWorkerPoolPerfTest, SharedPriorityQueueExternalThreads) {
+  RunTest(SequenceDispatchMode::SHARED_PRIORITY_QUEUE,
+          PostingPattern::EXTERNAL_THREADS);
+}
+
+TEST_F(TaskSchedulerWorkerPoolPerfTest, WorkStealingExternalThreads) {
+  RunTest(SequenceDispatchMode::WORK_STEALING,
+          PostingPattern::EXTERNAL_THREADS);
+}
+
+TEST_F(TaskSchedulerWorkerPoolPerfTest, SharedPriorityQueueFanOut) {
+  RunTest(SequenceDispatchMode::SHARED_PRIORITY_QUEUE, PostingPattern::FAN_OUT);
+}
+
+TEST_F(TaskSchedulerWorkerPoolPerfTest, WorkStealingFanOut) {
+  RunTest(SequenceDispatchMode::WORK_STEALING, PostingPattern::FAN_OUT);
+}
+
+}  // namespace internal
+}  // namespace base
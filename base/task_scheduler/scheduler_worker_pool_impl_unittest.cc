@@ -26,6 +26,7 @@
 #include "base/task_scheduler/sequence.h"
 #include "base/task_scheduler/sequence_sort_key.h"
 #include "base/task_scheduler/task_tracker.h"
+#include "base/task_scheduler/task_traits.h"
 #include "base/task_scheduler/test_task_factory.h"
 #include "base/test/gtest_util.h"
 #include "base/threading/platform_thread.h"
@@ -47,6 +48,7 @@ constexpr TimeDelta kReclaimTimeForDetachTests =
     TimeDelta::FromMilliseconds(10);
 
 using IORestriction = SchedulerWorkerPoolParams::IORestriction;
+using SequenceDispatchMode = SchedulerWorkerPoolParams::SequenceDispatchMode;
 
 class TestDelayedTaskManager : public DelayedTaskManager {
  public:
@@ -77,13 +79,16 @@ class TaskSchedulerWorkerPoolImplTest
     worker_pool_->JoinForTesting();
   }
 
-  void InitializeWorkerPool(const TimeDelta& suggested_reclaim_time) {
+  void InitializeWorkerPool(const TimeDelta& suggested_reclaim_time,
+                            SequenceDispatchMode sequence_dispatch_mode =
+                                SequenceDispatchMode::SHARED_PRIORITY_QUEUE) {
     worker_pool_ = SchedulerWorkerPoolImpl::Create(
         SchedulerWorkerPoolParams("TestWorkerPoolWithFileIO",
                                   ThreadPriority::NORMAL,
                                   IORestriction::ALLOWED,
                                   kNumWorkersInWorkerPool,
-                                  suggested_reclaim_time),
+                                  suggested_reclaim_time,
+                                  sequence_dispatch_mode),
         Bind(&TaskSchedulerWorkerPoolImplTest::ReEnqueueSequenceCallback,
              Unretained(this)),
         &task_tracker_, &delayed_task_manager_);
@@ -339,6 +344,201 @@ INSTANTIATE_TEST_CASE_P(SingleThreaded,
 
 namespace {
 
+class TaskSchedulerWorkerPoolWorkStealingTest
+    : public TaskSchedulerWorkerPoolImplTest {
+ protected:
+  TaskSchedulerWorkerPoolWorkStealingTest() = default;
+
+  void SetUp() override {
+    InitializeWorkerPool(TimeDelta::Max(), SequenceDispatchMode::WORK_STEALING);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerWorkerPoolWorkStealingTest);
+};
+
+// Increments |num_running_tasks| and waits until |num_expected_tasks| tasks
+// have done the same.
+void WaitForOtherStolenTasks(subtle::Atomic32* num_running_tasks,
+                             subtle::Atomic32 num_expected_tasks,
+                             WaitableEvent* all_tasks_running) {
+  if (subtle::Barrier_AtomicIncrement(num_running_tasks, 1) ==
+      num_expected_tasks) {
+    all_tasks_running->Signal();
+  }
+  all_tasks_running->Wait();
+}
+
+// Posts |num_tasks| tasks to |task_runner| from a worker of the pool, then
+// blocks that worker until all of them run.
+void PostTasksAndBlock(scoped_refptr<TaskRunner> task_runner,
+                       size_t num_tasks,
+                       subtle::Atomic32* num_running_tasks,
+                       WaitableEvent* all_tasks_running) {
+  for (size_t i = 0; i < num_tasks; ++i) {
+    task_runner->PostTask(
+        FROM_HERE, Bind(&WaitForOtherStolenTasks, num_running_tasks,
+                        static_cast<subtle::Atomic32>(num_tasks),
+                        all_tasks_running));
+  }
+  all_tasks_running->Wait();
+}
+
+// Number of Tasks posted at each TaskPriority by the workers that are stolen
+// from in StealingRespectsTaskPriority.
+const size_t kNumTasksPerStolenPriority = 8;
+
+// State shared by the Tasks of StealingRespectsTaskPriority.
+class StealingPriorityTestState {
+ public:
+  // The first worker to start posts USER_BLOCKING Tasks if
+  // |user_blocking_posted_first| is true and BACKGROUND Tasks otherwise. The
+  // second worker posts the other kind.
+  explicit StealingPriorityTestState(bool user_blocking_posted_first)
+      : user_blocking_rank_(user_blocking_posted_first ? 1 : 2),
+        num_started_workers_(0),
+        num_posting_workers_(0),
+        all_workers_started_(WaitableEvent::ResetPolicy::MANUAL,
+                             WaitableEvent::InitialState::NOT_SIGNALED),
+        tasks_posted_(WaitableEvent::ResetPolicy::MANUAL,
+                      WaitableEvent::InitialState::NOT_SIGNALED),
+        all_tasks_ran_(WaitableEvent::ResetPolicy::MANUAL,
+                       WaitableEvent::InitialState::NOT_SIGNALED),
+        release_workers_(WaitableEvent::ResetPolicy::MANUAL,
+                         WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  // Runs on every worker of the pool. Once all workers are running this, the
+  // first two post Tasks of a different TaskPriority to their local
+  // PriorityQueue and block, the third returns to steal these Tasks and the
+  // others block.
+  void OccupyWorker(scoped_refptr<TaskRunner> background_task_runner,
+                    scoped_refptr<TaskRunner> user_blocking_task_runner) {
+    const subtle::Atomic32 worker_rank =
+        subtle::Barrier_AtomicIncrement(&num_started_workers_, 1);
+    if (worker_rank == static_cast<subtle::Atomic32>(kNumWorkersInWorkerPool))
+      all_workers_started_.Signal();
+    all_workers_started_.Wait();
+
+    if (worker_rank == 1 || worker_rank == 2) {
+      const bool post_user_blocking = worker_rank == user_blocking_rank_;
+      scoped_refptr<TaskRunner> task_runner = post_user_blocking
+                                                  ? user_blocking_task_runner
+                                                  : background_task_runner;
+      const TaskPriority priority = post_user_blocking
+                                        ? TaskPriority::USER_BLOCKING
+                                        : TaskPriority::BACKGROUND;
+      for (size_t i = 0; i < kNumTasksPerStolenPriority; ++i) {
+        task_runner->PostTask(
+            FROM_HERE, Bind(&StealingPriorityTestState::RunStolenTask,
+                            Unretained(this), priority));
+      }
+      if (subtle::Barrier_AtomicIncrement(&num_posting_workers_, 1) == 2)
+        tasks_posted_.Signal();
+    } else if (worker_rank == 3) {
+      tasks_posted_.Wait();
+      return;
+    }
+    release_workers_.Wait();
+  }
+
+  // Waits until all stolen Tasks have run and returns the TaskPriority of
+  // each, in the order in which they ran.
+  std::vector<TaskPriority> WaitForStolenTasks() {
+    all_tasks_ran_.Wait();
+    AutoLock auto_lock(lock_);
+    return run_priorities_;
+  }
+
+  void ReleaseWorkers() { release_workers_.Signal(); }
+
+ private:
+  void RunStolenTask(TaskPriority priority) {
+    AutoLock auto_lock(lock_);
+    run_priorities_.push_back(priority);
+    if (run_priorities_.size() == 2 * kNumTasksPerStolenPriority)
+      all_tasks_ran_.Signal();
+  }
+
+  const subtle::Atomic32 user_blocking_rank_;
+  subtle::Atomic32 num_started_workers_;
+  subtle::Atomic32 num_posting_workers_;
+  WaitableEvent all_workers_started_;
+  WaitableEvent tasks_posted_;
+  WaitableEvent all_tasks_ran_;
+  WaitableEvent release_workers_;
+
+  Lock lock_;
+  std::vector<TaskPriority> run_priorities_;
+
+  DISALLOW_COPY_AND_ASSIGN(StealingPriorityTestState);
+};
+
+}  // namespace
+
+// Verify that Sequences posted by a busy worker to its local PriorityQueue are
+// stolen by the other workers of the pool. The worker that posts the tasks
+// blocks until they all run concurrently, which is only possible if every
+// other worker steals one of them.
+TEST_F(TaskSchedulerWorkerPoolWorkStealingTest,
+       IdleWorkersStealFromBusyWorker) {
+  subtle::Atomic32 num_running_tasks = 0;
+  WaitableEvent all_tasks_running(WaitableEvent::ResetPolicy::MANUAL,
+                                  WaitableEvent::InitialState::NOT_SIGNALED);
+  auto task_runner = worker_pool_->CreateTaskRunnerWithTraits(
+      TaskTraits(), ExecutionMode::PARALLEL);
+  task_runner->PostTask(
+      FROM_HERE, Bind(&PostTasksAndBlock, task_runner,
+                      kNumWorkersInWorkerPool - 1,
+                      Unretained(&num_running_tasks),
+                      Unretained(&all_tasks_running)));
+
+  all_tasks_running.Wait();
+  worker_pool_->WaitForAllWorkersIdleForTesting();
+  EXPECT_EQ(static_cast<subtle::Atomic32>(kNumWorkersInWorkerPool - 1),
+            subtle::NoBarrier_Load(&num_running_tasks));
+}
+
+// Verify that a worker that runs out of work steals from the worker whose
+// local PriorityQueue holds the most important Sequence. One worker posts
+// BACKGROUND Tasks and another posts USER_BLOCKING Tasks before a third worker
+// becomes idle and steals them all: the USER_BLOCKING Tasks must run first,
+// whichever of the two workers the thief looks at first.
+TEST_F(TaskSchedulerWorkerPoolWorkStealingTest, StealingRespectsTaskPriority) {
+  auto background_task_runner = worker_pool_->CreateTaskRunnerWithTraits(
+      TaskTraits().WithPriority(TaskPriority::BACKGROUND),
+      ExecutionMode::PARALLEL);
+  auto user_blocking_task_runner = worker_pool_->CreateTaskRunnerWithTraits(
+      TaskTraits().WithPriority(TaskPriority::USER_BLOCKING),
+      ExecutionMode::PARALLEL);
+  auto task_runner = worker_pool_->CreateTaskRunnerWithTraits(
+      TaskTraits(), ExecutionMode::PARALLEL);
+
+  for (bool user_blocking_posted_first : {false, true}) {
+    StealingPriorityTestState state(user_blocking_posted_first);
+    for (size_t i = 0; i < kNumWorkersInWorkerPool; ++i) {
+      task_runner->PostTask(
+          FROM_HERE, Bind(&StealingPriorityTestState::OccupyWorker,
+                          Unretained(&state), background_task_runner,
+                          user_blocking_task_runner));
+    }
+
+    const std::vector<TaskPriority> run_priorities =
+        state.WaitForStolenTasks();
+    ASSERT_EQ(2 * kNumTasksPerStolenPriority, run_priorities.size());
+    for (size_t i = 0; i < run_priorities.size(); ++i) {
+      EXPECT_EQ(i < kNumTasksPerStolenPriority ? TaskPriority::USER_BLOCKING
+                                               : TaskPriority::BACKGROUND,
+                run_priorities[i])
+          << i;
+    }
+
+    state.ReleaseWorkers();
+    worker_pool_->WaitForAllWorkersIdleForTesting();
+  }
+}
+
+namespace {
+
 void NotReachedReEnqueueSequenceCallback(scoped_refptr<Sequence> sequence) {
   ADD_FAILURE()
       << "Unexpected invocation of NotReachedReEnqueueSequenceCallback.";
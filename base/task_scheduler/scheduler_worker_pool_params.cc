@@ -13,12 +13,14 @@ SchedulerWorkerPoolParams::SchedulerWorkerPoolParams(
     ThreadPriority thread_priority,
     IORestriction io_restriction,
     int max_threads,
-    const TimeDelta& suggested_reclaim_time)
+    const TimeDelta& suggested_reclaim_time,
+    SequenceDispatchMode sequence_dispatch_mode)
     : name_(name),
       thread_priority_(thread_priority),
       io_restriction_(io_restriction),
       max_threads_(max_threads),
-      suggested_reclaim_time_(suggested_reclaim_time) {}
+      suggested_reclaim_time_(suggested_reclaim_time),
+      sequence_dispatch_mode_(sequence_dispatch_mode) {}
 
 SchedulerWorkerPoolParams::SchedulerWorkerPoolParams(
     SchedulerWorkerPoolParams&& other) = default;
@@ -21,19 +21,31 @@ class BASE_EXPORT SchedulerWorkerPoolParams final {
     DISALLOWED,
   };
 
+  enum class SequenceDispatchMode {
+    // All workers get Sequences from a single PriorityQueue shared by the
+    // pool.
+    SHARED_PRIORITY_QUEUE,
+    // Each worker gets Sequences from its own PriorityQueue and idle workers
+    // steal Sequences from the PriorityQueues of busy workers.
+    WORK_STEALING,
+  };
+
   // Construct a scheduler worker pool parameter object that instructs a
   // scheduler worker pool to use the label |name| and create up to
   // |max_threads| threads of priority |thread_priority|. |io_restriction|
   // indicates whether Tasks on the scheduler worker pool are allowed to make
   // I/O calls. |suggested_reclaim_time| sets a suggestion on when to reclaim
   // idle threads. The worker pool is free to ignore this value for performance
-  // or correctness reasons.
+  // or correctness reasons. |sequence_dispatch_mode| indicates how Sequences
+  // are distributed to the pool's threads.
   SchedulerWorkerPoolParams(
       const std::string& name,
       ThreadPriority thread_priority,
       IORestriction io_restriction,
       int max_threads,
-      const TimeDelta& suggested_reclaim_time);
+      const TimeDelta& suggested_reclaim_time,
+      SequenceDispatchMode sequence_dispatch_mode =
+          SequenceDispatchMode::SHARED_PRIORITY_QUEUE);
   SchedulerWorkerPoolParams(SchedulerWorkerPoolParams&& other);
   SchedulerWorkerPoolParams& operator=(SchedulerWorkerPoolParams&& other);
 
@@ -54,12 +66,18 @@ class BASE_EXPORT SchedulerWorkerPoolParams final {
     return suggested_reclaim_time_;
   }
 
+  // How Sequences are distributed to the pool's threads.
+  SequenceDispatchMode sequence_dispatch_mode() const {
+    return sequence_dispatch_mode_;
+  }
+
  private:
   std::string name_;
   ThreadPriority thread_priority_;
   IORestriction io_restriction_;
   size_t max_threads_;
   TimeDelta suggested_reclaim_time_;
+  SequenceDispatchMode sequence_dispatch_mode_;
 
   DISALLOW_COPY_AND_ASSIGN(SchedulerWorkerPoolParams);
 };
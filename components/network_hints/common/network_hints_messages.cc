@@ -9,6 +9,12 @@
 
 namespace IPC {
 
+void ParamTraits<network_hints::LookupRequest>::GetSize(
+    base::PickleSizer* s,
+    const network_hints::LookupRequest& request) {
+  IPC::GetParamSize(s, request.hostname_list);
+}
+
 void ParamTraits<network_hints::LookupRequest>::Write(
     base::Pickle* m,
     const network_hints::LookupRequest& request) {
@@ -21,6 +21,7 @@ namespace IPC {
 template <>
 struct ParamTraits<network_hints::LookupRequest> {
   typedef network_hints::LookupRequest param_type;
+  static void GetSize(base::PickleSizer* s, const param_type& p);
   static void Write(base::Pickle* m, const param_type& p);
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
@@ -27,6 +27,9 @@ namespace IPC {
 template <>
 struct ParamTraits<content::WebCursor> {
   typedef content::WebCursor param_type;
+  static void GetSize(base::PickleSizer* s, const param_type& p) {
+    p.GetSerializedSize(s);
+  }
   static void Write(base::Pickle* m, const param_type& p) { p.Serialize(m); }
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
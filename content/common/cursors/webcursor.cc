@@ -132,6 +132,17 @@ bool WebCursor::Serialize(base::Pickle* pickle) const {
   return SerializePlatformData(pickle);
 }
 
+void WebCursor::GetSerializedSize(base::PickleSizer* sizer) const {
+  sizer->AddInt();
+  sizer->AddInt();
+  sizer->AddInt();
+  sizer->AddInt();
+  sizer->AddInt();
+  sizer->AddFloat();
+  sizer->AddData(static_cast<int>(custom_data_.size()));
+  // SerializePlatformData() doesn't write anything on any platform.
+}
+
 bool WebCursor::IsCustom() const {
   return type_ == WebCursorInfo::TypeCustom;
 }
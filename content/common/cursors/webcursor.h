@@ -34,6 +34,7 @@ class NSCursor;
 namespace base {
 class Pickle;
 class PickleIterator;
+class PickleSizer;
 }
 
 namespace content {
@@ -75,6 +76,7 @@ class CONTENT_EXPORT WebCursor {
   // Serialization / De-serialization
   bool Deserialize(base::PickleIterator* iter);
   bool Serialize(base::Pickle* pickle) const;
+  void GetSerializedSize(base::PickleSizer* sizer) const;
 
   // Returns true if GetCustomCursor should be used to allocate a platform
   // specific cursor object.  Otherwise GetCursor should be used.
@@ -33,6 +33,11 @@ void LogWebUCharString(
 
 namespace IPC {
 
+void ParamTraits<WebGamepad>::GetSize(base::PickleSizer* s,
+                                      const WebGamepad& p) {
+  s->AddData(sizeof(WebGamepad));
+}
+
 void ParamTraits<WebGamepad>::Write(base::Pickle* m, const WebGamepad& p) {
   m->WriteData(reinterpret_cast<const char*>(&p), sizeof(WebGamepad));
 }
@@ -23,6 +23,7 @@ class Message;
 template <>
 struct ParamTraits<blink::WebGamepad> {
   typedef blink::WebGamepad param_type;
+  static void GetSize(base::PickleSizer* s, const blink::WebGamepad& p);
   static void Write(base::Pickle* m, const blink::WebGamepad& p);
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
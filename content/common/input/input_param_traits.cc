@@ -64,6 +64,35 @@ void ParamTraits<content::ScopedWebInputEvent>::Log(const param_type& p,
   LogParam(static_cast<WebInputEventPointer>(p.get()), l);
 }
 
+void ParamTraits<content::SyntheticGesturePacket>::GetSize(
+    base::PickleSizer* s,
+    const param_type& p) {
+  DCHECK(p.gesture_params());
+  GetParamSize(s, p.gesture_params()->GetGestureType());
+  switch (p.gesture_params()->GetGestureType()) {
+    case content::SyntheticGestureParams::SMOOTH_SCROLL_GESTURE:
+      GetParamSize(s, *content::SyntheticSmoothScrollGestureParams::Cast(
+          p.gesture_params()));
+      break;
+    case content::SyntheticGestureParams::SMOOTH_DRAG_GESTURE:
+      GetParamSize(s, *content::SyntheticSmoothDragGestureParams::Cast(
+          p.gesture_params()));
+      break;
+    case content::SyntheticGestureParams::PINCH_GESTURE:
+      GetParamSize(s, *content::SyntheticPinchGestureParams::Cast(
+          p.gesture_params()));
+      break;
+    case content::SyntheticGestureParams::TAP_GESTURE:
+      GetParamSize(s, *content::SyntheticTapGestureParams::Cast(
+          p.gesture_params()));
+      break;
+    case content::SyntheticGestureParams::POINTER_ACTION:
+      GetParamSize(
+          s, *content::SyntheticPointerActionParams::Cast(p.gesture_params()));
+      break;
+  }
+}
+
 void ParamTraits<content::SyntheticGesturePacket>::Write(base::Pickle* m,
                                                          const param_type& p) {
   DCHECK(p.gesture_params());
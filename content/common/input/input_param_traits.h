@@ -29,6 +29,7 @@ struct CONTENT_EXPORT ParamTraits<content::ScopedWebInputEvent> {
 template<>
 struct CONTENT_EXPORT ParamTraits<content::SyntheticGesturePacket> {
   typedef content::SyntheticGesturePacket param_type;
+  static void GetSize(base::PickleSizer* s, const param_type& p);
   static void Write(base::Pickle* m, const param_type& p);
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
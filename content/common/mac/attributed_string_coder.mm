@@ -121,6 +121,13 @@ namespace IPC {
 
 using mac::AttributedStringCoder;
 
+void ParamTraits<AttributedStringCoder::EncodedString>::GetSize(
+    base::PickleSizer* s,
+    const param_type& p) {
+  GetParamSize(s, p.string());
+  GetParamSize(s, p.attributes());
+}
+
 void ParamTraits<AttributedStringCoder::EncodedString>::Write(
     base::Pickle* m,
     const param_type& p) {
@@ -147,6 +154,13 @@ void ParamTraits<AttributedStringCoder::EncodedString>::Log(
   l->append(base::UTF16ToUTF8(p.string()));
 }
 
+void ParamTraits<AttributedStringCoder::FontAttribute>::GetSize(
+    base::PickleSizer* s,
+    const param_type& p) {
+  GetParamSize(s, p.font_descriptor());
+  GetParamSize(s, p.effective_range());
+}
+
 void ParamTraits<AttributedStringCoder::FontAttribute>::Write(
     base::Pickle* m,
     const param_type& p) {
@@ -102,6 +102,13 @@ struct CONTENT_EXPORT ParamTraits<content::PageState> {
 template <>
 struct ParamTraits<gfx::NativeWindow> {
   typedef gfx::NativeWindow param_type;
+  static void GetSize(base::PickleSizer* s, const param_type& p) {
+#if defined(OS_WIN)
+    s->AddUInt32();
+#else
+    s->AddData(sizeof(p));
+#endif
+  }
   static void Write(base::Pickle* m, const param_type& p) {
 #if defined(OS_WIN)
     m->WriteUInt32(base::win::HandleToUint32(p));
@@ -20,6 +20,12 @@ HandleWin::HandleWin() : handle_(nullptr), permissions_(INVALID) {}
 HandleWin::HandleWin(const HANDLE& handle, Permissions permissions)
     : handle_(handle), permissions_(permissions) {}
 
+// static
+void ParamTraits<HandleWin>::GetSize(base::PickleSizer* sizer,
+                                     const param_type& p) {
+  sizer->AddAttachment();
+}
+
 // static
 void ParamTraits<HandleWin>::Write(base::Pickle* m, const param_type& p) {
   scoped_refptr<IPC::internal::HandleAttachmentWin> attachment(
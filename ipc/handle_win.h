@@ -57,6 +57,7 @@ class IPC_EXPORT HandleWin {
 template <>
 struct IPC_EXPORT ParamTraits<HandleWin> {
   typedef HandleWin param_type;
+  static void GetSize(base::PickleSizer* sizer, const param_type& p);
   static void Write(base::Pickle* m, const param_type& p);
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
@@ -401,65 +401,81 @@ bool ChannelPosix::ProcessOutgoingMessages() {
     return false;
 
   // Write out all the messages we can till the write blocks or there are no
-  // more outgoing messages.
+  // more outgoing messages. Each write gathers as many queued messages as fit
+  // in the budget.
   while (!output_queue_.empty()) {
-    OutputElement* element = output_queue_.front();
+    struct iovec iov[kMaxMessagesPerWrite];
+    Message* msg_with_fds = nullptr;
+    size_t num_elements = 0;
+    size_t amt_to_write = 0;
+    unsigned num_fds = 0;
+
+    while (num_elements < output_queue_.size() &&
+           num_elements < kMaxMessagesPerWrite) {
+      OutputElement* element = output_queue_[num_elements];
+      size_t offset = num_elements ? 0 : message_send_bytes_written_;
+      size_t size = element->size() - offset;
+      DCHECK_NE(0U, size);
+      if (num_elements && amt_to_write + size > kMaxBytesPerWrite)
+        break;
+
+      // Descriptors go out with the first byte of their message, so a message
+      // carrying descriptors starts a new write. Otherwise the descriptors
+      // would arrive with the bytes of the messages before it, and the reader
+      // fails the channel if a read ends on a message boundary while it still
+      // holds descriptors.
+      Message* msg = element->get_message();
+      if (msg && !offset &&
+          msg->attachment_set()->num_non_brokerable_attachments()) {
+        if (num_elements)
+          break;
+        num_fds = msg->attachment_set()->num_non_brokerable_attachments();
+        DCHECK_LE(num_fds, MessageAttachmentSet::kMaxDescriptorsPerMessage);
+        if (msg->attachment_set()->ContainsDirectoryDescriptor()) {
+          LOG(FATAL) << "Panic: attempting to transport directory descriptor "
+                        "over IPC. Aborting to maintain sandbox isolation.";
+          // If you have hit this then something tried to send a file
+          // descriptor to a directory over an IPC channel. Since IPC channels
+          // span sandboxes this is very bad: the receiving process can use
+          // openat with ".." elements in the path in order to reach the real
+          // filesystem.
+        }
+        // |num_fds| is at most kMaxDescriptorsPerMessage, so no danger of
+        // overflow.
+        msg->header()->num_fds = static_cast<uint16_t>(num_fds);
+        msg_with_fds = msg;
+      }
 
-    size_t amt_to_write = element->size() - message_send_bytes_written_;
-    DCHECK_NE(0U, amt_to_write);
-    const char* out_bytes = reinterpret_cast<const char*>(element->data()) +
-        message_send_bytes_written_;
+      iov[num_elements].iov_base = const_cast<char*>(
+          reinterpret_cast<const char*>(element->data()) + offset);
+      iov[num_elements].iov_len = size;
+      amt_to_write += size;
+      num_elements++;
+    }
 
     struct msghdr msgh = {0};
-    struct iovec iov = {const_cast<char*>(out_bytes), amt_to_write};
-    msgh.msg_iov = &iov;
-    msgh.msg_iovlen = 1;
+    msgh.msg_iov = iov;
+    msgh.msg_iovlen = num_elements;
     char buf[CMSG_SPACE(sizeof(int) *
                         MessageAttachmentSet::kMaxDescriptorsPerMessage)];
 
-    ssize_t bytes_written = 1;
-    int fd_written = -1;
-
-    Message* msg = element->get_message();
-    if (message_send_bytes_written_ == 0 && msg &&
-        msg->attachment_set()->num_non_brokerable_attachments()) {
-      // This is the first chunk of a message which has descriptors to send
-      struct cmsghdr *cmsg;
-      const unsigned num_fds =
-          msg->attachment_set()->num_non_brokerable_attachments();
-
-      DCHECK(num_fds <= MessageAttachmentSet::kMaxDescriptorsPerMessage);
-      if (msg->attachment_set()->ContainsDirectoryDescriptor()) {
-        LOG(FATAL) << "Panic: attempting to transport directory descriptor over"
-                      " IPC. Aborting to maintain sandbox isolation.";
-        // If you have hit this then something tried to send a file descriptor
-        // to a directory over an IPC channel. Since IPC channels span
-        // sandboxes this is very bad: the receiving process can use openat
-        // with ".." elements in the path in order to reach the real
-        // filesystem.
-      }
-
+    if (num_fds) {
       msgh.msg_control = buf;
       msgh.msg_controllen = CMSG_SPACE(sizeof(int) * num_fds);
-      cmsg = CMSG_FIRSTHDR(&msgh);
+      struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgh);
       cmsg->cmsg_level = SOL_SOCKET;
       cmsg->cmsg_type = SCM_RIGHTS;
       cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
-      msg->attachment_set()->PeekDescriptors(
+      msg_with_fds->attachment_set()->PeekDescriptors(
           reinterpret_cast<int*>(CMSG_DATA(cmsg)));
       msgh.msg_controllen = cmsg->cmsg_len;
-
-      // DCHECK_LE above already checks that
-      // num_fds < kMaxDescriptorsPerMessage so no danger of overflow.
-      msg->header()->num_fds = static_cast<uint16_t>(num_fds);
     }
 
-    if (bytes_written == 1) {
-      fd_written = pipe_.get();
-      bytes_written = HANDLE_EINTR(sendmsg(pipe_.get(), &msgh, MSG_DONTWAIT));
-    }
-    if (bytes_written > 0 && msg)
-      CloseFileDescriptors(msg);
+    int fd_written = pipe_.get();
+    ssize_t bytes_written =
+        HANDLE_EINTR(sendmsg(pipe_.get(), &msgh, MSG_DONTWAIT));
+    if (bytes_written > 0 && msg_with_fds)
+      CloseFileDescriptors(msg_with_fds);
 
     if (bytes_written < 0 && !SocketWriteErrorIsRecoverable()) {
       // We can't close the pipe here, because calling OnChannelError
@@ -479,17 +495,36 @@ bool ChannelPosix::ProcessOutgoingMessages() {
       }
       PLOG(ERROR) << "pipe error on "
                   << fd_written
-                  << " Currently writing message of size: "
-                  << element->size();
+                  << " Currently writing " << num_elements
+                  << " messages of size: " << amt_to_write;
       return false;
     }
 
-    if (static_cast<size_t>(bytes_written) != amt_to_write) {
-      if (bytes_written > 0) {
-        // If write() fails with EAGAIN then bytes_written will be -1.
-        message_send_bytes_written_ += bytes_written;
+    // If write() fails with EAGAIN then bytes_written will be -1.
+    size_t amt_written = bytes_written > 0 ? bytes_written : 0;
+    for (size_t i = 0; i < num_elements; ++i) {
+      OutputElement* element = output_queue_.front();
+      size_t amt_left = element->size() - message_send_bytes_written_;
+      if (amt_written < amt_left) {
+        message_send_bytes_written_ += amt_written;
+        break;
+      }
+      amt_written -= amt_left;
+      message_send_bytes_written_ = 0;
+
+      // Message sent OK!
+      if (Message* msg = element->get_message()) {
+        DVLOG(2) << "sent message @" << msg << " on channel @" << this
+                 << " with type " << msg->type() << " on fd " << pipe_.get();
+      } else {
+        DVLOG(2) << "sent buffer @" << element->data() << " on channel @"
+                 << this << " on fd " << pipe_.get();
       }
+      delete element;
+      output_queue_.pop_front();
+    }
 
+    if (static_cast<size_t>(bytes_written) != amt_to_write) {
       // Tell libevent to call us back once things are unblocked.
       is_blocked_on_write_ = true;
       base::MessageLoopForIO::current()->WatchFileDescriptor(
@@ -499,19 +534,6 @@ bool ChannelPosix::ProcessOutgoingMessages() {
           &write_watcher_,
           this);
       return true;
-    } else {
-      message_send_bytes_written_ = 0;
-
-      // Message sent OK!
-      if (msg) {
-        DVLOG(2) << "sent message @" << msg << " on channel @" << this
-                 << " with type " << msg->type() << " on fd " << pipe_.get();
-      } else {
-        DVLOG(2) << "sent buffer @" << element->data() << " on channel @"
-                 << this << " on fd " << pipe_.get();
-      }
-      delete output_queue_.front();
-      output_queue_.pop();
     }
   }
   return true;
@@ -586,7 +608,7 @@ void ChannelPosix::ResetToAcceptingConnectionState() {
 
   while (!output_queue_.empty()) {
     OutputElement* element = output_queue_.front();
-    output_queue_.pop();
+    output_queue_.pop_front();
     if (element->get_message())
       CloseFileDescriptors(element->get_message());
     delete element;
@@ -727,13 +749,13 @@ bool ChannelPosix::ProcessMessageForDelivery(Message* message) {
 
   // |output_queue_| takes ownership of |message|.
   OutputElement* element = new OutputElement(message);
-  output_queue_.push(element);
+  output_queue_.push_back(element);
 
   if (message->HasBrokerableAttachments()) {
     // |output_queue_| takes ownership of |ids.buffer|.
     Message::SerializedAttachmentIds ids =
         message->SerializedIdsOfBrokerableAttachments();
-    output_queue_.push(new OutputElement(ids.buffer, ids.size));
+    output_queue_.push_back(new OutputElement(ids.buffer, ids.size));
   }
 
   return ProcessOutgoingMessages();
@@ -829,7 +851,7 @@ void ChannelPosix::QueueHelloMessage() {
     NOTREACHED() << "Unable to pickle hello message proc id";
   }
   OutputElement* element = new OutputElement(msg.release());
-  output_queue_.push(element);
+  output_queue_.push_back(element);
 }
 
 ChannelPosix::ReadState ChannelPosix::ReadData(
@@ -986,7 +1008,7 @@ void ChannelPosix::QueueCloseFDMessage(int fd, int hops) {
       }
 
       OutputElement* element = new OutputElement(msg.release());
-      output_queue_.push(element);
+      output_queue_.push_back(element);
       break;
     }
 
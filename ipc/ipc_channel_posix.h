@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <sys/socket.h>  // for CMSG macros
 
+#include <deque>
 #include <queue>
 #include <set>
 #include <string>
@@ -169,7 +170,12 @@ class IPC_EXPORT ChannelPosix : public Channel,
   std::queue<Message*> prelim_queue_;
 
   // Messages to be sent are queued here.
-  std::queue<OutputElement*> output_queue_;
+  std::deque<OutputElement*> output_queue_;
+
+  // The most messages, and bytes, that ProcessOutgoingMessages() gathers into
+  // one write. A larger message is written on its own.
+  static const size_t kMaxMessagesPerWrite = 64;
+  static const size_t kMaxBytesPerWrite = 64 * 1024;
 
   // We assume a worst case: kReadBufferSize bytes of messages, where each
   // message has no payload and a full complement of descriptors.
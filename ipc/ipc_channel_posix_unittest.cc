@@ -16,12 +16,15 @@
 #include <unistd.h>
 
 #include <memory>
+#include <string>
 
 #include "base/command_line.h"
 #include "base/files/file_path.h"
+#include "base/file_descriptor_posix.h"
 #include "base/files/file_util.h"
 #include "base/location.h"
 #include "base/path_service.h"
+#include "base/pickle.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/process/process.h"
 #include "base/rand_util.h"
@@ -32,6 +35,7 @@
 #include "base/test/test_timeouts.h"
 #include "build/build_config.h"
 #include "ipc/ipc_listener.h"
+#include "ipc/ipc_message_utils.h"
 #include "ipc/unix_domain_socket_util.h"
 #include "testing/multiprocess_func_list.h"
 
@@ -112,11 +116,50 @@ class IPCChannelPosixTestListener : public IPC::Listener {
   bool quit_only_on_message_;
 };
 
+// Checks that messages arrive in order, each carrying its sequence number and
+// every tenth one a descriptor. Quits after |num_messages| messages.
+class IPCChannelPosixSequenceListener : public IPC::Listener {
+ public:
+  explicit IPCChannelPosixSequenceListener(int num_messages)
+      : num_messages_(num_messages), num_received_(0) {}
+
+  ~IPCChannelPosixSequenceListener() override {}
+
+  bool OnMessageReceived(const IPC::Message& message) override {
+    base::PickleIterator iter(message);
+    int sequence;
+    EXPECT_TRUE(iter.ReadInt(&sequence));
+    EXPECT_EQ(num_received_, sequence);
+    if (sequence % 10 == 0) {
+      base::FileDescriptor descriptor;
+      EXPECT_TRUE(IPC::ParamTraits<base::FileDescriptor>::Read(
+          &message, &iter, &descriptor));
+      EXPECT_LE(0, descriptor.fd);
+      IGNORE_EINTR(close(descriptor.fd));
+    }
+    if (++num_received_ == num_messages_)
+      base::MessageLoopForIO::current()->QuitWhenIdle();
+    return true;
+  }
+
+  void OnChannelError() override {
+    ADD_FAILURE() << "Channel error after " << num_received_ << " messages";
+    base::MessageLoopForIO::current()->QuitWhenIdle();
+  }
+
+  int num_received() const { return num_received_; }
+
+ private:
+  const int num_messages_;
+  int num_received_;
+};
+
 class IPCChannelPosixTest : public base::MultiProcessTest {
  public:
   static void SetUpSocket(IPC::ChannelHandle *handle,
                           IPC::Channel::Mode mode);
   static void SpinRunLoop(base::TimeDelta delay);
+  static void SendQueuedMessagesOfSize(size_t message_size);
   static const std::string GetChannelDirName();
   static std::string GetClientConnectionSocketName();
 
@@ -276,6 +319,56 @@ TEST_F(IPCChannelPosixTest, SendHangTest) {
   ASSERT_EQ(IPCChannelPosixTestListener::CHANNEL_ERROR, out_listener.status());
 }
 
+// Sends more messages of |message_size| bytes than the socket buffer holds,
+// so that the queued ones are gathered into combined writes, and checks that
+// they and their descriptors arrive in order.
+void IPCChannelPosixTest::SendQueuedMessagesOfSize(size_t message_size) {
+  const int kNumMessages = 2000;
+  IPCChannelPosixTestListener out_listener(true);
+  IPCChannelPosixSequenceListener in_listener(kNumMessages);
+  IPC::ChannelHandle in_handle("IN");
+  std::unique_ptr<IPC::ChannelPosix> in_chan(new IPC::ChannelPosix(
+      in_handle, IPC::Channel::MODE_SERVER, &in_listener));
+  IPC::ChannelHandle out_handle(
+      "OUT", base::FileDescriptor(in_chan->TakeClientFileDescriptor()));
+  std::unique_ptr<IPC::ChannelPosix> out_chan(new IPC::ChannelPosix(
+      out_handle, IPC::Channel::MODE_CLIENT, &out_listener));
+  ASSERT_TRUE(in_chan->Connect());
+  ASSERT_TRUE(out_chan->Connect());
+
+  for (int i = 0; i < kNumMessages; ++i) {
+    IPC::Message* message =
+        new IPC::Message(0, kQuitMessage, IPC::Message::PRIORITY_NORMAL);
+    message->WriteInt(i);
+    if (i % 10 == 0) {
+      int fd = open("/dev/null", O_RDONLY);
+      ASSERT_LE(0, fd);
+      IPC::ParamTraits<base::FileDescriptor>::Write(
+          message, base::FileDescriptor(fd, true));
+    }
+    // Pad the message to |message_size| bytes, including the string's length.
+    ASSERT_LE(message->size() + sizeof(int), message_size);
+    message->WriteString(
+        std::string(message_size - message->size() - sizeof(int), 'a'));
+    ASSERT_EQ(message_size, message->size());
+    ASSERT_TRUE(out_chan->Send(message));
+  }
+
+  SpinRunLoop(TestTimeouts::action_max_timeout());
+  EXPECT_EQ(kNumMessages, in_listener.num_received());
+}
+
+TEST_F(IPCChannelPosixTest, SendQueuedMessages) {
+  SendQueuedMessagesOfSize(1024);
+}
+
+// Every read of the receiving channel ends exactly on a message boundary, so
+// descriptors that arrive before the bytes of their message would be seen as
+// descriptors without a message.
+TEST_F(IPCChannelPosixTest, SendQueuedMessagesOnReadBoundaries) {
+  SendQueuedMessagesOfSize(IPC::Channel::kReadBufferSize);
+}
+
 // If a connection closes right before a Connect() call, we may end up closing
 // the connection without notifying the listener, which can cause hangs in
 // sync_message_filter and others. Make sure the listener is notified.
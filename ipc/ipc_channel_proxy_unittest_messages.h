@@ -17,6 +17,7 @@ namespace IPC {
 
 template <>
 struct ParamTraits<BadType> {
+  static void GetSize(base::PickleSizer* sizer, const BadType& p) {}
   static void Write(base::Pickle* m, const BadType& p) {}
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
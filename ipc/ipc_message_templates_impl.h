@@ -7,8 +7,21 @@
 
 #include <tuple>
 
+#include "base/pickle.h"
+
 namespace IPC {
 
+// Sizes the payload with ParamTraits::GetSize() before it's written, so that
+// the message buffer grows at most once instead of doubling as fields are
+// appended. If GetSize() and Write() disagree, the message still grows as
+// needed.
+template <typename... Ts>
+void ReserveParams(Message* msg, const std::tuple<const Ts&...>& params) {
+  base::PickleSizer sizer;
+  GetParamSize(&sizer, params);
+  msg->Reserve(sizer.payload_size());
+}
+
 template <typename... Ts>
 class ParamDeserializer : public MessageReplyDeserializer {
  public:
@@ -26,6 +39,7 @@ template <typename Meta, typename... Ins>
 MessageT<Meta, std::tuple<Ins...>, void>::MessageT(Routing routing,
                                                     const Ins&... ins)
     : Message(routing.id, ID, PRIORITY_NORMAL) {
+  ReserveParams(this, std::tie(ins...));
   WriteParam(this, std::tie(ins...));
 }
 
@@ -59,6 +73,7 @@ MessageT<Meta, std::tuple<Ins...>, std::tuple<Outs...>>::MessageT(
           ID,
           PRIORITY_NORMAL,
           new ParamDeserializer<Outs...>(std::tie(*outs...))) {
+  ReserveParams(this, std::tie(ins...));
   WriteParam(this, std::tie(ins...));
 }
 
@@ -83,6 +98,7 @@ void MessageT<Meta,
               std::tuple<Ins...>,
               std::tuple<Outs...>>::WriteReplyParams(Message* reply,
                                                       const Outs&... outs) {
+  ReserveParams(reply, std::tie(outs...));
   WriteParam(reply, std::tie(outs...));
 }
 
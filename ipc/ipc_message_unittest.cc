@@ -10,6 +10,8 @@
 
 #include <limits>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
@@ -29,6 +31,8 @@ IPC_MESSAGE_CONTROL0(TestMsgClassEmpty)
 
 IPC_MESSAGE_CONTROL1(TestMsgClassI, int)
 
+IPC_MESSAGE_CONTROL2(TestMsgClassIVS, int, std::vector<std::string>)
+
 IPC_SYNC_MESSAGE_CONTROL1_1(TestMsgClassIS, int, std::string)
 
 namespace IPC {
@@ -214,6 +218,21 @@ TEST(IPCMessageTest, FindNextOverflow) {
 #endif
 }
 
+// Messages are sized before their parameters are written, so the payload
+// doesn't reallocate, or end up with unused capacity, as it grows.
+TEST(IPCMessageTest, PresizedPayload) {
+  std::vector<std::string> strings(100, std::string(1000, 'a'));
+  TestMsgClassIVS message(42, strings);
+
+  // The payload is allocated in units of 64 bytes.
+  EXPECT_LT(message.GetTotalAllocatedSize(), message.size() + 64);
+
+  TestMsgClassIVS::Param params;
+  ASSERT_TRUE(TestMsgClassIVS::Read(&message, &params));
+  EXPECT_EQ(42, std::get<0>(params));
+  EXPECT_EQ(strings, std::get<1>(params));
+}
+
 namespace {
 
 class IPCMessageParameterTest : public testing::Test {
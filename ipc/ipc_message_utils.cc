@@ -586,6 +586,12 @@ void ParamTraits<std::vector<bool> >::Log(const param_type& p, std::string* l) {
   }
 }
 
+void ParamTraits<BrokerableAttachment::AttachmentId>::GetSize(
+    base::PickleSizer* sizer,
+    const param_type& p) {
+  sizer->AddBytes(BrokerableAttachment::kNonceSize);
+}
+
 void ParamTraits<BrokerableAttachment::AttachmentId>::Write(
     base::Pickle* m,
     const param_type& p) {
@@ -1086,6 +1092,14 @@ void ParamTraits<LogData>::Log(const param_type& p, std::string* l) {
   // Doesn't make sense to implement this!
 }
 
+void ParamTraits<Message>::GetSize(base::PickleSizer* sizer,
+                                  const Message& p) {
+  sizer->AddUInt32();
+  sizer->AddUInt32();
+  sizer->AddUInt32();
+  sizer->AddData(static_cast<int>(p.payload_size()));
+}
+
 void ParamTraits<Message>::Write(base::Pickle* m, const Message& p) {
 #if defined(OS_POSIX)
   // We don't serialize the file descriptors in the nested message, so there
@@ -516,6 +516,7 @@ struct ParamTraits<std::pair<A, B> > {
 template <>
 struct IPC_EXPORT ParamTraits<BrokerableAttachment::AttachmentId> {
   typedef BrokerableAttachment::AttachmentId param_type;
+  static void GetSize(base::PickleSizer* sizer, const param_type& p);
   static void Write(base::Pickle* m, const param_type& p);
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
@@ -828,6 +829,11 @@ struct ParamTraits<std::tuple<A, B, C, D, E>> {
 template<class P>
 struct ParamTraits<ScopedVector<P> > {
   typedef ScopedVector<P> param_type;
+  static void GetSize(base::PickleSizer* sizer, const param_type& p) {
+    GetParamSize(sizer, static_cast<int>(p.size()));
+    for (size_t i = 0; i < p.size(); i++)
+      GetParamSize(sizer, *p[i]);
+  }
   static void Write(base::Pickle* m, const param_type& p) {
     WriteParam(m, static_cast<int>(p.size()));
     for (size_t i = 0; i < p.size(); i++)
@@ -1051,6 +1057,7 @@ struct IPC_EXPORT ParamTraits<LogData> {
 
 template <>
 struct IPC_EXPORT ParamTraits<Message> {
+  static void GetSize(base::PickleSizer* sizer, const Message& p);
   static void Write(base::Pickle* m, const Message& p);
   static bool Read(const base::Pickle* m,
                    base::PickleIterator* iter,
@@ -230,6 +230,76 @@ class PerformanceChannelListener : public Listener {
   std::unique_ptr<base::PerfTimeLogger> perf_logger_;
 };
 
+// Sends a burst of |msg_count| messages once the client answers "hello", and
+// quits when all of them have been reflected. Unlike the ping-pong tests,
+// messages queue up on both sides, which measures throughput rather than
+// latency.
+class ThroughputChannelListener : public Listener {
+ public:
+  explicit ThroughputChannelListener(const std::string& label)
+      : label_(label), sender_(NULL), msg_count_(0), count_down_(0) {}
+
+  ~ThroughputChannelListener() override {}
+
+  void Init(Sender* sender) {
+    DCHECK(!sender_);
+    sender_ = sender;
+  }
+
+  // Call this before running the message loop.
+  void SetTestParams(int msg_count, size_t msg_size) {
+    DCHECK_EQ(0, count_down_);
+    msg_count_ = msg_count;
+    count_down_ = msg_count_;
+    payload_ = std::string(msg_size, 'a');
+  }
+
+  bool OnMessageReceived(const Message& message) override {
+    CHECK(sender_);
+
+    base::PickleIterator iter(message);
+    int64_t time_internal;
+    EXPECT_TRUE(iter.ReadInt64(&time_internal));
+    int msgid;
+    EXPECT_TRUE(iter.ReadInt(&msgid));
+    base::StringPiece reflected_payload;
+    EXPECT_TRUE(iter.ReadStringPiece(&reflected_payload));
+
+    if (reflected_payload == "hello") {
+      std::string test_name = base::StringPrintf(
+          "IPC_%s_Throughput_%dx_%u", label_.c_str(), msg_count_,
+          static_cast<unsigned>(payload_.size()));
+      perf_logger_.reset(new base::PerfTimeLogger(test_name.c_str()));
+      for (int i = 0; i < msg_count_; i++) {
+        Message* msg = new Message(0, 2, Message::PRIORITY_NORMAL);
+        msg->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+        msg->WriteInt(i);
+        msg->WriteString(payload_);
+        sender_->Send(msg);
+      }
+      return true;
+    }
+
+    DCHECK_EQ(payload_.size(), reflected_payload.size());
+    CHECK(count_down_ > 0);
+    count_down_--;
+    if (count_down_ == 0) {
+      perf_logger_.reset();  // Stop the perf timer now.
+      base::MessageLoop::current()->QuitWhenIdle();
+    }
+    return true;
+  }
+
+ private:
+  std::string label_;
+  Sender* sender_;
+  int msg_count_;
+
+  int count_down_;
+  std::string payload_;
+  std::unique_ptr<base::PerfTimeLogger> perf_logger_;
+};
+
 IPCChannelPerfTestBase::IPCChannelPerfTestBase() = default;
 IPCChannelPerfTestBase::~IPCChannelPerfTestBase() = default;
 
@@ -246,6 +316,15 @@ IPCChannelPerfTestBase::GetDefaultTestParams() {
   return list;
 }
 
+std::vector<PingPongTestParams>
+IPCChannelPerfTestBase::GetSmallMessageTestParams() {
+  std::vector<PingPongTestParams> list;
+  list.push_back(PingPongTestParams(12, 100000));
+  list.push_back(PingPongTestParams(144, 100000));
+  list.push_back(PingPongTestParams(1728, 20000));
+  return list;
+}
+
 void IPCChannelPerfTestBase::RunTestChannelPingPong(
     const std::vector<PingPongTestParams>& params) {
   Init("PerformanceClient");
@@ -285,6 +364,45 @@ void IPCChannelPerfTestBase::RunTestChannelPingPong(
   DestroyChannel();
 }
 
+void IPCChannelPerfTestBase::RunTestChannelThroughput(
+    const std::vector<PingPongTestParams>& params) {
+  Init("PerformanceClient");
+
+  // Set up IPC channel and start client.
+  ThroughputChannelListener listener("Channel");
+  CreateChannel(&listener);
+  listener.Init(channel());
+  ASSERT_TRUE(ConnectChannel());
+  ASSERT_TRUE(StartClient());
+
+  LockThreadAffinity thread_locker(kSharedCore);
+  for (size_t i = 0; i < params.size(); i++) {
+    listener.SetTestParams(params[i].message_count(),
+                           params[i].message_size());
+
+    // The reply to this message starts the burst.
+    Message* message =
+        new Message(0, 2, Message::PRIORITY_NORMAL);
+    message->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+    message->WriteInt(-1);
+    message->WriteString("hello");
+    sender()->Send(message);
+
+    // Run message loop.
+    base::RunLoop().Run();
+  }
+
+  // Send quit message.
+  Message* message = new Message(0, 2, Message::PRIORITY_NORMAL);
+  message->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+  message->WriteInt(-1);
+  message->WriteString("quit");
+  sender()->Send(message);
+
+  EXPECT_TRUE(WaitForClientShutdown());
+  DestroyChannel();
+}
+
 void IPCChannelPerfTestBase::RunTestChannelProxyPingPong(
     const std::vector<PingPongTestParams>& params) {
   io_thread_.reset(new base::TestIOThread(base::TestIOThread::kAutoStart));
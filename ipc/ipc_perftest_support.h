@@ -42,10 +42,16 @@ class IPCChannelPerfTestBase : public IPCTestBase {
 
   static std::vector<PingPongTestParams> GetDefaultTestParams();
 
+  // Parameters for RunTestChannelThroughput(), which sends whole bursts of
+  // small messages.
+  static std::vector<PingPongTestParams> GetSmallMessageTestParams();
+
   void RunTestChannelPingPong(
       const std::vector<PingPongTestParams>& params_list);
   void RunTestChannelProxyPingPong(
       const std::vector<PingPongTestParams>& params_list);
+  void RunTestChannelThroughput(
+      const std::vector<PingPongTestParams>& params_list);
 
   scoped_refptr<base::TaskRunner> io_task_runner() {
     if (io_thread_)
@@ -4,8 +4,52 @@
 
 #include "ipc/ipc_perftest_support.h"
 
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_utils.h"
+
 namespace {
 
+const size_t kStringSize = 64;
+
+// Writes |strings| into a new message the way MessageT does, sizing the
+// payload first if |presize| is set, and returns the number of times the
+// message buffer was allocated.
+int WriteStrings(const std::vector<std::string>& strings, bool presize) {
+  IPC::Message message(0, 2, IPC::Message::PRIORITY_NORMAL);
+  int allocations = 1;
+  size_t allocated_size = message.GetTotalAllocatedSize();
+  auto count_allocation = [&message, &allocations, &allocated_size]() {
+    if (message.GetTotalAllocatedSize() != allocated_size) {
+      allocations++;
+      allocated_size = message.GetTotalAllocatedSize();
+    }
+  };
+
+  if (presize) {
+    base::PickleSizer sizer;
+    IPC::GetParamSize(&sizer, strings);
+    message.Reserve(sizer.payload_size());
+    count_allocation();
+  }
+  IPC::WriteParam(&message, static_cast<int>(strings.size()));
+  count_allocation();
+  for (const std::string& string : strings) {
+    IPC::WriteParam(&message, string);
+    count_allocation();
+  }
+  return allocations;
+}
+
 // This test times the roundtrip IPC message cycle.
 //
 // TODO(brettw): Make this test run by default.
@@ -21,6 +65,39 @@ TEST_F(IPCChannelPerfTest, ChannelProxyPingPong) {
   RunTestChannelProxyPingPong(GetDefaultTestParams());
 }
 
+TEST_F(IPCChannelPerfTest, ChannelThroughput) {
+  RunTestChannelThroughput(GetSmallMessageTestParams());
+}
+
+// This test times writing messages of the ping-pong sizes with and without
+// sizing them first, and logs the buffer allocations per message that sizing
+// removes.
+TEST(IPCMessagePerfTest, PresizedMessage) {
+  for (const IPC::test::PingPongTestParams& params :
+       IPC::test::IPCChannelPerfTestBase::GetDefaultTestParams()) {
+    std::vector<std::string> strings(
+        std::max<size_t>(params.message_size() / kStringSize, 1),
+        std::string(kStringSize, 'a'));
+    int grown_allocations = 0;
+    int sized_allocations = 0;
+    for (bool presize : {false, true}) {
+      base::PerfTimeLogger timer(
+          base::StringPrintf("IPC_Message_%s_%dx%zu",
+                             presize ? "Sized" : "Grown",
+                             params.message_count(), params.message_size())
+              .c_str());
+      int* allocations = presize ? &sized_allocations : &grown_allocations;
+      for (int i = 0; i < params.message_count(); i++)
+        *allocations = WriteStrings(strings, presize);
+      timer.Done();
+    }
+    LOG(INFO) << params.message_size() << " bytes: "
+              << grown_allocations - sized_allocations
+              << " allocations per message removed (" << grown_allocations
+              << " -> " << sized_allocations << ")";
+  }
+}
+
 MULTIPROCESS_IPC_TEST_CLIENT_MAIN(PerformanceClient) {
   IPC::test::PingPongTestClient client;
   return client.RunMain();
@@ -61,6 +61,13 @@ struct Configuration {
   // (This will also entail some auditing to make sure I'm not messing up my
   // checks anywhere.)
   size_t max_shared_memory_num_bytes;
+
+  // Capacity of the shared memory ring through which a channel writes messages
+  // to another process on the same host, in bytes. Only the handles attached
+  // to messages then go through the socket. Must be a power of two between 4KB
+  // and 64MB, and is only supported on Linux and Android. The default is 0,
+  // which writes all messages to the socket.
+  size_t channel_shared_ring_num_bytes;
 };
 
 }  // namespace edk
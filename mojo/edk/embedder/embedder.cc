@@ -18,6 +18,7 @@
 #include "mojo/edk/embedder/entrypoints.h"
 #include "mojo/edk/embedder/platform_channel_pair.h"
 #include "mojo/edk/embedder/process_delegate.h"
+#include "mojo/edk/system/configuration.h"
 #include "mojo/edk/system/core.h"
 
 #if !defined(OS_NACL)
@@ -42,6 +43,10 @@ Core* GetCore() { return g_core; }
 void SetMaxMessageSize(size_t bytes) {
 }
 
+void SetChannelSharedRingSize(size_t bytes) {
+  GetMutableConfiguration()->channel_shared_ring_num_bytes = bytes;
+}
+
 void ChildProcessLaunched(base::ProcessHandle child_process,
                           ScopedPlatformHandle server_pipe,
                           const std::string& child_token) {
@@ -40,6 +40,11 @@ using ProcessErrorCallback = base::Callback<void(const std::string& error)>;
 // Allows changing the default max message size. Must be called before Init.
 MOJO_SYSTEM_IMPL_EXPORT void SetMaxMessageSize(size_t bytes);
 
+// Allows channels to other processes to write messages through a shared memory
+// ring of |bytes| bytes instead of the socket. See
+// |Configuration::channel_shared_ring_num_bytes|. Must be called before Init.
+MOJO_SYSTEM_IMPL_EXPORT void SetChannelSharedRingSize(size_t bytes);
+
 // Called in the parent process for each child process that is launched.
 MOJO_SYSTEM_IMPL_EXPORT void ChildProcessLaunched(
     base::ProcessHandle child_process,
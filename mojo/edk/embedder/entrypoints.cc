@@ -258,6 +258,21 @@ MojoResult MojoGetPropertyImpl(MojoPropertyType type, void* value) {
   return g_core->GetProperty(type, value);
 }
 
+MojoResult MojoAttachMessageContextImpl(
+    MojoMessageHandle message,
+    uintptr_t context,
+    const MojoMessageContextOperations* operations) {
+  return g_core->AttachMessageContext(message, context, operations);
+}
+
+MojoResult MojoGetMessageContextImpl(
+    MojoMessageHandle message,
+    const MojoMessageContextOperations* operations,
+    uintptr_t* context,
+    uint32_t* num_bytes) {
+  return g_core->GetMessageContext(message, operations, context, num_bytes);
+}
+
 }  // extern "C"
 
 namespace mojo {
@@ -300,7 +315,9 @@ MojoSystemThunks MakeSystemThunks() {
                                     MojoWrapPlatformSharedBufferHandleImpl,
                                     MojoUnwrapPlatformSharedBufferHandleImpl,
                                     MojoNotifyBadMessageImpl,
-                                    MojoGetPropertyImpl};
+                                    MojoGetPropertyImpl,
+                                    MojoAttachMessageContextImpl,
+                                    MojoGetMessageContextImpl};
   return system_thunks;
 }
 
@@ -39,6 +39,14 @@ class Channel : public base::RefCountedThreadSafe<Channel> {
         HANDLES_SENT,
         // A control message containing handles that can now be closed.
         HANDLES_SENT_ACK,
+#endif
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+        // A control message offering a shared memory ring through which all
+        // further messages are written.
+        SHARED_RING_OFFER,
+        // A control message carrying the platform handles of a message
+        // written to a shared memory ring.
+        SHARED_RING_HANDLES,
 #endif
       };
 
@@ -247,6 +255,13 @@ class Channel : public base::RefCountedThreadSafe<Channel> {
   // read done by the implementation.
   bool OnReadComplete(size_t bytes_read, size_t* next_read_size_hint);
 
+  // The same as GetReadBuffer() and OnReadComplete(), for messages read from a
+  // shared memory ring rather than from the platform handle. The two streams
+  // of messages are buffered separately. Platform handles for messages from
+  // either stream come from GetReadPlatformHandles().
+  char* GetSharedRingReadBuffer(size_t* buffer_capacity);
+  bool OnSharedRingReadComplete(size_t bytes_read, size_t* next_read_size_hint);
+
   // Called by the implementation when something goes horribly wrong. It is NOT
   // OK to call this synchronously from any public interface methods.
   void OnError();
@@ -280,9 +295,17 @@ class Channel : public base::RefCountedThreadSafe<Channel> {
 
   class ReadBuffer;
 
+  char* GetReadBufferImpl(ReadBuffer* read_buffer, size_t* buffer_capacity);
+  bool OnReadCompleteImpl(ReadBuffer* read_buffer,
+                          size_t bytes_read,
+                          size_t* next_read_size_hint);
+
   Delegate* delegate_;
   const std::unique_ptr<ReadBuffer> read_buffer_;
 
+  // Created once a shared memory ring is read from.
+  std::unique_ptr<ReadBuffer> shared_ring_read_buffer_;
+
   DISALLOW_COPY_AND_ASSIGN(Channel);
 };
 
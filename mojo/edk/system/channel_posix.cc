@@ -26,6 +26,15 @@
 #include <sys/uio.h>
 #endif
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "base/posix/eintr_wrapper.h"
+#include "mojo/edk/system/configuration.h"
+#include "mojo/edk/system/shared_ring_buffer.h"
+#endif
+
 namespace mojo {
 namespace edk {
 
@@ -33,6 +42,32 @@ namespace {
 
 const size_t kMaxBatchReadCapacity = 256 * 1024;
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+// The minimum number of bytes to read from a shared memory ring at once.
+const size_t kSharedRingReadSize = 64 * 1024;
+
+// The payload of a SHARED_RING_OFFER message. Its handles are the shared
+// memory of the ring, an eventfd signalled when data is written to an empty
+// ring, and an eventfd signalled when space is freed in a full ring.
+struct SharedRingOfferData {
+  uint32_t capacity;
+  uint32_t padding;
+};
+
+// Wakes up the side waiting on the eventfd |event|.
+bool SignalEvent(const ScopedPlatformHandle& event) {
+  const uint64_t value = 1;
+  return HANDLE_EINTR(write(event.get().handle, &value, sizeof(value))) ==
+         sizeof(value);
+}
+
+// Resets the eventfd |event| after it was signalled.
+void ClearEvent(const ScopedPlatformHandle& event) {
+  uint64_t value;
+  ignore_result(HANDLE_EINTR(read(event.get().handle, &value, sizeof(value))));
+}
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
 // A view over a Channel::Message object. The write queue uses these since
 // large messages may need to be sent in chunks.
 class MessageView {
@@ -122,12 +157,8 @@ class ChannelPosix : public Channel,
       base::AutoLock lock(write_lock_);
       if (reject_writes_)
         return;
-      if (outgoing_messages_.empty()) {
-        if (!WriteNoLock(MessageView(std::move(message), 0)))
-          reject_writes_ = write_error = true;
-      } else {
-        outgoing_messages_.emplace_back(std::move(message), 0);
-      }
+      if (!WriteMessageNoLock(std::move(message)))
+        reject_writes_ = write_error = true;
     }
     if (write_error) {
       // Do not synchronously invoke OnError(). Write() may have been called by
@@ -216,6 +247,10 @@ class ChannelPosix : public Channel,
         handle_.get().handle, true /* persistent */,
         base::MessageLoopForIO::WATCH_READ, read_watcher_.get(), this);
     base::MessageLoop::current()->AddDestructionObserver(this);
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    if (GetConfiguration().channel_shared_ring_num_bytes)
+      OfferSharedRing(GetConfiguration().channel_shared_ring_num_bytes);
+#endif
   }
 
   void WaitForWriteOnIOThread() {
@@ -244,6 +279,19 @@ class ChannelPosix : public Channel,
 
     read_watcher_.reset();
     write_watcher_.reset();
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    incoming_data_watcher_.reset();
+    incoming_ring_.reset();
+    incoming_data_event_.reset();
+    incoming_space_event_.reset();
+    outgoing_space_watcher_.reset();
+    outgoing_space_event_.reset();
+    {
+      base::AutoLock lock(write_lock_);
+      outgoing_ring_.reset();
+      outgoing_data_event_.reset();
+    }
+#endif
     if (leak_handle_)
       ignore_result(handle_.release());
     handle_.reset();
@@ -264,6 +312,20 @@ class ChannelPosix : public Channel,
 
   // base::MessageLoopForIO::Watcher:
   void OnFileCanReadWithoutBlocking(int fd) override {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    if (incoming_data_event_.is_valid() &&
+        fd == incoming_data_event_.get().handle) {
+      ClearEvent(incoming_data_event_);
+      ReadFromSharedRing();
+      return;
+    }
+    if (outgoing_space_event_.is_valid() &&
+        fd == outgoing_space_event_.get().handle) {
+      ClearEvent(outgoing_space_event_);
+      OnSharedRingSpaceAvailable();
+      return;
+    }
+#endif
     CHECK_EQ(fd, handle_.get().handle);
 
     bool read_error = false;
@@ -291,16 +353,33 @@ class ChannelPosix : public Channel,
         }
       } else if (read_result == 0 ||
                  (errno != EAGAIN && errno != EWOULDBLOCK)) {
-        read_error = true;
+        read_error = socket_closed_ = true;
         break;
       }
     } while (bytes_read == buffer_capacity &&
              total_bytes_read < kMaxBatchReadCapacity &&
              next_read_size > 0);
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    // Messages from the shared memory ring may have been waiting for the
+    // handles that were just read.
+    if (!read_error && incoming_ring_ &&
+        !OnSharedRingReadComplete(0, &next_read_size)) {
+      read_error = true;
+    }
+#endif
     if (read_error) {
       // Stop receiving read notifications.
       read_watcher_.reset();
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      // The other side may have written messages to the ring just before it
+      // closed the socket. Deliver them first; ReadFromSharedRing() reports
+      // the error once the ring is empty.
+      if (socket_closed_ && incoming_ring_) {
+        ReadFromSharedRing();
+        return;
+      }
+#endif
       OnError();
     }
   }
@@ -317,6 +396,25 @@ class ChannelPosix : public Channel,
       OnError();
   }
 
+  // Writes |message| to the shared memory ring if there is one, or to the
+  // socket otherwise.
+  bool WriteMessageNoLock(MessagePtr message) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    if (outgoing_ring_)
+      return WriteToSharedRingNoLock(std::move(message));
+#endif
+    return WriteToSocketNoLock(MessageView(std::move(message), 0));
+  }
+
+  // Writes |message_view| to the socket, after any messages already queued.
+  bool WriteToSocketNoLock(MessageView message_view) {
+    if (!outgoing_messages_.empty()) {
+      outgoing_messages_.emplace_back(std::move(message_view));
+      return true;
+    }
+    return WriteNoLock(std::move(message_view));
+  }
+
   // Attempts to write a message directly to the channel. If the full message
   // cannot be written, it's queued and a wait is initiated to write the message
   // ASAP on the I/O thread.
@@ -411,12 +509,237 @@ class ChannelPosix : public Channel,
     return true;
   }
 
-#if defined(OS_MACOSX)
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // Creates a shared memory ring and offers it to the other side. Once the
+  // offer is written, all further messages are written to the ring, and only
+  // their handles go through the socket.
+  void OfferSharedRing(size_t capacity) {
+    std::unique_ptr<SharedRingBuffer> ring = SharedRingBuffer::Create(capacity);
+    ScopedPlatformHandle data_event(
+        PlatformHandle(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)));
+    ScopedPlatformHandle space_event(
+        PlatformHandle(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)));
+    if (!ring || !data_event.is_valid() || !space_event.is_valid()) {
+      DLOG(ERROR) << "Failed to create a shared ring of " << capacity
+                  << " bytes; falling back to the socket";
+      return;
+    }
+
+    ScopedPlatformHandleVectorPtr handles(new PlatformHandleVector);
+    handles->push_back(ring->DuplicatePlatformHandle().release());
+    handles->push_back(
+        PlatformHandle(HANDLE_EINTR(dup(data_event.get().handle))));
+    handles->push_back(
+        PlatformHandle(HANDLE_EINTR(dup(space_event.get().handle))));
+    for (const PlatformHandle& handle : *handles) {
+      if (!handle.is_valid()) {
+        DPLOG(ERROR) << "Failed to duplicate a shared ring handle";
+        return;
+      }
+    }
+
+    MessagePtr message(new Channel::Message(
+        sizeof(SharedRingOfferData), handles->size(),
+        Message::Header::MessageType::SHARED_RING_OFFER));
+    SharedRingOfferData* data =
+        static_cast<SharedRingOfferData*>(message->mutable_payload());
+    data->capacity = static_cast<uint32_t>(capacity);
+    data->padding = 0;
+    message->SetHandles(std::move(handles));
+
+    outgoing_space_watcher_.reset(
+        new base::MessageLoopForIO::FileDescriptorWatcher);
+    base::MessageLoopForIO::current()->WatchFileDescriptor(
+        space_event.get().handle, true /* persistent */,
+        base::MessageLoopForIO::WATCH_READ, outgoing_space_watcher_.get(),
+        this);
+    outgoing_space_event_ = std::move(space_event);
+
+    bool write_error = false;
+    {
+      base::AutoLock lock(write_lock_);
+      if (reject_writes_)
+        return;
+      if (WriteToSocketNoLock(MessageView(std::move(message), 0))) {
+        outgoing_ring_ = std::move(ring);
+        outgoing_data_event_ = std::move(data_event);
+      } else {
+        reject_writes_ = write_error = true;
+      }
+    }
+    if (write_error) {
+      io_task_runner_->PostTask(FROM_HERE,
+                                base::Bind(&ChannelPosix::OnError, this));
+    }
+  }
+
+  // Maps the shared memory ring offered by the other side, and starts reading
+  // from it.
+  bool AcceptSharedRing(const void* payload,
+                        size_t payload_size,
+                        ScopedPlatformHandleVectorPtr handles) {
+    if (incoming_ring_ || payload_size != sizeof(SharedRingOfferData) ||
+        !handles || handles->size() != 3) {
+      return false;
+    }
+    const SharedRingOfferData* data =
+        static_cast<const SharedRingOfferData*>(payload);
+    if (!SharedRingBuffer::IsValidCapacity(data->capacity))
+      return false;
+
+    ScopedPlatformHandle shared_memory(handles->at(0));
+    ScopedPlatformHandle data_event(handles->at(1));
+    ScopedPlatformHandle space_event(handles->at(2));
+    handles->clear();
+
+    // Fails if the memory is too small for the ring, or could be shrunk later.
+    incoming_ring_ = SharedRingBuffer::CreateFromPlatformHandle(
+        data->capacity, std::move(shared_memory));
+    if (!incoming_ring_)
+      return false;
+    incoming_data_event_ = std::move(data_event);
+    incoming_space_event_ = std::move(space_event);
+
+    incoming_data_watcher_.reset(
+        new base::MessageLoopForIO::FileDescriptorWatcher);
+    base::MessageLoopForIO::current()->WatchFileDescriptor(
+        incoming_data_event_.get().handle, true /* persistent */,
+        base::MessageLoopForIO::WATCH_READ, incoming_data_watcher_.get(),
+        this);
+
+    // Messages may have been written to the ring before the offer was read.
+    io_task_runner_->PostTask(
+        FROM_HERE, base::Bind(&ChannelPosix::ReadFromSharedRing, this));
+    return true;
+  }
+
+  // Reads and dispatches messages from the incoming ring until it is empty,
+  // and then waits for |incoming_data_event_|.
+  void ReadFromSharedRing() {
+    if (!incoming_ring_)
+      return;
+
+    size_t next_read_size = 0;
+    size_t total_bytes_read = 0;
+    while (total_bytes_read < kMaxBatchReadCapacity) {
+      size_t buffer_capacity = std::max(next_read_size, kSharedRingReadSize);
+      char* buffer = GetSharedRingReadBuffer(&buffer_capacity);
+      size_t bytes_read = 0;
+      bool wake_writer = false;
+      if (!incoming_ring_->Read(buffer, buffer_capacity, &bytes_read,
+                                &wake_writer) ||
+          (wake_writer && !SignalEvent(incoming_space_event_))) {
+        OnSharedRingReadError();
+        return;
+      }
+
+      if (!bytes_read) {
+        // Nothing more can arrive once the socket is closed.
+        if (socket_closed_) {
+          OnSharedRingReadError();
+          return;
+        }
+        if (incoming_ring_->WaitForData())
+          return;
+        continue;
+      }
+
+      total_bytes_read += bytes_read;
+      if (!OnSharedRingReadComplete(bytes_read, &next_read_size)) {
+        OnSharedRingReadError();
+        return;
+      }
+    }
+
+    // Let other tasks run before reading more.
+    io_task_runner_->PostTask(
+        FROM_HERE, base::Bind(&ChannelPosix::ReadFromSharedRing, this));
+  }
+
+  void OnSharedRingReadError() {
+    // Stop receiving data notifications.
+    incoming_data_watcher_.reset();
+    incoming_ring_.reset();
+
+    OnError();
+  }
+
+  void OnSharedRingSpaceAvailable() {
+    bool write_error = false;
+    {
+      base::AutoLock lock(write_lock_);
+      if (outgoing_ring_ && !FlushOutgoingRingMessagesNoLock())
+        reject_writes_ = write_error = true;
+    }
+    if (write_error)
+      OnError();
+  }
+
+  // Writes |message| to the outgoing ring, after any messages already queued.
+  // The ring can't carry file descriptors, so a SHARED_RING_HANDLES message
+  // carries them over the socket instead.
+  bool WriteToSharedRingNoLock(MessagePtr message) {
+    MessageView message_view(std::move(message), 0);
+    ScopedPlatformHandleVectorPtr handles = message_view.TakeHandles();
+    if (handles && handles->size()) {
+      MessageView handles_view(
+          MessagePtr(new Channel::Message(
+              0, 0, Message::Header::MessageType::SHARED_RING_HANDLES)),
+          0);
+      handles_view.SetHandles(std::move(handles));
+      if (!WriteToSocketNoLock(std::move(handles_view)))
+        return false;
+    }
+
+    outgoing_ring_messages_.push_back(std::move(message_view));
+    if (outgoing_ring_messages_.size() > 1) {
+      // Already waiting for space.
+      return true;
+    }
+    return FlushOutgoingRingMessagesNoLock();
+  }
+
+  // Writes queued messages to the outgoing ring until it is full, in which
+  // case the writer waits for |outgoing_space_event_|.
+  bool FlushOutgoingRingMessagesNoLock() {
+    while (!outgoing_ring_messages_.empty()) {
+      MessageView& message_view = outgoing_ring_messages_.front();
+      size_t bytes_written = 0;
+      bool wake_reader = false;
+      if (!outgoing_ring_->Write(message_view.data(),
+                                 message_view.data_num_bytes(), &bytes_written,
+                                 &wake_reader) ||
+          (wake_reader && !SignalEvent(outgoing_data_event_))) {
+        return false;
+      }
+
+      if (bytes_written == message_view.data_num_bytes()) {
+        outgoing_ring_messages_.pop_front();
+      } else if (bytes_written) {
+        message_view.advance_data_offset(bytes_written);
+      } else if (outgoing_ring_->WaitForSpace()) {
+        return true;
+      }
+    }
+    return true;
+  }
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
   bool OnControlMessage(Message::Header::MessageType message_type,
                         const void* payload,
                         size_t payload_size,
                         ScopedPlatformHandleVectorPtr handles) override {
     switch (message_type) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      case Message::Header::MessageType::SHARED_RING_OFFER:
+        return AcceptSharedRing(payload, payload_size, std::move(handles));
+
+      case Message::Header::MessageType::SHARED_RING_HANDLES:
+        // The handles stay queued for the message read from the ring.
+        return true;
+#endif
+
+#if defined(OS_MACOSX)
       case Message::Header::MessageType::HANDLES_SENT: {
         if (payload_size == 0)
           break;
@@ -437,6 +760,7 @@ class ChannelPosix : public Channel,
           break;
         return true;
       }
+#endif  // defined(OS_MACOSX)
 
       default:
         break;
@@ -445,6 +769,8 @@ class ChannelPosix : public Channel,
     return false;
   }
 
+#if defined(OS_MACOSX)
+
   // Closes handles referenced by |fds|. Returns false if |num_fds| is 0, or if
   // |fds| does not match a sequence of handles in |handles_to_close_|.
   bool CloseHandles(const int* fds, size_t num_fds) {
@@ -489,6 +815,8 @@ class ChannelPosix : public Channel,
   std::unique_ptr<base::MessageLoopForIO::FileDescriptorWatcher> write_watcher_;
 
   std::deque<PlatformHandle> incoming_platform_handles_;
+  // Whether reading from the socket hit the end of the stream or failed.
+  bool socket_closed_ = false;
 
   // Protects |pending_write_| and |outgoing_messages_|.
   base::Lock write_lock_;
@@ -496,6 +824,24 @@ class ChannelPosix : public Channel,
   bool reject_writes_ = false;
   std::deque<MessageView> outgoing_messages_;
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // The ring written by this side, and the eventfd to signal when the other
+  // side waits for data. Also protected by |write_lock_|.
+  std::unique_ptr<SharedRingBuffer> outgoing_ring_;
+  ScopedPlatformHandle outgoing_data_event_;
+  std::deque<MessageView> outgoing_ring_messages_;
+
+  // These must only be accessed on the IO thread.
+  ScopedPlatformHandle outgoing_space_event_;
+  std::unique_ptr<base::MessageLoopForIO::FileDescriptorWatcher>
+      outgoing_space_watcher_;
+  std::unique_ptr<SharedRingBuffer> incoming_ring_;
+  ScopedPlatformHandle incoming_data_event_;
+  ScopedPlatformHandle incoming_space_event_;
+  std::unique_ptr<base::MessageLoopForIO::FileDescriptorWatcher>
+      incoming_data_watcher_;
+#endif
+
   bool leak_handle_ = false;
 
 #if defined(OS_MACOSX)
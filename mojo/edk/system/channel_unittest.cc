@@ -0,0 +1,285 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/edk/system/channel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "mojo/edk/embedder/platform_channel_pair.h"
+#include "mojo/edk/embedder/platform_channel_utils_posix.h"
+#include "mojo/edk/embedder/platform_handle_vector.h"
+#include "mojo/edk/embedder/scoped_platform_handle.h"
+#include "mojo/edk/system/configuration.h"
+#include "mojo/edk/system/shared_ring_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace mojo {
+namespace edk {
+namespace {
+
+const size_t kRingCapacity = 4096;
+
+class TestChannelDelegate : public Channel::Delegate {
+ public:
+  TestChannelDelegate() : error_(false) {}
+  ~TestChannelDelegate() override {}
+
+  // Channel::Delegate:
+  void OnChannelMessage(const void* payload,
+                        size_t payload_size,
+                        ScopedPlatformHandleVectorPtr handles) override {
+    EXPECT_FALSE(error_);
+    messages_.push_back(
+        std::string(static_cast<const char*>(payload), payload_size));
+    handles_.push_back(std::move(handles));
+  }
+
+  void OnChannelError() override { error_ = true; }
+
+  const std::vector<std::string>& messages() const { return messages_; }
+  std::vector<ScopedPlatformHandleVectorPtr>& handles() { return handles_; }
+  bool error() const { return error_; }
+
+ private:
+  std::vector<std::string> messages_;
+  std::vector<ScopedPlatformHandleVectorPtr> handles_;
+  bool error_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestChannelDelegate);
+};
+
+Channel::MessagePtr CreateMessage(const std::string& payload) {
+  Channel::MessagePtr message(new Channel::Message(payload.size(), 0));
+  memcpy(message->mutable_payload(), payload.data(), payload.size());
+  return message;
+}
+
+// Returns a message carrying the read end of a pipe holding |contents|.
+Channel::MessagePtr CreateMessageWithPipe(const std::string& payload,
+                                          const std::string& contents) {
+  int fds[2];
+  CHECK_EQ(0, pipe(fds));
+  CHECK_EQ(static_cast<ssize_t>(contents.size()),
+           write(fds[1], contents.data(), contents.size()));
+  close(fds[1]);
+
+  Channel::MessagePtr message(new Channel::Message(payload.size(), 1));
+  memcpy(message->mutable_payload(), payload.data(), payload.size());
+  ScopedPlatformHandleVectorPtr handles(new PlatformHandleVector);
+  handles->push_back(PlatformHandle(fds[0]));
+  message->SetHandles(std::move(handles));
+  return message;
+}
+
+// Reads what is left in the pipe |handle|.
+std::string ReadPipe(const PlatformHandle& handle) {
+  char buffer[64];
+  ssize_t result = read(handle.handle, buffer, sizeof(buffer));
+  return result > 0 ? std::string(buffer, result) : std::string();
+}
+
+class ChannelSharedRingTest : public testing::Test {
+ public:
+  ChannelSharedRingTest()
+      : message_loop_(base::MessageLoop::TYPE_IO),
+        saved_ring_num_bytes_(
+            GetConfiguration().channel_shared_ring_num_bytes) {
+    GetMutableConfiguration()->channel_shared_ring_num_bytes = kRingCapacity;
+  }
+
+  ~ChannelSharedRingTest() override {
+    GetMutableConfiguration()->channel_shared_ring_num_bytes =
+        saved_ring_num_bytes_;
+  }
+
+ protected:
+  scoped_refptr<Channel> CreateChannel(TestChannelDelegate* delegate,
+                                       ScopedPlatformHandle handle) {
+    scoped_refptr<Channel> channel = Channel::Create(
+        delegate, std::move(handle), base::ThreadTaskRunnerHandle::Get());
+    channel->Start();
+    return channel;
+  }
+
+  void ShutDown(scoped_refptr<Channel> channel) {
+    channel->ShutDown();
+    base::RunLoop().RunUntilIdle();
+  }
+
+ private:
+  base::MessageLoop message_loop_;
+  const size_t saved_ring_num_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChannelSharedRingTest);
+};
+
+TEST_F(ChannelSharedRingTest, OffersRingAndWritesMessagesToIt) {
+  PlatformChannelPair channel_pair;
+  ScopedPlatformHandle peer = channel_pair.PassClientHandle();
+  TestChannelDelegate delegate;
+  scoped_refptr<Channel> channel =
+      CreateChannel(&delegate, channel_pair.PassServerHandle());
+  channel->Write(CreateMessage("hello"));
+
+  // The socket only carries the offer: a header, the capacity, padding, and
+  // the shared memory and two eventfds.
+  char buffer[256];
+  std::deque<PlatformHandle> handles;
+  ssize_t bytes_read =
+      PlatformChannelRecvmsg(peer.get(), buffer, sizeof(buffer), &handles);
+  ASSERT_GE(bytes_read,
+            static_cast<ssize_t>(sizeof(Channel::Message::Header) + 8));
+  const Channel::Message::Header* header =
+      reinterpret_cast<const Channel::Message::Header*>(buffer);
+  EXPECT_EQ(static_cast<uint32_t>(bytes_read), header->num_bytes);
+  EXPECT_EQ(Channel::Message::Header::MessageType::SHARED_RING_OFFER,
+            header->message_type);
+  uint32_t capacity;
+  memcpy(&capacity, buffer + bytes_read - 8, sizeof(capacity));
+  EXPECT_EQ(kRingCapacity, capacity);
+  ASSERT_EQ(3u, handles.size());
+  EXPECT_LT(PlatformChannelRecvmsg(peer.get(), buffer, sizeof(buffer),
+                                   &handles),
+            0);
+
+  // The message went through the ring instead.
+  std::unique_ptr<SharedRingBuffer> ring =
+      SharedRingBuffer::CreateFromPlatformHandle(
+          capacity, ScopedPlatformHandle(handles[0]));
+  ScopedPlatformHandle data_event(handles[1]);
+  ScopedPlatformHandle space_event(handles[2]);
+  ASSERT_TRUE(ring);
+  std::vector<char> data(kRingCapacity);
+  size_t ring_bytes_read;
+  bool wake_writer;
+  ASSERT_TRUE(
+      ring->Read(data.data(), data.size(), &ring_bytes_read, &wake_writer));
+  Channel::MessagePtr message =
+      Channel::Message::Deserialize(data.data(), ring_bytes_read);
+  ASSERT_TRUE(message);
+  EXPECT_EQ("hello",
+            std::string(static_cast<const char*>(message->payload()),
+                        message->payload_size()));
+
+  ShutDown(channel);
+}
+
+TEST_F(ChannelSharedRingTest, HandlesStayWithTheirMessages) {
+  PlatformChannelPair channel_pair;
+  TestChannelDelegate sender_delegate;
+  TestChannelDelegate receiver_delegate;
+  scoped_refptr<Channel> sender =
+      CreateChannel(&sender_delegate, channel_pair.PassServerHandle());
+  scoped_refptr<Channel> receiver =
+      CreateChannel(&receiver_delegate, channel_pair.PassClientHandle());
+  base::RunLoop().RunUntilIdle();
+
+  sender->Write(CreateMessage("a"));
+  sender->Write(CreateMessageWithPipe("b", "pipe b"));
+  sender->Write(CreateMessage("c"));
+  sender->Write(CreateMessageWithPipe("d", "pipe d"));
+  // Larger than the ring, so the sender waits for space in between.
+  sender->Write(CreateMessage(std::string(3 * kRingCapacity, 'e')));
+  sender->Write(CreateMessageWithPipe("f", "pipe f"));
+  base::RunLoop().RunUntilIdle();
+
+  const std::vector<std::string>& messages = receiver_delegate.messages();
+  ASSERT_EQ(6u, messages.size());
+  EXPECT_EQ("a", messages[0]);
+  EXPECT_EQ("b", messages[1]);
+  EXPECT_EQ("c", messages[2]);
+  EXPECT_EQ("d", messages[3]);
+  EXPECT_EQ(std::string(3 * kRingCapacity, 'e'), messages[4]);
+  EXPECT_EQ("f", messages[5]);
+
+  std::vector<ScopedPlatformHandleVectorPtr>& handles =
+      receiver_delegate.handles();
+  EXPECT_FALSE(handles[0] && handles[0]->size());
+  EXPECT_FALSE(handles[2] && handles[2]->size());
+  EXPECT_FALSE(handles[4] && handles[4]->size());
+  const char* const kPipeContents[] = {"pipe b", "pipe d", "pipe f"};
+  for (size_t i = 0; i < arraysize(kPipeContents); ++i) {
+    ScopedPlatformHandleVectorPtr& message_handles = handles[2 * i + 1];
+    ASSERT_TRUE(message_handles);
+    ASSERT_EQ(1u, message_handles->size());
+    ScopedPlatformHandle pipe(message_handles->at(0));
+    message_handles->clear();
+    EXPECT_EQ(kPipeContents[i], ReadPipe(pipe.get()));
+  }
+  EXPECT_FALSE(receiver_delegate.error());
+
+  ShutDown(sender);
+  ShutDown(receiver);
+}
+
+TEST_F(ChannelSharedRingTest, MessagesInRingArriveBeforeError) {
+  PlatformChannelPair sender_pair;
+  PlatformChannelPair receiver_pair;
+  ScopedPlatformHandle sender_peer = sender_pair.PassClientHandle();
+  ScopedPlatformHandle receiver_peer = receiver_pair.PassClientHandle();
+  TestChannelDelegate sender_delegate;
+  TestChannelDelegate receiver_delegate;
+  scoped_refptr<Channel> sender =
+      CreateChannel(&sender_delegate, sender_pair.PassServerHandle());
+  scoped_refptr<Channel> receiver =
+      CreateChannel(&receiver_delegate, receiver_pair.PassServerHandle());
+
+  // Pass the sender's offer on to the receiver, but keep the eventfd that
+  // signals new data to ourselves, so the receiver only learns about the
+  // messages below through the socket closing.
+  char buffer[256];
+  std::deque<PlatformHandle> handles;
+  ssize_t bytes_read = PlatformChannelRecvmsg(sender_peer.get(), buffer,
+                                              sizeof(buffer), &handles);
+  ASSERT_GT(bytes_read, 0);
+  ASSERT_EQ(3u, handles.size());
+  ScopedPlatformHandle shared_memory(handles[0]);
+  ScopedPlatformHandle data_event(handles[1]);
+  ScopedPlatformHandle space_event(handles[2]);
+  ScopedPlatformHandle unused_event(
+      PlatformHandle(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)));
+  PlatformHandle offer_handles[] = {shared_memory.get(), unused_event.get(),
+                                    space_event.get()};
+  struct iovec iov = {buffer, static_cast<size_t>(bytes_read)};
+  ASSERT_EQ(bytes_read,
+            PlatformChannelSendmsgWithHandles(receiver_peer.get(), &iov, 1,
+                                              offer_handles, 3));
+  base::RunLoop().RunUntilIdle();
+
+  // The receiver found the ring empty and is waiting for the data event.
+  sender->Write(CreateMessage("a"));
+  sender->Write(CreateMessage("b"));
+  sender->Write(CreateMessage("c"));
+  receiver_peer.reset();
+  base::RunLoop().RunUntilIdle();
+
+  const std::vector<std::string>& messages = receiver_delegate.messages();
+  ASSERT_EQ(3u, messages.size());
+  EXPECT_EQ("a", messages[0]);
+  EXPECT_EQ("b", messages[1]);
+  EXPECT_EQ("c", messages[2]);
+  EXPECT_TRUE(receiver_delegate.error());
+
+  ShutDown(sender);
+  ShutDown(receiver);
+}
+
+}  // namespace
+}  // namespace edk
+}  // namespace mojo
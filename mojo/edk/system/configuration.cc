@@ -19,7 +19,8 @@ Configuration g_configuration = {
     256 * 1024 * 1024,    // max_data_pipe_capacity_bytes
     1024 * 1024,          // default_data_pipe_capacity_bytes
     16,                   // data_pipe_buffer_alignment_bytes
-    1024 * 1024 * 1024};  // max_shared_memory_num_bytes
+    1024 * 1024 * 1024,   // max_shared_memory_num_bytes
+    0};                   // channel_shared_ring_num_bytes
 
 }  // namespace internal
 }  // namespace edk
@@ -522,6 +522,52 @@ MojoResult Core::GetMessageBuffer(MojoMessageHandle message, void** buffer) {
   return MOJO_RESULT_OK;
 }
 
+MojoResult Core::AttachMessageContext(
+    MojoMessageHandle message,
+    uintptr_t context,
+    const MojoMessageContextOperations* operations) {
+  if (!message || !operations || !operations->get_serialized_size ||
+      !operations->serialize || !operations->destroy) {
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  }
+
+  PortsMessage* ports_message =
+      reinterpret_cast<MessageForTransit*>(message)->mutable_ports_message();
+  if (ports_message->has_context())
+    return MOJO_RESULT_ALREADY_EXISTS;
+  ports_message->SetContext(context, operations);
+
+  return MOJO_RESULT_OK;
+}
+
+MojoResult Core::GetMessageContext(
+    MojoMessageHandle message,
+    const MojoMessageContextOperations* operations,
+    uintptr_t* context,
+    uint32_t* num_bytes) {
+  if (!message)
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  MessageForTransit* message_for_transit =
+      reinterpret_cast<MessageForTransit*>(message);
+  PortsMessage* ports_message = message_for_transit->mutable_ports_message();
+  MojoResult rv = MOJO_RESULT_NOT_FOUND;
+  if (ports_message->has_context()) {
+    if (ports_message->context_operations() == operations) {
+      *context = ports_message->context();
+      rv = MOJO_RESULT_OK;
+    } else {
+      // The caller doesn't know the type of the context, so it gets the
+      // serialized bytes instead.
+      ports_message->SerializeContext();
+    }
+  }
+  if (num_bytes)
+    *num_bytes = static_cast<uint32_t>(message_for_transit->num_bytes());
+
+  return rv;
+}
+
 MojoResult Core::GetProperty(MojoPropertyType type, void* value) {
   base::AutoLock locker(property_lock_);
   switch (type) {
@@ -152,6 +152,14 @@ class MOJO_SYSTEM_IMPL_EXPORT Core {
                           MojoMessageHandle* message);
   MojoResult FreeMessage(MojoMessageHandle message);
   MojoResult GetMessageBuffer(MojoMessageHandle message, void** buffer);
+  MojoResult AttachMessageContext(
+      MojoMessageHandle message,
+      uintptr_t context,
+      const MojoMessageContextOperations* operations);
+  MojoResult GetMessageContext(MojoMessageHandle message,
+                               const MojoMessageContextOperations* operations,
+                               uintptr_t* context,
+                               uint32_t* num_bytes);
   MojoResult GetProperty(MojoPropertyType type, void* value);
 
   // These methods correspond to the API functions defined in
@@ -209,6 +209,13 @@ MojoResult MessagePipeDispatcher::ReadMessage(
         uint32_t bytes_available =
             static_cast<uint32_t>(message.num_payload_bytes()) -
             header->header_size;
+        // Readers which only get the bytes get the context serialized after
+        // them.
+        if (!read_any_size && message.has_context()) {
+          bytes_available += static_cast<uint32_t>(
+              message.context_operations()->get_serialized_size(
+                  message.context()));
+        }
         if (num_bytes) {
           bytes_to_read = std::min(*num_bytes, bytes_available);
           *num_bytes = bytes_available;
@@ -268,6 +275,8 @@ MojoResult MessagePipeDispatcher::ReadMessage(
 
   std::unique_ptr<PortsMessage> msg(
       static_cast<PortsMessage*>(ports_message.release()));
+  if (!read_any_size && msg->has_context())
+    msg->SerializeContext();
 
   const MessageHeader* header =
       static_cast<const MessageHeader*>(msg->payload_bytes());
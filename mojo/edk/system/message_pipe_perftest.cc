@@ -15,6 +15,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/test/perf_time_logger.h"
 #include "base/threading/thread.h"
+#include "base/time/time.h"
 #include "mojo/edk/embedder/embedder.h"
 #include "mojo/edk/embedder/scoped_platform_handle.h"
 #include "mojo/edk/system/handle_signals_state.h"
@@ -71,11 +72,21 @@ class MessagePipePerfTest : public test::MojoTestBase {
         base::StringPrintf("IPC_Perf_%dx_%u", message_count_,
                            static_cast<unsigned>(message_size_));
     base::PerfTimeLogger logger(test_name.c_str());
+    base::TimeTicks start = base::TimeTicks::Now();
 
     for (int i = 0; i < message_count_; ++i)
       WriteWaitThenRead(mp);
 
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
     logger.Done();
+
+    // Each round trip carries the payload both ways.
+    double seconds = elapsed.InSecondsF();
+    LOG(INFO) << test_name << ": "
+              << 2.0 * message_count_ * message_size_ / seconds / (1024 * 1024)
+              << " MB/s, "
+              << elapsed.InMicroseconds() / static_cast<double>(message_count_)
+              << " us per round trip";
   }
 
  protected:
@@ -5,10 +5,13 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <string>
+
 #include "base/memory/ref_counted.h"
 #include "mojo/edk/system/test_utils.h"
 #include "mojo/edk/test/mojo_test_base.h"
 #include "mojo/public/c/system/core.h"
+#include "mojo/public/c/system/message_pipe.h"
 #include "mojo/public/c/system/types.h"
 
 namespace mojo {
@@ -476,6 +479,197 @@ TEST_F(MessagePipeTest, WriteAndReadMessageObject) {
   EXPECT_EQ(MOJO_RESULT_OK, MojoClose(b));
 }
 
+// A message context holding a string, which is appended to the message when
+// it is serialized.
+struct TestMessageContext {
+  std::string data;
+  bool* destroyed;
+};
+
+size_t GetTestMessageContextSize(uintptr_t context) {
+  return reinterpret_cast<TestMessageContext*>(context)->data.size();
+}
+
+void SerializeTestMessageContext(uintptr_t context, void* buffer) {
+  const std::string& data =
+      reinterpret_cast<TestMessageContext*>(context)->data;
+  memcpy(buffer, data.data(), data.size());
+}
+
+void DestroyTestMessageContext(uintptr_t context) {
+  TestMessageContext* test_context =
+      reinterpret_cast<TestMessageContext*>(context);
+  *test_context->destroyed = true;
+  delete test_context;
+}
+
+const MojoMessageContextOperations kTestMessageContextOperations = {
+    &GetTestMessageContextSize, &SerializeTestMessageContext,
+    &DestroyTestMessageContext};
+
+TEST_F(MessagePipeTest, AttachAndGetMessageContext) {
+  MojoMessageHandle message = MOJO_MESSAGE_HANDLE_INVALID;
+  ASSERT_EQ(MOJO_RESULT_OK, MojoAllocMessage(0, nullptr, 0,
+                                             MOJO_ALLOC_MESSAGE_FLAG_NONE,
+                                             &message));
+
+  bool destroyed = false;
+  uintptr_t context =
+      reinterpret_cast<uintptr_t>(new TestMessageContext{"", &destroyed});
+  uintptr_t result = 0;
+  EXPECT_EQ(MOJO_RESULT_NOT_FOUND,
+            MojoGetMessageContext(message, &kTestMessageContextOperations,
+                                  &result, nullptr));
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            MojoAttachMessageContext(message, context, nullptr));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoAttachMessageContext(message, context,
+                                     &kTestMessageContextOperations));
+  EXPECT_EQ(MOJO_RESULT_ALREADY_EXISTS,
+            MojoAttachMessageContext(message, context,
+                                     &kTestMessageContextOperations));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoGetMessageContext(message, &kTestMessageContextOperations,
+                                  &result, nullptr));
+  EXPECT_EQ(context, result);
+
+  EXPECT_FALSE(destroyed);
+  EXPECT_EQ(MOJO_RESULT_OK, MojoFreeMessage(message));
+  EXPECT_TRUE(destroyed);
+}
+
+// Readers which don't know the type of the context get it serialized.
+TEST_F(MessagePipeTest, GetMessageContextWithOtherOperations) {
+  const std::string kMessage = "Hello, ";
+  MojoMessageHandle message = MOJO_MESSAGE_HANDLE_INVALID;
+  ASSERT_EQ(MOJO_RESULT_OK,
+            MojoAllocMessage(static_cast<uint32_t>(kMessage.size()), nullptr, 0,
+                             MOJO_ALLOC_MESSAGE_FLAG_NONE, &message));
+  void* buffer = nullptr;
+  EXPECT_EQ(MOJO_RESULT_OK, MojoGetMessageBuffer(message, &buffer));
+  memcpy(buffer, kMessage.data(), kMessage.size());
+
+  bool destroyed = false;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoAttachMessageContext(
+                message, reinterpret_cast<uintptr_t>(
+                             new TestMessageContext{"world.", &destroyed}),
+                &kTestMessageContextOperations));
+
+  const MojoMessageContextOperations other_operations =
+      kTestMessageContextOperations;
+  uintptr_t result = 0;
+  uint32_t num_bytes = 0;
+  EXPECT_EQ(MOJO_RESULT_NOT_FOUND,
+            MojoGetMessageContext(message, &other_operations, &result,
+                                  &num_bytes));
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(MOJO_RESULT_NOT_FOUND,
+            MojoGetMessageContext(message, &kTestMessageContextOperations,
+                                  &result, nullptr));
+
+  const std::string kSerialized = "Hello, world.";
+  ASSERT_EQ(static_cast<uint32_t>(kSerialized.size()), num_bytes);
+  EXPECT_EQ(MOJO_RESULT_OK, MojoGetMessageBuffer(message, &buffer));
+  EXPECT_EQ(kSerialized,
+            std::string(static_cast<const char*>(buffer), num_bytes));
+
+  EXPECT_EQ(MOJO_RESULT_OK, MojoFreeMessage(message));
+}
+
+TEST_F(MessagePipeTest, WriteAndReadMessageContext) {
+  const std::string kMessage = "Hello, ";
+  MojoMessageHandle message = MOJO_MESSAGE_HANDLE_INVALID;
+  ASSERT_EQ(MOJO_RESULT_OK,
+            MojoAllocMessage(static_cast<uint32_t>(kMessage.size()), nullptr, 0,
+                             MOJO_ALLOC_MESSAGE_FLAG_NONE, &message));
+  void* buffer = nullptr;
+  EXPECT_EQ(MOJO_RESULT_OK, MojoGetMessageBuffer(message, &buffer));
+  memcpy(buffer, kMessage.data(), kMessage.size());
+
+  bool destroyed = false;
+  uintptr_t context =
+      reinterpret_cast<uintptr_t>(new TestMessageContext{"world.", &destroyed});
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoAttachMessageContext(message, context,
+                                     &kTestMessageContextOperations));
+
+  MojoHandle a, b;
+  CreateMessagePipe(&a, &b);
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoWriteMessageNew(a, message, MOJO_WRITE_MESSAGE_FLAG_NONE));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoWait(b, MOJO_HANDLE_SIGNAL_READABLE, MOJO_DEADLINE_INDEFINITE,
+                     nullptr));
+  uint32_t num_bytes = 0;
+  uint32_t num_handles = 0;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoReadMessageNew(b, &message, &num_bytes, nullptr, &num_handles,
+                               MOJO_READ_MESSAGE_FLAG_NONE));
+
+  // The message stayed in this process, so it was never serialized.
+  EXPECT_EQ(static_cast<uint32_t>(kMessage.size()), num_bytes);
+  uintptr_t result = 0;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoGetMessageContext(message, &kTestMessageContextOperations,
+                                  &result, &num_bytes));
+  EXPECT_EQ(context, result);
+  EXPECT_EQ(static_cast<uint32_t>(kMessage.size()), num_bytes);
+  EXPECT_FALSE(destroyed);
+
+  EXPECT_EQ(MOJO_RESULT_OK, MojoFreeMessage(message));
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(MOJO_RESULT_OK, MojoClose(a));
+  EXPECT_EQ(MOJO_RESULT_OK, MojoClose(b));
+}
+
+// MojoReadMessage() can only return bytes, so the context is serialized.
+TEST_F(MessagePipeTest, ReadMessageSerializesContext) {
+  const std::string kMessage = "Hello, ";
+  MojoMessageHandle message = MOJO_MESSAGE_HANDLE_INVALID;
+  ASSERT_EQ(MOJO_RESULT_OK,
+            MojoAllocMessage(static_cast<uint32_t>(kMessage.size()), nullptr, 0,
+                             MOJO_ALLOC_MESSAGE_FLAG_NONE, &message));
+  void* buffer = nullptr;
+  EXPECT_EQ(MOJO_RESULT_OK, MojoGetMessageBuffer(message, &buffer));
+  memcpy(buffer, kMessage.data(), kMessage.size());
+
+  bool destroyed = false;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoAttachMessageContext(
+                message, reinterpret_cast<uintptr_t>(
+                             new TestMessageContext{"world.", &destroyed}),
+                &kTestMessageContextOperations));
+
+  MojoHandle a, b;
+  CreateMessagePipe(&a, &b);
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoWriteMessageNew(a, message, MOJO_WRITE_MESSAGE_FLAG_NONE));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoWait(b, MOJO_HANDLE_SIGNAL_READABLE, MOJO_DEADLINE_INDEFINITE,
+                     nullptr));
+
+  // The size includes the context.
+  const std::string kSerialized = "Hello, world.";
+  char bytes[32];
+  uint32_t num_bytes = 0;
+  EXPECT_EQ(MOJO_RESULT_RESOURCE_EXHAUSTED,
+            MojoReadMessage(b, nullptr, &num_bytes, nullptr, nullptr,
+                            MOJO_READ_MESSAGE_FLAG_NONE));
+  ASSERT_EQ(static_cast<uint32_t>(kSerialized.size()), num_bytes);
+  EXPECT_FALSE(destroyed);
+
+  num_bytes = sizeof(bytes);
+  EXPECT_EQ(MOJO_RESULT_OK,
+            MojoReadMessage(b, bytes, &num_bytes, nullptr, nullptr,
+                            MOJO_READ_MESSAGE_FLAG_NONE));
+  EXPECT_EQ(kSerialized, std::string(bytes, num_bytes));
+  EXPECT_TRUE(destroyed);
+
+  EXPECT_EQ(MOJO_RESULT_OK, MojoClose(a));
+  EXPECT_EQ(MOJO_RESULT_OK, MojoClose(b));
+}
+
 #if !defined(OS_IOS)
 
 const size_t kPingPongHandlesPerIteration = 50;
@@ -28,6 +28,7 @@
 #include "mojo/edk/test/test_utils.h"
 #include "mojo/public/c/system/buffer.h"
 #include "mojo/public/c/system/functions.h"
+#include "mojo/public/c/system/message_pipe.h"
 #include "mojo/public/c/system/types.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -743,6 +744,46 @@ TEST_F(MultiprocessMessagePipeTest, MultiprocessChannelPipe) {
   END_CHILD()
 }
 
+size_t GetStringContextSize(uintptr_t context) {
+  return reinterpret_cast<std::string*>(context)->size();
+}
+
+void SerializeStringContext(uintptr_t context, void* buffer) {
+  const std::string* data = reinterpret_cast<std::string*>(context);
+  memcpy(buffer, data->data(), data->size());
+}
+
+void DestroyStringContext(uintptr_t context) {
+  delete reinterpret_cast<std::string*>(context);
+}
+
+const MojoMessageContextOperations kStringContextOperations = {
+    &GetStringContextSize, &SerializeStringContext, &DestroyStringContext};
+
+// A message context is serialized after the message bytes when the message
+// leaves the process.
+TEST_F(MultiprocessMessagePipeTest, SerializeMessageContext) {
+  const std::string kMessage = "in an interstellar ";
+  MojoMessageHandle message = MOJO_MESSAGE_HANDLE_INVALID;
+  ASSERT_EQ(MOJO_RESULT_OK,
+            MojoAllocMessage(static_cast<uint32_t>(kMessage.size()), nullptr, 0,
+                             MOJO_ALLOC_MESSAGE_FLAG_NONE, &message));
+  void* buffer = nullptr;
+  ASSERT_EQ(MOJO_RESULT_OK, MojoGetMessageBuffer(message, &buffer));
+  memcpy(buffer, kMessage.data(), kMessage.size());
+  ASSERT_EQ(MOJO_RESULT_OK,
+            MojoAttachMessageContext(
+                message, reinterpret_cast<uintptr_t>(new std::string("burst")),
+                &kStringContextOperations));
+
+  RUN_CHILD_ON_PIPE(ChannelEchoClient, h)
+    ASSERT_EQ(MOJO_RESULT_OK,
+              MojoWriteMessageNew(h, message, MOJO_WRITE_MESSAGE_FLAG_NONE));
+    EXPECT_EQ("in an interstellar burst", ReadMessage(h));
+    WriteMessage(h, "exit");
+  END_CHILD()
+}
+
 // Receives a pipe handle from the primordial channel and echos on it until
 // "exit". Used to test simple pipe transfer across processes via channels.
 DEFINE_TEST_CLIENT_WITH_PIPE(EchoServiceClient, MultiprocessMessagePipeTest,
@@ -4,6 +4,9 @@
 
 #include "mojo/edk/system/ports_message.h"
 
+#include <string.h>
+
+#include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "mojo/edk/system/node_channel.h"
 
@@ -19,7 +22,24 @@ std::unique_ptr<PortsMessage> PortsMessage::NewUserMessage(
       new PortsMessage(num_payload_bytes, num_ports, num_handles));
 }
 
-PortsMessage::~PortsMessage() {}
+PortsMessage::~PortsMessage() {
+  if (context_operations_)
+    context_operations_->destroy(context_);
+}
+
+void PortsMessage::SetContext(uintptr_t context,
+                              const MojoMessageContextOperations* operations) {
+  DCHECK(!context_operations_);
+  DCHECK(operations);
+  context_ = context;
+  context_operations_ = operations;
+}
+
+Channel::MessagePtr PortsMessage::TakeChannelMessage() {
+  if (context_operations_)
+    SerializeContext();
+  return std::move(channel_message_);
+}
 
 PortsMessage::PortsMessage(size_t num_payload_bytes,
                            size_t num_ports,
@@ -58,5 +78,26 @@ PortsMessage::PortsMessage(size_t num_header_bytes,
   }
 }
 
+void PortsMessage::SerializeContext() {
+  DCHECK(context_operations_);
+  DCHECK(channel_message_);
+  size_t num_context_bytes = context_operations_->get_serialized_size(context_);
+  size_t num_bytes = num_header_bytes_ + num_ports_bytes_ + num_payload_bytes_;
+
+  void* data;
+  Channel::MessagePtr channel_message = NodeChannel::CreatePortsMessage(
+      num_bytes + num_context_bytes, &data, channel_message_->num_handles());
+  memcpy(data, start_, num_bytes);
+  start_ = static_cast<char*>(data);
+  context_operations_->serialize(context_, start_ + num_bytes);
+  channel_message->SetHandles(channel_message_->TakeHandles());
+  channel_message_ = std::move(channel_message);
+  num_payload_bytes_ += num_context_bytes;
+
+  context_operations_->destroy(context_);
+  context_ = 0;
+  context_operations_ = nullptr;
+}
+
 }  // namespace edk
 }  // namespace mojo
@@ -12,6 +12,7 @@
 #include "mojo/edk/system/channel.h"
 #include "mojo/edk/system/ports/message.h"
 #include "mojo/edk/system/ports/name.h"
+#include "mojo/public/c/system/message_pipe.h"
 
 namespace mojo {
 namespace edk {
@@ -37,9 +38,24 @@ class PortsMessage : public ports::Message {
     return channel_message_->TakeHandles();
   }
 
-  Channel::MessagePtr TakeChannelMessage() {
-    return std::move(channel_message_);
+  // A context attached by |MojoAttachMessageContext()|, which stands for
+  // payload bytes following the existing ones. It is only serialized once the
+  // message leaves this node.
+  bool has_context() const { return !!context_operations_; }
+  uintptr_t context() const { return context_; }
+  const MojoMessageContextOperations* context_operations() const {
+    return context_operations_;
   }
+  void SetContext(uintptr_t context,
+                  const MojoMessageContextOperations* operations);
+
+  // Replaces the message with a copy that has the serialized context appended
+  // to the payload, and destroys the context.
+  void SerializeContext();
+
+  // Takes the serialized message, serializing the context into the payload
+  // first if there is one.
+  Channel::MessagePtr TakeChannelMessage();
 
   void set_source_node(const ports::NodeName& name) { source_node_ = name; }
   const ports::NodeName& source_node() const { return source_node_; }
@@ -59,6 +75,9 @@ class PortsMessage : public ports::Message {
 
   Channel::MessagePtr channel_message_;
 
+  uintptr_t context_ = 0;
+  const MojoMessageContextOperations* context_operations_ = nullptr;
+
   // The node name from which this message was received, if known.
   ports::NodeName source_node_ = ports::kInvalidNodeName;
 };
@@ -0,0 +1,297 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/edk/system/shared_ring_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "build/build_config.h"
+#include "mojo/edk/embedder/platform_shared_buffer.h"
+
+#if defined(OS_LINUX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "base/posix/eintr_wrapper.h"
+#elif defined(OS_ANDROID)
+#include "third_party/ashmem/ashmem.h"
+#endif
+
+namespace mojo {
+namespace edk {
+
+namespace {
+
+const size_t kMinCapacity = 4 * 1024;
+const size_t kMaxCapacity = 64 * 1024 * 1024;
+
+// Keeps the fields written by each side on separate cache lines.
+const size_t kCacheLineSize = 64;
+
+#if defined(OS_LINUX)
+// From <linux/memfd.h> and <linux/fcntl.h>, which older sysroots lack.
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+// Creates |num_bytes| of zero-filled memory whose size can never change, so
+// that neither side can make the other's mapping fault.
+ScopedPlatformHandle CreateSealedMemory(size_t num_bytes) {
+#if defined(__NR_memfd_create)
+  ScopedPlatformHandle handle(PlatformHandle(static_cast<int>(
+      syscall(__NR_memfd_create, "mojo_shared_ring",
+              MFD_CLOEXEC | MFD_ALLOW_SEALING))));
+  if (!handle.is_valid())
+    return ScopedPlatformHandle();
+  if (HANDLE_EINTR(ftruncate(handle.get().handle, num_bytes)) != 0 ||
+      fcntl(handle.get().handle, F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+    return ScopedPlatformHandle();
+  }
+  return handle;
+#else
+  return ScopedPlatformHandle();
+#endif
+}
+#endif  // defined(OS_LINUX)
+
+// Returns whether the shared memory |handle| holds at least |num_bytes| bytes
+// that stay mapped for as long as the ring is used.
+bool IsUsableSharedMemory(const ScopedPlatformHandle& handle,
+                          size_t num_bytes) {
+#if defined(OS_LINUX)
+  struct stat shared_memory_stat;
+  if (fstat(handle.get().handle, &shared_memory_stat) != 0 ||
+      static_cast<uint64_t>(shared_memory_stat.st_size) < num_bytes) {
+    return false;
+  }
+  int seals = fcntl(handle.get().handle, F_GET_SEALS);
+  return seals >= 0 && (seals & F_SEAL_SHRINK);
+#elif defined(OS_ANDROID)
+  // The size of ashmem is fixed once it is mapped, which the writer did before
+  // offering the ring.
+  int ashmem_bytes = ashmem_get_size_region(handle.get().handle);
+  return ashmem_bytes >= 0 && static_cast<size_t>(ashmem_bytes) >= num_bytes;
+#else
+  return true;
+#endif
+}
+
+}  // namespace
+
+// The start of the shared memory, followed by the data.
+struct SharedRingBuffer::Header {
+  // Only written by the writer.
+  base::subtle::Atomic32 write_offset;
+  char write_offset_padding[kCacheLineSize - sizeof(base::subtle::Atomic32)];
+
+  // Only written by the reader.
+  base::subtle::Atomic32 read_offset;
+  char read_offset_padding[kCacheLineSize - sizeof(base::subtle::Atomic32)];
+
+  // Set by the side that waits, and cleared by the side that wakes it up.
+  base::subtle::Atomic32 reader_waiting;
+  base::subtle::Atomic32 writer_waiting;
+  char waiting_padding[kCacheLineSize - 2 * sizeof(base::subtle::Atomic32)];
+};
+
+// static
+bool SharedRingBuffer::IsValidCapacity(size_t capacity) {
+  return capacity >= kMinCapacity && capacity <= kMaxCapacity &&
+         (capacity & (capacity - 1)) == 0;
+}
+
+// static
+size_t SharedRingBuffer::GetNumBytes(size_t capacity) {
+  return sizeof(Header) + capacity;
+}
+
+// static
+std::unique_ptr<SharedRingBuffer> SharedRingBuffer::Create(size_t capacity) {
+  if (!IsValidCapacity(capacity))
+    return nullptr;
+
+  // The shared memory starts zero-filled, which is a valid empty ring.
+#if defined(OS_LINUX)
+  ScopedPlatformHandle handle = CreateSealedMemory(GetNumBytes(capacity));
+  if (!handle.is_valid())
+    return nullptr;
+  scoped_refptr<PlatformSharedBuffer> buffer(
+      PlatformSharedBuffer::CreateFromPlatformHandle(
+          GetNumBytes(capacity), false /* read_only */, std::move(handle)));
+#else
+  scoped_refptr<PlatformSharedBuffer> buffer(
+      PlatformSharedBuffer::Create(GetNumBytes(capacity)));
+#endif
+  if (!buffer)
+    return nullptr;
+  std::unique_ptr<PlatformSharedBufferMapping> mapping =
+      buffer->Map(0, GetNumBytes(capacity));
+  if (!mapping)
+    return nullptr;
+  return base::WrapUnique(new SharedRingBuffer(
+      capacity, true /* is_writer */, std::move(buffer), std::move(mapping)));
+}
+
+// static
+std::unique_ptr<SharedRingBuffer> SharedRingBuffer::CreateFromPlatformHandle(
+    size_t capacity,
+    ScopedPlatformHandle handle) {
+  if (!IsValidCapacity(capacity) || !handle.is_valid() ||
+      !IsUsableSharedMemory(handle, GetNumBytes(capacity))) {
+    return nullptr;
+  }
+
+  scoped_refptr<PlatformSharedBuffer> buffer(
+      PlatformSharedBuffer::CreateFromPlatformHandle(
+          GetNumBytes(capacity), false /* read_only */, std::move(handle)));
+  if (!buffer)
+    return nullptr;
+  std::unique_ptr<PlatformSharedBufferMapping> mapping =
+      buffer->Map(0, GetNumBytes(capacity));
+  if (!mapping)
+    return nullptr;
+  return base::WrapUnique(new SharedRingBuffer(
+      capacity, false /* is_writer */, std::move(buffer), std::move(mapping)));
+}
+
+SharedRingBuffer::SharedRingBuffer(
+    size_t capacity,
+    bool is_writer,
+    scoped_refptr<PlatformSharedBuffer> buffer,
+    std::unique_ptr<PlatformSharedBufferMapping> mapping)
+    : capacity_(capacity),
+      is_writer_(is_writer),
+      buffer_(std::move(buffer)),
+      mapping_(std::move(mapping)),
+      header_(static_cast<Header*>(mapping_->GetBase())),
+      data_(static_cast<char*>(mapping_->GetBase()) + sizeof(Header)),
+      offset_(0) {
+  static_assert(sizeof(Header) == 3 * kCacheLineSize,
+                "Unexpected Header size.");
+}
+
+SharedRingBuffer::~SharedRingBuffer() {}
+
+ScopedPlatformHandle SharedRingBuffer::DuplicatePlatformHandle() {
+  return buffer_->DuplicatePlatformHandle();
+}
+
+bool SharedRingBuffer::Write(const void* data,
+                             size_t num_bytes,
+                             size_t* bytes_written,
+                             bool* wake_reader) {
+  DCHECK(is_writer_);
+  *bytes_written = 0;
+  *wake_reader = false;
+
+  uint32_t num_bytes_used = GetNumBytesUsed();
+  if (num_bytes_used > capacity_)
+    return false;
+  size_t num_bytes_to_write = std::min(num_bytes, capacity_ - num_bytes_used);
+  if (!num_bytes_to_write)
+    return true;
+
+  size_t start = offset_ & (capacity_ - 1);
+  size_t num_bytes_before_end = std::min(num_bytes_to_write, capacity_ - start);
+  memcpy(data_ + start, data, num_bytes_before_end);
+  memcpy(data_, static_cast<const char*>(data) + num_bytes_before_end,
+         num_bytes_to_write - num_bytes_before_end);
+  offset_ += num_bytes_to_write;
+  base::subtle::Release_Store(&header_->write_offset,
+                              static_cast<base::subtle::Atomic32>(offset_));
+
+  // Either the reader sees the new data after it starts waiting, or we see
+  // that it waits. See WaitForData().
+  base::subtle::MemoryBarrier();
+  *wake_reader =
+      base::subtle::NoBarrier_Load(&header_->reader_waiting) &&
+      base::subtle::NoBarrier_AtomicExchange(&header_->reader_waiting, 0);
+  *bytes_written = num_bytes_to_write;
+  return true;
+}
+
+bool SharedRingBuffer::WaitForSpace() {
+  DCHECK(is_writer_);
+  base::subtle::NoBarrier_Store(&header_->writer_waiting, 1);
+  base::subtle::MemoryBarrier();
+  if (GetNumBytesUsed() != capacity_) {
+    base::subtle::NoBarrier_Store(&header_->writer_waiting, 0);
+    return false;
+  }
+  return true;
+}
+
+bool SharedRingBuffer::Read(void* buffer,
+                            size_t buffer_size,
+                            size_t* bytes_read,
+                            bool* wake_writer) {
+  DCHECK(!is_writer_);
+  *bytes_read = 0;
+  *wake_writer = false;
+
+  uint32_t num_bytes_used = GetNumBytesUsed();
+  if (num_bytes_used > capacity_)
+    return false;
+  size_t num_bytes_to_read = std::min<size_t>(buffer_size, num_bytes_used);
+  if (!num_bytes_to_read)
+    return true;
+
+  size_t start = offset_ & (capacity_ - 1);
+  size_t num_bytes_before_end = std::min(num_bytes_to_read, capacity_ - start);
+  memcpy(buffer, data_ + start, num_bytes_before_end);
+  memcpy(static_cast<char*>(buffer) + num_bytes_before_end, data_,
+         num_bytes_to_read - num_bytes_before_end);
+  offset_ += num_bytes_to_read;
+  base::subtle::Release_Store(&header_->read_offset,
+                              static_cast<base::subtle::Atomic32>(offset_));
+
+  // Pairs with the barrier in WaitForSpace().
+  base::subtle::MemoryBarrier();
+  *wake_writer =
+      base::subtle::NoBarrier_Load(&header_->writer_waiting) &&
+      base::subtle::NoBarrier_AtomicExchange(&header_->writer_waiting, 0);
+  *bytes_read = num_bytes_to_read;
+  return true;
+}
+
+bool SharedRingBuffer::WaitForData() {
+  DCHECK(!is_writer_);
+  base::subtle::NoBarrier_Store(&header_->reader_waiting, 1);
+  base::subtle::MemoryBarrier();
+  if (GetNumBytesUsed() != 0) {
+    base::subtle::NoBarrier_Store(&header_->reader_waiting, 0);
+    return false;
+  }
+  return true;
+}
+
+uint32_t SharedRingBuffer::GetNumBytesUsed() const {
+  if (is_writer_) {
+    return offset_ - static_cast<uint32_t>(
+                         base::subtle::Acquire_Load(&header_->read_offset));
+  }
+  return static_cast<uint32_t>(
+             base::subtle::Acquire_Load(&header_->write_offset)) -
+         offset_;
+}
+
+}  // namespace edk
+}  // namespace mojo
@@ -0,0 +1,127 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MOJO_EDK_SYSTEM_SHARED_RING_BUFFER_H_
+#define MOJO_EDK_SYSTEM_SHARED_RING_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "mojo/edk/embedder/scoped_platform_handle.h"
+#include "mojo/edk/system/system_impl_export.h"
+
+namespace mojo {
+namespace edk {
+
+class PlatformSharedBuffer;
+class PlatformSharedBufferMapping;
+
+// SharedRingBuffer is a single-producer, single-consumer queue of bytes in
+// shared memory. It lets a Channel pass messages to another process on the
+// same host without a system call per message. One process creates the ring
+// and writes to it, and the other maps it and reads from it.
+//
+// Neither side ever blocks. A writer that finds the ring full calls
+// WaitForSpace(), and the reader's next Read() reports that the writer must be
+// woken up through some other means, e.g. an eventfd. The same goes for a
+// reader that finds the ring empty, with WaitForData() and Write().
+//
+// Each side keeps its own offset and validates the other side's offset before
+// using it, and Read() copies the data out of shared memory so that it can't
+// change after it has been validated. This keeps a misbehaving peer from making
+// either side access memory outside the ring. It does not stop the peer from
+// writing garbage into the ring, which the Channel rejects as it would a bad
+// message from the socket.
+//
+// The peer could also shrink the shared memory so that touching the mapping
+// raises SIGBUS. On Linux, Create() seals the size of the memory and
+// CreateFromPlatformHandle() rejects memory whose size isn't sealed. On
+// Android, the memory is ashmem, whose size can't change once it is mapped.
+// Other platforms have no such protection, and don't use the ring.
+class MOJO_SYSTEM_IMPL_EXPORT SharedRingBuffer {
+ public:
+  // Returns whether |capacity| is a valid ring capacity: a power of two
+  // between 4 KB and 64 MB.
+  static bool IsValidCapacity(size_t capacity);
+
+  // Returns the size of the shared memory holding a ring of |capacity| bytes.
+  static size_t GetNumBytes(size_t capacity);
+
+  // Creates a ring of |capacity| bytes, to be written by the caller. Returns
+  // null on failure, which includes Linux kernels without sealable memory.
+  static std::unique_ptr<SharedRingBuffer> Create(size_t capacity);
+
+  // Maps the ring of |capacity| bytes whose shared memory is |handle|, to be
+  // read by the caller. Returns null on failure, or if |handle| refers to less
+  // than GetNumBytes(capacity) bytes or to memory that could be shrunk.
+  static std::unique_ptr<SharedRingBuffer> CreateFromPlatformHandle(
+      size_t capacity,
+      ScopedPlatformHandle handle);
+
+  ~SharedRingBuffer();
+
+  size_t capacity() const { return capacity_; }
+
+  // Duplicates the handle of the shared memory, to pass to the reader.
+  ScopedPlatformHandle DuplicatePlatformHandle();
+
+  // Copies as much of the |num_bytes| bytes at |data| as fits into the ring,
+  // and sets |*bytes_written| to the number of bytes copied. Sets
+  // |*wake_reader| if the reader waits for data. Returns false if the reader
+  // corrupted the ring.
+  bool Write(const void* data,
+             size_t num_bytes,
+             size_t* bytes_written,
+             bool* wake_reader);
+
+  // Records that the writer waits for space. Returns false if space was freed
+  // in the meantime, in which case the writer should write again instead.
+  bool WaitForSpace();
+
+  // Copies up to |buffer_size| bytes out of the ring into |buffer|, and sets
+  // |*bytes_read| to the number of bytes copied. Sets |*wake_writer| if the
+  // writer waits for space. Returns false if the writer corrupted the ring.
+  bool Read(void* buffer,
+            size_t buffer_size,
+            size_t* bytes_read,
+            bool* wake_writer);
+
+  // Records that the reader waits for data. Returns false if data was written
+  // in the meantime, in which case the reader should read again instead.
+  bool WaitForData();
+
+ private:
+  struct Header;
+
+  SharedRingBuffer(size_t capacity,
+                   bool is_writer,
+                   scoped_refptr<PlatformSharedBuffer> buffer,
+                   std::unique_ptr<PlatformSharedBufferMapping> mapping);
+
+  // Returns the number of bytes in the ring as seen from this side, or a
+  // value greater than |capacity_| if the other side corrupted the ring.
+  uint32_t GetNumBytesUsed() const;
+
+  const size_t capacity_;
+  const bool is_writer_;
+  scoped_refptr<PlatformSharedBuffer> buffer_;
+  std::unique_ptr<PlatformSharedBufferMapping> mapping_;
+  Header* header_;
+  char* data_;
+
+  // The offset of the side using this object, in bytes written or read since
+  // the ring was created, modulo 2^32. The copy in |header_| is only written.
+  uint32_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedRingBuffer);
+};
+
+}  // namespace edk
+}  // namespace mojo
+
+#endif  // MOJO_EDK_SYSTEM_SHARED_RING_BUFFER_H_
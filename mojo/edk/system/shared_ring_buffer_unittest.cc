@@ -0,0 +1,172 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/edk/system/shared_ring_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#if defined(OS_LINUX)
+#include <unistd.h>
+#endif
+
+#include "base/memory/ref_counted.h"
+#include "build/build_config.h"
+#include "mojo/edk/embedder/platform_shared_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace mojo {
+namespace edk {
+namespace {
+
+const size_t kCapacity = 4096;
+
+class SharedRingBufferTest : public testing::Test {
+ public:
+  void SetUp() override {
+    writer_ = SharedRingBuffer::Create(kCapacity);
+    ASSERT_TRUE(writer_);
+    reader_ = SharedRingBuffer::CreateFromPlatformHandle(
+        kCapacity, writer_->DuplicatePlatformHandle());
+    ASSERT_TRUE(reader_);
+  }
+
+ protected:
+  // Writes |data|, and returns the number of bytes written.
+  size_t Write(const std::string& data, bool* wake_reader) {
+    size_t bytes_written = 0;
+    EXPECT_TRUE(
+        writer_->Write(data.data(), data.size(), &bytes_written, wake_reader));
+    return bytes_written;
+  }
+
+  // Reads up to |max_bytes| bytes.
+  std::string Read(size_t max_bytes, bool* wake_writer) {
+    std::string data(max_bytes, '\0');
+    size_t bytes_read = 0;
+    EXPECT_TRUE(reader_->Read(&data[0], data.size(), &bytes_read, wake_writer));
+    data.resize(bytes_read);
+    return data;
+  }
+
+  std::unique_ptr<SharedRingBuffer> writer_;
+  std::unique_ptr<SharedRingBuffer> reader_;
+};
+
+TEST_F(SharedRingBufferTest, RejectsInvalidCapacity) {
+  EXPECT_FALSE(SharedRingBuffer::IsValidCapacity(0));
+  EXPECT_FALSE(SharedRingBuffer::IsValidCapacity(1024));
+  EXPECT_FALSE(SharedRingBuffer::IsValidCapacity(kCapacity + 1));
+  EXPECT_FALSE(SharedRingBuffer::IsValidCapacity(1024 * 1024 * 1024));
+  EXPECT_TRUE(SharedRingBuffer::IsValidCapacity(kCapacity));
+  EXPECT_FALSE(SharedRingBuffer::Create(kCapacity + 1));
+}
+
+TEST_F(SharedRingBufferTest, WriteAndRead) {
+  bool wake = true;
+  EXPECT_EQ("", Read(kCapacity, &wake));
+  EXPECT_FALSE(wake);
+
+  EXPECT_EQ(5u, Write("hello", &wake));
+  EXPECT_FALSE(wake);
+  EXPECT_EQ(6u, Write(" world", &wake));
+  EXPECT_EQ("hel", Read(3, &wake));
+  EXPECT_EQ("lo world", Read(kCapacity, &wake));
+  EXPECT_EQ("", Read(kCapacity, &wake));
+}
+
+TEST_F(SharedRingBufferTest, WrapsAround) {
+  bool wake;
+  const std::string first(3000, 'a');
+  EXPECT_EQ(first.size(), Write(first, &wake));
+  EXPECT_EQ(first, Read(kCapacity, &wake));
+
+  std::string second;
+  for (int i = 0; i < 3000; ++i)
+    second.push_back('a' + i % 26);
+  EXPECT_EQ(second.size(), Write(second, &wake));
+  EXPECT_EQ(second, Read(kCapacity, &wake));
+}
+
+TEST_F(SharedRingBufferTest, WakesWriterWhenSpaceIsFreed) {
+  bool wake;
+  const std::string data(kCapacity + 10, 'a');
+  EXPECT_EQ(kCapacity, Write(data, &wake));
+  EXPECT_EQ(0u, Write(data, &wake));
+  EXPECT_TRUE(writer_->WaitForSpace());
+
+  EXPECT_EQ(10u, Read(10, &wake).size());
+  EXPECT_TRUE(wake);
+  EXPECT_EQ(10u, Read(10, &wake).size());
+  EXPECT_FALSE(wake);
+
+  // There is space already, so there's no need to wait.
+  EXPECT_FALSE(writer_->WaitForSpace());
+  EXPECT_EQ(20u, Write(data, &wake));
+}
+
+TEST_F(SharedRingBufferTest, WakesReaderWhenDataIsWritten) {
+  bool wake;
+  EXPECT_TRUE(reader_->WaitForData());
+  EXPECT_EQ(1u, Write("a", &wake));
+  EXPECT_TRUE(wake);
+  EXPECT_EQ(1u, Write("b", &wake));
+  EXPECT_FALSE(wake);
+
+  // There is data already, so there's no need to wait.
+  EXPECT_FALSE(reader_->WaitForData());
+  EXPECT_EQ("ab", Read(kCapacity, &wake));
+}
+
+TEST_F(SharedRingBufferTest, RejectsCorruptedRing) {
+  // Map the ring as another process could, and move the write offset past
+  // the end of the data.
+  scoped_refptr<PlatformSharedBuffer> buffer(
+      PlatformSharedBuffer::CreateFromPlatformHandle(
+          SharedRingBuffer::GetNumBytes(kCapacity), false,
+          writer_->DuplicatePlatformHandle()));
+  ASSERT_TRUE(buffer);
+  std::unique_ptr<PlatformSharedBufferMapping> mapping =
+      buffer->Map(0, SharedRingBuffer::GetNumBytes(kCapacity));
+  ASSERT_TRUE(mapping);
+  *static_cast<uint32_t*>(mapping->GetBase()) = kCapacity + 1;
+
+  char data[16];
+  size_t bytes_read;
+  bool wake;
+  EXPECT_FALSE(reader_->Read(data, sizeof(data), &bytes_read, &wake));
+}
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+TEST_F(SharedRingBufferTest, RejectsTooSmallMemory) {
+  scoped_refptr<PlatformSharedBuffer> buffer(
+      PlatformSharedBuffer::Create(SharedRingBuffer::GetNumBytes(kCapacity)));
+  ASSERT_TRUE(buffer);
+  EXPECT_FALSE(SharedRingBuffer::CreateFromPlatformHandle(
+      2 * kCapacity, buffer->DuplicatePlatformHandle()));
+}
+#endif
+
+#if defined(OS_LINUX)
+TEST_F(SharedRingBufferTest, SizeIsSealed) {
+  ScopedPlatformHandle handle = writer_->DuplicatePlatformHandle();
+  EXPECT_NE(0, ftruncate(handle.get().handle, 0));
+}
+
+TEST_F(SharedRingBufferTest, RejectsUnsealedMemory) {
+  // Ordinary shared memory could be shrunk by the process that sent it.
+  scoped_refptr<PlatformSharedBuffer> buffer(
+      PlatformSharedBuffer::Create(SharedRingBuffer::GetNumBytes(kCapacity)));
+  ASSERT_TRUE(buffer);
+  EXPECT_FALSE(SharedRingBuffer::CreateFromPlatformHandle(
+      kCapacity, buffer->DuplicatePlatformHandle()));
+}
+#endif
+
+}  // namespace
+}  // namespace edk
+}  // namespace mojo
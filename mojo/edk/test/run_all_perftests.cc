@@ -2,7 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stddef.h>
+
 #include "base/command_line.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/test/multiprocess_test.h"
 #include "base/test/perf_test_suite.h"
 #include "base/test/test_io_thread.h"
@@ -12,6 +16,15 @@
 #include "mojo/edk/test/test_support_impl.h"
 #include "mojo/public/tests/test_support_private.h"
 
+namespace {
+
+// Makes channels to child processes write messages through a shared memory
+// ring of the given number of bytes, to compare with the socket alone. Child
+// processes inherit the switch.
+const char kChannelSharedRingBytesSwitch[] = "mojo-channel-shared-ring-bytes";
+
+}  // namespace
+
 int main(int argc, char** argv) {
 #if defined(OS_ANDROID)
   base::InitAndroidMultiProcessTestHelper(main);
@@ -19,6 +32,16 @@ int main(int argc, char** argv) {
 
   base::PerfTestSuite test(argc, argv);
 
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(kChannelSharedRingBytesSwitch)) {
+    size_t shared_ring_bytes;
+    CHECK(base::StringToSizeT(
+        command_line.GetSwitchValueASCII(kChannelSharedRingBytesSwitch),
+        &shared_ring_bytes));
+    mojo::edk::SetChannelSharedRingSize(shared_ring_bytes);
+  }
+
   mojo::edk::Init();
   base::TestIOThread test_io_thread(base::TestIOThread::kAutoStart);
   // Leak this because its destructor calls mojo::edk::ShutdownIPCSupport which
@@ -9,6 +9,7 @@
 #ifndef MOJO_PUBLIC_C_SYSTEM_MESSAGE_PIPE_H_
 #define MOJO_PUBLIC_C_SYSTEM_MESSAGE_PIPE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "mojo/public/c/system/macros.h"
@@ -95,6 +96,23 @@ const MojoAllocMessageFlags MOJO_ALLOC_MESSAGE_FLAG_NONE = 0;
 #define MOJO_ALLOC_MESSAGE_FLAG_NONE ((MojoAllocMessageFlags)0)
 #endif
 
+// |MojoMessageContextOperations|: Used with |MojoAttachMessageContext()| to
+// serialize and destroy a context attached to a message. Each function takes
+// the context as its first argument, may be called on any thread, and must not
+// call the Mojo system API.
+//   |get_serialized_size| - Returns the number of bytes the context serializes
+//       to.
+//   |serialize| - Serializes the context into |buffer|, which has room for the
+//       number of bytes returned by |get_serialized_size|.
+//   |destroy| - Destroys the context. Called exactly once, when the message
+//       is freed or right after the context is serialized.
+
+struct MojoMessageContextOperations {
+  size_t (*get_serialized_size)(uintptr_t context);
+  void (*serialize)(uintptr_t context, void* buffer);
+  void (*destroy)(uintptr_t context);
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -313,6 +331,51 @@ MOJO_SYSTEM_EXPORT MojoResult MojoFreeMessage(MojoMessageHandle message);
 MOJO_SYSTEM_EXPORT MojoResult MojoGetMessageBuffer(MojoMessageHandle message,
                                                    void** buffer);  // Out
 
+// Attaches |context| to a message allocated by |MojoAllocMessage()|, to stand
+// for bytes following the message bytes. This lets the caller pass an object
+// through a message pipe without serializing it: if the message is read in the
+// same process, the reader gets |context| back from |MojoGetMessageContext()|.
+// Only if the message has to leave the process is |context| serialized using
+// |operations|, in which case the reader finds the serialized bytes after the
+// message bytes instead.
+//
+// |operations| must outlive the message, and identifies the type of |context|
+// to |MojoGetMessageContext()|. The serialized bytes can't carry handles.
+// |context| is also serialized if the message is read with |MojoReadMessage()|,
+// or if the reader asks for a context with other |operations|.
+//
+// Returns:
+//   |MOJO_RESULT_OK| if |context| was attached. The message owns it from now
+//       on.
+//   |MOJO_RESULT_INVALID_ARGUMENT| if |message| is not a valid message object,
+//       or if |operations| is null or has a null function.
+//   |MOJO_RESULT_ALREADY_EXISTS| if |message| already has a context.
+MOJO_SYSTEM_EXPORT MojoResult
+MojoAttachMessageContext(MojoMessageHandle message,
+                         uintptr_t context,
+                         const struct MojoMessageContextOperations* operations);
+
+// Retrieves the context attached to |message| by |MojoAttachMessageContext()|
+// with the same |operations|. The message keeps ownership of the context. If
+// the context was attached with other |operations|, it is serialized after the
+// message bytes instead, so that the caller can read it from the buffer.
+//
+// If |num_bytes| is non-null, |*num_bytes| is set to the number of message
+// bytes, which includes any serialized context. Callers should use it in place
+// of the size returned by |MojoReadMessageNew()|.
+//
+// Returns:
+//   |MOJO_RESULT_OK| if |message| has a context attached with |operations|.
+//       |*context| is set to the context.
+//   |MOJO_RESULT_INVALID_ARGUMENT| if |message| is not a valid message object.
+//   |MOJO_RESULT_NOT_FOUND| if |message| has no such context, e.g. because it
+//       was serialized to reach another process.
+MOJO_SYSTEM_EXPORT MojoResult
+MojoGetMessageContext(MojoMessageHandle message,
+                      const struct MojoMessageContextOperations* operations,
+                      uintptr_t* context,    // Out
+                      uint32_t* num_bytes);  // Optional out
+
 // Notifies the system that a bad message was received on a message pipe,
 // according to whatever criteria the caller chooses. This ultimately tries to
 // notify the embedder about the bad message, and the embedder may enforce some
@@ -287,6 +287,23 @@ MojoResult MojoGetProperty(MojoPropertyType type, void* value) {
   return g_thunks.GetProperty(type, value);
 }
 
+MojoResult MojoAttachMessageContext(
+    MojoMessageHandle message,
+    uintptr_t context,
+    const struct MojoMessageContextOperations* operations) {
+  assert(g_thunks.AttachMessageContext);
+  return g_thunks.AttachMessageContext(message, context, operations);
+}
+
+MojoResult MojoGetMessageContext(
+    MojoMessageHandle message,
+    const struct MojoMessageContextOperations* operations,
+    uintptr_t* context,
+    uint32_t* num_bytes) {
+  assert(g_thunks.GetMessageContext);
+  return g_thunks.GetMessageContext(message, operations, context, num_bytes);
+}
+
 }  // extern "C"
 
 size_t MojoEmbedderSetSystemThunks(const MojoSystemThunks* system_thunks) {
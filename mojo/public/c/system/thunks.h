@@ -157,6 +157,15 @@ struct MojoSystemThunks {
                                  const char* error,
                                  size_t error_num_bytes);
   MojoResult (*GetProperty)(MojoPropertyType type, void* value);
+  MojoResult (*AttachMessageContext)(
+      MojoMessageHandle message,
+      uintptr_t context,
+      const struct MojoMessageContextOperations* operations);
+  MojoResult (*GetMessageContext)(
+      MojoMessageHandle message,
+      const struct MojoMessageContextOperations* operations,
+      uintptr_t* context,
+      uint32_t* num_bytes);
 };
 #pragma pack(pop)
 
@@ -16,6 +16,25 @@
 
 namespace mojo {
 
+namespace {
+
+size_t GetContextSerializedSize(uintptr_t context) {
+  return reinterpret_cast<MessageContext*>(context)->GetSerializedSize();
+}
+
+void SerializeContext(uintptr_t context, void* buffer) {
+  reinterpret_cast<MessageContext*>(context)->Serialize(buffer);
+}
+
+void DestroyContext(uintptr_t context) {
+  delete reinterpret_cast<MessageContext*>(context);
+}
+
+const MojoMessageContextOperations kContextOperations = {
+    &GetContextSerializedSize, &SerializeContext, &DestroyContext};
+
+}  // namespace
+
 Message::Message() {
 }
 
@@ -32,25 +51,52 @@ void Message::InitializeFromMojoMessage(ScopedMessageHandle message,
                                         uint32_t num_bytes,
                                         std::vector<Handle>* handles) {
   DCHECK(!buffer_);
+  // A context attached by another kind of sender is serialized instead, which
+  // changes |num_bytes|.
+  uintptr_t context = 0;
+  if (GetMessageContext(message.get(), &kContextOperations, &context,
+                        &num_bytes) == MOJO_RESULT_OK) {
+    context_ = reinterpret_cast<MessageContext*>(context);
+  }
+
   buffer_.reset(new internal::MessageBuffer(std::move(message), num_bytes));
   handles_.swap(*handles);
 }
 
+void Message::AttachContext(std::unique_ptr<MessageContext> context) {
+  DCHECK(buffer_);
+  DCHECK(!context_);
+  DCHECK(context);
+  MojoResult rv =
+      AttachMessageContext(buffer_->message(),
+                           reinterpret_cast<uintptr_t>(context.get()),
+                           &kContextOperations);
+  CHECK_EQ(rv, MOJO_RESULT_OK);
+  context_ = context.release();
+}
+
 void Message::MoveTo(Message* destination) {
   DCHECK(this != destination);
 
   // No copy needed.
   std::swap(destination->buffer_, buffer_);
   std::swap(destination->handles_, handles_);
+  std::swap(destination->context_, context_);
 
   CloseHandles();
   handles_.clear();
   buffer_.reset();
+  context_ = nullptr;
 }
 
 ScopedMessageHandle Message::TakeMojoMessage() {
-  if (handles_.empty())  // Fast path for the common case: No handles.
+  if (handles_.empty()) {  // Fast path for the common case: No handles.
+    context_ = nullptr;
     return buffer_->TakeMessage();
+  }
+
+  // The context would be lost with the old message.
+  CHECK(!context_);
 
   // Allocate a new message with space for the handles, then copy the buffer
   // contents into it.
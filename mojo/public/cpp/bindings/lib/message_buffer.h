@@ -34,6 +34,7 @@ class MessageBuffer : public Buffer {
   // Buffer:
   void* Allocate(size_t delta) override;
 
+  MessageHandle message() const { return message_.get(); }
   ScopedMessageHandle TakeMessage() { return std::move(message_); }
 
   void NotifyBadMessage(const std::string& error);
@@ -20,6 +20,22 @@
 
 namespace mojo {
 
+// An unserialized message payload which may be attached to a Message in place
+// of serialized payload bytes. If the message is read in the same process, the
+// receiver gets the context back and may use it directly. Otherwise the
+// context is serialized after the message bytes when the message leaves the
+// process. Methods may be called on any thread.
+class MessageContext {
+ public:
+  virtual ~MessageContext() {}
+
+  // Returns the number of bytes Serialize() writes.
+  virtual size_t GetSerializedSize() = 0;
+
+  // Writes the serialized payload to |buffer|.
+  virtual void Serialize(void* buffer) = 0;
+};
+
 // Message is a holder for the data and handles to be sent over a MessagePipe.
 // Message owns its data and handles, but a consumer of Message is free to
 // mutate the data and handles. The message's data is comprised of a header
@@ -96,6 +112,15 @@ class Message {
   const std::vector<Handle>* handles() const { return &handles_; }
   std::vector<Handle>* mutable_handles() { return &handles_; }
 
+  // Attaches |context| in place of the payload, which must not have been
+  // written. Messages with a context can't carry handles.
+  void AttachContext(std::unique_ptr<MessageContext> context);
+
+  // Returns the context attached by the sender, or null if the message was
+  // serialized. Receivers must check this before validating the payload, and
+  // know the type of the context from the message name.
+  MessageContext* context() const { return context_; }
+
   // Access the underlying Buffer interface.
   internal::Buffer* buffer() { return buffer_.get(); }
 
@@ -114,6 +139,9 @@ class Message {
   std::unique_ptr<internal::MessageBuffer> buffer_;
   std::vector<Handle> handles_;
 
+  // Owned by the Mojo message in |buffer_|.
+  MessageContext* context_ = nullptr;
+
   DISALLOW_COPY_AND_ASSIGN(Message);
 };
 
@@ -3,12 +3,24 @@
 // found in the LICENSE file.
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "mojo/public/cpp/bindings/binding.h"
+#include "mojo/public/cpp/bindings/connector.h"
+#include "mojo/public/cpp/bindings/lib/message_builder.h"
+#include "mojo/public/cpp/bindings/message.h"
 #include "mojo/public/cpp/test_support/test_support.h"
 #include "mojo/public/cpp/test_support/test_utils.h"
 #include "mojo/public/interfaces/bindings/tests/ping_service.mojom.h"
@@ -90,6 +102,103 @@ struct BoundPingService {
   Binding<test::PingService> binding;
 };
 
+// Holds a payload which is only copied if its message leaves the process.
+class PayloadContext : public MessageContext {
+ public:
+  explicit PayloadContext(std::vector<uint8_t> payload)
+      : payload_(std::move(payload)) {}
+
+  std::vector<uint8_t> TakePayload() { return std::move(payload_); }
+
+  // MessageContext:
+  size_t GetSerializedSize() override { return payload_.size(); }
+  void Serialize(void* buffer) override {
+    memcpy(buffer, payload_.data(), payload_.size());
+  }
+
+ private:
+  std::vector<uint8_t> payload_;
+};
+
+// Sends |payload| through |connector|, either serialized into the message or
+// attached as a context.
+void SendPayload(Connector* connector,
+                 std::vector<uint8_t> payload,
+                 bool attach_context) {
+  if (attach_context) {
+    internal::MessageBuilder builder(1, 0);
+    builder.message()->AttachContext(std::unique_ptr<MessageContext>(
+        new PayloadContext(std::move(payload))));
+    connector->Accept(builder.message());
+  } else {
+    internal::MessageBuilder builder(1, payload.size());
+    memcpy(builder.buffer()->Allocate(payload.size()), payload.data(),
+           payload.size());
+    connector->Accept(builder.message());
+  }
+}
+
+// Takes the payload out of each message, as a stub would deserialize it, and
+// sends it back through |reply_connector| if there is one.
+class PayloadReceiver : public MessageReceiver {
+ public:
+  PayloadReceiver(Connector* reply_connector, bool attach_context)
+      : reply_connector_(reply_connector), attach_context_(attach_context) {}
+
+  bool Accept(Message* message) override {
+    std::vector<uint8_t> payload;
+    if (message->context()) {
+      payload =
+          static_cast<PayloadContext*>(message->context())->TakePayload();
+    } else {
+      payload.assign(message->payload(),
+                     message->payload() + message->payload_num_bytes());
+    }
+    if (reply_connector_)
+      SendPayload(reply_connector_, std::move(payload), attach_context_);
+    return true;
+  }
+
+ private:
+  Connector* const reply_connector_;
+  const bool attach_context_;
+
+  DISALLOW_COPY_AND_ASSIGN(PayloadReceiver);
+};
+
+// Sends |num_bytes| payloads back and forth between two Connectors in this
+// process, either serialized into the messages or attached as contexts, and
+// logs the average round trip time.
+void SendPayloads(size_t num_bytes, bool attach_context) {
+  MessagePipe pipe;
+  Connector sender(std::move(pipe.handle0), Connector::SINGLE_THREADED_SEND,
+                   base::ThreadTaskRunnerHandle::Get());
+  Connector receiver(std::move(pipe.handle1), Connector::SINGLE_THREADED_SEND,
+                     base::ThreadTaskRunnerHandle::Get());
+  PayloadReceiver reply_receiver(nullptr, attach_context);
+  sender.set_incoming_receiver(&reply_receiver);
+  PayloadReceiver echo_receiver(&receiver, attach_context);
+  receiver.set_incoming_receiver(&echo_receiver);
+
+  const size_t kIterations = std::min<size_t>(100000, (256 << 20) / num_bytes);
+  const MojoTimeTicks start_time = MojoGetTimeTicksNow();
+  for (size_t i = 0; i < kIterations; ++i) {
+    SendPayload(&sender,
+                std::vector<uint8_t>(num_bytes, static_cast<uint8_t>(i)),
+                attach_context);
+    receiver.WaitForIncomingMessage(MOJO_DEADLINE_INDEFINITE);
+    sender.WaitForIncomingMessage(MOJO_DEADLINE_INDEFINITE);
+  }
+  const MojoTimeTicks end_time = MojoGetTimeTicksNow();
+
+  std::string sub_test_name = base::SizeTToString(num_bytes) +
+                              (attach_context ? "_Context" : "_Serialized");
+  test::LogPerfResult(
+      "InProcessPayload", sub_test_name.c_str(),
+      static_cast<double>(end_time - start_time) / kIterations,
+      "microseconds/round trip");
+}
+
 class MojoBindingsPerftest : public testing::Test {
  public:
   MojoBindingsPerftest() {}
@@ -133,5 +242,13 @@ TEST_F(MojoBindingsPerftest, InProcessPingPong) {
   }
 }
 
+TEST_F(MojoBindingsPerftest, InProcessPayload) {
+  const size_t kPayloadSizes[] = {64, 4 * 1024, 64 * 1024, 1024 * 1024};
+  for (size_t num_bytes : kPayloadSizes) {
+    SendPayloads(num_bytes, false);
+    SendPayloads(num_bytes, true);
+  }
+}
+
 }  // namespace
 }  // namespace mojo
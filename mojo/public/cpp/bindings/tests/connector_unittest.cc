@@ -7,6 +7,9 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+
+#include <memory>
+#include <string>
 #include <utility>
 
 #include "base/bind.h"
@@ -86,6 +89,22 @@ class ReentrantMessageAccumulator : public MessageAccumulator {
   int number_of_calls_;
 };
 
+class StringMessageContext : public MessageContext {
+ public:
+  explicit StringMessageContext(const std::string& text) : text_(text) {}
+
+  const std::string& text() const { return text_; }
+
+  // MessageContext:
+  size_t GetSerializedSize() override { return text_.size(); }
+  void Serialize(void* buffer) override {
+    memcpy(buffer, text_.data(), text_.size());
+  }
+
+ private:
+  const std::string text_;
+};
+
 class ConnectorTest : public testing::Test {
  public:
   ConnectorTest() {}
@@ -198,6 +217,38 @@ TEST_F(ConnectorTest, Basic_EarlyIncomingReceiver) {
       std::string(reinterpret_cast<const char*>(message_received.payload())));
 }
 
+TEST_F(ConnectorTest, Basic_MessageContext) {
+  Connector connector0(std::move(handle0_), Connector::SINGLE_THREADED_SEND,
+                       base::ThreadTaskRunnerHandle::Get());
+  Connector connector1(std::move(handle1_), Connector::SINGLE_THREADED_SEND,
+                       base::ThreadTaskRunnerHandle::Get());
+
+  const char kText[] = "hello world";
+
+  internal::MessageBuilder builder(1, 0);
+  builder.message()->AttachContext(
+      std::unique_ptr<MessageContext>(new StringMessageContext(kText)));
+  connector0.Accept(builder.message());
+
+  base::RunLoop run_loop;
+  MessageAccumulator accumulator(run_loop.QuitClosure());
+  connector1.set_incoming_receiver(&accumulator);
+
+  run_loop.Run();
+
+  ASSERT_FALSE(accumulator.IsEmpty());
+
+  Message message_received;
+  accumulator.Pop(&message_received);
+
+  // The message never left the process, so the payload wasn't serialized.
+  EXPECT_EQ(0u, message_received.payload_num_bytes());
+  ASSERT_TRUE(message_received.context());
+  EXPECT_EQ(std::string(kText),
+            static_cast<StringMessageContext*>(message_received.context())
+                ->text());
+}
+
 TEST_F(ConnectorTest, Basic_TwoMessages) {
   Connector connector0(std::move(handle0_), Connector::SINGLE_THREADED_SEND,
                        base::ThreadTaskRunnerHandle::Get());
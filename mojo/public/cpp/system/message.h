@@ -5,6 +5,8 @@
 #ifndef MOJO_PUBLIC_CPP_SYSTEM_MESSAGE_H_
 #define MOJO_PUBLIC_CPP_SYSTEM_MESSAGE_H_
 
+#include <stdint.h>
+
 #include <limits>
 
 #include "base/macros.h"
@@ -72,6 +74,24 @@ inline MojoResult GetMessageBuffer(MessageHandle message, void** buffer) {
   return MojoGetMessageBuffer(message.value(), buffer);
 }
 
+inline MojoResult AttachMessageContext(
+    MessageHandle message,
+    uintptr_t context,
+    const MojoMessageContextOperations* operations) {
+  DCHECK(message.is_valid());
+  return MojoAttachMessageContext(message.value(), context, operations);
+}
+
+inline MojoResult GetMessageContext(
+    MessageHandle message,
+    const MojoMessageContextOperations* operations,
+    uintptr_t* context,
+    uint32_t* num_bytes) {
+  DCHECK(message.is_valid());
+  return MojoGetMessageContext(message.value(), operations, context,
+                               num_bytes);
+}
+
 inline MojoResult NotifyBadMessage(MessageHandle message,
                                    const base::StringPiece& error) {
   DCHECK(message.is_valid());
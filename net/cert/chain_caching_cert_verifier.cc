@@ -0,0 +1,424 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert/chain_caching_cert_verifier.h"
+
+#include <openssl/sha.h>
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/containers/linked_list.h"
+#include "base/logging.h"
+#include "base/strings/string_util.h"
+#include "net/base/net_errors.h"
+#include "net/base/url_util.h"
+#include "net/cert/cert_status_flags.h"
+#include "net/cert/crl_set.h"
+#include "net/cert/x509_certificate.h"
+#include "net/log/net_log.h"
+
+namespace net {
+
+namespace {
+
+// The maximum number of chains to cache results for.
+const unsigned kMaxCacheEntries = 256;
+
+// The number of seconds to cache entries. This is kept short because entries
+// expire on TimeTicks, and so don't notice changes to the system clock.
+const unsigned kTTLSecs = 300;  // 5 minutes.
+
+// Adds |data| to |ctx|, preceded by its length, so that the bytes of one
+// field can't be mistaken for those of the next.
+void HashLengthPrefixed(SHA256_CTX* ctx, const std::string& data) {
+  uint64_t length = data.size();
+  SHA256_Update(ctx, &length, sizeof(length));
+  SHA256_Update(ctx, data.data(), data.size());
+}
+
+// Adds |count| to |ctx|, ahead of that many length-prefixed fields.
+void HashCount(SHA256_CTX* ctx, size_t count) {
+  uint64_t count64 = count;
+  SHA256_Update(ctx, &count64, sizeof(count64));
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+//
+// A Job verifies one chain, for the hostname of the request that started it,
+// with the wrapped verifier. Requests for the same chain, whatever their
+// hostname, attach a JobRequest to the Job and receive its result once it
+// completes. Jobs and JobRequests live on the origin thread.
+//
+// Cancellation:
+//
+// Deleting a JobRequest detaches it from its Job. When the last JobRequest is
+// detached, the Job is deleted, which cancels the verification in the wrapped
+// verifier.
+//
+// Deleting the ChainCachingCertVerifier deletes all Jobs, which cancels their
+// verifications and marks each of their JobRequests as cancelled.
+
+class ChainCachingCertVerifier::JobRequest
+    : public base::LinkNode<JobRequest>,
+      public CertVerifier::Request {
+ public:
+  JobRequest(Job* job,
+             const RequestParams& params,
+             CRLSet* crl_set,
+             CertVerifyResult* verify_result,
+             const CompletionCallback& callback,
+             const BoundNetLog& net_log)
+      : job_(job),
+        params_(params),
+        crl_set_(crl_set),
+        verify_result_(verify_result),
+        callback_(callback),
+        net_log_(net_log) {}
+
+  ~JobRequest() override;
+
+  // Completes the request with |chain_error| and |chain_result|, which the
+  // Job obtained for |job_params|. If the result can't be shared with this
+  // request's hostname, verifies the request on its own with |verifier|
+  // instead.
+  void OnJobCompleted(CertVerifier* verifier,
+                      const RequestParams& job_params,
+                      int chain_error,
+                      const CertVerifyResult& chain_result);
+
+  void OnJobCancelled() {
+    job_ = nullptr;
+    callback_.Reset();
+  }
+
+ private:
+  void OnVerifyComplete(int error) {
+    base::ResetAndReturn(&callback_).Run(error);
+  }
+
+  Job* job_;  // Not owned.
+  const RequestParams params_;
+  const scoped_refptr<CRLSet> crl_set_;
+  CertVerifyResult* verify_result_;
+  CompletionCallback callback_;
+  const BoundNetLog net_log_;
+
+  // The request to the wrapped verifier, if this request had to be verified
+  // on its own.
+  std::unique_ptr<CertVerifier::Request> request_;
+
+  DISALLOW_COPY_AND_ASSIGN(JobRequest);
+};
+
+class ChainCachingCertVerifier::Job {
+ public:
+  Job(ChainCachingCertVerifier* cert_verifier,
+      const std::string& key,
+      const RequestParams& params)
+      : cert_verifier_(cert_verifier), key_(key), params_(params) {}
+
+  ~Job() {
+    // Cancels the verification in the wrapped verifier, if still running.
+    request_.reset();
+    for (base::LinkNode<JobRequest>* it = requests_.head();
+         it != requests_.end(); it = it->next()) {
+      it->value()->OnJobCancelled();
+    }
+  }
+
+  const std::string& key() const { return key_; }
+  const CertVerifyResult& verify_result() const { return verify_result_; }
+
+  // Starts verifying the chain with |verifier|. Returns ERR_IO_PENDING if
+  // the verification completes asynchronously, otherwise the result, which
+  // is then available from verify_result().
+  int Start(CertVerifier* verifier,
+            CRLSet* crl_set,
+            const BoundNetLog& net_log) {
+    return verifier->Verify(
+        params_, crl_set, &verify_result_,
+        base::Bind(&Job::OnVerifyComplete, base::Unretained(this)), &request_,
+        net_log);
+  }
+
+  // Creates and attaches a request to the Job.
+  std::unique_ptr<JobRequest> CreateRequest(const RequestParams& params,
+                                            CRLSet* crl_set,
+                                            CertVerifyResult* verify_result,
+                                            const CompletionCallback& callback,
+                                            const BoundNetLog& net_log) {
+    std::unique_ptr<JobRequest> request(new JobRequest(
+        this, params, crl_set, verify_result, callback, net_log));
+    requests_.Append(request.get());
+    return request;
+  }
+
+  // Detaches |request| from the Job, abandoning the Job if it was the last
+  // one.
+  void RemoveRequest(JobRequest* request) {
+    request->RemoveFromList();
+    if (requests_.empty() && cert_verifier_)
+      cert_verifier_->OnJobAbandoned(this);
+  }
+
+ private:
+  void OnVerifyComplete(int error) {
+    std::unique_ptr<Job> keep_alive =
+        cert_verifier_->OnJobCompleted(this, error, verify_result_);
+    CertVerifier* verifier = cert_verifier_->verifier_.get();
+    base::WeakPtr<ChainCachingCertVerifier> weak_cert_verifier =
+        cert_verifier_->weak_factory_.GetWeakPtr();
+    cert_verifier_ = nullptr;
+
+    // If the ChainCachingCertVerifier is deleted from within one of the
+    // callbacks, the remaining requests are cancelled when |keep_alive| goes
+    // away.
+    while (!requests_.empty() && weak_cert_verifier) {
+      JobRequest* request = requests_.head()->value();
+      request->RemoveFromList();
+      request->OnJobCompleted(verifier, params_, error, verify_result_);
+    }
+  }
+
+  ChainCachingCertVerifier* cert_verifier_;  // Not owned.
+  const std::string key_;
+
+  // The parameters of the request that started the Job.
+  const RequestParams params_;
+
+  CertVerifyResult verify_result_;
+  std::unique_ptr<CertVerifier::Request> request_;
+  base::LinkedList<JobRequest> requests_;  // Not owned.
+
+  DISALLOW_COPY_AND_ASSIGN(Job);
+};
+
+ChainCachingCertVerifier::JobRequest::~JobRequest() {
+  if (job_)
+    job_->RemoveRequest(this);
+}
+
+void ChainCachingCertVerifier::JobRequest::OnJobCompleted(
+    CertVerifier* verifier,
+    const RequestParams& job_params,
+    int chain_error,
+    const CertVerifyResult& chain_result) {
+  DCHECK(job_);
+  job_ = nullptr;
+
+  if (params_ == job_params) {
+    *verify_result_ = chain_result;
+    OnVerifyComplete(chain_error);
+    return;
+  }
+
+  if (IsShareable(chain_error, chain_result)) {
+    OnVerifyComplete(
+        DeriveResult(params_, chain_error, chain_result, verify_result_));
+    return;
+  }
+
+  int rv = verifier->Verify(params_, crl_set_.get(), verify_result_,
+                            base::Bind(&JobRequest::OnVerifyComplete,
+                                       base::Unretained(this)),
+                            &request_, net_log_);
+  if (rv != ERR_IO_PENDING)
+    OnVerifyComplete(rv);
+}
+
+ChainCachingCertVerifier::ChainCachingCertVerifier(
+    std::unique_ptr<CertVerifier> verifier)
+    : verifier_(std::move(verifier)),
+      cache_(kMaxCacheEntries),
+      requests_(0u),
+      cache_hits_(0u),
+      inflight_joins_(0u),
+      weak_factory_(this) {
+  CertDatabase::GetInstance()->AddObserver(this);
+}
+
+ChainCachingCertVerifier::~ChainCachingCertVerifier() {
+  CertDatabase::GetInstance()->RemoveObserver(this);
+  // Cancel the inflight verifications before |verifier_| goes away.
+  inflight_.clear();
+}
+
+int ChainCachingCertVerifier::Verify(const RequestParams& params,
+                                     CRLSet* crl_set,
+                                     CertVerifyResult* verify_result,
+                                     const CompletionCallback& callback,
+                                     std::unique_ptr<Request>* out_req,
+                                     const BoundNetLog& net_log) {
+  out_req->reset();
+
+  if (callback.is_null() || !verify_result || params.hostname().empty())
+    return ERR_INVALID_ARGUMENT;
+
+  requests_++;
+
+  std::string key = GetChainKey(params, crl_set);
+
+  const CachedResult* cached_result =
+      cache_.Get(key, base::TimeTicks::Now());
+  if (cached_result) {
+    ++cache_hits_;
+    return DeriveResult(params, cached_result->error, cached_result->result,
+                        verify_result);
+  }
+
+  JobMap::iterator it = inflight_.find(key);
+  if (it != inflight_.end()) {
+    ++inflight_joins_;
+    *out_req = it->second->CreateRequest(params, crl_set, verify_result,
+                                         callback, net_log);
+    return ERR_IO_PENDING;
+  }
+
+  std::unique_ptr<Job> job(new Job(this, key, params));
+  int rv = job->Start(verifier_.get(), crl_set, net_log);
+  if (rv != ERR_IO_PENDING) {
+    // Synchronous completion; nothing else can have joined the Job.
+    *verify_result = job->verify_result();
+    OnJobCompleted(job.get(), rv, *verify_result);
+    return rv;
+  }
+
+  *out_req =
+      job->CreateRequest(params, crl_set, verify_result, callback, net_log);
+  inflight_[key] = std::move(job);
+  return ERR_IO_PENDING;
+}
+
+bool ChainCachingCertVerifier::SupportsOCSPStapling() {
+  return verifier_->SupportsOCSPStapling();
+}
+
+ChainCachingCertVerifier::CachedResult::CachedResult() : error(ERR_FAILED) {}
+
+ChainCachingCertVerifier::CachedResult::~CachedResult() {}
+
+// static
+std::string ChainCachingCertVerifier::GetChainKey(const RequestParams& params,
+                                                  CRLSet* crl_set) {
+  // Like RequestParams, but without the hostname, and with the CRLSet.
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  std::string cert_der;
+  X509Certificate::GetDEREncoded(params.certificate()->os_cert_handle(),
+                                 &cert_der);
+  HashLengthPrefixed(&ctx, cert_der);
+  const X509Certificate::OSCertHandles& intermediates =
+      params.certificate()->GetIntermediateCertificates();
+  HashCount(&ctx, intermediates.size());
+  for (auto* cert_handle : intermediates) {
+    X509Certificate::GetDEREncoded(cert_handle, &cert_der);
+    HashLengthPrefixed(&ctx, cert_der);
+  }
+  int flags = params.flags();
+  SHA256_Update(&ctx, &flags, sizeof(flags));
+  HashLengthPrefixed(&ctx, params.ocsp_response());
+  HashCount(&ctx, params.additional_trust_anchors().size());
+  for (const auto& trust_anchor : params.additional_trust_anchors()) {
+    X509Certificate::GetDEREncoded(trust_anchor->os_cert_handle(), &cert_der);
+    HashLengthPrefixed(&ctx, cert_der);
+  }
+  uint32_t crl_set_sequence = crl_set ? crl_set->sequence() : 0;
+  SHA256_Update(&ctx, &crl_set_sequence, sizeof(crl_set_sequence));
+
+  std::string key;
+  SHA256_Final(reinterpret_cast<uint8_t*>(
+                   base::WriteInto(&key, SHA256_DIGEST_LENGTH + 1)),
+               &ctx);
+  return key;
+}
+
+// static
+bool ChainCachingCertVerifier::IsShareable(
+    int error,
+    const CertVerifyResult& verify_result) {
+  // Other errors, such as running out of resources, say nothing about the
+  // chain.
+  if (error != OK && !IsCertificateError(error))
+    return false;
+  // Whether the chain has other problems that the name mismatch hides is not
+  // known, so the request is verified again for other hostnames.
+  return !(verify_result.cert_status & CERT_STATUS_COMMON_NAME_INVALID);
+}
+
+// static
+int ChainCachingCertVerifier::DeriveResult(const RequestParams& params,
+                                           int chain_error,
+                                           const CertVerifyResult& chain_result,
+                                           CertVerifyResult* verify_result) {
+  DCHECK(IsShareable(chain_error, chain_result));
+
+  // These are the checks of CertVerifyProc and of the platform
+  // implementations that depend on the hostname.
+  *verify_result = chain_result;
+  verify_result->cert_status &= ~CERT_STATUS_NON_UNIQUE_NAME;
+  verify_result->common_name_fallback_used = false;
+  if (!params.certificate()->VerifyNameMatch(
+          params.hostname(), &verify_result->common_name_fallback_used)) {
+    verify_result->cert_status |= CERT_STATUS_COMMON_NAME_INVALID;
+  }
+  if (verify_result->is_issued_by_known_root &&
+      IsHostnameNonUnique(params.hostname())) {
+    verify_result->cert_status |= CERT_STATUS_NON_UNIQUE_NAME;
+  }
+
+  if (!(verify_result->cert_status & CERT_STATUS_COMMON_NAME_INVALID))
+    return chain_error;
+  // The name mismatch may be more serious than the errors of the chain.
+  return MapCertStatusToNetError(verify_result->cert_status);
+}
+
+std::unique_ptr<ChainCachingCertVerifier::Job>
+ChainCachingCertVerifier::OnJobCompleted(
+    Job* job,
+    int error,
+    const CertVerifyResult& verify_result) {
+  // Results that depend on the clock aren't cached, as the cache doesn't
+  // notice when the clock is corrected.
+  if (IsShareable(error, verify_result) &&
+      !(verify_result.cert_status & CERT_STATUS_DATE_INVALID)) {
+    CachedResult cached_result;
+    cached_result.error = error;
+    cached_result.result = verify_result;
+    base::TimeTicks now = base::TimeTicks::Now();
+    cache_.Put(job->key(), cached_result, now,
+               now + base::TimeDelta::FromSeconds(kTTLSecs));
+  }
+
+  JobMap::iterator it = inflight_.find(job->key());
+  if (it == inflight_.end() || it->second.get() != job)
+    return nullptr;
+  std::unique_ptr<Job> owned_job = std::move(it->second);
+  inflight_.erase(it);
+  return owned_job;
+}
+
+void ChainCachingCertVerifier::OnJobAbandoned(Job* job) {
+  JobMap::iterator it = inflight_.find(job->key());
+  DCHECK(it != inflight_.end());
+  DCHECK_EQ(job, it->second.get());
+  inflight_.erase(it);
+}
+
+void ChainCachingCertVerifier::OnCACertChanged(const X509Certificate* cert) {
+  ClearCache();
+}
+
+void ChainCachingCertVerifier::ClearCache() {
+  cache_.Clear();
+}
+
+size_t ChainCachingCertVerifier::GetCacheSize() const {
+  return cache_.size();
+}
+
+}  // namespace net
@@ -0,0 +1,153 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_CERT_CHAIN_CACHING_CERT_VERIFIER_H_
+#define NET_CERT_CHAIN_CACHING_CERT_VERIFIER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/gtest_prod_util.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "net/base/expiring_cache.h"
+#include "net/base/net_export.h"
+#include "net/cert/cert_database.h"
+#include "net/cert/cert_verifier.h"
+#include "net/cert/cert_verify_result.h"
+
+namespace net {
+
+// CertVerifier that shares verifications of the same certificate chain
+// between requests for different hostnames.
+//
+// Building and checking a chain is expensive, while matching a verified
+// certificate against a hostname is cheap, and large sites commonly serve one
+// certificate for many hostnames. The verifiers below this one key their work
+// on the full RequestParams, so each of those hostnames is verified from
+// scratch; after a restart they all reach the worker pool at the same time.
+//
+// ChainCachingCertVerifier instead keys on everything but the hostname: the
+// certificate and its intermediates, the flags, the stapled OCSP response,
+// the CRLSet and the additional trust anchors.
+//   - A request whose chain is already being verified joins that
+//     verification instead of starting its own.
+//   - Results are cached for a limited time.
+// In both cases the result is derived for the request's hostname by redoing
+// the hostname-dependent checks on the origin thread. Results that depend on
+// the hostname in a way that can't be redone, such as a name mismatch for the
+// hostname that was verified, are not shared.
+//
+// This is not part of CertVerifier::CreateDefault(). The platform
+// CertVerifyProcs are given the hostname and may apply per-host policy, such
+// as the per-domain trust anchors and pins of Android's TrustManager, so their
+// results can't in general be reused for another hostname. Only wrap a
+// verifier whose results depend on the hostname through the checks that are
+// redone here.
+class NET_EXPORT ChainCachingCertVerifier : public CertVerifier,
+                                            public CertDatabase::Observer {
+ public:
+  // Creates a ChainCachingCertVerifier that will use |verifier| to perform
+  // the actual verifications.
+  explicit ChainCachingCertVerifier(std::unique_ptr<CertVerifier> verifier);
+
+  ~ChainCachingCertVerifier() override;
+
+  // CertVerifier implementation:
+  int Verify(const RequestParams& params,
+             CRLSet* crl_set,
+             CertVerifyResult* verify_result,
+             const CompletionCallback& callback,
+             std::unique_ptr<Request>* out_req,
+             const BoundNetLog& net_log) override;
+  bool SupportsOCSPStapling() override;
+
+ private:
+  class Job;
+  class JobRequest;
+  FRIEND_TEST_ALL_PREFIXES(ChainCachingCertVerifierTest, CacheHit);
+  FRIEND_TEST_ALL_PREFIXES(ChainCachingCertVerifierTest,
+                           CacheHitKeepsChainErrors);
+  FRIEND_TEST_ALL_PREFIXES(ChainCachingCertVerifierTest,
+                           ChainKeySeparatesFields);
+  FRIEND_TEST_ALL_PREFIXES(ChainCachingCertVerifierTest, DifferentFlags);
+  FRIEND_TEST_ALL_PREFIXES(ChainCachingCertVerifierTest, JoinsInflightChain);
+  FRIEND_TEST_ALL_PREFIXES(ChainCachingCertVerifierTest,
+                           NameMismatchIsNotShared);
+
+  struct CachedResult {
+    CachedResult();
+    ~CachedResult();
+
+    int error;
+    CertVerifyResult result;
+  };
+
+  using ChainResultCache = ExpiringCache<std::string,
+                                         CachedResult,
+                                         base::TimeTicks,
+                                         std::less<base::TimeTicks>>;
+  using JobMap = std::map<std::string, std::unique_ptr<Job>>;
+
+  // Returns the key shared by all requests for the same chain as |params|
+  // and |crl_set|.
+  static std::string GetChainKey(const RequestParams& params, CRLSet* crl_set);
+
+  // Returns whether |error| and |verify_result|, obtained for one hostname,
+  // may be used for other hostnames.
+  static bool IsShareable(int error, const CertVerifyResult& verify_result);
+
+  // Fills in |verify_result| for |params| from |chain_result|, a shareable
+  // result for the same chain and another hostname, and returns the matching
+  // error.
+  static int DeriveResult(const RequestParams& params,
+                          int chain_error,
+                          const CertVerifyResult& chain_result,
+                          CertVerifyResult* verify_result);
+
+  // Called by |job| when its verification completes, before its requests are
+  // notified. Caches the result if it can be shared, and passes ownership of
+  // |job| back to the caller.
+  std::unique_ptr<Job> OnJobCompleted(Job* job,
+                                      int error,
+                                      const CertVerifyResult& verify_result);
+
+  // Called when the last request attached to |job| is cancelled.
+  void OnJobAbandoned(Job* job);
+
+  // CertDatabase::Observer methods:
+  void OnCACertChanged(const X509Certificate* cert) override;
+
+  // For unit testing.
+  void ClearCache();
+  size_t GetCacheSize() const;
+  uint64_t requests() const { return requests_; }
+  uint64_t cache_hits() const { return cache_hits_; }
+  uint64_t inflight_joins() const { return inflight_joins_; }
+
+  std::unique_ptr<CertVerifier> verifier_;
+
+  // Jobs for the chains that are currently being verified, by chain key.
+  JobMap inflight_;
+
+  ChainResultCache cache_;
+
+  uint64_t requests_;
+  uint64_t cache_hits_;
+  uint64_t inflight_joins_;
+
+  base::WeakPtrFactory<ChainCachingCertVerifier> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChainCachingCertVerifier);
+};
+
+}  // namespace net
+
+#endif  // NET_CERT_CHAIN_CACHING_CERT_VERIFIER_H_
@@ -0,0 +1,155 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert/chain_caching_cert_verifier.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/time/time.h"
+#include "crypto/sha2.h"
+#include "net/base/net_errors.h"
+#include "net/cert/caching_cert_verifier.h"
+#include "net/cert/cert_status_flags.h"
+#include "net/cert/cert_verify_proc.h"
+#include "net/cert/cert_verify_result.h"
+#include "net/cert/multi_threaded_cert_verifier.h"
+#include "net/cert/x509_certificate.h"
+#include "net/log/net_log.h"
+#include "net/test/test_certificate_data.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumHostnames = 200;
+const int kConnectionsPerHostname = 5;
+
+// Number of hashes of the certificate that stand in for building and
+// checking its chain.
+const int kChainCost = 2000;
+
+// A CertVerifyProc that spends a fixed amount of CPU time on every
+// verification, and accepts the certificate for any hostname it is valid for.
+class SlowCertVerifyProc : public CertVerifyProc {
+ public:
+  SlowCertVerifyProc() {}
+
+ private:
+  ~SlowCertVerifyProc() override {}
+
+  // CertVerifyProc implementation
+  bool SupportsAdditionalTrustAnchors() const override { return false; }
+  bool SupportsOCSPStapling() const override { return false; }
+
+  int VerifyInternal(X509Certificate* cert,
+                     const std::string& hostname,
+                     const std::string& ocsp_response,
+                     int flags,
+                     CRLSet* crl_set,
+                     const CertificateList& additional_trust_anchors,
+                     CertVerifyResult* verify_result) override {
+    std::string der;
+    X509Certificate::GetDEREncoded(cert->os_cert_handle(), &der);
+    for (int i = 0; i < kChainCost; ++i)
+      der = crypto::SHA256HashString(der);
+
+    if (!cert->VerifyNameMatch(hostname,
+                               &verify_result->common_name_fallback_used)) {
+      verify_result->cert_status |= CERT_STATUS_COMMON_NAME_INVALID;
+    }
+    return IsCertStatusError(verify_result->cert_status)
+               ? MapCertStatusToNetError(verify_result->cert_status)
+               : OK;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SlowCertVerifyProc);
+};
+
+class ChainCachingCertVerifierPerfTest : public testing::Test {
+ protected:
+  // Verifies every connection to kNumHostnames hostnames that share a
+  // certificate, all at once as after a restart, and logs the throughput.
+  void RunConnections(const std::string& name,
+                      std::unique_ptr<CertVerifier> verifier) {
+    scoped_refptr<X509Certificate> cert(X509Certificate::CreateFromBytes(
+        reinterpret_cast<const char*>(webkit_der), sizeof(webkit_der)));
+    ASSERT_TRUE(cert);
+
+    const int num_connections = kNumHostnames * kConnectionsPerHostname;
+    std::vector<CertVerifyResult> verify_results(num_connections);
+    std::vector<std::unique_ptr<CertVerifier::Request>> requests(
+        num_connections);
+    base::RunLoop run_loop;
+    int pending = 0;
+    CompletionCallback callback =
+        base::Bind(&ChainCachingCertVerifierPerfTest::OnVerifyComplete,
+                   base::Unretained(&pending), run_loop.QuitClosure());
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    base::PerfTimeLogger timer(
+        base::StringPrintf("CertVerifier_%d_connections_%s", num_connections,
+                           name.c_str())
+            .c_str());
+    for (int i = 0; i < num_connections; ++i) {
+      std::string hostname =
+          base::StringPrintf("host%d.webkit.org", i % kNumHostnames);
+      int rv = verifier->Verify(
+          CertVerifier::RequestParams(cert, hostname, 0, std::string(),
+                                      CertificateList()),
+          nullptr, &verify_results[i], callback, &requests[i], BoundNetLog());
+      if (rv == ERR_IO_PENDING)
+        ++pending;
+      else
+        EXPECT_EQ(OK, rv);
+    }
+    if (pending)
+      run_loop.Run();
+    timer.Done();
+
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    LOG(INFO) << name << ": "
+              << static_cast<int>(num_connections / elapsed.InSecondsF())
+              << " connections verified per second";
+    for (const CertVerifyResult& verify_result : verify_results)
+      EXPECT_EQ(0u, verify_result.cert_status);
+  }
+
+ private:
+  static void OnVerifyComplete(int* pending,
+                               const base::Closure& quit_closure,
+                               int result) {
+    EXPECT_EQ(OK, result);
+    if (!--*pending)
+      quit_closure.Run();
+  }
+
+  base::MessageLoopForIO message_loop_;
+};
+
+TEST_F(ChainCachingCertVerifierPerfTest, SharedCertificate) {
+  RunConnections("current",
+                 base::MakeUnique<CachingCertVerifier>(
+                     base::MakeUnique<MultiThreadedCertVerifier>(
+                         new SlowCertVerifyProc())));
+  RunConnections("chain_caching",
+                 base::MakeUnique<CachingCertVerifier>(
+                     base::MakeUnique<ChainCachingCertVerifier>(
+                         base::MakeUnique<MultiThreadedCertVerifier>(
+                             new SlowCertVerifyProc()))));
+}
+
+}  // namespace
+
+}  // namespace net
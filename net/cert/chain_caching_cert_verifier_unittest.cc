@@ -0,0 +1,356 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert/chain_caching_cert_verifier.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/callback_helpers.h"
+#include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/cert/cert_status_flags.h"
+#include "net/cert/cert_verifier.h"
+#include "net/cert/cert_verify_result.h"
+#include "net/cert/mock_cert_verifier.h"
+#include "net/cert/x509_certificate.h"
+#include "net/log/net_log.h"
+#include "net/test/gtest_util.h"
+#include "net/test/test_certificate_data.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using net::test::IsError;
+using net::test::IsOk;
+
+namespace net {
+
+namespace {
+
+// A CertVerifier whose verifications only complete when the test completes
+// them.
+class PendingCertVerifier : public CertVerifier {
+ public:
+  struct Verification {
+    Verification(const RequestParams& params,
+                 CertVerifyResult* verify_result,
+                 const CompletionCallback& callback)
+        : params(params),
+          verify_result(verify_result),
+          callback(callback),
+          done(false),
+          cancelled(false) {}
+
+    const RequestParams params;
+    CertVerifyResult* verify_result;
+    CompletionCallback callback;
+    bool done;
+    bool cancelled;
+  };
+
+  PendingCertVerifier() {}
+  ~PendingCertVerifier() override {}
+
+  // CertVerifier implementation:
+  int Verify(const RequestParams& params,
+             CRLSet* crl_set,
+             CertVerifyResult* verify_result,
+             const CompletionCallback& callback,
+             std::unique_ptr<Request>* out_req,
+             const BoundNetLog& net_log) override {
+    verifications_.push_back(
+        base::MakeUnique<Verification>(params, verify_result, callback));
+    out_req->reset(new PendingRequest(verifications_.back().get()));
+    return ERR_IO_PENDING;
+  }
+
+  size_t num_verifications() const { return verifications_.size(); }
+  const Verification& verification(size_t i) const {
+    return *verifications_[i];
+  }
+
+  // Completes the |i|th verification with |error| and |cert_status|.
+  void Complete(size_t i, int error, CertStatus cert_status) {
+    Verification* verification = verifications_[i].get();
+    ASSERT_FALSE(verification->done);
+    ASSERT_FALSE(verification->cancelled);
+    verification->done = true;
+    verification->verify_result->Reset();
+    verification->verify_result->verified_cert =
+        verification->params.certificate();
+    verification->verify_result->cert_status = cert_status;
+    base::ResetAndReturn(&verification->callback).Run(error);
+  }
+
+ private:
+  class PendingRequest : public CertVerifier::Request {
+   public:
+    explicit PendingRequest(Verification* verification)
+        : verification_(verification) {}
+    ~PendingRequest() override {
+      if (!verification_->done)
+        verification_->cancelled = true;
+    }
+
+   private:
+    Verification* verification_;
+  };
+
+  std::vector<std::unique_ptr<Verification>> verifications_;
+};
+
+// Returns a certificate for *.webkit.org and webkit.org.
+scoped_refptr<X509Certificate> GetWebkitCert() {
+  return X509Certificate::CreateFromBytes(
+      reinterpret_cast<const char*>(webkit_der), sizeof(webkit_der));
+}
+
+CertVerifier::RequestParams WebkitParams(
+    const scoped_refptr<X509Certificate>& cert,
+    const std::string& hostname) {
+  return CertVerifier::RequestParams(cert, hostname, 0, std::string(),
+                                     CertificateList());
+}
+
+}  // namespace
+
+class ChainCachingCertVerifierTest : public ::testing::Test {
+ public:
+  ChainCachingCertVerifierTest() : cert_(GetWebkitCert()) {}
+  ~ChainCachingCertVerifierTest() override {}
+
+ protected:
+  // Creates |verifier_| on top of |verifier|.
+  void CreateVerifier(std::unique_ptr<CertVerifier> verifier) {
+    verifier_.reset(new ChainCachingCertVerifier(std::move(verifier)));
+  }
+
+  // Creates |verifier_| on top of a PendingCertVerifier, and returns the
+  // latter.
+  PendingCertVerifier* CreatePendingVerifier() {
+    PendingCertVerifier* pending_verifier = new PendingCertVerifier();
+    CreateVerifier(base::WrapUnique(pending_verifier));
+    return pending_verifier;
+  }
+
+  int Verify(const std::string& hostname,
+             CertVerifyResult* verify_result,
+             const CompletionCallback& callback,
+             std::unique_ptr<CertVerifier::Request>* request) {
+    return verifier_->Verify(WebkitParams(cert_, hostname), nullptr,
+                             verify_result, callback, request, BoundNetLog());
+  }
+
+  scoped_refptr<X509Certificate> cert_;
+  std::unique_ptr<ChainCachingCertVerifier> verifier_;
+};
+
+TEST_F(ChainCachingCertVerifierTest, CacheHit) {
+  std::unique_ptr<MockCertVerifier> mock_verifier(new MockCertVerifier());
+  mock_verifier->set_default_result(OK);
+  CreateVerifier(std::move(mock_verifier));
+
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  std::unique_ptr<CertVerifier::Request> request;
+
+  EXPECT_THAT(callback.GetResult(Verify("www.webkit.org", &verify_result,
+                                        callback.callback(), &request)),
+              IsOk());
+  EXPECT_EQ(1u, verifier_->requests());
+  EXPECT_EQ(0u, verifier_->cache_hits());
+  EXPECT_EQ(1u, verifier_->GetCacheSize());
+
+  // Another hostname the certificate is valid for.
+  EXPECT_THAT(
+      Verify("bugs.webkit.org", &verify_result, callback.callback(), &request),
+      IsOk());
+  EXPECT_FALSE(request);
+  EXPECT_EQ(0u, verify_result.cert_status);
+  EXPECT_EQ(2u, verifier_->requests());
+  EXPECT_EQ(1u, verifier_->cache_hits());
+
+  // A hostname the certificate isn't valid for.
+  EXPECT_THAT(
+      Verify("www.example.com", &verify_result, callback.callback(), &request),
+      IsError(ERR_CERT_COMMON_NAME_INVALID));
+  EXPECT_FALSE(request);
+  EXPECT_EQ(CERT_STATUS_COMMON_NAME_INVALID, verify_result.cert_status);
+  EXPECT_EQ(3u, verifier_->requests());
+  EXPECT_EQ(2u, verifier_->cache_hits());
+  EXPECT_EQ(1u, verifier_->GetCacheSize());
+
+  verifier_->ClearCache();
+  EXPECT_EQ(0u, verifier_->GetCacheSize());
+}
+
+// A chain error is kept when the name also mismatches, unless the mismatch is
+// more serious.
+TEST_F(ChainCachingCertVerifierTest, CacheHitKeepsChainErrors) {
+  CreateVerifier(base::MakeUnique<MockCertVerifier>());
+
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  std::unique_ptr<CertVerifier::Request> request;
+
+  EXPECT_THAT(callback.GetResult(Verify("www.webkit.org", &verify_result,
+                                        callback.callback(), &request)),
+              IsError(ERR_CERT_INVALID));
+  EXPECT_THAT(
+      Verify("www.example.com", &verify_result, callback.callback(), &request),
+      IsError(ERR_CERT_INVALID));
+  EXPECT_EQ(CERT_STATUS_INVALID | CERT_STATUS_COMMON_NAME_INVALID,
+            verify_result.cert_status);
+  EXPECT_EQ(1u, verifier_->cache_hits());
+}
+
+TEST_F(ChainCachingCertVerifierTest, JoinsInflightChain) {
+  PendingCertVerifier* pending_verifier = CreatePendingVerifier();
+
+  const char* const kHostnames[] = {"www.webkit.org", "bugs.webkit.org",
+                                    "www.example.com"};
+  CertVerifyResult verify_results[arraysize(kHostnames)];
+  TestCompletionCallback callbacks[arraysize(kHostnames)];
+  std::unique_ptr<CertVerifier::Request> requests[arraysize(kHostnames)];
+  for (size_t i = 0; i < arraysize(kHostnames); ++i) {
+    EXPECT_THAT(Verify(kHostnames[i], &verify_results[i],
+                       callbacks[i].callback(), &requests[i]),
+                IsError(ERR_IO_PENDING));
+    EXPECT_TRUE(requests[i]);
+  }
+  EXPECT_EQ(3u, verifier_->requests());
+  EXPECT_EQ(2u, verifier_->inflight_joins());
+  ASSERT_EQ(1u, pending_verifier->num_verifications());
+  EXPECT_EQ("www.webkit.org",
+            pending_verifier->verification(0).params.hostname());
+
+  pending_verifier->Complete(0, OK, 0);
+  EXPECT_THAT(callbacks[0].WaitForResult(), IsOk());
+  EXPECT_THAT(callbacks[1].WaitForResult(), IsOk());
+  EXPECT_EQ(0u, verify_results[1].cert_status);
+  EXPECT_THAT(callbacks[2].WaitForResult(),
+              IsError(ERR_CERT_COMMON_NAME_INVALID));
+  EXPECT_EQ(CERT_STATUS_COMMON_NAME_INVALID, verify_results[2].cert_status);
+
+  // The result was cached too.
+  EXPECT_EQ(1u, verifier_->GetCacheSize());
+  EXPECT_EQ(1u, pending_verifier->num_verifications());
+}
+
+// A result with a name mismatch is not shared, as the mismatch may hide other
+// errors; the other hostnames are verified on their own.
+TEST_F(ChainCachingCertVerifierTest, NameMismatchIsNotShared) {
+  PendingCertVerifier* pending_verifier = CreatePendingVerifier();
+
+  CertVerifyResult verify_result1;
+  TestCompletionCallback callback1;
+  std::unique_ptr<CertVerifier::Request> request1;
+  EXPECT_THAT(Verify("www.example.com", &verify_result1, callback1.callback(),
+                     &request1),
+              IsError(ERR_IO_PENDING));
+
+  CertVerifyResult verify_result2;
+  TestCompletionCallback callback2;
+  std::unique_ptr<CertVerifier::Request> request2;
+  EXPECT_THAT(Verify("www.webkit.org", &verify_result2, callback2.callback(),
+                     &request2),
+              IsError(ERR_IO_PENDING));
+  EXPECT_EQ(1u, verifier_->inflight_joins());
+
+  pending_verifier->Complete(0, ERR_CERT_COMMON_NAME_INVALID,
+                             CERT_STATUS_COMMON_NAME_INVALID);
+  EXPECT_THAT(callback1.WaitForResult(),
+              IsError(ERR_CERT_COMMON_NAME_INVALID));
+  EXPECT_EQ(0u, verifier_->GetCacheSize());
+
+  ASSERT_EQ(2u, pending_verifier->num_verifications());
+  EXPECT_EQ("www.webkit.org",
+            pending_verifier->verification(1).params.hostname());
+  EXPECT_FALSE(callback2.have_result());
+  pending_verifier->Complete(1, OK, 0);
+  EXPECT_THAT(callback2.WaitForResult(), IsOk());
+}
+
+// Requests for different flags don't share a verification.
+TEST_F(ChainCachingCertVerifierTest, DifferentFlags) {
+  PendingCertVerifier* pending_verifier = CreatePendingVerifier();
+
+  CertVerifyResult verify_result1;
+  TestCompletionCallback callback1;
+  std::unique_ptr<CertVerifier::Request> request1;
+  EXPECT_THAT(verifier_->Verify(WebkitParams(cert_, "www.webkit.org"), nullptr,
+                                &verify_result1, callback1.callback(),
+                                &request1, BoundNetLog()),
+              IsError(ERR_IO_PENDING));
+
+  CertVerifyResult verify_result2;
+  TestCompletionCallback callback2;
+  std::unique_ptr<CertVerifier::Request> request2;
+  EXPECT_THAT(verifier_->Verify(
+                  CertVerifier::RequestParams(
+                      cert_, "bugs.webkit.org", CertVerifier::VERIFY_EV_CERT,
+                      std::string(), CertificateList()),
+                  nullptr, &verify_result2, callback2.callback(), &request2,
+                  BoundNetLog()),
+              IsError(ERR_IO_PENDING));
+  EXPECT_EQ(0u, verifier_->inflight_joins());
+  EXPECT_EQ(2u, pending_verifier->num_verifications());
+}
+
+// The stapled OCSP response and the additional trust anchors don't run into
+// each other in the chain key.
+TEST_F(ChainCachingCertVerifierTest, ChainKeySeparatesFields) {
+  std::string cert_der;
+  ASSERT_TRUE(
+      X509Certificate::GetDEREncoded(cert_->os_cert_handle(), &cert_der));
+  CertVerifier::RequestParams anchor_params(cert_, "www.webkit.org", 0,
+                                            std::string(),
+                                            CertificateList(1, cert_));
+  CertVerifier::RequestParams ocsp_params(cert_, "www.webkit.org", 0, cert_der,
+                                          CertificateList());
+  EXPECT_NE(ChainCachingCertVerifier::GetChainKey(anchor_params, nullptr),
+            ChainCachingCertVerifier::GetChainKey(ocsp_params, nullptr));
+  EXPECT_EQ(ChainCachingCertVerifier::GetChainKey(
+                WebkitParams(cert_, "www.webkit.org"), nullptr),
+            ChainCachingCertVerifier::GetChainKey(
+                WebkitParams(cert_, "bugs.webkit.org"), nullptr));
+}
+
+// Cancelling every request attached to a verification cancels it.
+TEST_F(ChainCachingCertVerifierTest, CancelRequests) {
+  PendingCertVerifier* pending_verifier = CreatePendingVerifier();
+
+  CertVerifyResult verify_result1;
+  TestCompletionCallback callback1;
+  std::unique_ptr<CertVerifier::Request> request1;
+  EXPECT_THAT(Verify("www.webkit.org", &verify_result1, callback1.callback(),
+                     &request1),
+              IsError(ERR_IO_PENDING));
+
+  CertVerifyResult verify_result2;
+  TestCompletionCallback callback2;
+  std::unique_ptr<CertVerifier::Request> request2;
+  EXPECT_THAT(Verify("bugs.webkit.org", &verify_result2, callback2.callback(),
+                     &request2),
+              IsError(ERR_IO_PENDING));
+
+  // The verification goes on for the remaining request.
+  request1.reset();
+  EXPECT_FALSE(pending_verifier->verification(0).cancelled);
+
+  request2.reset();
+  EXPECT_TRUE(pending_verifier->verification(0).cancelled);
+  EXPECT_FALSE(callback1.have_result());
+  EXPECT_FALSE(callback2.have_result());
+
+  // A new request starts a new verification.
+  EXPECT_THAT(Verify("www.webkit.org", &verify_result1, callback1.callback(),
+                     &request1),
+              IsError(ERR_IO_PENDING));
+  EXPECT_EQ(2u, pending_verifier->num_verifications());
+}
+
+}  // namespace net
@@ -65,6 +65,7 @@
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 #include "net/cookies/canonical_cookie.h"
 #include "net/cookies/cookie_util.h"
+#include "net/cookies/hashed_cookie_jar.h"
 #include "net/cookies/parsed_cookie.h"
 #include "url/origin.h"
 
@@ -990,6 +991,17 @@ void CookieMonster::SetPersistSessionCookies(bool persist_session_cookies) {
   persist_session_cookies_ = persist_session_cookies;
 }
 
+// This function must be called before the CookieMonster is used.
+void CookieMonster::SetUseHashedCookieJar(bool use_hashed_cookie_jar) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK(!initialized_);
+  DCHECK(cookies_.empty());
+  if (use_hashed_cookie_jar)
+    hashed_jar_.reset(new HashedCookieJar);
+  else
+    hashed_jar_.reset();
+}
+
 bool CookieMonster::IsCookieableScheme(const std::string& scheme) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
@@ -1024,6 +1036,16 @@ CookieMonster::~CookieMonster() {
 
   // TODO(mmenke): Does it really make sense to run |delegate_| and
   // CookieChanged callbacks when the CookieStore is destroyed?
+  if (hashed_jar_) {
+    for (const std::string& key : hashed_jar_->GetKeys()) {
+      std::vector<CanonicalCookie*> cookies(
+          hashed_jar_->GetCookiesForKey(key));
+      for (CanonicalCookie* cc : cookies) {
+        InternalDeleteJarCookie(key, cc, false /* sync_to_store */,
+                                DELETE_COOKIE_DONT_RECORD);
+      }
+    }
+  }
   for (CookieMap::iterator cookie_it = cookies_.begin();
        cookie_it != cookies_.end();) {
     CookieMap::iterator current_cookie_it = cookie_it;
@@ -1091,15 +1113,26 @@ CookieList CookieMonster::GetAllCookies() {
   //
   // Note that this does not prune cookies to be below our limits (if we've
   // exceeded them) the way that calling GarbageCollect() would.
-  GarbageCollectExpired(
-      Time::Now(), CookieMapItPair(cookies_.begin(), cookies_.end()), NULL);
-
+  //
   // Copy the CanonicalCookie pointers from the map so that we can use the same
   // sorter as elsewhere, then copy the result out.
   std::vector<CanonicalCookie*> cookie_ptrs;
-  cookie_ptrs.reserve(cookies_.size());
-  for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end(); ++it)
-    cookie_ptrs.push_back(it->second);
+  if (hashed_jar_) {
+    const Time current(Time::Now());
+    for (const std::string& key : hashed_jar_->GetKeys()) {
+      GarbageCollectExpiredForJarKey(current, key);
+      const std::vector<CanonicalCookie*>& cookies =
+          hashed_jar_->GetCookiesForKey(key);
+      cookie_ptrs.insert(cookie_ptrs.end(), cookies.begin(), cookies.end());
+    }
+  } else {
+    GarbageCollectExpired(
+        Time::Now(), CookieMapItPair(cookies_.begin(), cookies_.end()), NULL);
+
+    cookie_ptrs.reserve(cookies_.size());
+    for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end(); ++it)
+      cookie_ptrs.push_back(it->second);
+  }
   std::sort(cookie_ptrs.begin(), cookie_ptrs.end(), CookieSorter);
 
   CookieList cookie_list;
@@ -1137,6 +1170,22 @@ int CookieMonster::DeleteAllCreatedBetween(const Time& delete_begin,
   DCHECK(thread_checker_.CalledOnValidThread());
 
   int num_deleted = 0;
+  if (hashed_jar_) {
+    for (const std::string& key : hashed_jar_->GetKeys()) {
+      std::vector<CanonicalCookie*> cookies(
+          hashed_jar_->GetCookiesForKey(key));
+      for (CanonicalCookie* cc : cookies) {
+        if (cc->CreationDate() >= delete_begin &&
+            (delete_end.is_null() || cc->CreationDate() < delete_end)) {
+          InternalDeleteJarCookie(key, cc, true, /*sync_to_store*/
+                                  DELETE_COOKIE_EXPLICIT);
+          ++num_deleted;
+        }
+      }
+    }
+    return num_deleted;
+  }
+
   for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
     CookieMap::iterator curit = it;
     CanonicalCookie* cc = curit->second;
@@ -1158,6 +1207,23 @@ int CookieMonster::DeleteAllCreatedBetweenWithPredicate(
     const base::Time& delete_end,
     const base::Callback<bool(const CanonicalCookie&)>& predicate) {
   int num_deleted = 0;
+  if (hashed_jar_) {
+    for (const std::string& key : hashed_jar_->GetKeys()) {
+      std::vector<CanonicalCookie*> cookies(
+          hashed_jar_->GetCookiesForKey(key));
+      for (CanonicalCookie* cc : cookies) {
+        if (cc->CreationDate() >= delete_begin &&
+            (delete_end.is_null() || cc->CreationDate() < delete_end) &&
+            predicate.Run(*cc)) {
+          InternalDeleteJarCookie(key, cc, true, /*sync_to_store*/
+                                  DELETE_COOKIE_EXPLICIT);
+          ++num_deleted;
+        }
+      }
+    }
+    return num_deleted;
+  }
+
   for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
     CookieMap::iterator curit = it;
     CanonicalCookie* cc = curit->second;
@@ -1231,6 +1297,14 @@ void CookieMonster::DeleteCookie(const GURL& url,
     matching_cookies.insert(cookie);
   }
 
+  if (hashed_jar_) {
+    // All of |cookies| came from the key for |url|.
+    const std::string key(GetKey(url.host()));
+    for (CanonicalCookie* cookie : matching_cookies)
+      InternalDeleteJarCookie(key, cookie, true, DELETE_COOKIE_EXPLICIT);
+    return;
+  }
+
   for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
     CookieMap::iterator curit = it;
     ++it;
@@ -1243,7 +1317,19 @@ void CookieMonster::DeleteCookie(const GURL& url,
 int CookieMonster::DeleteCanonicalCookie(const CanonicalCookie& cookie) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  for (CookieMapItPair its = cookies_.equal_range(GetKey(cookie.Domain()));
+  const std::string key(GetKey(cookie.Domain()));
+  if (hashed_jar_) {
+    for (CanonicalCookie* cc : hashed_jar_->GetCookiesForKey(key)) {
+      // The creation date acts as the unique index...
+      if (cc->CreationDate() == cookie.CreationDate()) {
+        InternalDeleteJarCookie(key, cc, true, DELETE_COOKIE_EXPLICIT);
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  for (CookieMapItPair its = cookies_.equal_range(key);
        its.first != its.second; ++its.first) {
     // The creation date acts as the unique index...
     if (its.first->second->CreationDate() == cookie.CreationDate()) {
@@ -1276,6 +1362,21 @@ int CookieMonster::DeleteSessionCookies() {
   DCHECK(thread_checker_.CalledOnValidThread());
 
   int num_deleted = 0;
+  if (hashed_jar_) {
+    for (const std::string& key : hashed_jar_->GetKeys()) {
+      std::vector<CanonicalCookie*> cookies(
+          hashed_jar_->GetCookiesForKey(key));
+      for (CanonicalCookie* cc : cookies) {
+        if (!cc->IsPersistent()) {
+          InternalDeleteJarCookie(key, cc, true, /*sync_to_store*/
+                                  DELETE_COOKIE_EXPIRED);
+          ++num_deleted;
+        }
+      }
+    }
+    return num_deleted;
+  }
+
   for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
     CookieMap::iterator curit = it;
     CanonicalCookie* cc = curit->second;
@@ -1388,6 +1489,7 @@ void CookieMonster::StoreLoadedCookies(
   // Even if a key is expired, insert it so it can be garbage collected,
   // removed, and sync'd.
   CookieItVector cookies_with_control_chars;
+  std::vector<CanonicalCookie*> jar_cookies_with_control_chars;
 
   for (std::vector<CanonicalCookie*>::const_iterator it = cookies.begin();
        it != cookies.end(); ++it) {
@@ -1403,7 +1505,10 @@ void CookieMonster::StoreLoadedCookies(
 
       if (ContainsControlCharacter((*it)->Name()) ||
           ContainsControlCharacter((*it)->Value())) {
-        cookies_with_control_chars.push_back(inserted);
+        if (hashed_jar_)
+          jar_cookies_with_control_chars.push_back(*it);
+        else
+          cookies_with_control_chars.push_back(inserted);
       }
     } else {
       LOG(ERROR) << base::StringPrintf(
@@ -1427,6 +1532,10 @@ void CookieMonster::StoreLoadedCookies(
 
     InternalDeleteCookie(*curit, true, DELETE_COOKIE_CONTROL_CHAR);
   }
+  for (CanonicalCookie* cc : jar_cookies_with_control_chars) {
+    InternalDeleteJarCookie(GetKey(cc->Domain()), cc, true,
+                            DELETE_COOKIE_CONTROL_CHAR);
+  }
 
   // After importing cookies from the PersistentCookieStore, verify that
   // none of our other constraints are violated.
@@ -1470,6 +1579,12 @@ void CookieMonster::InvokeQueue() {
 void CookieMonster::EnsureCookiesMapIsValid() {
   DCHECK(thread_checker_.CalledOnValidThread());
 
+  if (hashed_jar_) {
+    for (const std::string& key : hashed_jar_->GetKeys())
+      TrimDuplicateJarCookiesForKey(key);
+    return;
+  }
+
   // Iterate through all the of the cookies, grouped by host.
   CookieMap::iterator prev_range_end = cookies_.begin();
   while (prev_range_end != cookies_.end()) {
@@ -1558,6 +1673,37 @@ void CookieMonster::TrimDuplicateCookiesForKey(const std::string& key,
   DCHECK_EQ(num_duplicates, num_duplicates_found);
 }
 
+void CookieMonster::TrimDuplicateJarCookiesForKey(const std::string& key) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  // Maps each signature to the most recently created cookie that has it.
+  std::map<CookieSignature, CanonicalCookie*> newest_cookies;
+  std::vector<CanonicalCookie*> duplicates;
+  for (CanonicalCookie* cookie : hashed_jar_->GetCookiesForKey(key)) {
+    CookieSignature signature(cookie->Name(), cookie->Domain(), cookie->Path());
+    auto inserted = newest_cookies.insert(std::make_pair(signature, cookie));
+    if (inserted.second)
+      continue;
+
+    CanonicalCookie*& newest = inserted.first->second;
+    DCHECK(newest->CreationDate() != cookie->CreationDate())
+        << "Duplicate creation times found in duplicate cookie name scan.";
+    if (cookie->CreationDate() > newest->CreationDate())
+      std::swap(newest, cookie);
+    duplicates.push_back(cookie);
+  }
+
+  for (CanonicalCookie* cookie : duplicates) {
+    LOG(ERROR) << base::StringPrintf(
+        "Found duplicate cookie for host='%s', "
+        "with {name='%s', domain='%s', path='%s'}",
+        key.c_str(), cookie->Name().c_str(), cookie->Domain().c_str(),
+        cookie->Path().c_str());
+    InternalDeleteJarCookie(key, cookie, true,
+                            DELETE_COOKIE_DUPLICATE_IN_BACKING_STORE);
+  }
+}
+
 void CookieMonster::FindCookiesForHostAndDomain(
     const GURL& url,
     const CookieOptions& options,
@@ -1583,6 +1729,22 @@ void CookieMonster::FindCookiesForKey(const std::string& key,
                                       std::vector<CanonicalCookie*>* cookies) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
+  if (hashed_jar_) {
+    // Drop the expired cookies first, then collect matches before touching
+    // access times, since both reorder the jar's cookies for |key|.
+    GarbageCollectExpiredForJarKey(current, key);
+    size_t first_match = cookies->size();
+    for (CanonicalCookie* cc : hashed_jar_->GetCookiesForKey(key)) {
+      if (cc->IncludeForRequestURL(url, options))
+        cookies->push_back(cc);
+    }
+    if (options.update_access_time()) {
+      for (size_t i = first_match; i < cookies->size(); ++i)
+        InternalUpdateCookieAccessTime(key, (*cookies)[i], current);
+    }
+    return;
+  }
+
   for (CookieMapItPair its = cookies_.equal_range(key);
        its.first != its.second;) {
     CookieMap::iterator curit = its.first;
@@ -1604,7 +1766,7 @@ void CookieMonster::FindCookiesForKey(const std::string& key,
     // Add this cookie to the set of matching cookies. Update the access
     // time if we've been requested to do so.
     if (options.update_access_time()) {
-      InternalUpdateCookieAccessTime(cc, current);
+      InternalUpdateCookieAccessTime(key, cc, current);
     }
     cookies->push_back(cc);
   }
@@ -1624,56 +1786,92 @@ bool CookieMonster::DeleteAnyEquivalentCookie(const std::string& key,
 
   histogram_cookie_delete_equivalent_->Add(COOKIE_DELETE_EQUIVALENT_ATTEMPT);
 
+  DeletionCause deletion_cause = already_expired
+                                     ? DELETE_COOKIE_EXPIRED_OVERWRITE
+                                     : DELETE_COOKIE_OVERWRITE;
+
+  if (hashed_jar_) {
+    // At most one cookie is deleted, so defer it until the scan is done
+    // rather than mutate the jar's cookies for |key| during it.
+    CanonicalCookie* to_delete = nullptr;
+    for (CanonicalCookie* cc : hashed_jar_->GetCookiesForKey(key)) {
+      if (CheckEquivalentCookie(ecc, *cc, source_url, skip_httponly,
+                                enforce_strict_secure, &found_equivalent_cookie,
+                                &skipped_httponly, &skipped_secure_cookie)) {
+        to_delete = cc;
+      }
+    }
+    if (to_delete)
+      InternalDeleteJarCookie(key, to_delete, true, deletion_cause);
+    return skipped_httponly || skipped_secure_cookie;
+  }
+
   for (CookieMapItPair its = cookies_.equal_range(key);
        its.first != its.second;) {
     CookieMap::iterator curit = its.first;
     CanonicalCookie* cc = curit->second;
     ++its.first;
 
-    // If strict secure cookies is being enforced, then the equivalency
-    // requirements are looser. If the cookie is being set from an insecure
-    // scheme, then if a cookie already exists with the same name and it is
-    // Secure, then the cookie should *not* be updated if they domain-match and
-    // ignoring the path attribute.
-    //
-    // See: https://tools.ietf.org/html/draft-west-leave-secure-cookies-alone
-    if (enforce_strict_secure && cc->IsSecure() &&
-        !source_url.SchemeIsCryptographic() &&
-        ecc.IsEquivalentForSecureCookieMatching(*cc)) {
-      skipped_secure_cookie = true;
-      histogram_cookie_delete_equivalent_->Add(
-          COOKIE_DELETE_EQUIVALENT_SKIPPING_SECURE);
-      // If the cookie is equivalent to the new cookie and wouldn't have been
-      // skipped for being HTTP-only, record that it is a skipped secure cookie
-      // that would have been deleted otherwise.
-      if (ecc.IsEquivalent(*cc)) {
-        found_equivalent_cookie = true;
-
-        if (!skip_httponly || !cc->IsHttpOnly()) {
-          histogram_cookie_delete_equivalent_->Add(
-              COOKIE_DELETE_EQUIVALENT_WOULD_HAVE_DELETED);
-        }
-      }
-    } else if (ecc.IsEquivalent(*cc)) {
-      // We should never have more than one equivalent cookie, since they should
-      // overwrite each other, unless secure cookies require secure scheme is
-      // being enforced. In that case, cookies with different paths might exist
-      // and be considered equivalent.
-      CHECK(!found_equivalent_cookie)
-          << "Duplicate equivalent cookies found, cookie store is corrupted.";
-      if (skip_httponly && cc->IsHttpOnly()) {
-        skipped_httponly = true;
-      } else {
+    if (CheckEquivalentCookie(ecc, *cc, source_url, skip_httponly,
+                              enforce_strict_secure, &found_equivalent_cookie,
+                              &skipped_httponly, &skipped_secure_cookie)) {
+      InternalDeleteCookie(curit, true, deletion_cause);
+    }
+  }
+  return skipped_httponly || skipped_secure_cookie;
+}
+
+bool CookieMonster::CheckEquivalentCookie(const CanonicalCookie& ecc,
+                                          const CanonicalCookie& cc,
+                                          const GURL& source_url,
+                                          bool skip_httponly,
+                                          bool enforce_strict_secure,
+                                          bool* found_equivalent_cookie,
+                                          bool* skipped_httponly,
+                                          bool* skipped_secure_cookie) {
+  // If strict secure cookies is being enforced, then the equivalency
+  // requirements are looser. If the cookie is being set from an insecure
+  // scheme, then if a cookie already exists with the same name and it is
+  // Secure, then the cookie should *not* be updated if they domain-match and
+  // ignoring the path attribute.
+  //
+  // See: https://tools.ietf.org/html/draft-west-leave-secure-cookies-alone
+  if (enforce_strict_secure && cc.IsSecure() &&
+      !source_url.SchemeIsCryptographic() &&
+      ecc.IsEquivalentForSecureCookieMatching(cc)) {
+    *skipped_secure_cookie = true;
+    histogram_cookie_delete_equivalent_->Add(
+        COOKIE_DELETE_EQUIVALENT_SKIPPING_SECURE);
+    // If the cookie is equivalent to the new cookie and wouldn't have been
+    // skipped for being HTTP-only, record that it is a skipped secure cookie
+    // that would have been deleted otherwise.
+    if (ecc.IsEquivalent(cc)) {
+      *found_equivalent_cookie = true;
+
+      if (!skip_httponly || !cc.IsHttpOnly()) {
         histogram_cookie_delete_equivalent_->Add(
-            COOKIE_DELETE_EQUIVALENT_FOUND);
-        InternalDeleteCookie(curit, true, already_expired
-                                              ? DELETE_COOKIE_EXPIRED_OVERWRITE
-                                              : DELETE_COOKIE_OVERWRITE);
+            COOKIE_DELETE_EQUIVALENT_WOULD_HAVE_DELETED);
       }
-      found_equivalent_cookie = true;
     }
+    return false;
   }
-  return skipped_httponly || skipped_secure_cookie;
+
+  if (!ecc.IsEquivalent(cc))
+    return false;
+
+  // We should never have more than one equivalent cookie, since they should
+  // overwrite each other, unless secure cookies require secure scheme is
+  // being enforced. In that case, cookies with different paths might exist
+  // and be considered equivalent.
+  CHECK(!*found_equivalent_cookie)
+      << "Duplicate equivalent cookies found, cookie store is corrupted.";
+  *found_equivalent_cookie = true;
+  if (skip_httponly && cc.IsHttpOnly()) {
+    *skipped_httponly = true;
+    return false;
+  }
+  histogram_cookie_delete_equivalent_->Add(COOKIE_DELETE_EQUIVALENT_FOUND);
+  return true;
 }
 
 CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
@@ -1691,8 +1889,11 @@ CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
   if ((cc->IsPersistent() || persist_session_cookies_) && store_.get() &&
       sync_to_store)
     store_->AddCookie(*cc);
-  CookieMap::iterator inserted =
-      cookies_.insert(CookieMap::value_type(key, cc));
+  CookieMap::iterator inserted = cookies_.end();
+  if (hashed_jar_)
+    hashed_jar_->Insert(key, base::WrapUnique(cc));
+  else
+    inserted = cookies_.insert(CookieMap::value_type(key, cc));
   if (delegate_.get()) {
     delegate_->OnCookieChanged(*cc, false,
                                CookieMonsterDelegate::CHANGE_COOKIE_EXPLICIT);
@@ -1825,7 +2026,8 @@ bool CookieMonster::SetCanonicalCookies(const CookieList& list) {
   return true;
 }
 
-void CookieMonster::InternalUpdateCookieAccessTime(CanonicalCookie* cc,
+void CookieMonster::InternalUpdateCookieAccessTime(const std::string& key,
+                                                   CanonicalCookie* cc,
                                                    const Time& current) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
@@ -1836,7 +2038,10 @@ void CookieMonster::InternalUpdateCookieAccessTime(CanonicalCookie* cc,
   if ((current - cc->LastAccessDate()) < last_access_threshold_)
     return;
 
-  cc->SetLastAccessDate(current);
+  if (hashed_jar_)
+    hashed_jar_->UpdateAccessDate(key, cc, current);
+  else
+    cc->SetLastAccessDate(current);
   if ((cc->IsPersistent() || persist_session_cookies_) && store_.get())
     store_->UpdateCookieAccessTime(*cc);
 }
@@ -1848,6 +2053,28 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
                                          DeletionCause deletion_cause) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
+  CanonicalCookie* cc = it->second;
+  OnCookieDeleted(*cc, sync_to_store, deletion_cause);
+  cookies_.erase(it);
+  delete cc;
+}
+
+void CookieMonster::InternalDeleteJarCookie(const std::string& key,
+                                            CanonicalCookie* cc,
+                                            bool sync_to_store,
+                                            DeletionCause deletion_cause) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  OnCookieDeleted(*cc, sync_to_store, deletion_cause);
+  std::unique_ptr<CanonicalCookie> removed = hashed_jar_->Remove(key, cc);
+  DCHECK(removed);
+}
+
+void CookieMonster::OnCookieDeleted(const CanonicalCookie& cc,
+                                    bool sync_to_store,
+                                    DeletionCause deletion_cause) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
   // Ideally, this would be asserted up where we define ChangeCauseMapping,
   // but DeletionCause's visibility (or lack thereof) forces us to make
   // this check here.
@@ -1858,23 +2085,20 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
   if (deletion_cause != DELETE_COOKIE_DONT_RECORD)
     histogram_cookie_deletion_cause_->Add(deletion_cause);
 
-  CanonicalCookie* cc = it->second;
   VLOG(kVlogSetCookies) << "InternalDeleteCookie()"
                         << ", cause:" << deletion_cause
-                        << ", cc: " << cc->DebugString();
+                        << ", cc: " << cc.DebugString();
 
-  if ((cc->IsPersistent() || persist_session_cookies_) && store_.get() &&
+  if ((cc.IsPersistent() || persist_session_cookies_) && store_.get() &&
       sync_to_store)
-    store_->DeleteCookie(*cc);
+    store_->DeleteCookie(cc);
   if (delegate_.get()) {
     ChangeCausePair mapping = ChangeCauseMapping[deletion_cause];
 
     if (mapping.notify)
-      delegate_->OnCookieChanged(*cc, true, mapping.cause);
+      delegate_->OnCookieChanged(cc, true, mapping.cause);
   }
-  RunCookieChangedCallbacks(*cc, true);
-  cookies_.erase(it);
-  delete cc;
+  RunCookieChangedCallbacks(cc, true);
 }
 
 // Domain expiry behavior is unchanged by key/expiry scheme (the
@@ -1884,6 +2108,9 @@ size_t CookieMonster::GarbageCollect(const Time& current,
                                      bool enforce_strict_secure) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
+  if (hashed_jar_)
+    return GarbageCollectHashedJar(current, key, enforce_strict_secure);
+
   size_t num_deleted = 0;
   Time safe_date(Time::Now() - TimeDelta::FromDays(kSafeFromGlobalPurgeDays));
 
@@ -2024,6 +2251,61 @@ size_t CookieMonster::GarbageCollect(const Time& current,
   return num_deleted;
 }
 
+size_t CookieMonster::GarbageCollectHashedJar(const Time& current,
+                                              const std::string& key,
+                                              bool enforce_strict_secure) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  size_t num_deleted = 0;
+  Time safe_date(Time::Now() - TimeDelta::FromDays(kSafeFromGlobalPurgeDays));
+  HashedCookieJar::CookieVector evicted;
+
+  // Collect garbage for this key. The jar applies the same priority and secure
+  // purge rounds as GarbageCollect(), walking the key's cookies in access
+  // order.
+  if (hashed_jar_->CountForKey(key) > kDomainMaxCookies) {
+    VLOG(kVlogGarbageCollection) << "GarbageCollect() key: " << key;
+
+    num_deleted += GarbageCollectExpiredForJarKey(current, key);
+
+    size_t num_cookies = hashed_jar_->CountForKey(key);
+    if (num_cookies > kDomainMaxCookies) {
+      VLOG(kVlogGarbageCollection) << "Deep Garbage Collect domain.";
+      size_t purge_goal =
+          num_cookies - (kDomainMaxCookies - kDomainPurgeCookies);
+      num_deleted += hashed_jar_->EvictFromKey(key, purge_goal,
+                                               enforce_strict_secure, &evicted);
+      for (const auto& cc : evicted)
+        OnCookieDeleted(*cc, true, DELETE_COOKIE_EVICTED_DOMAIN);
+      evicted.clear();
+    }
+  }
+
+  // Collect garbage for everything. The least recently accessed cookies are at
+  // the heads of the jar's LRU lists, so nothing needs to be sorted.
+  if (hashed_jar_->size() > kMaxCookies && earliest_access_time_ < safe_date) {
+    VLOG(kVlogGarbageCollection) << "GarbageCollect() everything";
+
+    for (const std::string& jar_key : hashed_jar_->GetKeys())
+      num_deleted += GarbageCollectExpiredForJarKey(current, jar_key);
+
+    if (hashed_jar_->size() > kMaxCookies) {
+      VLOG(kVlogGarbageCollection) << "Deep Garbage Collect everything.";
+      size_t purge_goal = hashed_jar_->size() - (kMaxCookies - kPurgeCookies);
+      num_deleted += hashed_jar_->EvictLeastRecentlyAccessed(
+          purge_goal, safe_date, enforce_strict_secure, &evicted);
+      for (const auto& cc : evicted) {
+        histogram_evicted_last_access_minutes_->Add(
+            (current - cc->LastAccessDate()).InMinutes());
+        OnCookieDeleted(*cc, true, DELETE_COOKIE_EVICTED_GLOBAL);
+      }
+      earliest_access_time_ = hashed_jar_->EarliestAccessDate();
+    }
+  }
+
+  return num_deleted;
+}
+
 size_t CookieMonster::PurgeLeastRecentMatches(CookieItVector* cookies,
                                               CookiePriority priority,
                                               size_t to_protect,
@@ -2097,6 +2379,17 @@ size_t CookieMonster::GarbageCollectExpired(const Time& current,
   return num_deleted;
 }
 
+size_t CookieMonster::GarbageCollectExpiredForJarKey(const Time& current,
+                                                     const std::string& key) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  HashedCookieJar::CookieVector expired;
+  size_t num_deleted = hashed_jar_->EvictExpiredForKey(key, current, &expired);
+  for (const auto& cc : expired)
+    OnCookieDeleted(*cc, true, DELETE_COOKIE_EXPIRED);
+  return num_deleted;
+}
+
 size_t CookieMonster::GarbageCollectDeleteRange(
     const Time& current,
     DeletionCause cause,
@@ -2212,7 +2505,7 @@ void CookieMonster::RecordPeriodicStats(const base::Time& current_time) {
   }
 
   // See InitializeHistograms() for details.
-  histogram_count_->Add(cookies_.size());
+  histogram_count_->Add(hashed_jar_ ? hashed_jar_->size() : cookies_.size());
 
   // More detailed statistics on cookie counts at different granularities.
   last_statistic_record_time_ = current_time;
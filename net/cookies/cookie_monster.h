@@ -40,6 +40,7 @@ class HistogramBase;
 namespace net {
 
 class CookieMonsterDelegate;
+class HashedCookieJar;
 
 // The cookie monster is the system for storing and retrieving cookies. It has
 // an in-memory list of all cookies, and synchronizes non-session cookies to an
@@ -202,6 +203,12 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // (i.e. as part of the instance initialization process).
   void SetPersistSessionCookies(bool persist_session_cookies);
 
+  // Stores cookies in a HashedCookieJar instead of a CookieMap. The jar keeps
+  // each eTLD+1's cookies together and the whole store in access order, so
+  // lookups and garbage collection stay cheap for very large stores. If this
+  // method is called, it must be called before first use of the instance.
+  void SetUseHashedCookieJar(bool use_hashed_cookie_jar);
+
   // Determines if the scheme of the URL is a scheme that cookies will be
   // stored for.
   bool IsCookieableScheme(const std::string& scheme);
@@ -248,6 +255,7 @@ class NET_EXPORT CookieMonster : public CookieStore {
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestTotalGarbageCollection);
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, GarbageCollectionTriggers);
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestGCTimes);
+  FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestLargeJarGlobalGC);
 
   // For validation of key values.
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestDomainTree);
@@ -477,6 +485,10 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                   CookieMap::iterator begin,
                                   CookieMap::iterator end);
 
+  // Like TrimDuplicateCookiesForKey(), for the cookies stored under |key| in
+  // |hashed_jar_|.
+  void TrimDuplicateJarCookiesForKey(const std::string& key);
+
   void SetDefaultCookieableSchemes();
 
   void FindCookiesForHostAndDomain(const GURL& url,
@@ -505,8 +517,21 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                  bool already_expired,
                                  bool enforce_strict_secure);
 
+  // Helper for DeleteAnyEquivalentCookie(). Compares the stored cookie |cc|
+  // with |ecc|, updating the histogram and the three flags, and returns true
+  // if |cc| should be deleted.
+  bool CheckEquivalentCookie(const CanonicalCookie& ecc,
+                             const CanonicalCookie& cc,
+                             const GURL& source_url,
+                             bool skip_httponly,
+                             bool enforce_strict_secure,
+                             bool* found_equivalent_cookie,
+                             bool* skipped_httponly,
+                             bool* skipped_secure_cookie);
+
   // Takes ownership of *cc. Returns an iterator that points to the inserted
-  // cookie in cookies_. Guarantee: all iterators to cookies_ remain valid.
+  // cookie in cookies_, or cookies_.end() if the cookie went into
+  // |hashed_jar_|. Guarantee: all iterators to cookies_ remain valid.
   CookieMap::iterator InternalInsertCookie(const std::string& key,
                                            CanonicalCookie* cc,
                                            const GURL& source_url,
@@ -530,7 +555,9 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // Helper function calling SetCanonicalCookie() for all cookies in |list|.
   bool SetCanonicalCookies(const CookieList& list);
 
-  void InternalUpdateCookieAccessTime(CanonicalCookie* cc,
+  // |key| is the key |cc| is stored under.
+  void InternalUpdateCookieAccessTime(const std::string& key,
+                                      CanonicalCookie* cc,
                                       const base::Time& current_time);
 
   // |deletion_cause| argument is used for collecting statistics and choosing
@@ -541,6 +568,20 @@ class NET_EXPORT CookieMonster : public CookieStore {
                             bool sync_to_store,
                             DeletionCause deletion_cause);
 
+  // Like InternalDeleteCookie(), for the cookie |cc| stored under |key| in
+  // |hashed_jar_|.
+  void InternalDeleteJarCookie(const std::string& key,
+                               CanonicalCookie* cc,
+                               bool sync_to_store,
+                               DeletionCause deletion_cause);
+
+  // Records the deletion of |cc| in histograms, removes it from the backing
+  // store if |sync_to_store| is set, and notifies the delegate and the
+  // cookie changed callbacks. Does not remove |cc| from the in-memory store.
+  void OnCookieDeleted(const CanonicalCookie& cc,
+                       bool sync_to_store,
+                       DeletionCause deletion_cause);
+
   // If the number of cookies for CookieMap key |key|, or globally, are
   // over the preset maximums above, garbage collect, first for the host and
   // then globally.  See comments above garbage collection threshold
@@ -551,6 +592,13 @@ class NET_EXPORT CookieMonster : public CookieStore {
                         const std::string& key,
                         bool enforce_strict_secure);
 
+  // GarbageCollect() for cookies stored in |hashed_jar_|. Evicts the same
+  // cookies, but takes them from the jar's per-key and LRU orderings instead
+  // of sorting.
+  size_t GarbageCollectHashedJar(const base::Time& current,
+                                 const std::string& key,
+                                 bool enforce_strict_secure);
+
   // Helper for GarbageCollect(). Deletes up to |purge_goal| cookies with a
   // priority less than or equal to |priority| from |cookies|, while ensuring
   // that at least the |to_protect| most-recent cookies are retained.
@@ -575,6 +623,11 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                const CookieMapItPair& itpair,
                                CookieItVector* cookie_its);
 
+  // GarbageCollectExpired() for the cookies stored under |key| in
+  // |hashed_jar_|. Returns the number of cookies deleted.
+  size_t GarbageCollectExpiredForJarKey(const base::Time& current,
+                                        const std::string& key);
+
   // Helper for GarbageCollect(). Deletes all cookies in the range specified by
   // [|it_begin|, |it_end|). Returns the number of cookies deleted.
   size_t GarbageCollectDeleteRange(const base::Time& current,
@@ -650,6 +703,10 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   CookieMap cookies_;
 
+  // If set, cookies are stored here and |cookies_| stays empty. See
+  // SetUseHashedCookieJar().
+  std::unique_ptr<HashedCookieJar> hashed_jar_;
+
   // Indicates whether the cookie store has been initialized.
   bool initialized_;
 
@@ -27,6 +27,11 @@ const int kNumCookies = 20000;
 const char kCookieLine[] = "A  = \"b=;\\\"\"  ;secure;;;";
 const char kGoogleURL[] = "http://www.google.izzle";
 
+// Jar sizes for the scaling tests, and how many cookies each domain holds.
+const size_t kJarSizes[] = {10000, 100000, 1000000};
+const size_t kCookiesPerDomain = 20;
+const int kNumJarQueries = 10000;
+
 int CountInString(const std::string& str, char c) {
   return std::count(str.begin(), str.end(), c);
 }
@@ -98,6 +103,28 @@ class GetCookiesCallback : public BaseCallback {
   CookieOptions options_;
 };
 
+// Builds |num_cookies| cookies spread over |num_cookies| / kCookiesPerDomain
+// domains, with unique, increasing creation times.
+void BuildJar(size_t num_cookies, std::vector<CanonicalCookie*>* cookies) {
+  int64_t time_tick(base::Time::Now().ToInternalValue());
+  for (size_t i = 0; i < num_cookies; ++i) {
+    GURL gurl(base::StringPrintf("http://www.domain%d.izzle",
+                                 static_cast<int>(i / kCookiesPerDomain)));
+    AddCookieToList(
+        gurl, base::StringPrintf("Cookie_%d=1; Path=/",
+                                 static_cast<int>(i % kCookiesPerDomain)),
+        base::Time::FromInternalValue(time_tick++), cookies);
+  }
+}
+
+GURL JarQueryURL(size_t num_cookies, int query) {
+  size_t num_domains = num_cookies / kCookiesPerDomain;
+  // Stride through the domains so consecutive queries do not share a key.
+  return GURL(base::StringPrintf(
+      "http://www.domain%d.izzle",
+      static_cast<int>((query * 7919u) % num_domains)));
+}
+
 }  // namespace
 
 TEST(ParsedCookieTest, TestParseCookies) {
@@ -388,4 +415,87 @@ TEST_F(CookieMonsterTest, TestGCTimes) {
   }
 }
 
+// Compares the CookieMap and HashedCookieJar stores on import, query and set
+// for jars far above kMaxCookies. All the cookies are recent, so no global
+// garbage collection happens.
+TEST_F(CookieMonsterTest, TestLargeJars) {
+  GetCookiesCallback getCookiesCallback;
+  SetCookieCallback setCookieCallback;
+
+  for (bool use_hashed_cookie_jar : {false, true}) {
+    const std::string store_name =
+        use_hashed_cookie_jar ? "Hashed_cookie_jar" : "Cookie_monster";
+    for (size_t num_cookies : kJarSizes) {
+      scoped_refptr<MockPersistentCookieStore> store(
+          new MockPersistentCookieStore);
+      std::vector<CanonicalCookie*> initial_cookies;
+      BuildJar(num_cookies, &initial_cookies);
+      store->SetLoadExpectation(true, initial_cookies);
+
+      std::unique_ptr<CookieMonster> cm(
+          new CookieMonster(store.get(), nullptr));
+      cm->SetUseHashedCookieJar(use_hashed_cookie_jar);
+      const std::string suffix =
+          base::StringPrintf("_%d", static_cast<int>(num_cookies));
+
+      base::PerfTimeLogger import_timer(
+          (store_name + "_import" + suffix).c_str());
+      getCookiesCallback.GetCookies(cm.get(), GURL(kGoogleURL));
+      import_timer.Done();
+
+      base::PerfTimeLogger query_timer(
+          (store_name + "_query" + suffix).c_str());
+      for (int i = 0; i < kNumJarQueries; ++i) {
+        const std::string& cookie_line = getCookiesCallback.GetCookies(
+            cm.get(), JarQueryURL(num_cookies, i));
+        EXPECT_EQ(static_cast<int>(kCookiesPerDomain),
+                  CountInString(cookie_line, '='));
+      }
+      query_timer.Done();
+
+      base::PerfTimeLogger set_timer((store_name + "_set" + suffix).c_str());
+      for (int i = 0; i < kNumJarQueries; ++i) {
+        setCookieCallback.SetCookie(cm.get(), JarQueryURL(num_cookies, i),
+                                    "z=1");
+      }
+      set_timer.Done();
+
+      EXPECT_EQ(static_cast<int>(kCookiesPerDomain) + 1,
+                CountInString(getCookiesCallback.GetCookies(
+                                  cm.get(), JarQueryURL(num_cookies, 0)),
+                              '='));
+    }
+  }
+}
+
+// Times the set that triggers global garbage collection in a large jar where
+// half the cookies were last accessed before the safe date. The CookieMap
+// store sorts the candidates; the HashedCookieJar pops them off its LRU lists.
+TEST_F(CookieMonsterTest, TestLargeJarGlobalGC) {
+  GetCookiesCallback getCookiesCallback;
+  SetCookieCallback setCookieCallback;
+
+  for (bool use_hashed_cookie_jar : {false, true}) {
+    const std::string store_name =
+        use_hashed_cookie_jar ? "Hashed_cookie_jar" : "Cookie_monster";
+    for (size_t num_cookies : kJarSizes) {
+      const int num_old_cookies = static_cast<int>(num_cookies / 2);
+      std::unique_ptr<CookieMonster> cm = CreateMonsterFromStoreForGC(
+          static_cast<int>(num_cookies), num_old_cookies, 0, 0,
+          CookieMonster::kSafeFromGlobalPurgeDays * 2);
+      cm->SetUseHashedCookieJar(use_hashed_cookie_jar);
+
+      // Load the store first so that only the collection is timed.
+      getCookiesCallback.GetCookies(cm.get(), GURL(kGoogleURL));
+
+      base::PerfTimeLogger timer(
+          base::StringPrintf("%s_global_gc_%d", store_name.c_str(),
+                             static_cast<int>(num_cookies))
+              .c_str());
+      setCookieCallback.SetCookie(cm.get(), GURL(kGoogleURL), "z=1");
+      timer.Done();
+    }
+  }
+}
+
 }  // namespace net
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
@@ -108,6 +109,7 @@ struct CookieMonsterTestTraits {
   static const bool has_path_prefix_bug = false;
   static const int creation_time_granularity_in_ms = 0;
   static const bool enforce_strict_secure = false;
+  static const bool use_hashed_cookie_jar = false;
 };
 
 struct CookieMonsterEnforcingStrictSecure {
@@ -122,6 +124,41 @@ struct CookieMonsterEnforcingStrictSecure {
   static const bool has_path_prefix_bug = false;
   static const int creation_time_granularity_in_ms = 0;
   static const bool enforce_strict_secure = true;
+  static const bool use_hashed_cookie_jar = false;
+};
+
+struct CookieMonsterHashedCookieJarTestTraits {
+  static std::unique_ptr<CookieStore> Create() {
+    std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
+    cm->SetUseHashedCookieJar(true);
+    return std::move(cm);
+  }
+
+  static const bool supports_http_only = true;
+  static const bool supports_non_dotted_domains = true;
+  static const bool preserves_trailing_dots = true;
+  static const bool filters_schemes = true;
+  static const bool has_path_prefix_bug = false;
+  static const int creation_time_granularity_in_ms = 0;
+  static const bool enforce_strict_secure = false;
+  static const bool use_hashed_cookie_jar = true;
+};
+
+struct CookieMonsterHashedCookieJarEnforcingStrictSecure {
+  static std::unique_ptr<CookieStore> Create() {
+    std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
+    cm->SetUseHashedCookieJar(true);
+    return std::move(cm);
+  }
+
+  static const bool supports_http_only = true;
+  static const bool supports_non_dotted_domains = true;
+  static const bool preserves_trailing_dots = true;
+  static const bool filters_schemes = true;
+  static const bool has_path_prefix_bug = false;
+  static const int creation_time_granularity_in_ms = 0;
+  static const bool enforce_strict_secure = true;
+  static const bool use_hashed_cookie_jar = true;
 };
 
 INSTANTIATE_TYPED_TEST_CASE_P(CookieMonster,
@@ -132,6 +169,15 @@ INSTANTIATE_TYPED_TEST_CASE_P(CookieMonsterStrictSecure,
                               CookieStoreTest,
                               CookieMonsterEnforcingStrictSecure);
 
+INSTANTIATE_TYPED_TEST_CASE_P(CookieMonsterHashedCookieJar,
+                              CookieStoreTest,
+                              CookieMonsterHashedCookieJarTestTraits);
+
+INSTANTIATE_TYPED_TEST_CASE_P(
+    CookieMonsterHashedCookieJarStrictSecure,
+    CookieStoreTest,
+    CookieMonsterHashedCookieJarEnforcingStrictSecure);
+
 template <typename T>
 class CookieMonsterTestBase : public CookieStoreTest<T> {
  public:
@@ -303,6 +349,14 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
     return std::count(str.begin(), str.end(), c);
   }
 
+  // Returns a CookieMonster with no backing store that keeps its cookies in
+  // the storage selected by |T::use_hashed_cookie_jar|.
+  std::unique_ptr<CookieMonster> CreateCookieMonster() {
+    std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
+    cm->SetUseHashedCookieJar(T::use_hashed_cookie_jar);
+    return cm;
+  }
+
   void TestHostGarbageCollectHelper() {
     int domain_max_cookies = CookieMonster::kDomainMaxCookies;
     int domain_purge_cookies = CookieMonster::kDomainPurgeCookies;
@@ -310,7 +364,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
         (domain_max_cookies + domain_purge_cookies) * 2;
     // Add a bunch of cookies on a single host, should purge them.
     {
-      std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
+      std::unique_ptr<CookieMonster> cm = CreateCookieMonster();
       for (int i = 0; i < more_than_enough_cookies; ++i) {
         std::string cookie = base::StringPrintf("a%03d=b", i);
         EXPECT_TRUE(SetCookie(cm.get(), http_www_google_.url(), cookie));
@@ -328,7 +382,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
     // between them.  We shouldn't go above kDomainMaxCookies for both together.
     GURL url_google_specific(http_www_google_.Format("http://www.gmail.%D"));
     {
-      std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
+      std::unique_ptr<CookieMonster> cm = CreateCookieMonster();
       for (int i = 0; i < more_than_enough_cookies; ++i) {
         std::string cookie_general = base::StringPrintf("a%03d=b", i);
         EXPECT_TRUE(
@@ -507,7 +561,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
     std::unique_ptr<CookieMonster> cm;
 
     if (alt_host_entries == nullptr) {
-      cm.reset(new CookieMonster(nullptr, nullptr));
+      cm = CreateCookieMonster();
     } else {
       // When generating all of these cookies on alternate hosts, they need to
       // be all older than the max "safe" date for GC, which is currently 30
@@ -515,6 +569,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
       cm = CreateMonsterFromStoreForGC(
           alt_host_entries->first, alt_host_entries->first,
           alt_host_entries->second, alt_host_entries->second, 60);
+      cm->SetUseHashedCookieJar(T::use_hashed_cookie_jar);
     }
 
     int next_cookie_id = 0;
@@ -552,7 +607,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
     DCHECK_EQ(150U, CookieMonster::kDomainMaxCookies -
                         CookieMonster::kDomainPurgeCookies);
 
-    std::unique_ptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+    std::unique_ptr<CookieMonster> cm = CreateCookieMonster();
 
     // Each test case adds 181 cookies, so 31 cookies are evicted.
     // Cookie same priority, repeated for each priority.
@@ -615,7 +670,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
     DCHECK_EQ(150U, CookieMonster::kDomainMaxCookies -
                         CookieMonster::kDomainPurgeCookies);
 
-    std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
+    std::unique_ptr<CookieMonster> cm = CreateCookieMonster();
 
     // Each test case adds 181 cookies, so 31 cookies are evicted.
     // Cookie same priority, repeated for each priority.
@@ -672,7 +727,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
     DCHECK_EQ(150U, CookieMonster::kDomainMaxCookies -
                         CookieMonster::kDomainPurgeCookies);
 
-    std::unique_ptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+    std::unique_ptr<CookieMonster> cm = CreateCookieMonster();
 
     // Each test case adds 180 secure cookies, and some non-secure cookie. The
     // secure cookies take priority, so the non-secure cookie is removed, along
@@ -778,7 +833,7 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
   // Function for creating a CM with a number of cookies in it,
   // no store (and hence no ability to affect access time).
   CookieMonster* CreateMonsterForGC(int num_cookies) {
-    CookieMonster* cm(new CookieMonster(NULL, NULL));
+    CookieMonster* cm = CreateCookieMonster().release();
     for (int i = 0; i < num_cookies; i++) {
       SetCookie(cm, GURL(base::StringPrintf("http://h%05d.izzle", i)), "a=1");
     }
@@ -806,6 +861,10 @@ class CookieMonsterTestBase : public CookieStoreTest<T> {
 using CookieMonsterTest = CookieMonsterTestBase<CookieMonsterTestTraits>;
 using CookieMonsterStrictSecureTest =
     CookieMonsterTestBase<CookieMonsterEnforcingStrictSecure>;
+using HashedCookieJarCookieMonsterTest =
+    CookieMonsterTestBase<CookieMonsterHashedCookieJarTestTraits>;
+using HashedCookieJarCookieMonsterStrictSecureTest =
+    CookieMonsterTestBase<CookieMonsterHashedCookieJarEnforcingStrictSecure>;
 
 // TODO(erikwright): Replace the other callbacks and synchronous helper methods
 // in this test suite with these Mocks.
@@ -1601,6 +1660,25 @@ TEST_F(CookieMonsterStrictSecureTest, TestPriorityAwareGarbageCollectionMixed) {
   TestPriorityAwareGarbageCollectHelperMixed();
 }
 
+TEST_F(HashedCookieJarCookieMonsterTest, TestHostGarbageCollection) {
+  TestHostGarbageCollectHelper();
+}
+
+TEST_F(HashedCookieJarCookieMonsterTest,
+       TestPriorityAwareGarbageCollectionNonSecure) {
+  TestPriorityAwareGarbageCollectHelperNonSecure();
+}
+
+TEST_F(HashedCookieJarCookieMonsterTest,
+       TestPriorityAwareGarbageCollectionSecure) {
+  TestPriorityAwareGarbageCollectHelperSecure();
+}
+
+TEST_F(HashedCookieJarCookieMonsterStrictSecureTest,
+       TestPriorityAwareGarbageCollectionMixed) {
+  TestPriorityAwareGarbageCollectHelperMixed();
+}
+
 TEST_F(CookieMonsterTest, SetCookieableSchemes) {
   std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
   std::unique_ptr<CookieMonster> cm_foo(new CookieMonster(nullptr, nullptr));
@@ -1851,6 +1929,41 @@ TEST_F(CookieMonsterTest, DontImportDuplicateCookies) {
   EXPECT_EQ(CookieStoreCommand::REMOVE, store->commands()[3].type);
 }
 
+// Duplicates loaded into a HashedCookieJar are trimmed the same way.
+TEST_F(HashedCookieJarCookieMonsterTest, DontImportDuplicateCookies) {
+  scoped_refptr<MockPersistentCookieStore> store(new MockPersistentCookieStore);
+  std::vector<CanonicalCookie*> initial_cookies;
+
+  AddCookieToList(GURL("http://www.google.com"),
+                  "X=1; path=/; expires=Thu, 01-Jan-2099 00:00:00 GMT",
+                  Time::Now() + TimeDelta::FromDays(3), &initial_cookies);
+
+  // ===> This one is the WINNER (biggest creation time).  <====
+  AddCookieToList(GURL("http://www.google.com"),
+                  "X=2; path=/; expires=Thu, 01-Jan-2099 00:00:00 GMT",
+                  Time::Now() + TimeDelta::FromDays(4), &initial_cookies);
+
+  AddCookieToList(GURL("http://www.google.com"),
+                  "X=a1; path=/2; expires=Thu, 01-Jan-2099 00:00:00 GMT",
+                  Time::Now() + TimeDelta::FromDays(9), &initial_cookies);
+
+  AddCookieToList(GURL("http://www.google.com"),
+                  "Y=a; path=/; expires=Thu, 01-Jan-2099 00:00:00 GMT",
+                  Time::Now() + TimeDelta::FromDays(10), &initial_cookies);
+
+  store->SetLoadExpectation(true, initial_cookies);
+
+  std::unique_ptr<CookieMonster> cm(new CookieMonster(store.get(), nullptr));
+  cm->SetUseHashedCookieJar(true);
+
+  EXPECT_EQ("X=2; Y=a", GetCookies(cm.get(), GURL("http://www.google.com/")));
+  EXPECT_EQ("X=a1; X=2; Y=a",
+            GetCookies(cm.get(), GURL("http://www.google.com/2/x")));
+
+  ASSERT_EQ(1u, store->commands().size());
+  EXPECT_EQ(CookieStoreCommand::REMOVE, store->commands()[0].type);
+}
+
 // Tests importing from a persistent cookie store that contains cookies
 // with duplicate creation times.  This situation should be handled by
 // dropping the cookies before insertion/visibility to user.
@@ -3235,6 +3348,31 @@ TEST_F(CookieMonsterStrictSecureTest, EvictSecureCookies) {
                            &test14_alt_hosts);
 }
 
+// Spot checks domain and global eviction with a HashedCookieJar against the
+// expectations of the CookieMap store above.
+TEST_F(HashedCookieJarCookieMonsterStrictSecureTest, EvictSecureCookies) {
+  const CookiesEntry test2[] = {{180U, false}, {20U, true}};
+  TestSecureCookieEviction(test2, arraysize(test2), 20U, 149U, nullptr);
+
+  const CookiesEntry test6[] = {{50U, true}, {50U, false}, {81U, true}};
+  TestSecureCookieEviction(test6, arraysize(test6), 131U, 19U, nullptr);
+
+  const CookiesEntry test9[] = {{180U, false}, {20U, true}};
+  const AltHosts test9_alt_hosts(0, 20);
+  TestSecureCookieEviction(test9, arraysize(test9), 20U, 169U,
+                           &test9_alt_hosts);
+
+  const CookiesEntry test10[] = {{1U, false}};
+  const AltHosts test10_alt_hosts(3300, 0);
+  TestSecureCookieEviction(test10, arraysize(test10), 2999U, 1U,
+                           &test10_alt_hosts);
+
+  const CookiesEntry test13[] = {{1U, false}};
+  const AltHosts test13_alt_hosts(1500, 1800);
+  TestSecureCookieEviction(test13, arraysize(test13), 1500U, 1500,
+                           &test13_alt_hosts);
+}
+
 // Tests that strict secure cookies doesn't trip equivalent cookie checks
 // accidentally. Regression test for https://crbug.com/569943.
 TEST_F(CookieMonsterStrictSecureTest, EquivalentCookies) {
@@ -0,0 +1,488 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cookies/hashed_cookie_jar.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/hash.h"
+#include "base/logging.h"
+#include "net/cookies/canonical_cookie.h"
+#include "net/cookies/cookie_monster.h"
+
+namespace net {
+
+namespace {
+
+const size_t kInitialSlotCount = 16;
+
+// Orders cookies by LastAccessDate(), falling back to CreationDate() for
+// stability, exactly like CookieMonster's LRACookieSorter.
+bool AccessedBefore(const CanonicalCookie& a, const CanonicalCookie& b) {
+  if (a.LastAccessDate() != b.LastAccessDate())
+    return a.LastAccessDate() < b.LastAccessDate();
+  return a.CreationDate() < b.CreationDate();
+}
+
+}  // namespace
+
+struct HashedCookieJar::Entry {
+  std::unique_ptr<CanonicalCookie> cookie;
+  uint32_t hash;
+  Entry* prev;
+  Entry* next;
+};
+
+HashedCookieJar::Slot::Slot() : occupied(false), hash(0) {}
+
+HashedCookieJar::Slot::Slot(Slot&& other) = default;
+
+HashedCookieJar::Slot::~Slot() {}
+
+HashedCookieJar::Slot& HashedCookieJar::Slot::operator=(Slot&& other) =
+    default;
+
+HashedCookieJar::LruList::LruList() : head(nullptr), tail(nullptr), size(0) {}
+
+void HashedCookieJar::LruList::Link(Entry* entry) {
+  // Walk back from the tail; with monotonic access times this stops at once.
+  Entry* after = tail;
+  while (after && AccessedBefore(*entry->cookie, *after->cookie))
+    after = after->prev;
+
+  entry->prev = after;
+  entry->next = after ? after->next : head;
+  if (entry->next)
+    entry->next->prev = entry;
+  else
+    tail = entry;
+  if (after)
+    after->next = entry;
+  else
+    head = entry;
+  ++size;
+}
+
+void HashedCookieJar::LruList::Unlink(Entry* entry) {
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    head = entry->next;
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    tail = entry->prev;
+  entry->prev = nullptr;
+  entry->next = nullptr;
+  --size;
+}
+
+HashedCookieJar::HashedCookieJar() : key_count_(0), size_(0) {}
+
+HashedCookieJar::~HashedCookieJar() {
+  Clear();
+}
+
+void HashedCookieJar::Insert(const std::string& key,
+                             std::unique_ptr<CanonicalCookie> cookie) {
+  DCHECK(cookie);
+  size_t index = FindOrInsertSlot(key);
+  Slot& slot = slots_[index];
+
+  Entry* entry = new Entry;
+  entry->hash = slot.hash;
+  entry->prev = nullptr;
+  entry->next = nullptr;
+  entry->cookie = std::move(cookie);
+
+  // Keep the slot in access order, scanning from the most recent end.
+  size_t position = slot.entries.size();
+  while (position > 0 &&
+         AccessedBefore(*entry->cookie, *slot.cookies[position - 1])) {
+    --position;
+  }
+  slot.entries.insert(slot.entries.begin() + position, entry);
+  slot.cookies.insert(slot.cookies.begin() + position, entry->cookie.get());
+
+  ListFor(*entry->cookie).Link(entry);
+  ++size_;
+}
+
+std::unique_ptr<CanonicalCookie> HashedCookieJar::Remove(
+    const std::string& key,
+    const CanonicalCookie* cookie) {
+  int index = FindSlot(key, base::Hash(key));
+  if (index < 0)
+    return nullptr;
+
+  const std::vector<CanonicalCookie*>& cookies = slots_[index].cookies;
+  auto it = std::find(cookies.begin(), cookies.end(), cookie);
+  if (it == cookies.end())
+    return nullptr;
+
+  std::unique_ptr<CanonicalCookie> removed =
+      RemoveEntry(index, it - cookies.begin());
+  EraseSlotIfEmpty(index);
+  return removed;
+}
+
+const std::vector<CanonicalCookie*>& HashedCookieJar::GetCookiesForKey(
+    const std::string& key) const {
+  int index = FindSlot(key, base::Hash(key));
+  return index < 0 ? no_cookies_ : slots_[index].cookies;
+}
+
+void HashedCookieJar::UpdateAccessDate(const std::string& key,
+                                       CanonicalCookie* cookie,
+                                       const base::Time& access_date) {
+  int index = FindSlot(key, base::Hash(key));
+  DCHECK_GE(index, 0);
+  Slot& slot = slots_[index];
+  size_t position =
+      std::find(slot.cookies.begin(), slot.cookies.end(), cookie) -
+      slot.cookies.begin();
+  DCHECK_LT(position, slot.cookies.size());
+
+  Entry* entry = slot.entries[position];
+  LruList& list = ListFor(*cookie);
+  list.Unlink(entry);
+  cookie->SetLastAccessDate(access_date);
+  list.Link(entry);
+
+  // Rotate the cookie to its new place; access dates usually move forward,
+  // so this is normally a shift towards the end.
+  slot.entries.erase(slot.entries.begin() + position);
+  slot.cookies.erase(slot.cookies.begin() + position);
+  position = slot.entries.size();
+  while (position > 0 && AccessedBefore(*cookie, *slot.cookies[position - 1]))
+    --position;
+  slot.entries.insert(slot.entries.begin() + position, entry);
+  slot.cookies.insert(slot.cookies.begin() + position, cookie);
+}
+
+size_t HashedCookieJar::EvictExpiredForKey(const std::string& key,
+                                           const base::Time& current,
+                                           CookieVector* evicted) {
+  int index = FindSlot(key, base::Hash(key));
+  if (index < 0)
+    return 0u;
+
+  size_t num_deleted = 0;
+  for (size_t position = 0; position < slots_[index].cookies.size();) {
+    if (slots_[index].cookies[position]->IsExpired(current)) {
+      evicted->push_back(RemoveEntry(index, position));
+      ++num_deleted;
+    } else {
+      ++position;
+    }
+  }
+  EraseSlotIfEmpty(index);
+  return num_deleted;
+}
+
+size_t HashedCookieJar::EvictFromKey(const std::string& key,
+                                     size_t purge_goal,
+                                     bool enforce_strict_secure,
+                                     CookieVector* evicted) {
+  int index = FindSlot(key, base::Hash(key));
+  if (index < 0)
+    return 0u;
+
+  // Same rounds as CookieMonster::GarbageCollect().
+  const static struct {
+    CookiePriority priority;
+    bool protect_secure_cookies;
+  } purge_rounds[] = {
+      // 1.  Low-priority non-secure cookies.
+      {COOKIE_PRIORITY_LOW, true},
+      // 2.  Low-priority secure cookies.
+      {COOKIE_PRIORITY_LOW, false},
+      // 3.  Medium-priority non-secure cookies.
+      {COOKIE_PRIORITY_MEDIUM, true},
+      // 4.  High-priority non-secure cookies.
+      {COOKIE_PRIORITY_HIGH, true},
+      // 5.  Medium-priority secure cookies.
+      {COOKIE_PRIORITY_MEDIUM, false},
+      // 6.  High-priority secure cookies.
+      {COOKIE_PRIORITY_HIGH, false},
+  };
+
+  size_t num_deleted = 0;
+  for (const auto& purge_round : purge_rounds) {
+    if (!enforce_strict_secure && purge_round.protect_secure_cookies)
+      continue;
+    if (num_deleted >= purge_goal)
+      break;
+
+    size_t quota = 0;
+    switch (purge_round.priority) {
+      case COOKIE_PRIORITY_LOW:
+        quota = CookieMonster::kDomainCookiesQuotaLow;
+        break;
+      case COOKIE_PRIORITY_MEDIUM:
+        quota = CookieMonster::kDomainCookiesQuotaMedium;
+        break;
+      case COOKIE_PRIORITY_HIGH:
+        quota = CookieMonster::kDomainCookiesQuotaHigh;
+        break;
+    }
+    num_deleted += PurgeLeastRecentMatches(
+        index, purge_round.priority, quota, purge_goal - num_deleted,
+        purge_round.protect_secure_cookies, evicted);
+  }
+  EraseSlotIfEmpty(index);
+  return num_deleted;
+}
+
+size_t HashedCookieJar::EvictLeastRecentlyAccessed(size_t purge_goal,
+                                                   const base::Time& safe_date,
+                                                   bool enforce_strict_secure,
+                                                   CookieVector* evicted) {
+  if (enforce_strict_secure) {
+    size_t num_deleted = 0;
+    if (non_secure_lru_.size > 1) {
+      num_deleted += EvictFromList(
+          &non_secure_lru_,
+          std::min<size_t>(purge_goal, non_secure_lru_.size - 1), safe_date,
+          evicted);
+    }
+    if (num_deleted < purge_goal && secure_lru_.size > 1) {
+      num_deleted += EvictFromList(
+          &secure_lru_,
+          std::min<size_t>(purge_goal - num_deleted, secure_lru_.size - 1),
+          safe_date, evicted);
+    }
+    return num_deleted;
+  }
+
+  // Merge the two lists by access date.
+  size_t num_deleted = 0;
+  while (num_deleted < purge_goal) {
+    Entry* oldest = secure_lru_.head;
+    if (!oldest || (non_secure_lru_.head &&
+                    AccessedBefore(*non_secure_lru_.head->cookie,
+                                   *oldest->cookie))) {
+      oldest = non_secure_lru_.head;
+    }
+    if (!oldest || oldest->cookie->LastAccessDate() >= safe_date)
+      break;
+    num_deleted += EvictFromList(&ListFor(*oldest->cookie), 1, safe_date,
+                                 evicted);
+  }
+  return num_deleted;
+}
+
+base::Time HashedCookieJar::EarliestAccessDate() const {
+  const Entry* secure = secure_lru_.head;
+  const Entry* non_secure = non_secure_lru_.head;
+  if (!secure && !non_secure)
+    return base::Time();
+  if (!secure)
+    return non_secure->cookie->LastAccessDate();
+  if (!non_secure)
+    return secure->cookie->LastAccessDate();
+  return std::min(secure->cookie->LastAccessDate(),
+                  non_secure->cookie->LastAccessDate());
+}
+
+std::vector<std::string> HashedCookieJar::GetKeys() const {
+  std::vector<std::string> keys;
+  keys.reserve(key_count_);
+  for (const Slot& slot : slots_) {
+    if (slot.occupied)
+      keys.push_back(slot.key);
+  }
+  return keys;
+}
+
+void HashedCookieJar::Clear() {
+  for (Slot& slot : slots_) {
+    for (Entry* entry : slot.entries)
+      delete entry;
+  }
+  slots_.clear();
+  secure_lru_ = LruList();
+  non_secure_lru_ = LruList();
+  key_count_ = 0;
+  size_ = 0;
+}
+
+size_t HashedCookieJar::CountForKey(const std::string& key) const {
+  return GetCookiesForKey(key).size();
+}
+
+int HashedCookieJar::FindSlot(const std::string& key, uint32_t hash) const {
+  if (slots_.empty())
+    return -1;
+  size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    if (!slot.occupied)
+      return -1;
+    if (slot.hash == hash && slot.key == key)
+      return static_cast<int>(i);
+  }
+}
+
+size_t HashedCookieJar::FindOrInsertSlot(const std::string& key) {
+  uint32_t hash = base::Hash(key);
+  int existing = FindSlot(key, hash);
+  if (existing >= 0)
+    return existing;
+
+  // Keep the load factor at or below 3/4 so probe runs stay short.
+  if ((key_count_ + 1) * 4 > slots_.size() * 3)
+    Grow();
+
+  size_t mask = slots_.size() - 1;
+  size_t i = hash & mask;
+  while (slots_[i].occupied)
+    i = (i + 1) & mask;
+  slots_[i].occupied = true;
+  slots_[i].hash = hash;
+  slots_[i].key = key;
+  ++key_count_;
+  return i;
+}
+
+void HashedCookieJar::EraseSlot(size_t index) {
+  DCHECK(slots_[index].occupied);
+  size_t mask = slots_.size() - 1;
+  size_t hole = index;
+  for (size_t i = (index + 1) & mask; slots_[i].occupied; i = (i + 1) & mask) {
+    // A slot can fill the hole only if its home position is not cyclically
+    // within (hole, i].
+    size_t home = slots_[i].hash & mask;
+    bool stays = hole <= i ? (hole < home && home <= i)
+                           : (hole < home || home <= i);
+    if (stays)
+      continue;
+    slots_[hole] = std::move(slots_[i]);
+    hole = i;
+  }
+  slots_[hole] = Slot();
+  --key_count_;
+}
+
+void HashedCookieJar::Grow() {
+  std::vector<Slot> old_slots;
+  old_slots.swap(slots_);
+  slots_.resize(old_slots.empty() ? kInitialSlotCount : old_slots.size() * 2);
+
+  size_t mask = slots_.size() - 1;
+  for (Slot& slot : old_slots) {
+    if (!slot.occupied)
+      continue;
+    size_t i = slot.hash & mask;
+    while (slots_[i].occupied)
+      i = (i + 1) & mask;
+    slots_[i] = std::move(slot);
+  }
+}
+
+size_t HashedCookieJar::FindSlotForEntry(const Entry* entry) const {
+  // Slots that share the hash are all on the same probe run; the entry
+  // pointer disambiguates full hash collisions.
+  size_t mask = slots_.size() - 1;
+  for (size_t i = entry->hash & mask;; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    DCHECK(slot.occupied);
+    if (slot.hash == entry->hash &&
+        std::find(slot.entries.begin(), slot.entries.end(), entry) !=
+            slot.entries.end()) {
+      return i;
+    }
+  }
+}
+
+std::unique_ptr<CanonicalCookie> HashedCookieJar::RemoveEntry(
+    size_t slot_index,
+    size_t position) {
+  Slot& slot = slots_[slot_index];
+  Entry* entry = slot.entries[position];
+  slot.entries.erase(slot.entries.begin() + position);
+  slot.cookies.erase(slot.cookies.begin() + position);
+
+  ListFor(*entry->cookie).Unlink(entry);
+  std::unique_ptr<CanonicalCookie> cookie = std::move(entry->cookie);
+  delete entry;
+  --size_;
+  return cookie;
+}
+
+void HashedCookieJar::EraseSlotIfEmpty(size_t slot_index) {
+  if (slots_[slot_index].entries.empty())
+    EraseSlot(slot_index);
+}
+
+size_t HashedCookieJar::PurgeLeastRecentMatches(size_t slot_index,
+                                                CookiePriority priority,
+                                                size_t to_protect,
+                                                size_t purge_goal,
+                                                bool protect_secure_cookies,
+                                                CookieVector* evicted) {
+  const std::vector<CanonicalCookie*>& cookies = slots_[slot_index].cookies;
+
+  size_t count = 0;
+  size_t secure_count = 0;
+  for (const CanonicalCookie* cookie : cookies) {
+    if (cookie->Priority() != priority)
+      continue;
+    ++count;
+    if (cookie->IsSecure())
+      ++secure_count;
+  }
+  if (count <= to_protect)
+    return 0u;
+
+  // Same accounting as CookieMonster::PurgeLeastRecentMatches(), including
+  // its unsigned arithmetic, so both stores evict the same cookies.
+  if (protect_secure_cookies) {
+    count -= std::max(secure_count, to_protect - secure_count);
+  } else {
+    count -= to_protect;
+  }
+
+  size_t removed = 0;
+  for (size_t position = 0;
+       removed < purge_goal && count > 0 && position < cookies.size();) {
+    const CanonicalCookie* cookie = cookies[position];
+    if (cookie->Priority() == priority &&
+        !(protect_secure_cookies && cookie->IsSecure())) {
+      evicted->push_back(RemoveEntry(slot_index, position));
+      ++removed;
+      --count;
+    } else {
+      ++position;
+    }
+  }
+  return removed;
+}
+
+size_t HashedCookieJar::EvictFromList(LruList* list,
+                                      size_t purge_goal,
+                                      const base::Time& safe_date,
+                                      CookieVector* evicted) {
+  size_t removed = 0;
+  while (removed < purge_goal && list->head &&
+         list->head->cookie->LastAccessDate() < safe_date) {
+    Entry* entry = list->head;
+    size_t slot_index = FindSlotForEntry(entry);
+    const std::vector<Entry*>& entries = slots_[slot_index].entries;
+    size_t position =
+        std::find(entries.begin(), entries.end(), entry) - entries.begin();
+    evicted->push_back(RemoveEntry(slot_index, position));
+    EraseSlotIfEmpty(slot_index);
+    ++removed;
+  }
+  return removed;
+}
+
+HashedCookieJar::LruList& HashedCookieJar::ListFor(
+    const CanonicalCookie& cookie) {
+  return cookie.IsSecure() ? secure_lru_ : non_secure_lru_;
+}
+
+}  // namespace net
@@ -0,0 +1,196 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_COOKIES_HASHED_COOKIE_JAR_H_
+#define NET_COOKIES_HASHED_COOKIE_JAR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+#include "net/cookies/cookie_constants.h"
+
+namespace net {
+
+class CanonicalCookie;
+
+// An in-memory cookie storage engine intended for very large jars. A
+// CookieMonster stores its cookies here instead of in its std::multimap once
+// CookieMonster::SetUseHashedCookieJar() has been called.
+//
+// Cookies are grouped by key (eTLD+1, as computed by CookieMonster::GetKey())
+// in an open-addressing hash table with linear probing. Each key owns a small
+// vector of its cookies kept in least-recently-accessed order, so domain
+// lookups cost one probe sequence plus a scan of that domain's cookies, and
+// domain eviction never needs to sort.
+//
+// Every cookie is also linked into one of two jar-wide LRU lists (secure and
+// non-secure), ordered by LastAccessDate(). Global eviction pops from the
+// heads of those lists, so it touches only the cookies it evicts rather than
+// sorting the whole jar. Keeping the lists ordered is O(1) when access times
+// are monotonic, which is the common case; out-of-order timestamps (e.g. when
+// importing from a backing store) are placed by walking back from the tail.
+//
+// The eviction policies mirror CookieMonster::GarbageCollect(): domain
+// eviction honors per-priority quotas and, when |enforce_strict_secure| is
+// set, removes non-secure cookies before secure ones; global eviction only
+// removes cookies last accessed before |safe_date|.
+//
+// This class is not thread-safe.
+class NET_EXPORT HashedCookieJar {
+ public:
+  typedef std::vector<std::unique_ptr<CanonicalCookie>> CookieVector;
+
+  HashedCookieJar();
+  ~HashedCookieJar();
+
+  // Adds |cookie| under |key|. The jar takes ownership. Does not check for
+  // equivalent cookies; callers are expected to have removed them already.
+  void Insert(const std::string& key, std::unique_ptr<CanonicalCookie> cookie);
+
+  // Removes |cookie| from |key| and returns ownership of it, or returns null if
+  // |cookie| is not stored under |key|.
+  std::unique_ptr<CanonicalCookie> Remove(const std::string& key,
+                                          const CanonicalCookie* cookie);
+
+  // Returns the cookies stored under |key|, least recently accessed first. The
+  // returned vector is invalidated by any mutation of the jar.
+  const std::vector<CanonicalCookie*>& GetCookiesForKey(
+      const std::string& key) const;
+
+  // Sets the LastAccessDate() of |cookie|, which must be stored under |key|,
+  // and moves it to its new place in the LRU orderings.
+  void UpdateAccessDate(const std::string& key,
+                        CanonicalCookie* cookie,
+                        const base::Time& access_date);
+
+  // Removes every cookie under |key| that is expired at |current| and appends
+  // it to |evicted|. Returns the number removed.
+  size_t EvictExpiredForKey(const std::string& key,
+                            const base::Time& current,
+                            CookieVector* evicted);
+
+  // Evicts |purge_goal| cookies from |key| in the priority/secure order used by
+  // CookieMonster's domain garbage collection, appending them to |evicted|.
+  // Returns the number removed.
+  size_t EvictFromKey(const std::string& key,
+                      size_t purge_goal,
+                      bool enforce_strict_secure,
+                      CookieVector* evicted);
+
+  // Evicts up to |purge_goal| of the least recently accessed cookies in the
+  // jar, skipping any accessed at or after |safe_date|. When
+  // |enforce_strict_secure| is set, non-secure cookies go first and at least
+  // one cookie of each kind is kept. Appends the cookies to |evicted| and
+  // returns the number removed.
+  size_t EvictLeastRecentlyAccessed(size_t purge_goal,
+                                    const base::Time& safe_date,
+                                    bool enforce_strict_secure,
+                                    CookieVector* evicted);
+
+  // Returns the LastAccessDate() of the least recently accessed cookie, or a
+  // null time if the jar is empty.
+  base::Time EarliestAccessDate() const;
+
+  // Returns every key that has at least one cookie, in no particular order.
+  std::vector<std::string> GetKeys() const;
+
+  // Deletes every cookie.
+  void Clear();
+
+  size_t size() const { return size_; }
+  size_t key_count() const { return key_count_; }
+  size_t CountForKey(const std::string& key) const;
+
+ private:
+  struct Entry;
+
+  // One bucket of the open-addressing table. |cookies| and |entries| are
+  // parallel and ordered least recently accessed first.
+  struct Slot {
+    Slot();
+    Slot(Slot&& other);
+    ~Slot();
+    Slot& operator=(Slot&& other);
+
+    bool occupied;
+    uint32_t hash;
+    std::string key;
+    std::vector<CanonicalCookie*> cookies;
+    std::vector<Entry*> entries;
+  };
+
+  // Intrusive doubly-linked list of entries ordered by LastAccessDate().
+  struct LruList {
+    LruList();
+
+    // Links |entry| after the last entry that is not accessed later than it.
+    void Link(Entry* entry);
+    void Unlink(Entry* entry);
+
+    Entry* head;
+    Entry* tail;
+    size_t size;
+  };
+
+  // Returns the slot index holding |key|, or -1.
+  int FindSlot(const std::string& key, uint32_t hash) const;
+  // Returns the slot index for |key|, claiming an empty one if needed.
+  size_t FindOrInsertSlot(const std::string& key);
+  // Empties slot |index| and shifts later members of its probe run back so
+  // lookups never need tombstones.
+  void EraseSlot(size_t index);
+  void Grow();
+
+  // Returns the slot index holding |entry|.
+  size_t FindSlotForEntry(const Entry* entry) const;
+
+  // Unlinks the entry at |position| in slot |slot_index| from the slot and its
+  // LRU list, frees it, and returns the cookie it held. The slot is left in
+  // place even if it becomes empty; see EraseSlotIfEmpty().
+  std::unique_ptr<CanonicalCookie> RemoveEntry(size_t slot_index,
+                                               size_t position);
+  void EraseSlotIfEmpty(size_t slot_index);
+
+  // Evicts up to |purge_goal| cookies of |priority| from slot |slot_index|
+  // while leaving |to_protect| of them, skipping secure ones when
+  // |protect_secure_cookies| is set.
+  size_t PurgeLeastRecentMatches(size_t slot_index,
+                                 CookiePriority priority,
+                                 size_t to_protect,
+                                 size_t purge_goal,
+                                 bool protect_secure_cookies,
+                                 CookieVector* evicted);
+
+  // Evicts up to |purge_goal| cookies from the head of |list|, stopping at the
+  // first cookie accessed at or after |safe_date|.
+  size_t EvictFromList(LruList* list,
+                       size_t purge_goal,
+                       const base::Time& safe_date,
+                       CookieVector* evicted);
+
+  LruList& ListFor(const CanonicalCookie& cookie);
+
+  std::vector<Slot> slots_;
+  size_t key_count_;
+  size_t size_;
+
+  LruList secure_lru_;
+  LruList non_secure_lru_;
+
+  // Returned by GetCookiesForKey() for keys with no cookies.
+  const std::vector<CanonicalCookie*> no_cookies_;
+
+  DISALLOW_COPY_AND_ASSIGN(HashedCookieJar);
+};
+
+}  // namespace net
+
+#endif  // NET_COOKIES_HASHED_COOKIE_JAR_H_
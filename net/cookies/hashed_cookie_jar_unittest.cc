@@ -0,0 +1,232 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cookies/hashed_cookie_jar.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "net/cookies/canonical_cookie.h"
+#include "net/cookies/cookie_monster.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+std::unique_ptr<CanonicalCookie> MakeCookie(int index,
+                                            const base::Time& access_time,
+                                            bool secure,
+                                            CookiePriority priority) {
+  return CanonicalCookie::Create(
+      base::StringPrintf("name%d", index), "value", "example.com", "/",
+      access_time, base::Time(), access_time, secure, false,
+      CookieSameSite::DEFAULT_MODE, priority);
+}
+
+std::unique_ptr<CanonicalCookie> MakeCookie(int index,
+                                            const base::Time& access_time) {
+  return MakeCookie(index, access_time, false, COOKIE_PRIORITY_MEDIUM);
+}
+
+}  // namespace
+
+TEST(HashedCookieJarTest, InsertAndRemove) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  for (int key = 0; key < 100; ++key) {
+    for (int i = 0; i < 5; ++i) {
+      jar.Insert(base::StringPrintf("key%d.com", key),
+                 MakeCookie(i, now + base::TimeDelta::FromSeconds(i)));
+    }
+  }
+  EXPECT_EQ(500u, jar.size());
+  EXPECT_EQ(100u, jar.key_count());
+  EXPECT_EQ(5u, jar.CountForKey("key42.com"));
+  EXPECT_EQ(0u, jar.CountForKey("missing.com"));
+  EXPECT_TRUE(jar.GetCookiesForKey("missing.com").empty());
+
+  // Emptying every other key must not disturb lookups of the keys that share
+  // their probe runs.
+  for (int key = 0; key < 100; key += 2) {
+    std::string name = base::StringPrintf("key%d.com", key);
+    while (jar.CountForKey(name) > 0) {
+      const CanonicalCookie* cookie = jar.GetCookiesForKey(name)[0];
+      EXPECT_TRUE(jar.Remove(name, cookie));
+    }
+  }
+  EXPECT_EQ(250u, jar.size());
+  EXPECT_EQ(50u, jar.key_count());
+  for (int key = 0; key < 100; ++key) {
+    EXPECT_EQ(key % 2 ? 5u : 0u,
+              jar.CountForKey(base::StringPrintf("key%d.com", key)));
+  }
+
+  std::vector<std::string> keys = jar.GetKeys();
+  ASSERT_EQ(50u, keys.size());
+  for (const std::string& key : keys)
+    EXPECT_EQ(5u, jar.CountForKey(key));
+
+  std::unique_ptr<CanonicalCookie> stranger = MakeCookie(0, now);
+  EXPECT_FALSE(jar.Remove("key1.com", stranger.get()));
+
+  jar.Clear();
+  EXPECT_EQ(0u, jar.size());
+  EXPECT_EQ(0u, jar.key_count());
+  EXPECT_TRUE(jar.GetKeys().empty());
+  EXPECT_TRUE(jar.EarliestAccessDate().is_null());
+}
+
+TEST(HashedCookieJarTest, KeyCookiesStayInAccessOrder) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  // Insert out of order, as happens when importing from a backing store.
+  jar.Insert("a.com", MakeCookie(2, now + base::TimeDelta::FromSeconds(2)));
+  jar.Insert("a.com", MakeCookie(0, now));
+  jar.Insert("a.com", MakeCookie(1, now + base::TimeDelta::FromSeconds(1)));
+
+  const std::vector<CanonicalCookie*>& cookies = jar.GetCookiesForKey("a.com");
+  ASSERT_EQ(3u, cookies.size());
+  EXPECT_EQ("name0", cookies[0]->Name());
+  EXPECT_EQ("name1", cookies[1]->Name());
+  EXPECT_EQ("name2", cookies[2]->Name());
+  EXPECT_EQ(now, jar.EarliestAccessDate());
+
+  jar.UpdateAccessDate("a.com", cookies[0],
+                       now + base::TimeDelta::FromSeconds(3));
+  EXPECT_EQ("name1", jar.GetCookiesForKey("a.com")[0]->Name());
+  EXPECT_EQ("name0", jar.GetCookiesForKey("a.com")[2]->Name());
+  EXPECT_EQ(now + base::TimeDelta::FromSeconds(1), jar.EarliestAccessDate());
+}
+
+TEST(HashedCookieJarTest, EvictExpiredForKey) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  jar.Insert("a.com", MakeCookie(0, now));
+  jar.Insert("a.com", CanonicalCookie::Create(
+                          "expired", "value", "a.com", "/", now,
+                          now + base::TimeDelta::FromSeconds(1), now, false,
+                          false, CookieSameSite::DEFAULT_MODE,
+                          COOKIE_PRIORITY_DEFAULT));
+
+  HashedCookieJar::CookieVector evicted;
+  EXPECT_EQ(1u, jar.EvictExpiredForKey(
+                    "a.com", now + base::TimeDelta::FromSeconds(2), &evicted));
+  ASSERT_EQ(1u, evicted.size());
+  EXPECT_EQ("expired", evicted[0]->Name());
+  EXPECT_EQ(1u, jar.CountForKey("a.com"));
+}
+
+TEST(HashedCookieJarTest, EvictFromKeyHonorsPriority) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  // 100 low-priority cookies followed by 100 more recently accessed
+  // high-priority cookies.
+  for (int i = 0; i < 200; ++i) {
+    jar.Insert("a.com", MakeCookie(i, now + base::TimeDelta::FromSeconds(i),
+                                   false, i < 100 ? COOKIE_PRIORITY_LOW
+                                                  : COOKIE_PRIORITY_HIGH));
+  }
+
+  HashedCookieJar::CookieVector evicted;
+  EXPECT_EQ(50u, jar.EvictFromKey("a.com", 50, false, &evicted));
+  ASSERT_EQ(50u, evicted.size());
+  for (size_t i = 0; i < evicted.size(); ++i) {
+    EXPECT_EQ(COOKIE_PRIORITY_LOW, evicted[i]->Priority());
+    // Least recently accessed first.
+    EXPECT_EQ(base::StringPrintf("name%d", static_cast<int>(i)),
+              evicted[i]->Name());
+  }
+
+  // The low-priority quota is protected, so further eviction falls through to
+  // the high-priority cookies.
+  evicted.clear();
+  EXPECT_EQ(40u, jar.EvictFromKey("a.com", 40, false, &evicted));
+  size_t low = 0;
+  for (const auto& cookie : evicted) {
+    if (cookie->Priority() == COOKIE_PRIORITY_LOW)
+      ++low;
+  }
+  EXPECT_EQ(100u - 50u - CookieMonster::kDomainCookiesQuotaLow, low);
+}
+
+TEST(HashedCookieJarTest, EvictFromKeyStrictSecure) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  // Older secure cookies, newer non-secure ones.
+  for (int i = 0; i < 100; ++i) {
+    jar.Insert("a.com", MakeCookie(i, now + base::TimeDelta::FromSeconds(i),
+                                   i < 50, COOKIE_PRIORITY_LOW));
+  }
+
+  HashedCookieJar::CookieVector evicted;
+  EXPECT_EQ(20u, jar.EvictFromKey("a.com", 20, true, &evicted));
+  for (const auto& cookie : evicted)
+    EXPECT_FALSE(cookie->IsSecure());
+}
+
+TEST(HashedCookieJarTest, EvictLeastRecentlyAccessed) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  for (int i = 0; i < 1000; ++i) {
+    jar.Insert(base::StringPrintf("key%d.com", i % 37),
+               MakeCookie(i, now + base::TimeDelta::FromSeconds(i), i % 3 == 0,
+                          COOKIE_PRIORITY_MEDIUM));
+  }
+
+  // Nothing is older than |now|, so nothing can go.
+  HashedCookieJar::CookieVector evicted;
+  EXPECT_EQ(0u, jar.EvictLeastRecentlyAccessed(100, now, false, &evicted));
+
+  base::Time safe_date = now + base::TimeDelta::FromSeconds(900);
+  EXPECT_EQ(100u,
+            jar.EvictLeastRecentlyAccessed(100, safe_date, false, &evicted));
+  ASSERT_EQ(100u, evicted.size());
+  for (size_t i = 0; i < evicted.size(); ++i) {
+    EXPECT_EQ(base::StringPrintf("name%d", static_cast<int>(i)),
+              evicted[i]->Name());
+  }
+  EXPECT_EQ(900u, jar.size());
+
+  // Everything else before |safe_date| goes, and no more.
+  evicted.clear();
+  EXPECT_EQ(800u,
+            jar.EvictLeastRecentlyAccessed(5000, safe_date, false, &evicted));
+  EXPECT_EQ(100u, jar.size());
+  EXPECT_EQ(safe_date, jar.EarliestAccessDate());
+}
+
+TEST(HashedCookieJarTest, EvictLeastRecentlyAccessedStrictSecure) {
+  HashedCookieJar jar;
+  base::Time now = base::Time::Now();
+
+  // The secure cookies are the least recently accessed.
+  for (int i = 0; i < 20; ++i) {
+    jar.Insert("a.com", MakeCookie(i, now + base::TimeDelta::FromSeconds(i),
+                                   i < 10, COOKIE_PRIORITY_MEDIUM));
+  }
+
+  base::Time safe_date = now + base::TimeDelta::FromDays(1);
+  HashedCookieJar::CookieVector evicted;
+  EXPECT_EQ(5u, jar.EvictLeastRecentlyAccessed(5, safe_date, true, &evicted));
+  for (const auto& cookie : evicted)
+    EXPECT_FALSE(cookie->IsSecure());
+
+  // One cookie of each kind is always kept.
+  evicted.clear();
+  EXPECT_EQ(13u,
+            jar.EvictLeastRecentlyAccessed(100, safe_date, true, &evicted));
+  EXPECT_EQ(2u, jar.size());
+}
+
+}  // namespace net
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <map>
+#include <string>
 #include <utility>
 
 #include "base/bind.h"
@@ -4292,3 +4294,57 @@ TEST_F(DiskCacheEntryTest, SimpleCacheReadCorruptLength) {
       disk_cache::simple_util::CorruptStream0LengthFromEntry(key, cache_path_));
   EXPECT_NE(net::OK, OpenEntry(key, &entry));
 }
+
+// Opening reads the end of the stream 0 file in one go; check that entries
+// whose streams fit in that read, and entries whose stream 0 or header do not,
+// are read back correctly.
+TEST_F(DiskCacheEntryTest, SimpleCacheOpenEntriesOfVaryingSizes) {
+  SetCacheType(net::APP_CACHE);
+  SetSimpleCacheMode();
+  InitCache();
+
+  const int kSizes[] = {0, 10, 3000, 20000, 100000};
+  std::map<std::string, std::string> stream_data;
+  for (int stream_0_size : kSizes) {
+    for (int stream_1_size : kSizes) {
+      const std::string key = "key " + base::IntToString(stream_0_size) + " " +
+                              base::IntToString(stream_1_size);
+      disk_cache::Entry* entry;
+      ASSERT_THAT(CreateEntry(key, &entry), IsOk());
+      for (int index = 0; index < 2; ++index) {
+        int size = index == 0 ? stream_0_size : stream_1_size;
+        scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(size));
+        CacheTestFillBuffer(buffer->data(), size, false);
+        EXPECT_EQ(size, WriteData(entry, index, 0, buffer.get(), size, false));
+        stream_data[key + base::IntToString(index)].assign(buffer->data(),
+                                                           size);
+      }
+      entry->Close();
+    }
+  }
+
+  base::RunLoop().RunUntilIdle();
+  disk_cache::SimpleBackendImpl::FlushWorkerPoolForTesting();
+  base::RunLoop().RunUntilIdle();
+
+  for (int stream_0_size : kSizes) {
+    for (int stream_1_size : kSizes) {
+      const std::string key = "key " + base::IntToString(stream_0_size) + " " +
+                              base::IntToString(stream_1_size);
+      disk_cache::Entry* entry;
+      ASSERT_THAT(OpenEntry(key, &entry), IsOk());
+      ScopedEntryPtr entry_closer(entry);
+      for (int index = 0; index < 2; ++index) {
+        const std::string& expected =
+            stream_data[key + base::IntToString(index)];
+        int size = static_cast<int>(expected.size());
+        ASSERT_EQ(size, entry->GetDataSize(index));
+        if (size == 0)
+          continue;
+        scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(size));
+        EXPECT_EQ(size, ReadData(entry, index, 0, buffer.get(), size));
+        EXPECT_EQ(expected, std::string(buffer->data(), size));
+      }
+    }
+  }
+}
@@ -49,6 +49,10 @@ const uint32_t kEvictionMarginDivisor = 20;
 
 const uint32_t kBytesInKb = 1024;
 
+// The journal is compacted into a full index write once it would hold more
+// records than this fraction of the number of entries.
+const uint64_t kJournalCompactionDivisor = 4;
+
 // Utility class used for timestamp comparisons in entry metadata while sorting.
 class CompareHashesForTimestamp {
   typedef disk_cache::SimpleIndex SimpleIndex;
@@ -151,6 +155,8 @@ SimpleIndex::SimpleIndex(
       high_watermark_(0),
       low_watermark_(0),
       eviction_in_progress_(false),
+      can_append_to_journal_(false),
+      journal_record_count_(0),
       initialized_(false),
       init_method_(INITIALIZE_METHOD_MAX),
       index_file_(std::move(index_file)),
@@ -257,6 +263,7 @@ void SimpleIndex::Insert(uint64_t entry_hash) {
                    &entries_set_);
   if (!initialized_)
     removed_entries_.erase(entry_hash);
+  entries_changed_since_write_.insert(entry_hash);
   PostponeWritingToDisk();
 }
 
@@ -270,6 +277,7 @@ void SimpleIndex::Remove(uint64_t entry_hash) {
 
   if (!initialized_)
     removed_entries_.insert(entry_hash);
+  entries_changed_since_write_.insert(entry_hash);
   PostponeWritingToDisk();
 }
 
@@ -288,6 +296,7 @@ bool SimpleIndex::UseIfExists(uint64_t entry_hash) {
     // If not initialized, always return true, forcing it to go to the disk.
     return !initialized_;
   it->second.SetLastUsedTime(base::Time::Now());
+  entries_changed_since_write_.insert(entry_hash);
   PostponeWritingToDisk();
   return true;
 }
@@ -349,6 +358,7 @@ bool SimpleIndex::UpdateEntrySize(uint64_t entry_hash,
     return false;
 
   UpdateEntryIteratorSize(&it, entry_size);
+  entries_changed_since_write_.insert(entry_hash);
   PostponeWritingToDisk();
   StartEvictionIfNeeded();
   return true;
@@ -432,6 +442,8 @@ void SimpleIndex::MergeInitializingSet(
   cache_size_ = merged_cache_size;
   initialized_ = true;
   init_method_ = load_result->init_method;
+  can_append_to_journal_ = load_result->can_append_to_journal;
+  journal_record_count_ = load_result->journal_record_count;
 
   // The actual IO is asynchronous, so calling WriteToDisk() shouldn't slow the
   // merge down much.
@@ -486,8 +498,21 @@ void SimpleIndex::WriteToDisk(IndexWriteToDiskReason reason) {
   }
   last_write_to_disk_ = start;
 
-  index_file_->WriteToDisk(reason, entries_set_, cache_size_, start,
-                           app_on_background_, base::Closure());
+  // Appending costs one record per changed entry plus a checkpoint.
+  const uint64_t append_record_count = entries_changed_since_write_.size() + 1;
+  if (can_append_to_journal_ &&
+      journal_record_count_ + append_record_count <=
+          entries_set_.size() / kJournalCompactionDivisor) {
+    index_file_->AppendToJournal(entries_set_, entries_changed_since_write_,
+                                 start, app_on_background_, base::Closure());
+    journal_record_count_ += append_record_count;
+  } else {
+    index_file_->WriteToDisk(reason, entries_set_, cache_size_, start,
+                             app_on_background_, base::Closure());
+    can_append_to_journal_ = true;
+    journal_record_count_ = 0;
+  }
+  entries_changed_since_write_.clear();
 }
 
 }  // namespace disk_cache
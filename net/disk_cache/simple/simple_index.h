@@ -166,6 +166,7 @@ class NET_EXPORT_PRIVATE SimpleIndex
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteQueued);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteExecuted);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWritePostponed);
+  FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteAppendsToJournal);
 
   void StartEvictionIfNeeded();
   void EvictionDone(int result);
@@ -201,6 +202,14 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // This stores all the entry_hash of entries that are removed during
   // initialization.
   std::unordered_set<uint64_t> removed_entries_;
+
+  // Entries inserted, removed or updated since the index was last written,
+  // which is what the next journal append has to record.
+  std::unordered_set<uint64_t> entries_changed_since_write_;
+  // Whether the index file has a journal that writes can append to, and how
+  // many records it holds.
+  bool can_append_to_journal_;
+  uint64_t journal_record_count_;
   bool initialized_;
   IndexInitMethod init_method_;
 
@@ -4,6 +4,9 @@
 
 #include "net/disk_cache/simple/simple_index_file.h"
 
+#include <stddef.h>
+#include <string.h>
+
 #include <utility>
 #include <vector>
 
@@ -35,12 +38,45 @@ const int kEntryFilesSuffixLength = 2;
 
 const uint64_t kMaxEntriesInIndex = 100000000;
 
+const uint64_t kSimpleIndexJournalMagicNumber = UINT64_C(0x6a6f75726e616c31);
+const uint32_t kSimpleIndexJournalVersion = 1;
+
+struct JournalHeader {
+  uint64_t magic_number;
+  uint32_t version;
+  // CRC of the index file this journal extends.
+  uint32_t index_crc;
+};
+static_assert(sizeof(JournalHeader) == 16, "journal header size changed");
+
+enum JournalRecordType : uint32_t {
+  JOURNAL_RECORD_ENTRY = 1,
+  JOURNAL_RECORD_REMOVED = 2,
+  JOURNAL_RECORD_CHECKPOINT = 3,
+};
+
 uint32_t CalculatePickleCRC(const base::Pickle& pickle) {
   return crc32(crc32(0, Z_NULL, 0),
                reinterpret_cast<const Bytef*>(pickle.payload()),
                pickle.payload_size());
 }
 
+bool WriteJournalHeader(uint32_t index_crc,
+                        const base::FilePath& journal_filename) {
+  File file(
+      journal_filename,
+      File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE | File::FLAG_SHARE_DELETE);
+  if (!file.IsValid())
+    return false;
+
+  JournalHeader header;
+  header.magic_number = kSimpleIndexJournalMagicNumber;
+  header.version = kSimpleIndexJournalVersion;
+  header.index_crc = index_crc;
+  return file.Write(0, reinterpret_cast<const char*>(&header),
+                    sizeof(header)) == static_cast<int>(sizeof(header));
+}
+
 // Used in histograms. Please only add new values at the end.
 enum IndexFileState {
   INDEX_STATE_CORRUPT = 0,
@@ -168,10 +204,47 @@ void ProcessEntryFile(SimpleIndex::EntrySet* entries,
 
 }  // namespace
 
+// Journal records have a fixed size and layout so that the journal can be read
+// in place from a memory mapping. Each carries its own CRC, so a torn append
+// only invalidates the tail of the journal.
+struct SimpleIndexFile::JournalRecord {
+  JournalRecord(JournalRecordType type,
+                uint64_t hash,
+                int64_t time,
+                uint32_t entry_size)
+      : hash(hash),
+        time(time),
+        entry_size(entry_size),
+        type(type),
+        reserved(0),
+        crc(CalculateCRC()) {}
+
+  uint32_t CalculateCRC() const {
+    return crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef*>(this),
+                 offsetof(JournalRecord, crc));
+  }
+
+  bool IsValid() const {
+    return crc == CalculateCRC() && type >= JOURNAL_RECORD_ENTRY &&
+           type <= JOURNAL_RECORD_CHECKPOINT;
+  }
+
+  uint64_t hash;
+  // The last used time of the entry, or the cache directory modification time
+  // for checkpoints, as a base::Time internal value.
+  int64_t time;
+  uint32_t entry_size;
+  uint32_t type;
+  uint32_t reserved;
+  uint32_t crc;
+};
+
 SimpleIndexLoadResult::SimpleIndexLoadResult()
     : did_load(false),
       index_write_reason(SimpleIndex::INDEX_WRITE_REASON_MAX),
-      flush_required(false) {}
+      flush_required(false),
+      can_append_to_journal(false),
+      journal_record_count(0) {}
 
 SimpleIndexLoadResult::~SimpleIndexLoadResult() {
 }
@@ -180,6 +253,8 @@ void SimpleIndexLoadResult::Reset() {
   did_load = false;
   index_write_reason = SimpleIndex::INDEX_WRITE_REASON_MAX;
   flush_required = false;
+  can_append_to_journal = false;
+  journal_record_count = 0;
   entries.clear();
 }
 
@@ -189,6 +264,8 @@ const char SimpleIndexFile::kIndexFileName[] = "the-real-index";
 const char SimpleIndexFile::kIndexDirectory[] = "index-dir";
 // static
 const char SimpleIndexFile::kTempIndexFileName[] = "temp-index";
+// static
+const char SimpleIndexFile::kIndexJournalFileName[] = "the-real-index-journal";
 
 SimpleIndexFile::IndexMetadata::IndexMetadata()
     : magic_number_(kSimpleIndexMagicNumber),
@@ -247,11 +324,18 @@ void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
                                       const base::FilePath& cache_directory,
                                       const base::FilePath& index_filename,
                                       const base::FilePath& temp_index_filename,
+                                      const base::FilePath& journal_filename,
                                       std::unique_ptr<base::Pickle> pickle,
                                       const base::TimeTicks& start_time,
                                       bool app_on_background) {
   DCHECK_EQ(index_filename.DirName().value(),
             temp_index_filename.DirName().value());
+  // SimpleIndex starts counting a new journal as soon as it asks for this
+  // write, so the old journal must not outlive it even if the write fails.
+  // Without the journal, the old index is only loaded if the cache directory
+  // has not changed since it was written; otherwise it is rebuilt.
+  simple_util::SimpleCacheDeleteFile(journal_filename);
+
   base::FilePath index_file_directory = temp_index_filename.DirName();
   if (!base::DirectoryExists(index_file_directory) &&
       !base::CreateDirectory(index_file_directory)) {
@@ -282,6 +366,12 @@ void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
   if (!base::ReplaceFile(temp_index_filename, index_filename, NULL))
     return;
 
+  // Appends are dropped until the new journal exists.
+  if (!WriteJournalHeader(pickle->headerT<PickleHeader>()->crc,
+                          journal_filename)) {
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+  }
+
   if (app_on_background) {
     SIMPLE_CACHE_UMA(TIMES,
                      "IndexWriteToDiskTime.Background", cache_type,
@@ -293,6 +383,53 @@ void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
   }
 }
 
+// static
+void SimpleIndexFile::SyncAppendToJournal(
+    net::CacheType cache_type,
+    const base::FilePath& cache_directory,
+    const base::FilePath& journal_filename,
+    std::unique_ptr<std::vector<JournalRecord>> records,
+    const base::TimeTicks& start_time,
+    bool app_on_background) {
+  // See SyncWriteToDisk() about the freshness of the recorded time.
+  base::Time cache_dir_mtime;
+  if (!simple_util::GetMTime(cache_directory, &cache_dir_mtime)) {
+    LOG(ERROR) << "Could not obtain information about cache age";
+    return;
+  }
+  records->push_back(JournalRecord(JOURNAL_RECORD_CHECKPOINT, 0,
+                                   cache_dir_mtime.ToInternalValue(), 0));
+
+  // Never create the journal here: without a header it would not be tied to
+  // an index.
+  File file(journal_filename,
+            File::FLAG_OPEN | File::FLAG_APPEND | File::FLAG_SHARE_DELETE);
+  if (!file.IsValid())
+    return;
+
+  const int size =
+      base::checked_cast<int>(records->size() * sizeof(JournalRecord));
+  if (file.WriteAtCurrentPos(reinterpret_cast<const char*>(records->data()),
+                             size) != size) {
+    // Records appended after a partial batch would never be read, so drop the
+    // journal and let the next load fall back to the index alone.
+    LOG(ERROR) << "Failed to append to the index journal";
+    file.Close();
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    return;
+  }
+
+  if (app_on_background) {
+    SIMPLE_CACHE_UMA(TIMES,
+                     "IndexJournalAppendTime.Background", cache_type,
+                     (base::TimeTicks::Now() - start_time));
+  } else {
+    SIMPLE_CACHE_UMA(TIMES,
+                     "IndexJournalAppendTime.Foreground", cache_type,
+                     (base::TimeTicks::Now() - start_time));
+  }
+}
+
 bool SimpleIndexFile::IndexMetadata::CheckIndexMetadata() {
   if (entry_count_ > kMaxEntriesInIndex ||
       magic_number_ != kSimpleIndexMagicNumber) {
@@ -318,7 +455,9 @@ SimpleIndexFile::SimpleIndexFile(
       index_file_(cache_directory_.AppendASCII(kIndexDirectory)
                       .AppendASCII(kIndexFileName)),
       temp_index_file_(cache_directory_.AppendASCII(kIndexDirectory)
-                           .AppendASCII(kTempIndexFileName)) {
+                           .AppendASCII(kTempIndexFileName)),
+      journal_file_(cache_directory_.AppendASCII(kIndexDirectory)
+                        .AppendASCII(kIndexJournalFileName)) {
 }
 
 SimpleIndexFile::~SimpleIndexFile() {}
@@ -345,7 +484,38 @@ void SimpleIndexFile::WriteToDisk(SimpleIndex::IndexWriteToDiskReason reason,
   base::Closure task =
       base::Bind(&SimpleIndexFile::SyncWriteToDisk,
                  cache_type_, cache_directory_, index_file_, temp_index_file_,
-                 base::Passed(&pickle), start, app_on_background);
+                 journal_file_, base::Passed(&pickle), start,
+                 app_on_background);
+  if (callback.is_null())
+    cache_thread_->PostTask(FROM_HERE, task);
+  else
+    cache_thread_->PostTaskAndReply(FROM_HERE, task, callback);
+}
+
+void SimpleIndexFile::AppendToJournal(
+    const SimpleIndex::EntrySet& entry_set,
+    const std::unordered_set<uint64_t>& changed_hashes,
+    const base::TimeTicks& start,
+    bool app_on_background,
+    const base::Closure& callback) {
+  std::unique_ptr<std::vector<JournalRecord>> records(
+      new std::vector<JournalRecord>());
+  // One more for the checkpoint.
+  records->reserve(changed_hashes.size() + 1);
+  for (uint64_t hash : changed_hashes) {
+    SimpleIndex::EntrySet::const_iterator it = entry_set.find(hash);
+    if (it == entry_set.end()) {
+      records->push_back(JournalRecord(JOURNAL_RECORD_REMOVED, hash, 0, 0));
+    } else {
+      records->push_back(JournalRecord(
+          JOURNAL_RECORD_ENTRY, hash,
+          it->second.GetLastUsedTime().ToInternalValue(),
+          it->second.GetEntrySize()));
+    }
+  }
+  base::Closure task = base::Bind(
+      &SimpleIndexFile::SyncAppendToJournal, cache_type_, cache_directory_,
+      journal_file_, base::Passed(&records), start, app_on_background);
   if (callback.is_null())
     cache_thread_->PostTask(FROM_HERE, task);
   else
@@ -446,8 +616,85 @@ void SimpleIndexFile::SyncLoadFromDisk(const base::FilePath& index_filename,
       out_last_cache_seen_by_index,
       out_result);
 
-  if (!out_result->did_load)
+  if (!out_result->did_load) {
     simple_util::SimpleCacheDeleteFile(index_filename);
+    return;
+  }
+
+  // Deserialize() has checked the CRC, so the header is valid.
+  const PickleHeader* header =
+      reinterpret_cast<const PickleHeader*>(index_file_map.data());
+  SyncLoadJournal(index_filename.DirName().AppendASCII(kIndexJournalFileName),
+                  header->crc, out_last_cache_seen_by_index, out_result);
+}
+
+// static
+void SimpleIndexFile::SyncLoadJournal(
+    const base::FilePath& journal_filename,
+    uint32_t index_crc,
+    base::Time* out_last_cache_seen_by_index,
+    SimpleIndexLoadResult* out_result) {
+  File file(journal_filename,
+            File::FLAG_OPEN | File::FLAG_READ | File::FLAG_SHARE_DELETE);
+  if (!file.IsValid())
+    return;
+
+  base::MemoryMappedFile journal_map;
+  if (!journal_map.Initialize(std::move(file)) ||
+      journal_map.length() < sizeof(JournalHeader)) {
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    return;
+  }
+
+  JournalHeader header;
+  memcpy(&header, journal_map.data(), sizeof(header));
+  if (header.magic_number != kSimpleIndexJournalMagicNumber ||
+      header.version != kSimpleIndexJournalVersion ||
+      header.index_crc != index_crc) {
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    return;
+  }
+
+  static_assert(sizeof(JournalRecord) == 32, "journal record size changed");
+  // The mapping is page aligned and the header keeps the records aligned.
+  const JournalRecord* records = reinterpret_cast<const JournalRecord*>(
+      journal_map.data() + sizeof(JournalHeader));
+  const size_t record_count =
+      (journal_map.length() - sizeof(JournalHeader)) / sizeof(JournalRecord);
+
+  // Only batches closed by a checkpoint are applied.
+  size_t complete_count = 0;
+  for (size_t i = 0; i < record_count; ++i) {
+    if (!records[i].IsValid())
+      break;
+    if (records[i].type == JOURNAL_RECORD_CHECKPOINT)
+      complete_count = i + 1;
+  }
+
+  SimpleIndex::EntrySet* entries = &out_result->entries;
+  for (size_t i = 0; i < complete_count; ++i) {
+    const JournalRecord& record = records[i];
+    switch (record.type) {
+      case JOURNAL_RECORD_ENTRY:
+        (*entries)[record.hash] = EntryMetadata(
+            base::Time::FromInternalValue(record.time), record.entry_size);
+        break;
+      case JOURNAL_RECORD_REMOVED:
+        entries->erase(record.hash);
+        break;
+      case JOURNAL_RECORD_CHECKPOINT:
+        *out_last_cache_seen_by_index =
+            base::Time::FromInternalValue(record.time);
+        break;
+    }
+  }
+
+  // Appending after an incomplete batch would hide the new records, so the
+  // next write has to start a new journal.
+  out_result->can_append_to_journal =
+      sizeof(JournalHeader) + complete_count * sizeof(JournalRecord) ==
+      journal_map.length();
+  out_result->journal_record_count = complete_count;
 }
 
 // static
@@ -535,6 +782,8 @@ void SimpleIndexFile::SyncRestoreFromDisk(
     SimpleIndexLoadResult* out_result) {
   VLOG(1) << "Simple Cache Index is being restored from disk.";
   simple_util::SimpleCacheDeleteFile(index_file_path);
+  simple_util::SimpleCacheDeleteFile(
+      index_file_path.DirName().AppendASCII(kIndexJournalFileName));
   out_result->Reset();
   SimpleIndex::EntrySet* entries = &out_result->entries;
 
@@ -9,6 +9,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "base/files/file_path.h"
@@ -39,6 +40,12 @@ struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
   SimpleIndex::IndexWriteToDiskReason index_write_reason;
   SimpleIndex::IndexInitMethod init_method;
   bool flush_required;
+
+  // Whether the journal on disk extends the loaded index, so that changes can
+  // be appended to it instead of rewriting the whole index.
+  bool can_append_to_journal;
+  // Number of records in that journal, including checkpoints.
+  uint64_t journal_record_count;
 };
 
 // Simple Index File format is a pickle of IndexMetadata and EntryMetadata
@@ -47,6 +54,14 @@ struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
 // the format see |SimpleIndexFile::Serialize()| and
 // |SimpleIndexFile::LoadFromDisk()|.
 //
+// Changes made between two full writes of the index can instead be appended to
+// a journal file next to it, see |AppendToJournal()|. The journal starts with
+// the CRC of the index it extends and holds fixed-size records, so loading it
+// is a single pass over a memory mapping. Records are appended in batches that
+// end with a checkpoint carrying the cache directory modification time; on
+// load, batches without a checkpoint are ignored and the latest checkpoint
+// decides whether the index is fresh. A full write starts a new journal.
+//
 // The non-static methods must run on the IO thread. All the real
 // work is done in the static methods, which are run on the cache thread
 // or in worker threads. Synchronization between methods is the
@@ -101,9 +116,22 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                            bool app_on_background,
                            const base::Closure& callback);
 
+  // Appends the current metadata of the entries in |changed_hashes| to the
+  // journal, recording the ones missing from |entry_set| as removed. Only
+  // valid after a WriteToDisk() or a load that returned
+  // |can_append_to_journal|.
+  virtual void AppendToJournal(
+      const SimpleIndex::EntrySet& entry_set,
+      const std::unordered_set<uint64_t>& changed_hashes,
+      const base::TimeTicks& start,
+      bool app_on_background,
+      const base::Closure& callback);
+
  private:
   friend class WrappedSimpleIndexFile;
 
+  struct JournalRecord;
+
   // Used for cache directory traversal.
   typedef base::Callback<void (const base::FilePath&)> EntryFileCallback;
 
@@ -123,6 +151,14 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                                base::Time* out_last_cache_seen_by_index,
                                SimpleIndexLoadResult* out_result);
 
+  // Applies the complete batches of the journal to the entries loaded from the
+  // index whose CRC is |index_crc|, and moves |out_last_cache_seen_by_index|
+  // to the last checkpoint. Deletes the journal if it belongs to another index.
+  static void SyncLoadJournal(const base::FilePath& journal_filename,
+                              uint32_t index_crc,
+                              base::Time* out_last_cache_seen_by_index,
+                              SimpleIndexLoadResult* out_result);
+
   // Returns a scoped_ptr for a newly allocated base::Pickle containing the
   // serialized
   // data to be written to a file. Note: the pickle is not in a consistent state
@@ -154,15 +190,26 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
       const base::FilePath& cache_path,
       const EntryFileCallback& entry_file_callback);
 
-  // Writes the index file to disk atomically.
+  // Deletes the journal, writes the index file to disk atomically, and starts
+  // an empty journal for it.
   static void SyncWriteToDisk(net::CacheType cache_type,
                               const base::FilePath& cache_directory,
                               const base::FilePath& index_filename,
                               const base::FilePath& temp_index_filename,
+                              const base::FilePath& journal_filename,
                               std::unique_ptr<base::Pickle> pickle,
                               const base::TimeTicks& start_time,
                               bool app_on_background);
 
+  // Appends |records| to the journal, followed by a checkpoint.
+  static void SyncAppendToJournal(
+      net::CacheType cache_type,
+      const base::FilePath& cache_directory,
+      const base::FilePath& journal_filename,
+      std::unique_ptr<std::vector<JournalRecord>> records,
+      const base::TimeTicks& start_time,
+      bool app_on_background);
+
   // Scan the index directory for entries, returning an EntrySet of all entries
   // found.
   static void SyncRestoreFromDisk(const base::FilePath& cache_directory,
@@ -186,10 +233,12 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
   const base::FilePath cache_directory_;
   const base::FilePath index_file_;
   const base::FilePath temp_index_file_;
+  const base::FilePath journal_file_;
 
   static const char kIndexDirectory[];
   static const char kIndexFileName[];
   static const char kTempIndexFileName[];
+  static const char kIndexJournalFileName[];
 
   DISALLOW_COPY_AND_ASSIGN(SimpleIndexFile);
 };
@@ -5,6 +5,7 @@
 #include "net/disk_cache/simple/simple_index_file.h"
 
 #include <memory>
+#include <unordered_set>
 
 #include "base/files/file.h"
 #include "base/files/file_util.h"
@@ -144,6 +145,8 @@ class WrappedSimpleIndexFile : public SimpleIndexFile {
     return temp_index_file_;
   }
 
+  const base::FilePath& GetJournalFilePath() const { return journal_file_; }
+
   bool CreateIndexFileDirectory() const {
     return base::CreateDirectory(index_file_.DirName());
   }
@@ -274,6 +277,118 @@ TEST_F(SimpleIndexFileTest, WriteThenLoadIndex) {
     EXPECT_EQ(1U, load_index_result.entries.count(kHashes[i]));
 }
 
+TEST_F(SimpleIndexFileTest, WriteAppendThenLoadIndex) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+
+  SimpleIndex::EntrySet entries;
+  static const uint64_t kHashes[] = {11, 22, 33};
+  for (uint64_t hash : kHashes) {
+    SimpleIndex::InsertInEntrySet(
+        hash, EntryMetadata(Time(), static_cast<uint32_t>(hash)), &entries);
+  }
+
+  net::TestClosure closure;
+  WrappedSimpleIndexFile simple_index_file(cache_dir.path());
+  simple_index_file.WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_SHUTDOWN,
+                                entries, 66U, base::TimeTicks(), false,
+                                closure.closure());
+  closure.WaitForResult();
+  EXPECT_TRUE(base::PathExists(simple_index_file.GetJournalFilePath()));
+
+  // Remove one entry, resize another and add a new one.
+  const Time kLastUsedTime = Time::Now();
+  entries.erase(11);
+  entries[22] = EntryMetadata(kLastUsedTime, 222u);
+  entries[44] = EntryMetadata(kLastUsedTime, 44u);
+  std::unordered_set<uint64_t> changed_hashes = {11, 22, 44};
+  simple_index_file.AppendToJournal(entries, changed_hashes, base::TimeTicks(),
+                                    false, closure.closure());
+  closure.WaitForResult();
+
+  base::Time fake_cache_mtime;
+  ASSERT_TRUE(simple_util::GetMTime(cache_dir.path(), &fake_cache_mtime));
+  SimpleIndexLoadResult load_index_result;
+  simple_index_file.LoadIndexEntries(fake_cache_mtime, closure.closure(),
+                                     &load_index_result);
+  closure.WaitForResult();
+
+  EXPECT_TRUE(load_index_result.did_load);
+  EXPECT_EQ(SimpleIndex::INITIALIZE_METHOD_LOADED,
+            load_index_result.init_method);
+  EXPECT_TRUE(load_index_result.can_append_to_journal);
+  // Three changes and a checkpoint.
+  EXPECT_EQ(4U, load_index_result.journal_record_count);
+  ASSERT_EQ(entries.size(), load_index_result.entries.size());
+  for (const auto& entry : entries) {
+    SimpleIndex::EntrySet::const_iterator it =
+        load_index_result.entries.find(entry.first);
+    ASSERT_TRUE(load_index_result.entries.end() != it);
+    EXPECT_TRUE(CompareTwoEntryMetadata(entry.second, it->second));
+  }
+}
+
+// A batch cut short by a crash is ignored, and stops further appends.
+TEST_F(SimpleIndexFileTest, LoadIgnoresTornJournalAppend) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time(), 11u), &entries);
+
+  net::TestClosure closure;
+  WrappedSimpleIndexFile simple_index_file(cache_dir.path());
+  simple_index_file.WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_SHUTDOWN,
+                                entries, 11U, base::TimeTicks(), false,
+                                closure.closure());
+  closure.WaitForResult();
+
+  const std::string kPartialRecord(20, 'x');
+  ASSERT_TRUE(base::AppendToFile(simple_index_file.GetJournalFilePath(),
+                                 kPartialRecord.data(),
+                                 kPartialRecord.size()));
+
+  base::Time fake_cache_mtime;
+  ASSERT_TRUE(simple_util::GetMTime(cache_dir.path(), &fake_cache_mtime));
+  SimpleIndexLoadResult load_index_result;
+  simple_index_file.LoadIndexEntries(fake_cache_mtime, closure.closure(),
+                                     &load_index_result);
+  closure.WaitForResult();
+
+  EXPECT_TRUE(load_index_result.did_load);
+  EXPECT_FALSE(load_index_result.can_append_to_journal);
+  EXPECT_EQ(1U, load_index_result.entries.size());
+}
+
+// A failed index write removes the journal, which extends the previous index
+// and not the one SimpleIndex asked to write.
+TEST_F(SimpleIndexFileTest, FailedWriteRemovesJournal) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time(), 11u), &entries);
+
+  net::TestClosure closure;
+  WrappedSimpleIndexFile simple_index_file(cache_dir.path());
+  simple_index_file.WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_SHUTDOWN,
+                                entries, 11U, base::TimeTicks(), false,
+                                closure.closure());
+  closure.WaitForResult();
+  ASSERT_TRUE(base::PathExists(simple_index_file.GetJournalFilePath()));
+
+  // The temporary index file cannot be written over a directory.
+  ASSERT_TRUE(base::CreateDirectory(simple_index_file.GetTempIndexFilePath()));
+  SimpleIndex::InsertInEntrySet(22, EntryMetadata(Time(), 22u), &entries);
+  simple_index_file.WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_SHUTDOWN,
+                                entries, 33U, base::TimeTicks(), false,
+                                closure.closure());
+  closure.WaitForResult();
+
+  EXPECT_FALSE(base::PathExists(simple_index_file.GetJournalFilePath()));
+  EXPECT_TRUE(base::PathExists(simple_index_file.GetIndexFilePath()));
+}
+
 TEST_F(SimpleIndexFileTest, LoadCorruptIndex) {
   base::ScopedTempDir cache_dir;
   ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
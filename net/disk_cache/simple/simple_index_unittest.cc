@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 
 #include "base/files/scoped_temp_dir.h"
@@ -56,7 +57,8 @@ class MockSimpleIndexFile : public SimpleIndexFile,
       : SimpleIndexFile(NULL, NULL, net::DISK_CACHE, base::FilePath()),
         load_result_(NULL),
         load_index_entries_calls_(0),
-        disk_writes_(0) {}
+        disk_writes_(0),
+        journal_appends_(0) {}
 
   void LoadIndexEntries(base::Time cache_last_modified,
                         const base::Closure& callback,
@@ -76,6 +78,15 @@ class MockSimpleIndexFile : public SimpleIndexFile,
     disk_write_entry_set_ = entry_set;
   }
 
+  void AppendToJournal(const SimpleIndex::EntrySet& entry_set,
+                       const std::unordered_set<uint64_t>& changed_hashes,
+                       const base::TimeTicks& start,
+                       bool app_on_background,
+                       const base::Closure& callback) override {
+    journal_appends_++;
+    journal_changed_hashes_ = changed_hashes;
+  }
+
   void GetAndResetDiskWriteEntrySet(SimpleIndex::EntrySet* entry_set) {
     entry_set->swap(disk_write_entry_set_);
   }
@@ -84,6 +95,10 @@ class MockSimpleIndexFile : public SimpleIndexFile,
   SimpleIndexLoadResult* load_result() const { return load_result_; }
   int load_index_entries_calls() const { return load_index_entries_calls_; }
   int disk_writes() const { return disk_writes_; }
+  int journal_appends() const { return journal_appends_; }
+  const std::unordered_set<uint64_t>& journal_changed_hashes() const {
+    return journal_changed_hashes_;
+  }
 
  private:
   base::Closure load_callback_;
@@ -91,6 +106,8 @@ class MockSimpleIndexFile : public SimpleIndexFile,
   int load_index_entries_calls_;
   int disk_writes_;
   SimpleIndex::EntrySet disk_write_entry_set_;
+  int journal_appends_;
+  std::unordered_set<uint64_t> journal_changed_hashes_;
 };
 
 class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
@@ -645,4 +662,38 @@ TEST_F(SimpleIndexTest, DiskWritePostponed) {
   index()->write_to_disk_timer_.Stop();
 }
 
+TEST_F(SimpleIndexTest, DiskWriteAppendsToJournal) {
+  index()->SetMaxSize(100000);
+  const base::Time now(base::Time::Now());
+  for (uint64_t hash = 1; hash <= 40; ++hash)
+    InsertIntoIndexFileReturn(hash, now, 10);
+  index_file_->load_result()->can_append_to_journal = true;
+  ReturnIndexFile();
+
+  const uint64_t kHash1 = hashes_.at<1>();
+  index()->Insert(kHash1);
+  index()->Remove(1);
+  index()->WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_IDLE);
+  EXPECT_EQ(0, index_file_->disk_writes());
+  EXPECT_EQ(1, index_file_->journal_appends());
+  EXPECT_EQ(2u, index_file_->journal_changed_hashes().size());
+  EXPECT_EQ(1u, index_file_->journal_changed_hashes().count(kHash1));
+  EXPECT_EQ(1u, index_file_->journal_changed_hashes().count(1));
+
+  // With 40 entries the journal may hold 10 records; three are used, and this
+  // batch needs ten more, so the index is rewritten instead.
+  for (uint64_t hash = 2; hash <= 10; ++hash)
+    index()->UpdateEntrySize(hash, 20u);
+  index()->WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_IDLE);
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(1, index_file_->journal_appends());
+
+  // The rewrite starts a new journal.
+  index()->UseIfExists(kHash1);
+  index()->WriteToDisk(SimpleIndex::INDEX_WRITE_REASON_IDLE);
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(2, index_file_->journal_appends());
+  EXPECT_EQ(1u, index_file_->journal_changed_hashes().size());
+}
+
 }  // namespace disk_cache
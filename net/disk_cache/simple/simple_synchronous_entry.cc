@@ -78,6 +78,9 @@ enum CloseResult {
 // Used in histograms, please only add entries at the end.
 enum class KeySHA256Result { NOT_PRESENT, MATCHED, NO_MATCH, MAX };
 
+// Whether InitializeForOpen() prefetches the tail of the stream 0 file.
+bool g_tail_prefetch_enabled = true;
+
 void RecordSyncOpenResult(net::CacheType cache_type,
                           OpenEntryResult result,
                           bool had_index) {
@@ -251,6 +254,42 @@ SimpleSynchronousEntry::EntryOperationData::EntryOperationData(
     int buf_len_p)
     : sparse_offset(sparse_offset_p), buf_len(buf_len_p) {}
 
+SimpleSynchronousEntry::PrefetchData::PrefetchData() : offset_(0) {}
+
+SimpleSynchronousEntry::PrefetchData::~PrefetchData() {}
+
+bool SimpleSynchronousEntry::PrefetchData::PrefetchTail(File* file,
+                                                        int64_t file_size,
+                                                        int max_size) {
+  DCHECK(data_.empty());
+  if (file_size <= 0)
+    return false;
+  offset_ = std::max<int64_t>(0, file_size - max_size);
+  int size = static_cast<int>(file_size - offset_);
+  data_.resize(size);
+  if (file->Read(offset_, data_.data(), size) != size) {
+    data_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool SimpleSynchronousEntry::PrefetchData::ReadData(
+    int64_t offset,
+    int size,
+    char* dest,
+    int* out_bytes_read) const {
+  if (data_.empty() || offset < offset_)
+    return false;
+  const int64_t available =
+      std::max<int64_t>(0, offset_ + data_.size() - offset);
+  int bytes_read = static_cast<int>(std::min<int64_t>(size, available));
+  if (bytes_read > 0)
+    std::memcpy(dest, data_.data() + (offset - offset_), bytes_read);
+  *out_bytes_read = bytes_read;
+  return true;
+}
+
 // static
 void SimpleSynchronousEntry::OpenEntry(
     net::CacheType cache_type,
@@ -325,6 +364,11 @@ int SimpleSynchronousEntry::DoomEntrySet(
   return (did_delete_count == key_hashes->size()) ? net::OK : net::ERR_FAILED;
 }
 
+// static
+void SimpleSynchronousEntry::SetTailPrefetchEnabledForTesting(bool enabled) {
+  g_tail_prefetch_enabled = enabled;
+}
+
 void SimpleSynchronousEntry::ReadData(const EntryOperationData& in_entry_op,
                                       net::IOBuffer* out_buf,
                                       uint32_t* out_crc32,
@@ -334,7 +378,7 @@ void SimpleSynchronousEntry::ReadData(const EntryOperationData& in_entry_op,
   DCHECK_NE(0, in_entry_op.index);
   int file_index = GetFileIndexFromStreamIndex(in_entry_op.index);
   if (header_and_key_check_needed_[file_index] &&
-      !CheckHeaderAndKey(file_index)) {
+      !CheckHeaderAndKey(file_index, nullptr)) {
     *out_result = net::ERR_FAILED;
     Doom();
     return;
@@ -370,7 +414,8 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
   int index = in_entry_op.index;
   int file_index = GetFileIndexFromStreamIndex(index);
   if (header_and_key_check_needed_[file_index] &&
-      !empty_file_omitted_[file_index] && !CheckHeaderAndKey(file_index)) {
+      !empty_file_omitted_[file_index] &&
+      !CheckHeaderAndKey(file_index, nullptr)) {
     *out_result = net::ERR_FAILED;
     Doom();
     return;
@@ -666,8 +711,8 @@ void SimpleSynchronousEntry::CheckEOFRecord(int index,
   bool has_crc32;
   bool has_key_sha256;
   int32_t stream_size;
-  *out_result = GetEOFRecordData(index, entry_stat, &has_crc32, &has_key_sha256,
-                                 &crc32, &stream_size);
+  *out_result = GetEOFRecordData(index, entry_stat, nullptr, &has_crc32,
+                                 &has_key_sha256, &crc32, &stream_size);
   if (*out_result != net::OK) {
     Doom();
     return;
@@ -749,7 +794,7 @@ void SimpleSynchronousEntry::Close(
     if (empty_file_omitted_[i])
       continue;
 
-    if (header_and_key_check_needed_[i] && !CheckHeaderAndKey(i)) {
+    if (header_and_key_check_needed_[i] && !CheckHeaderAndKey(i, nullptr)) {
       Doom();
     }
     files_[i].Close();
@@ -977,7 +1022,9 @@ void SimpleSynchronousEntry::CloseFiles() {
     CloseFile(i);
 }
 
-bool SimpleSynchronousEntry::CheckHeaderAndKey(int file_index) {
+bool SimpleSynchronousEntry::CheckHeaderAndKey(
+    int file_index,
+    const PrefetchData* prefetch_data) {
   // TODO(gavinp): Frequently we are doing this at the same time as we read from
   // the beginning of an entry. It might improve performance to make a single
   // read(2) call rather than two separate reads. On the other hand, it would
@@ -986,8 +1033,8 @@ bool SimpleSynchronousEntry::CheckHeaderAndKey(int file_index) {
   // actually already reading stream 1 data here, and tossing it out.
   std::vector<char> header_data(key_.empty() ? kInitialHeaderRead
                                              : GetHeaderSize(key_.size()));
-  int bytes_read =
-      files_[file_index].Read(0, header_data.data(), header_data.size());
+  int bytes_read = ReadFromFile(file_index, prefetch_data, 0,
+                                header_data.data(), header_data.size());
   const SimpleFileHeader* header =
       reinterpret_cast<const SimpleFileHeader*>(header_data.data());
 
@@ -1016,8 +1063,9 @@ bool SimpleSynchronousEntry::CheckHeaderAndKey(int file_index) {
     int bytes_to_read = expected_header_size - old_size;
     // This resize will invalidate iterators, since it is enlarging header_data.
     header_data.resize(expected_header_size);
-    int bytes_read = files_[file_index].Read(
-        old_size, header_data.data() + old_size, bytes_to_read);
+    int bytes_read =
+        ReadFromFile(file_index, prefetch_data, old_size,
+                     header_data.data() + old_size, bytes_to_read);
     if (bytes_read != bytes_to_read) {
       RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_KEY, had_index_);
       return false;
@@ -1045,6 +1093,20 @@ bool SimpleSynchronousEntry::CheckHeaderAndKey(int file_index) {
   return true;
 }
 
+int SimpleSynchronousEntry::ReadFromFile(int file_index,
+                                         const PrefetchData* prefetch_data,
+                                         int64_t offset,
+                                         char* dest,
+                                         int size) const {
+  int bytes_read;
+  if (file_index == 0 && prefetch_data &&
+      prefetch_data->ReadData(offset, size, dest, &bytes_read)) {
+    return bytes_read;
+  }
+  File* file = const_cast<File*>(&files_[file_index]);
+  return file->Read(offset, dest, size);
+}
+
 int SimpleSynchronousEntry::InitializeForOpen(
     SimpleEntryStat* out_entry_stat,
     scoped_refptr<net::GrowableIOBuffer>* stream_0_data,
@@ -1058,18 +1120,28 @@ int SimpleSynchronousEntry::InitializeForOpen(
     if (empty_file_omitted_[i])
       continue;
 
-    if (!key_.empty()) {
+    // Everything read from file 0 while opening is near its end, and for small
+    // entries the header is too, so one read usually serves all of it.
+    // File size for stream 0 has been stored temporarily in data_size[1].
+    PrefetchData prefetch_data;
+    if (i == 0 && g_tail_prefetch_enabled) {
+      prefetch_data.PrefetchTail(&files_[i], out_entry_stat->data_size(1),
+                                 kPrefetchTailSize);
+    }
+
+    // The header check can be deferred until the first read if the key is
+    // known, unless the header is already in memory.
+    if (!key_.empty() && !prefetch_data.has_file_start()) {
       header_and_key_check_needed_[i] = true;
     } else {
-      if (!CheckHeaderAndKey(i))
+      if (!CheckHeaderAndKey(i, &prefetch_data))
         return net::ERR_FAILED;
     }
 
     if (i == 0) {
-      // File size for stream 0 has been stored temporarily in data_size[1].
-      int ret_value_stream_0 =
-          ReadAndValidateStream0(out_entry_stat->data_size(1), out_entry_stat,
-                                 stream_0_data, out_stream_0_crc32);
+      int ret_value_stream_0 = ReadAndValidateStream0(
+          out_entry_stat->data_size(1), out_entry_stat, stream_0_data,
+          out_stream_0_crc32, &prefetch_data);
       if (ret_value_stream_0 != net::OK)
         return ret_value_stream_0;
     } else {
@@ -1164,7 +1236,8 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
     int file_size,
     SimpleEntryStat* out_entry_stat,
     scoped_refptr<net::GrowableIOBuffer>* stream_0_data,
-    uint32_t* out_stream_0_crc32) {
+    uint32_t* out_stream_0_crc32,
+    const PrefetchData* prefetch_data) {
   // Pretend this file has a null stream zero, and contains the optional key
   // SHA256. This is good enough to read the EOF record on the file, which gives
   // the actual size of stream 0.
@@ -1178,8 +1251,8 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
   uint32_t read_crc32;
   int32_t stream_0_size;
   int ret_value_crc32 =
-      GetEOFRecordData(0, *out_entry_stat, &has_crc32, &has_key_sha256,
-                       &read_crc32, &stream_0_size);
+      GetEOFRecordData(0, *out_entry_stat, prefetch_data, &has_crc32,
+                       &has_key_sha256, &read_crc32, &stream_0_size);
   if (ret_value_crc32 != net::OK)
     return ret_value_crc32;
 
@@ -1199,9 +1272,10 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
   int read_size = stream_0_size;
   if (has_key_sha256)
     read_size += sizeof(net::SHA256HashValue);
-  if (files_[0].Read(file_offset, (*stream_0_data)->data(), read_size) !=
-      read_size)
+  if (ReadFromFile(0, prefetch_data, file_offset, (*stream_0_data)->data(),
+                   read_size) != read_size) {
     return net::ERR_FAILED;
+  }
 
   // Check the CRC32.
   uint32_t expected_crc32 =
@@ -1235,7 +1309,7 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
 
   // Ensure the key is validated before completion.
   if (!has_key_sha256 && header_and_key_check_needed_[0])
-    CheckHeaderAndKey(0);
+    CheckHeaderAndKey(0, prefetch_data);
 
   RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_SUCCESS);
   return net::OK;
@@ -1243,6 +1317,7 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
 
 int SimpleSynchronousEntry::GetEOFRecordData(int index,
                                              const SimpleEntryStat& entry_stat,
+                                             const PrefetchData* prefetch_data,
                                              bool* out_has_crc32,
                                              bool* out_has_key_sha256,
                                              uint32_t* out_crc32,
@@ -1250,10 +1325,9 @@ int SimpleSynchronousEntry::GetEOFRecordData(int index,
   SimpleFileEOF eof_record;
   int file_offset = entry_stat.GetEOFOffsetInFile(key_.size(), index);
   int file_index = GetFileIndexFromStreamIndex(index);
-  File* file = const_cast<File*>(&files_[file_index]);
-  if (file->Read(file_offset, reinterpret_cast<char*>(&eof_record),
-                 sizeof(eof_record)) !=
-      sizeof(eof_record)) {
+  if (ReadFromFile(file_index, prefetch_data, file_offset,
+                   reinterpret_cast<char*>(&eof_record),
+                   sizeof(eof_record)) != sizeof(eof_record)) {
     RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_READ_FAILURE);
     return net::ERR_CACHE_CHECKSUM_READ_FAILURE;
   }
@@ -17,6 +17,7 @@
 #include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/time/time.h"
 #include "net/base/cache_type.h"
@@ -150,6 +151,11 @@ class SimpleSynchronousEntry {
   static int DoomEntrySet(const std::vector<uint64_t>* key_hashes,
                           const base::FilePath& path);
 
+  // Enables or disables reading the tail of the stream 0 file at once when
+  // opening an entry. It is enabled by default. Must not be called while
+  // entries are being opened.
+  static void SetTailPrefetchEnabledForTesting(bool enabled);
+
   // N.B. ReadData(), WriteData(), CheckEOFRecord() and Close() may block on IO.
   void ReadData(const EntryOperationData& in_entry_op,
                 net::IOBuffer* out_buf,
@@ -220,6 +226,39 @@ class SimpleSynchronousEntry {
   // make it likely the entire key is read.
   static const size_t kInitialHeaderRead = 64 * 1024;
 
+  // How much of the end of the stream 0 file is read at once when opening an
+  // entry. This covers the EOF record, stream 0 and the key SHA256 of most
+  // HTTP cache entries, and the whole file, header included, of small ones.
+  static const int kPrefetchTailSize = 8 * 1024;
+
+  // The last bytes of a file, read with a single read(2) call so that opening
+  // an entry does not need a separate read for each of the records it checks.
+  class PrefetchData {
+   public:
+    PrefetchData();
+    ~PrefetchData();
+
+    // Reads the last |max_size| bytes of |file|, which is |file_size| bytes
+    // long, or all of it if it is smaller. Returns false on failure, in which
+    // case ReadData() never succeeds.
+    bool PrefetchTail(base::File* file, int64_t file_size, int max_size);
+
+    // If the prefetched data starts at or before |offset|, copies up to |size|
+    // bytes from |offset| into |dest|, stopping at the end of the file like
+    // base::File::Read(), and returns true.
+    bool ReadData(int64_t offset, int size, char* dest, int* out_bytes_read)
+        const;
+
+    // True if the whole file was prefetched.
+    bool has_file_start() const { return !data_.empty() && offset_ == 0; }
+
+   private:
+    int64_t offset_;
+    std::vector<char> data_;
+
+    DISALLOW_COPY_AND_ASSIGN(PrefetchData);
+  };
+
   SimpleSynchronousEntry(net::CacheType cache_type,
                          const base::FilePath& path,
                          const std::string& key,
@@ -249,8 +288,17 @@ class SimpleSynchronousEntry {
   // Read the header and key at the beginning of the file, and validate that
   // they are correct. If this entry was opened with a key, the key is checked
   // for a match. If not, then the |key_| member is set based on the value in
-  // this header. Records histograms if any check is failed.
-  bool CheckHeaderAndKey(int file_index);
+  // this header. Records histograms if any check is failed. Reads are served
+  // from |prefetch_data| where possible; it may be null.
+  bool CheckHeaderAndKey(int file_index, const PrefetchData* prefetch_data);
+
+  // Reads |size| bytes at |offset| of file |file_index|, from |prefetch_data|
+  // if it holds them. Returns the number of bytes read, or -1 on error.
+  int ReadFromFile(int file_index,
+                   const PrefetchData* prefetch_data,
+                   int64_t offset,
+                   char* dest,
+                   int size) const;
 
   // Returns a net error, i.e. net::OK on success.
   int InitializeForOpen(SimpleEntryStat* out_entry_stat,
@@ -272,10 +320,12 @@ class SimpleSynchronousEntry {
       int file_size,
       SimpleEntryStat* out_entry_stat,
       scoped_refptr<net::GrowableIOBuffer>* stream_0_data,
-      uint32_t* out_stream_0_crc32);
+      uint32_t* out_stream_0_crc32,
+      const PrefetchData* prefetch_data);
 
   int GetEOFRecordData(int index,
                        const SimpleEntryStat& entry_stat,
+                       const PrefetchData* prefetch_data,
                        bool* out_has_crc32,
                        bool* out_has_key_sha256,
                        uint32_t* out_crc32,
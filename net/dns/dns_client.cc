@@ -25,21 +25,29 @@ class DnsClientImpl : public DnsClient {
  public:
   DnsClientImpl(NetLog* net_log,
                 ClientSocketFactory* socket_factory,
-                const RandIntCallback& rand_int_callback)
+                const RandIntCallback& rand_int_callback,
+                bool reuse_sockets)
       : address_sorter_(AddressSorter::CreateAddressSorter()),
         net_log_(net_log),
         socket_factory_(socket_factory),
-        rand_int_callback_(rand_int_callback) {}
+        rand_int_callback_(rand_int_callback),
+        reuse_sockets_(reuse_sockets) {}
 
   void SetConfig(const DnsConfig& config) override {
     factory_.reset();
     session_ = nullptr;
     if (config.IsValid() && !config.unhandled_options) {
-      std::unique_ptr<DnsSocketPool> socket_pool(
-          config.randomize_ports
-              ? DnsSocketPool::CreateDefault(socket_factory_,
-                                             rand_int_callback_)
-              : DnsSocketPool::CreateNull(socket_factory_, rand_int_callback_));
+      std::unique_ptr<DnsSocketPool> socket_pool;
+      if (config.randomize_ports) {
+        socket_pool =
+            DnsSocketPool::CreateDefault(socket_factory_, rand_int_callback_);
+      } else if (reuse_sockets_) {
+        socket_pool =
+            DnsSocketPool::CreateReusing(socket_factory_, rand_int_callback_);
+      } else {
+        socket_pool =
+            DnsSocketPool::CreateNull(socket_factory_, rand_int_callback_);
+      }
       session_ = new DnsSession(config, std::move(socket_pool),
                                 rand_int_callback_, net_log_);
       factory_ = DnsTransactionFactory::CreateFactory(session_.get());
@@ -77,6 +85,7 @@ class DnsClientImpl : public DnsClient {
 
   ClientSocketFactory* socket_factory_;
   const RandIntCallback rand_int_callback_;
+  const bool reuse_sockets_;
 
   DISALLOW_COPY_AND_ASSIGN(DnsClientImpl);
 };
@@ -87,7 +96,15 @@ class DnsClientImpl : public DnsClient {
 std::unique_ptr<DnsClient> DnsClient::CreateClient(NetLog* net_log) {
   return base::WrapUnique(
       new DnsClientImpl(net_log, ClientSocketFactory::GetDefaultFactory(),
-                        base::Bind(&base::RandInt)));
+                        base::Bind(&base::RandInt), false));
+}
+
+// static
+std::unique_ptr<DnsClient> DnsClient::CreateClientWithSocketReuse(
+    NetLog* net_log) {
+  return base::WrapUnique(
+      new DnsClientImpl(net_log, ClientSocketFactory::GetDefaultFactory(),
+                        base::Bind(&base::RandInt), true));
 }
 
 // static
@@ -96,7 +113,7 @@ std::unique_ptr<DnsClient> DnsClient::CreateClientForTesting(
     ClientSocketFactory* socket_factory,
     const RandIntCallback& rand_int_callback) {
   return base::WrapUnique(
-      new DnsClientImpl(net_log, socket_factory, rand_int_callback));
+      new DnsClientImpl(net_log, socket_factory, rand_int_callback, false));
 }
 
 }  // namespace net
@@ -49,6 +49,15 @@ class NET_EXPORT DnsClient {
   // Creates default client.
   static std::unique_ptr<DnsClient> CreateClient(NetLog* net_log);
 
+  // Creates a client for resolvers that send many queries to the same
+  // nameservers. Unless the config requires randomized ports, queries share a
+  // few long-lived UDP sockets per nameserver, and responses are matched to
+  // them by query ID, instead of connecting a new socket for each attempt.
+  // This reduces source port randomization, which makes spoofed responses
+  // easier to get accepted, so it is not the default.
+  static std::unique_ptr<DnsClient> CreateClientWithSocketReuse(
+      NetLog* net_log);
+
   // Creates a client for testing.  Allows using a mock ClientSocketFactory and
   // a deterministic random number generator. |socket_factory| must outlive
   // the returned DnsClient.
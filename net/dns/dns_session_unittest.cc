@@ -25,6 +25,11 @@ namespace net {
 
 namespace {
 
+// A RandIntCallback that makes the reusing pool always pick the same socket.
+int FirstInRange(int min, int max) {
+  return min;
+}
+
 class TestClientSocketFactory : public ClientSocketFactory {
  public:
   ~TestClientSocketFactory() override;
@@ -55,6 +60,8 @@ class TestClientSocketFactory : public ClientSocketFactory {
 
   void ClearSSLSessionCache() override { NOTIMPLEMENTED(); }
 
+  size_t num_created_sockets() const { return data_providers_.size(); }
+
  private:
   std::list<SocketDataProvider*> data_providers_;
 };
@@ -71,6 +78,9 @@ class DnsSessionTest : public testing::Test {
 
  protected:
   void Initialize(unsigned num_servers);
+  // Like Initialize, but uses the pool of DnsSocketPool::CreateReusing, which
+  // always picks the first of a server's sockets.
+  void InitializeReusing(unsigned num_servers);
   std::unique_ptr<DnsSession::SocketLease> Allocate(unsigned server_index);
   bool DidAllocate(unsigned server_index);
   bool DidFree(unsigned server_index);
@@ -82,6 +92,8 @@ class DnsSessionTest : public testing::Test {
   NetLog::Source source_;
 
  private:
+  void InitializeWithPool(unsigned num_servers,
+                          std::unique_ptr<DnsSocketPool> dns_socket_pool);
   bool ExpectEvent(const PoolEvent& event);
   std::list<PoolEvent> events_;
 };
@@ -114,6 +126,24 @@ class MockDnsSocketPool : public DnsSocketPool {
 };
 
 void DnsSessionTest::Initialize(unsigned num_servers) {
+  test_client_socket_factory_.reset(new TestClientSocketFactory());
+  InitializeWithPool(
+      num_servers,
+      std::unique_ptr<DnsSocketPool>(
+          new MockDnsSocketPool(test_client_socket_factory_.get(), this)));
+}
+
+void DnsSessionTest::InitializeReusing(unsigned num_servers) {
+  test_client_socket_factory_.reset(new TestClientSocketFactory());
+  InitializeWithPool(
+      num_servers,
+      DnsSocketPool::CreateReusing(test_client_socket_factory_.get(),
+                                   base::Bind(&FirstInRange)));
+}
+
+void DnsSessionTest::InitializeWithPool(
+    unsigned num_servers,
+    std::unique_ptr<DnsSocketPool> dns_socket_pool) {
   CHECK(num_servers < 256u);
   config_.nameservers.clear();
   for (unsigned char i = 0; i < num_servers; ++i) {
@@ -122,14 +152,8 @@ void DnsSessionTest::Initialize(unsigned num_servers) {
     config_.nameservers.push_back(dns_endpoint);
   }
 
-  test_client_socket_factory_.reset(new TestClientSocketFactory());
-
-  DnsSocketPool* dns_socket_pool =
-      new MockDnsSocketPool(test_client_socket_factory_.get(), this);
-
-  session_ =
-      new DnsSession(config_, std::unique_ptr<DnsSocketPool>(dns_socket_pool),
-                     base::Bind(&base::RandInt), NULL /* NetLog */);
+  session_ = new DnsSession(config_, std::move(dns_socket_pool),
+                            base::Bind(&base::RandInt), NULL /* NetLog */);
 
   events_.clear();
 }
@@ -220,6 +244,30 @@ TEST_F(DnsSessionTest, AllocateFree) {
   EXPECT_TRUE(NoMoreEvents());
 }
 
+// Queries to a server share its sockets.
+TEST_F(DnsSessionTest, ReusingPoolSharesSockets) {
+  InitializeReusing(2);
+
+  std::unique_ptr<DnsSession::SocketLease> lease1 = Allocate(0);
+  std::unique_ptr<DnsSession::SocketLease> lease2 = Allocate(0);
+  ASSERT_TRUE(lease1);
+  ASSERT_TRUE(lease2);
+  EXPECT_NE(lease1->socket(), lease2->socket());
+  EXPECT_EQ(1u, test_client_socket_factory_->num_created_sockets());
+
+  // Queries to another server don't.
+  std::unique_ptr<DnsSession::SocketLease> other_lease = Allocate(1);
+  ASSERT_TRUE(other_lease);
+  EXPECT_EQ(2u, test_client_socket_factory_->num_created_sockets());
+
+  // The shared socket stays connected once its queries are done.
+  lease1.reset();
+  lease2.reset();
+  lease1 = Allocate(0);
+  ASSERT_TRUE(lease1);
+  EXPECT_EQ(2u, test_client_socket_factory_->num_created_sockets());
+}
+
 // Expect default calculated timeout to be within 10ms of one in DnsConfig.
 TEST_F(DnsSessionTest, HistogramTimeoutNormal) {
   Initialize(2);
@@ -4,13 +4,28 @@
 
 #include "net/dns/dns_socket_pool.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/big_endian.h"
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/rand_util.h"
 #include "base/stl_util.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "net/base/address_list.h"
+#include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
+#include "net/dns/dns_protocol.h"
 #include "net/socket/client_socket_factory.h"
 #include "net/socket/stream_socket.h"
 #include "net/udp/datagram_client_socket.h"
@@ -36,6 +51,10 @@ const unsigned kInitialPoolSize = 0;
 const unsigned kAllocateMinSize = 1;
 #endif
 
+// Number of sockets a ReusingDnsSocketPool shares between the queries to one
+// server.
+const unsigned kSharedSocketsPerServer = 4;
+
 } // namespace
 
 DnsSocketPool::DnsSocketPool(ClientSocketFactory* socket_factory,
@@ -223,4 +242,469 @@ void DefaultDnsSocketPool::FillPool(unsigned server_index, unsigned size) {
   }
 }
 
+class MultiplexedDnsSocket;
+
+// A UDP socket connected to a nameserver, which several queries share. A
+// socket allows only one pending Read and one pending Write, so writes are
+// sent one at a time, in order, and a single read loop hands every response to
+// the queries with the same ID.
+class SharedDnsSocket : public base::RefCounted<SharedDnsSocket> {
+ public:
+  explicit SharedDnsSocket(std::unique_ptr<DatagramClientSocket> socket);
+
+  DatagramClientSocket* socket() const { return socket_.get(); }
+
+  // OK, or the error that stopped the read loop. Queries waiting for a
+  // response get the error, and the socket isn't handed out any more.
+  int read_result() const { return read_result_; }
+
+  // Delivers the datagrams whose ID is |id| to |query|, until RemoveQuery.
+  void AddQuery(uint16_t id, MultiplexedDnsSocket* query);
+  void RemoveQuery(uint16_t id, MultiplexedDnsSocket* query);
+
+  // Like Socket::Write. |callback| isn't run once CancelWrites is called for
+  // |query|.
+  int Write(MultiplexedDnsSocket* query,
+            IOBuffer* buf,
+            int buf_len,
+            const CompletionCallback& callback);
+  void CancelWrites(MultiplexedDnsSocket* query);
+
+  // Starts the read loop, unless it is already running.
+  void StartReading();
+
+ private:
+  friend class base::RefCounted<SharedDnsSocket>;
+
+  struct PendingWrite {
+    PendingWrite(MultiplexedDnsSocket* query,
+                 IOBuffer* buf,
+                 int buf_len,
+                 const CompletionCallback& callback);
+    PendingWrite(const PendingWrite& other);
+    ~PendingWrite();
+
+    MultiplexedDnsSocket* query;
+    scoped_refptr<IOBuffer> buf;
+    int buf_len;
+    CompletionCallback callback;
+  };
+
+  typedef std::multimap<uint16_t, MultiplexedDnsSocket*> QueryMap;
+
+  ~SharedDnsSocket();
+
+  void DoWrites();
+  void OnWriteComplete(int rv);
+  void CompleteWrite(int rv);
+
+  void DoReads();
+  void OnReadComplete(int rv);
+  void HandleRead(int rv);
+
+  bool HasQuery(uint16_t id, MultiplexedDnsSocket* query) const;
+
+  std::unique_ptr<DatagramClientSocket> socket_;
+  QueryMap queries_;
+
+  // Writes that wait for the socket. The first one is in progress if
+  // |writing_| is true.
+  std::deque<PendingWrite> pending_writes_;
+  bool writing_;
+
+  scoped_refptr<IOBufferWithSize> read_buffer_;
+  bool reading_;
+  int read_result_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDnsSocket);
+};
+
+// What a ReusingDnsSocketPool hands out: a socket for one query, which sends
+// and receives through a SharedDnsSocket. The query's ID is taken from the
+// datagram it writes.
+class MultiplexedDnsSocket : public DatagramClientSocket {
+ public:
+  explicit MultiplexedDnsSocket(scoped_refptr<SharedDnsSocket> shared_socket)
+      : shared_socket_(std::move(shared_socket)),
+        registered_(false),
+        query_id_(0),
+        read_buffer_len_(0) {}
+
+  ~MultiplexedDnsSocket() override { Close(); }
+
+  // Called by |shared_socket_| with a datagram for this query.
+  void OnDatagram(const char* data, int size) {
+    if (read_callback_.is_null()) {
+      received_.push_back(std::string(data, size));
+      return;
+    }
+    int bytes_read = std::min(size, read_buffer_len_);
+    memcpy(read_buffer_->data(), data, bytes_read);
+    RunReadCallback(bytes_read);
+  }
+
+  // Called by |shared_socket_| when its read loop fails.
+  void OnReadError(int error) {
+    if (!read_callback_.is_null())
+      RunReadCallback(error);
+  }
+
+  // Socket:
+  int Read(IOBuffer* buf,
+           int buf_len,
+           const CompletionCallback& callback) override {
+    DCHECK(read_callback_.is_null());
+    if (!received_.empty()) {
+      const std::string& datagram = received_.front();
+      int bytes_read = std::min(static_cast<int>(datagram.size()), buf_len);
+      memcpy(buf->data(), datagram.data(), bytes_read);
+      received_.pop_front();
+      return bytes_read;
+    }
+    if (shared_socket_->read_result() != OK)
+      return shared_socket_->read_result();
+
+    read_buffer_ = buf;
+    read_buffer_len_ = buf_len;
+    read_callback_ = callback;
+    shared_socket_->StartReading();
+    return ERR_IO_PENDING;
+  }
+
+  int Write(IOBuffer* buf,
+            int buf_len,
+            const CompletionCallback& callback) override {
+    if (buf_len < static_cast<int>(sizeof(query_id_)))
+      return ERR_INVALID_ARGUMENT;
+    uint16_t query_id;
+    base::ReadBigEndian(buf->data(), &query_id);
+    if (registered_ && query_id != query_id_)
+      shared_socket_->RemoveQuery(query_id_, this);
+    if (!registered_ || query_id != query_id_)
+      shared_socket_->AddQuery(query_id, this);
+    registered_ = true;
+    query_id_ = query_id;
+    return shared_socket_->Write(this, buf, buf_len, callback);
+  }
+
+  int SetReceiveBufferSize(int32_t size) override {
+    return shared_socket_->socket()->SetReceiveBufferSize(size);
+  }
+
+  int SetSendBufferSize(int32_t size) override {
+    return shared_socket_->socket()->SetSendBufferSize(size);
+  }
+
+  // DatagramSocket:
+  void Close() override {
+    if (registered_)
+      shared_socket_->RemoveQuery(query_id_, this);
+    registered_ = false;
+    shared_socket_->CancelWrites(this);
+    received_.clear();
+    read_buffer_ = nullptr;
+    read_callback_.Reset();
+  }
+
+  int GetPeerAddress(IPEndPoint* address) const override {
+    return shared_socket_->socket()->GetPeerAddress(address);
+  }
+
+  int GetLocalAddress(IPEndPoint* address) const override {
+    return shared_socket_->socket()->GetLocalAddress(address);
+  }
+
+  const BoundNetLog& NetLog() const override {
+    return shared_socket_->socket()->NetLog();
+  }
+
+  // DatagramClientSocket:
+  // The pool hands out sockets that are already connected.
+  int Connect(const IPEndPoint& address) override {
+    NOTREACHED();
+    return ERR_NOT_IMPLEMENTED;
+  }
+
+  int ConnectUsingNetwork(NetworkChangeNotifier::NetworkHandle network,
+                          const IPEndPoint& address) override {
+    NOTREACHED();
+    return ERR_NOT_IMPLEMENTED;
+  }
+
+  int ConnectUsingDefaultNetwork(const IPEndPoint& address) override {
+    NOTREACHED();
+    return ERR_NOT_IMPLEMENTED;
+  }
+
+  NetworkChangeNotifier::NetworkHandle GetBoundNetwork() const override {
+    return shared_socket_->socket()->GetBoundNetwork();
+  }
+
+  void EnableBatchedIO() override {}
+
+  bool SupportsBatchedIO() const override { return false; }
+
+  int ReadMultiple(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                   std::vector<int>* read_sizes) override {
+    return ERR_NOT_IMPLEMENTED;
+  }
+
+  int WriteMultiple(
+      const std::vector<scoped_refptr<StringIOBuffer>>& buffers) override {
+    return ERR_NOT_IMPLEMENTED;
+  }
+
+ private:
+  void RunReadCallback(int rv) {
+    CompletionCallback callback = read_callback_;
+    read_callback_.Reset();
+    read_buffer_ = nullptr;
+    callback.Run(rv);
+  }
+
+  scoped_refptr<SharedDnsSocket> shared_socket_;
+  bool registered_;
+  uint16_t query_id_;
+
+  // Datagrams that arrived while no Read was pending.
+  std::deque<std::string> received_;
+
+  scoped_refptr<IOBuffer> read_buffer_;
+  int read_buffer_len_;
+  CompletionCallback read_callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiplexedDnsSocket);
+};
+
+SharedDnsSocket::PendingWrite::PendingWrite(
+    MultiplexedDnsSocket* query,
+    IOBuffer* buf,
+    int buf_len,
+    const CompletionCallback& callback)
+    : query(query), buf(buf), buf_len(buf_len), callback(callback) {}
+
+SharedDnsSocket::PendingWrite::PendingWrite(const PendingWrite& other) =
+    default;
+
+SharedDnsSocket::PendingWrite::~PendingWrite() {}
+
+SharedDnsSocket::SharedDnsSocket(std::unique_ptr<DatagramClientSocket> socket)
+    : socket_(std::move(socket)),
+      writing_(false),
+      read_buffer_(new IOBufferWithSize(dns_protocol::kMaxUDPSize + 1)),
+      reading_(false),
+      read_result_(OK) {}
+
+SharedDnsSocket::~SharedDnsSocket() {
+  DCHECK(queries_.empty());
+}
+
+void SharedDnsSocket::AddQuery(uint16_t id, MultiplexedDnsSocket* query) {
+  queries_.insert(std::make_pair(id, query));
+}
+
+void SharedDnsSocket::RemoveQuery(uint16_t id, MultiplexedDnsSocket* query) {
+  std::pair<QueryMap::iterator, QueryMap::iterator> range =
+      queries_.equal_range(id);
+  for (QueryMap::iterator it = range.first; it != range.second; ++it) {
+    if (it->second == query) {
+      queries_.erase(it);
+      return;
+    }
+  }
+  NOTREACHED();
+}
+
+int SharedDnsSocket::Write(MultiplexedDnsSocket* query,
+                           IOBuffer* buf,
+                           int buf_len,
+                           const CompletionCallback& callback) {
+  if (!pending_writes_.empty()) {
+    pending_writes_.push_back(PendingWrite(query, buf, buf_len, callback));
+    return ERR_IO_PENDING;
+  }
+  int rv = socket_->Write(
+      buf, buf_len,
+      base::Bind(&SharedDnsSocket::OnWriteComplete, base::Unretained(this)));
+  if (rv == ERR_IO_PENDING) {
+    writing_ = true;
+    pending_writes_.push_back(PendingWrite(query, buf, buf_len, callback));
+  }
+  return rv;
+}
+
+void SharedDnsSocket::CancelWrites(MultiplexedDnsSocket* query) {
+  std::deque<PendingWrite>::iterator it = pending_writes_.begin();
+  // A write in progress has to finish, but nobody waits for it any more.
+  if (writing_ && it != pending_writes_.end()) {
+    if (it->query == query) {
+      it->query = nullptr;
+      it->callback.Reset();
+    }
+    ++it;
+  }
+  while (it != pending_writes_.end()) {
+    if (it->query == query)
+      it = pending_writes_.erase(it);
+    else
+      ++it;
+  }
+}
+
+void SharedDnsSocket::StartReading() {
+  if (reading_)
+    return;
+  reading_ = true;
+  // Read asynchronously, so that a response that is already there doesn't
+  // complete another query in the middle of this query's Read.
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::Bind(&SharedDnsSocket::DoReads, this));
+}
+
+void SharedDnsSocket::DoWrites() {
+  scoped_refptr<SharedDnsSocket> protect(this);
+  while (!writing_ && !pending_writes_.empty()) {
+    const PendingWrite& write = pending_writes_.front();
+    int rv = socket_->Write(
+        write.buf.get(), write.buf_len,
+        base::Bind(&SharedDnsSocket::OnWriteComplete, base::Unretained(this)));
+    if (rv == ERR_IO_PENDING) {
+      writing_ = true;
+      return;
+    }
+    CompleteWrite(rv);
+  }
+}
+
+void SharedDnsSocket::OnWriteComplete(int rv) {
+  scoped_refptr<SharedDnsSocket> protect(this);
+  DCHECK(writing_);
+  writing_ = false;
+  CompleteWrite(rv);
+  DoWrites();
+}
+
+void SharedDnsSocket::CompleteWrite(int rv) {
+  CompletionCallback callback = pending_writes_.front().callback;
+  pending_writes_.pop_front();
+  if (!callback.is_null())
+    callback.Run(rv);
+}
+
+void SharedDnsSocket::DoReads() {
+  while (read_result_ == OK) {
+    int rv = socket_->Read(
+        read_buffer_.get(), read_buffer_->size(),
+        base::Bind(&SharedDnsSocket::OnReadComplete, base::Unretained(this)));
+    if (rv == ERR_IO_PENDING)
+      return;
+    HandleRead(rv);
+  }
+}
+
+void SharedDnsSocket::OnReadComplete(int rv) {
+  scoped_refptr<SharedDnsSocket> protect(this);
+  HandleRead(rv);
+  DoReads();
+}
+
+void SharedDnsSocket::HandleRead(int rv) {
+  DCHECK_NE(ERR_IO_PENDING, rv);
+  // A failed read is for every query. A datagram is for the queries with its
+  // ID, and dropped if it is too short to have one.
+  std::vector<std::pair<uint16_t, MultiplexedDnsSocket*>> queries;
+  if (rv < 0) {
+    read_result_ = rv;
+    queries.assign(queries_.begin(), queries_.end());
+  } else if (rv >= static_cast<int>(sizeof(uint16_t))) {
+    uint16_t id;
+    base::ReadBigEndian(read_buffer_->data(), &id);
+    std::pair<QueryMap::const_iterator, QueryMap::const_iterator> range =
+        queries_.equal_range(id);
+    queries.assign(range.first, range.second);
+  }
+
+  // Queries may complete, and close their sockets, while others get the
+  // result, so each one is looked up again before it gets it.
+  for (const auto& id_and_query : queries) {
+    if (!HasQuery(id_and_query.first, id_and_query.second))
+      continue;
+    if (rv < 0)
+      id_and_query.second->OnReadError(rv);
+    else
+      id_and_query.second->OnDatagram(read_buffer_->data(), rv);
+  }
+}
+
+bool SharedDnsSocket::HasQuery(uint16_t id,
+                               MultiplexedDnsSocket* query) const {
+  std::pair<QueryMap::const_iterator, QueryMap::const_iterator> range =
+      queries_.equal_range(id);
+  for (QueryMap::const_iterator it = range.first; it != range.second; ++it) {
+    if (it->second == query)
+      return true;
+  }
+  return false;
+}
+
+// Each server gets a few long-lived sockets, connected on first use, that its
+// queries share. A query gets one of them at random, and its response is
+// matched to it by the query ID, like in other resolvers that send all
+// queries from one port. A socket whose reads fail is replaced.
+class ReusingDnsSocketPool : public DnsSocketPool {
+ public:
+  ReusingDnsSocketPool(ClientSocketFactory* factory,
+                       const RandIntCallback& rand_int_callback)
+      : DnsSocketPool(factory, rand_int_callback) {}
+
+  ~ReusingDnsSocketPool() override {}
+
+  void Initialize(const std::vector<IPEndPoint>* nameservers,
+                  NetLog* net_log) override {
+    InitializeInternal(nameservers, net_log);
+
+    DCHECK(shared_sockets_.empty());
+    shared_sockets_.resize(nameservers->size(),
+                           SocketVector(kSharedSocketsPerServer));
+  }
+
+  std::unique_ptr<DatagramClientSocket> AllocateSocket(
+      unsigned server_index) override {
+    DCHECK_LT(server_index, shared_sockets_.size());
+    unsigned socket_index = GetRandomInt(0, kSharedSocketsPerServer - 1);
+    scoped_refptr<SharedDnsSocket>& shared_socket =
+        shared_sockets_[server_index][socket_index];
+    if (!shared_socket || shared_socket->read_result() != OK) {
+      std::unique_ptr<DatagramClientSocket> socket =
+          CreateConnectedSocket(server_index);
+      if (!socket)
+        return std::unique_ptr<DatagramClientSocket>();
+      shared_socket = new SharedDnsSocket(std::move(socket));
+    }
+    return std::unique_ptr<DatagramClientSocket>(
+        new MultiplexedDnsSocket(shared_socket));
+  }
+
+  void FreeSocket(unsigned server_index,
+                  std::unique_ptr<DatagramClientSocket> socket) override {
+    DCHECK_LT(server_index, shared_sockets_.size());
+  }
+
+ private:
+  typedef std::vector<scoped_refptr<SharedDnsSocket>> SocketVector;
+
+  // Shared sockets, by server index.
+  std::vector<SocketVector> shared_sockets_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReusingDnsSocketPool);
+};
+
+// static
+std::unique_ptr<DnsSocketPool> DnsSocketPool::CreateReusing(
+    ClientSocketFactory* factory,
+    const RandIntCallback& rand_int_callback) {
+  return std::unique_ptr<DnsSocketPool>(
+      new ReusingDnsSocketPool(factory, rand_int_callback));
+}
+
 } // namespace net
@@ -42,6 +42,17 @@ class NET_EXPORT_PRIVATE DnsSocketPool {
       ClientSocketFactory* factory,
       const RandIntCallback& rand_int_callback);
 
+  // Creates a DnsSocketPool that connects a few sockets per server and sends
+  // all queries to the server over them, matching responses to queries by
+  // query ID.  This saves the socket setup for clients that send many
+  // queries.  Queries no longer get a random source port of their own, so an
+  // off-path attacker only has to guess the query ID, and which of the few
+  // long-lived ports was used, to spoof a response.  Only use it where that
+  // loss of source port randomization is acceptable.
+  static std::unique_ptr<DnsSocketPool> CreateReusing(
+      ClientSocketFactory* factory,
+      const RandIntCallback& rand_int_callback);
+
   // Initializes the DnsSocketPool.  |nameservers| is the list of nameservers
   // for which the DnsSocketPool will manage sockets; |net_log| is the NetLog
   // used when constructing sockets with the factory.
@@ -85,7 +96,7 @@ class NET_EXPORT_PRIVATE DnsSocketPool {
 
  private:
   ClientSocketFactory* socket_factory_;
-  const RandIntCallback& rand_int_callback_;
+  const RandIntCallback rand_int_callback_;
   NetLog* net_log_;
   const std::vector<IPEndPoint>* nameservers_;
   bool initialized_;
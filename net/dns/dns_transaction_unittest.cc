@@ -36,6 +36,12 @@ namespace net {
 
 namespace {
 
+// A RandIntCallback that makes the reusing socket pool always pick the first
+// socket to a server.
+int FirstInRange(int min, int max) {
+  return min;
+}
+
 std::string DomainFromDot(const base::StringPiece& dotted) {
   std::string out;
   EXPECT_TRUE(DNSDomainFromDot(dotted, &out));
@@ -357,6 +363,18 @@ class DnsTransactionTest : public testing::Test {
     transaction_factory_ = DnsTransactionFactory::CreateFactory(session_.get());
   }
 
+  // Like ConfigureFactory, but queries to a server share its first socket from
+  // DnsSocketPool::CreateReusing.
+  void ConfigureReusingFactory() {
+    socket_factory_.reset(new TestSocketFactory());
+    session_ = new DnsSession(
+        config_, DnsSocketPool::CreateReusing(socket_factory_.get(),
+                                              base::Bind(&FirstInRange)),
+        base::Bind(&DnsTransactionTest::GetNextId, base::Unretained(this)),
+        NULL /* NetLog */);
+    transaction_factory_ = DnsTransactionFactory::CreateFactory(session_.get());
+  }
+
   void AddSocketData(std::unique_ptr<DnsSocketData> data) {
     CHECK(socket_factory_.get());
     transaction_ids_.push_back(data->query_id());
@@ -551,6 +569,79 @@ TEST_F(DnsTransactionTest, CancelFromCallback) {
   EXPECT_TRUE(helper0.Run(transaction_factory_.get()));
 }
 
+// Queries that share a socket each get the response with their ID, whatever
+// the order the responses arrive in.
+TEST_F(DnsTransactionTest, SharedSocketMatchesResponsesById) {
+  ConfigureReusingFactory();
+  DnsQuery query0(0, DomainFromDot(kT0HostName), kT0Qtype);
+  DnsQuery query1(1, DomainFromDot(kT1HostName), kT1Qtype);
+  MockWrite writes[] = {
+      MockWrite(ASYNC, query0.io_buffer()->data(), query0.io_buffer()->size(),
+                0),
+      MockWrite(ASYNC, query1.io_buffer()->data(), query1.io_buffer()->size(),
+                1),
+  };
+  MockRead reads[] = {
+      MockRead(ASYNC, reinterpret_cast<const char*>(kT1ResponseDatagram),
+               arraysize(kT1ResponseDatagram), 2),
+      MockRead(ASYNC, reinterpret_cast<const char*>(kT0ResponseDatagram),
+               arraysize(kT0ResponseDatagram), 3),
+      MockRead(SYNCHRONOUS, ERR_IO_PENDING, 4),
+  };
+  SequencedSocketData data(reads, arraysize(reads), writes, arraysize(writes));
+  socket_factory_->AddSocketDataProvider(&data);
+  transaction_ids_.push_back(0);
+  transaction_ids_.push_back(1);
+
+  TransactionHelper helper0(kT0HostName, kT0Qtype, kT0RecordCount);
+  helper0.StartTransaction(transaction_factory_.get());
+  TransactionHelper helper1(kT1HostName, kT1Qtype, kT1RecordCount);
+  helper1.StartTransaction(transaction_factory_.get());
+
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_TRUE(helper0.has_completed());
+  EXPECT_TRUE(helper1.has_completed());
+  EXPECT_TRUE(data.AllWriteDataConsumed());
+}
+
+// The response to a cancelled query is dropped, and the other queries on the
+// socket still get theirs.
+TEST_F(DnsTransactionTest, SharedSocketDropsResponseOfCancelledQuery) {
+  ConfigureReusingFactory();
+  DnsQuery query0(0, DomainFromDot(kT0HostName), kT0Qtype);
+  DnsQuery query1(1, DomainFromDot(kT1HostName), kT1Qtype);
+  MockWrite writes[] = {
+      MockWrite(ASYNC, query0.io_buffer()->data(), query0.io_buffer()->size(),
+                0),
+      MockWrite(ASYNC, query1.io_buffer()->data(), query1.io_buffer()->size(),
+                1),
+  };
+  MockRead reads[] = {
+      MockRead(ASYNC, reinterpret_cast<const char*>(kT0ResponseDatagram),
+               arraysize(kT0ResponseDatagram), 2),
+      MockRead(ASYNC, reinterpret_cast<const char*>(kT1ResponseDatagram),
+               arraysize(kT1ResponseDatagram), 3),
+      MockRead(SYNCHRONOUS, ERR_IO_PENDING, 4),
+  };
+  SequencedSocketData data(reads, arraysize(reads), writes, arraysize(writes));
+  socket_factory_->AddSocketDataProvider(&data);
+  transaction_ids_.push_back(0);
+  transaction_ids_.push_back(1);
+
+  TransactionHelper helper0(kT0HostName, kT0Qtype, kT0RecordCount);
+  helper0.StartTransaction(transaction_factory_.get());
+  TransactionHelper helper1(kT1HostName, kT1Qtype, kT1RecordCount);
+  helper1.StartTransaction(transaction_factory_.get());
+  helper0.Cancel();
+
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_FALSE(helper0.has_completed());
+  EXPECT_TRUE(helper1.has_completed());
+  EXPECT_TRUE(data.AllWriteDataConsumed());
+}
+
 TEST_F(DnsTransactionTest, MismatchedResponseSync) {
   config_.attempts = 2;
   config_.timeout = TestTimeouts::tiny_timeout();
@@ -81,6 +81,7 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
 
    private:
     friend class HostCache;
+    friend class ShardedHostCache;
 
     Entry(const Entry& entry,
           base::TimeTicks now,
@@ -0,0 +1,321 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/dns/sharded_host_cache.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "base/format_macros.h"
+#include "base/hash.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/memory_dump_manager.h"
+#include "base/trace_event/memory_dump_provider.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "net/base/net_errors.h"
+
+namespace net {
+
+namespace {
+
+const size_t kDefaultMaxEntries = 1000;
+const size_t kDefaultShardCount = 16;
+const int kDefaultMaxNameNotResolvedTtlSeconds = 60;
+const int kDefaultMaxFailureTtlSeconds = 5;
+
+struct KeyHash {
+  size_t operator()(const HostCache::Key& key) const {
+    return base::HashInts64(
+        std::hash<std::string>()(key.hostname),
+        (static_cast<uint64_t>(key.address_family) << 32) |
+            static_cast<uint32_t>(key.host_resolver_flags));
+  }
+};
+
+struct KeyEqual {
+  bool operator()(const HostCache::Key& a, const HostCache::Key& b) const {
+    return a.address_family == b.address_family &&
+           a.host_resolver_flags == b.host_resolver_flags &&
+           a.hostname == b.hostname;
+  }
+};
+
+}  // namespace
+
+struct ShardedHostCache::Shard {
+  struct Record {
+    explicit Record(const Entry& entry) : entry(entry), referenced(false) {}
+
+    Entry entry;
+    // Set by lookup hits, cleared as the clock hand passes.
+    bool referenced;
+  };
+
+  using EntryMap = std::unordered_map<Key, Record, KeyHash, KeyEqual>;
+
+  explicit Shard(size_t capacity)
+      : capacity(capacity), hand(0), hits(0), misses(0), evictions(0) {}
+
+  // Advances the clock hand to the first entry not referenced since the hand
+  // last passed it, evicts that entry, and returns its slot in |clock|. Goes
+  // around at most twice.
+  size_t EvictOne() {
+    DCHECK(!clock.empty());
+    while (true) {
+      if (hand >= clock.size())
+        hand = 0;
+      Record& record = clock[hand]->second;
+      if (record.referenced) {
+        record.referenced = false;
+        ++hand;
+        continue;
+      }
+      size_t slot = hand++;
+      entries.erase(entries.find(clock[slot]->first));
+      clock[slot] = nullptr;
+      ++evictions;
+      return slot;
+    }
+  }
+
+  mutable base::Lock lock;
+  const size_t capacity;
+  EntryMap entries;
+  // The ring the clock hand sweeps, with one element per entry. Points into
+  // |entries|, whose elements do not move when it rehashes.
+  std::vector<EntryMap::value_type*> clock;
+  size_t hand;
+
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+};
+
+// Reports the cache's counters on memory dumps. Lives until the
+// MemoryDumpManager deletes it, which may be after the cache is gone.
+class ShardedHostCache::DumpProvider
+    : public base::trace_event::MemoryDumpProvider {
+ public:
+  explicit DumpProvider(const ShardedHostCache* cache) : cache_(cache) {}
+  ~DumpProvider() override {}
+
+  void ResetCache() {
+    base::AutoLock lock(lock_);
+    cache_ = nullptr;
+  }
+
+  // base::trace_event::MemoryDumpProvider implementation.
+  bool OnMemoryDump(const base::trace_event::MemoryDumpArgs& args,
+                    base::trace_event::ProcessMemoryDump* pmd) override {
+    base::AutoLock lock(lock_);
+    if (!cache_)
+      return false;
+    cache_->DumpMemoryStats(
+        pmd, base::StringPrintf("net/sharded_host_cache_0x%" PRIXPTR,
+                                reinterpret_cast<uintptr_t>(cache_)));
+    return true;
+  }
+
+ private:
+  // Held while dumping so the cache is not destroyed under the dump.
+  base::Lock lock_;
+  const ShardedHostCache* cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(DumpProvider);
+};
+
+ShardedHostCache::Options::Options()
+    : max_entries(kDefaultMaxEntries),
+      shard_count(kDefaultShardCount),
+      max_name_not_resolved_ttl(
+          base::TimeDelta::FromSeconds(kDefaultMaxNameNotResolvedTtlSeconds)),
+      max_failure_ttl(
+          base::TimeDelta::FromSeconds(kDefaultMaxFailureTtlSeconds)) {}
+
+ShardedHostCache::Stats::Stats()
+    : entries(0), hits(0), misses(0), evictions(0) {}
+
+ShardedHostCache::ShardedHostCache(const Options& options)
+    : max_entries_(options.max_entries),
+      max_name_not_resolved_ttl_(options.max_name_not_resolved_ttl),
+      max_failure_ttl_(options.max_failure_ttl),
+      network_changes_(0),
+      dump_provider_(new DumpProvider(this)) {
+  // Don't make shards that could never hold anything.
+  size_t shard_count =
+      std::max<size_t>(1, std::min(options.shard_count, max_entries_));
+  for (size_t i = 0; i < shard_count; ++i) {
+    size_t capacity =
+        max_entries_ / shard_count + (i < max_entries_ % shard_count ? 1 : 0);
+    shards_.push_back(base::MakeUnique<Shard>(capacity));
+  }
+
+  base::trace_event::MemoryDumpManager::GetInstance()->RegisterDumpProvider(
+      dump_provider_.get(), "ShardedHostCache", nullptr);
+}
+
+ShardedHostCache::~ShardedHostCache() {
+  dump_provider_->ResetCache();
+  base::trace_event::MemoryDumpManager::GetInstance()
+      ->UnregisterAndDeleteDumpProviderSoon(std::move(dump_provider_));
+}
+
+bool ShardedHostCache::Lookup(const Key& key,
+                              base::TimeTicks now,
+                              Entry* out_entry) {
+  return LookupInternal(key, now, /* allow_stale= */ false, out_entry,
+                        nullptr);
+}
+
+bool ShardedHostCache::LookupStale(const Key& key,
+                                   base::TimeTicks now,
+                                   Entry* out_entry,
+                                   EntryStaleness* stale_out) {
+  return LookupInternal(key, now, /* allow_stale= */ true, out_entry,
+                        stale_out);
+}
+
+void ShardedHostCache::Set(const Key& key,
+                           const Entry& entry,
+                           base::TimeTicks now,
+                           base::TimeDelta ttl) {
+  Shard* shard = ShardForKey(key);
+  if (shard->capacity == 0)
+    return;
+
+  Entry new_entry(entry, now, TtlForEntry(entry, ttl), network_changes());
+
+  base::AutoLock lock(shard->lock);
+  auto it = shard->entries.find(key);
+  if (it != shard->entries.end()) {
+    it->second.entry = new_entry;
+    return;
+  }
+
+  size_t slot;
+  if (shard->entries.size() < shard->capacity) {
+    slot = shard->clock.size();
+    shard->clock.push_back(nullptr);
+  } else {
+    slot = shard->EvictOne();
+  }
+  auto result =
+      shard->entries.insert(std::make_pair(key, Shard::Record(new_entry)));
+  DCHECK(result.second);
+  shard->clock[slot] = &*result.first;
+  DCHECK_EQ(shard->entries.size(), shard->clock.size());
+}
+
+void ShardedHostCache::OnNetworkChange() {
+  base::subtle::NoBarrier_AtomicIncrement(&network_changes_, 1);
+}
+
+void ShardedHostCache::clear() {
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    shard->clock.clear();
+    shard->entries.clear();
+    shard->hand = 0;
+  }
+}
+
+size_t ShardedHostCache::size() const {
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    size += shard->entries.size();
+  }
+  return size;
+}
+
+ShardedHostCache::Stats ShardedHostCache::GetStats() const {
+  Stats stats;
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    stats.entries += shard->entries.size();
+    stats.hits += shard->hits;
+    stats.misses += shard->misses;
+    stats.evictions += shard->evictions;
+  }
+  return stats;
+}
+
+void ShardedHostCache::DumpMemoryStats(
+    base::trace_event::ProcessMemoryDump* pmd,
+    const std::string& dump_name) const {
+  using base::trace_event::MemoryAllocatorDump;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    const Shard& shard = *shards_[i];
+    base::AutoLock lock(shard.lock);
+    MemoryAllocatorDump* dump = pmd->CreateAllocatorDump(
+        base::StringPrintf("%s/shard_%" PRIuS, dump_name.c_str(), i));
+    dump->AddScalar(MemoryAllocatorDump::kNameObjectCount,
+                    MemoryAllocatorDump::kUnitsObjects, shard.entries.size());
+    dump->AddScalar("hits", MemoryAllocatorDump::kUnitsObjects, shard.hits);
+    dump->AddScalar("misses", MemoryAllocatorDump::kUnitsObjects, shard.misses);
+    dump->AddScalar("evictions", MemoryAllocatorDump::kUnitsObjects,
+                    shard.evictions);
+  }
+}
+
+ShardedHostCache::Shard* ShardedHostCache::ShardForKey(const Key& key) const {
+  // Use a different hash than the shards' maps, so that the keys of one shard
+  // still spread over all of its buckets.
+  return shards_[base::Hash(key.hostname) % shards_.size()].get();
+}
+
+bool ShardedHostCache::LookupInternal(const Key& key,
+                                      base::TimeTicks now,
+                                      bool allow_stale,
+                                      Entry* out_entry,
+                                      EntryStaleness* stale_out) {
+  DCHECK(out_entry);
+  Shard* shard = ShardForKey(key);
+  int network_changes = this->network_changes();
+
+  base::AutoLock lock(shard->lock);
+  auto it = shard->entries.find(key);
+  if (it == shard->entries.end()) {
+    ++shard->misses;
+    return false;
+  }
+
+  Shard::Record& record = it->second;
+  bool is_stale = record.entry.IsStale(now, network_changes);
+  if (is_stale && !allow_stale) {
+    ++shard->misses;
+    return false;
+  }
+
+  ++shard->hits;
+  record.referenced = true;
+  record.entry.CountHit(is_stale);
+  if (stale_out)
+    record.entry.GetStaleness(now, network_changes, stale_out);
+  *out_entry = record.entry;
+  return true;
+}
+
+base::TimeDelta ShardedHostCache::TtlForEntry(const Entry& entry,
+                                              base::TimeDelta ttl) const {
+  if (entry.error() == OK)
+    return ttl;
+  if (entry.error() == ERR_NAME_NOT_RESOLVED)
+    return std::min(ttl, max_name_not_resolved_ttl_);
+  return std::min(ttl, max_failure_ttl_);
+}
+
+int ShardedHostCache::network_changes() const {
+  return base::subtle::NoBarrier_Load(&network_changes_);
+}
+
+}  // namespace net
@@ -0,0 +1,151 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DNS_SHARDED_HOST_CACHE_H_
+#define NET_DNS_SHARDED_HOST_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+#include "net/dns/host_cache.h"
+
+namespace base {
+namespace trace_event {
+class ProcessMemoryDump;
+}
+}
+
+namespace net {
+
+// A HostCache variant for embedders that resolve very large numbers of
+// distinct hostnames and look them up from several threads.
+//
+// Entries are spread over independently locked shards by a hash of their key,
+// so concurrent lookups only contend when they land on the same shard. Each
+// shard evicts with the CLOCK algorithm: a lookup hit sets the entry's
+// reference bit, and the clock hand clears bits until it finds an entry
+// without one. Eviction therefore never scans the whole cache, and entries
+// that were never looked up again are the first to go.
+//
+// Failed resolutions are kept for at most a per-error tier TTL, whatever TTL
+// they are Set() with. Per-shard entry, hit, miss and eviction counts are
+// reported to the MemoryDumpManager.
+//
+// Unlike HostCache, lookups copy the entry out, since another thread may
+// replace or evict it as soon as the shard lock is released. All methods are
+// thread-safe.
+class NET_EXPORT ShardedHostCache {
+ public:
+  using Key = HostCache::Key;
+  using Entry = HostCache::Entry;
+  using EntryStaleness = HostCache::EntryStaleness;
+
+  struct NET_EXPORT Options {
+    Options();
+
+    // Total number of entries, split evenly between the shards. Zero disables
+    // caching.
+    size_t max_entries;
+    size_t shard_count;
+
+    // The longest a failed resolution is cached. ERR_NAME_NOT_RESOLVED is an
+    // answer about the name and is kept longer than other failures, which
+    // are usually about the network at the time.
+    base::TimeDelta max_name_not_resolved_ttl;
+    base::TimeDelta max_failure_ttl;
+  };
+
+  struct NET_EXPORT Stats {
+    Stats();
+
+    size_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+  };
+
+  explicit ShardedHostCache(const Options& options);
+  ~ShardedHostCache();
+
+  // Copies the entry for |key| into |out_entry| and returns true if there is
+  // one that is valid at time |now|. Returns false otherwise.
+  bool Lookup(const Key& key, base::TimeTicks now, Entry* out_entry);
+
+  // Copies the entry for |key| into |out_entry|, whether it is valid or stale
+  // at time |now|, and fills in |stale_out| with how stale it is. Returns
+  // false if there is no entry for |key| at all.
+  bool LookupStale(const Key& key,
+                   base::TimeTicks now,
+                   Entry* out_entry,
+                   EntryStaleness* stale_out);
+
+  // Overwrites or creates an entry for |key|, evicting another entry from the
+  // same shard if it is full.
+  void Set(const Key& key,
+           const Entry& entry,
+           base::TimeTicks now,
+           base::TimeDelta ttl);
+
+  // Marks all entries as stale on account of a network change.
+  void OnNetworkChange();
+
+  // Empties the cache. Counters are kept.
+  void clear();
+
+  size_t size() const;
+  size_t max_entries() const { return max_entries_; }
+  size_t shard_count() const { return shards_.size(); }
+
+  // Returns the counters summed over all shards.
+  Stats GetStats() const;
+
+  // Adds one allocator dump per shard to |pmd|, under |dump_name|.
+  void DumpMemoryStats(base::trace_event::ProcessMemoryDump* pmd,
+                       const std::string& dump_name) const;
+
+ private:
+  struct Shard;
+  class DumpProvider;
+
+  Shard* ShardForKey(const Key& key) const;
+
+  // Looks up |key| and copies it out, counting a hit or a miss. Stale entries
+  // are misses unless |allow_stale| is set.
+  bool LookupInternal(const Key& key,
+                      base::TimeTicks now,
+                      bool allow_stale,
+                      Entry* out_entry,
+                      EntryStaleness* stale_out);
+
+  // Returns |ttl|, capped by the tier of |entry| if it is a failure.
+  base::TimeDelta TtlForEntry(const Entry& entry, base::TimeDelta ttl) const;
+
+  int network_changes() const;
+
+  const size_t max_entries_;
+  const base::TimeDelta max_name_not_resolved_ttl_;
+  const base::TimeDelta max_failure_ttl_;
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  base::subtle::Atomic32 network_changes_;
+
+  // Owned by this cache until the destructor, which hands it to the
+  // MemoryDumpManager for deletion.
+  std::unique_ptr<DumpProvider> dump_provider_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedHostCache);
+};
+
+}  // namespace net
+
+#endif  // NET_DNS_SHARDED_HOST_CACHE_H_
@@ -0,0 +1,254 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/dns/sharded_host_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/simple_thread.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+ShardedHostCache::Key Key(const std::string& hostname) {
+  return ShardedHostCache::Key(hostname, ADDRESS_FAMILY_UNSPECIFIED, 0);
+}
+
+ShardedHostCache::Options SingleShardOptions(size_t max_entries) {
+  ShardedHostCache::Options options;
+  options.max_entries = max_entries;
+  options.shard_count = 1;
+  return options;
+}
+
+// Sets and looks up its own range of hostnames on a shared cache.
+class CacheUser : public base::DelegateSimpleThread::Delegate {
+ public:
+  CacheUser(ShardedHostCache* cache, int id) : cache_(cache), id_(id) {}
+
+  void Run() override {
+    base::TimeTicks now;
+    ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+    for (int i = 0; i < 1000; ++i) {
+      ShardedHostCache::Key key = Key(base::StringPrintf("%d.%d.com", id_, i));
+      cache_->Set(key, ShardedHostCache::Entry(OK, AddressList()), now, kTTL);
+      EXPECT_TRUE(cache_->Lookup(key, now, &entry));
+      EXPECT_EQ(OK, entry.error());
+    }
+  }
+
+ private:
+  ShardedHostCache* const cache_;
+  const int id_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheUser);
+};
+
+}  // namespace
+
+TEST(ShardedHostCacheTest, Basic) {
+  ShardedHostCache cache{ShardedHostCache::Options()};
+  base::TimeTicks now;
+  ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+
+  EXPECT_FALSE(cache.Lookup(Key("foobar.com"), now, &entry));
+  cache.Set(Key("foobar.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  ASSERT_TRUE(cache.Lookup(Key("foobar.com"), now, &entry));
+  EXPECT_EQ(OK, entry.error());
+  EXPECT_EQ(1u, cache.size());
+
+  // Lookups are specific to the address family.
+  EXPECT_FALSE(cache.Lookup(
+      ShardedHostCache::Key("foobar.com", ADDRESS_FAMILY_IPV4, 0), now,
+      &entry));
+
+  // The entry expires after its TTL, but can still be looked up stale.
+  now += kTTL;
+  EXPECT_FALSE(cache.Lookup(Key("foobar.com"), now, &entry));
+  ShardedHostCache::EntryStaleness stale;
+  ASSERT_TRUE(cache.LookupStale(Key("foobar.com"), now, &entry, &stale));
+  EXPECT_TRUE(stale.is_stale());
+  EXPECT_EQ(base::TimeDelta(), stale.expired_by);
+  EXPECT_EQ(1, stale.stale_hits);
+
+  // Overwriting it makes it valid again without adding an entry.
+  cache.Set(Key("foobar.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  EXPECT_TRUE(cache.Lookup(Key("foobar.com"), now, &entry));
+  EXPECT_EQ(1u, cache.size());
+
+  ShardedHostCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.entries);
+  EXPECT_EQ(3u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ(0u, stats.evictions);
+
+  cache.clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Lookup(Key("foobar.com"), now, &entry));
+}
+
+TEST(ShardedHostCacheTest, NetworkChange) {
+  ShardedHostCache cache{ShardedHostCache::Options()};
+  base::TimeTicks now;
+  ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+
+  cache.Set(Key("foobar.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  cache.OnNetworkChange();
+  EXPECT_FALSE(cache.Lookup(Key("foobar.com"), now, &entry));
+
+  ShardedHostCache::EntryStaleness stale;
+  ASSERT_TRUE(cache.LookupStale(Key("foobar.com"), now, &entry, &stale));
+  EXPECT_EQ(1, stale.network_changes);
+}
+
+TEST(ShardedHostCacheTest, NoCache) {
+  ShardedHostCache cache(SingleShardOptions(0));
+  base::TimeTicks now;
+  ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+
+  cache.Set(Key("foobar.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Lookup(Key("foobar.com"), now, &entry));
+}
+
+// Entries that were looked up since the clock hand last passed survive
+// eviction; the others go in insertion order.
+TEST(ShardedHostCacheTest, EvictsUnreferencedEntries) {
+  ShardedHostCache cache(SingleShardOptions(3));
+  base::TimeTicks now;
+  ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+
+  for (const char* hostname : {"a.com", "b.com", "c.com"}) {
+    cache.Set(Key(hostname), ShardedHostCache::Entry(OK, AddressList()), now,
+              kTTL);
+  }
+  EXPECT_TRUE(cache.Lookup(Key("a.com"), now, &entry));
+
+  cache.Set(Key("d.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_TRUE(cache.Lookup(Key("a.com"), now, &entry));
+  EXPECT_FALSE(cache.Lookup(Key("b.com"), now, &entry));
+  EXPECT_TRUE(cache.Lookup(Key("c.com"), now, &entry));
+  EXPECT_TRUE(cache.Lookup(Key("d.com"), now, &entry));
+
+  // Everything is referenced now, so the hand goes around once clearing
+  // reference bits and evicts the entry after the last one it evicted.
+  cache.Set(Key("e.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  EXPECT_FALSE(cache.Lookup(Key("c.com"), now, &entry));
+  EXPECT_TRUE(cache.Lookup(Key("e.com"), now, &entry));
+  EXPECT_EQ(2u, cache.GetStats().evictions);
+}
+
+TEST(ShardedHostCacheTest, FailureTtlTiers) {
+  ShardedHostCache::Options options;
+  options.max_name_not_resolved_ttl = base::TimeDelta::FromSeconds(5);
+  options.max_failure_ttl = base::TimeDelta::FromSeconds(1);
+  ShardedHostCache cache(options);
+  base::TimeTicks now;
+  ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+
+  cache.Set(Key("ok.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  cache.Set(Key("nxdomain.com"),
+            ShardedHostCache::Entry(ERR_NAME_NOT_RESOLVED, AddressList()), now,
+            kTTL);
+  cache.Set(Key("timeout.com"),
+            ShardedHostCache::Entry(ERR_DNS_TIMED_OUT, AddressList()), now,
+            kTTL);
+  // A failure cached with a TTL under its tier's keeps that TTL.
+  cache.Set(Key("short.com"),
+            ShardedHostCache::Entry(ERR_NAME_NOT_RESOLVED, AddressList()), now,
+            base::TimeDelta());
+
+  EXPECT_FALSE(cache.Lookup(Key("short.com"), now, &entry));
+  now += base::TimeDelta::FromSeconds(1);
+  EXPECT_TRUE(cache.Lookup(Key("nxdomain.com"), now, &entry));
+  EXPECT_EQ(ERR_NAME_NOT_RESOLVED, entry.error());
+  EXPECT_FALSE(cache.Lookup(Key("timeout.com"), now, &entry));
+  now += base::TimeDelta::FromSeconds(4);
+  EXPECT_FALSE(cache.Lookup(Key("nxdomain.com"), now, &entry));
+  EXPECT_TRUE(cache.Lookup(Key("ok.com"), now, &entry));
+}
+
+TEST(ShardedHostCacheTest, SpreadsOverShards) {
+  ShardedHostCache::Options options;
+  options.max_entries = 160;
+  options.shard_count = 16;
+  ShardedHostCache cache(options);
+  EXPECT_EQ(16u, cache.shard_count());
+
+  base::TimeTicks now;
+  for (int i = 0; i < 1000; ++i) {
+    cache.Set(Key(base::StringPrintf("host%d.com", i)),
+              ShardedHostCache::Entry(OK, AddressList()), now, kTTL);
+  }
+  EXPECT_EQ(160u, cache.size());
+  EXPECT_EQ(840u, cache.GetStats().evictions);
+
+  // With fewer entries than shards, no shard is left empty.
+  options.max_entries = 3;
+  EXPECT_EQ(3u, ShardedHostCache(options).shard_count());
+}
+
+TEST(ShardedHostCacheTest, ConcurrentUse) {
+  ShardedHostCache::Options options;
+  options.max_entries = 100000;
+  ShardedHostCache cache(options);
+
+  std::vector<std::unique_ptr<CacheUser>> users;
+  std::vector<std::unique_ptr<base::DelegateSimpleThread>> threads;
+  for (int i = 0; i < 4; ++i) {
+    users.push_back(base::MakeUnique<CacheUser>(&cache, i));
+    threads.push_back(base::MakeUnique<base::DelegateSimpleThread>(
+        users.back().get(), "ShardedHostCacheTest"));
+    threads.back()->Start();
+  }
+  for (const auto& thread : threads)
+    thread->Join();
+
+  ShardedHostCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(4000u, stats.entries);
+  EXPECT_EQ(4000u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+}
+
+TEST(ShardedHostCacheTest, DumpMemoryStats) {
+  ShardedHostCache::Options options;
+  options.shard_count = 4;
+  ShardedHostCache cache(options);
+  base::TimeTicks now;
+  ShardedHostCache::Entry entry(ERR_UNEXPECTED, AddressList());
+  cache.Set(Key("foobar.com"), ShardedHostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  EXPECT_TRUE(cache.Lookup(Key("foobar.com"), now, &entry));
+
+  base::trace_event::MemoryDumpArgs args = {
+      base::trace_event::MemoryDumpLevelOfDetail::DETAILED};
+  base::trace_event::ProcessMemoryDump pmd(nullptr, args);
+  cache.DumpMemoryStats(&pmd, "host_cache");
+  EXPECT_EQ(4u, pmd.allocator_dumps().size());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(
+        pmd.GetAllocatorDump(base::StringPrintf("host_cache/shard_%d", i)));
+  }
+}
+
+}  // namespace net
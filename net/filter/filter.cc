@@ -23,8 +23,12 @@
 
 #include "net/filter/filter.h"
 
+#include <vector>
+
 #include "base/files/file_path.h"
+#include "base/lazy_instance.h"
 #include "base/strings/string_util.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/values.h"
 #include "net/base/io_buffer.h"
 #include "net/base/sdch_net_log_params.h"
@@ -54,6 +58,71 @@ const char kTextHtml[]             = "text/html";
 // Buffer size allocated when de-compressing data.
 const int kFilterBufSize = 32 * 1024;
 
+// Maximum number of stream buffers kept for reuse on each thread. Every
+// filter in a chain holds one buffer, so this covers the filters of a couple
+// of concurrently decoded responses.
+const size_t kMaxPooledStreamBuffers = 4;
+
+// Recycles the kFilterBufSize stream buffers of destroyed filters, so that
+// decoding a response doesn't allocate and free a fresh buffer for every
+// filter in its chain. Buffers are only reused on the thread that released
+// them.
+class StreamBufferPool {
+ public:
+  StreamBufferPool() {}
+
+  // Returns a buffer of kFilterBufSize bytes, reusing a released one if
+  // possible.
+  scoped_refptr<IOBuffer> Take() {
+    if (buffers_.empty())
+      return new IOBuffer(kFilterBufSize);
+    scoped_refptr<IOBuffer> buffer = std::move(buffers_.back());
+    buffers_.pop_back();
+    return buffer;
+  }
+
+  // Keeps |buffer| for a later Take() if the pool isn't full. |buffer| must
+  // be kFilterBufSize bytes and not be referenced by anyone else.
+  void Release(scoped_refptr<IOBuffer> buffer) {
+    DCHECK(buffer->HasOneRef());
+    if (buffers_.size() < kMaxPooledStreamBuffers)
+      buffers_.push_back(std::move(buffer));
+  }
+
+ private:
+  std::vector<scoped_refptr<IOBuffer>> buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamBufferPool);
+};
+
+// Owns the StreamBufferPool of each thread, which is destroyed when the
+// thread exits.
+class StreamBufferPoolSlot {
+ public:
+  StreamBufferPoolSlot() : slot_(&DeletePool) {}
+
+  StreamBufferPool* GetForCurrentThread() {
+    StreamBufferPool* pool = static_cast<StreamBufferPool*>(slot_.Get());
+    if (!pool) {
+      pool = new StreamBufferPool();
+      slot_.Set(pool);
+    }
+    return pool;
+  }
+
+ private:
+  static void DeletePool(void* pool) {
+    delete static_cast<StreamBufferPool*>(pool);
+  }
+
+  base::ThreadLocalStorage::Slot slot_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamBufferPoolSlot);
+};
+
+base::LazyInstance<StreamBufferPoolSlot>::Leaky g_stream_buffer_pool_slot =
+    LAZY_INSTANCE_INITIALIZER;
+
 void LogSdchProblem(const FilterContext& filter_context,
                     SdchProblemCode problem) {
   SdchManager::SdchErrorRecovery(problem);
@@ -89,7 +158,15 @@ std::string FilterTypeAsString(Filter::FilterType type_id) {
 FilterContext::~FilterContext() {
 }
 
-Filter::~Filter() {}
+Filter::~Filter() {
+  // Recycle the stream buffer unless the consumer still holds on to it, e.g.
+  // for a read that is in progress.
+  if (stream_buffer_ && stream_buffer_size_ == kFilterBufSize &&
+      stream_buffer_->HasOneRef()) {
+    g_stream_buffer_pool_slot.Get().GetForCurrentThread()->Release(
+        std::move(stream_buffer_));
+  }
+}
 
 // static
 std::unique_ptr<Filter> Filter::Factory(
@@ -436,7 +513,12 @@ std::unique_ptr<Filter> Filter::PrependNewFilter(
 void Filter::InitBuffer(int buffer_size) {
   DCHECK(!stream_buffer());
   DCHECK_GT(buffer_size, 0);
-  stream_buffer_ = new IOBuffer(buffer_size);
+  if (buffer_size == kFilterBufSize) {
+    stream_buffer_ =
+        g_stream_buffer_pool_slot.Get().GetForCurrentThread()->Take();
+  } else {
+    stream_buffer_ = new IOBuffer(buffer_size);
+  }
   stream_buffer_size_ = buffer_size;
 }
 
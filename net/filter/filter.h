@@ -278,7 +278,9 @@ class NET_EXPORT_PRIVATE Filter {
   int stream_data_len_;
 
  private:
-  // Allocates and initializes stream_buffer_ and stream_buffer_size_.
+  // Allocates and initializes stream_buffer_ and stream_buffer_size_. Buffers
+  // of the default size are recycled from filters previously destroyed on the
+  // same thread.
   void InitBuffer(int size);
 
   // A factory helper for creating filters for within a chain of potentially
@@ -210,4 +210,33 @@ TEST(FilterTest, ThreeFilterChain) {
   EXPECT_EQ(compare_array_index, input_array_size);
 }
 
+// The stream buffer of a destroyed filter should be reused by the next filter
+// created on the same thread.
+TEST(FilterTest, StreamBufferIsRecycled) {
+  std::unique_ptr<Filter> filter = Filter::GZipFactory();
+  ASSERT_TRUE(filter);
+  IOBuffer* stream_buffer = filter->stream_buffer();
+  filter.reset();
+
+  filter = Filter::GZipFactory();
+  ASSERT_TRUE(filter);
+  EXPECT_EQ(stream_buffer, filter->stream_buffer());
+}
+
+// A stream buffer that is still referenced, for instance by a pending read,
+// must not be handed to another filter.
+TEST(FilterTest, StreamBufferInUseIsNotRecycled) {
+  std::unique_ptr<Filter> filter = Filter::GZipFactory();
+  ASSERT_TRUE(filter);
+  scoped_refptr<IOBuffer> stream_buffer = filter->stream_buffer();
+  filter.reset();
+
+  for (int i = 0; i < 8; ++i) {
+    std::unique_ptr<Filter> other_filter = Filter::GZipFactory();
+    ASSERT_TRUE(other_filter);
+    EXPECT_NE(stream_buffer.get(), other_filter->stream_buffer());
+  }
+  EXPECT_TRUE(stream_buffer->HasOneRef());
+}
+
 }  // Namespace net
@@ -96,7 +96,8 @@ HttpCache::ActiveEntry::ActiveEntry(disk_cache::Entry* entry)
     : disk_entry(entry),
       writer(NULL),
       will_process_pending_queue(false),
-      doomed(false) {
+      doomed(false),
+      shared_writing(false) {
 }
 
 HttpCache::ActiveEntry::~ActiveEntry() {
@@ -303,6 +304,7 @@ HttpCache::HttpCache(std::unique_ptr<HttpTransactionFactory> network_layer,
     : net_log_(nullptr),
       backend_factory_(std::move(backend_factory)),
       building_backend_(false),
+      shared_writing_enabled_(false),
       bypass_lock_for_test_(false),
       fail_conditionalization_for_test_(false),
       mode_(NORMAL),
@@ -338,6 +340,7 @@ HttpCache::~HttpCache() {
     entry->will_process_pending_queue = false;
     entry->pending_queue.clear();
     entry->readers.clear();
+    entry->waiting_readers.clear();
     entry->writer = NULL;
     DeactivateEntry(entry);
   }
@@ -796,13 +799,18 @@ int HttpCache::AddTransactionToEntry(ActiveEntry* entry, Transaction* trans) {
   //
   // NOTE: If the transaction can only write, then the entry should not be in
   // use (since any existing entry should have already been doomed).
+  //
+  // With shared writing, readers don't have to wait for a writer that is
+  // storing a fresh response: they read the body as it is written.
 
   if (entry->writer || entry->will_process_pending_queue) {
-    entry->pending_queue.push_back(trans);
-    return ERR_IO_PENDING;
-  }
-
-  if (trans->mode() & Transaction::WRITE) {
+    if (!entry->shared_writing || entry->will_process_pending_queue ||
+        !trans->CanReadWhileWriting()) {
+      entry->pending_queue.push_back(trans);
+      return ERR_IO_PENDING;
+    }
+    entry->readers.push_back(trans);
+  } else if (trans->mode() & Transaction::WRITE) {
     // transaction needs exclusive access to the entry
     if (entry->readers.empty()) {
       entry->writer = trans;
@@ -818,8 +826,10 @@ int HttpCache::AddTransactionToEntry(ActiveEntry* entry, Transaction* trans) {
   // We do this before calling EntryAvailable to force any further calls to
   // AddTransactionToEntry to add their transaction to the pending queue, which
   // ensures FIFO ordering.
-  if (!entry->writer && !entry->pending_queue.empty())
+  if ((!entry->writer || entry->shared_writing) &&
+      !entry->pending_queue.empty()) {
     ProcessPendingQueue(entry);
+  }
 
   return OK;
 }
@@ -828,12 +838,12 @@ void HttpCache::DoneWithEntry(ActiveEntry* entry, Transaction* trans,
                               bool cancel) {
   // If we already posted a task to move on to the next transaction and this was
   // the writer, there is nothing to cancel.
-  if (entry->will_process_pending_queue && entry->readers.empty())
+  if (entry->will_process_pending_queue && entry->readers.empty() &&
+      !entry->writer) {
     return;
+  }
 
-  if (entry->writer) {
-    DCHECK(trans == entry->writer);
-
+  if (entry->writer == trans) {
     // Assume there was a failure.
     bool success = false;
     if (cancel) {
@@ -852,21 +862,44 @@ void HttpCache::DoneWithEntry(ActiveEntry* entry, Transaction* trans,
 }
 
 void HttpCache::DoneWritingToEntry(ActiveEntry* entry, bool success) {
-  DCHECK(entry->readers.empty());
+  DCHECK(entry->readers.empty() || entry->shared_writing);
+
+  if (entry->shared_writing) {
+    // The current readers need to know whether the end of the stored data
+    // is the end of the body. If the writer was cancelled, the entry may have
+    // been kept as truncated, and completed later by another writer, so this
+    // doesn't apply to readers that join from now on.
+    int64_t content_length =
+        entry->writer->GetResponseInfo()->headers->GetContentLength();
+    if (!success ||
+        (content_length >= 0 &&
+         entry->disk_entry->GetDataSize(kResponseContentIndex) <
+             content_length)) {
+      entry->incomplete_readers = entry->readers;
+    }
+    entry->shared_writing = false;
+    NotifySharedReaders(entry);
+  }
 
   entry->writer = NULL;
 
   if (success) {
     ProcessPendingQueue(entry);
   } else {
-    DCHECK(!entry->will_process_pending_queue);
-
     // We failed to create this entry.
     TransactionList pending_queue;
     pending_queue.swap(entry->pending_queue);
 
-    entry->disk_entry->Doom();
-    DestroyEntry(entry);
+    if (entry->readers.empty() && !entry->will_process_pending_queue) {
+      entry->disk_entry->Doom();
+      DestroyEntry(entry);
+    } else if (!entry->doomed) {
+      // Readers that joined while the body was being written still use the
+      // entry, so it goes away with the last of them.
+      DoomEntry(entry->disk_entry->GetKey(), NULL);
+    } else {
+      entry->disk_entry->Doom();
+    }
 
     // We need to do something about these pending entries, which now need to
     // be added to a new entry.
@@ -879,13 +912,15 @@ void HttpCache::DoneWritingToEntry(ActiveEntry* entry, bool success) {
 }
 
 void HttpCache::DoneReadingFromEntry(ActiveEntry* entry, Transaction* trans) {
-  DCHECK(!entry->writer);
+  DCHECK(!entry->writer || entry->shared_writing);
 
   TransactionList::iterator it =
       std::find(entry->readers.begin(), entry->readers.end(), trans);
   DCHECK(it != entry->readers.end());
 
   entry->readers.erase(it);
+  entry->waiting_readers.remove(trans);
+  entry->incomplete_readers.remove(trans);
 
   ProcessPendingQueue(entry);
 }
@@ -903,6 +938,35 @@ void HttpCache::ConvertWriterToReader(ActiveEntry* entry) {
   ProcessPendingQueue(entry);
 }
 
+void HttpCache::BeginSharedWriting(ActiveEntry* entry) {
+  DCHECK(entry->writer);
+  if (!shared_writing_enabled_ || entry->shared_writing)
+    return;
+
+  DCHECK(entry->readers.empty());
+  entry->shared_writing = true;
+  if (!entry->pending_queue.empty())
+    ProcessPendingQueue(entry);
+}
+
+void HttpCache::WaitForSharedWriter(ActiveEntry* entry, Transaction* trans) {
+  DCHECK(entry->shared_writing);
+  DCHECK(std::find(entry->readers.begin(), entry->readers.end(), trans) !=
+         entry->readers.end());
+  entry->waiting_readers.push_back(trans);
+}
+
+void HttpCache::NotifySharedReaders(ActiveEntry* entry) {
+  // The readers continue from a posted task, so that they don't run in the
+  // middle of the writer's IO.
+  TransactionList waiting_readers;
+  waiting_readers.swap(entry->waiting_readers);
+  for (Transaction* reader : waiting_readers) {
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::Bind(reader->io_callback(), OK));
+  }
+}
+
 LoadState HttpCache::GetLoadStateForPendingTransaction(
       const Transaction* trans) {
   ActiveEntriesMap::const_iterator i = active_entries_.find(trans->key());
@@ -996,21 +1060,39 @@ void HttpCache::ProcessPendingQueue(ActiveEntry* entry) {
 
 void HttpCache::OnProcessPendingQueue(ActiveEntry* entry) {
   entry->will_process_pending_queue = false;
-  DCHECK(!entry->writer);
+
+  // A shared writer may have stopped sharing the entry since this task was
+  // posted, in which case everyone waits for it to finish.
+  if (entry->writer && !entry->shared_writing)
+    return;
 
   // If no one is interested in this entry, then we can deactivate it.
   if (entry->pending_queue.empty()) {
-    if (entry->readers.empty())
+    if (entry->readers.empty() && !entry->writer)
       DestroyEntry(entry);
     return;
   }
 
+  TransactionList::iterator next_it = entry->pending_queue.begin();
+  if (entry->writer) {
+    // Promote the next transaction that can read the body while it is being
+    // written. The others wait for the writer to finish.
+    while (next_it != entry->pending_queue.end() &&
+           !(*next_it)->CanReadWhileWriting()) {
+      ++next_it;
+    }
+    if (next_it == entry->pending_queue.end())
+      return;
+  }
+
   // Promote next transaction from the pending queue.
-  Transaction* next = entry->pending_queue.front();
-  if ((next->mode() & Transaction::WRITE) && !entry->readers.empty())
+  Transaction* next = *next_it;
+  if ((next->mode() & Transaction::WRITE) && !entry->readers.empty() &&
+      !entry->writer) {
     return;  // Have to wait.
+  }
 
-  entry->pending_queue.erase(entry->pending_queue.begin());
+  entry->pending_queue.erase(next_it);
 
   int rv = AddTransactionToEntry(entry, next);
   if (rv != ERR_IO_PENDING) {
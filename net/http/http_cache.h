@@ -197,6 +197,17 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // referred to by |url| and |http_method|.
   void OnExternalCacheHit(const GURL& url, const std::string& http_method);
 
+  // Enables or disables shared writing. When enabled, a transaction that is
+  // storing a fresh response lets the transactions waiting for the same entry
+  // read the response body while it is still being written, instead of
+  // holding them back until the whole body is stored. Range requests, and
+  // requests that have to validate the fresh response, still wait for the
+  // writer to finish.
+  void set_shared_writing_enabled(bool value) {
+    shared_writing_enabled_ = value;
+  }
+  bool shared_writing_enabled() const { return shared_writing_enabled_; }
+
   // Causes all transactions created after this point to effectively bypass
   // the cache lock whenever there is lock contention.
   void BypassLockForTest() {
@@ -257,8 +268,17 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
     Transaction*       writer;
     TransactionList    readers;
     TransactionList    pending_queue;
+    // Readers that have read all the data stored so far by a shared writer,
+    // and wait for it to store more.
+    TransactionList    waiting_readers;
+    // Readers that joined while a shared writer stored the body, and that
+    // the writer left before storing all of it.
+    TransactionList    incomplete_readers;
     bool               will_process_pending_queue;
     bool               doomed;
+    // True while |writer| stores a response body that |readers| read as it
+    // arrives.
+    bool               shared_writing;
   };
 
   using ActiveEntriesMap = std::unordered_map<std::string, ActiveEntry*>;
@@ -361,6 +381,19 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // transactions can start reading from this entry.
   void ConvertWriterToReader(ActiveEntry* entry);
 
+  // Called by the writer of |entry| once it has stored the new response
+  // headers, and is about to store the body. If shared writing is enabled,
+  // pending transactions that can read the body as it is written are let in.
+  void BeginSharedWriting(ActiveEntry* entry);
+
+  // Called by a reader of |entry| that has read all the data stored so far by
+  // a shared writer. |trans| will be notified via its IO callback when there
+  // is more data, or the writer is done.
+  void WaitForSharedWriter(ActiveEntry* entry, Transaction* trans);
+
+  // Notifies the readers waiting for the shared writer of |entry|.
+  void NotifySharedReaders(ActiveEntry* entry);
+
   // Returns the LoadState of the provided pending transaction.
   LoadState GetLoadStateForPendingTransaction(const Transaction* trans);
 
@@ -407,6 +440,7 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // Used when lazily constructing the disk_cache_.
   std::unique_ptr<BackendFactory> backend_factory_;
   bool building_backend_;
+  bool shared_writing_enabled_;
   bool bypass_lock_for_test_;
   bool fail_conditionalization_for_test_;
 
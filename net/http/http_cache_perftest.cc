@@ -0,0 +1,163 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_transaction.h"
+#include "net/http/http_transaction_test_util.h"
+#include "net/http/mock_http_cache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kBodySize = 2 * 1024 * 1024;
+const int kReadSize = 32 * 1024;
+
+// Reads a response through the cache until the end, and reports its first
+// byte.
+class ResponseReader {
+ public:
+  explicit ResponseReader(const base::Closure& first_byte_callback)
+      : first_byte_callback_(first_byte_callback),
+        buf_(new IOBuffer(kReadSize)),
+        bytes_read_(0),
+        done_(false) {}
+
+  void Start(MockHttpCache* cache, const HttpRequestInfo* request) {
+    ASSERT_EQ(OK, cache->CreateTransaction(&trans_));
+    int rv = trans_->Start(request,
+                           base::Bind(&ResponseReader::OnStartComplete,
+                                      base::Unretained(this)),
+                           BoundNetLog());
+    if (rv != ERR_IO_PENDING)
+      OnStartComplete(rv);
+  }
+
+  int bytes_read() const { return bytes_read_; }
+  bool done() const { return done_; }
+
+ private:
+  void OnStartComplete(int result) {
+    ASSERT_EQ(OK, result);
+    ReadMore();
+  }
+
+  void ReadMore() {
+    int rv;
+    do {
+      rv = trans_->Read(
+          buf_.get(), kReadSize,
+          base::Bind(&ResponseReader::OnReadComplete, base::Unretained(this)));
+    } while (rv != ERR_IO_PENDING && OnRead(rv));
+  }
+
+  void OnReadComplete(int result) {
+    if (OnRead(result))
+      ReadMore();
+  }
+
+  // Returns true if there is more to read.
+  bool OnRead(int result) {
+    EXPECT_GE(result, 0);
+    if (result <= 0) {
+      done_ = true;
+      return false;
+    }
+    if (!bytes_read_)
+      first_byte_callback_.Run();
+    bytes_read_ += result;
+    return true;
+  }
+
+  base::Closure first_byte_callback_;
+  std::unique_ptr<HttpTransaction> trans_;
+  scoped_refptr<IOBuffer> buf_;
+  int bytes_read_;
+  bool done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResponseReader);
+};
+
+class HttpCacheSharedWritingPerfTest : public testing::Test {
+ protected:
+  HttpCacheSharedWritingPerfTest() : body_(kBodySize, 'x') {}
+
+  // Starts a writer and |num_readers| readers of the same uncached response,
+  // and logs the time until every reader has received its first byte.
+  void RunTimeToFirstByte(bool shared_writing, int num_readers) {
+    MockHttpCache cache;
+    cache.http_cache()->set_shared_writing_enabled(shared_writing);
+
+    ScopedMockTransaction transaction(kSimpleGET_Transaction);
+    transaction.data = body_.c_str();
+    MockHttpRequest request(transaction);
+
+    base::RunLoop run_loop;
+    int pending_first_bytes = num_readers;
+    base::Closure reader_first_byte = base::Bind(
+        &HttpCacheSharedWritingPerfTest::OnReaderFirstByte,
+        base::Unretained(&pending_first_bytes), run_loop.QuitClosure());
+
+    std::vector<std::unique_ptr<ResponseReader>> readers;
+    readers.push_back(
+        base::MakeUnique<ResponseReader>(base::Bind(&base::DoNothing)));
+    for (int i = 0; i < num_readers; ++i)
+      readers.push_back(base::MakeUnique<ResponseReader>(reader_first_byte));
+
+    base::PerfTimeLogger timer(
+        base::StringPrintf("HttpCache_time_to_first_byte_%s_%d_readers",
+                           shared_writing ? "shared" : "exclusive",
+                           num_readers)
+            .c_str());
+    for (const auto& reader : readers)
+      reader->Start(&cache, &request);
+    run_loop.Run();
+    timer.Done();
+
+    // Let everyone finish.
+    base::RunLoop().RunUntilIdle();
+    for (const auto& reader : readers) {
+      EXPECT_TRUE(reader->done());
+      EXPECT_EQ(kBodySize, reader->bytes_read());
+    }
+    EXPECT_EQ(1, cache.network_layer()->transaction_count());
+  }
+
+ private:
+  static void OnReaderFirstByte(int* pending_first_bytes,
+                                const base::Closure& quit_closure) {
+    if (!--*pending_first_bytes)
+      quit_closure.Run();
+  }
+
+  base::MessageLoopForIO message_loop_;
+  const std::string body_;
+};
+
+TEST_F(HttpCacheSharedWritingPerfTest, TimeToFirstByte) {
+  for (int num_readers : {1, 8, 32}) {
+    RunTimeToFirstByte(false, num_readers);
+    RunTimeToFirstByte(true, num_readers);
+  }
+}
+
+}  // namespace
+
+}  // namespace net
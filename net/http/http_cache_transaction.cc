@@ -161,6 +161,7 @@ HttpCache::Transaction::Transaction(RequestPriority priority, HttpCache* cache)
       done_reading_(false),
       vary_mismatch_(false),
       couldnt_conditionalize_request_(false),
+      must_wait_for_writer_(false),
       bypass_lock_for_test_(false),
       fail_conditionalization_for_test_(false),
       io_buf_len_(0),
@@ -240,6 +241,13 @@ bool HttpCache::Transaction::AddTruncatedFlag() {
   return true;
 }
 
+bool HttpCache::Transaction::CanReadWhileWriting() const {
+  // Range requests and externally conditionalized requests need the whole
+  // entry, and so does anything but a GET.
+  return (mode_ == READ || mode_ == READ_WRITE) && !partial_ &&
+         !must_wait_for_writer_ && request_->method == "GET";
+}
+
 LoadState HttpCache::Transaction::GetWriterLoadState() const {
   if (network_trans_.get())
     return network_trans_->GetLoadState();
@@ -407,6 +415,13 @@ void HttpCache::Transaction::StopCaching() {
   //                Fix this.
   if (cache_.get() && entry_ && (mode_ & WRITE) && network_trans_.get() &&
       !is_sparse_ && !range_requested_) {
+    if (entry_->shared_writing) {
+      // Other transactions are reading the body as it is stored, so keep
+      // storing it for them.
+      if (!entry_->readers.empty())
+        return;
+      entry_->shared_writing = false;
+    }
     mode_ = NONE;
   }
 }
@@ -1119,8 +1134,10 @@ int HttpCache::Transaction::DoAddToEntryComplete(int result) {
   DCHECK(new_entry_);
   cache_pending_ = false;
 
-  if (result == OK)
+  if (result == OK) {
     entry_ = new_entry_;
+    must_wait_for_writer_ = false;
+  }
 
   // If there is a failure, the cache should have taken care of new_entry_.
   new_entry_ = NULL;
@@ -1261,6 +1278,12 @@ int HttpCache::Transaction::DoCacheDispatchValidation() {
       result = BeginCacheRead();
       break;
     case READ_WRITE:
+      // A READ_WRITE transaction that is not the writer joined the entry
+      // while another transaction was writing it.
+      if (entry_->writer != this) {
+        result = BeginSharedCacheRead();
+        break;
+      }
       result = BeginPartialCacheValidation();
       break;
     case UPDATE:
@@ -1661,8 +1684,15 @@ int HttpCache::Transaction::DoPartialHeadersReceived() {
   if (entry_ && !partial_ && entry_->disk_entry->GetDataSize(kMetadataIndex))
     next_state_ = STATE_CACHE_READ_METADATA;
 
-  if (!partial_)
+  if (!partial_) {
+    // The new headers are stored and the old body is gone, so the body can
+    // be read by others as it is written.
+    if (entry_ && mode_ == WRITE && request_->method == "GET" &&
+        response_.headers->response_code() == 200) {
+      cache_->BeginSharedWriting(entry_);
+    }
     return OK;
+  }
 
   if (reading_) {
     if (network_trans_.get()) {
@@ -1755,8 +1785,18 @@ int HttpCache::Transaction::DoCacheReadDataComplete(int result) {
     return DoPartialCacheReadCompleted(result);
   }
 
+  if (result == 0 && entry_->shared_writing) {
+    // This is all the data stored so far. Wait for the writer to store more.
+    cache_->WaitForSharedWriter(entry_, this);
+    next_state_ = STATE_CACHE_READ_DATA;
+    return ERR_IO_PENDING;
+  }
+
   if (result > 0) {
     read_offset_ += result;
+  } else if (result == 0 && SharedWriterStoppedEarly()) {
+    // The writer stopped before storing the whole body.
+    return ERR_CACHE_READ_FAILURE;
   } else if (result == 0) {  // End of file.
     RecordHistograms();
     cache_->DoneReadingFromEntry(entry_, this);
@@ -1807,6 +1847,9 @@ int HttpCache::Transaction::DoCacheWriteDataComplete(int result) {
       done_reading_ = true;
   }
 
+  if (result > 0 && entry_ && entry_->shared_writing)
+    cache_->NotifySharedReaders(entry_);
+
   if (partial_) {
     // This may be the last request.
     if (result != 0 || truncated_ ||
@@ -1984,6 +2027,33 @@ int HttpCache::Transaction::BeginCacheRead() {
   return OK;
 }
 
+int HttpCache::Transaction::BeginSharedCacheRead() {
+  DCHECK_EQ(mode_, READ_WRITE);
+  DCHECK(!partial_);
+
+  // The response was just received, but it may still have to be validated for
+  // this request. If so, or if the writer didn't store the whole body, start
+  // over and wait for the writer to finish.
+  if (SharedWriterStoppedEarly() ||
+      RequiresValidation() != VALIDATION_NONE) {
+    must_wait_for_writer_ = true;
+    cache_->DoneReadingFromEntry(entry_, this);
+    entry_ = NULL;
+    next_state_ = STATE_INIT_ENTRY;
+    return OK;
+  }
+
+  UpdateCacheEntryStatus(CacheEntryStatus::ENTRY_USED);
+  mode_ = READ;
+  return BeginCacheRead();
+}
+
+bool HttpCache::Transaction::SharedWriterStoppedEarly() const {
+  return std::find(entry_->incomplete_readers.begin(),
+                   entry_->incomplete_readers.end(),
+                   this) != entry_->incomplete_readers.end();
+}
+
 int HttpCache::Transaction::BeginCacheValidation() {
   DCHECK_EQ(mode_, READ_WRITE);
 
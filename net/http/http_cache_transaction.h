@@ -110,6 +110,10 @@ class HttpCache::Transaction : public HttpTransaction {
 
   HttpCache::ActiveEntry* entry() { return entry_; }
 
+  // Returns true if this transaction may read the response body of its entry
+  // while another transaction is still writing it.
+  bool CanReadWhileWriting() const;
+
   // Returns the LoadState of the writer transaction of a given ActiveEntry. In
   // other words, returns the LoadState of this transaction without asking the
   // http cache, because this transaction should be the one currently writing
@@ -304,6 +308,14 @@ class HttpCache::Transaction : public HttpTransaction {
   // Called to begin reading from the cache.  Returns network error code.
   int BeginCacheRead();
 
+  // Called to begin reading a response that another transaction is still
+  // writing to the cache.  Returns network error code.
+  int BeginSharedCacheRead();
+
+  // Returns true if this transaction joined |entry_| while a shared writer
+  // stored the body, and the writer stopped before storing all of it.
+  bool SharedWriterStoppedEarly() const;
+
   // Called to begin validating the cache entry.  Returns network error code.
   int BeginCacheValidation();
 
@@ -459,6 +471,9 @@ class HttpCache::Transaction : public HttpTransaction {
   bool done_reading_;  // All available data was read.
   bool vary_mismatch_;  // The request doesn't match the stored vary data.
   bool couldnt_conditionalize_request_;
+  // The response being written by another transaction has to be validated, so
+  // this one waits for the writer to finish.
+  bool must_wait_for_writer_;
   bool bypass_lock_for_test_;  // A test is exercising the cache lock.
   bool fail_conditionalization_for_test_;  // Fail ConditionalizeRequest.
   scoped_refptr<IOBuffer> read_buf_;
@@ -1326,6 +1326,255 @@ TEST(HttpCache, SimpleGET_ManyReaders) {
   }
 }
 
+// Tests that with shared writing, readers get the response and its body while
+// the writer is still storing the body.
+TEST(HttpCache, SimpleGET_SharedWriting_ManyReaders) {
+  MockHttpCache cache;
+  cache.http_cache()->set_shared_writing_enabled(true);
+
+  // The network returns the body one byte at a time.
+  ScopedMockTransaction transaction(kSimpleGET_Transaction);
+  transaction.test_mode = TEST_MODE_SLOW_READ;
+  MockHttpRequest request(transaction);
+
+  std::vector<std::unique_ptr<Context>> context_list;
+  const int kNumTransactions = 5;
+
+  for (int i = 0; i < kNumTransactions; ++i) {
+    context_list.push_back(base::MakeUnique<Context>());
+    Context* c = context_list[i].get();
+
+    c->result = cache.CreateTransaction(&c->trans);
+    ASSERT_THAT(c->result, IsOk());
+
+    c->result =
+        c->trans->Start(&request, c->callback.callback(), BoundNetLog());
+  }
+
+  base::RunLoop().RunUntilIdle();
+
+  // Everyone has the response headers, but the body has not been read from
+  // the network yet.
+  for (const auto& c : context_list) {
+    ASSERT_TRUE(c->callback.have_result());
+    EXPECT_THAT(c->callback.WaitForResult(), IsOk());
+  }
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+
+  // A reader waits for the writer to store some data.
+  Context* writer = context_list[0].get();
+  Context* reader = context_list[1].get();
+  scoped_refptr<IOBuffer> reader_buf(new IOBuffer(256));
+  TestCompletionCallback reader_callback;
+  int rv =
+      reader->trans->Read(reader_buf.get(), 256, reader_callback.callback());
+  EXPECT_THAT(rv, IsError(ERR_IO_PENDING));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE(reader_callback.have_result());
+
+  scoped_refptr<IOBuffer> writer_buf(new IOBuffer(256));
+  TestCompletionCallback writer_callback;
+  rv = writer->trans->Read(writer_buf.get(), 256, writer_callback.callback());
+  EXPECT_EQ(1, writer_callback.GetResult(rv));
+  EXPECT_EQ(1, reader_callback.WaitForResult());
+  EXPECT_EQ(transaction.data[0], reader_buf->data()[0]);
+
+  // Everyone reads the rest.
+  const std::string expected(transaction.data);
+  std::string content;
+  EXPECT_THAT(ReadTransaction(writer->trans.get(), &content), IsOk());
+  EXPECT_EQ(expected.substr(1), content);
+  EXPECT_THAT(ReadTransaction(reader->trans.get(), &content), IsOk());
+  EXPECT_EQ(expected.substr(1), content);
+  for (int i = 2; i < kNumTransactions; ++i)
+    ReadAndVerifyTransaction(context_list[i]->trans.get(), transaction);
+
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+
+  // The stored entry is complete.
+  RunTransactionTest(cache.http_cache(), transaction);
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+}
+
+// Tests that with shared writing, a request that has to validate the response
+// waits for the writer to finish.
+TEST(HttpCache, SimpleGET_SharedWriting_Validation) {
+  MockHttpCache cache;
+  cache.http_cache()->set_shared_writing_enabled(true);
+
+  MockHttpRequest request(kSimpleGET_Transaction);
+  MockHttpRequest validating_request(kSimpleGET_Transaction);
+  validating_request.load_flags |= LOAD_VALIDATE_CACHE;
+
+  Context writer;
+  Context reader;
+  Context validator;
+  for (Context* c : {&writer, &reader, &validator}) {
+    c->result = cache.CreateTransaction(&c->trans);
+    ASSERT_THAT(c->result, IsOk());
+  }
+  writer.result =
+      writer.trans->Start(&request, writer.callback.callback(), BoundNetLog());
+  reader.result =
+      reader.trans->Start(&request, reader.callback.callback(), BoundNetLog());
+  validator.result = validator.trans->Start(
+      &validating_request, validator.callback.callback(), BoundNetLog());
+
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_THAT(writer.callback.GetResult(writer.result), IsOk());
+  EXPECT_THAT(reader.callback.GetResult(reader.result), IsOk());
+  EXPECT_FALSE(validator.callback.have_result());
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+
+  ReadAndVerifyTransaction(writer.trans.get(), kSimpleGET_Transaction);
+  ReadAndVerifyTransaction(reader.trans.get(), kSimpleGET_Transaction);
+
+  // The response has no validators, so it is fetched again.
+  EXPECT_THAT(validator.callback.WaitForResult(), IsOk());
+  ReadAndVerifyTransaction(validator.trans.get(), kSimpleGET_Transaction);
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+}
+
+// Tests that with shared writing, readers fail if the writer goes away before
+// storing the whole body, and that the entry is not used again.
+TEST(HttpCache, SimpleGET_SharedWriting_WriterCancelled) {
+  MockHttpCache cache;
+  cache.http_cache()->set_shared_writing_enabled(true);
+
+  ScopedMockTransaction transaction(kSimpleGET_Transaction);
+  transaction.test_mode = TEST_MODE_SLOW_READ;
+  MockHttpRequest request(transaction);
+
+  Context writer;
+  Context reader;
+  for (Context* c : {&writer, &reader}) {
+    c->result = cache.CreateTransaction(&c->trans);
+    ASSERT_THAT(c->result, IsOk());
+    c->result =
+        c->trans->Start(&request, c->callback.callback(), BoundNetLog());
+  }
+  EXPECT_THAT(writer.callback.GetResult(writer.result), IsOk());
+  EXPECT_THAT(reader.callback.GetResult(reader.result), IsOk());
+
+  scoped_refptr<IOBuffer> buf(new IOBuffer(256));
+  TestCompletionCallback callback;
+  int rv = writer.trans->Read(buf.get(), 256, callback.callback());
+  EXPECT_EQ(1, callback.GetResult(rv));
+
+  rv = reader.trans->Read(buf.get(), 256, callback.callback());
+  EXPECT_EQ(1, callback.GetResult(rv));
+  rv = reader.trans->Read(buf.get(), 256, callback.callback());
+  EXPECT_THAT(rv, IsError(ERR_IO_PENDING));
+
+  // The response can't be resumed, so the entry is doomed.
+  writer.trans.reset();
+  EXPECT_THAT(callback.WaitForResult(), IsError(ERR_CACHE_READ_FAILURE));
+  reader.trans.reset();
+
+  RunTransactionTest(cache.http_cache(), transaction);
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(2, cache.disk_cache()->create_count());
+}
+
+// Tests that with shared writing, only the readers that were sharing the entry
+// fail when the writer stores part of a resumable body, and that a request
+// reading the entry after another writer completes it gets the whole body.
+TEST(HttpCache, SimpleGET_SharedWriting_TruncatedThenCompleted) {
+  MockHttpCache cache;
+  cache.http_cache()->set_shared_writing_enabled(true);
+
+  ScopedMockTransaction transaction(kRangeGET_TransactionOK);
+  transaction.request_headers = EXTRA_HEADER;
+  transaction.status = "HTTP/1.1 200 OK";
+  transaction.response_headers =
+      "Last-Modified: Sat, 18 Apr 2007 01:10:43 GMT\n"
+      "ETag: \"foo\"\n"
+      "Accept-Ranges: bytes\n"
+      "Content-Length: 80\n";
+  transaction.data = kFullRangeData;
+  transaction.handler = nullptr;
+  transaction.test_mode = TEST_MODE_SLOW_READ;
+  MockHttpRequest request(transaction);
+
+  Context writer;
+  Context reader;
+  for (Context* c : {&writer, &reader}) {
+    c->result = cache.CreateTransaction(&c->trans);
+    ASSERT_THAT(c->result, IsOk());
+    c->result =
+        c->trans->Start(&request, c->callback.callback(), BoundNetLog());
+  }
+  EXPECT_THAT(writer.callback.GetResult(writer.result), IsOk());
+  EXPECT_THAT(reader.callback.GetResult(reader.result), IsOk());
+
+  // The writer stores the first block of the body, and the reader catches up.
+  scoped_refptr<IOBuffer> buf(new IOBuffer(256));
+  TestCompletionCallback callback;
+  int rv;
+  for (int i = 0; i < 10; ++i) {
+    rv = writer.trans->Read(buf.get(), 256, callback.callback());
+    EXPECT_EQ(1, callback.GetResult(rv));
+  }
+  int bytes_read = 0;
+  while (bytes_read < 10) {
+    rv = reader.trans->Read(buf.get(), 256, callback.callback());
+    rv = callback.GetResult(rv);
+    ASSERT_GT(rv, 0);
+    bytes_read += rv;
+  }
+  EXPECT_EQ(10, bytes_read);
+  rv = reader.trans->Read(buf.get(), 256, callback.callback());
+  EXPECT_THAT(rv, IsError(ERR_IO_PENDING));
+
+  // The response can be resumed, so the entry is kept as truncated.
+  writer.trans.reset();
+  EXPECT_THAT(callback.WaitForResult(), IsError(ERR_CACHE_READ_FAILURE));
+
+  // Queue a request that completes the entry and another one that reads it,
+  // while the failed reader still holds the entry.
+  transaction.status = kRangeGET_TransactionOK.status;
+  transaction.response_headers = kRangeGET_TransactionOK.response_headers;
+  transaction.handler = &RangeTransactionServer::RangeHandler;
+  transaction.test_mode = TEST_MODE_NORMAL;
+  RangeTransactionServer handler;
+
+  Context resumer;
+  Context later_reader;
+  for (Context* c : {&resumer, &later_reader}) {
+    c->result = cache.CreateTransaction(&c->trans);
+    ASSERT_THAT(c->result, IsOk());
+    c->result =
+        c->trans->Start(&request, c->callback.callback(), BoundNetLog());
+    EXPECT_THAT(c->result, IsError(ERR_IO_PENDING));
+  }
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE(resumer.callback.have_result());
+  EXPECT_FALSE(later_reader.callback.have_result());
+
+  reader.trans.reset();
+  EXPECT_THAT(resumer.callback.WaitForResult(), IsOk());
+  ReadAndVerifyTransaction(resumer.trans.get(), transaction);
+  resumer.trans.reset();
+
+  EXPECT_THAT(later_reader.callback.WaitForResult(), IsOk());
+  ReadAndVerifyTransaction(later_reader.trans.get(), transaction);
+
+  // The resumer validates the entry with a one byte range before fetching the
+  // rest of the body.
+  EXPECT_EQ(3, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+  VerifyTruncatedFlag(&cache, kRangeGET_TransactionOK.url, false, 80);
+}
+
 // This is a test for http://code.google.com/p/chromium/issues/detail?id=4769.
 // If cancelling a request is racing with another request for the same resource
 // finishing, we have to make sure that we remove both transactions from the
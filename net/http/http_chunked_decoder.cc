@@ -69,6 +69,12 @@ HttpChunkedDecoder::HttpChunkedDecoder()
 int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
   int result = 0;
 
+  // Chunk data is moved down over the chunk markers before it, to |out|.
+  // Moving each piece once, rather than moving the whole rest of |buf| each
+  // time a marker is removed, keeps this linear in |buf_len| however many
+  // chunks |buf| holds.  Nothing moves until the first marker.
+  char* out = buf;
+
   while (buf_len > 0) {
     if (chunk_remaining_ > 0) {
       // Since |chunk_remaining_| is positive and |buf_len| an int, the minimum
@@ -76,17 +82,24 @@ int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
       int num = static_cast<int>(
           std::min(chunk_remaining_, static_cast<int64_t>(buf_len)));
 
+      if (out != buf)
+        memmove(out, buf, num);
+
       buf_len -= num;
       chunk_remaining_ -= num;
 
       result += num;
       buf += num;
+      out += num;
 
       // After each chunk's data there should be a CRLF.
       if (chunk_remaining_ == 0)
         chunk_terminator_remaining_ = true;
       continue;
     } else if (reached_eof_) {
+      // Callers expect the bytes after the end right after the data.
+      if (out != buf)
+        memmove(out, buf, buf_len);
       bytes_after_eof_ += buf_len;
       break;  // Done!
     }
@@ -96,8 +109,7 @@ int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
       return bytes_consumed; // Error
 
     buf_len -= bytes_consumed;
-    if (buf_len > 0)
-      memmove(buf, buf + bytes_consumed, buf_len);
+    buf += bytes_consumed;
   }
 
   return result;
@@ -394,6 +394,28 @@ TEST(HttpChunkedDecoderTest, MultipleExtraDataBlocks) {
   RunTest(inputs, arraysize(inputs), "hello", true, 11);
 }
 
+// The data of many chunks in one buffer ends up contiguous at its start,
+// followed by the bytes after the end.
+TEST(HttpChunkedDecoderTest, ManyChunksExtraDataPosition) {
+  std::string input;
+  std::string expected_output;
+  for (int i = 0; i < 1000; ++i) {
+    std::string data(i % 17 + 1, static_cast<char>('a' + i % 26));
+    input += base::StringPrintf("%x\r\n", static_cast<unsigned>(data.size()));
+    input += data + "\r\n";
+    expected_output += data;
+  }
+  input += "0\r\n\r\nextra bytes";
+
+  HttpChunkedDecoder decoder;
+  int n = decoder.FilterBuf(&input[0], static_cast<int>(input.size()));
+  ASSERT_EQ(static_cast<int>(expected_output.size()), n);
+  EXPECT_EQ(expected_output, input.substr(0, n));
+  EXPECT_TRUE(decoder.reached_eof());
+  ASSERT_EQ(11, decoder.bytes_after_eof());
+  EXPECT_EQ("extra bytes", input.substr(n, 11));
+}
+
 // Test when the line with the chunk length is too long.
 TEST(HttpChunkedDecoderTest, LongChunkLengthLine) {
   int big_chunk_length = HttpChunkedDecoder::kMaxLineBufLen;
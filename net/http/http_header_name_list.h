@@ -0,0 +1,101 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file intentionally does not have header guards, it's included
+// inside a macro to generate enum values and tables.
+//
+// This file contains the list of HTTP header names that are interned by
+// LookupHttpHeaderName(). Names must be lower case, and each one must appear
+// only once. There can be at most 255 of them.
+
+#ifndef HTTP_HEADER_NAME
+#error "HTTP_HEADER_NAME should be defined before including this file"
+#endif
+
+HTTP_HEADER_NAME(ACCEPT, "accept")
+HTTP_HEADER_NAME(ACCEPT_CHARSET, "accept-charset")
+HTTP_HEADER_NAME(ACCEPT_ENCODING, "accept-encoding")
+HTTP_HEADER_NAME(ACCEPT_LANGUAGE, "accept-language")
+HTTP_HEADER_NAME(ACCEPT_RANGES, "accept-ranges")
+HTTP_HEADER_NAME(ACCESS_CONTROL_ALLOW_CREDENTIALS, "access-control-allow-credentials")
+HTTP_HEADER_NAME(ACCESS_CONTROL_ALLOW_HEADERS, "access-control-allow-headers")
+HTTP_HEADER_NAME(ACCESS_CONTROL_ALLOW_METHODS, "access-control-allow-methods")
+HTTP_HEADER_NAME(ACCESS_CONTROL_ALLOW_ORIGIN, "access-control-allow-origin")
+HTTP_HEADER_NAME(ACCESS_CONTROL_EXPOSE_HEADERS, "access-control-expose-headers")
+HTTP_HEADER_NAME(ACCESS_CONTROL_MAX_AGE, "access-control-max-age")
+HTTP_HEADER_NAME(ACCESS_CONTROL_REQUEST_HEADERS, "access-control-request-headers")
+HTTP_HEADER_NAME(ACCESS_CONTROL_REQUEST_METHOD, "access-control-request-method")
+HTTP_HEADER_NAME(AGE, "age")
+HTTP_HEADER_NAME(ALLOW, "allow")
+HTTP_HEADER_NAME(ALT_SVC, "alt-svc")
+HTTP_HEADER_NAME(ALTERNATE_PROTOCOL, "alternate-protocol")
+HTTP_HEADER_NAME(AUTHORIZATION, "authorization")
+HTTP_HEADER_NAME(CACHE_CONTROL, "cache-control")
+HTTP_HEADER_NAME(CONNECTION, "connection")
+HTTP_HEADER_NAME(CONTENT_DISPOSITION, "content-disposition")
+HTTP_HEADER_NAME(CONTENT_ENCODING, "content-encoding")
+HTTP_HEADER_NAME(CONTENT_LANGUAGE, "content-language")
+HTTP_HEADER_NAME(CONTENT_LENGTH, "content-length")
+HTTP_HEADER_NAME(CONTENT_LOCATION, "content-location")
+HTTP_HEADER_NAME(CONTENT_MD5, "content-md5")
+HTTP_HEADER_NAME(CONTENT_RANGE, "content-range")
+HTTP_HEADER_NAME(CONTENT_SECURITY_POLICY, "content-security-policy")
+HTTP_HEADER_NAME(CONTENT_SECURITY_POLICY_REPORT_ONLY, "content-security-policy-report-only")
+HTTP_HEADER_NAME(CONTENT_TYPE, "content-type")
+HTTP_HEADER_NAME(COOKIE, "cookie")
+HTTP_HEADER_NAME(DATE, "date")
+HTTP_HEADER_NAME(DNT, "dnt")
+HTTP_HEADER_NAME(ETAG, "etag")
+HTTP_HEADER_NAME(EXPECT, "expect")
+HTTP_HEADER_NAME(EXPIRES, "expires")
+HTTP_HEADER_NAME(FROM, "from")
+HTTP_HEADER_NAME(HOST, "host")
+HTTP_HEADER_NAME(IF_MATCH, "if-match")
+HTTP_HEADER_NAME(IF_MODIFIED_SINCE, "if-modified-since")
+HTTP_HEADER_NAME(IF_NONE_MATCH, "if-none-match")
+HTTP_HEADER_NAME(IF_RANGE, "if-range")
+HTTP_HEADER_NAME(IF_UNMODIFIED_SINCE, "if-unmodified-since")
+HTTP_HEADER_NAME(KEEP_ALIVE, "keep-alive")
+HTTP_HEADER_NAME(LAST_MODIFIED, "last-modified")
+HTTP_HEADER_NAME(LINK, "link")
+HTTP_HEADER_NAME(LOCATION, "location")
+HTTP_HEADER_NAME(MAX_FORWARDS, "max-forwards")
+HTTP_HEADER_NAME(ORIGIN, "origin")
+HTTP_HEADER_NAME(P3P, "p3p")
+HTTP_HEADER_NAME(PRAGMA, "pragma")
+HTTP_HEADER_NAME(PROXY_AUTHENTICATE, "proxy-authenticate")
+HTTP_HEADER_NAME(PROXY_AUTHORIZATION, "proxy-authorization")
+HTTP_HEADER_NAME(PROXY_CONNECTION, "proxy-connection")
+HTTP_HEADER_NAME(PUBLIC_KEY_PINS, "public-key-pins")
+HTTP_HEADER_NAME(PUBLIC_KEY_PINS_REPORT_ONLY, "public-key-pins-report-only")
+HTTP_HEADER_NAME(RANGE, "range")
+HTTP_HEADER_NAME(REFERER, "referer")
+HTTP_HEADER_NAME(REFERRER_POLICY, "referrer-policy")
+HTTP_HEADER_NAME(REFRESH, "refresh")
+HTTP_HEADER_NAME(RETRY_AFTER, "retry-after")
+HTTP_HEADER_NAME(SERVER, "server")
+HTTP_HEADER_NAME(SET_COOKIE, "set-cookie")
+HTTP_HEADER_NAME(SET_COOKIE2, "set-cookie2")
+HTTP_HEADER_NAME(STATUS, "status")
+HTTP_HEADER_NAME(STRICT_TRANSPORT_SECURITY, "strict-transport-security")
+HTTP_HEADER_NAME(TE, "te")
+HTTP_HEADER_NAME(TIMING_ALLOW_ORIGIN, "timing-allow-origin")
+HTTP_HEADER_NAME(TRAILER, "trailer")
+HTTP_HEADER_NAME(TRANSFER_ENCODING, "transfer-encoding")
+HTTP_HEADER_NAME(UPGRADE, "upgrade")
+HTTP_HEADER_NAME(UPGRADE_INSECURE_REQUESTS, "upgrade-insecure-requests")
+HTTP_HEADER_NAME(USER_AGENT, "user-agent")
+HTTP_HEADER_NAME(VARY, "vary")
+HTTP_HEADER_NAME(VIA, "via")
+HTTP_HEADER_NAME(WARNING, "warning")
+HTTP_HEADER_NAME(WWW_AUTHENTICATE, "www-authenticate")
+HTTP_HEADER_NAME(X_CACHE, "x-cache")
+HTTP_HEADER_NAME(X_CONTENT_TYPE_OPTIONS, "x-content-type-options")
+HTTP_HEADER_NAME(X_DNS_PREFETCH_CONTROL, "x-dns-prefetch-control")
+HTTP_HEADER_NAME(X_FORWARDED_FOR, "x-forwarded-for")
+HTTP_HEADER_NAME(X_FRAME_OPTIONS, "x-frame-options")
+HTTP_HEADER_NAME(X_POWERED_BY, "x-powered-by")
+HTTP_HEADER_NAME(X_REQUESTED_WITH, "x-requested-with")
+HTTP_HEADER_NAME(X_UA_COMPATIBLE, "x-ua-compatible")
+HTTP_HEADER_NAME(X_XSS_PROTECTION, "x-xss-protection")
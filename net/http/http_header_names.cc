@@ -0,0 +1,109 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_header_names.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/strings/string_util.h"
+
+namespace net {
+
+namespace {
+
+const char* const kHeaderNames[] = {
+    nullptr,  // HTTP_HEADER_UNKNOWN
+
+#define HTTP_HEADER_NAME(label, name) name,
+#include "net/http/http_header_name_list.h"
+#undef HTTP_HEADER_NAME
+
+};
+
+static_assert(arraysize(kHeaderNames) == HTTP_HEADER_NAME_COUNT,
+              "kHeaderNames must match HttpHeaderName");
+static_assert(HTTP_HEADER_NAME_COUNT <= 256,
+              "HttpHeaderName must fit in a uint8_t");
+
+// An open-addressed hash table of the names in http_header_name_list.h. It
+// is a power of two at least three times as large as the list, so lookups of
+// names that are not in it usually end at an empty slot straight away.
+const size_t kTableSize = 512;
+static_assert(kTableSize >= 3 * HTTP_HEADER_NAME_COUNT,
+              "kTableSize is too small for http_header_name_list.h");
+
+// 32-bit FNV-1a of the lower case form of |name|.
+uint32_t HashHeaderName(const base::StringPiece& name) {
+  uint32_t hash = 2166136261u;
+  for (char c : name) {
+    hash ^= static_cast<uint8_t>(base::ToLowerASCII(c));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+class HeaderNameTable {
+ public:
+  HeaderNameTable() : max_length_(0) {
+    memset(slots_, HTTP_HEADER_UNKNOWN, sizeof(slots_));
+    for (size_t i = 1; i < HTTP_HEADER_NAME_COUNT; ++i) {
+      lengths_[i] = strlen(kHeaderNames[i]);
+      max_length_ = std::max(max_length_, lengths_[i]);
+      size_t slot = HashHeaderName(kHeaderNames[i]) & (kTableSize - 1);
+      while (slots_[slot] != HTTP_HEADER_UNKNOWN) {
+        DCHECK(strcmp(kHeaderNames[slots_[slot]], kHeaderNames[i]))
+            << "Duplicate header name " << kHeaderNames[i];
+        slot = (slot + 1) & (kTableSize - 1);
+      }
+      slots_[slot] = static_cast<uint8_t>(i);
+    }
+  }
+
+  HttpHeaderName Lookup(const base::StringPiece& name) const {
+    if (name.empty() || name.size() > max_length_)
+      return HTTP_HEADER_UNKNOWN;
+    size_t slot = HashHeaderName(name) & (kTableSize - 1);
+    while (slots_[slot] != HTTP_HEADER_UNKNOWN) {
+      uint8_t id = slots_[slot];
+      if (lengths_[id] == name.size() &&
+          base::LowerCaseEqualsASCII(name, kHeaderNames[id])) {
+        return static_cast<HttpHeaderName>(id);
+      }
+      slot = (slot + 1) & (kTableSize - 1);
+    }
+    return HTTP_HEADER_UNKNOWN;
+  }
+
+ private:
+  // The HttpHeaderName of the name in each slot, or HTTP_HEADER_UNKNOWN.
+  uint8_t slots_[kTableSize];
+
+  // The length of each name, by HttpHeaderName.
+  size_t lengths_[HTTP_HEADER_NAME_COUNT];
+  size_t max_length_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeaderNameTable);
+};
+
+base::LazyInstance<HeaderNameTable>::Leaky g_header_name_table =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+HttpHeaderName LookupHttpHeaderName(const base::StringPiece& name) {
+  return g_header_name_table.Get().Lookup(name);
+}
+
+const char* GetHttpHeaderNameString(HttpHeaderName header) {
+  DCHECK_NE(HTTP_HEADER_UNKNOWN, header);
+  DCHECK_LT(header, HTTP_HEADER_NAME_COUNT);
+  return kHeaderNames[header];
+}
+
+}  // namespace net
@@ -0,0 +1,39 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_HTTP_HTTP_HEADER_NAMES_H_
+#define NET_HTTP_HTTP_HEADER_NAMES_H_
+
+#include <stdint.h>
+
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// Identifiers of commonly used HTTP header names. HTTP_HEADER_UNKNOWN stands
+// for every other name.
+enum HttpHeaderName : uint8_t {
+  HTTP_HEADER_UNKNOWN = 0,
+
+#define HTTP_HEADER_NAME(label, name) HTTP_HEADER_ ## label,
+#include "net/http/http_header_name_list.h"
+#undef HTTP_HEADER_NAME
+
+  HTTP_HEADER_NAME_COUNT
+};
+
+// Returns the identifier of the header name |name|, compared case
+// insensitively, or HTTP_HEADER_UNKNOWN if it is not in
+// http_header_name_list.h. This takes one hash of |name| and usually a single
+// comparison, so it is cheaper than comparing |name| against a few strings.
+NET_EXPORT HttpHeaderName LookupHttpHeaderName(const base::StringPiece& name);
+
+// Returns the lower case name of |header|, which must not be
+// HTTP_HEADER_UNKNOWN.
+NET_EXPORT const char* GetHttpHeaderNameString(HttpHeaderName header);
+
+}  // namespace net
+
+#endif  // NET_HTTP_HTTP_HEADER_NAMES_H_
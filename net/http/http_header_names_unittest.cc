@@ -0,0 +1,43 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_header_names.h"
+
+#include <string>
+
+#include "base/strings/string_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(HttpHeaderNamesTest, LookupKnownNames) {
+  for (int i = HTTP_HEADER_UNKNOWN + 1; i < HTTP_HEADER_NAME_COUNT; ++i) {
+    HttpHeaderName header = static_cast<HttpHeaderName>(i);
+    std::string name = GetHttpHeaderNameString(header);
+    SCOPED_TRACE(name);
+    EXPECT_EQ(base::ToLowerASCII(name), name);
+    EXPECT_EQ(header, LookupHttpHeaderName(name));
+    EXPECT_EQ(header, LookupHttpHeaderName(base::ToUpperASCII(name)));
+  }
+
+  EXPECT_EQ(HTTP_HEADER_CONTENT_LENGTH, LookupHttpHeaderName("Content-Length"));
+  EXPECT_STREQ("set-cookie", GetHttpHeaderNameString(HTTP_HEADER_SET_COOKIE));
+}
+
+TEST(HttpHeaderNamesTest, LookupUnknownNames) {
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN, LookupHttpHeaderName(""));
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN, LookupHttpHeaderName("x-unknown"));
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN, LookupHttpHeaderName("content-lengt"));
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN, LookupHttpHeaderName("content-length "));
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN, LookupHttpHeaderName("content_length"));
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN,
+            LookupHttpHeaderName(std::string("vary\0", 5)));
+  EXPECT_EQ(HTTP_HEADER_UNKNOWN, LookupHttpHeaderName(std::string(1000, 'a')));
+}
+
+}  // namespace
+
+}  // namespace net
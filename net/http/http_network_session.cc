@@ -93,6 +93,7 @@ HttpNetworkSession::Params::Params()
       enable_http2(true),
       spdy_session_max_recv_window_size(kSpdySessionMaxRecvWindowSize),
       spdy_stream_max_recv_window_size(kSpdyStreamMaxRecvWindowSize),
+      enable_spdy_write_coalescing(false),
       time_func(&base::TimeTicks::Now),
       enable_http2_alternative_service_with_different_host(false),
       enable_quic_alternative_service_with_different_host(true),
@@ -197,6 +198,7 @@ HttpNetworkSession::HttpNetworkSession(const Params& params)
                          params.enable_spdy_ping_based_connection_checking,
                          params.spdy_session_max_recv_window_size,
                          params.spdy_stream_max_recv_window_size,
+                         params.enable_spdy_write_coalescing,
                          params.time_func,
                          params.proxy_delegate),
       http_stream_factory_(new HttpStreamFactoryImpl(this, false)),
@@ -92,6 +92,9 @@ class NET_EXPORT HttpNetworkSession
     bool enable_http2;
     size_t spdy_session_max_recv_window_size;
     size_t spdy_stream_max_recv_window_size;
+    // Whether SPDY sessions write the frames they have queued together, in
+    // a single socket write, instead of one write per frame.
+    bool enable_spdy_write_coalescing;
     // Source of time for SPDY connections.
     SpdySessionPool::TimeFunc time_func;
     // Whether to enable HTTP/2 Alt-Svc entries with hostname different than
@@ -316,4 +316,8 @@ bool HttpProxyClientSocketPool::CloseOneIdleConnection() {
   return base_.CloseOneIdleConnectionInHigherLayeredPool();
 }
 
+bool HttpProxyClientSocketPool::HasGroup(const std::string& group_name) const {
+  return base_.HasGroup(group_name);
+}
+
 }  // namespace net
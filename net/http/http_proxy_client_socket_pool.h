@@ -195,6 +195,7 @@ class NET_EXPORT_PRIVATE HttpProxyClientSocketPool
 
   // HigherLayeredPool implementation.
   bool CloseOneIdleConnection() override;
+  bool HasGroup(const std::string& group_name) const override;
 
  private:
   typedef ClientSocketPoolBase<HttpProxySocketParams> PoolBase;
@@ -9,6 +9,8 @@
 
 #include "net/http/http_response_headers.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <unordered_map>
 #include <utility>
@@ -111,6 +113,44 @@ bool ShouldUpdateHeader(base::StringPiece name) {
   return true;
 }
 
+// Largest value of HttpResponseHeaders::first_header_index_.
+const size_t kMaxHeaderIndex = 0xFFFF;
+
+// Returns whether the values of |name| must not be split on commas.  All the
+// names HttpUtil::IsNonCoalescingHeader() accepts are interned, so this just
+// switches on the interned name instead of comparing strings.
+bool IsNonCoalescingHeader(HttpHeaderName name) {
+  switch (name) {
+    case HTTP_HEADER_DATE:
+    case HTTP_HEADER_EXPIRES:
+    case HTTP_HEADER_LAST_MODIFIED:
+    case HTTP_HEADER_LOCATION:
+    case HTTP_HEADER_RETRY_AFTER:
+    case HTTP_HEADER_SET_COOKIE:
+    case HTTP_HEADER_WWW_AUTHENTICATE:
+    case HTTP_HEADER_PROXY_AUTHENTICATE:
+    case HTTP_HEADER_STRICT_TRANSPORT_SECURITY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the first |c| in [begin, end), or |end| if there is none.  This uses
+// memchr(), which is much faster than std::find() on all but the shortest
+// ranges.
+std::string::const_iterator FindChar(std::string::const_iterator begin,
+                                     std::string::const_iterator end,
+                                     char c) {
+  if (begin == end)
+    return end;
+  const char* first = &*begin;
+  const void* found = memchr(first, c, end - begin);
+  if (!found)
+    return end;
+  return begin + (static_cast<const char*>(found) - first);
+}
+
 void CheckDoesNotHaveEmbededNulls(const std::string& str) {
   // Care needs to be taken when adding values to the raw headers string to
   // make sure it does not contain embeded NULLs. Any embeded '\0' may be
@@ -127,6 +167,8 @@ struct HttpResponseHeaders::ParsedHeader {
   // preceding header.  (Header values are comma separated.)
   bool is_continuation() const { return name_begin == name_end; }
 
+  // HTTP_HEADER_UNKNOWN for continuations.
+  HttpHeaderName name_id;
   std::string::const_iterator name_begin;
   std::string::const_iterator name_end;
   std::string::const_iterator value_begin;
@@ -136,7 +178,7 @@ struct HttpResponseHeaders::ParsedHeader {
 //-----------------------------------------------------------------------------
 
 HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
-    : response_code_(-1) {
+    : first_header_index_(), response_code_(-1) {
   Parse(raw_input);
 
   // The most important thing to do with this histogram is find out
@@ -159,7 +201,7 @@ HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
 }
 
 HttpResponseHeaders::HttpResponseHeaders(base::PickleIterator* iter)
-    : response_code_(-1) {
+    : first_header_index_(), response_code_(-1) {
   std::string raw_input;
   if (iter->ReadString(&raw_input))
     Parse(raw_input);
@@ -394,12 +436,14 @@ void HttpResponseHeaders::UpdateWithNewRange(const HttpByteRange& byte_range,
 }
 
 void HttpResponseHeaders::Parse(const std::string& raw_input) {
+  DCHECK(parsed_.empty());
+  memset(first_header_index_, 0, sizeof(first_header_index_));
   raw_headers_.reserve(raw_input.size());
 
   // ParseStatusLine adds a normalized status line to raw_headers_
   std::string::const_iterator line_begin = raw_input.begin();
   std::string::const_iterator line_end =
-      std::find(line_begin, raw_input.end(), '\0');
+      FindChar(line_begin, raw_input.end(), '\0');
   // has_headers = true, if there is any data following the status line.
   // Used by ParseStatusLine() to decide if a HTTP/0.9 is really a HTTP/1.0.
   bool has_headers = (line_end != raw_input.end() &&
@@ -430,16 +474,35 @@ void HttpResponseHeaders::Parse(const std::string& raw_input) {
     raw_headers_.push_back('\0');
   }
 
-  // Adjust to point at the null byte following the status line
-  line_end = raw_headers_.begin() + status_line_len - 1;
+  // Split the header lines on their null terminators.  This accepts and
+  // trims the same lines HttpUtil::HeadersIterator does, but finds the line
+  // ends and colons with memchr() rather than a character at a time.
+  std::string::const_iterator headers_end = raw_headers_.end();
+  for (line_begin = raw_headers_.begin() + status_line_len;
+       line_begin != headers_end; line_begin = line_end + 1) {
+    line_end = FindChar(line_begin, headers_end, '\0');
+    DCHECK(line_end != headers_end);
+
+    std::string::const_iterator colon = FindChar(line_begin, line_end, ':');
+    // Skip empty and malformed lines.  A line starting with LWS would be a
+    // continuation, which HttpUtil::AssembleRawHeaders() should have joined.
+    if (colon == line_end || colon == line_begin ||
+        HttpUtil::IsLWS(*line_begin)) {
+      continue;
+    }
+
+    std::string::const_iterator name_begin = line_begin;
+    std::string::const_iterator name_end = colon;
+    HttpUtil::TrimLWS(&name_begin, &name_end);
+    if (!HttpUtil::IsToken(name_begin, name_end))
+      continue;
+
+    std::string::const_iterator values_begin = colon + 1;
+    std::string::const_iterator values_end = line_end;
+    HttpUtil::TrimLWS(&values_begin, &values_end);
 
-  HttpUtil::HeadersIterator headers(line_end + 1, raw_headers_.end(),
-                                    std::string(1, '\0'));
-  while (headers.GetNext()) {
-    AddHeader(headers.name_begin(),
-              headers.name_end(),
-              headers.values_begin(),
-              headers.values_end());
+    AddHeader(LookupHttpHeaderName(StringPiece(name_begin, name_end)),
+              name_begin, name_end, values_begin, values_end);
   }
 
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 2]);
@@ -580,15 +643,29 @@ bool HttpResponseHeaders::EnumerateHeaderLines(size_t* iter,
 bool HttpResponseHeaders::EnumerateHeader(size_t* iter,
                                           const base::StringPiece& name,
                                           std::string* value) const {
+  return EnumerateHeader(iter, LookupHttpHeaderName(name), name, value);
+}
+
+bool HttpResponseHeaders::EnumerateHeader(size_t* iter,
+                                          HttpHeaderName name,
+                                          std::string* value) const {
+  DCHECK_NE(HTTP_HEADER_UNKNOWN, name);
+  return EnumerateHeader(iter, name, StringPiece(), value);
+}
+
+bool HttpResponseHeaders::EnumerateHeader(size_t* iter,
+                                          HttpHeaderName name_id,
+                                          const base::StringPiece& name,
+                                          std::string* value) const {
   size_t i;
   if (!iter || !*iter) {
-    i = FindHeader(0, name);
+    i = FindHeader(0, name_id, name);
   } else {
     i = *iter;
     if (i >= parsed_.size()) {
       i = std::string::npos;
     } else if (!parsed_[i].is_continuation()) {
-      i = FindHeader(i, name);
+      i = FindHeader(i, name_id, name);
     }
   }
 
@@ -607,9 +684,10 @@ bool HttpResponseHeaders::HasHeaderValue(const base::StringPiece& name,
                                          const base::StringPiece& value) const {
   // The value has to be an exact match.  This is important since
   // 'cache-control: no-cache' != 'cache-control: no-cache="foo"'
+  HttpHeaderName name_id = LookupHttpHeaderName(name);
   size_t iter = 0;
   std::string temp;
-  while (EnumerateHeader(&iter, name, &temp)) {
+  while (EnumerateHeader(&iter, name_id, name, &temp)) {
     if (base::EqualsCaseInsensitiveASCII(value, temp))
       return true;
   }
@@ -620,7 +698,13 @@ bool HttpResponseHeaders::HasHeader(const base::StringPiece& name) const {
   return FindHeader(0, name) != std::string::npos;
 }
 
-HttpResponseHeaders::HttpResponseHeaders() : response_code_(-1) {
+bool HttpResponseHeaders::HasHeader(HttpHeaderName name) const {
+  DCHECK_NE(HTTP_HEADER_UNKNOWN, name);
+  return FindHeader(0, name, StringPiece()) != std::string::npos;
+}
+
+HttpResponseHeaders::HttpResponseHeaders()
+    : first_header_index_(), response_code_(-1) {
 }
 
 HttpResponseHeaders::~HttpResponseHeaders() {
@@ -745,9 +829,29 @@ void HttpResponseHeaders::ParseStatusLine(
 
 size_t HttpResponseHeaders::FindHeader(size_t from,
                                        const base::StringPiece& search) const {
+  return FindHeader(from, LookupHttpHeaderName(search), search);
+}
+
+size_t HttpResponseHeaders::FindHeader(size_t from,
+                                       HttpHeaderName search_id,
+                                       const base::StringPiece& search) const {
+  if (search_id != HTTP_HEADER_UNKNOWN) {
+    size_t first = first_header_index_[search_id];
+    if (!first)
+      return std::string::npos;
+    for (size_t i = std::max(from, first - 1); i < parsed_.size(); ++i) {
+      if (parsed_[i].name_id == search_id)
+        return i;
+    }
+    return std::string::npos;
+  }
+
+  // Interned names can't match |search|, so only compare it to the others.
   for (size_t i = from; i < parsed_.size(); ++i) {
-    if (parsed_[i].is_continuation())
+    if (parsed_[i].is_continuation() ||
+        parsed_[i].name_id != HTTP_HEADER_UNKNOWN) {
       continue;
+    }
     base::StringPiece name(parsed_[i].name_begin, parsed_[i].name_end);
     if (base::EqualsCaseInsensitiveASCII(search, name))
       return i;
@@ -781,29 +885,41 @@ bool HttpResponseHeaders::GetCacheControlDirective(const StringPiece& directive,
   return false;
 }
 
-void HttpResponseHeaders::AddHeader(std::string::const_iterator name_begin,
+void HttpResponseHeaders::AddHeader(HttpHeaderName name_id,
+                                    std::string::const_iterator name_begin,
                                     std::string::const_iterator name_end,
                                     std::string::const_iterator values_begin,
                                     std::string::const_iterator values_end) {
+  DCHECK_EQ(HttpUtil::IsNonCoalescingHeader(name_begin, name_end),
+            IsNonCoalescingHeader(name_id));
+
   // If the header can be coalesced, then we should split it up.
-  if (values_begin == values_end ||
-      HttpUtil::IsNonCoalescingHeader(name_begin, name_end)) {
-    AddToParsed(name_begin, name_end, values_begin, values_end);
+  if (values_begin == values_end || IsNonCoalescingHeader(name_id)) {
+    AddToParsed(name_id, name_begin, name_end, values_begin, values_end);
   } else {
     HttpUtil::ValuesIterator it(values_begin, values_end, ',');
     while (it.GetNext()) {
-      AddToParsed(name_begin, name_end, it.value_begin(), it.value_end());
+      AddToParsed(name_id, name_begin, name_end, it.value_begin(),
+                  it.value_end());
       // clobber these so that subsequent values are treated as continuations
+      name_id = HTTP_HEADER_UNKNOWN;
       name_begin = name_end = raw_headers_.end();
     }
   }
 }
 
-void HttpResponseHeaders::AddToParsed(std::string::const_iterator name_begin,
+void HttpResponseHeaders::AddToParsed(HttpHeaderName name_id,
+                                      std::string::const_iterator name_begin,
                                       std::string::const_iterator name_end,
                                       std::string::const_iterator value_begin,
                                       std::string::const_iterator value_end) {
+  if (name_id != HTTP_HEADER_UNKNOWN && !first_header_index_[name_id]) {
+    first_header_index_[name_id] = static_cast<uint16_t>(
+        std::min(parsed_.size() + 1, kMaxHeaderIndex));
+  }
+
   ParsedHeader header;
+  header.name_id = name_id;
   header.name_begin = name_begin;
   header.name_end = name_end;
   header.value_begin = value_begin;
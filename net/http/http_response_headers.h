@@ -16,6 +16,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
+#include "net/http/http_header_names.h"
 #include "net/http/http_version.h"
 #include "net/log/net_log.h"
 
@@ -199,6 +200,12 @@ class NET_EXPORT HttpResponseHeaders
                        const base::StringPiece& name,
                        std::string* value) const;
 
+  // Like above, but takes an interned header name, which saves looking it up.
+  // |name| must not be HTTP_HEADER_UNKNOWN.
+  bool EnumerateHeader(size_t* iter,
+                       HttpHeaderName name,
+                       std::string* value) const;
+
   // Returns true if the response contains the specified header-value pair.
   // Both name and value are compared case insensitively.
   bool HasHeaderValue(const base::StringPiece& name,
@@ -207,6 +214,7 @@ class NET_EXPORT HttpResponseHeaders
   // Returns true if the response contains the specified header.
   // The name is compared case insensitively.
   bool HasHeader(const base::StringPiece& name) const;
+  bool HasHeader(HttpHeaderName name) const;
 
   // Get the mime type and charset values in lower case form from the headers.
   // Empty strings are returned if the values are not present.
@@ -362,6 +370,19 @@ class NET_EXPORT HttpResponseHeaders
   // index |from|.  Returns string::npos if not found.
   size_t FindHeader(size_t from, const base::StringPiece& name) const;
 
+  // Same as above, with |name_id| being LookupHttpHeaderName(name). |name| is
+  // only used if |name_id| is HTTP_HEADER_UNKNOWN.
+  size_t FindHeader(size_t from,
+                    HttpHeaderName name_id,
+                    const base::StringPiece& name) const;
+
+  // Implements both public versions of EnumerateHeader(), with |name_id| and
+  // |name| as for FindHeader().
+  bool EnumerateHeader(size_t* iter,
+                       HttpHeaderName name_id,
+                       const base::StringPiece& name,
+                       std::string* value) const;
+
   // Search the Cache-Control header for a directive matching |directive|. If
   // present, treat its value as a time offset in seconds, write it to |result|,
   // and return true.
@@ -369,14 +390,16 @@ class NET_EXPORT HttpResponseHeaders
                                 base::TimeDelta* result) const;
 
   // Add a header->value pair to our list.  If we already have header in our
-  // list, append the value to it.
-  void AddHeader(std::string::const_iterator name_begin,
+  // list, append the value to it.  |name_id| is the interned header name.
+  void AddHeader(HttpHeaderName name_id,
+                 std::string::const_iterator name_begin,
                  std::string::const_iterator name_end,
                  std::string::const_iterator value_begin,
                  std::string::const_iterator value_end);
 
   // Add to parsed_ given the fields of a ParsedHeader object.
-  void AddToParsed(std::string::const_iterator name_begin,
+  void AddToParsed(HttpHeaderName name_id,
+                   std::string::const_iterator name_begin,
                    std::string::const_iterator name_end,
                    std::string::const_iterator value_begin,
                    std::string::const_iterator value_end);
@@ -413,6 +436,12 @@ class NET_EXPORT HttpResponseHeaders
   // header-value pairs within raw_headers_.
   HeaderList parsed_;
 
+  // For each interned header name, one more than the index in parsed_ of its
+  // first line, or 0 if there is none.  Indices too large to fit are clamped,
+  // so this is where to start looking for the header, not necessarily where
+  // it is.
+  uint16_t first_header_index_[HTTP_HEADER_NAME_COUNT];
+
   // The raw_headers_ consists of the normalized status line (terminated with a
   // null byte) and then followed by the raw null-terminated headers from the
   // input that was passed to our constructor.  We preserve the input [*] to
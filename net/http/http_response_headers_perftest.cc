@@ -0,0 +1,95 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_response_headers.h"
+
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "base/test/perf_time_logger.h"
+#include "net/http/http_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 100000;
+
+// A response like those of a large site serving a script from a CDN.
+const char kResponse[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Date: Tue, 04 Oct 2016 18:22:41 GMT\r\n"
+    "Content-Type: application/javascript; charset=utf-8\r\n"
+    "Content-Length: 184632\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: public, max-age=31536000, immutable\r\n"
+    "Expires: Wed, 04 Oct 2017 18:22:41 GMT\r\n"
+    "Last-Modified: Mon, 26 Sep 2016 09:14:02 GMT\r\n"
+    "ETag: \"5e8f3c1a-2d138\"\r\n"
+    "Vary: Accept-Encoding, Origin\r\n"
+    "Accept-Ranges: bytes\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Timing-Allow-Origin: *\r\n"
+    "Strict-Transport-Security: max-age=31536000; includeSubDomains\r\n"
+    "X-Content-Type-Options: nosniff\r\n"
+    "X-Frame-Options: SAMEORIGIN\r\n"
+    "X-XSS-Protection: 1; mode=block\r\n"
+    "Server: cdn-edge/2.4\r\n"
+    "Via: 1.1 varnish, 1.1 varnish\r\n"
+    "Age: 86112\r\n"
+    "X-Served-By: cache-sjc3120-SJC, cache-lhr6330-LHR\r\n"
+    "X-Cache: HIT, HIT\r\n"
+    "X-Cache-Hits: 14, 1032\r\n"
+    "X-Timer: S1475605361.123465,VS0,VE0\r\n"
+    "Set-Cookie: session=8f14e45fceea167a5a36dedd4bea2543; Path=/; Secure\r\n"
+    "Set-Cookie: region=eu; Path=/; Max-Age=3600\r\n"
+    "\r\n";
+
+TEST(HttpResponseHeadersPerfTest, ParseAndLookUp) {
+  const std::string response(kResponse);
+
+  {
+    base::PerfTimeLogger timer("HttpUtil_AssembleRawHeaders");
+    for (int i = 0; i < kIterations; ++i) {
+      std::string raw_headers =
+          HttpUtil::AssembleRawHeaders(response.data(), response.size());
+      ASSERT_FALSE(raw_headers.empty());
+    }
+    timer.Done();
+  }
+
+  const std::string raw_headers =
+      HttpUtil::AssembleRawHeaders(response.data(), response.size());
+  {
+    base::PerfTimeLogger timer("HttpResponseHeaders_Parse");
+    for (int i = 0; i < kIterations; ++i) {
+      scoped_refptr<HttpResponseHeaders> headers(
+          new HttpResponseHeaders(raw_headers));
+      ASSERT_EQ(200, headers->response_code());
+    }
+    timer.Done();
+  }
+
+  // The lookups HttpStreamParser and HttpCache make for every response.
+  scoped_refptr<HttpResponseHeaders> headers(
+      new HttpResponseHeaders(raw_headers));
+  {
+    base::PerfTimeLogger timer("HttpResponseHeaders_LookUp");
+    for (int i = 0; i < kIterations; ++i) {
+      ASSERT_FALSE(headers->IsChunkEncoded());
+      ASSERT_EQ(184632, headers->GetContentLength());
+      ASSERT_TRUE(headers->IsKeepAlive());
+      ASSERT_FALSE(headers->HasHeaderValue("cache-control", "no-store"));
+      ASSERT_FALSE(headers->HasHeader("content-disposition"));
+      ASSERT_FALSE(headers->HasHeader("x-unknown-header"));
+      ASSERT_TRUE(headers->HasStrongValidators());
+    }
+    timer.Done();
+  }
+}
+
+}  // namespace
+
+}  // namespace net
@@ -505,6 +505,61 @@ TEST(HttpResponseHeadersTest, EnumerateHeader_DateValued) {
   EXPECT_EQ("Wed, 01 Aug 2007 23:23:45 GMT", value);
 }
 
+TEST(HttpResponseHeadersTest, EnumerateHeader_InternedName) {
+  // Interned and other header names are interleaved, and looked up both ways.
+  std::string headers =
+      "HTTP/1.1 200 OK\n"
+      "X-Custom: a\n"
+      "Vary: accept-encoding, cookie\n"
+      "X-Custom-2: b\n"
+      "vary: origin\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(headers));
+
+  size_t iter = 0;
+  std::string value;
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, HTTP_HEADER_VARY, &value));
+  EXPECT_EQ("accept-encoding", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, HTTP_HEADER_VARY, &value));
+  EXPECT_EQ("cookie", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "VARY", &value));
+  EXPECT_EQ("origin", value);
+  EXPECT_FALSE(parsed->EnumerateHeader(&iter, HTTP_HEADER_VARY, &value));
+
+  EXPECT_TRUE(parsed->EnumerateHeader(NULL, "x-custom", &value));
+  EXPECT_EQ("a", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(NULL, "x-custom-2", &value));
+  EXPECT_EQ("b", value);
+  EXPECT_FALSE(parsed->HasHeader("x-custom-"));
+  EXPECT_TRUE(parsed->HasHeader(HTTP_HEADER_VARY));
+  EXPECT_FALSE(parsed->HasHeader(HTTP_HEADER_CONTENT_TYPE));
+  EXPECT_TRUE(parsed->HasHeaderValue("Vary", "COOKIE"));
+
+  parsed->RemoveHeader("vary");
+  EXPECT_FALSE(parsed->HasHeader(HTTP_HEADER_VARY));
+  parsed->AddHeader("Content-Type: text/html");
+  EXPECT_TRUE(parsed->HasHeader(HTTP_HEADER_CONTENT_TYPE));
+  EXPECT_TRUE(parsed->HasHeader("x-custom-2"));
+}
+
+TEST(HttpResponseHeadersTest, EnumerateHeader_ManyLines) {
+  // Headers past the end of the index of interned names are still found.
+  std::string headers = "HTTP/1.1 200 OK\n";
+  for (int i = 0; i < 70000; ++i)
+    headers += "X-Padding: x\n";
+  headers += "Vary: cookie\nX-Padding: x\nVary: origin\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(headers));
+
+  size_t iter = 0;
+  std::string value;
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "vary", &value));
+  EXPECT_EQ("cookie", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "vary", &value));
+  EXPECT_EQ("origin", value);
+  EXPECT_FALSE(parsed->EnumerateHeader(&iter, "vary", &value));
+}
+
 TEST(HttpResponseHeadersTest, DefaultDateToGMT) {
   // Verify we make the best interpretation when parsing dates that incorrectly
   // do not end in "GMT" as RFC2616 requires.
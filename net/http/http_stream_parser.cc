@@ -17,6 +17,7 @@
 #include "net/base/ip_endpoint.h"
 #include "net/base/upload_data_stream.h"
 #include "net/http/http_chunked_decoder.h"
+#include "net/http/http_header_names.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_request_info.h"
 #include "net/http/http_response_headers.h"
@@ -66,7 +67,7 @@ std::string GetResponseHeaderLines(const HttpResponseHeaders& headers) {
 // Return true if |headers| contain multiple |field_name| fields with different
 // values.
 bool HeadersContainMultipleCopiesOfField(const HttpResponseHeaders& headers,
-                                         const std::string& field_name) {
+                                         HttpHeaderName field_name) {
   size_t it = 0;
   std::string field_value;
   if (!headers.EnumerateHeader(&it, field_name, &field_value))
@@ -1018,15 +1019,19 @@ int HttpStreamParser::ParseResponseHeaders(int end_offset) {
   // chunked-encoded.  If they exist, and have distinct values, it's a potential
   // response smuggling attack.
   if (!headers->IsChunkEncoded()) {
-    if (HeadersContainMultipleCopiesOfField(*headers, "Content-Length"))
+    if (HeadersContainMultipleCopiesOfField(*headers,
+                                            HTTP_HEADER_CONTENT_LENGTH)) {
       return ERR_RESPONSE_HEADERS_MULTIPLE_CONTENT_LENGTH;
+    }
   }
 
   // Check for multiple Content-Disposition or Location headers.  If they exist,
   // it's also a potential response smuggling attack.
-  if (HeadersContainMultipleCopiesOfField(*headers, "Content-Disposition"))
+  if (HeadersContainMultipleCopiesOfField(*headers,
+                                          HTTP_HEADER_CONTENT_DISPOSITION)) {
     return ERR_RESPONSE_HEADERS_MULTIPLE_CONTENT_DISPOSITION;
-  if (HeadersContainMultipleCopiesOfField(*headers, "Location"))
+  }
+  if (HeadersContainMultipleCopiesOfField(*headers, HTTP_HEADER_LOCATION))
     return ERR_RESPONSE_HEADERS_MULTIPLE_LOCATION;
 
   response_->headers = headers;
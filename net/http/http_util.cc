@@ -7,6 +7,8 @@
 
 #include "net/http/http_util.h"
 
+#include <string.h>
+
 #include <algorithm>
 
 #include "base/logging.h"
@@ -640,12 +642,57 @@ static bool IsLineSegmentContinuable(const char* begin, const char* end) {
   return true;
 }
 
-// Helper used by AssembleRawHeaders, to find the end of the status line.
-static const char* FindStatusLineEnd(const char* begin, const char* end) {
-  size_t i = base::StringPiece(begin, end - begin).find_first_of("\r\n");
-  if (i == base::StringPiece::npos)
-    return end;
-  return begin + i;
+namespace {
+
+// Helper used by AssembleRawHeaders, to find the line breaks in a header
+// block.  It looks for CRs and LFs separately with memchr(), which is much
+// faster than checking each character against both, and remembers the next
+// of each, so that every character is looked at at most twice even if the
+// block only uses one of them.
+class LineBreakFinder {
+ public:
+  LineBreakFinder(const char* begin, const char* end)
+      : end_(end), next_cr_(Find(begin, '\r')), next_lf_(Find(begin, '\n')) {}
+
+  // Returns the first CR or LF at or after |pos|, or the end of the block.
+  const char* FindFrom(const char* pos) {
+    if (next_cr_ < pos)
+      next_cr_ = Find(pos, '\r');
+    if (next_lf_ < pos)
+      next_lf_ = Find(pos, '\n');
+    return std::min(next_cr_, next_lf_);
+  }
+
+ private:
+  const char* Find(const char* pos, char c) const {
+    const void* found = memchr(pos, c, end_ - pos);
+    return found ? static_cast<const char*>(found) : end_;
+  }
+
+  const char* const end_;
+  const char* next_cr_;
+  const char* next_lf_;
+
+  DISALLOW_COPY_AND_ASSIGN(LineBreakFinder);
+};
+
+}  // namespace
+
+// Helper used by AssembleRawHeaders, to append [begin, end) to |output|
+// without the nulls it contains.
+static void AppendWithoutNulls(const char* begin,
+                               const char* end,
+                               std::string* output) {
+  while (begin != end) {
+    const char* null =
+        static_cast<const char*>(memchr(begin, '\0', end - begin));
+    if (!null) {
+      output->append(begin, end);
+      return;
+    }
+    output->append(begin, null);
+    begin = null + 1;
+  }
 }
 
 // Helper used by AssembleRawHeaders, to skip past leading LWS.
@@ -670,48 +717,52 @@ std::string HttpUtil::AssembleRawHeaders(const char* input_begin,
   if (status_begin_offset != -1)
     input_begin += status_begin_offset;
 
+  // Use '\0' as the canonical line terminator. If the input already contains
+  // any embeded '\0' characters, they are stripped to avoid interpreting them
+  // as line breaks.
+  LineBreakFinder line_breaks(input_begin, input_end);
+
   // Copy the status line.
-  const char* status_line_end = FindStatusLineEnd(input_begin, input_end);
-  raw_headers.append(input_begin, status_line_end);
+  const char* status_line_end = line_breaks.FindFrom(input_begin);
+  AppendWithoutNulls(input_begin, status_line_end, &raw_headers);
 
   // After the status line, every subsequent line is a header line segment.
   // Should a segment start with LWS, it is a continuation of the previous
   // line's field-value.
 
-  // TODO(ericroman): is this too permissive? (delimits on [\r\n]+)
-  base::CStringTokenizer lines(status_line_end, input_end, "\r\n");
-
   // This variable is true when the previous line was continuable.
   bool prev_line_continuable = false;
 
-  while (lines.GetNext()) {
-    const char* line_begin = lines.token_begin();
-    const char* line_end = lines.token_end();
+  // TODO(ericroman): is this too permissive? (delimits on [\r\n]+)
+  const char* line_end = status_line_end;
+  while (true) {
+    const char* line_begin = line_end;
+    while (line_begin != input_end && (*line_begin == '\r' ||
+                                       *line_begin == '\n')) {
+      ++line_begin;
+    }
+    if (line_begin == input_end)
+      break;
+    line_end = line_breaks.FindFrom(line_begin);
 
     if (prev_line_continuable && IsLWS(*line_begin)) {
       // Join continuation; reduce the leading LWS to a single SP.
       raw_headers.push_back(' ');
-      raw_headers.append(FindFirstNonLWS(line_begin, line_end), line_end);
+      AppendWithoutNulls(FindFirstNonLWS(line_begin, line_end), line_end,
+                         &raw_headers);
     } else {
       // Terminate the previous line.
-      raw_headers.push_back('\n');
+      raw_headers.push_back('\0');
 
       // Copy the raw data to output.
-      raw_headers.append(line_begin, line_end);
+      AppendWithoutNulls(line_begin, line_end, &raw_headers);
 
       // Check if the current line can be continued.
       prev_line_continuable = IsLineSegmentContinuable(line_begin, line_end);
     }
   }
 
-  raw_headers.append("\n\n", 2);
-
-  // Use '\0' as the canonical line terminator. If the input already contained
-  // any embeded '\0' characters we will strip them first to avoid interpreting
-  // them as line breaks.
-  raw_headers.erase(std::remove(raw_headers.begin(), raw_headers.end(), '\0'),
-                    raw_headers.end());
-  std::replace(raw_headers.begin(), raw_headers.end(), '\n', '\0');
+  raw_headers.append(2, '\0');
 
   return raw_headers;
 }
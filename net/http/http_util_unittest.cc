@@ -679,6 +679,12 @@ TEST(HttpUtilTest, AssembleRawHeaders) {
       "HTTP/1.0 200 OK\nFoo: 1|Foo2: 3\nBar: 2\n\n",
       "HTTP/1.0 200 OK|Foo: 1Foo2: 3|Bar: 2||"
     },
+
+    // Lone CRs are line breaks too, mixed with LFs.
+    {
+      "HTTP/1.0 200 OK\rFoo: 1\r continuation\rBar: 2\n\rBaz: 3\r\r",
+      "HTTP/1.0 200 OK|Foo: 1 continuation|Bar: 2|Baz: 3||"
+    },
   };
   for (size_t i = 0; i < arraysize(tests); ++i) {
     std::string input = tests[i].input;
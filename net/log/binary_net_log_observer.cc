@@ -0,0 +1,496 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/log/binary_net_log_observer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/json/json_writer.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "net/log/net_log_util.h"
+
+namespace net {
+
+namespace {
+
+// The file starts with kMagic and the length-prefixed JSON of the constants,
+// followed by chunks of events. Each chunk is a uint32_t size followed by
+// that many bytes of events. The file may end with zeroes, which read as
+// empty chunks.
+//
+// Each event is:
+//   uint32_t sequence number
+//   int64_t  time, as a TimeTicks internal value
+//   uint32_t source id
+//   uint32_t source type
+//   uint32_t event type
+//   uint8_t  event phase
+//   the parameters as an encoded value, or kNoParameters.
+//
+// A value is its base::Value::Type as a uint8_t, followed by:
+//   TYPE_NULL:       nothing
+//   TYPE_BOOLEAN:    uint8_t
+//   TYPE_INTEGER:    int32_t
+//   TYPE_DOUBLE:     double
+//   TYPE_STRING:     uint32_t length and the UTF-8 bytes
+//   TYPE_BINARY:     uint32_t length and the bytes
+//   TYPE_DICTIONARY: uint32_t count, and that many length-prefixed keys each
+//                    followed by a value
+//   TYPE_LIST:       uint32_t count and that many values
+const char kMagic[] = {'N', 'e', 't', 'L', 'o', 'g', 'B', '1'};
+
+const uint8_t kNoParameters = 0xff;
+
+// A thread's buffer is written to the file once it holds this many bytes.
+const size_t kThreadBufferFlushSize = 64 * 1024;
+
+// Deeper values are rejected as malformed when reading.
+const int kMaxValueDepth = 100;
+
+template <typename T>
+void AppendPOD(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(base::StringPiece value, std::string* out) {
+  AppendPOD<uint32_t>(value.size(), out);
+  out->append(value.data(), value.size());
+}
+
+void AppendValue(const base::Value& value, std::string* out) {
+  AppendPOD<uint8_t>(value.GetType(), out);
+  switch (value.GetType()) {
+    case base::Value::TYPE_NULL:
+      break;
+    case base::Value::TYPE_BOOLEAN: {
+      bool boolean_value = false;
+      value.GetAsBoolean(&boolean_value);
+      AppendPOD<uint8_t>(boolean_value ? 1 : 0, out);
+      break;
+    }
+    case base::Value::TYPE_INTEGER: {
+      int integer_value = 0;
+      value.GetAsInteger(&integer_value);
+      AppendPOD<int32_t>(integer_value, out);
+      break;
+    }
+    case base::Value::TYPE_DOUBLE: {
+      double double_value = 0;
+      value.GetAsDouble(&double_value);
+      AppendPOD<double>(double_value, out);
+      break;
+    }
+    case base::Value::TYPE_STRING: {
+      const base::StringValue* string_value = nullptr;
+      value.GetAsString(&string_value);
+      AppendString(string_value->GetString(), out);
+      break;
+    }
+    case base::Value::TYPE_BINARY: {
+      const base::BinaryValue* binary_value = nullptr;
+      value.GetAsBinary(&binary_value);
+      AppendString(base::StringPiece(binary_value->GetBuffer(),
+                                     binary_value->GetSize()),
+                   out);
+      break;
+    }
+    case base::Value::TYPE_DICTIONARY: {
+      const base::DictionaryValue* dict = nullptr;
+      value.GetAsDictionary(&dict);
+      AppendPOD<uint32_t>(dict->size(), out);
+      for (base::DictionaryValue::Iterator it(*dict); !it.IsAtEnd();
+           it.Advance()) {
+        AppendString(it.key(), out);
+        AppendValue(it.value(), out);
+      }
+      break;
+    }
+    case base::Value::TYPE_LIST: {
+      const base::ListValue* list = nullptr;
+      value.GetAsList(&list);
+      AppendPOD<uint32_t>(list->GetSize(), out);
+      for (const auto& element : *list)
+        AppendValue(*element, out);
+      break;
+    }
+  }
+}
+
+// Reads the data written by the functions above.
+class BinaryReader {
+ public:
+  explicit BinaryReader(base::StringPiece data) : data_(data) {}
+
+  size_t remaining() const { return data_.size(); }
+
+  template <typename T>
+  bool ReadPOD(T* value) {
+    if (data_.size() < sizeof(T))
+      return false;
+    memcpy(value, data_.data(), sizeof(T));
+    data_.remove_prefix(sizeof(T));
+    return true;
+  }
+
+  bool ReadBytes(size_t size, base::StringPiece* value) {
+    if (data_.size() < size)
+      return false;
+    *value = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  bool ReadString(base::StringPiece* value) {
+    uint32_t length;
+    return ReadPOD(&length) && ReadBytes(length, value);
+  }
+
+  // Reads a value, or nothing if the tag is kNoParameters and
+  // |allow_no_value| is true.
+  bool ReadValue(bool allow_no_value,
+                 int depth,
+                 std::unique_ptr<base::Value>* value) {
+    uint8_t type;
+    if (depth > kMaxValueDepth || !ReadPOD(&type))
+      return false;
+
+    base::StringPiece string_value;
+    uint32_t count;
+    switch (type) {
+      case kNoParameters:
+        value->reset();
+        return allow_no_value;
+      case base::Value::TYPE_NULL:
+        *value = base::Value::CreateNullValue();
+        return true;
+      case base::Value::TYPE_BOOLEAN: {
+        uint8_t boolean_value;
+        if (!ReadPOD(&boolean_value))
+          return false;
+        value->reset(new base::FundamentalValue(boolean_value != 0));
+        return true;
+      }
+      case base::Value::TYPE_INTEGER: {
+        int32_t integer_value;
+        if (!ReadPOD(&integer_value))
+          return false;
+        value->reset(new base::FundamentalValue(integer_value));
+        return true;
+      }
+      case base::Value::TYPE_DOUBLE: {
+        double double_value;
+        if (!ReadPOD(&double_value))
+          return false;
+        value->reset(new base::FundamentalValue(double_value));
+        return true;
+      }
+      case base::Value::TYPE_STRING:
+        if (!ReadString(&string_value))
+          return false;
+        value->reset(new base::StringValue(string_value.as_string()));
+        return true;
+      case base::Value::TYPE_BINARY:
+        if (!ReadString(&string_value))
+          return false;
+        *value = base::BinaryValue::CreateWithCopiedBuffer(
+            string_value.data(), string_value.size());
+        return true;
+      case base::Value::TYPE_DICTIONARY: {
+        if (!ReadPOD(&count))
+          return false;
+        std::unique_ptr<base::DictionaryValue> dict(
+            new base::DictionaryValue());
+        for (uint32_t i = 0; i < count; ++i) {
+          std::unique_ptr<base::Value> element;
+          if (!ReadString(&string_value) ||
+              !ReadValue(false, depth + 1, &element)) {
+            return false;
+          }
+          dict->SetWithoutPathExpansion(string_value.as_string(),
+                                        std::move(element));
+        }
+        *value = std::move(dict);
+        return true;
+      }
+      case base::Value::TYPE_LIST: {
+        if (!ReadPOD(&count))
+          return false;
+        std::unique_ptr<base::ListValue> list(new base::ListValue());
+        for (uint32_t i = 0; i < count; ++i) {
+          std::unique_ptr<base::Value> element;
+          if (!ReadValue(false, depth + 1, &element))
+            return false;
+          list->Append(std::move(element));
+        }
+        *value = std::move(list);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  base::StringPiece data_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryReader);
+};
+
+// Reads an event and adds its JSON, in the format of NetLog::Entry::ToValue(),
+// to |events| by sequence number.
+bool ReadEvent(BinaryReader* reader, std::map<uint32_t, std::string>* events) {
+  uint32_t sequence_number;
+  int64_t time;
+  uint32_t source_id;
+  uint32_t source_type;
+  uint32_t type;
+  uint8_t phase;
+  std::unique_ptr<base::Value> params;
+  if (!reader->ReadPOD(&sequence_number) || !reader->ReadPOD(&time) ||
+      !reader->ReadPOD(&source_id) || !reader->ReadPOD(&source_type) ||
+      !reader->ReadPOD(&type) || !reader->ReadPOD(&phase) ||
+      !reader->ReadValue(true, 0, &params)) {
+    return false;
+  }
+
+  base::DictionaryValue entry_dict;
+  entry_dict.SetString("time", NetLog::TickCountToString(
+                                   base::TimeTicks::FromInternalValue(time)));
+  std::unique_ptr<base::DictionaryValue> source_dict(
+      new base::DictionaryValue());
+  source_dict->SetInteger("id", source_id);
+  source_dict->SetInteger("type", source_type);
+  entry_dict.Set("source", std::move(source_dict));
+  entry_dict.SetInteger("type", type);
+  entry_dict.SetInteger("phase", phase);
+  if (params)
+    entry_dict.Set("params", std::move(params));
+
+  return base::JSONWriter::Write(entry_dict, &(*events)[sequence_number]);
+}
+
+}  // namespace
+
+// Copies chunks of events to the memory-mapped log file. Lives on the file
+// task runner.
+class BinaryNetLogObserver::FileWriter {
+ public:
+  FileWriter() : offset_(0) {}
+  ~FileWriter() {}
+
+  // Creates the file, of at most |max_file_size| bytes, and writes its
+  // header. If that fails, all events are dropped.
+  void Initialize(const base::FilePath& log_path,
+                  size_t max_file_size,
+                  const std::string& constants_json) {
+    log_path_ = log_path;
+    base::File file(log_path, base::File::FLAG_CREATE_ALWAYS |
+                                  base::File::FLAG_READ |
+                                  base::File::FLAG_WRITE);
+    if (!file.IsValid()) {
+      LOG(ERROR) << "Unable to create NetLog file " << log_path.value();
+      return;
+    }
+    std::string header(kMagic, sizeof(kMagic));
+    AppendString(constants_json, &header);
+    if (header.size() > max_file_size)
+      return;
+
+    mapped_file_.reset(new base::MemoryMappedFile());
+    base::MemoryMappedFile::Region region = {
+        0, static_cast<int64_t>(max_file_size)};
+    if (!mapped_file_->Initialize(std::move(file), region,
+                                  base::MemoryMappedFile::READ_WRITE_EXTEND)) {
+      LOG(ERROR) << "Unable to map NetLog file " << log_path.value();
+      mapped_file_.reset();
+      return;
+    }
+    memcpy(mapped_file_->data(), header.data(), header.size());
+    offset_ = header.size();
+  }
+
+  // Appends a chunk of |events|, unless the file is full.
+  void AppendChunk(std::unique_ptr<std::string> events) {
+    uint32_t size = events->size();
+    if (!mapped_file_ ||
+        mapped_file_->length() - offset_ < sizeof(size) + size) {
+      return;
+    }
+    // Write the size last, so that a chunk cut short by a crash reads as the
+    // end of the log.
+    uint8_t* chunk = mapped_file_->data() + offset_;
+    memcpy(chunk + sizeof(size), events->data(), size);
+    memcpy(chunk, &size, sizeof(size));
+    offset_ += sizeof(size) + size;
+  }
+
+  // Unmaps the file and truncates it to the data written.
+  void Finish() {
+    if (!mapped_file_)
+      return;
+    mapped_file_.reset();
+    base::File file(log_path_, base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    if (!file.IsValid() || !file.SetLength(offset_))
+      LOG(ERROR) << "Unable to truncate NetLog file " << log_path_.value();
+  }
+
+ private:
+  base::FilePath log_path_;
+  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
+
+  // Where the next chunk goes in |mapped_file_|.
+  size_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileWriter);
+};
+
+BinaryNetLogObserver::ThreadBuffer::ThreadBuffer() {}
+
+BinaryNetLogObserver::ThreadBuffer::~ThreadBuffer() {}
+
+BinaryNetLogObserver::BinaryNetLogObserver(
+    scoped_refptr<base::SequencedTaskRunner> file_task_runner)
+    : file_task_runner_(std::move(file_task_runner)),
+      capture_mode_(NetLogCaptureMode::Default()) {}
+
+BinaryNetLogObserver::~BinaryNetLogObserver() {
+  DCHECK(!file_writer_);
+}
+
+void BinaryNetLogObserver::set_capture_mode(NetLogCaptureMode capture_mode) {
+  DCHECK(!net_log());
+  capture_mode_ = capture_mode;
+}
+
+void BinaryNetLogObserver::StartObserving(NetLog* net_log,
+                                          const base::FilePath& log_path,
+                                          size_t max_file_size,
+                                          base::Value* constants) {
+  DCHECK(!file_writer_);
+
+  std::string constants_json;
+  if (constants)
+    base::JSONWriter::Write(*constants, &constants_json);
+  else
+    base::JSONWriter::Write(*GetNetConstants(), &constants_json);
+
+  // |file_writer_| is only deleted by a task posted after all the tasks that
+  // use it, in StopObserving().
+  file_writer_.reset(new FileWriter());
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&FileWriter::Initialize, base::Unretained(file_writer_.get()),
+                 log_path, max_file_size, constants_json));
+
+  net_log->DeprecatedAddObserver(this, capture_mode_);
+}
+
+void BinaryNetLogObserver::StopObserving(const base::Closure& callback) {
+  net_log()->DeprecatedRemoveObserver(this);
+
+  // No thread can be adding an event anymore, and the NetLog's lock makes the
+  // events they added visible here.
+  {
+    base::AutoLock lock(thread_buffers_lock_);
+    for (const auto& buffer : thread_buffers_)
+      FlushBuffer(buffer.get());
+  }
+
+  file_task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&FileWriter::Finish, base::Owned(file_writer_.release())),
+      callback);
+}
+
+void BinaryNetLogObserver::OnAddEntry(const NetLog::Entry& entry) {
+  ThreadBuffer* buffer = thread_buffer_.Get();
+  if (!buffer) {
+    buffer = new ThreadBuffer();
+    {
+      base::AutoLock lock(thread_buffers_lock_);
+      thread_buffers_.push_back(base::WrapUnique(buffer));
+    }
+    thread_buffer_.Set(buffer);
+  }
+
+  std::string* events = &buffer->events;
+  AppendPOD<uint32_t>(next_sequence_number_.GetNext(), events);
+  AppendPOD<int64_t>(entry.time().ToInternalValue(), events);
+  AppendPOD<uint32_t>(entry.source().id, events);
+  AppendPOD<uint32_t>(entry.source().type, events);
+  AppendPOD<uint32_t>(entry.type(), events);
+  AppendPOD<uint8_t>(entry.phase(), events);
+  std::unique_ptr<base::Value> params(entry.ParametersToValue());
+  if (params)
+    AppendValue(*params, events);
+  else
+    AppendPOD<uint8_t>(kNoParameters, events);
+
+  if (events->size() >= kThreadBufferFlushSize)
+    FlushBuffer(buffer);
+}
+
+void BinaryNetLogObserver::FlushBuffer(ThreadBuffer* buffer) {
+  if (buffer->events.empty())
+    return;
+  std::unique_ptr<std::string> events(new std::string());
+  events->swap(buffer->events);
+  buffer->events.reserve(kThreadBufferFlushSize);
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&FileWriter::AppendChunk,
+                 base::Unretained(file_writer_.get()), base::Passed(&events)));
+}
+
+bool ConvertBinaryNetLogToJSON(base::StringPiece binary_log,
+                               std::string* json) {
+  BinaryReader reader(binary_log);
+  char magic[sizeof(kMagic)];
+  base::StringPiece constants_json;
+  if (!reader.ReadPOD(&magic) || memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !reader.ReadString(&constants_json)) {
+    return false;
+  }
+
+  std::map<uint32_t, std::string> events;
+  uint32_t size;
+  base::StringPiece chunk;
+  // An empty or incomplete chunk marks the end of the log.
+  while (reader.ReadPOD(&size) && size > 0 && reader.ReadBytes(size, &chunk)) {
+    BinaryReader chunk_reader(chunk);
+    while (chunk_reader.remaining() > 0) {
+      if (!ReadEvent(&chunk_reader, &events))
+        return false;
+    }
+  }
+
+  // Match the layout written by WriteToFileNetLogObserver.
+  json->assign("{\"constants\": ");
+  json->append(constants_json.data(), constants_json.size());
+  json->append(",\n\"events\": [\n");
+  bool first_event = true;
+  for (const auto& event : events) {
+    if (!first_event)
+      json->append(",\n");
+    json->append(event.second);
+    first_event = false;
+  }
+  json->append("]}");
+  return true;
+}
+
+}  // namespace net
@@ -0,0 +1,123 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_LOG_BINARY_NET_LOG_OBSERVER_H_
+#define NET_LOG_BINARY_NET_LOG_OBSERVER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/atomic_sequence_num.h"
+#include "base/callback_forward.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local.h"
+#include "net/base/net_export.h"
+#include "net/log/net_log.h"
+
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+class Value;
+}
+
+namespace net {
+
+// BinaryNetLogObserver watches the NetLog event stream and writes all entries
+// to a file in a compact binary format, which ConvertBinaryNetLogToJSON()
+// turns into the JSON written by WriteToFileNetLogObserver.
+//
+// WriteToFileNetLogObserver serializes each event to JSON and writes it to
+// its file on the thread that added the event. This observer only encodes
+// the event into a buffer belonging to that thread. Full buffers are copied
+// to a memory-mapped file on |file_task_runner|, so the threads adding events
+// never wait on file I/O.
+//
+// The file is written in the byte order of the machine that wrote it, and
+// must be converted on a machine with the same byte order.
+class NET_EXPORT BinaryNetLogObserver : public NetLog::ThreadSafeObserver {
+ public:
+  // All file operations are done on |file_task_runner|.
+  explicit BinaryNetLogObserver(
+      scoped_refptr<base::SequencedTaskRunner> file_task_runner);
+  ~BinaryNetLogObserver() override;
+
+  // Sets the capture mode to log at. Must be called before StartObserving.
+  void set_capture_mode(NetLogCaptureMode capture_mode);
+
+  // Starts observing |net_log| and writes output to a new file at |log_path|.
+  // The file is at most |max_file_size| bytes long; events that don't fit are
+  // dropped. Must not already be watching a NetLog.
+  //
+  // |constants| is an optional legend for decoding constant values used in the
+  // log.  It should generally be a modified version of GetNetConstants().  If
+  // not present, the output of GetNetConstants() will be used.
+  void StartObserving(NetLog* net_log,
+                      const base::FilePath& log_path,
+                      size_t max_file_size,
+                      base::Value* constants);
+
+  // Stops observing net_log(). Must already be watching. Must be called
+  // before destruction of the BinaryNetLogObserver and the NetLog.
+  //
+  // The events still buffered are written to the file, and |callback| is run
+  // on the calling thread once the file is complete.
+  void StopObserving(const base::Closure& callback);
+
+  // net::NetLog::ThreadSafeObserver implementation:
+  void OnAddEntry(const NetLog::Entry& entry) override;
+
+ private:
+  class FileWriter;
+
+  // Events encoded by one thread that have not been passed to |file_writer_|
+  // yet.
+  struct ThreadBuffer {
+    ThreadBuffer();
+    ~ThreadBuffer();
+
+    std::string events;
+  };
+
+  // Passes the events in |buffer| to |file_writer_|, leaving |buffer| empty.
+  void FlushBuffer(ThreadBuffer* buffer);
+
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+
+  // The capture mode to log at.
+  NetLogCaptureMode capture_mode_;
+
+  // Lives on |file_task_runner_| while observing.
+  std::unique_ptr<FileWriter> file_writer_;
+
+  // Orders events across threads. The converter sorts events by it.
+  base::AtomicSequenceNumber next_sequence_number_;
+
+  // The buffer of the current thread, owned by |thread_buffers_|.
+  base::ThreadLocalPointer<ThreadBuffer> thread_buffer_;
+
+  // Every thread's buffer. Buffers are only touched by their thread while
+  // observing, and are kept until destruction since other threads may still
+  // point to them. |thread_buffers_lock_| is only needed to add a buffer.
+  base::Lock thread_buffers_lock_;
+  std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryNetLogObserver);
+};
+
+// Converts a log written by BinaryNetLogObserver to the JSON format written by
+// WriteToFileNetLogObserver, with the events in the order they were added.
+// A log that was cut short, for instance by a crash, is converted up to its
+// last complete chunk of events. Returns false if |binary_log| is malformed.
+NET_EXPORT bool ConvertBinaryNetLogToJSON(base::StringPiece binary_log,
+                                          std::string* json);
+
+}  // namespace net
+
+#endif  // NET_LOG_BINARY_NET_LOG_OBSERVER_H_
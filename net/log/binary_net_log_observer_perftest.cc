@@ -0,0 +1,98 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/log/binary_net_log_observer.h"
+
+#include <string>
+#include <utility>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "net/log/net_log.h"
+#include "net/log/write_to_file_net_log_observer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumEvents = 200000;
+const size_t kMaxFileSize = 256 * 1024 * 1024;
+
+const char kUrl[] =
+    "https://www.example.com/some/path/to/a/resource?with=a&query=string";
+
+class NetLogObserverPerfTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    log_path_ = temp_dir_.path().AppendASCII("NetLogFile");
+    ASSERT_TRUE(file_thread_.Start());
+  }
+
+ protected:
+  NetLogObserverPerfTest() : file_thread_("NetLogFileThread") {}
+
+  // Adds kNumEvents events with a small parameter dictionary, as most
+  // events have, and logs the time spent per event by the adding thread.
+  void AddEvents(const std::string& name) {
+    base::PerfTimeLogger timer(
+        base::StringPrintf("NetLog_add_%d_events_%s", kNumEvents, name.c_str())
+            .c_str());
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kNumEvents; ++i) {
+      net_log_.AddGlobalEntry(NetLog::TYPE_REQUEST_ALIVE,
+                              NetLog::StringCallback("url", kUrl));
+    }
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    timer.Done();
+    LOG(INFO) << name << ": "
+              << elapsed.InMicroseconds() * 1000.0 / kNumEvents
+              << " ns per event";
+  }
+
+  base::MessageLoopForIO message_loop_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath log_path_;
+  base::Thread file_thread_;
+  NetLog net_log_;
+};
+
+TEST_F(NetLogObserverPerfTest, WriteToFile) {
+  base::ScopedFILE file(base::OpenFile(log_path_, "w"));
+  ASSERT_TRUE(file);
+  base::DictionaryValue constants;
+  WriteToFileNetLogObserver logger;
+  logger.StartObserving(&net_log_, std::move(file), &constants, nullptr);
+  AddEvents("write_to_file");
+  logger.StopObserving(nullptr);
+}
+
+TEST_F(NetLogObserverPerfTest, Binary) {
+  base::DictionaryValue constants;
+  BinaryNetLogObserver logger(file_thread_.task_runner());
+  logger.StartObserving(&net_log_, log_path_, kMaxFileSize, &constants);
+  AddEvents("binary");
+  base::RunLoop run_loop;
+  logger.StopObserving(run_loop.QuitClosure());
+  run_loop.Run();
+
+  int64_t file_size;
+  ASSERT_TRUE(base::GetFileSize(log_path_, &file_size));
+  LOG(INFO) << "binary: " << file_size / kNumEvents << " bytes per event";
+}
+
+}  // namespace
+
+}  // namespace net
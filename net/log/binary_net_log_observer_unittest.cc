@@ -0,0 +1,251 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/log/binary_net_log_observer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/values.h"
+#include "net/log/net_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const size_t kMaxFileSize = 1024 * 1024;
+
+// Returns parameters with a value of each type.
+std::unique_ptr<base::Value> AllTypesCallback(NetLogCaptureMode capture_mode) {
+  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue());
+  dict->Set("null", base::Value::CreateNullValue());
+  dict->SetBoolean("bool", true);
+  dict->SetInteger("int", -42);
+  dict->SetDouble("double", 0.5);
+  dict->SetString("string", "value");
+  std::unique_ptr<base::ListValue> list(new base::ListValue());
+  list->AppendInteger(1);
+  list->AppendString("two");
+  std::unique_ptr<base::DictionaryValue> nested(new base::DictionaryValue());
+  nested->SetString("key", "nested value");
+  list->Append(std::move(nested));
+  dict->Set("list", std::move(list));
+  return std::move(dict);
+}
+
+class BinaryNetLogObserverTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    log_path_ = temp_dir_.path().AppendASCII("NetLogFile");
+  }
+
+ protected:
+  std::unique_ptr<BinaryNetLogObserver> CreateObserver() {
+    return std::unique_ptr<BinaryNetLogObserver>(
+        new BinaryNetLogObserver(base::ThreadTaskRunnerHandle::Get()));
+  }
+
+  // Stops |logger| and waits for its file to be complete.
+  void StopObserving(BinaryNetLogObserver* logger) {
+    base::RunLoop run_loop;
+    logger->StopObserving(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  // Reads and converts the log, and returns its dictionary.
+  std::unique_ptr<base::DictionaryValue> ReadLog() {
+    std::string binary_log;
+    EXPECT_TRUE(base::ReadFileToString(log_path_, &binary_log));
+    std::string json;
+    EXPECT_TRUE(ConvertBinaryNetLogToJSON(binary_log, &json));
+    return ParseJSON(json);
+  }
+
+  std::unique_ptr<base::DictionaryValue> ParseJSON(const std::string& json) {
+    base::JSONReader reader;
+    std::unique_ptr<base::Value> root(reader.ReadToValue(json));
+    EXPECT_TRUE(root) << reader.GetErrorMessage();
+    return base::DictionaryValue::From(std::move(root));
+  }
+
+  base::MessageLoopForIO message_loop_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath log_path_;
+  NetLog net_log_;
+};
+
+TEST_F(BinaryNetLogObserverTest, GeneratesValidJSONForNoEvents) {
+  std::unique_ptr<BinaryNetLogObserver> logger = CreateObserver();
+  logger->StartObserving(&net_log_, log_path_, kMaxFileSize, nullptr);
+  StopObserving(logger.get());
+  logger.reset();
+
+  std::unique_ptr<base::DictionaryValue> dict = ReadLog();
+  ASSERT_TRUE(dict);
+  base::ListValue* events;
+  ASSERT_TRUE(dict->GetList("events", &events));
+  EXPECT_EQ(0u, events->GetSize());
+  base::DictionaryValue* constants;
+  EXPECT_TRUE(dict->GetDictionary("constants", &constants));
+}
+
+TEST_F(BinaryNetLogObserverTest, CustomConstants) {
+  const char kConstantString[] = "awesome constant";
+  base::StringValue constants(kConstantString);
+  std::unique_ptr<BinaryNetLogObserver> logger = CreateObserver();
+  logger->StartObserving(&net_log_, log_path_, kMaxFileSize, &constants);
+  StopObserving(logger.get());
+  logger.reset();
+
+  std::unique_ptr<base::DictionaryValue> dict = ReadLog();
+  ASSERT_TRUE(dict);
+  std::string constants_string;
+  ASSERT_TRUE(dict->GetString("constants", &constants_string));
+  EXPECT_EQ(kConstantString, constants_string);
+}
+
+// The converted events must match the JSON that WriteToFileNetLogObserver
+// writes for them.
+TEST_F(BinaryNetLogObserverTest, EventsMatchEntryToValue) {
+  std::unique_ptr<BinaryNetLogObserver> logger = CreateObserver();
+  logger->set_capture_mode(NetLogCaptureMode::IncludeSocketBytes());
+  logger->StartObserving(&net_log_, log_path_, kMaxFileSize, nullptr);
+
+  const int kDummyId = 1;
+  NetLog::Source source(NetLog::SOURCE_HTTP2_SESSION, kDummyId);
+  NetLog::ParametersCallback callback = base::Bind(&AllTypesCallback);
+  NetLog::EntryData entry_data(NetLog::TYPE_PROXY_SERVICE, source,
+                               NetLog::PHASE_BEGIN, base::TimeTicks::Now(),
+                               &callback);
+  NetLog::Entry entry(&entry_data, NetLogCaptureMode::IncludeSocketBytes());
+  NetLog::EntryData no_params_data(NetLog::TYPE_PROXY_SERVICE, source,
+                                   NetLog::PHASE_END, base::TimeTicks::Now(),
+                                   nullptr);
+  NetLog::Entry no_params_entry(&no_params_data,
+                                NetLogCaptureMode::IncludeSocketBytes());
+  logger->OnAddEntry(entry);
+  logger->OnAddEntry(no_params_entry);
+  StopObserving(logger.get());
+  logger.reset();
+
+  std::unique_ptr<base::DictionaryValue> dict = ReadLog();
+  ASSERT_TRUE(dict);
+  base::ListValue* events;
+  ASSERT_TRUE(dict->GetList("events", &events));
+  ASSERT_EQ(2u, events->GetSize());
+  base::Value* event;
+  ASSERT_TRUE(events->Get(0, &event));
+  EXPECT_TRUE(entry.ToValue()->Equals(event));
+  ASSERT_TRUE(events->Get(1, &event));
+  EXPECT_TRUE(no_params_entry.ToValue()->Equals(event));
+}
+
+// Events added on different threads are converted in the order they were
+// added.
+TEST_F(BinaryNetLogObserverTest, EventsFromMultipleThreads) {
+  std::unique_ptr<BinaryNetLogObserver> logger = CreateObserver();
+  logger->StartObserving(&net_log_, log_path_, kMaxFileSize, nullptr);
+
+  base::Thread thread("BinaryNetLogObserverTest");
+  ASSERT_TRUE(thread.Start());
+  net_log_.AddGlobalEntry(NetLog::TYPE_CANCELLED);
+  {
+    base::RunLoop run_loop;
+    thread.task_runner()->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(static_cast<void (NetLog::*)(NetLog::EventType)>(
+                       &NetLog::AddGlobalEntry),
+                   base::Unretained(&net_log_), NetLog::TYPE_REQUEST_ALIVE),
+        run_loop.QuitClosure());
+    run_loop.Run();
+  }
+  net_log_.AddGlobalEntry(NetLog::TYPE_FAILED);
+  StopObserving(logger.get());
+  logger.reset();
+  thread.Stop();
+
+  std::unique_ptr<base::DictionaryValue> dict = ReadLog();
+  ASSERT_TRUE(dict);
+  base::ListValue* events;
+  ASSERT_TRUE(dict->GetList("events", &events));
+  ASSERT_EQ(3u, events->GetSize());
+  const NetLog::EventType kExpectedTypes[] = {NetLog::TYPE_CANCELLED,
+                                              NetLog::TYPE_REQUEST_ALIVE,
+                                              NetLog::TYPE_FAILED};
+  for (size_t i = 0; i < arraysize(kExpectedTypes); ++i) {
+    base::DictionaryValue* event;
+    ASSERT_TRUE(events->GetDictionary(i, &event));
+    int type;
+    ASSERT_TRUE(event->GetInteger("type", &type));
+    EXPECT_EQ(kExpectedTypes[i], type);
+  }
+}
+
+// Events that don't fit in the file are dropped, and the file stays valid.
+TEST_F(BinaryNetLogObserverTest, DropsEventsPastMaxFileSize) {
+  base::StringValue constants("");
+  std::unique_ptr<BinaryNetLogObserver> logger = CreateObserver();
+  logger->StartObserving(&net_log_, log_path_, 256, &constants);
+  for (int i = 0; i < 100; ++i)
+    net_log_.AddGlobalEntry(NetLog::TYPE_CANCELLED);
+  StopObserving(logger.get());
+  logger.reset();
+
+  int64_t file_size;
+  ASSERT_TRUE(base::GetFileSize(log_path_, &file_size));
+  EXPECT_GE(256, file_size);
+
+  std::unique_ptr<base::DictionaryValue> dict = ReadLog();
+  ASSERT_TRUE(dict);
+  base::ListValue* events;
+  ASSERT_TRUE(dict->GetList("events", &events));
+  EXPECT_EQ(0u, events->GetSize());
+}
+
+// A log cut short is converted up to its last complete chunk.
+TEST_F(BinaryNetLogObserverTest, ConvertsTruncatedLog) {
+  std::unique_ptr<BinaryNetLogObserver> logger = CreateObserver();
+  logger->StartObserving(&net_log_, log_path_, kMaxFileSize, nullptr);
+  // Enough events to fill more than one chunk.
+  const int kNumEvents = 5000;
+  for (int i = 0; i < kNumEvents; ++i)
+    net_log_.AddGlobalEntry(NetLog::TYPE_CANCELLED);
+  StopObserving(logger.get());
+  logger.reset();
+
+  std::string binary_log;
+  ASSERT_TRUE(base::ReadFileToString(log_path_, &binary_log));
+  binary_log.resize(binary_log.size() - 1);
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryNetLogToJSON(binary_log, &json));
+
+  std::unique_ptr<base::DictionaryValue> dict = ParseJSON(json);
+  ASSERT_TRUE(dict);
+  base::ListValue* events;
+  ASSERT_TRUE(dict->GetList("events", &events));
+  EXPECT_LT(0u, events->GetSize());
+  EXPECT_GT(static_cast<size_t>(kNumEvents), events->GetSize());
+}
+
+TEST_F(BinaryNetLogObserverTest, RejectsMalformedLog) {
+  std::string json;
+  EXPECT_FALSE(ConvertBinaryNetLogToJSON("", &json));
+  EXPECT_FALSE(ConvertBinaryNetLogToJSON("{\"constants\": {}}", &json));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -811,6 +811,13 @@ EVENT_TYPE(SOCKET_POOL_BOUND_TO_SOCKET)
 //   }
 EVENT_TYPE(SOCKET_POOL_CONNECTING_N_SOCKETS)
 
+// Added to a socket pool request for a group the pool keeps idle sockets
+// connected for. The event parameters are:
+//   {
+//      "hit": <Whether the request was given an already connected socket>,
+//   }
+EVENT_TYPE(SOCKET_POOL_PREWARM_RESULT)
+
 // ------------------------------------------------------------------------
 // URLRequest
 // ------------------------------------------------------------------------
@@ -375,13 +375,15 @@ class BidirectionalStreamQuicImplTest
     helper_.reset(
         new QuicChromiumConnectionHelper(&clock_, &random_generator_));
     alarm_factory_.reset(new QuicChromiumAlarmFactory(runner_.get(), &clock_));
+    QuicChromiumPacketWriter* writer =
+        new QuicChromiumPacketWriter(socket.get());
     connection_ = new QuicConnection(
-        connection_id_, peer_addr_, helper_.get(), alarm_factory_.get(),
-        new QuicChromiumPacketWriter(socket.get()), true /* owns_writer */,
-        Perspective::IS_CLIENT, SupportedVersions(GetParam()));
+        connection_id_, peer_addr_, helper_.get(), alarm_factory_.get(), writer,
+        true /* owns_writer */, Perspective::IS_CLIENT,
+        SupportedVersions(GetParam()));
 
     session_.reset(new QuicChromiumClientSession(
-        connection_, std::move(socket),
+        connection_, std::move(socket), writer,
         /*stream_factory=*/nullptr, &crypto_client_stream_factory_, &clock_,
         &transport_security_state_,
         base::WrapUnique(static_cast<QuicServerInfo*>(nullptr)),
@@ -203,6 +203,7 @@ void QuicChromiumClientSession::StreamRequest::OnRequestCompleteFailure(
 QuicChromiumClientSession::QuicChromiumClientSession(
     QuicConnection* connection,
     std::unique_ptr<DatagramClientSocket> socket,
+    QuicChromiumPacketWriter* writer,
     QuicStreamFactory* stream_factory,
     QuicCryptoClientStreamFactory* crypto_client_stream_factory,
     QuicClock* clock,
@@ -224,6 +225,7 @@ QuicChromiumClientSession::QuicChromiumClientSession(
       server_id_(server_id),
       require_confirmation_(false),
       stream_factory_(stream_factory),
+      packet_writer_(writer),
       transport_security_state_(transport_security_state),
       server_info_(std::move(server_info)),
       pkp_bypassed_(false),
@@ -920,6 +922,9 @@ void QuicChromiumClientSession::OnConnectionClosed(
   NotifyFactoryOfSessionGoingAway();
   QuicSession::OnConnectionClosed(error, error_details, source);
 
+  // Send the CONNECTION_CLOSE, if there is one, before the sockets close.
+  packet_writer_->FlushQueuedPackets();
+
   if (!callback_.is_null()) {
     base::ResetAndReturn(&callback_).Run(ERR_QUIC_PROTOCOL_ERROR);
   }
@@ -1182,14 +1187,24 @@ bool QuicChromiumClientSession::MigrateToSocket(
   packet_readers_.push_back(std::move(reader));
   sockets_.push_back(std::move(socket));
   StartReading();
-  QuicChromiumPacketWriter* raw_writer = writer.get();
+  // Packets the old writer had queued go out on the new socket, after
+  // |packet| if there is one.
+  std::vector<scoped_refptr<StringIOBuffer>> queued_packets =
+      packet_writer_->TakeQueuedPackets();
+  writer->Initialize(this, connection());
+  packet_writer_ = writer.get();
   connection()->SetQuicPacketWriter(writer.release(), /*owns_writer=*/true);
   if (packet == nullptr) {
+    packet_writer_->QueuePackets(std::move(queued_packets));
     connection()->SendPing();
     return true;
   }
   // Packet rewrite after migration on socket write error.
-  error_code_from_rewrite_ = raw_writer->WritePacketToSocket(packet.get());
+  error_code_from_rewrite_ = packet_writer_->WritePacketToSocket(packet.get());
+  if (error_code_from_rewrite_ >= 0 ||
+      error_code_from_rewrite_ == ERR_IO_PENDING) {
+    packet_writer_->QueuePackets(std::move(queued_packets));
+  }
   use_error_code_from_rewrite_ = true;
   return true;
 }
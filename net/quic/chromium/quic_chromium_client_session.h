@@ -121,6 +121,7 @@ class NET_EXPORT_PRIVATE QuicChromiumClientSession
   QuicChromiumClientSession(
       QuicConnection* connection,
       std::unique_ptr<DatagramClientSocket> socket,
+      QuicChromiumPacketWriter* writer,
       QuicStreamFactory* stream_factory,
       QuicCryptoClientStreamFactory* crypto_client_stream_factory,
       QuicClock* clock,
@@ -339,6 +340,8 @@ class NET_EXPORT_PRIVATE QuicChromiumClientSession
   std::unique_ptr<QuicCryptoClientStream> crypto_stream_;
   QuicStreamFactory* stream_factory_;
   std::vector<std::unique_ptr<DatagramClientSocket>> sockets_;
+  // Writer for the most recently added socket. Owned by the connection.
+  QuicChromiumPacketWriter* packet_writer_;
   TransportSecurityState* transport_security_state_;
   std::unique_ptr<QuicServerInfo> server_info_;
   std::unique_ptr<CertVerifyResult> cert_verify_result_;
@@ -91,7 +91,7 @@ class QuicChromiumClientSessionTest
         0, kIpEndPoint, &helper_, &alarm_factory_, writer, true,
         Perspective::IS_CLIENT, SupportedVersions(GetParam()));
     session_.reset(new QuicChromiumClientSession(
-        connection, std::move(socket),
+        connection, std::move(socket), writer,
         /*stream_factory=*/nullptr, &crypto_client_stream_factory_, &clock_,
         &transport_security_state_,
         base::WrapUnique(static_cast<QuicServerInfo*>(nullptr)),
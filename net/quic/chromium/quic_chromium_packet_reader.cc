@@ -4,6 +4,8 @@
 
 #include "net/quic/chromium/quic_chromium_packet_reader.h"
 
+#include <algorithm>
+
 #include "base/location.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/single_thread_task_runner.h"
@@ -29,6 +31,7 @@ QuicChromiumPacketReader::QuicChromiumPacketReader(
       yield_after_duration_(yield_after_duration),
       yield_after_(QuicTime::Infinite()),
       read_buffer_(new IOBufferWithSize(static_cast<size_t>(kMaxPacketSize))),
+      socket_drained_(false),
       net_log_(net_log),
       weak_factory_(this) {}
 
@@ -43,6 +46,34 @@ void QuicChromiumPacketReader::StartReading() {
 
   DCHECK(socket_);
   read_pending_ = true;
+  if (socket_->SupportsBatchedIO() && !socket_drained_) {
+    if (batch_buffers_.empty()) {
+      for (size_t i = 0; i < kQuicMaxPacketsPerBatchedRead; ++i) {
+        batch_buffers_.push_back(
+            new IOBufferWithSize(static_cast<size_t>(kMaxPacketSize)));
+      }
+    }
+    int rv = socket_->ReadMultiple(batch_buffers_, &batch_sizes_);
+    // Filling fewer buffers than there are means nothing else was queued, so
+    // the next read waits for more with Read() instead of trying again.
+    socket_drained_ = rv < static_cast<int>(batch_buffers_.size());
+    if (rv != ERR_IO_PENDING) {
+      if (rv > 0)
+        UMA_HISTOGRAM_COUNTS_100("Net.QuicSession.PacketsPerBatchedRead", rv);
+      if (ShouldYield(std::max(rv, 1))) {
+        base::ThreadTaskRunnerHandle::Get()->PostTask(
+            FROM_HERE,
+            base::Bind(&QuicChromiumPacketReader::OnReadMultipleComplete,
+                       weak_factory_.GetWeakPtr(), rv));
+      } else {
+        OnReadMultipleComplete(rv);
+      }
+      return;
+    }
+    // Nothing is queued yet, so wait for the next packet with Read().
+  }
+  socket_drained_ = false;
+
   int rv = socket_->Read(read_buffer_.get(), read_buffer_->size(),
                          base::Bind(&QuicChromiumPacketReader::OnReadComplete,
                                     weak_factory_.GetWeakPtr()));
@@ -52,9 +83,7 @@ void QuicChromiumPacketReader::StartReading() {
     return;
   }
 
-  if (++num_packets_read_ > yield_after_packets_ ||
-      clock_->Now() > yield_after_) {
-    num_packets_read_ = 0;
+  if (ShouldYield(1)) {
     // Data was read, process it.
     // Schedule the work through the message loop to 1) prevent infinite
     // recursion and 2) avoid blocking the thread for too long.
@@ -66,6 +95,16 @@ void QuicChromiumPacketReader::StartReading() {
   }
 }
 
+bool QuicChromiumPacketReader::ShouldYield(int packets_read) {
+  num_packets_read_ += packets_read;
+  if (num_packets_read_ <= yield_after_packets_ &&
+      clock_->Now() <= yield_after_) {
+    return false;
+  }
+  num_packets_read_ = 0;
+  return true;
+}
+
 void QuicChromiumPacketReader::OnReadComplete(int result) {
   read_pending_ = false;
   if (result == 0)
@@ -87,4 +126,33 @@ void QuicChromiumPacketReader::OnReadComplete(int result) {
   StartReading();
 }
 
+void QuicChromiumPacketReader::OnReadMultipleComplete(int result) {
+  read_pending_ = false;
+  if (result == 0)
+    result = ERR_CONNECTION_CLOSED;
+
+  if (result < 0) {
+    visitor_->OnReadError(result, socket_);
+    return;
+  }
+
+  IPEndPoint local_address;
+  IPEndPoint peer_address;
+  socket_->GetLocalAddress(&local_address);
+  socket_->GetPeerAddress(&peer_address);
+  for (int i = 0; i < result; ++i) {
+    // As in OnReadComplete(), an empty datagram closes the connection.
+    if (batch_sizes_[i] == 0) {
+      visitor_->OnReadError(ERR_CONNECTION_CLOSED, socket_);
+      return;
+    }
+    QuicReceivedPacket packet(batch_buffers_[i]->data(), batch_sizes_[i],
+                              clock_->Now());
+    if (!visitor_->OnPacket(packet, local_address, peer_address))
+      return;
+  }
+
+  StartReading();
+}
+
 }  // namespace net
@@ -6,6 +6,8 @@
 #ifndef NET_QUIC_QUIC_CHROMIUM_PACKET_READER_H_
 #define NET_QUIC_QUIC_CHROMIUM_PACKET_READER_H_
 
+#include <vector>
+
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "net/base/io_buffer.h"
@@ -25,6 +27,9 @@ class QuicClock;
 const int kQuicYieldAfterPacketsRead = 32;
 const int kQuicYieldAfterDurationMilliseconds = 20;
 
+// Most packets read per system call when the socket supports batched reads.
+const size_t kQuicMaxPacketsPerBatchedRead = 16;
+
 class NET_EXPORT_PRIVATE QuicChromiumPacketReader {
  public:
   class NET_EXPORT_PRIVATE Visitor {
@@ -46,13 +51,23 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketReader {
   virtual ~QuicChromiumPacketReader();
 
   // Causes the QuicConnectionHelper to start reading from the socket
-  // and passing the data along to the QuicConnection.
+  // and passing the data along to the QuicConnection. If the socket supports
+  // batched I/O, packets that are already queued are read several at a time,
+  // and Read() is only used to wait for more.
   void StartReading();
 
  private:
   // A completion callback invoked when a read completes.
   void OnReadComplete(int result);
 
+  // Passes the |result| packets read into |batch_buffers_| by
+  // DatagramClientSocket::ReadMultiple() to |visitor_|, or reports the error.
+  void OnReadMultipleComplete(int result);
+
+  // Returns true if the read loop should yield to the message loop, having
+  // just read |packets_read| more packets.
+  bool ShouldYield(int packets_read);
+
   DatagramClientSocket* socket_;
   Visitor* visitor_;
   bool read_pending_;
@@ -62,6 +77,11 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketReader {
   QuicTime::Delta yield_after_duration_;
   QuicTime yield_after_;
   scoped_refptr<IOBufferWithSize> read_buffer_;
+  // Reused across batched reads, and allocated on the first one.
+  std::vector<scoped_refptr<IOBufferWithSize>> batch_buffers_;
+  std::vector<int> batch_sizes_;
+  // Whether the last ReadMultiple() emptied the socket's queue.
+  bool socket_drained_;
   BoundNetLog net_log_;
 
   base::WeakPtrFactory<QuicChromiumPacketReader> weak_factory_;
@@ -0,0 +1,165 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/chromium/quic_chromium_packet_reader.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "net/base/net_errors.h"
+#include "net/quic/test_tools/mock_clock.h"
+#include "net/udp/datagram_client_socket.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+// Socket that supports batched I/O. ReadMultiple() returns |queued| packets,
+// as many as fit, and Read() always waits for more.
+class BatchedReadSocket : public DatagramClientSocket {
+ public:
+  BatchedReadSocket() : queued(0), read_calls(0), read_multiple_calls(0) {}
+
+  // Socket implementation.
+  int Read(IOBuffer* buf,
+           int buf_len,
+           const CompletionCallback& callback) override {
+    ++read_calls;
+    read_buffer = buf;
+    read_callback = callback;
+    return ERR_IO_PENDING;
+  }
+  int Write(IOBuffer* buf,
+            int buf_len,
+            const CompletionCallback& callback) override {
+    return buf_len;
+  }
+  int SetReceiveBufferSize(int32_t size) override { return OK; }
+  int SetSendBufferSize(int32_t size) override { return OK; }
+
+  // DatagramSocket implementation.
+  void Close() override {}
+  int GetPeerAddress(IPEndPoint* address) const override {
+    return ERR_NOT_IMPLEMENTED;
+  }
+  int GetLocalAddress(IPEndPoint* address) const override {
+    return ERR_NOT_IMPLEMENTED;
+  }
+  const BoundNetLog& NetLog() const override { return net_log_; }
+
+  // DatagramClientSocket implementation.
+  int Connect(const IPEndPoint& address) override { return OK; }
+  int ConnectUsingNetwork(NetworkChangeNotifier::NetworkHandle network,
+                          const IPEndPoint& address) override {
+    return OK;
+  }
+  int ConnectUsingDefaultNetwork(const IPEndPoint& address) override {
+    return OK;
+  }
+  NetworkChangeNotifier::NetworkHandle GetBoundNetwork() const override {
+    return NetworkChangeNotifier::kInvalidNetworkHandle;
+  }
+  void EnableBatchedIO() override {}
+  bool SupportsBatchedIO() const override { return true; }
+  int ReadMultiple(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                   std::vector<int>* read_sizes) override {
+    ++read_multiple_calls;
+    size_t count = std::min(queued, buffers.size());
+    if (count == 0)
+      return ERR_IO_PENDING;
+    queued -= count;
+    read_sizes->assign(count, 1);
+    for (size_t i = 0; i < count; ++i)
+      buffers[i]->data()[0] = 'p';
+    return static_cast<int>(count);
+  }
+  int WriteMultiple(
+      const std::vector<scoped_refptr<StringIOBuffer>>& buffers) override {
+    return ERR_NOT_IMPLEMENTED;
+  }
+
+  size_t queued;
+  int read_calls;
+  int read_multiple_calls;
+  scoped_refptr<IOBuffer> read_buffer;
+  CompletionCallback read_callback;
+
+ private:
+  BoundNetLog net_log_;
+};
+
+class CountingVisitor : public QuicChromiumPacketReader::Visitor {
+ public:
+  CountingVisitor() : packets(0), errors(0) {}
+
+  void OnReadError(int result, const DatagramClientSocket* socket) override {
+    ++errors;
+  }
+  bool OnPacket(const QuicReceivedPacket& packet,
+                IPEndPoint local_address,
+                IPEndPoint peer_address) override {
+    ++packets;
+    return true;
+  }
+
+  int packets;
+  int errors;
+};
+
+class QuicChromiumPacketReaderTest : public ::testing::Test {
+ protected:
+  QuicChromiumPacketReaderTest()
+      : reader_(&socket_,
+                &clock_,
+                &visitor_,
+                kQuicYieldAfterPacketsRead,
+                QuicTime::Delta::FromMilliseconds(
+                    kQuicYieldAfterDurationMilliseconds),
+                BoundNetLog()) {}
+
+  MockClock clock_;
+  BatchedReadSocket socket_;
+  CountingVisitor visitor_;
+  QuicChromiumPacketReader reader_;
+};
+
+TEST_F(QuicChromiumPacketReaderTest, PartialBatchWaitsWithRead) {
+  socket_.queued = 3;
+  reader_.StartReading();
+  EXPECT_EQ(3, visitor_.packets);
+  // The socket had fewer packets than buffers, so there is no second
+  // ReadMultiple() that would only find the queue empty.
+  EXPECT_EQ(1, socket_.read_multiple_calls);
+  EXPECT_EQ(1, socket_.read_calls);
+}
+
+TEST_F(QuicChromiumPacketReaderTest, FullBatchReadsAgain) {
+  socket_.queued = kQuicMaxPacketsPerBatchedRead + 4;
+  reader_.StartReading();
+  EXPECT_EQ(static_cast<int>(kQuicMaxPacketsPerBatchedRead + 4),
+            visitor_.packets);
+  EXPECT_EQ(2, socket_.read_multiple_calls);
+  EXPECT_EQ(1, socket_.read_calls);
+}
+
+TEST_F(QuicChromiumPacketReaderTest, BatchedReadResumesAfterRead) {
+  reader_.StartReading();
+  EXPECT_EQ(1, socket_.read_multiple_calls);
+  EXPECT_EQ(1, socket_.read_calls);
+
+  // A packet arrives with more behind it; they are read in one batch.
+  socket_.queued = 2;
+  socket_.read_buffer->data()[0] = 'p';
+  socket_.read_callback.Run(1);
+  EXPECT_EQ(3, visitor_.packets);
+  EXPECT_EQ(2, socket_.read_multiple_calls);
+  EXPECT_EQ(2, socket_.read_calls);
+  EXPECT_EQ(0, visitor_.errors);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -10,20 +10,24 @@
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/sparse_histogram.h"
+#include "base/single_thread_task_runner.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/quic/chromium/quic_chromium_client_session.h"
 
 namespace net {
 
-QuicChromiumPacketWriter::QuicChromiumPacketWriter() : weak_factory_(this) {}
+QuicChromiumPacketWriter::QuicChromiumPacketWriter()
+    : flush_pending_(false), weak_factory_(this) {}
 
-QuicChromiumPacketWriter::QuicChromiumPacketWriter(Socket* socket)
+QuicChromiumPacketWriter::QuicChromiumPacketWriter(DatagramClientSocket* socket)
     : socket_(socket),
       connection_(nullptr),
       observer_(nullptr),
       packet_(nullptr),
       write_blocked_(false),
+      flush_pending_(false),
       weak_factory_(this) {}
 
 QuicChromiumPacketWriter::~QuicChromiumPacketWriter() {}
@@ -35,9 +39,14 @@ void QuicChromiumPacketWriter::Initialize(WriteErrorObserver* observer,
 }
 
 int QuicChromiumPacketWriter::WritePacketToSocket(StringIOBuffer* packet) {
-  return socket_->Write(packet, packet->size(),
-                        base::Bind(&QuicChromiumPacketWriter::OnWriteComplete,
-                                   weak_factory_.GetWeakPtr()));
+  int rv = socket_->Write(packet, packet->size(),
+                          base::Bind(&QuicChromiumPacketWriter::OnWriteComplete,
+                                     weak_factory_.GetWeakPtr()));
+  if (rv == ERR_IO_PENDING) {
+    write_blocked_ = true;
+    packet_ = packet;
+  }
+  return rv;
 }
 
 WriteResult QuicChromiumPacketWriter::WritePacket(
@@ -49,6 +58,16 @@ WriteResult QuicChromiumPacketWriter::WritePacket(
   scoped_refptr<StringIOBuffer> buf(
       new StringIOBuffer(std::string(buffer, buf_len)));
   DCHECK(!IsWriteBlocked());
+
+  if (socket_->SupportsBatchedIO()) {
+    // Reported as written now; a failure surfaces later through
+    // QuicConnection::OnWriteError(), which the connection handles the same
+    // way as a failed asynchronous write.
+    batch_.push_back(buf);
+    ScheduleFlush();
+    return WriteResult(WRITE_STATUS_OK, buf_len);
+  }
+
   base::TimeTicks now = base::TimeTicks::Now();
 
   int rv = WritePacketToSocket(buf.get());
@@ -58,7 +77,16 @@ WriteResult QuicChromiumPacketWriter::WritePacket(
     // able to migrate and rewrite packet on a new socket.
     // OnWriteError returns the outcome of that attempt, which is returned
     // to the caller.
+    base::WeakPtr<QuicChromiumPacketWriter> weak_this =
+        weak_factory_.GetWeakPtr();
     rv = observer_->OnWriteError(rv, buf);
+    if (!weak_this) {
+      // Migration replaced this writer. The new one rewrote |buf| and is
+      // blocked if that write is pending.
+      if (rv == ERR_IO_PENDING)
+        return WriteResult(WRITE_STATUS_BLOCKED, rv);
+      return WriteResult(rv < 0 ? WRITE_STATUS_ERROR : WRITE_STATUS_OK, rv);
+    }
   }
 
   WriteStatus status = WRITE_STATUS_OK;
@@ -68,8 +96,6 @@ WriteResult QuicChromiumPacketWriter::WritePacket(
       status = WRITE_STATUS_ERROR;
     } else {
       status = WRITE_STATUS_BLOCKED;
-      write_blocked_ = true;
-      packet_ = buf;
     }
   }
 
@@ -100,22 +126,120 @@ void QuicChromiumPacketWriter::SetWritable() {
 void QuicChromiumPacketWriter::OnWriteComplete(int rv) {
   DCHECK_NE(rv, ERR_IO_PENDING);
   write_blocked_ = false;
+  QuicConnection* connection = connection_;
+  base::WeakPtr<QuicChromiumPacketWriter> weak_this =
+      weak_factory_.GetWeakPtr();
   if (rv < 0) {
     // If write error, then call into the observer's OnWriteError,
     // which may be able to rewrite the packet on a new
     // socket. OnWriteError returns the outcome of the attempt.
     rv = observer_->OnWriteError(rv, packet_);
-    packet_ = nullptr;
     if (rv == ERR_IO_PENDING)
       return;
+    if (!weak_this) {
+      // Migration replaced this writer, and the new one sends what was
+      // queued here.
+      if (rv < 0) {
+        connection->OnWriteError(rv);
+      } else {
+        connection->OnCanWrite();
+      }
+      return;
+    }
+    packet_ = nullptr;
   }
 
   if (rv < 0) {
+    batch_.clear();
     connection_->OnWriteError(rv);
+  } else if (!batch_.empty()) {
+    // Packets queued behind the blocked write go out before the connection
+    // is told it can write again.
+    FlushBatch();
+    if (!weak_this || write_blocked_ || !connection->connected())
+      return;
   }
   connection_->OnCanWrite();
 }
 
+void QuicChromiumPacketWriter::FlushBatch() {
+  flush_pending_ = false;
+  while (!batch_.empty() && !write_blocked_) {
+    // Packets handed over from a writer on a batching socket may end up here
+    // on one that is not; they are then sent one at a time below.
+    int rv = socket_->SupportsBatchedIO() ? socket_->WriteMultiple(batch_) : 0;
+    if (rv > 0) {
+      UMA_HISTOGRAM_COUNTS_100("Net.QuicSession.PacketsPerBatchedWrite", rv);
+      batch_.erase(batch_.begin(), batch_.begin() + rv);
+      continue;
+    }
+
+    // Nothing was sent. Retry the first packet through Write(), which waits
+    // for the socket to become writable and reports errors the same way as
+    // unbatched writes.
+    scoped_refptr<StringIOBuffer> packet = batch_.front();
+    batch_.erase(batch_.begin());
+    rv = WritePacketToSocket(packet.get());
+    if (rv == ERR_IO_PENDING)
+      return;
+    if (rv >= 0)
+      continue;
+
+    QuicConnection* connection = connection_;
+    base::WeakPtr<QuicChromiumPacketWriter> weak_this =
+        weak_factory_.GetWeakPtr();
+    if (observer_ != nullptr)
+      rv = observer_->OnWriteError(rv, packet);
+    if (rv == ERR_IO_PENDING)
+      return;
+    if (rv < 0) {
+      UMA_HISTOGRAM_SPARSE_SLOWLY("Net.QuicSession.WriteError", -rv);
+      if (weak_this)
+        batch_.clear();
+      connection->OnWriteError(rv);
+      return;
+    }
+    // A successful migration deletes this writer, after moving the rest of
+    // |batch_| to the new one.
+    if (!weak_this)
+      return;
+  }
+}
+
+void QuicChromiumPacketWriter::ScheduleFlush() {
+  if (flush_pending_ || batch_.empty())
+    return;
+  flush_pending_ = true;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::Bind(&QuicChromiumPacketWriter::FlushBatch,
+                            weak_factory_.GetWeakPtr()));
+}
+
+void QuicChromiumPacketWriter::FlushQueuedPackets() {
+  // Write() could only queue the packets on a socket that is about to be
+  // closed, so only what WriteMultiple() takes right away is sent.
+  while (!batch_.empty() && !write_blocked_ && socket_->SupportsBatchedIO()) {
+    int rv = socket_->WriteMultiple(batch_);
+    if (rv <= 0)
+      break;
+    batch_.erase(batch_.begin(), batch_.begin() + rv);
+  }
+  batch_.clear();
+}
+
+std::vector<scoped_refptr<StringIOBuffer>>
+QuicChromiumPacketWriter::TakeQueuedPackets() {
+  std::vector<scoped_refptr<StringIOBuffer>> packets;
+  packets.swap(batch_);
+  return packets;
+}
+
+void QuicChromiumPacketWriter::QueuePackets(
+    std::vector<scoped_refptr<StringIOBuffer>> packets) {
+  batch_.insert(batch_.begin(), packets.begin(), packets.end());
+  ScheduleFlush();
+}
+
 QuicByteCount QuicChromiumPacketWriter::GetMaxPacketSize(
     const IPEndPoint& peer_address) const {
   return kMaxPacketSize;
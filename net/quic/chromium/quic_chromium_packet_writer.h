@@ -7,6 +7,8 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "net/base/io_buffer.h"
@@ -20,6 +22,16 @@
 namespace net {
 
 // Chrome specific packet writer which uses a datagram Socket for writing data.
+//
+// If the socket supports batched I/O, packets are not written as they are
+// produced. They are queued and sent together with
+// DatagramClientSocket::WriteMultiple() from a task posted when the first one
+// is queued, so everything the connection writes in one go costs a single
+// system call. Errors from a batched write are reported through
+// QuicConnection::OnWriteError(), as for asynchronous writes. The session
+// sends whatever is still queued when the connection closes, so a final
+// CONNECTION_CLOSE is not lost, and hands the queue to the new writer when
+// it migrates to another socket.
 class NET_EXPORT_PRIVATE QuicChromiumPacketWriter : public QuicPacketWriter {
  public:
   // Interface which receives notifications on socket write errors.
@@ -34,12 +46,13 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketWriter : public QuicPacketWriter {
   };
 
   QuicChromiumPacketWriter();
-  explicit QuicChromiumPacketWriter(Socket* socket);
+  explicit QuicChromiumPacketWriter(DatagramClientSocket* socket);
   ~QuicChromiumPacketWriter() override;
 
   void Initialize(WriteErrorObserver* observer, QuicConnection* connection);
 
   // Writes |packet| to the socket and returns the error code from the write.
+  // If the write is pending, the writer is blocked until it completes.
   int WritePacketToSocket(StringIOBuffer* packet);
 
   // QuicPacketWriter
@@ -55,11 +68,32 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketWriter : public QuicPacketWriter {
 
   void OnWriteComplete(int rv);
 
+  // Sends as many queued packets as the socket takes without blocking, then
+  // drops the rest. Errors are not reported. Used when the connection closes.
+  void FlushQueuedPackets();
+
+  // Returns the packets that are queued but not yet sent, oldest first, and
+  // forgets them.
+  std::vector<scoped_refptr<StringIOBuffer>> TakeQueuedPackets();
+
+  // Queues |packets|, taken from the writer this one replaces, to be sent
+  // ahead of anything written after this call.
+  void QueuePackets(std::vector<scoped_refptr<StringIOBuffer>> packets);
+
  protected:
   void set_write_blocked(bool is_blocked) { write_blocked_ = is_blocked; }
 
  private:
-  Socket* socket_;
+  // Sends the packets in |batch_|, in order, until they are all written or a
+  // write blocks or fails. May delete |this| if |observer_| migrates the
+  // connection to a new socket.
+  void FlushBatch();
+
+  // Posts a task to run FlushBatch() if there is none and |batch_| is not
+  // empty.
+  void ScheduleFlush();
+
+  DatagramClientSocket* socket_;
   QuicConnection* connection_;
   WriteErrorObserver* observer_;
   // When a write returns asynchronously, |packet_| stores the written
@@ -69,6 +103,11 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketWriter : public QuicPacketWriter {
   // Whether a write is currently in flight.
   bool write_blocked_;
 
+  // Packets waiting for FlushBatch(), oldest first.
+  std::vector<scoped_refptr<StringIOBuffer>> batch_;
+  // Whether a task to run FlushBatch() has been posted.
+  bool flush_pending_;
+
   base::WeakPtrFactory<QuicChromiumPacketWriter> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicChromiumPacketWriter);
@@ -0,0 +1,207 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/chromium/quic_chromium_packet_writer.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/run_loop.h"
+#include "net/base/net_errors.h"
+#include "net/log/net_log.h"
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "net/udp/datagram_client_socket.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+const IPEndPoint kPeerAddress = IPEndPoint(IPAddress::IPv4Localhost(), 443);
+
+// Socket that supports batched I/O and records what is written to it.
+// WriteMultiple() takes at most |max_batch| packets per call, or fails with
+// |write_multiple_result| if that is not OK. Write() completes asynchronously
+// when |write_pending| is set.
+class BatchedWriteSocket : public DatagramClientSocket {
+ public:
+  BatchedWriteSocket()
+      : max_batch(16),
+        write_multiple_result(OK),
+        write_pending(false),
+        write_multiple_calls(0) {}
+
+  // Socket implementation.
+  int Read(IOBuffer* buf,
+           int buf_len,
+           const CompletionCallback& callback) override {
+    return ERR_IO_PENDING;
+  }
+  int Write(IOBuffer* buf,
+            int buf_len,
+            const CompletionCallback& callback) override {
+    written.push_back(std::string(buf->data(), buf_len));
+    if (!write_pending)
+      return buf_len;
+    write_callback = callback;
+    return ERR_IO_PENDING;
+  }
+  int SetReceiveBufferSize(int32_t size) override { return OK; }
+  int SetSendBufferSize(int32_t size) override { return OK; }
+
+  // DatagramSocket implementation.
+  void Close() override {}
+  int GetPeerAddress(IPEndPoint* address) const override {
+    *address = kPeerAddress;
+    return OK;
+  }
+  int GetLocalAddress(IPEndPoint* address) const override {
+    return ERR_NOT_IMPLEMENTED;
+  }
+  const BoundNetLog& NetLog() const override { return net_log_; }
+
+  // DatagramClientSocket implementation.
+  int Connect(const IPEndPoint& address) override { return OK; }
+  int ConnectUsingNetwork(NetworkChangeNotifier::NetworkHandle network,
+                          const IPEndPoint& address) override {
+    return OK;
+  }
+  int ConnectUsingDefaultNetwork(const IPEndPoint& address) override {
+    return OK;
+  }
+  NetworkChangeNotifier::NetworkHandle GetBoundNetwork() const override {
+    return NetworkChangeNotifier::kInvalidNetworkHandle;
+  }
+  void EnableBatchedIO() override {}
+  bool SupportsBatchedIO() const override { return true; }
+  int ReadMultiple(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                   std::vector<int>* read_sizes) override {
+    return ERR_IO_PENDING;
+  }
+  int WriteMultiple(
+      const std::vector<scoped_refptr<StringIOBuffer>>& buffers) override {
+    ++write_multiple_calls;
+    if (write_multiple_result != OK)
+      return write_multiple_result;
+    size_t count = std::min(buffers.size(), max_batch);
+    for (size_t i = 0; i < count; ++i)
+      written.push_back(buffers[i]->data());
+    return static_cast<int>(count);
+  }
+
+  size_t max_batch;
+  int write_multiple_result;
+  bool write_pending;
+  CompletionCallback write_callback;
+  int write_multiple_calls;
+  std::vector<std::string> written;
+
+ private:
+  BoundNetLog net_log_;
+};
+
+class QuicChromiumPacketWriterTest : public ::testing::Test {
+ protected:
+  QuicChromiumPacketWriterTest()
+      : connection_(new MockQuicConnection(&helper_,
+                                           &alarm_factory_,
+                                           Perspective::IS_CLIENT)),
+        writer_(&socket_) {
+    writer_.Initialize(nullptr, connection_.get());
+  }
+
+  WriteResult Write(const std::string& packet) {
+    return writer_.WritePacket(packet.data(), packet.size(), IPAddress(),
+                               kPeerAddress, nullptr);
+  }
+
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  std::unique_ptr<MockQuicConnection> connection_;
+  BatchedWriteSocket socket_;
+  QuicChromiumPacketWriter writer_;
+};
+
+TEST_F(QuicChromiumPacketWriterTest, PacketsAreSentInOneBatch) {
+  EXPECT_EQ(WRITE_STATUS_OK, Write("one").status);
+  EXPECT_EQ(WRITE_STATUS_OK, Write("two").status);
+  EXPECT_EQ(WRITE_STATUS_OK, Write("three").status);
+  EXPECT_TRUE(socket_.written.empty());
+
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, socket_.write_multiple_calls);
+  EXPECT_EQ((std::vector<std::string>{"one", "two", "three"}),
+            socket_.written);
+}
+
+TEST_F(QuicChromiumPacketWriterTest, PartialBatchIsResent) {
+  socket_.max_batch = 2;
+  Write("one");
+  Write("two");
+  Write("three");
+
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(2, socket_.write_multiple_calls);
+  EXPECT_EQ((std::vector<std::string>{"one", "two", "three"}),
+            socket_.written);
+}
+
+TEST_F(QuicChromiumPacketWriterTest, FlushQueuedPacketsSendsImmediately) {
+  Write("data");
+  Write("close");
+  writer_.FlushQueuedPackets();
+  EXPECT_EQ((std::vector<std::string>{"data", "close"}), socket_.written);
+
+  // The posted flush has nothing left to do.
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, socket_.write_multiple_calls);
+}
+
+TEST_F(QuicChromiumPacketWriterTest, FlushQueuedPacketsDropsUnsentPackets) {
+  socket_.write_multiple_result = ERR_IO_PENDING;
+  Write("close");
+  writer_.FlushQueuedPackets();
+  EXPECT_TRUE(socket_.written.empty());
+  EXPECT_TRUE(writer_.TakeQueuedPackets().empty());
+}
+
+TEST_F(QuicChromiumPacketWriterTest, QueuedPacketsFollowBlockedWrite) {
+  // WriteMultiple() would block, so the first packet goes through Write() and
+  // the rest wait for it.
+  socket_.write_multiple_result = ERR_IO_PENDING;
+  socket_.write_pending = true;
+  Write("one");
+  Write("two");
+  base::RunLoop().RunUntilIdle();
+  EXPECT_TRUE(writer_.IsWriteBlocked());
+  EXPECT_EQ((std::vector<std::string>{"one"}), socket_.written);
+
+  socket_.write_multiple_result = OK;
+  socket_.write_pending = false;
+  EXPECT_CALL(*connection_, OnCanWrite());
+  socket_.write_callback.Run(3);
+  EXPECT_FALSE(writer_.IsWriteBlocked());
+  EXPECT_EQ((std::vector<std::string>{"one", "two"}), socket_.written);
+}
+
+TEST_F(QuicChromiumPacketWriterTest, HandedOverPacketsGoFirst) {
+  BatchedWriteSocket old_socket;
+  QuicChromiumPacketWriter old_writer(&old_socket);
+  old_writer.WritePacket("one", 3, IPAddress(), kPeerAddress, nullptr);
+  old_writer.WritePacket("two", 3, IPAddress(), kPeerAddress, nullptr);
+
+  writer_.QueuePackets(old_writer.TakeQueuedPackets());
+  Write("three");
+
+  base::RunLoop().RunUntilIdle();
+  EXPECT_TRUE(old_socket.written.empty());
+  EXPECT_EQ((std::vector<std::string>{"one", "two", "three"}),
+            socket_.written);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
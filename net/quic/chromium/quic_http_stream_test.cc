@@ -291,10 +291,12 @@ class QuicHttpStreamTest : public ::testing::TestWithParam<QuicVersion> {
         new QuicChromiumConnectionHelper(&clock_, &random_generator_));
     alarm_factory_.reset(new QuicChromiumAlarmFactory(runner_.get(), &clock_));
 
+    QuicChromiumPacketWriter* writer =
+        new QuicChromiumPacketWriter(socket.get());
     connection_ =
         new TestQuicConnection(SupportedVersions(GetParam()), connection_id_,
                                peer_addr_, helper_.get(), alarm_factory_.get(),
-                               new QuicChromiumPacketWriter(socket.get()));
+                               writer);
     connection_->set_visitor(&visitor_);
     connection_->SetSendAlgorithm(send_algorithm_);
 
@@ -308,7 +310,7 @@ class QuicHttpStreamTest : public ::testing::TestWithParam<QuicVersion> {
     crypto_client_stream_factory_.AddProofVerifyDetails(&verify_details_);
 
     session_.reset(new QuicChromiumClientSession(
-        connection_, std::move(socket),
+        connection_, std::move(socket), writer,
         /*stream_factory=*/nullptr, &crypto_client_stream_factory_, &clock_,
         &transport_security_state_,
         base::WrapUnique(static_cast<QuicServerInfo*>(nullptr)),
@@ -10,6 +10,7 @@
 #include <tuple>
 #include <utility>
 
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/memory/ptr_util.h"
 #include "base/metrics/field_trial.h"
@@ -86,6 +87,11 @@ const int32_t kQuicStreamMaxRecvWindowSize = 6 * 1024 * 1024;    // 6 MB
 // Set the maximum number of undecryptable packets the connection will store.
 const int32_t kMaxUndecryptablePackets = 100;
 
+// Reads and writes QUIC packets in batches with recvmmsg() and sendmmsg()
+// where the platform supports it.
+const base::Feature kQuicBatchedUdpIo{"QuicBatchedUdpIo",
+                                      base::FEATURE_DISABLED_BY_DEFAULT};
+
 std::unique_ptr<base::Value> NetLogQuicConnectionMigrationTriggerCallback(
     std::string trigger,
     NetLogCaptureMode capture_mode) {
@@ -1590,6 +1596,9 @@ int QuicStreamFactory::ConfigureSocket(DatagramClientSocket* socket,
 #endif
   }
 
+  if (base::FeatureList::IsEnabled(kQuicBatchedUdpIo))
+    socket->EnableBatchedIO();
+
   int rv;
   if (migrate_sessions_on_network_change_) {
     // If caller leaves network unspecified, use current default network.
@@ -1728,10 +1737,11 @@ int QuicStreamFactory::CreateSession(
   }
 
   *session = new QuicChromiumClientSession(
-      connection, std::move(socket), this, quic_crypto_client_stream_factory_,
-      clock_.get(), transport_security_state_, std::move(server_info),
-      server_id, yield_after_packets_, yield_after_duration_, cert_verify_flags,
-      config, &crypto_config_, network_connection_.GetDescription(),
+      connection, std::move(socket), writer, this,
+      quic_crypto_client_stream_factory_, clock_.get(),
+      transport_security_state_, std::move(server_info), server_id,
+      yield_after_packets_, yield_after_duration_, cert_verify_flags, config,
+      &crypto_config_, network_connection_.GetDescription(),
       dns_resolution_end_time, &push_promise_index_,
       base::ThreadTaskRunnerHandle::Get().get(),
       std::move(socket_performance_watcher), net_log.net_log());
@@ -21,6 +21,10 @@ int64_t g_used_idle_socket_timeout_s = 300;  // 5 minutes
 
 namespace net {
 
+bool HigherLayeredPool::HasGroup(const std::string& group_name) const {
+  return false;
+}
+
 // static
 base::TimeDelta ClientSocketPool::unused_idle_socket_timeout() {
   return base::TimeDelta::FromSeconds(g_unused_idle_socket_timeout_s);
@@ -37,6 +37,12 @@ class NET_EXPORT HigherLayeredPool {
   // one was closed.  Closing an idle connection will call into the lower layer
   // pool it came from, so must be careful of re-entrancy when using this.
   virtual bool CloseOneIdleConnection() = 0;
+
+  // Returns true if the HigherLayeredPool has a group named |group_name|.
+  // Higher layered pools request their underlying sockets under their own
+  // group names, so lower layered pools use this to leave prewarming of those
+  // groups to the pool that owns them.
+  virtual bool HasGroup(const std::string& group_name) const;
 };
 
 // ClientSocketPools are layered. This defines an interface for higher level
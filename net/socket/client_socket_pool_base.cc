@@ -32,6 +32,10 @@ namespace {
 // after a certain timeout has passed without receiving an ACK.
 bool g_connect_backup_jobs_enabled = true;
 
+// Indicate whether or not pools should keep idle sockets connected for the
+// groups they are asked for most often.
+bool g_prewarming_enabled = false;
+
 }  // namespace
 
 ConnectJob::ConnectJob(const std::string& group_name,
@@ -145,6 +149,11 @@ ClientSocketPoolBaseHelper::Request::~Request() {
   liveness_ = DEAD;
 }
 
+std::unique_ptr<const ClientSocketPoolBaseHelper::Request>
+ClientSocketPoolBaseHelper::Request::CreatePrewarmRequest() const {
+  return nullptr;
+}
+
 void ClientSocketPoolBaseHelper::Request::CrashIfInvalid() const {
   CHECK_EQ(liveness_, ALIVE);
 }
@@ -167,6 +176,10 @@ ClientSocketPoolBaseHelper::ClientSocketPoolBaseHelper(
       connect_backup_jobs_enabled_(false),
       pool_generation_number_(0),
       pool_(pool),
+      prewarm_task_pending_(false),
+      prewarm_hit_count_(0),
+      prewarm_miss_count_(0),
+      prewarmed_socket_count_(0),
       weak_factory_(this) {
   DCHECK_LE(0, max_sockets_per_group);
   DCHECK_LE(max_sockets_per_group, max_sockets);
@@ -271,7 +284,17 @@ int ClientSocketPoolBaseHelper::RequestSocket(
   request->net_log().BeginEvent(NetLog::TYPE_SOCKET_POOL);
   Group* group = GetOrCreateGroup(group_name);
 
+  bool prewarmed_group = false;
+  if (prewarmer_)
+    prewarmed_group = RecordPrewarmDemand(group_name, *request);
+
   int rv = RequestSocketInternal(group_name, *request);
+  if (prewarmed_group) {
+    // Only a socket that was already connected saved the request a connect.
+    RecordPrewarmResult(rv == OK && request->handle()->reuse_type() !=
+                                        ClientSocketHandle::UNUSED,
+                        request->net_log());
+  }
   if (rv != ERR_IO_PENDING) {
     request->net_log().EndEventWithNetErrorCode(NetLog::TYPE_SOCKET_POOL, rv);
     CHECK(!request->handle()->is_initialized());
@@ -598,6 +621,13 @@ ClientSocketPoolBaseHelper::GetInfoAsValue(const std::string& name,
   dict->SetInteger("max_socket_count", max_sockets_);
   dict->SetInteger("max_sockets_per_group", max_sockets_per_group_);
   dict->SetInteger("pool_generation_number", pool_generation_number_);
+  if (prewarmer_) {
+    dict->SetInteger("prewarm_group_count",
+                     static_cast<int>(prewarm_requests_.size()));
+    dict->SetInteger("prewarm_hit_count", prewarm_hit_count_);
+    dict->SetInteger("prewarm_miss_count", prewarm_miss_count_);
+    dict->SetInteger("prewarmed_socket_count", prewarmed_socket_count_);
+  }
 
   if (group_map_.empty())
     return dict;
@@ -674,12 +704,23 @@ void ClientSocketPoolBaseHelper::CleanupIdleSockets(bool force) {
   while (i != group_map_.end()) {
     Group* group = i->second;
 
+    // A group being prewarmed keeps its warm sockets past the unused socket
+    // timeout, rather than closing and reopening them.
+    int warm_sockets_to_keep = 0;
+    if (!force && ContainsKey(prewarm_requests_, i->first))
+      warm_sockets_to_keep =
+          prewarmer_->GetTargetIdleSocketCount(i->first, now);
+
     std::list<IdleSocket>::iterator j = group->mutable_idle_sockets()->begin();
     while (j != group->idle_sockets().end()) {
       base::TimeDelta timeout =
           j->socket->WasEverUsed() ?
           used_idle_socket_timeout_ : unused_idle_socket_timeout_;
-      if (force || j->ShouldCleanup(now, timeout)) {
+      if (warm_sockets_to_keep > 0 && !j->socket->WasEverUsed() &&
+          j->IsUsable()) {
+        warm_sockets_to_keep--;
+        ++j;
+      } else if (force || j->ShouldCleanup(now, timeout)) {
         delete j->socket;
         j = group->mutable_idle_sockets()->erase(j);
         DecrementIdleCount();
@@ -735,6 +776,24 @@ void ClientSocketPoolBaseHelper::EnableConnectBackupJobs() {
   connect_backup_jobs_enabled_ = g_connect_backup_jobs_enabled;
 }
 
+// static
+bool ClientSocketPoolBaseHelper::prewarming_enabled() {
+  return g_prewarming_enabled;
+}
+
+// static
+bool ClientSocketPoolBaseHelper::set_prewarming_enabled(bool enabled) {
+  bool old_value = g_prewarming_enabled;
+  g_prewarming_enabled = enabled;
+  return old_value;
+}
+
+void ClientSocketPoolBaseHelper::EnablePrewarming(
+    const ClientSocketPoolPrewarmer::Params& params) {
+  if (g_prewarming_enabled)
+    prewarmer_.reset(new ClientSocketPoolPrewarmer(params));
+}
+
 void ClientSocketPoolBaseHelper::IncrementIdleCount() {
   ++idle_socket_count_;
 }
@@ -911,6 +970,13 @@ void ClientSocketPoolBaseHelper::OnIPAddressChanged() {
 }
 
 void ClientSocketPoolBaseHelper::FlushWithError(int error) {
+  // Don't reopen sockets until the groups are asked for again, and forget
+  // the demand seen so far, since it was for the sockets being dropped.
+  if (prewarmer_)
+    prewarmer_->Clear();
+  prewarm_requests_.clear();
+  prewarm_timer_.Stop();
+
   pool_generation_number_++;
   CancelAllConnectJobs();
   CloseIdleSockets();
@@ -1141,6 +1207,134 @@ void ClientSocketPoolBaseHelper::TryToCloseSocketsInLayeredPools() {
   }
 }
 
+bool ClientSocketPoolBaseHelper::RecordPrewarmDemand(
+    const std::string& group_name,
+    const Request& request) {
+  // IDLE priority requests include the ones a higher layered pool makes to
+  // prewarm its own sockets, which shouldn't count twice.
+  if (request.priority() == IDLE)
+    return false;
+
+  // A higher layered pool requests its underlying sockets under its own group
+  // name. That pool already prewarms the group, so counting the demand here
+  // too would open a second set of sockets under it.
+  for (const HigherLayeredPool* higher_pool : higher_pools_) {
+    if (higher_pool->HasGroup(group_name))
+      return false;
+  }
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  bool was_hot = prewarmer_->GetTargetIdleSocketCount(group_name, now) > 0;
+  prewarmer_->OnSocketRequested(group_name, now);
+  if (prewarmer_->GetTargetIdleSocketCount(group_name, now) == 0)
+    return was_hot;
+
+  // Keep the latest parameters, so prewarmed sockets match what the group is
+  // currently asked for.
+  std::unique_ptr<const Request> prewarm_request =
+      request.CreatePrewarmRequest();
+  if (!prewarm_request)
+    return was_hot;
+  prewarm_requests_[group_name] = std::move(prewarm_request);
+  SchedulePrewarm();
+  return was_hot;
+}
+
+void ClientSocketPoolBaseHelper::RecordPrewarmResult(
+    bool hit,
+    const BoundNetLog& net_log) {
+  if (hit) {
+    prewarm_hit_count_++;
+  } else {
+    prewarm_miss_count_++;
+  }
+  UMA_HISTOGRAM_BOOLEAN("Net.SocketPool.PrewarmHit", hit);
+  net_log.AddEvent(NetLog::TYPE_SOCKET_POOL_PREWARM_RESULT,
+                   NetLog::BoolCallback("hit", hit));
+}
+
+void ClientSocketPoolBaseHelper::SchedulePrewarm() {
+  if (!prewarm_timer_.IsRunning()) {
+    prewarm_timer_.Start(FROM_HERE, prewarmer_->params().refresh_interval,
+                         base::Bind(
+                             &ClientSocketPoolBaseHelper::OnPrewarmTimerFired,
+                             base::Unretained(this)));
+  }
+
+  // Prewarm asynchronously, as the request that made the group hot is still
+  // being processed.
+  if (prewarm_task_pending_)
+    return;
+  prewarm_task_pending_ = true;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::Bind(&ClientSocketPoolBaseHelper::PrewarmGroups,
+                            weak_factory_.GetWeakPtr()));
+}
+
+void ClientSocketPoolBaseHelper::PrewarmGroups() {
+  prewarm_task_pending_ = false;
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  int started = 0;
+  PrewarmRequestMap::iterator it = prewarm_requests_.begin();
+  while (it != prewarm_requests_.end()) {
+    int target = prewarmer_->GetTargetIdleSocketCount(it->first, now);
+    if (target == 0) {
+      // The group cooled down.  Its idle sockets time out as usual.
+      prewarm_requests_.erase(it++);
+      continue;
+    }
+    started += PrewarmGroup(it->first, *it->second, target);
+    ++it;
+  }
+
+  if (started > 0) {
+    prewarmed_socket_count_ += started;
+    UMA_HISTOGRAM_COUNTS_100("Net.SocketPool.PrewarmedSockets", started);
+  }
+  if (prewarm_requests_.empty())
+    prewarm_timer_.Stop();
+}
+
+void ClientSocketPoolBaseHelper::OnPrewarmTimerFired() {
+  CleanupIdleSockets(false);
+  PrewarmGroups();
+}
+
+int ClientSocketPoolBaseHelper::PrewarmGroup(const std::string& group_name,
+                                             const Request& request,
+                                             int target) {
+  Group* group = GetOrCreateGroup(group_name);
+
+  // Waiting requests already get every socket the group can open.
+  if (group->has_pending_requests())
+    return 0;
+
+  int started = 0;
+  for (int num_iterations_left = target;
+       static_cast<int>(group->idle_sockets().size()) +
+               group->unassigned_job_count() <
+           target &&
+       num_iterations_left > 0;
+       num_iterations_left--) {
+    // Prewarming never closes another group's idle sockets to make room.
+    if (!group->HasAvailableSocketSlot(max_sockets_per_group_) ||
+        ReachedMaxSocketsLimit()) {
+      break;
+    }
+    int rv = RequestSocketInternal(group_name, request);
+    if (rv < 0 && rv != ERR_IO_PENDING) {
+      // RequestSocketInternal() has already removed the group if it is empty.
+      return started;
+    }
+    started++;
+  }
+
+  if (group->IsEmpty())
+    RemoveGroup(group_name);
+  return started;
+}
+
 ClientSocketPoolBaseHelper::Group::Group()
     : unassigned_job_count_(0),
       pending_requests_(NUM_PRIORITIES),
@@ -52,6 +52,7 @@
 #include "net/log/net_log.h"
 #include "net/socket/client_socket_handle.h"
 #include "net/socket/client_socket_pool.h"
+#include "net/socket/client_socket_pool_prewarmer.h"
 #include "net/socket/stream_socket.h"
 
 namespace net {
@@ -185,6 +186,11 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
     virtual ~Request();
 
+    // Returns an IDLE priority preconnect request for the same parameters as
+    // this one, for the pool to open sockets with ahead of demand. Returns
+    // NULL if the request can't be copied that way.
+    virtual std::unique_ptr<const Request> CreatePrewarmRequest() const;
+
     ClientSocketHandle* handle() const { return handle_; }
     const CompletionCallback& callback() const { return callback_; }
     RequestPriority priority() const { return priority_; }
@@ -342,6 +348,14 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
   void EnableConnectBackupJobs();
 
+  static bool prewarming_enabled();
+  static bool set_prewarming_enabled(bool enabled);
+
+  // Makes the pool keep idle sockets connected for the groups it is asked for
+  // most often, as decided by a ClientSocketPoolPrewarmer with |params|. Does
+  // nothing unless prewarming is enabled globally.
+  void EnablePrewarming(const ClientSocketPoolPrewarmer::Params& params);
+
   // ConnectJob::Delegate methods:
   void OnConnectJobComplete(int result, ConnectJob* job) override;
 
@@ -517,6 +531,10 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   typedef std::map<const ClientSocketHandle*, CallbackResultPair>
       PendingCallbackMap;
 
+  // The requests used to prewarm sockets, keyed by group name.
+  typedef std::map<std::string, std::unique_ptr<const Request>>
+      PrewarmRequestMap;
+
   Group* GetOrCreateGroup(const std::string& group_name);
   void RemoveGroup(const std::string& group_name);
   void RemoveGroup(GroupMap::iterator it);
@@ -601,6 +619,34 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // this pool is stalled.
   void TryToCloseSocketsInLayeredPools();
 
+  // Records |request| as demand for |group_name|, and remembers how to prewarm
+  // the group if that makes it hot.  Returns true if the group was already
+  // being prewarmed before |request|.
+  bool RecordPrewarmDemand(const std::string& group_name,
+                           const Request& request);
+
+  // Records whether a request in a prewarmed group was given an already
+  // connected socket.
+  void RecordPrewarmResult(bool hit, const BoundNetLog& net_log);
+
+  // Posts a task to run PrewarmGroups(), and starts |prewarm_timer_|.
+  void SchedulePrewarm();
+
+  // Opens sockets for every hot group that has fewer idle sockets than its
+  // target, and stops tracking groups that cooled down.
+  void PrewarmGroups();
+
+  // Called by |prewarm_timer_| to replace idle sockets that timed out or were
+  // closed by the server.
+  void OnPrewarmTimerFired();
+
+  // Starts preconnects for |group_name| with |request| until it has |target|
+  // idle or connecting sockets, or reaches a socket limit.  Returns the number
+  // of preconnects started.
+  int PrewarmGroup(const std::string& group_name,
+                   const Request& request,
+                   int target);
+
   GroupMap group_map_;
 
   // Map of the ClientSocketHandles for which we have a pending Task to invoke a
@@ -650,6 +696,25 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // will remove itself from all lower layered pools on destruction.
   std::set<LowerLayeredPool*> lower_pools_;
 
+  // Decides which groups to prewarm.  NULL unless EnablePrewarming() was called
+  // with prewarming enabled.
+  std::unique_ptr<ClientSocketPoolPrewarmer> prewarmer_;
+
+  // How to open sockets for each group |prewarmer_| wants warm.
+  PrewarmRequestMap prewarm_requests_;
+
+  // Periodically tops up the groups in |prewarm_requests_|.
+  base::RepeatingTimer prewarm_timer_;
+
+  // True if a PrewarmGroups() task has been posted and hasn't run yet.
+  bool prewarm_task_pending_;
+
+  // Requests in prewarmed groups that were or weren't given an already
+  // connected socket, and the number of sockets started by prewarming.
+  int prewarm_hit_count_;
+  int prewarm_miss_count_;
+  int prewarmed_socket_count_;
+
   base::WeakPtrFactory<ClientSocketPoolBaseHelper> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(ClientSocketPoolBaseHelper);
@@ -677,6 +742,15 @@ class ClientSocketPoolBase {
                                                         net_log),
           params_(params) {}
 
+    std::unique_ptr<const internal::ClientSocketPoolBaseHelper::Request>
+    CreatePrewarmRequest() const override {
+      return std::unique_ptr<const Request>(new Request(
+          nullptr /* no handle */, CompletionCallback(), IDLE,
+          ClientSocketPool::RespectLimits::ENABLED,
+          internal::ClientSocketPoolBaseHelper::NO_IDLE_SOCKETS, params_,
+          BoundNetLog()));
+    }
+
     const scoped_refptr<SocketParams>& params() const { return params_; }
 
    private:
@@ -826,6 +900,10 @@ class ClientSocketPoolBase {
 
   void EnableConnectBackupJobs() { helper_.EnableConnectBackupJobs(); }
 
+  void EnablePrewarming(const ClientSocketPoolPrewarmer::Params& params) {
+    helper_.EnablePrewarming(params);
+  }
+
   bool CloseOneIdleSocket() { return helper_.CloseOneIdleSocket(); }
 
   bool CloseOneIdleConnectionInHigherLayeredPool() {
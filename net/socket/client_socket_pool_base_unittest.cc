@@ -594,6 +594,10 @@ class TestClientSocketPool : public ClientSocketPool {
 
   void EnableConnectBackupJobs() { base_.EnableConnectBackupJobs(); }
 
+  void EnablePrewarming(const ClientSocketPoolPrewarmer::Params& params) {
+    base_.EnablePrewarming(params);
+  }
+
   bool CloseOneIdleConnectionInHigherLayeredPool() {
     return base_.CloseOneIdleConnectionInHigherLayeredPool();
   }
@@ -3485,6 +3489,10 @@ class MockLayeredPool : public HigherLayeredPool {
 
   MOCK_METHOD0(CloseOneIdleConnection, bool());
 
+  bool HasGroup(const std::string& group_name) const override {
+    return group_name == group_name_;
+  }
+
  private:
   TestClientSocketPool* const pool_;
   ClientSocketHandle handle_;
@@ -3770,6 +3778,195 @@ TEST_F(ClientSocketPoolBaseTest, IgnoreLimitsCancelOtherJob) {
   EXPECT_FALSE(request(1)->have_result());
 }
 
+class ClientSocketPoolBasePrewarmingTest : public ClientSocketPoolBaseTest {
+ protected:
+  ClientSocketPoolBasePrewarmingTest() {
+    prewarming_enabled_ =
+        internal::ClientSocketPoolBaseHelper::set_prewarming_enabled(true);
+    // Make every group hot from its first request.
+    prewarm_params_.min_requests_per_minute = 0.1;
+  }
+
+  ~ClientSocketPoolBasePrewarmingTest() override {
+    internal::ClientSocketPoolBaseHelper::set_prewarming_enabled(
+        prewarming_enabled_);
+  }
+
+  void CreatePrewarmingPool(int max_sockets, int max_sockets_per_group) {
+    CreatePool(max_sockets, max_sockets_per_group);
+    pool_->EnablePrewarming(prewarm_params_);
+  }
+
+  ClientSocketPoolPrewarmer::Params prewarm_params_;
+
+ private:
+  bool prewarming_enabled_;
+};
+
+TEST_F(ClientSocketPoolBasePrewarmingTest, DisabledByDefault) {
+  internal::ClientSocketPoolBaseHelper::set_prewarming_enabled(false);
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+
+  ClientSocketHandle handle;
+  TestCompletionCallback callback;
+  EXPECT_EQ(OK, handle.Init("a", params_, DEFAULT_PRIORITY,
+                            ClientSocketPool::RespectLimits::ENABLED,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("a"));
+}
+
+TEST_F(ClientSocketPoolBasePrewarmingTest, PrewarmsHotGroup) {
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+
+  ClientSocketHandle handle1;
+  TestCompletionCallback callback1;
+  EXPECT_EQ(OK, handle1.Init("a", params_, DEFAULT_PRIORITY,
+                             ClientSocketPool::RespectLimits::ENABLED,
+                             callback1.callback(), pool_.get(), BoundNetLog()));
+  // Prewarming happens asynchronously.
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("a"));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, pool_->IdleSocketCountInGroup("a"));
+
+  // The next request gets the warm socket.
+  ClientSocketHandle handle2;
+  TestCompletionCallback callback2;
+  BoundTestNetLog log;
+  EXPECT_EQ(OK, handle2.Init("a", params_, DEFAULT_PRIORITY,
+                             ClientSocketPool::RespectLimits::ENABLED,
+                             callback2.callback(), pool_.get(), log.bound()));
+  EXPECT_EQ(ClientSocketHandle::UNUSED_IDLE, handle2.reuse_type());
+
+  TestNetLogEntry::List entries;
+  log.GetEntries(&entries);
+  size_t pos = ExpectLogContainsSomewhere(
+      entries, 0, NetLog::TYPE_SOCKET_POOL_PREWARM_RESULT, NetLog::PHASE_NONE);
+  bool hit = false;
+  EXPECT_TRUE(entries[pos].GetBooleanValue("hit", &hit));
+  EXPECT_TRUE(hit);
+
+  std::unique_ptr<base::DictionaryValue> info =
+      pool_->GetInfoAsValue("pool", "type", false);
+  int count = 0;
+  EXPECT_TRUE(info->GetInteger("prewarm_hit_count", &count));
+  EXPECT_EQ(1, count);
+  EXPECT_TRUE(info->GetInteger("prewarm_miss_count", &count));
+  EXPECT_EQ(0, count);
+  EXPECT_TRUE(info->GetInteger("prewarmed_socket_count", &count));
+  EXPECT_EQ(1, count);
+}
+
+// Sockets requested at IDLE priority, like a higher layered pool's prewarming,
+// don't count as demand.
+TEST_F(ClientSocketPoolBasePrewarmingTest, IdlePriorityIsNotDemand) {
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+
+  ClientSocketHandle handle;
+  TestCompletionCallback callback;
+  EXPECT_EQ(OK, handle.Init("a", params_, IDLE,
+                            ClientSocketPool::RespectLimits::ENABLED,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("a"));
+}
+
+TEST_F(ClientSocketPoolBasePrewarmingTest, RespectsGroupLimit) {
+  // Ask for more warm sockets than the group may have.
+  prewarm_params_.socket_hold_time = base::TimeDelta::FromHours(1);
+  prewarm_params_.max_idle_sockets_per_group = 4;
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+
+  ClientSocketHandle handle;
+  TestCompletionCallback callback;
+  EXPECT_EQ(OK, handle.Init("a", params_, DEFAULT_PRIORITY,
+                            ClientSocketPool::RespectLimits::ENABLED,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(kDefaultMaxSocketsPerGroup - 1, pool_->IdleSocketCountInGroup("a"));
+}
+
+TEST_F(ClientSocketPoolBasePrewarmingTest, RespectsPoolLimit) {
+  CreatePrewarmingPool(2, 2);
+
+  ClientSocketHandle handle1;
+  TestCompletionCallback callback1;
+  EXPECT_EQ(OK, handle1.Init("a", params_, DEFAULT_PRIORITY,
+                             ClientSocketPool::RespectLimits::ENABLED,
+                             callback1.callback(), pool_.get(), BoundNetLog()));
+  ClientSocketHandle handle2;
+  TestCompletionCallback callback2;
+  EXPECT_EQ(OK, handle2.Init("b", params_, DEFAULT_PRIORITY,
+                             ClientSocketPool::RespectLimits::ENABLED,
+                             callback2.callback(), pool_.get(), BoundNetLog()));
+  base::RunLoop().RunUntilIdle();
+
+  // Neither group gets a warm socket, and neither loses its socket to the
+  // other.
+  EXPECT_EQ(0, pool_->IdleSocketCount());
+  EXPECT_EQ(1, pool_->NumActiveSocketsInGroup("a"));
+  EXPECT_EQ(1, pool_->NumActiveSocketsInGroup("b"));
+}
+
+TEST_F(ClientSocketPoolBasePrewarmingTest, FlushStopsPrewarming) {
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+
+  ClientSocketHandle handle;
+  TestCompletionCallback callback;
+  EXPECT_EQ(OK, handle.Init("a", params_, DEFAULT_PRIORITY,
+                            ClientSocketPool::RespectLimits::ENABLED,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  pool_->FlushWithError(ERR_NETWORK_CHANGED);
+  handle.Reset();
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, pool_->IdleSocketCount());
+}
+
+// Demand seen before a flush doesn't make the group hot afterwards.
+TEST_F(ClientSocketPoolBasePrewarmingTest, FlushForgetsDemand) {
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+
+  ClientSocketHandle handle1;
+  TestCompletionCallback callback1;
+  EXPECT_EQ(OK, handle1.Init("a", params_, DEFAULT_PRIORITY,
+                             ClientSocketPool::RespectLimits::ENABLED,
+                             callback1.callback(), pool_.get(), BoundNetLog()));
+  pool_->FlushWithError(ERR_NETWORK_CHANGED);
+  handle1.Reset();
+
+  // The group starts cold again, so this request is neither a hit nor a miss.
+  ClientSocketHandle handle2;
+  TestCompletionCallback callback2;
+  EXPECT_EQ(OK, handle2.Init("a", params_, DEFAULT_PRIORITY,
+                             ClientSocketPool::RespectLimits::ENABLED,
+                             callback2.callback(), pool_.get(), BoundNetLog()));
+  std::unique_ptr<base::DictionaryValue> info =
+      pool_->GetInfoAsValue("pool", "type", false);
+  int count = 0;
+  EXPECT_TRUE(info->GetInteger("prewarm_miss_count", &count));
+  EXPECT_EQ(0, count);
+}
+
+// A group that belongs to a higher layered pool is left to that pool to
+// prewarm.
+TEST_F(ClientSocketPoolBasePrewarmingTest, HigherLayeredPoolOwnsGroup) {
+  CreatePrewarmingPool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+  MockLayeredPool mock_layered_pool(pool_.get(), "a");
+
+  EXPECT_EQ(OK, mock_layered_pool.RequestSocket(pool_.get()));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("a"));
+
+  // Other groups are still prewarmed.
+  ClientSocketHandle handle;
+  TestCompletionCallback callback;
+  EXPECT_EQ(OK, handle.Init("b", params_, DEFAULT_PRIORITY,
+                            ClientSocketPool::RespectLimits::ENABLED,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, pool_->IdleSocketCountInGroup("b"));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -0,0 +1,105 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/client_socket_pool_prewarmer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/logging.h"
+
+namespace net {
+
+ClientSocketPoolPrewarmer::Params::Params()
+    : demand_half_life(base::TimeDelta::FromSeconds(60)),
+      min_requests_per_minute(6),
+      socket_hold_time(base::TimeDelta::FromSeconds(1)),
+      max_idle_sockets_per_group(2),
+      max_tracked_groups(32),
+      refresh_interval(base::TimeDelta::FromSeconds(5)) {}
+
+ClientSocketPoolPrewarmer::ClientSocketPoolPrewarmer(const Params& params)
+    : params_(params) {
+  DCHECK_GT(params_.demand_half_life, base::TimeDelta());
+  DCHECK_GT(params_.max_idle_sockets_per_group, 0);
+  DCHECK_GT(params_.max_tracked_groups, 0u);
+}
+
+ClientSocketPoolPrewarmer::~ClientSocketPoolPrewarmer() {}
+
+void ClientSocketPoolPrewarmer::OnSocketRequested(const std::string& group_name,
+                                                  base::TimeTicks now) {
+  GroupDemandMap::iterator it = groups_.find(group_name);
+  if (it == groups_.end()) {
+    if (groups_.size() >= params_.max_tracked_groups)
+      EvictColdestGroup(now);
+    GroupDemand demand = {0, now};
+    it = groups_.insert(std::make_pair(group_name, demand)).first;
+  }
+  it->second.score = DecayedScore(it->second, now) + 1;
+  it->second.last_update = now;
+}
+
+double ClientSocketPoolPrewarmer::GetRequestsPerMinute(
+    const std::string& group_name,
+    base::TimeTicks now) const {
+  GroupDemandMap::const_iterator it = groups_.find(group_name);
+  if (it == groups_.end())
+    return 0;
+  return ScoreToRequestsPerMinute(DecayedScore(it->second, now));
+}
+
+int ClientSocketPoolPrewarmer::GetTargetIdleSocketCount(
+    const std::string& group_name,
+    base::TimeTicks now) const {
+  double requests_per_minute = GetRequestsPerMinute(group_name, now);
+  if (requests_per_minute <= 0 ||
+      requests_per_minute < params_.min_requests_per_minute) {
+    return 0;
+  }
+  // Little's law: the number of requests holding a socket at any one time.
+  double busy_sockets =
+      requests_per_minute / 60 * params_.socket_hold_time.InSecondsF();
+  double target =
+      std::min(std::ceil(busy_sockets),
+               static_cast<double>(params_.max_idle_sockets_per_group));
+  return std::max(1, static_cast<int>(target));
+}
+
+void ClientSocketPoolPrewarmer::Clear() {
+  groups_.clear();
+}
+
+double ClientSocketPoolPrewarmer::DecayedScore(const GroupDemand& demand,
+                                               base::TimeTicks now) const {
+  if (now <= demand.last_update)
+    return demand.score;
+  double half_lives = (now - demand.last_update).InSecondsF() /
+                      params_.demand_half_life.InSecondsF();
+  return demand.score * std::exp2(-half_lives);
+}
+
+double ClientSocketPoolPrewarmer::ScoreToRequestsPerMinute(
+    double score) const {
+  // At a steady rate of r requests per second, the score converges to
+  // r * demand_half_life / ln(2).
+  return score * std::log(2.0) / params_.demand_half_life.InSecondsF() * 60;
+}
+
+void ClientSocketPoolPrewarmer::EvictColdestGroup(base::TimeTicks now) {
+  GroupDemandMap::iterator coldest = groups_.end();
+  double coldest_score = 0;
+  for (GroupDemandMap::iterator it = groups_.begin(); it != groups_.end();
+       ++it) {
+    double score = DecayedScore(it->second, now);
+    if (coldest == groups_.end() || score < coldest_score) {
+      coldest = it;
+      coldest_score = score;
+    }
+  }
+  if (coldest != groups_.end())
+    groups_.erase(coldest);
+}
+
+}  // namespace net
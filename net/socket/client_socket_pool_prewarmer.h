@@ -0,0 +1,106 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SOCKET_CLIENT_SOCKET_POOL_PREWARMER_H_
+#define NET_SOCKET_CLIENT_SOCKET_POOL_PREWARMER_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <string>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// ClientSocketPoolPrewarmer learns how often each group of a socket pool is
+// asked for sockets, and decides how many idle sockets a group should keep
+// connected so that its next requests don't have to wait for a new
+// connection. It only makes decisions; ClientSocketPoolBaseHelper opens and
+// closes the sockets.
+//
+// Demand is an exponentially decaying count of requests, so a group that
+// stops being used cools down on its own. The number of sockets a hot group
+// needs follows Little's law: the request rate times how long a request
+// holds on to its socket.
+class NET_EXPORT_PRIVATE ClientSocketPoolPrewarmer {
+ public:
+  struct NET_EXPORT_PRIVATE Params {
+    Params();
+
+    // How quickly past requests stop counting towards a group's demand.
+    base::TimeDelta demand_half_life;
+
+    // Groups requested less often than this get no warm sockets.
+    double min_requests_per_minute;
+
+    // How long a request typically keeps its socket.
+    base::TimeDelta socket_hold_time;
+
+    // Upper bound on the number of warm idle sockets per group. The pool's
+    // own per-group and global limits also apply.
+    int max_idle_sockets_per_group;
+
+    // Upper bound on the number of groups whose demand is tracked. The
+    // coldest group is forgotten to make room for a new one.
+    size_t max_tracked_groups;
+
+    // How often the pool tops warm groups back up, replacing sockets that
+    // timed out or were closed by the server.
+    base::TimeDelta refresh_interval;
+  };
+
+  explicit ClientSocketPoolPrewarmer(const Params& params);
+  ~ClientSocketPoolPrewarmer();
+
+  const Params& params() const { return params_; }
+
+  // Records a request for a socket in |group_name| at |now|.
+  void OnSocketRequested(const std::string& group_name, base::TimeTicks now);
+
+  // Returns the estimated number of requests per minute for |group_name| at
+  // |now|.
+  double GetRequestsPerMinute(const std::string& group_name,
+                              base::TimeTicks now) const;
+
+  // Returns the number of idle sockets |group_name| should have at |now|, not
+  // counting the pool's limits.
+  int GetTargetIdleSocketCount(const std::string& group_name,
+                               base::TimeTicks now) const;
+
+  // Forgets all recorded demand.
+  void Clear();
+
+  size_t tracked_group_count() const { return groups_.size(); }
+
+ private:
+  struct GroupDemand {
+    // Sum over past requests of 2^(-age / demand_half_life), as of
+    // |last_update|.
+    double score;
+    base::TimeTicks last_update;
+  };
+
+  typedef std::map<std::string, GroupDemand> GroupDemandMap;
+
+  // Returns the score of |demand| decayed to |now|.
+  double DecayedScore(const GroupDemand& demand, base::TimeTicks now) const;
+
+  // Returns the requests per minute a decayed |score| stands for.
+  double ScoreToRequestsPerMinute(double score) const;
+
+  // Removes the group with the lowest decayed score at |now|.
+  void EvictColdestGroup(base::TimeTicks now);
+
+  const Params params_;
+  GroupDemandMap groups_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClientSocketPoolPrewarmer);
+};
+
+}  // namespace net
+
+#endif  // NET_SOCKET_CLIENT_SOCKET_POOL_PREWARMER_H_
@@ -0,0 +1,472 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// The tests in this file estimate through simulation how prewarming idle
+// sockets with ClientSocketPoolPrewarmer changes:
+// a) how often a request finds a connected socket waiting for it, and
+// b) how many connections are opened for nothing.
+// The pool and the servers are simple models of ClientSocketPoolBaseHelper
+// and of servers closing idle connections; the prewarming decisions are made
+// by the real ClientSocketPoolPrewarmer. Set SHOW_SIMULATION_RESULTS in your
+// environment to see the numbers, e.g. while tuning
+// ClientSocketPoolPrewarmer::Params.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/environment.h"
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "net/socket/client_socket_pool_prewarmer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::TimeDelta;
+using base::TimeTicks;
+
+namespace net {
+namespace {
+
+// Set this variable in your environment if you want to see verbose results
+// of the simulation tests.
+const char kShowSimulationVariableName[] = "SHOW_SIMULATION_RESULTS";
+
+// How long it takes to connect a socket, including any TLS handshake.
+const int kConnectTimeMs = 300;
+
+// How long a request keeps its socket.
+const int kRequestTimeMs = 1000;
+
+// Servers close connections that were idle for this long.
+const int kServerIdleTimeoutSeconds = 15;
+
+// The pool's own idle socket timeouts, as in ClientSocketPool.
+const int kUnusedIdleSocketTimeoutSeconds = 10;
+const int kUsedIdleSocketTimeoutSeconds = 300;
+
+const int kMaxSocketsPerGroup = 6;
+
+const int kTickMs = 100;
+
+// Prints output only if a given environment variable is set. We use this
+// to not print any output for human evaluation when the test is run without
+// supervision.
+void VerboseOut(const char* format, ...) {
+  static bool have_checked_environment = false;
+  static bool should_print = false;
+  if (!have_checked_environment) {
+    have_checked_environment = true;
+    std::unique_ptr<base::Environment> env(base::Environment::Create());
+    if (env->HasVar(kShowSimulationVariableName))
+      should_print = true;
+  }
+
+  if (should_print) {
+    va_list arglist;
+    va_start(arglist, format);
+    vprintf(format, arglist);
+    va_end(arglist);
+  }
+}
+
+// A simple two-phase discrete time simulation. Actors are added in the order
+// they should take action at every tick of the clock. Ticks of the clock
+// are two-phase:
+// - Phase 1 advances every actor's time to a new absolute time.
+// - Phase 2 asks each actor to perform their action.
+class DiscreteTimeSimulation {
+ public:
+  class Actor {
+   public:
+    virtual ~Actor() {}
+    virtual void AdvanceTime(const TimeTicks& absolute_time) = 0;
+    virtual void PerformAction() = 0;
+  };
+
+  DiscreteTimeSimulation() {}
+
+  // Adds an |actor| to the simulation. The client of the simulation maintains
+  // ownership of |actor| and must ensure its lifetime exceeds that of the
+  // simulation. Actors should be added in the order you wish for them to
+  // act at each tick of the simulation.
+  void AddActor(Actor* actor) { actors_.push_back(actor); }
+
+  // Runs the simulation for |maximum_simulated_duration|, pretending
+  // |time_between_ticks| passes from one tick to the next.
+  void RunSimulation(const TimeDelta& maximum_simulated_duration,
+                     const TimeDelta& time_between_ticks) {
+    TimeTicks start_time = TimeTicks();
+    TimeTicks now = start_time;
+    while ((now - start_time) <= maximum_simulated_duration) {
+      for (Actor* actor : actors_)
+        actor->AdvanceTime(now);
+      for (Actor* actor : actors_)
+        actor->PerformAction();
+      now += time_between_ticks;
+    }
+  }
+
+ private:
+  std::vector<Actor*> actors_;
+
+  DISALLOW_COPY_AND_ASSIGN(DiscreteTimeSimulation);
+};
+
+// A deterministic random number generator, so that simulations with
+// different parameters see exactly the same traffic.
+class SimulationRandom {
+ public:
+  explicit SimulationRandom(uint64_t seed) : state_(seed) {}
+
+  // Returns a number in [0, 1).
+  double NextDouble() {
+    state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (state_ >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+ private:
+  uint64_t state_;
+};
+
+// Models the idle socket handling of ClientSocketPoolBaseHelper for a set of
+// groups, each talking to a server that closes idle connections after
+// kServerIdleTimeoutSeconds. Must be added to the simulation after all the
+// actors making requests.
+class SimulatedPool : public DiscreteTimeSimulation::Actor {
+ public:
+  struct GroupStats {
+    GroupStats()
+        : requests(0), hits(0), connects(0), prewarm_connects(0), wasted(0) {}
+
+    int requests;
+    // Requests given an already connected socket.
+    int hits;
+    // Sockets connected, for requests or by prewarming.
+    int connects;
+    int prewarm_connects;
+    // Prewarmed sockets that were closed before any request used them.
+    int wasted;
+  };
+
+  typedef std::map<std::string, GroupStats> StatsMap;
+
+  // Prewarms with |params|, or not at all if it is NULL.
+  explicit SimulatedPool(const ClientSocketPoolPrewarmer::Params* params)
+      : request_seen_(false) {
+    if (params)
+      prewarmer_.reset(new ClientSocketPoolPrewarmer(*params));
+  }
+
+  void AdvanceTime(const TimeTicks& absolute_time) override {
+    now_ = absolute_time;
+  }
+
+  void PerformAction() override {
+    for (auto& it : groups_)
+      UpdateGroup(it.first, &it.second);
+
+    // The pool prewarms right after requests make a group hot, and every
+    // refresh interval.
+    if (prewarmer_ &&
+        (request_seen_ ||
+         now_ - last_refresh_ >= prewarmer_->params().refresh_interval)) {
+      for (auto& it : groups_)
+        PrewarmGroup(it.first, &it.second);
+      request_seen_ = false;
+      last_refresh_ = now_;
+    }
+  }
+
+  void RequestSocket(const std::string& group_name) {
+    Group* group = &groups_[group_name];
+    group->stats.requests++;
+    if (prewarmer_) {
+      prewarmer_->OnSocketRequested(group_name, now_);
+      request_seen_ = true;
+    }
+
+    if (!group->idle_sockets.empty()) {
+      // Prefer the most recently used socket, then the oldest unused one.
+      std::vector<IdleSocket>::iterator socket = group->idle_sockets.begin();
+      for (auto it = group->idle_sockets.begin();
+           it != group->idle_sockets.end(); ++it) {
+        if (it->was_used)
+          socket = it;
+      }
+      group->idle_sockets.erase(socket);
+      group->stats.hits++;
+      group->busy_until.push_back(now_ +
+                                  TimeDelta::FromMilliseconds(kRequestTimeMs));
+    } else if (!group->connecting_until.empty()) {
+      // Late binding to a prewarm connect that hasn't finished yet.
+      TimeTicks connected = group->connecting_until.front();
+      group->connecting_until.erase(group->connecting_until.begin());
+      group->busy_until.push_back(connected +
+                                  TimeDelta::FromMilliseconds(kRequestTimeMs));
+    } else {
+      group->stats.connects++;
+      group->busy_until.push_back(
+          now_ + TimeDelta::FromMilliseconds(kConnectTimeMs + kRequestTimeMs));
+    }
+  }
+
+  StatsMap GetStats() const {
+    StatsMap stats;
+    for (const auto& it : groups_)
+      stats[it.first] = it.second.stats;
+    return stats;
+  }
+
+ private:
+  struct IdleSocket {
+    TimeTicks idle_since;
+    bool was_used;
+  };
+
+  struct Group {
+    std::vector<IdleSocket> idle_sockets;
+    // When each socket in use is released.
+    std::vector<TimeTicks> busy_until;
+    // When each prewarm connect that no request has claimed finishes.
+    std::vector<TimeTicks> connecting_until;
+    GroupStats stats;
+  };
+
+  void UpdateGroup(const std::string& group_name, Group* group) {
+    // Requests that are done release their sockets, and connects finish.
+    for (auto it = group->busy_until.begin(); it != group->busy_until.end();) {
+      if (*it > now_) {
+        ++it;
+        continue;
+      }
+      IdleSocket socket = {now_, true};
+      group->idle_sockets.push_back(socket);
+      it = group->busy_until.erase(it);
+    }
+    for (auto it = group->connecting_until.begin();
+         it != group->connecting_until.end();) {
+      if (*it > now_) {
+        ++it;
+        continue;
+      }
+      IdleSocket socket = {now_, false};
+      group->idle_sockets.push_back(socket);
+      it = group->connecting_until.erase(it);
+    }
+
+    // Close idle sockets the server closed or the pool times out, keeping
+    // timed out unused sockets the group wants warm, as CleanupIdleSockets()
+    // does.
+    int warm_sockets_to_keep =
+        prewarmer_ ? prewarmer_->GetTargetIdleSocketCount(group_name, now_) : 0;
+    for (auto it = group->idle_sockets.begin();
+         it != group->idle_sockets.end();) {
+      TimeDelta idle_time = now_ - it->idle_since;
+      TimeDelta timeout = TimeDelta::FromSeconds(
+          it->was_used ? kUsedIdleSocketTimeoutSeconds
+                       : kUnusedIdleSocketTimeoutSeconds);
+      bool close;
+      if (idle_time >= TimeDelta::FromSeconds(kServerIdleTimeoutSeconds)) {
+        close = true;
+      } else if (!it->was_used && warm_sockets_to_keep > 0) {
+        warm_sockets_to_keep--;
+        close = false;
+      } else {
+        close = idle_time >= timeout;
+      }
+      if (!close) {
+        ++it;
+        continue;
+      }
+      // Only prewarming leaves unused sockets behind.
+      if (!it->was_used)
+        group->stats.wasted++;
+      it = group->idle_sockets.erase(it);
+    }
+  }
+
+  void PrewarmGroup(const std::string& group_name, Group* group) {
+    int target = prewarmer_->GetTargetIdleSocketCount(group_name, now_);
+    int warm = static_cast<int>(group->idle_sockets.size() +
+                                group->connecting_until.size());
+    int sockets = warm + static_cast<int>(group->busy_until.size());
+    for (; warm < target && sockets < kMaxSocketsPerGroup; ++warm, ++sockets) {
+      group->connecting_until.push_back(
+          now_ + TimeDelta::FromMilliseconds(kConnectTimeMs));
+      group->stats.connects++;
+      group->stats.prewarm_connects++;
+    }
+  }
+
+  std::unique_ptr<ClientSocketPoolPrewarmer> prewarmer_;
+  std::map<std::string, Group> groups_;
+  TimeTicks now_;
+  TimeTicks last_refresh_;
+  // True if there were requests since the last time groups were prewarmed.
+  bool request_seen_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimulatedPool);
+};
+
+// Requests sockets for a group at random times, at an average rate.
+class RandomRequester : public DiscreteTimeSimulation::Actor {
+ public:
+  RandomRequester(SimulatedPool* pool,
+                  const std::string& group_name,
+                  double requests_per_minute,
+                  uint64_t seed)
+      : pool_(pool),
+        group_name_(group_name),
+        request_probability_(requests_per_minute / 60 * kTickMs / 1000),
+        random_(seed) {}
+
+  void AdvanceTime(const TimeTicks& absolute_time) override {}
+
+  void PerformAction() override {
+    if (random_.NextDouble() < request_probability_)
+      pool_->RequestSocket(group_name_);
+  }
+
+ private:
+  SimulatedPool* const pool_;
+  const std::string group_name_;
+  const double request_probability_;
+  SimulationRandom random_;
+
+  DISALLOW_COPY_AND_ASSIGN(RandomRequester);
+};
+
+// Requests |burst_size| sockets for a group at once, every |period|, like a
+// page that reloads its resources.
+class BurstRequester : public DiscreteTimeSimulation::Actor {
+ public:
+  BurstRequester(SimulatedPool* pool,
+                 const std::string& group_name,
+                 TimeDelta period,
+                 int burst_size)
+      : pool_(pool),
+        group_name_(group_name),
+        period_(period),
+        burst_size_(burst_size) {}
+
+  void AdvanceTime(const TimeTicks& absolute_time) override {
+    now_ = absolute_time;
+  }
+
+  void PerformAction() override {
+    if (!next_burst_.is_null() && now_ < next_burst_)
+      return;
+    for (int i = 0; i < burst_size_; ++i)
+      pool_->RequestSocket(group_name_);
+    next_burst_ = now_ + period_;
+  }
+
+ private:
+  SimulatedPool* const pool_;
+  const std::string group_name_;
+  const TimeDelta period_;
+  const int burst_size_;
+  TimeTicks now_;
+  TimeTicks next_burst_;
+
+  DISALLOW_COPY_AND_ASSIGN(BurstRequester);
+};
+
+// Simulates an hour of traffic to a few kinds of servers, prewarming with
+// |params|, or without prewarming if it is NULL.
+SimulatedPool::StatsMap SimulateTraffic(
+    const ClientSocketPoolPrewarmer::Params* params) {
+  SimulatedPool pool(params);
+  // An API polled every few seconds.
+  RandomRequester frequent(&pool, "frequent", 12, 1);
+  // A page reloading six resources every 20 seconds.
+  BurstRequester bursty(&pool, "bursty", TimeDelta::FromSeconds(20), 6);
+  // A server polled about twice a minute.
+  RandomRequester occasional(&pool, "occasional", 2, 2);
+  // A server hardly ever used.
+  RandomRequester rare(&pool, "rare", 0.2, 3);
+
+  DiscreteTimeSimulation simulation;
+  simulation.AddActor(&frequent);
+  simulation.AddActor(&bursty);
+  simulation.AddActor(&occasional);
+  simulation.AddActor(&rare);
+  simulation.AddActor(&pool);
+  simulation.RunSimulation(TimeDelta::FromHours(1),
+                           TimeDelta::FromMilliseconds(kTickMs));
+  return pool.GetStats();
+}
+
+void PrintStats(const char* title, const SimulatedPool::StatsMap& stats) {
+  VerboseOut("%s\n", title);
+  VerboseOut("  %-12s %8s %8s %8s %8s %8s\n", "group", "requests", "hits",
+             "connects", "prewarm", "wasted");
+  for (const auto& it : stats) {
+    const SimulatedPool::GroupStats& group = it.second;
+    VerboseOut("  %-12s %8d %7.1f%% %8d %8d %8d\n", it.first.c_str(),
+               group.requests,
+               group.requests ? 100.0 * group.hits / group.requests : 0.0,
+               group.connects, group.prewarm_connects, group.wasted);
+  }
+}
+
+TEST(ClientSocketPoolPrewarmerSimulationTest, DefaultParams) {
+  SimulatedPool::StatsMap baseline = SimulateTraffic(nullptr);
+  ClientSocketPoolPrewarmer::Params params;
+  SimulatedPool::StatsMap prewarmed = SimulateTraffic(&params);
+  PrintStats("Without prewarming:", baseline);
+  PrintStats("With prewarming:", prewarmed);
+
+  int hits_gained = 0;
+  int wasted = 0;
+  for (const auto& it : baseline) {
+    SCOPED_TRACE(it.first);
+    const SimulatedPool::GroupStats& before = it.second;
+    const SimulatedPool::GroupStats& after = prewarmed[it.first];
+    ASSERT_EQ(before.requests, after.requests);
+    EXPECT_EQ(0, before.prewarm_connects);
+    // Prewarming never takes a connected socket away from a request.
+    EXPECT_GE(after.hits, before.hits);
+    hits_gained += after.hits - before.hits;
+    wasted += after.wasted;
+  }
+
+  // Servers that are used often enough get warm sockets...
+  EXPECT_GT(prewarmed["bursty"].hits, baseline["bursty"].hits);
+  // ...the others are left alone.
+  EXPECT_EQ(0, prewarmed["rare"].prewarm_connects);
+  EXPECT_EQ(0, prewarmed["occasional"].prewarm_connects);
+  // Every connection wasted buys at least one request a warm socket.
+  EXPECT_LT(wasted, hits_gained);
+}
+
+// Lowering the minimum demand prewarms more groups, at the cost of more
+// connections.
+TEST(ClientSocketPoolPrewarmerSimulationTest, MinRequestsPerMinute) {
+  int last_prewarm_connects = -1;
+  for (double min_requests_per_minute : {20.0, 6.0, 1.0}) {
+    ClientSocketPoolPrewarmer::Params params;
+    params.min_requests_per_minute = min_requests_per_minute;
+    SimulatedPool::StatsMap stats = SimulateTraffic(&params);
+    PrintStats(base::StringPrintf("Prewarming from %.0f requests per minute:",
+                                  min_requests_per_minute)
+                   .c_str(),
+               stats);
+
+    int prewarm_connects = 0;
+    for (const auto& it : stats)
+      prewarm_connects += it.second.prewarm_connects;
+    EXPECT_GE(prewarm_connects, last_prewarm_connects);
+    last_prewarm_connects = prewarm_connects;
+  }
+}
+
+}  // namespace
+}  // namespace net
@@ -0,0 +1,124 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/client_socket_pool_prewarmer.h"
+
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::TimeDelta;
+using base::TimeTicks;
+
+namespace net {
+
+namespace {
+
+ClientSocketPoolPrewarmer::Params TestParams() {
+  ClientSocketPoolPrewarmer::Params params;
+  params.demand_half_life = TimeDelta::FromSeconds(60);
+  params.min_requests_per_minute = 6;
+  params.socket_hold_time = TimeDelta::FromSeconds(1);
+  params.max_idle_sockets_per_group = 4;
+  params.max_tracked_groups = 3;
+  return params;
+}
+
+// Records one request every |interval| for |duration|, starting at |*now|, and
+// leaves |*now| at the time of the last one.
+void RequestSteadily(ClientSocketPoolPrewarmer* prewarmer,
+                     const std::string& group_name,
+                     TimeDelta interval,
+                     TimeDelta duration,
+                     TimeTicks* now) {
+  TimeTicks end = *now + duration;
+  prewarmer->OnSocketRequested(group_name, *now);
+  while (*now + interval <= end) {
+    *now += interval;
+    prewarmer->OnSocketRequested(group_name, *now);
+  }
+}
+
+TEST(ClientSocketPoolPrewarmerTest, UnknownGroupIsCold) {
+  ClientSocketPoolPrewarmer prewarmer(TestParams());
+  EXPECT_EQ(0, prewarmer.GetRequestsPerMinute("a", TimeTicks()));
+  EXPECT_EQ(0, prewarmer.GetTargetIdleSocketCount("a", TimeTicks()));
+}
+
+TEST(ClientSocketPoolPrewarmerTest, OneRequestIsNotDemand) {
+  ClientSocketPoolPrewarmer prewarmer(TestParams());
+  prewarmer.OnSocketRequested("a", TimeTicks());
+  EXPECT_GT(prewarmer.GetRequestsPerMinute("a", TimeTicks()), 0);
+  EXPECT_EQ(0, prewarmer.GetTargetIdleSocketCount("a", TimeTicks()));
+}
+
+TEST(ClientSocketPoolPrewarmerTest, SteadyRateIsLearned) {
+  ClientSocketPoolPrewarmer prewarmer(TestParams());
+  TimeTicks now;
+  // 12 requests per minute for ten half-lives.
+  RequestSteadily(&prewarmer, "a", TimeDelta::FromSeconds(5),
+                  TimeDelta::FromMinutes(10), &now);
+  EXPECT_NEAR(12, prewarmer.GetRequestsPerMinute("a", now), 1.0);
+  // Each request holds a socket for 1/5th of the time.
+  EXPECT_EQ(1, prewarmer.GetTargetIdleSocketCount("a", now));
+
+  // Other groups are unaffected.
+  EXPECT_EQ(0, prewarmer.GetTargetIdleSocketCount("b", now));
+}
+
+TEST(ClientSocketPoolPrewarmerTest, BusyGroupGetsMoreSockets) {
+  ClientSocketPoolPrewarmer prewarmer(TestParams());
+  TimeTicks now;
+  // 150 requests per minute hold 2.5 sockets on average.
+  RequestSteadily(&prewarmer, "a", TimeDelta::FromMilliseconds(400),
+                  TimeDelta::FromMinutes(10), &now);
+  EXPECT_EQ(3, prewarmer.GetTargetIdleSocketCount("a", now));
+
+  // 600 requests per minute would need 10, but the target is capped.
+  RequestSteadily(&prewarmer, "b", TimeDelta::FromMilliseconds(100),
+                  TimeDelta::FromMinutes(10), &now);
+  EXPECT_EQ(4, prewarmer.GetTargetIdleSocketCount("b", now));
+}
+
+TEST(ClientSocketPoolPrewarmerTest, DemandDecays) {
+  ClientSocketPoolPrewarmer prewarmer(TestParams());
+  TimeTicks now;
+  RequestSteadily(&prewarmer, "a", TimeDelta::FromSeconds(5),
+                  TimeDelta::FromMinutes(10), &now);
+  double requests_per_minute = prewarmer.GetRequestsPerMinute("a", now);
+
+  now += TimeDelta::FromSeconds(60);
+  EXPECT_NEAR(requests_per_minute / 2, prewarmer.GetRequestsPerMinute("a", now),
+              0.01);
+  now += TimeDelta::FromSeconds(60);
+  EXPECT_NEAR(requests_per_minute / 4, prewarmer.GetRequestsPerMinute("a", now),
+              0.01);
+  // Below the minimum rate, the group is cold again.
+  EXPECT_EQ(0, prewarmer.GetTargetIdleSocketCount("a", now));
+}
+
+TEST(ClientSocketPoolPrewarmerTest, EvictsColdestGroup) {
+  ClientSocketPoolPrewarmer prewarmer(TestParams());
+  TimeTicks now;
+  RequestSteadily(&prewarmer, "hot", TimeDelta::FromSeconds(1),
+                  TimeDelta::FromMinutes(1), &now);
+  for (int i = 0; i < 5; ++i) {
+    now += TimeDelta::FromSeconds(1);
+    prewarmer.OnSocketRequested("cold" + base::IntToString(i), now);
+    EXPECT_LE(prewarmer.tracked_group_count(), 3u);
+  }
+  EXPECT_GT(prewarmer.GetTargetIdleSocketCount("hot", now), 0);
+  EXPECT_EQ(0, prewarmer.GetRequestsPerMinute("cold0", now));
+  EXPECT_GT(prewarmer.GetRequestsPerMinute("cold4", now), 0);
+
+  prewarmer.Clear();
+  EXPECT_EQ(0u, prewarmer.tracked_group_count());
+  EXPECT_EQ(0, prewarmer.GetTargetIdleSocketCount("hot", now));
+}
+
+}  // namespace
+
+}  // namespace net
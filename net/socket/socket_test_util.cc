@@ -1389,6 +1389,25 @@ NetworkChangeNotifier::NetworkHandle MockUDPClientSocket::GetBoundNetwork()
   return network_;
 }
 
+void MockUDPClientSocket::EnableBatchedIO() {}
+
+bool MockUDPClientSocket::SupportsBatchedIO() const {
+  return false;
+}
+
+int MockUDPClientSocket::ReadMultiple(
+    const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+    std::vector<int>* read_sizes) {
+  NOTREACHED();
+  return ERR_NOT_IMPLEMENTED;
+}
+
+int MockUDPClientSocket::WriteMultiple(
+    const std::vector<scoped_refptr<StringIOBuffer>>& buffers) {
+  NOTREACHED();
+  return ERR_NOT_IMPLEMENTED;
+}
+
 void MockUDPClientSocket::OnReadComplete(const MockRead& data) {
   if (!data_)
     return;
@@ -304,4 +304,8 @@ bool SOCKSClientSocketPool::CloseOneIdleConnection() {
   return base_.CloseOneIdleConnectionInHigherLayeredPool();
 }
 
+bool SOCKSClientSocketPool::HasGroup(const std::string& group_name) const {
+  return base_.HasGroup(group_name);
+}
+
 }  // namespace net
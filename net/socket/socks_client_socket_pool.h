@@ -165,6 +165,7 @@ class NET_EXPORT_PRIVATE SOCKSClientSocketPool
 
   // HigherLayeredPool implementation.
   bool CloseOneIdleConnection() override;
+  bool HasGroup(const std::string& group_name) const override;
 
  private:
   typedef ClientSocketPoolBase<SOCKSSocketParams> PoolBase;
@@ -248,6 +248,7 @@ class NET_EXPORT_PRIVATE SSLClientSocketPool
 
   // HigherLayeredPool implementation.
   bool CloseOneIdleConnection() override;
+  bool HasGroup(const std::string& group_name) const override;
 
  private:
   typedef ClientSocketPoolBase<SSLSocketParams> PoolBase;
@@ -546,6 +546,7 @@ TransportClientSocketPool::TransportClientSocketPool(
                                            socket_performance_watcher_factory,
                                            net_log)) {
   base_.EnableConnectBackupJobs();
+  base_.EnablePrewarming(ClientSocketPoolPrewarmer::Params());
 }
 
 TransportClientSocketPool::~TransportClientSocketPool() {}
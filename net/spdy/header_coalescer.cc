@@ -46,22 +46,9 @@ void HeaderCoalescer::OnHeader(base::StringPiece key, base::StringPiece value) {
     return;
   }
 
-  auto iter = headers_.find(key);
-  if (iter == headers_.end()) {
-    headers_[key] = value;
-  } else {
-    // This header had multiple values, so it must be reconstructed.
-    base::StringPiece v = iter->second;
-    std::string s(v.data(), v.length());
-    if (key == "cookie") {
-      // Obeys section 8.1.2.5 in RFC 7540 for cookie reconstruction.
-      s.append("; ");
-    } else {
-      base::StringPiece("\0", 1).AppendToString(&s);
-    }
-    value.AppendToString(&s);
-    headers_.ReplaceOrAppendHeader(key, s);
-  }
+  // Multiple values are joined in place in |headers_|'s arena, "; " separated
+  // for cookies per RFC 7540 Section 8.1.2.5 and NUL separated otherwise.
+  headers_.AppendValueOrAddHeader(key, value);
 }
 
 SpdyHeaderBlock HeaderCoalescer::release_headers() {
@@ -25,6 +25,22 @@ class NET_EXPORT_PRIVATE HpackHuffmanDecoder {
   typedef uint32_t HuffmanWord;
   typedef size_t HuffmanCodeLength;
 
+  // An entry of the multi-symbol lookup table, which is indexed by the next
+  // kLookupBits bits of input. It holds every symbol whose code fits entirely
+  // within those bits, in order.
+  struct LookupEntry {
+    uint8_t symbols[2];
+    // Number of valid |symbols|; zero if the first code is longer than
+    // kLookupBits.
+    uint8_t symbol_count;
+    // Total length of the codes of |symbols|.
+    uint8_t bit_count;
+  };
+
+  // Number of input bits decoded per table lookup. The shortest code is 5
+  // bits, so a lookup yields at most 2 symbols.
+  static const HuffmanCodeLength kLookupBits = 12;
+
   HpackHuffmanDecoder() = delete;
 
   // Decodes a string that has been encoded using the HPACK Huffman Code (see
@@ -40,6 +56,8 @@ class NET_EXPORT_PRIVATE HpackHuffmanDecoder {
  private:
   friend class test::HpackHuffmanDecoderPeer;
 
+  class LookupTable;
+
   // The following private methods are declared here rather than simply
   // inlined into DecodeString so that they can be tested directly.
 
@@ -61,6 +79,9 @@ class NET_EXPORT_PRIVATE HpackHuffmanDecoder {
   // Converts a canonical symbol to the source symbol (the char in the original
   // string that was encoded).
   static char CanonicalToSource(HuffmanWord canonical);
+
+  // Returns the lookup table entry for the high kLookupBits bits of |bits|.
+  static const LookupEntry& LookupPrefix(HuffmanWord bits);
 };
 
 }  // namespace net
@@ -0,0 +1,144 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/test/perf_time_logger.h"
+#include "net/spdy/hpack/hpack_constants.h"
+#include "net/spdy/hpack/hpack_huffman_decoder.h"
+#include "net/spdy/hpack/hpack_huffman_table.h"
+#include "net/spdy/hpack/hpack_input_stream.h"
+#include "net/spdy/hpack/hpack_output_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 2000;
+
+// Typical request and response header values from browser traffic to large
+// sites. Session identifiers are made up, but keep realistic lengths and
+// character mixes since those determine the Huffman code lengths.
+const char* const kHeaderCorpus[] = {
+    // Requests.
+    "www.example.com",
+    "/search?q=http2+header+compression&oq=http2+header&aqs=chrome.0.0j69i57"
+    "j0l4.5839j0j7&sourceid=chrome&ie=UTF-8",
+    "/static/js/main.4f3b2a1c.chunk.js",
+    "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, "
+    "like Gecko) Chrome/52.0.2743.116 Safari/537.36",
+    "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_11_6) AppleWebKit/537.36 "
+    "(KHTML, like Gecko) Chrome/52.0.2743.116 Safari/537.36",
+    "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;"
+    "q=0.8",
+    "image/webp,image/*,*/*;q=0.8",
+    "gzip, deflate, sdch, br",
+    "en-US,en;q=0.8,de;q=0.6,fr;q=0.4",
+    "https://www.example.com/news/technology/2016/08/article-title-here.html",
+    "NID=84=Zx3kQmB0a9H2lS8fPqW1cE7vT4yR6uN0oI5jK3hG2fD1sA9zX8cV7bN6mM5lK4jH3g"
+    "F2dS1aQ0wE9rT8yU7iO6pL5kJ4hG3fD2sA1; SID=Bw8AAAAxQk9hM2tLcFhmZ3pRdnJ0; "
+    "_ga=GA1.2.1234567890.1470000000; _gid=GA1.2.987654321.1471234567",
+    "max-age=0",
+    "1",
+    "\"5d8c72a5edda8d6a:0\"",
+    "Wed, 17 Aug 2016 18:30:52 GMT",
+    // Responses.
+    "200",
+    "text/html; charset=UTF-8",
+    "application/javascript",
+    "private, max-age=0, must-revalidate, no-transform",
+    "public, max-age=31536000",
+    "Thu, 18 Aug 2016 18:30:52 GMT",
+    "gws",
+    "nginx/1.10.1",
+    "Accept-Encoding,User-Agent",
+    "SAMEORIGIN",
+    "1; mode=block",
+    "max-age=31536000; includeSubDomains; preload",
+    "CP=\"This is not a P3P policy! See g.co/p3phelp for more info.\"",
+    "quic=\":443\"; ma=2592000; v=\"36,35,34,33,32,31,30\"",
+    "NID=84=cQ7vX2bN9mK4lJ6hG8fD1sA3zX5cV7bN9mQ2wE4rT6yU8iO0pL1kJ3hG5fD7sA9z; "
+    "expires=Thu, 16-Feb-2017 18:30:52 GMT; path=/; domain=.example.com; "
+    "HttpOnly",
+    "https://cdn.example.net/assets/fonts/roboto-v15-latin-regular.woff2",
+    "bytes",
+    "HIT",
+    "3f6a2c1b-8e4d-4a7f-9b0c-5d1e2f3a4b5c",
+};
+
+class HpackHuffmanDecoderPerfTest : public testing::Test {
+ protected:
+  HpackHuffmanDecoderPerfTest()
+      : table_(ObtainHpackHuffmanTable()), encoded_bytes_(0) {
+    for (const char* value : kHeaderCorpus) {
+      HpackOutputStream output_stream;
+      table_.EncodeString(value, &output_stream);
+      std::string encoded;
+      output_stream.TakeString(&encoded);
+      decoded_.push_back(value);
+      encoded_.push_back(encoded);
+      encoded_bytes_ += encoded.size();
+    }
+  }
+
+  const HpackHuffmanTable& table_;
+  std::vector<std::string> decoded_;
+  std::vector<std::string> encoded_;
+  size_t encoded_bytes_;
+};
+
+}  // namespace
+
+TEST_F(HpackHuffmanDecoderPerfTest, Decode) {
+  std::string buffer;
+  buffer.reserve(1024);
+  base::PerfTimeLogger timer("Hpack_huffman_decoder_decode_corpus");
+  for (int i = 0; i < kIterations; ++i) {
+    for (const std::string& encoded : encoded_) {
+      HpackInputStream input_stream(encoded);
+      ASSERT_TRUE(HpackHuffmanDecoder::DecodeString(&input_stream, &buffer));
+    }
+  }
+  timer.Done();
+  LOG(INFO) << "Decoded " << encoded_bytes_ * kIterations << " bytes.";
+
+  for (size_t i = 0; i < encoded_.size(); ++i) {
+    HpackInputStream input_stream(encoded_[i]);
+    ASSERT_TRUE(HpackHuffmanDecoder::DecodeString(&input_stream, &buffer));
+    EXPECT_EQ(decoded_[i], buffer);
+  }
+}
+
+// The table-driven decoder that HpackHuffmanDecoder replaced, for reference.
+TEST_F(HpackHuffmanDecoderPerfTest, GenericDecode) {
+  std::string buffer;
+  buffer.reserve(1024);
+  base::PerfTimeLogger timer("Hpack_huffman_table_generic_decode_corpus");
+  for (int i = 0; i < kIterations; ++i) {
+    for (const std::string& encoded : encoded_) {
+      HpackInputStream input_stream(encoded);
+      ASSERT_TRUE(table_.GenericDecodeString(&input_stream, &buffer));
+    }
+  }
+  timer.Done();
+}
+
+TEST_F(HpackHuffmanDecoderPerfTest, Encode) {
+  std::string buffer;
+  base::PerfTimeLogger timer("Hpack_huffman_table_encode_corpus");
+  for (int i = 0; i < kIterations; ++i) {
+    HpackOutputStream output_stream;
+    for (const std::string& decoded : decoded_)
+      table_.EncodeString(decoded, &output_stream);
+    output_stream.TakeString(&buffer);
+  }
+  timer.Done();
+  EXPECT_EQ(encoded_bytes_, buffer.size());
+}
+
+}  // namespace net
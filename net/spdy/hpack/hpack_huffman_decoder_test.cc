@@ -52,6 +52,11 @@ class HpackHuffmanDecoderPeer {
   static char CanonicalToSource(HuffmanWord canonical) {
     return HpackHuffmanDecoder::CanonicalToSource(canonical);
   }
+
+  static const HpackHuffmanDecoder::LookupEntry& LookupPrefix(
+      HuffmanWord bits) {
+    return HpackHuffmanDecoder::LookupPrefix(bits);
+  }
 };
 
 // Tests of the ability to decode the HPACK Huffman Code, defined in:
@@ -163,6 +168,57 @@ TEST_F(HpackHuffmanDecoderTest, DecodeToSource) {
   }
 }
 
+// Every lookup table entry must agree with decoding its index one code at a
+// time, and must include every code that fits in the indexed bits.
+TEST_F(HpackHuffmanDecoderTest, LookupPrefix) {
+  const HuffmanCodeLength kLookupBits = HpackHuffmanDecoder::kLookupBits;
+  for (HuffmanWord index = 0; index < (1u << kLookupBits); ++index) {
+    const HuffmanWord prefix = index << (32 - kLookupBits);
+    // Random low order bits must not affect the entry.
+    const HuffmanWord bits = prefix | (RandUint32() >> kLookupBits);
+    const HpackHuffmanDecoder::LookupEntry& entry =
+        HpackHuffmanDecoderPeer::LookupPrefix(bits);
+
+    HuffmanWord remaining = prefix;
+    HuffmanCodeLength consumed = 0;
+    size_t expected_count = 0;
+    while (expected_count < arraysize(entry.symbols)) {
+      HuffmanCodeLength code_length =
+          HpackHuffmanDecoderPeer::CodeLengthOfPrefix(remaining);
+      if (consumed + code_length > kLookupBits)
+        break;
+      ASSERT_LT(expected_count, entry.symbol_count) << "bits: " << Bits(bits);
+      EXPECT_EQ(DecodeToSource(code_length, remaining),
+                static_cast<uint8_t>(entry.symbols[expected_count]))
+          << "bits: " << Bits(bits);
+      remaining <<= code_length;
+      consumed += code_length;
+      ++expected_count;
+    }
+    EXPECT_EQ(expected_count, entry.symbol_count) << "bits: " << Bits(bits);
+    EXPECT_EQ(consumed, entry.bit_count) << "bits: " << Bits(bits);
+  }
+}
+
+// Strings long enough to exercise the lookup table, mixing short codes with
+// codes too long for it.
+TEST_F(HpackHuffmanDecoderTest, RoundTripMixedCodeLengths) {
+  const std::string kInputs[] = {
+      "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+      "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)",
+      std::string("\x00\x01abc\xff\xfe{}<>|\\^~\x7f", 16),
+      "a",
+      "",
+  };
+  for (const std::string& input : kInputs) {
+    std::string encoded = EncodeString(input);
+    std::string decoded;
+    HpackInputStream input_stream(encoded);
+    EXPECT_TRUE(HpackHuffmanDecoder::DecodeString(&input_stream, &decoded));
+    EXPECT_EQ(input, decoded);
+  }
+}
+
 TEST_F(HpackHuffmanDecoderTest, SpecRequestExamples) {
   std::string buffer;
   std::string test_table[] = {
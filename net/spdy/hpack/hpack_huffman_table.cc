@@ -220,7 +220,10 @@ bool HpackHuffmanTable::IsInitialized() const {
 
 void HpackHuffmanTable::EncodeString(StringPiece in,
                                      HpackOutputStream* out) const {
-  size_t bit_remnant = 0;
+  // Codes are packed into the low bits of |accumulator| and written out 32
+  // bits at a time, rather than a byte (or less) at a time.
+  uint64_t accumulator = 0;
+  size_t bit_count = 0;
   for (size_t i = 0; i != in.size(); i++) {
     uint16_t symbol_id = static_cast<uint8_t>(in[i]);
     CHECK_GT(code_by_id_.size(), symbol_id);
@@ -229,26 +232,23 @@ void HpackHuffmanTable::EncodeString(StringPiece in,
     unsigned length = length_by_id_[symbol_id];
     uint32_t code = code_by_id_[symbol_id] >> (32 - length);
 
-    bit_remnant = (bit_remnant + length) % 8;
-
-    if (length > 24) {
-      out->AppendBits(static_cast<uint8_t>(code >> 24), length - 24);
-      length = 24;
-    }
-    if (length > 16) {
-      out->AppendBits(static_cast<uint8_t>(code >> 16), length - 16);
-      length = 16;
-    }
-    if (length > 8) {
-      out->AppendBits(static_cast<uint8_t>(code >> 8), length - 8);
-      length = 8;
+    accumulator = (accumulator << length) | code;
+    bit_count += length;
+    if (bit_count >= 32) {
+      bit_count -= 32;
+      out->AppendBits32(static_cast<uint32_t>(accumulator >> bit_count), 32);
+      accumulator &= (static_cast<uint64_t>(1) << bit_count) - 1;
     }
-    out->AppendBits(static_cast<uint8_t>(code), length);
   }
+  size_t bit_remnant = bit_count % 8;
   if (bit_remnant != 0) {
     // Pad current byte as required.
-    out->AppendBits(pad_bits_ >> bit_remnant, 8 - bit_remnant);
+    size_t pad_length = 8 - bit_remnant;
+    accumulator = (accumulator << pad_length) | (pad_bits_ >> bit_remnant);
+    bit_count += pad_length;
   }
+  if (bit_count != 0)
+    out->AppendBits32(static_cast<uint32_t>(accumulator), bit_count);
 }
 
 size_t HpackHuffmanTable::EncodedSize(StringPiece in) const {
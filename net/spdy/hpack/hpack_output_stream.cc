@@ -37,6 +37,25 @@ void HpackOutputStream::AppendBits(uint8_t bits, size_t bit_size) {
   bit_offset_ = new_bit_offset % 8;
 }
 
+void HpackOutputStream::AppendBits32(uint32_t bits, size_t bit_size) {
+  DCHECK_GT(bit_size, 0u);
+  DCHECK_LE(bit_size, 32u);
+  DCHECK(bit_size == 32 || (bits >> bit_size) == 0);
+  if (bit_offset_ == 0 && bit_size % 8 == 0) {
+    char bytes[4];
+    size_t byte_count = bit_size / 8;
+    for (size_t i = 0; i < byte_count; ++i)
+      bytes[i] = static_cast<char>(bits >> (bit_size - 8 * (i + 1)));
+    buffer_.append(bytes, byte_count);
+    return;
+  }
+  while (bit_size > 8) {
+    bit_size -= 8;
+    AppendBits(static_cast<uint8_t>(bits >> bit_size), 8);
+  }
+  AppendBits(static_cast<uint8_t>(bits & ((1u << bit_size) - 1)), bit_size);
+}
+
 void HpackOutputStream::AppendPrefix(HpackPrefix prefix) {
   AppendBits(prefix.bits, prefix.bit_size);
 }
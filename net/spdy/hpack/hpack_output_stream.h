@@ -34,6 +34,15 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   // set other than the lower |bit_size| bits.
   void AppendBits(uint8_t bits, size_t bit_size);
 
+  // Appends the lower |bit_size| bits of |bits| to the internal buffer,
+  // most significant bit first.
+  //
+  // |bit_size| must be > 0 and <= 32. |bits| must not have any bits
+  // set other than the lower |bit_size| bits. When the buffer ends on a
+  // byte boundary and |bit_size| is a multiple of 8, the bytes are appended
+  // in one step.
+  void AppendBits32(uint32_t bits, size_t bit_size);
+
   // Simply forwards to AppendBits(prefix.bits, prefix.bit-size).
   void AppendPrefix(HpackPrefix prefix);
 
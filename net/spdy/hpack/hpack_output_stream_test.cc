@@ -44,6 +44,25 @@ TEST(HpackOutputStreamTest, AppendBits) {
   EXPECT_EQ(expected_str, str);
 }
 
+// AppendBits32() must produce the same bytes whether or not the buffer is
+// on a byte boundary, and for sizes that are not multiples of 8.
+TEST(HpackOutputStreamTest, AppendBits32) {
+  HpackOutputStream output_stream;
+
+  // Byte-aligned fast path.
+  output_stream.AppendBits32(0xdeadbeef, 32);
+  output_stream.AppendBits32(0x1234, 16);
+
+  // Unaligned appends, including one that crosses several bytes.
+  output_stream.AppendBits32(0x5, 3);
+  output_stream.AppendBits32(0x1abcdef, 25);
+  output_stream.AppendBits32(0xf, 4);
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ(string("\xde\xad\xbe\xef\x12\x34\xba\xbc\xde\xff", 10), str);
+}
+
 // Utility function to return I as a string encoded with an N-bit
 // prefix.
 string EncodeUint32(uint8_t N, uint32_t I) {
@@ -4,6 +4,9 @@
 
 #include "net/spdy/spdy_http_utils.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <string>
 
 #include "base/strings/string_number_conversions.h"
@@ -44,9 +47,23 @@ bool SpdyHeadersToHttpResponse(const SpdyHeaderBlock& headers,
   SpdyHeaderBlock::const_iterator it = headers.find(":status");
   if (it == headers.end())
     return false;
-  std::string status = it->second.as_string();
-  std::string raw_headers("HTTP/1.1 ");
-  raw_headers.append(status);
+  base::StringPiece status = it->second;
+
+  // Size the buffer up front so that it is filled with a single allocation;
+  // every name and value is copied exactly once, straight out of the block's
+  // storage.
+  size_t raw_headers_size = strlen("HTTP/1.1 ") + status.size() + 1;
+  for (it = headers.begin(); it != headers.end(); ++it) {
+    size_t value_count =
+        1 + std::count(it->second.begin(), it->second.end(), '\0');
+    raw_headers_size +=
+        value_count * (it->first.size() + 2) + it->second.size();
+  }
+
+  std::string raw_headers;
+  raw_headers.reserve(raw_headers_size);
+  raw_headers.append("HTTP/1.1 ");
+  status.AppendToString(&raw_headers);
   raw_headers.push_back('\0');
   for (it = headers.begin(); it != headers.end(); ++it) {
     // For each value, if the server sends a NUL-separated
@@ -57,25 +74,21 @@ bool SpdyHeadersToHttpResponse(const SpdyHeaderBlock& headers,
     // becomes
     //    Set-Cookie: foo\0
     //    Set-Cookie: bar\0
-    std::string value = it->second.as_string();
+    base::StringPiece name = it->first;
+    if (!name.empty() && name[0] == ':')
+      name.remove_prefix(1);
+    base::StringPiece value = it->second;
     size_t start = 0;
     size_t end = 0;
     do {
       end = value.find('\0', start);
-      std::string tval;
-      if (end != value.npos)
-        tval = value.substr(start, (end - start));
-      else
-        tval = value.substr(start);
-      if (it->first[0] == ':')
-        raw_headers.append(it->first.as_string().substr(1));
-      else
-        raw_headers.append(it->first.as_string());
+      name.AppendToString(&raw_headers);
       raw_headers.push_back(':');
-      raw_headers.append(tval);
+      // When |end| is npos the length is clamped to the rest of |value|.
+      value.substr(start, end - start).AppendToString(&raw_headers);
       raw_headers.push_back('\0');
       start = end + 1;
-    } while (end != value.npos);
+    } while (end != base::StringPiece::npos);
   }
 
   response->headers = new HttpResponseHeaders(raw_headers);
@@ -9,6 +9,8 @@
 #include <limits>
 
 #include "net/http/http_request_info.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
 #include "net/spdy/spdy_framer.h"
 #include "net/spdy/spdy_test_utils.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -94,4 +96,31 @@ TEST(SpdyHttpUtilsTest, CreateSpdyHeadersFromHttpRequestConnectHTTP2) {
   EXPECT_EQ("Chrome/1.1", headers["user-agent"]);
 }
 
+TEST(SpdyHttpUtilsTest, SpdyHeadersToHttpResponse) {
+  SpdyHeaderBlock headers;
+  headers[":status"] = "200";
+  headers.AppendValueOrAddHeader("set-cookie", "a=1");
+  headers.AppendValueOrAddHeader("set-cookie", "b=2");
+  headers["content-type"] = "text/html";
+  headers["x-empty"] = "";
+
+  HttpResponseInfo response;
+  ASSERT_TRUE(SpdyHeadersToHttpResponse(headers, &response));
+  EXPECT_TRUE(response.was_fetched_via_spdy);
+  EXPECT_EQ(200, response.headers->response_code());
+  EXPECT_TRUE(response.headers->HasHeaderValue("set-cookie", "a=1"));
+  EXPECT_TRUE(response.headers->HasHeaderValue("set-cookie", "b=2"));
+  EXPECT_TRUE(response.headers->HasHeaderValue("content-type", "text/html"));
+  EXPECT_TRUE(response.headers->HasHeader("x-empty"));
+  EXPECT_TRUE(response.headers->HasHeaderValue("status", "200"));
+}
+
+TEST(SpdyHttpUtilsTest, SpdyHeadersToHttpResponseRequiresStatus) {
+  SpdyHeaderBlock headers;
+  headers["content-type"] = "text/html";
+
+  HttpResponseInfo response;
+  EXPECT_FALSE(SpdyHeadersToHttpResponse(headers, &response));
+}
+
 }  // namespace net
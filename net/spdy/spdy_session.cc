@@ -4,6 +4,8 @@
 
 #include "net/spdy/spdy_session.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <limits>
 #include <map>
@@ -627,6 +629,7 @@ SpdySession::SpdySession(const SpdySessionKey& spdy_session_key,
                          bool enable_ping_based_connection_checking,
                          size_t session_max_recv_window_size,
                          size_t stream_max_recv_window_size,
+                         bool enable_write_coalescing,
                          TimeFunc time_func,
                          ProxyDelegate* proxy_delegate,
                          NetLog* net_log)
@@ -675,6 +678,7 @@ SpdySession::SpdySession(const SpdySessionKey& spdy_session_key,
       enable_sending_initial_data_(enable_sending_initial_data),
       enable_ping_based_connection_checking_(
           enable_ping_based_connection_checking),
+      enable_write_coalescing_(enable_write_coalescing),
       connection_at_risk_of_loss_time_(
           base::TimeDelta::FromSeconds(kDefaultConnectionAtRiskOfLossSeconds)),
       hung_interval_(base::TimeDelta::FromSeconds(kHungIntervalSeconds)),
@@ -1454,50 +1458,25 @@ int SpdySession::DoWrite() {
   } else {
     // Grab the next frame to send.
     SpdyFrameType frame_type = DATA;
-    std::unique_ptr<SpdyBufferProducer> producer;
+    std::unique_ptr<SpdyBuffer> buffer;
     base::WeakPtr<SpdyStream> stream;
-    if (!write_queue_.Dequeue(&frame_type, &producer, &stream)) {
+    int rv = DequeueNextWrite(&frame_type, &buffer, &stream);
+    if (rv == ERR_IO_PENDING) {
       write_state_ = WRITE_STATE_IDLE;
       return ERR_IO_PENDING;
     }
+    if (rv != OK)
+      return rv;
 
-    if (stream.get())
-      CHECK(!stream->IsClosed());
-
-    // Activate the stream only when sending the HEADERS frame to
-    // guarantee monotonically-increasing stream IDs.
-    if (frame_type == HEADERS) {
-      CHECK(stream.get());
-      CHECK_EQ(stream->stream_id(), 0u);
-      std::unique_ptr<SpdyStream> owned_stream =
-          ActivateCreatedStream(stream.get());
-      InsertActivatedStream(std::move(owned_stream));
-
-      if (stream_hi_water_mark_ > kLastStreamId) {
-        CHECK_EQ(stream->stream_id(), kLastStreamId);
-        // We've exhausted the stream ID space, and no new streams may be
-        // created after this one.
-        MakeUnavailable();
-        StartGoingAway(kLastStreamId, ERR_ABORTED);
-      }
-    }
-
-    // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is
-    // fixed.
-    tracked_objects::ScopedTracker tracking_profile1(
-        FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite1"));
-    in_flight_write_ = producer->ProduceBuffer();
-    if (!in_flight_write_) {
-      NOTREACHED();
-      return ERR_UNEXPECTED;
-    }
+    in_flight_write_ = std::move(buffer);
     in_flight_write_frame_type_ = frame_type;
     in_flight_write_frame_size_ = in_flight_write_->GetRemainingSize();
-    DCHECK_GE(in_flight_write_frame_size_,
-              buffered_spdy_framer_->GetFrameMinimumSize());
     in_flight_write_stream_ = stream;
   }
 
+  if (enable_write_coalescing_)
+    CoalesceQueuedWrites();
+
   write_state_ = WRITE_STATE_DO_WRITE_COMPLETE;
 
   // Explicitly store in a scoped_refptr<IOBuffer> to avoid problems
@@ -1506,11 +1485,11 @@ int SpdySession::DoWrite() {
   // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is fixed.
   tracked_objects::ScopedTracker tracking_profile2(
       FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite2"));
+  size_t write_size = 0;
   scoped_refptr<IOBuffer> write_io_buffer =
-      in_flight_write_->GetIOBufferForRemainingData();
+      GetIOBufferForInFlightWrites(&write_size);
   return connection_->socket()->Write(
-      write_io_buffer.get(),
-      in_flight_write_->GetRemainingSize(),
+      write_io_buffer.get(), write_size,
       base::Bind(&SpdySession::PumpWriteLoop,
                  weak_factory_.GetWeakPtr(), WRITE_STATE_DO_WRITE_COMPLETE));
 }
@@ -1528,37 +1507,57 @@ int SpdySession::DoWriteComplete(int result) {
     in_flight_write_frame_type_ = DATA;
     in_flight_write_frame_size_ = 0;
     in_flight_write_stream_.reset();
+    coalesced_writes_.clear();
     write_state_ = WRITE_STATE_DO_WRITE;
     DoDrainSession(static_cast<Error>(result), "Write error");
     return OK;
   }
 
-  // It should not be possible to have written more bytes than our
-  // in_flight_write_.
-  DCHECK_LE(static_cast<size_t>(result),
-            in_flight_write_->GetRemainingSize());
-
-  if (result > 0) {
-    in_flight_write_->Consume(static_cast<size_t>(result));
+  // The write may span |in_flight_write_| and the frames coalesced with it.
+  // Consume them in order, notifying the stream of each frame that has been
+  // fully written.
+  size_t bytes_written = static_cast<size_t>(result);
+  while (bytes_written > 0) {
+    // It should not be possible to have written more bytes than our
+    // in-flight writes.
+    DCHECK(in_flight_write_);
+    size_t consume_size =
+        std::min(bytes_written, in_flight_write_->GetRemainingSize());
+    in_flight_write_->Consume(consume_size);
+    bytes_written -= consume_size;
     if (in_flight_write_stream_.get())
-      in_flight_write_stream_->AddRawSentBytes(static_cast<size_t>(result));
+      in_flight_write_stream_->AddRawSentBytes(consume_size);
 
     // We only notify the stream when we've fully written the pending frame.
-    if (in_flight_write_->GetRemainingSize() == 0) {
-      // It is possible that the stream was cancelled while we were
-      // writing to the socket.
-      if (in_flight_write_stream_.get()) {
-        DCHECK_GT(in_flight_write_frame_size_, 0u);
-        in_flight_write_stream_->OnFrameWriteComplete(
-            in_flight_write_frame_type_,
-            in_flight_write_frame_size_);
-      }
+    if (in_flight_write_->GetRemainingSize() > 0) {
+      DCHECK_EQ(bytes_written, 0u);
+      break;
+    }
+
+    // It is possible that the stream was cancelled while we were
+    // writing to the socket.
+    if (in_flight_write_stream_.get()) {
+      DCHECK_GT(in_flight_write_frame_size_, 0u);
+      in_flight_write_stream_->OnFrameWriteComplete(
+          in_flight_write_frame_type_,
+          in_flight_write_frame_size_);
+    }
 
-      // Cleanup the write which just completed.
+    // Cleanup the write which just completed, and continue with the next
+    // frame written along with it, if any.
+    if (coalesced_writes_.empty()) {
       in_flight_write_.reset();
       in_flight_write_frame_type_ = DATA;
       in_flight_write_frame_size_ = 0;
       in_flight_write_stream_.reset();
+    } else {
+      std::unique_ptr<CoalescedWrite> next_write =
+          std::move(coalesced_writes_.front());
+      coalesced_writes_.pop_front();
+      in_flight_write_ = std::move(next_write->buffer);
+      in_flight_write_frame_type_ = next_write->frame_type;
+      in_flight_write_frame_size_ = next_write->frame_size;
+      in_flight_write_stream_ = next_write->stream;
     }
   }
 
@@ -1566,6 +1565,98 @@ int SpdySession::DoWriteComplete(int result) {
   return OK;
 }
 
+SpdySession::CoalescedWrite::CoalescedWrite()
+    : frame_type(DATA), frame_size(0) {}
+
+SpdySession::CoalescedWrite::~CoalescedWrite() {}
+
+int SpdySession::DequeueNextWrite(SpdyFrameType* frame_type,
+                                  std::unique_ptr<SpdyBuffer>* buffer,
+                                  base::WeakPtr<SpdyStream>* stream) {
+  std::unique_ptr<SpdyBufferProducer> producer;
+  if (!write_queue_.Dequeue(frame_type, &producer, stream))
+    return ERR_IO_PENDING;
+
+  if (stream->get())
+    CHECK(!(*stream)->IsClosed());
+
+  // Activate the stream only when sending the HEADERS frame to
+  // guarantee monotonically-increasing stream IDs.
+  if (*frame_type == HEADERS) {
+    CHECK(stream->get());
+    CHECK_EQ((*stream)->stream_id(), 0u);
+    std::unique_ptr<SpdyStream> owned_stream =
+        ActivateCreatedStream(stream->get());
+    InsertActivatedStream(std::move(owned_stream));
+
+    if (stream_hi_water_mark_ > kLastStreamId) {
+      CHECK_EQ((*stream)->stream_id(), kLastStreamId);
+      // We've exhausted the stream ID space, and no new streams may be
+      // created after this one.
+      MakeUnavailable();
+      StartGoingAway(kLastStreamId, ERR_ABORTED);
+    }
+  }
+
+  // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is
+  // fixed.
+  tracked_objects::ScopedTracker tracking_profile1(
+      FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite1"));
+  *buffer = producer->ProduceBuffer();
+  if (!*buffer) {
+    NOTREACHED();
+    return ERR_UNEXPECTED;
+  }
+  DCHECK_GE((*buffer)->GetRemainingSize(),
+            buffered_spdy_framer_->GetFrameMinimumSize());
+  return OK;
+}
+
+void SpdySession::CoalesceQueuedWrites() {
+  DCHECK(in_flight_write_);
+  size_t write_size = in_flight_write_->GetRemainingSize();
+  for (const auto& coalesced_write : coalesced_writes_)
+    write_size += coalesced_write->buffer->GetRemainingSize();
+
+  // Stop if the session starts draining, as that clears the write queue.
+  while (write_size < static_cast<size_t>(kMaxCoalescedWriteSize) &&
+         availability_state_ != STATE_DRAINING) {
+    std::unique_ptr<CoalescedWrite> coalesced_write(new CoalescedWrite());
+    if (DequeueNextWrite(&coalesced_write->frame_type,
+                         &coalesced_write->buffer,
+                         &coalesced_write->stream) != OK) {
+      return;
+    }
+    coalesced_write->frame_size = coalesced_write->buffer->GetRemainingSize();
+    write_size += coalesced_write->frame_size;
+    coalesced_writes_.push_back(std::move(coalesced_write));
+  }
+}
+
+scoped_refptr<IOBuffer> SpdySession::GetIOBufferForInFlightWrites(
+    size_t* size) {
+  *size = in_flight_write_->GetRemainingSize();
+  if (coalesced_writes_.empty())
+    return in_flight_write_->GetIOBufferForRemainingData();
+
+  for (const auto& coalesced_write : coalesced_writes_)
+    *size += coalesced_write->buffer->GetRemainingSize();
+
+  // StreamSocket has no vectored write, so the frames are copied into a
+  // single buffer, of at most kMaxCoalescedWriteSize plus one frame.
+  scoped_refptr<IOBuffer> io_buffer(new IOBuffer(*size));
+  char* data = io_buffer->data();
+  memcpy(data, in_flight_write_->GetRemainingData(),
+         in_flight_write_->GetRemainingSize());
+  data += in_flight_write_->GetRemainingSize();
+  for (const auto& coalesced_write : coalesced_writes_) {
+    memcpy(data, coalesced_write->buffer->GetRemainingData(),
+           coalesced_write->buffer->GetRemainingSize());
+    data += coalesced_write->buffer->GetRemainingSize();
+  }
+  return io_buffer;
+}
+
 void SpdySession::DcheckGoingAway() const {
 #if DCHECK_IS_ON()
   DCHECK_GE(availability_state_, STATE_GOING_AWAY);
@@ -1893,6 +1984,11 @@ void SpdySession::DeleteStream(std::unique_ptr<SpdyStream> stream, int status) {
     // without notifying |in_flight_write_stream_|.
     in_flight_write_stream_.reset();
   }
+  // Likewise for the frames being written along with it.
+  for (const auto& coalesced_write : coalesced_writes_) {
+    if (coalesced_write->stream.get() == stream.get())
+      coalesced_write->stream.reset();
+  }
 
   write_queue_.RemovePendingWritesForStream(stream->GetWeakPtr());
   stream->OnClose(status);
@@ -2155,7 +2251,7 @@ void SpdySession::OnReceiveCompressedFrame(
 }
 
 int SpdySession::OnInitialResponseHeadersReceived(
-    const SpdyHeaderBlock& response_headers,
+    SpdyHeaderBlock response_headers,
     base::Time response_time,
     base::TimeTicks recv_first_byte_time,
     SpdyStream* stream) {
@@ -2180,7 +2276,7 @@ int SpdySession::OnInitialResponseHeadersReceived(
 
   // May invalidate |stream|.
   int rv = stream->OnInitialResponseHeadersReceived(
-      response_headers, response_time, recv_first_byte_time);
+      std::move(response_headers), response_time, recv_first_byte_time);
   if (rv < 0) {
     DCHECK_NE(rv, ERR_IO_PENDING);
     DCHECK(active_streams_.find(stream_id) == active_streams_.end());
@@ -2260,12 +2356,12 @@ void SpdySession::OnHeaders(SpdyStreamId stream_id,
   if (it->second.waiting_for_reply_headers_frame) {
     it->second.waiting_for_reply_headers_frame = false;
     ignore_result(OnInitialResponseHeadersReceived(
-        headers, response_time, recv_first_byte_time, stream));
+        std::move(headers), response_time, recv_first_byte_time, stream));
   } else if (it->second.stream->IsReservedRemote()) {
     ignore_result(OnInitialResponseHeadersReceived(
-        headers, response_time, recv_first_byte_time, stream));
+        std::move(headers), response_time, recv_first_byte_time, stream));
   } else {
-    int rv = stream->OnAdditionalResponseHeadersReceived(headers);
+    int rv = stream->OnAdditionalResponseHeadersReceived(std::move(headers));
     if (rv < 0) {
       DCHECK_NE(rv, ERR_IO_PENDING);
       DCHECK(active_streams_.find(stream_id) == active_streams_.end());
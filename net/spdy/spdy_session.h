@@ -75,6 +75,11 @@ const int kMaxConcurrentPushedStreams = 1000;
 const int kYieldAfterBytesRead = 32 * 1024;
 const int kYieldAfterDurationMilliseconds = 20;
 
+// If write coalescing is enabled, queued frames are added to a socket write
+// until it holds at least this many bytes, the payload of a full-sized TLS
+// record.
+const int kMaxCoalescedWriteSize = 16 * 1024;
+
 // First and last valid stream IDs. As we always act as the client,
 // start at 1 for the first stream id.
 const SpdyStreamId kFirstStreamId = 1;
@@ -296,6 +301,7 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
               bool enable_ping_based_connection_checking,
               size_t session_max_recv_window_size,
               size_t stream_max_recv_window_size,
+              bool enable_write_coalescing,
               TimeFunc time_func,
               ProxyDelegate* proxy_delegate,
               NetLog* net_log);
@@ -637,6 +643,18 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
     WRITE_STATE_DO_WRITE_COMPLETE,
   };
 
+  // A frame written to the socket in the same write as |in_flight_write_|,
+  // following it.
+  struct CoalescedWrite {
+    CoalescedWrite();
+    ~CoalescedWrite();
+
+    std::unique_ptr<SpdyBuffer> buffer;
+    SpdyFrameType frame_type;
+    size_t frame_size;
+    base::WeakPtr<SpdyStream> stream;
+  };
+
   // Checks whether a stream for the given |url| can be created or
   // retrieved from the set of unclaimed push streams. Returns OK if
   // so. Otherwise, the session is closed and an error <
@@ -733,6 +751,23 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   int DoWrite();
   int DoWriteComplete(int result);
 
+  // Dequeues the next frame from |write_queue_| and produces its buffer,
+  // activating its stream if it is a HEADERS frame. Returns OK and fills in
+  // the out parameters if successful, ERR_IO_PENDING if the write queue is
+  // empty, or another error if the frame could not be produced.
+  int DequeueNextWrite(SpdyFrameType* frame_type,
+                       std::unique_ptr<SpdyBuffer>* buffer,
+                       base::WeakPtr<SpdyStream>* stream);
+
+  // Dequeues frames to write together with |in_flight_write_| into
+  // |coalesced_writes_|, until the write queue is empty or the frames
+  // remaining to be written add up to kMaxCoalescedWriteSize.
+  void CoalesceQueuedWrites();
+
+  // Returns an IOBuffer with the remaining data of |in_flight_write_|
+  // followed by that of |coalesced_writes_|, and sets |size| to its size.
+  scoped_refptr<IOBuffer> GetIOBufferForInFlightWrites(size_t* size);
+
   // TODO(akalin): Rename the Send* and Write* functions below to
   // Enqueue*.
 
@@ -812,7 +847,7 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // Delegates to |stream->OnInitialResponseHeadersReceived()|. If an
   // error is returned, the last reference to |this| may have been
   // released.
-  int OnInitialResponseHeadersReceived(const SpdyHeaderBlock& response_headers,
+  int OnInitialResponseHeadersReceived(SpdyHeaderBlock response_headers,
                                        base::Time response_time,
                                        base::TimeTicks recv_first_byte_time,
                                        SpdyStream* stream);
@@ -1062,6 +1097,9 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // The stream to notify when |in_flight_write_| has been written to
   // the socket completely.
   base::WeakPtr<SpdyStream> in_flight_write_stream_;
+  // The frames that are written after |in_flight_write_| in the same socket
+  // write. Empty unless |enable_write_coalescing_| is true.
+  std::deque<std::unique_ptr<CoalescedWrite>> coalesced_writes_;
 
   // Flag if we're using an SSL connection for this SpdySession.
   bool is_secure_;
@@ -1167,6 +1205,10 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   bool enable_sending_initial_data_;
   bool enable_ping_based_connection_checking_;
 
+  // Whether to write the frames in |write_queue_| to the socket together,
+  // rather than one frame per write.
+  bool enable_write_coalescing_;
+
   // |connection_at_risk_of_loss_time_| is an optimization to avoid sending
   // wasteful preface pings (when we just got some data).
   //
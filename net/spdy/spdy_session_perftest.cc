@@ -0,0 +1,260 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/spdy_session.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_errors.h"
+#include "net/base/privacy_mode.h"
+#include "net/log/net_log.h"
+#include "net/proxy/proxy_server.h"
+#include "net/socket/socket_test_util.h"
+#include "net/spdy/spdy_protocol.h"
+#include "net/spdy/spdy_session_key.h"
+#include "net/spdy/spdy_stream.h"
+#include "net/spdy/spdy_stream_test_util.h"
+#include "net/spdy/spdy_test_util_common.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+const int kNumStreams = 8;
+const int kBodySize = 4 * 1024 * 1024;
+
+const size_t kFrameHeaderSize = 9;
+const uint8_t kDataFrameType = 0;
+
+// A SocketDataProvider that returns the given reads once, then blocks, and
+// accepts every write in full. It counts the writes, and the bytes of DATA
+// frame payload written for each stream.
+class CountingSocketData : public SocketDataProvider {
+ public:
+  CountingSocketData(MockRead* reads, size_t reads_count)
+      : reads_(reads),
+        reads_count_(reads_count),
+        read_index_(0),
+        writes_(0),
+        bytes_written_(0),
+        frame_remaining_(0),
+        frame_stream_id_(0),
+        frame_is_data_(false),
+        data_bytes_written_(0),
+        fairness_sample_point_(0),
+        fairness_(0) {}
+
+  ~CountingSocketData() override {}
+
+  // Records the fairness of the streams once |bytes| bytes of DATA frame
+  // payload have been written in total.
+  void set_fairness_sample_point(int64_t bytes) {
+    fairness_sample_point_ = bytes;
+  }
+
+  int64_t writes() const { return writes_; }
+  int64_t bytes_written() const { return bytes_written_; }
+  int64_t data_bytes_written() const { return data_bytes_written_; }
+
+  // Jain's fairness index of the DATA bytes written per stream at the
+  // sample point: 1 if all streams had written as much, 1 / n if a single
+  // stream out of n had written anything.
+  double fairness() const { return fairness_; }
+
+  // SocketDataProvider implementation.
+  MockRead OnRead() override {
+    if (read_index_ < reads_count_)
+      return reads_[read_index_++];
+    return MockRead(SYNCHRONOUS, ERR_IO_PENDING);
+  }
+
+  MockWriteResult OnWrite(const std::string& data) override {
+    ++writes_;
+    bytes_written_ += data.size();
+    ParseFrames(data);
+    return MockWriteResult(SYNCHRONOUS, data.size());
+  }
+
+  bool AllReadDataConsumed() const override {
+    return read_index_ == reads_count_;
+  }
+
+  bool AllWriteDataConsumed() const override { return true; }
+
+ private:
+  void Reset() override {}
+
+  // Follows the HTTP/2 frames in |data|, which may start or end in the
+  // middle of a frame.
+  void ParseFrames(const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+      if (frame_remaining_ == 0) {
+        size_t header_bytes = std::min(kFrameHeaderSize - frame_header_.size(),
+                                       data.size() - offset);
+        frame_header_.append(data, offset, header_bytes);
+        offset += header_bytes;
+        if (frame_header_.size() < kFrameHeaderSize)
+          return;
+
+        const uint8_t* header =
+            reinterpret_cast<const uint8_t*>(frame_header_.data());
+        frame_remaining_ = (header[0] << 16) | (header[1] << 8) | header[2];
+        frame_is_data_ = header[3] == kDataFrameType;
+        frame_stream_id_ = ((header[5] & 0x7f) << 24) | (header[6] << 16) |
+                           (header[7] << 8) | header[8];
+        frame_header_.clear();
+        continue;
+      }
+
+      size_t payload_bytes = std::min(frame_remaining_, data.size() - offset);
+      if (frame_is_data_)
+        OnDataWritten(frame_stream_id_, payload_bytes);
+      frame_remaining_ -= payload_bytes;
+      offset += payload_bytes;
+    }
+  }
+
+  void OnDataWritten(SpdyStreamId stream_id, size_t bytes) {
+    data_bytes_by_stream_[stream_id] += bytes;
+    int64_t previous_data_bytes_written = data_bytes_written_;
+    data_bytes_written_ += bytes;
+    if (previous_data_bytes_written >= fairness_sample_point_ ||
+        data_bytes_written_ < fairness_sample_point_) {
+      return;
+    }
+
+    double sum = 0;
+    double sum_of_squares = 0;
+    for (const auto& stream_bytes : data_bytes_by_stream_) {
+      sum += stream_bytes.second;
+      sum_of_squares += static_cast<double>(stream_bytes.second) *
+                        stream_bytes.second;
+    }
+    fairness_ = sum * sum / (kNumStreams * sum_of_squares);
+  }
+
+  MockRead* const reads_;
+  const size_t reads_count_;
+  size_t read_index_;
+
+  int64_t writes_;
+  int64_t bytes_written_;
+
+  // State of the frame being written.
+  std::string frame_header_;
+  size_t frame_remaining_;
+  SpdyStreamId frame_stream_id_;
+  bool frame_is_data_;
+
+  std::map<SpdyStreamId, int64_t> data_bytes_by_stream_;
+  int64_t data_bytes_written_;
+  int64_t fairness_sample_point_;
+  double fairness_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingSocketData);
+};
+
+class SpdySessionWritePerfTest : public testing::Test {
+ protected:
+  SpdySessionWritePerfTest() : url_(kDefaultUrl) {}
+
+  // Uploads a body on each of kNumStreams streams of the same priority, and
+  // logs the number of socket writes per MB and how evenly the streams
+  // shared the connection.
+  void RunUploads(const std::string& name, bool enable_write_coalescing) {
+    SpdyTestUtil spdy_util;
+
+    // Open the flow control windows so that nothing stalls.
+    SettingsMap settings;
+    settings[SETTINGS_INITIAL_WINDOW_SIZE] =
+        SettingsFlagsAndValue(SETTINGS_FLAG_NONE, kSpdyMaximumWindowSize);
+    SpdySerializedFrame settings_frame(
+        spdy_util.ConstructSpdySettings(settings));
+    SpdySerializedFrame window_update(spdy_util.ConstructSpdyWindowUpdate(
+        kSessionFlowControlStreamId,
+        kSpdyMaximumWindowSize - kDefaultInitialWindowSize));
+    MockRead reads[] = {
+        MockRead(ASYNC, settings_frame.data(), settings_frame.size()),
+        MockRead(ASYNC, window_update.data(), window_update.size()),
+    };
+    CountingSocketData data(reads, arraysize(reads));
+    data.set_fairness_sample_point(
+        static_cast<int64_t>(kNumStreams) * kBodySize / 2);
+
+    SpdySessionDependencies session_deps;
+    session_deps.host_resolver->set_synchronous_mode(true);
+    session_deps.enable_write_coalescing = enable_write_coalescing;
+    session_deps.socket_factory->AddSocketDataProvider(&data);
+    std::unique_ptr<HttpNetworkSession> http_session =
+        SpdySessionDependencies::SpdyCreateSession(&session_deps);
+
+    SpdySessionKey key(HostPortPair::FromURL(url_), ProxyServer::Direct(),
+                       PRIVACY_MODE_DISABLED);
+    base::WeakPtr<SpdySession> session =
+        CreateInsecureSpdySession(http_session.get(), key, BoundNetLog());
+    base::RunLoop().RunUntilIdle();
+    ASSERT_TRUE(data.AllReadDataConsumed());
+
+    const std::string body(kBodySize, 'a');
+    std::vector<std::unique_ptr<test::StreamDelegateWithBody>> delegates;
+    base::PerfTimeLogger timer(
+        base::StringPrintf("SpdySession_upload_%d_streams_%s", kNumStreams,
+                           name.c_str())
+            .c_str());
+    for (int i = 0; i < kNumStreams; ++i) {
+      base::WeakPtr<SpdyStream> stream = CreateStreamSynchronously(
+          SPDY_REQUEST_RESPONSE_STREAM, session, url_, MEDIUM, BoundNetLog());
+      ASSERT_TRUE(stream);
+      delegates.push_back(
+          base::MakeUnique<test::StreamDelegateWithBody>(stream, body));
+      stream->SetDelegate(delegates.back().get());
+      stream->SendRequestHeaders(
+          spdy_util.ConstructPostHeaderBlock(kDefaultUrl, kBodySize),
+          MORE_DATA_TO_SEND);
+    }
+    base::RunLoop().RunUntilIdle();
+    timer.Done();
+
+    EXPECT_EQ(static_cast<int64_t>(kNumStreams) * kBodySize,
+              data.data_bytes_written());
+    double megabytes = data.bytes_written() / (1024.0 * 1024.0);
+    LOG(INFO) << name << ": " << data.writes() / megabytes
+              << " socket writes per MB, fairness " << data.fairness();
+
+    // Close the streams while their delegates are still alive.
+    session->CloseSessionOnError(ERR_ABORTED, "Benchmark done");
+    base::RunLoop().RunUntilIdle();
+  }
+
+ private:
+  const GURL url_;
+  base::MessageLoopForIO message_loop_;
+};
+
+TEST_F(SpdySessionWritePerfTest, ConcurrentUploads) {
+  RunUploads("one_frame_per_write", false);
+  RunUploads("coalesced_writes", true);
+}
+
+}  // namespace
+
+}  // namespace net
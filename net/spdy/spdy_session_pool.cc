@@ -39,6 +39,7 @@ SpdySessionPool::SpdySessionPool(
     bool enable_ping_based_connection_checking,
     size_t session_max_recv_window_size,
     size_t stream_max_recv_window_size,
+    bool enable_write_coalescing,
     SpdySessionPool::TimeFunc time_func,
     ProxyDelegate* proxy_delegate)
     : http_server_properties_(http_server_properties),
@@ -51,6 +52,7 @@ SpdySessionPool::SpdySessionPool(
           enable_ping_based_connection_checking),
       session_max_recv_window_size_(session_max_recv_window_size),
       stream_max_recv_window_size_(stream_max_recv_window_size),
+      enable_write_coalescing_(enable_write_coalescing),
       time_func_(time_func),
       proxy_delegate_(proxy_delegate) {
   NetworkChangeNotifier::AddIPAddressObserver(this);
@@ -89,8 +91,8 @@ base::WeakPtr<SpdySession> SpdySessionPool::CreateAvailableSessionFromSocket(
       key, http_server_properties_, transport_security_state_,
       verify_domain_authentication_, enable_sending_initial_data_,
       enable_ping_based_connection_checking_, session_max_recv_window_size_,
-      stream_max_recv_window_size_, time_func_, proxy_delegate_,
-      net_log.net_log()));
+      stream_max_recv_window_size_, enable_write_coalescing_, time_func_,
+      proxy_delegate_, net_log.net_log()));
 
   new_session->InitializeWithSocket(std::move(connection), this, is_secure,
                                     certificate_error_code);
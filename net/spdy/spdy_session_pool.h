@@ -52,6 +52,7 @@ class NET_EXPORT SpdySessionPool
                   bool enable_ping_based_connection_checking,
                   size_t session_max_recv_window_size,
                   size_t stream_max_recv_window_size,
+                  bool enable_write_coalescing,
                   SpdySessionPool::TimeFunc time_func,
                   ProxyDelegate* proxy_delegate);
   ~SpdySessionPool() override;
@@ -222,6 +223,7 @@ class NET_EXPORT SpdySessionPool
   bool enable_ping_based_connection_checking_;
   size_t session_max_recv_window_size_;
   size_t stream_max_recv_window_size_;
+  bool enable_write_coalescing_;
   TimeFunc time_func_;
 
   // Determines if a proxy is a trusted SPDY proxy, which is allowed to push
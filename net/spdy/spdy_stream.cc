@@ -50,7 +50,7 @@ std::unique_ptr<base::Value> NetLogSpdyStreamWindowUpdateCallback(
   return std::move(dict);
 }
 
-bool ContainsUppercaseAscii(const std::string& str) {
+bool ContainsUppercaseAscii(base::StringPiece str) {
   return std::any_of(str.begin(), str.end(), base::IsAsciiUpper<char>);
 }
 
@@ -387,7 +387,7 @@ void SpdyStream::SetRequestTime(base::Time t) {
 }
 
 int SpdyStream::OnInitialResponseHeadersReceived(
-    const SpdyHeaderBlock& initial_response_headers,
+    SpdyHeaderBlock initial_response_headers,
     base::Time response_time,
     base::TimeTicks recv_first_byte_time) {
   // SpdySession guarantees that this is called at most once.
@@ -433,11 +433,11 @@ int SpdyStream::OnInitialResponseHeadersReceived(
 
   response_time_ = response_time;
   recv_first_byte_time_ = recv_first_byte_time;
-  return MergeWithResponseHeaders(initial_response_headers);
+  return MergeWithResponseHeaders(std::move(initial_response_headers));
 }
 
 int SpdyStream::OnAdditionalResponseHeadersReceived(
-    const SpdyHeaderBlock& additional_response_headers) {
+    SpdyHeaderBlock additional_response_headers) {
   if (type_ == SPDY_REQUEST_RESPONSE_STREAM) {
     if (response_headers_status_ != RESPONSE_HEADERS_ARE_COMPLETE) {
       session_->ResetStream(
@@ -462,7 +462,7 @@ int SpdyStream::OnAdditionalResponseHeadersReceived(
         "Additional headers received for push stream");
     return ERR_SPDY_PROTOCOL_ERROR;
   }
-  return MergeWithResponseHeaders(additional_response_headers);
+  return MergeWithResponseHeaders(std::move(additional_response_headers));
 }
 
 void SpdyStream::OnPushPromiseHeadersReceived(SpdyHeaderBlock headers) {
@@ -855,7 +855,7 @@ void SpdyStream::QueueNextDataFrame() {
 }
 
 int SpdyStream::MergeWithResponseHeaders(
-    const SpdyHeaderBlock& new_response_headers) {
+    SpdyHeaderBlock new_response_headers) {
   if (new_response_headers.find("transfer-encoding") !=
       new_response_headers.end()) {
     session_->ResetStream(stream_id_, RST_STREAM_PROTOCOL_ERROR,
@@ -866,23 +866,29 @@ int SpdyStream::MergeWithResponseHeaders(
   for (SpdyHeaderBlock::const_iterator it = new_response_headers.begin();
       it != new_response_headers.end(); ++it) {
     // Disallow uppercase headers.
-    if (ContainsUppercaseAscii(it->first.as_string())) {
+    if (ContainsUppercaseAscii(it->first)) {
       session_->ResetStream(
           stream_id_, RST_STREAM_PROTOCOL_ERROR,
           "Upper case characters in header: " + it->first.as_string());
       return ERR_SPDY_PROTOCOL_ERROR;
     }
 
-    SpdyHeaderBlock::iterator it2 =
-        response_headers_.find(it->first.as_string());
     // Disallow duplicate headers.  This is just to be conservative.
-    if (it2 != response_headers_.end()) {
+    if (response_headers_.find(it->first) != response_headers_.end()) {
       session_->ResetStream(stream_id_, RST_STREAM_PROTOCOL_ERROR,
                             "Duplicate header: " + it->first.as_string());
       return ERR_SPDY_PROTOCOL_ERROR;
     }
+  }
 
-    response_headers_.insert(*it);
+  // The first block received is adopted along with its storage, so the names
+  // and values decoded by the framer are never copied. Later blocks are rare
+  // and are appended header by header.
+  if (response_headers_.empty()) {
+    response_headers_ = std::move(new_response_headers);
+  } else {
+    for (const auto& header : new_response_headers)
+      response_headers_.insert(header);
   }
 
   // If delegate_ is not yet attached, we'll call
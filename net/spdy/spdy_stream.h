@@ -293,8 +293,9 @@ class NET_EXPORT_PRIVATE SpdyStream {
 
   // Called at most once by the SpdySession when the initial response headers
   // have been received for this stream. Returns a status code; if it is an
-  // error, the stream was closed by this function.
-  int OnInitialResponseHeadersReceived(const SpdyHeaderBlock& response_headers,
+  // error, the stream was closed by this function. Takes |response_headers| by
+  // value so that they can be adopted without copying each header.
+  int OnInitialResponseHeadersReceived(SpdyHeaderBlock response_headers,
                                        base::Time response_time,
                                        base::TimeTicks recv_first_byte_time);
 
@@ -303,7 +304,7 @@ class NET_EXPORT_PRIVATE SpdyStream {
   // late-bound headers are received for a stream. Returns a status
   // code; if it is an error, the stream was closed by this function.
   int OnAdditionalResponseHeadersReceived(
-      const SpdyHeaderBlock& additional_response_headers);
+      SpdyHeaderBlock additional_response_headers);
 
   // Called by the SpdySession when a frame carrying request headers opening a
   // push stream is received. Stream transits to STATE_RESERVED_REMOTE state.
@@ -474,7 +475,7 @@ class NET_EXPORT_PRIVATE SpdyStream {
   // OnResponseHeadersUpdated() on the delegate (if attached).
   // Returns a status code; if it is an error, the stream was closed
   // by this function.
-  int MergeWithResponseHeaders(const SpdyHeaderBlock& new_response_headers);
+  int MergeWithResponseHeaders(SpdyHeaderBlock new_response_headers);
 
   static std::string DescribeState(State state);
 
@@ -300,14 +300,14 @@ TEST_F(SpdyStreamTest, PushedStream) {
   // Send some basic response headers.
   SpdyHeaderBlock response;
   response[spdy_util_.GetStatusKey()] = "200";
-  stream->OnInitialResponseHeadersReceived(response, response_time,
+  stream->OnInitialResponseHeadersReceived(std::move(response), response_time,
                                            first_byte_time);
 
   // And some more headers.
   // TODO(baranovich): not valid for HTTP 2.
   SpdyHeaderBlock headers;
   headers["alpha"] = "beta";
-  stream->OnAdditionalResponseHeadersReceived(headers);
+  stream->OnAdditionalResponseHeadersReceived(std::move(headers));
 
   EXPECT_EQ(kStreamUrl, stream->GetUrlFromHeaders().spec());
 
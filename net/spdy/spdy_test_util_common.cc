@@ -341,6 +341,7 @@ SpdySessionDependencies::SpdySessionDependencies(
       enable_quic(false),
       session_max_recv_window_size(kDefaultInitialWindowSize),
       stream_max_recv_window_size(kDefaultInitialWindowSize),
+      enable_write_coalescing(false),
       time_func(&base::TimeTicks::Now),
       enable_http2_alternative_service_with_different_host(false),
       net_log(NULL) {
@@ -392,6 +393,7 @@ HttpNetworkSession::Params SpdySessionDependencies::CreateSessionParams(
       session_deps->session_max_recv_window_size;
   params.spdy_stream_max_recv_window_size =
       session_deps->stream_max_recv_window_size;
+  params.enable_spdy_write_coalescing = session_deps->enable_write_coalescing;
   params.time_func = session_deps->time_func;
   params.proxy_delegate = session_deps->proxy_delegate.get();
   params.enable_http2_alternative_service_with_different_host =
@@ -202,6 +202,7 @@ struct SpdySessionDependencies {
   bool enable_quic;
   size_t session_max_recv_window_size;
   size_t stream_max_recv_window_size;
+  bool enable_write_coalescing;
   SpdySession::TimeFunc time_func;
   std::unique_ptr<ProxyDelegate> proxy_delegate;
   bool enable_http2_alternative_service_with_different_host;
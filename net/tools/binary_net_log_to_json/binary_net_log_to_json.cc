@@ -0,0 +1,48 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This utility converts a log written by net::BinaryNetLogObserver to the
+// JSON format that chrome://net-internals imports.
+
+#include <stdio.h>
+
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "net/log/binary_net_log_observer.h"
+
+static int Usage(const char* argv0) {
+  fprintf(stderr, "Usage: %s <binary log file> <output JSON file>\n", argv0);
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+
+  if (argc != 3)
+    return Usage(argv[0]);
+
+  base::FilePath input_filename = base::FilePath::FromUTF8Unsafe(argv[1]);
+  base::FilePath output_filename = base::FilePath::FromUTF8Unsafe(argv[2]);
+
+  std::string binary_log;
+  if (!base::ReadFileToString(input_filename, &binary_log)) {
+    fprintf(stderr, "Failed to read %s\n", argv[1]);
+    return 1;
+  }
+
+  std::string json;
+  if (!net::ConvertBinaryNetLogToJSON(binary_log, &json)) {
+    fprintf(stderr, "%s is not a valid binary NetLog\n", argv[1]);
+    return 1;
+  }
+
+  if (base::WriteFile(output_filename, json.data(), json.size()) == -1) {
+    fprintf(stderr, "Failed to write %s\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,302 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how many queries per second DnsClient resolves against a local
+// stub nameserver that answers every A query with 127.0.0.1. Each run is
+// done with the default client, which connects a new UDP socket for every
+// attempt, and with a client whose queries share a few sockets.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/at_exit.h"
+#include "base/big_endian.h"
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_address.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/dns/dns_client.h"
+#include "net/dns/dns_config_service.h"
+#include "net/dns/dns_protocol.h"
+#include "net/dns/dns_transaction.h"
+#include "net/log/net_log.h"
+#include "net/udp/udp_server_socket.h"
+
+namespace {
+
+const char kQueriesSwitch[] = "queries";
+const char kConcurrencySwitch[] = "concurrency";
+
+const int kDefaultQueries = 20000;
+const int kDefaultConcurrency = 16;
+
+// Answers every query received on a local UDP port. A queries get a single
+// record for 127.0.0.1, other types get an empty answer.
+class StubNameserver {
+ public:
+  StubNameserver()
+      : socket_(nullptr, net::NetLog::Source()),
+        read_buffer_(new net::IOBufferWithSize(net::dns_protocol::kMaxUDPSize)),
+        write_buffer_(
+            new net::IOBufferWithSize(net::dns_protocol::kMaxUDPSize)) {}
+
+  // Starts listening on the loopback interface. Returns a net error code.
+  int Start() {
+    int rv = socket_.Listen(
+        net::IPEndPoint(net::IPAddress::IPv4Localhost(), 0));
+    if (rv != net::OK)
+      return rv;
+    rv = socket_.GetLocalAddress(&address_);
+    if (rv != net::OK)
+      return rv;
+    DoRead();
+    return net::OK;
+  }
+
+  const net::IPEndPoint& address() const { return address_; }
+
+ private:
+  void DoRead() {
+    while (true) {
+      int rv = socket_.RecvFrom(
+          read_buffer_.get(), read_buffer_->size(), &client_address_,
+          base::Bind(&StubNameserver::OnReadComplete, base::Unretained(this)));
+      if (rv == net::ERR_IO_PENDING)
+        return;
+      if (!HandleQuery(rv))
+        return;
+    }
+  }
+
+  void OnReadComplete(int rv) {
+    if (HandleQuery(rv))
+      DoRead();
+  }
+
+  // Replies to the query of |rv| bytes in |read_buffer_|. Returns true if
+  // the next query can be read right away.
+  bool HandleQuery(int rv) {
+    const size_t kHeaderSize = sizeof(net::dns_protocol::Header);
+    if (rv < 0) {
+      LOG(ERROR) << "Stub nameserver read failed: " << net::ErrorToString(rv);
+      return false;
+    }
+    // Ignore datagrams too short to hold a question.
+    if (rv < static_cast<int>(kHeaderSize + 2 * sizeof(uint16_t)))
+      return true;
+
+    // Echo the header and question, and append the answer if asked for an
+    // address.
+    size_t query_size = rv;
+    memcpy(write_buffer_->data(), read_buffer_->data(), query_size);
+    char* header = write_buffer_->data();
+    uint16_t qtype;
+    base::ReadBigEndian<uint16_t>(header + query_size - 2 * sizeof(uint16_t),
+                                  &qtype);
+    bool answer = qtype == net::dns_protocol::kTypeA;
+
+    base::BigEndianWriter header_writer(header + sizeof(uint16_t),
+                                        kHeaderSize - sizeof(uint16_t));
+    header_writer.WriteU16(net::dns_protocol::kFlagResponse |
+                           net::dns_protocol::kFlagRD |
+                           net::dns_protocol::kFlagRA);
+    header_writer.WriteU16(1);  // qdcount
+    header_writer.WriteU16(answer ? 1 : 0);  // ancount
+    header_writer.WriteU16(0);  // nscount
+    header_writer.WriteU16(0);  // arcount
+
+    size_t response_size = query_size;
+    if (answer) {
+      base::BigEndianWriter writer(header + query_size,
+                                   write_buffer_->size() - query_size);
+      // Pointer to the question name.
+      writer.WriteU16(static_cast<uint16_t>(0xc000 | kHeaderSize));
+      writer.WriteU16(net::dns_protocol::kTypeA);
+      writer.WriteU16(net::dns_protocol::kClassIN);
+      writer.WriteU32(60);  // TTL
+      writer.WriteU16(4);   // RDLENGTH
+      writer.WriteBytes("\x7f\x00\x00\x01", 4);
+      response_size = writer.ptr() - header;
+    }
+
+    rv = socket_.SendTo(
+        write_buffer_.get(), response_size, client_address_,
+        base::Bind(&StubNameserver::OnWriteComplete, base::Unretained(this)));
+    return rv != net::ERR_IO_PENDING;
+  }
+
+  void OnWriteComplete(int rv) { DoRead(); }
+
+  net::UDPServerSocket socket_;
+  net::IPEndPoint address_;
+  net::IPEndPoint client_address_;
+  scoped_refptr<net::IOBufferWithSize> read_buffer_;
+  scoped_refptr<net::IOBufferWithSize> write_buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(StubNameserver);
+};
+
+// Resolves |num_queries| distinct names, keeping |concurrency| transactions
+// in flight.
+class QueryRunner {
+ public:
+  QueryRunner(net::DnsTransactionFactory* factory,
+              int num_queries,
+              int concurrency)
+      : factory_(factory),
+        num_queries_(num_queries),
+        concurrency_(concurrency),
+        started_(0),
+        completed_(0),
+        failed_(0) {}
+
+  // Runs all queries and returns the number that failed.
+  int Run() {
+    for (int i = 0; i < concurrency_ && started_ < num_queries_; ++i)
+      StartTransaction();
+    run_loop_.Run();
+    return failed_;
+  }
+
+ private:
+  void StartTransaction() {
+    std::string hostname =
+        base::StringPrintf("host%d.benchmark.example.", started_++);
+    std::unique_ptr<net::DnsTransaction> transaction =
+        factory_->CreateTransaction(
+            hostname, net::dns_protocol::kTypeA,
+            base::Bind(&QueryRunner::OnTransactionComplete,
+                       base::Unretained(this)),
+            net::BoundNetLog());
+    net::DnsTransaction* transaction_ptr = transaction.get();
+    transactions_[transaction_ptr] = std::move(transaction);
+    transaction_ptr->Start();
+  }
+
+  void OnTransactionComplete(net::DnsTransaction* transaction,
+                             int neterror,
+                             const net::DnsResponse* response) {
+    // Destroying the transaction also releases its socket.
+    transactions_.erase(transaction);
+    if (neterror != net::OK)
+      ++failed_;
+    if (++completed_ == num_queries_) {
+      run_loop_.Quit();
+      return;
+    }
+    if (started_ < num_queries_)
+      StartTransaction();
+  }
+
+  net::DnsTransactionFactory* factory_;
+  const int num_queries_;
+  const int concurrency_;
+  int started_;
+  int completed_;
+  int failed_;
+
+  // Transactions in flight.
+  std::map<net::DnsTransaction*, std::unique_ptr<net::DnsTransaction>>
+      transactions_;
+
+  base::RunLoop run_loop_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueryRunner);
+};
+
+// Resolves the queries with |client| and prints the throughput. Returns false
+// on error.
+bool RunBenchmark(const std::string& name,
+                  std::unique_ptr<net::DnsClient> client,
+                  const net::IPEndPoint& nameserver,
+                  int num_queries,
+                  int concurrency) {
+  net::DnsConfig config;
+  config.nameservers.push_back(nameserver);
+  config.attempts = 1;
+  config.timeout = base::TimeDelta::FromSeconds(1);
+  client->SetConfig(config);
+  if (!client->GetTransactionFactory()) {
+    std::cerr << "Couldn't configure the DNS client." << std::endl;
+    return false;
+  }
+
+  QueryRunner runner(client->GetTransactionFactory(), num_queries,
+                     concurrency);
+  base::TimeTicks start = base::TimeTicks::Now();
+  int failed = runner.Run();
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  std::cout << name << ": " << num_queries << " queries in "
+            << elapsed.InMilliseconds() << " ms, "
+            << static_cast<int>(num_queries / elapsed.InSecondsF())
+            << " queries/s, " << failed << " failed" << std::endl;
+  return true;
+}
+
+bool GetIntSwitch(const base::CommandLine& command_line,
+                  const char* name,
+                  int default_value,
+                  int* value) {
+  *value = default_value;
+  if (!command_line.HasSwitch(name))
+    return true;
+  return base::StringToInt(command_line.GetSwitchValueASCII(name), value) &&
+         *value > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+
+  int num_queries;
+  int concurrency;
+  if (!GetIntSwitch(command_line, kQueriesSwitch, kDefaultQueries,
+                    &num_queries) ||
+      !GetIntSwitch(command_line, kConcurrencySwitch, kDefaultConcurrency,
+                    &concurrency)) {
+    std::cerr << argv[0] << " [--" << kQueriesSwitch << "=N] [--"
+              << kConcurrencySwitch << "=N]" << std::endl;
+    return 1;
+  }
+
+  base::MessageLoopForIO message_loop;
+
+  StubNameserver nameserver;
+  int rv = nameserver.Start();
+  if (rv != net::OK) {
+    std::cerr << "Couldn't start the stub nameserver: "
+              << net::ErrorToString(rv) << std::endl;
+    return 1;
+  }
+
+  if (!RunBenchmark("new socket per query",
+                    net::DnsClient::CreateClient(nullptr), nameserver.address(),
+                    num_queries, concurrency) ||
+      !RunBenchmark("shared sockets",
+                    net::DnsClient::CreateClientWithSocketReuse(nullptr),
+                    nameserver.address(), num_queries, concurrency)) {
+    return 1;
+  }
+  return 0;
+}
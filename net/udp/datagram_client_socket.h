@@ -5,6 +5,10 @@
 #ifndef NET_UDP_DATAGRAM_CLIENT_SOCKET_H_
 #define NET_UDP_DATAGRAM_CLIENT_SOCKET_H_
 
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "net/base/io_buffer.h"
 #include "net/base/network_change_notifier.h"
 #include "net/socket/socket.h"
 #include "net/udp/datagram_socket.h"
@@ -40,6 +44,31 @@ class NET_EXPORT_PRIVATE DatagramClientSocket : public DatagramSocket,
   // ConnectUsingNetwork() or ConnectUsingDefaultNetwork().
   virtual NetworkChangeNotifier::NetworkHandle GetBoundNetwork() const = 0;
 
+  // Lets ReadMultiple() and WriteMultiple() move several datagrams per system
+  // call, if the platform supports it. Does nothing otherwise.
+  virtual void EnableBatchedIO() = 0;
+
+  // Returns true if ReadMultiple() and WriteMultiple() may be used, i.e. if
+  // the socket can move several datagrams per system call.
+  virtual bool SupportsBatchedIO() const = 0;
+
+  // Reads datagrams that are already queued on the socket into |buffers|,
+  // without waiting, and stores the size of each one read in |read_sizes|.
+  // Returns the number of datagrams read, ERR_IO_PENDING if none are queued,
+  // or another net error code. Never invokes a callback, so the caller must
+  // arrange to be notified of new data with Read(). Must not be called while
+  // a Read() is pending.
+  virtual int ReadMultiple(
+      const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+      std::vector<int>* read_sizes) = 0;
+
+  // Writes as many of |buffers|, in order, as the socket accepts without
+  // waiting. Returns the number of datagrams written, ERR_IO_PENDING if the
+  // first one could not be written without blocking, or another net error
+  // code. Never invokes a callback. Must not be called while a Write() is
+  // pending.
+  virtual int WriteMultiple(
+      const std::vector<scoped_refptr<StringIOBuffer>>& buffers) = 0;
 };
 
 }  // namespace net
@@ -64,6 +64,25 @@ FuzzedDatagramClientSocket::GetBoundNetwork() const {
   return NetworkChangeNotifier::kInvalidNetworkHandle;
 }
 
+void FuzzedDatagramClientSocket::EnableBatchedIO() {}
+
+bool FuzzedDatagramClientSocket::SupportsBatchedIO() const {
+  return false;
+}
+
+int FuzzedDatagramClientSocket::ReadMultiple(
+    const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+    std::vector<int>* read_sizes) {
+  NOTREACHED();
+  return ERR_NOT_IMPLEMENTED;
+}
+
+int FuzzedDatagramClientSocket::WriteMultiple(
+    const std::vector<scoped_refptr<StringIOBuffer>>& buffers) {
+  NOTREACHED();
+  return ERR_NOT_IMPLEMENTED;
+}
+
 void FuzzedDatagramClientSocket::Close() {
   connected_ = false;
   read_pending_ = false;
@@ -35,6 +35,12 @@ class FuzzedDatagramClientSocket : public DatagramClientSocket {
                           const IPEndPoint& address) override;
   int ConnectUsingDefaultNetwork(const IPEndPoint& address) override;
   NetworkChangeNotifier::NetworkHandle GetBoundNetwork() const override;
+  void EnableBatchedIO() override;
+  bool SupportsBatchedIO() const override;
+  int ReadMultiple(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                   std::vector<int>* read_sizes) override;
+  int WriteMultiple(
+      const std::vector<scoped_refptr<StringIOBuffer>>& buffers) override;
 
   // DatagramSocket implementation:
   void Close() override;
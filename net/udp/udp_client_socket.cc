@@ -4,6 +4,7 @@
 
 #include "net/udp/udp_client_socket.h"
 
+#include "base/logging.h"
 #include "net/base/net_errors.h"
 #include "net/log/net_log.h"
 
@@ -113,6 +114,42 @@ const BoundNetLog& UDPClientSocket::NetLog() const {
   return socket_.NetLog();
 }
 
+void UDPClientSocket::EnableBatchedIO() {
+#if defined(OS_LINUX)
+  // ReadMultiple() and WriteMultiple() use recvmmsg() and sendmmsg().
+  socket_.EnableBatchedIO();
+#endif
+}
+
+bool UDPClientSocket::SupportsBatchedIO() const {
+#if defined(OS_LINUX)
+  return socket_.batched_io_enabled();
+#else
+  return false;
+#endif
+}
+
+int UDPClientSocket::ReadMultiple(
+    const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+    std::vector<int>* read_sizes) {
+#if defined(OS_LINUX)
+  return socket_.ReadMultiple(buffers, read_sizes);
+#else
+  NOTREACHED();
+  return ERR_NOT_IMPLEMENTED;
+#endif
+}
+
+int UDPClientSocket::WriteMultiple(
+    const std::vector<scoped_refptr<StringIOBuffer>>& buffers) {
+#if defined(OS_LINUX)
+  return socket_.WriteMultiple(buffers);
+#else
+  NOTREACHED();
+  return ERR_NOT_IMPLEMENTED;
+#endif
+}
+
 #if defined(OS_WIN)
 void UDPClientSocket::UseNonBlockingIO() {
   socket_.UseNonBlockingIO();
@@ -44,6 +44,12 @@ class NET_EXPORT_PRIVATE UDPClientSocket : public DatagramClientSocket {
   int SetReceiveBufferSize(int32_t size) override;
   int SetSendBufferSize(int32_t size) override;
   const BoundNetLog& NetLog() const override;
+  void EnableBatchedIO() override;
+  bool SupportsBatchedIO() const override;
+  int ReadMultiple(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                   std::vector<int>* read_sizes) override;
+  int WriteMultiple(
+      const std::vector<scoped_refptr<StringIOBuffer>>& buffers) override;
 
 #if defined(OS_WIN)
   // Switch to use non-blocking IO. Must be called right after construction and
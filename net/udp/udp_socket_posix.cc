@@ -9,9 +9,12 @@
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+
 #include "base/callback.h"
 #include "base/debug/alias.h"
 #include "base/files/file_util.h"
@@ -48,6 +51,11 @@ const int kBindRetries = 10;
 const int kPortStart = 1024;
 const int kPortEnd = 65535;
 
+#if defined(OS_LINUX)
+// Most datagrams moved by one recvmmsg() or sendmmsg() call.
+const size_t kMaxDatagramsPerBatch = 64;
+#endif
+
 #if defined(OS_MACOSX)
 
 // Returns IPv4 address in network order.
@@ -89,7 +97,8 @@ UDPSocketPosix::UDPSocketPosix(DatagramSocket::BindType bind_type,
       recv_from_address_(NULL),
       write_buf_len_(0),
       net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_UDP_SOCKET)),
-      bound_network_(NetworkChangeNotifier::kInvalidNetworkHandle) {
+      bound_network_(NetworkChangeNotifier::kInvalidNetworkHandle),
+      batched_io_enabled_(false) {
   net_log_.BeginEvent(NetLog::TYPE_SOCKET_ALIVE,
                       source.ToEventParametersCallback());
   if (bind_type == DatagramSocket::RANDOM_BIND)
@@ -271,6 +280,83 @@ int UDPSocketPosix::SendToOrWrite(IOBuffer* buf,
   return ERR_IO_PENDING;
 }
 
+#if defined(OS_LINUX)
+int UDPSocketPosix::ReadMultiple(
+    const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+    std::vector<int>* read_sizes) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(batched_io_enabled_);
+  CHECK(read_callback_.is_null());
+  DCHECK(!buffers.empty());
+
+  size_t count = std::min(buffers.size(), kMaxDatagramsPerBatch);
+  struct iovec iovecs[kMaxDatagramsPerBatch];
+  struct mmsghdr messages[kMaxDatagramsPerBatch];
+  SockaddrStorage storage[kMaxDatagramsPerBatch];
+  memset(messages, 0, sizeof(messages[0]) * count);
+  for (size_t i = 0; i < count; ++i) {
+    iovecs[i].iov_base = buffers[i]->data();
+    iovecs[i].iov_len = buffers[i]->size();
+    messages[i].msg_hdr.msg_name = storage[i].addr;
+    messages[i].msg_hdr.msg_namelen = storage[i].addr_len;
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int result =
+      HANDLE_EINTR(recvmmsg(socket_, messages, count, MSG_DONTWAIT, nullptr));
+  if (result < 0) {
+    result = MapSystemError(errno);
+    if (result != ERR_IO_PENDING)
+      LogRead(result, NULL, 0, NULL);
+    return result;
+  }
+
+  read_sizes->clear();
+  for (int i = 0; i < result; ++i) {
+    int size = static_cast<int>(messages[i].msg_len);
+    read_sizes->push_back(size);
+    LogRead(size, buffers[i]->data(), messages[i].msg_hdr.msg_namelen,
+            storage[i].addr);
+  }
+  return result;
+}
+
+int UDPSocketPosix::WriteMultiple(
+    const std::vector<scoped_refptr<StringIOBuffer>>& buffers) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(batched_io_enabled_);
+  DCHECK(is_connected_);
+  CHECK(write_callback_.is_null());
+  DCHECK(!buffers.empty());
+
+  size_t count = std::min(buffers.size(), kMaxDatagramsPerBatch);
+  struct iovec iovecs[kMaxDatagramsPerBatch];
+  struct mmsghdr messages[kMaxDatagramsPerBatch];
+  memset(messages, 0, sizeof(messages[0]) * count);
+  for (size_t i = 0; i < count; ++i) {
+    iovecs[i].iov_base = buffers[i]->data();
+    iovecs[i].iov_len = buffers[i]->size();
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int result = HANDLE_EINTR(sendmmsg(socket_, messages, count, MSG_DONTWAIT));
+  if (result < 0) {
+    result = MapSystemError(errno);
+    if (result != ERR_IO_PENDING)
+      LogWrite(result, NULL, NULL);
+    return result;
+  }
+
+  for (int i = 0; i < result; ++i)
+    LogWrite(messages[i].msg_len, buffers[i]->data(), NULL);
+  return result;
+}
+#endif  // defined(OS_LINUX)
+
 int UDPSocketPosix::Connect(const IPEndPoint& address) {
   DCHECK_NE(socket_, kInvalidSocket);
   net_log_.BeginEvent(NetLog::TYPE_UDP_CONNECT,
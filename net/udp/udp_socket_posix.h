@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -187,6 +188,21 @@ class NET_EXPORT UDPSocketPosix : public base::NonThreadSafe {
   // Resets the thread to be used for thread-safety checks.
   void DetachFromThread();
 
+#if defined(OS_LINUX)
+  // Allows ReadMultiple() and WriteMultiple() to be used.
+  void EnableBatchedIO() { batched_io_enabled_ = true; }
+  bool batched_io_enabled() const { return batched_io_enabled_; }
+
+  // Reads datagrams already queued on a connected socket with a single
+  // recvmmsg() call. See DatagramClientSocket::ReadMultiple().
+  int ReadMultiple(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                   std::vector<int>* read_sizes);
+
+  // Writes datagrams to a connected socket with a single sendmmsg() call. See
+  // DatagramClientSocket::WriteMultiple().
+  int WriteMultiple(const std::vector<scoped_refptr<StringIOBuffer>>& buffers);
+#endif
+
  private:
   enum SocketOptions {
     SOCKET_OPTION_MULTICAST_LOOP = 1 << 0
@@ -313,6 +329,9 @@ class NET_EXPORT UDPSocketPosix : public base::NonThreadSafe {
   // Network that this socket is bound to via BindToNetwork().
   NetworkChangeNotifier::NetworkHandle bound_network_;
 
+  // Whether ReadMultiple() and WriteMultiple() may be used.
+  bool batched_io_enabled_;
+
   DISALLOW_COPY_AND_ASSIGN(UDPSocketPosix);
 };
 
@@ -275,6 +275,51 @@ TEST_F(UDPSocketTest, ConnectNonBlocking) {
 }
 #endif
 
+#if defined(OS_LINUX)
+TEST_F(UDPSocketTest, ReadWriteMultiple) {
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPServerSocket server(nullptr, NetLog::Source());
+  ASSERT_THAT(server.Listen(bind_address), IsOk());
+  IPEndPoint server_address;
+  ASSERT_THAT(server.GetLocalAddress(&server_address), IsOk());
+
+  UDPClientSocket client(DatagramSocket::DEFAULT_BIND, RandIntCallback(),
+                         nullptr, NetLog::Source());
+  EXPECT_FALSE(client.SupportsBatchedIO());
+  client.EnableBatchedIO();
+  EXPECT_TRUE(client.SupportsBatchedIO());
+  ASSERT_THAT(client.Connect(server_address), IsOk());
+
+  std::vector<std::string> messages = {"first", "second", "third"};
+  std::vector<scoped_refptr<StringIOBuffer>> write_buffers;
+  for (const std::string& message : messages)
+    write_buffers.push_back(new StringIOBuffer(message));
+  EXPECT_EQ(3, client.WriteMultiple(write_buffers));
+
+  for (const std::string& message : messages) {
+    EXPECT_EQ(message, RecvFromSocket(&server));
+    EXPECT_EQ(message.length(),
+              static_cast<size_t>(SendToSocket(&server, message)));
+  }
+
+  std::vector<scoped_refptr<IOBufferWithSize>> read_buffers;
+  for (int i = 0; i < 4; ++i)
+    read_buffers.push_back(new IOBufferWithSize(kMaxRead));
+  std::vector<int> read_sizes;
+  // Loopback delivery is synchronous, so all three replies are queued.
+  ASSERT_EQ(3, client.ReadMultiple(read_buffers, &read_sizes));
+  ASSERT_EQ(3u, read_sizes.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(messages[i],
+              std::string(read_buffers[i]->data(), read_sizes[i]));
+  }
+
+  EXPECT_THAT(client.ReadMultiple(read_buffers, &read_sizes),
+              IsError(ERR_IO_PENDING));
+}
+#endif  // defined(OS_LINUX)
+
 #if defined(OS_MACOSX)
 // UDPSocketPrivate_Broadcast is disabled for OSX because it requires
 // root permissions on OSX 10.7+.
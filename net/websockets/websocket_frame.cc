@@ -8,8 +8,12 @@
 #include <algorithm>
 
 #include "base/big_endian.h"
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/rand_util.h"
+#include "build/build_config.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 
@@ -23,8 +27,13 @@ namespace {
 // TODO(ricea): Add ARCH_CPU_ARM_FAMILY when arm_neon=1 becomes the default.
 #if defined(COMPILER_GCC) && defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
 
+#define WEBSOCKET_MASKING_USE_AVX2 1
+
 using PackedMaskType = uint32_t __attribute__((vector_size(16)));
 
+// Only used by code compiled for AVX2, when the CPU supports it.
+using WidePackedMaskType = uint32_t __attribute__((vector_size(32)));
+
 #else
 
 using PackedMaskType = size_t;
@@ -54,6 +63,106 @@ inline void MaskWebSocketFramePayloadByBytes(
   }
 }
 
+// Masks |data| in chunks of sizeof(PackedType), except for the beginning and
+// the end of the buffer which may be unaligned. This is always inlined so that
+// it is compiled for the instruction set of its caller.
+template <typename PackedType>
+ALWAYS_INLINE void MaskWebSocketFramePayloadPacked(
+    const WebSocketMaskingKey& masking_key,
+    uint64_t frame_offset,
+    char* const data,
+    int data_size) {
+  static const size_t kMaskingKeyLength =
+      WebSocketFrameHeader::kMaskingKeyLength;
+
+  // PackedType must be a multiple of kMaskingKeyLength in size.
+  PackedType packed_mask_key;
+  static const size_t kPackedMaskKeySize = sizeof(packed_mask_key);
+  static_assert((kPackedMaskKeySize >= kMaskingKeyLength &&
+                 kPackedMaskKeySize % kMaskingKeyLength == 0),
+                "PackedType size is not a multiple of mask length");
+  char* const end = data + data_size;
+  // If the buffer is too small for the vectorised version to be useful, revert
+  // to the byte-at-a-time implementation early.
+  if (data_size <= static_cast<int>(kPackedMaskKeySize * 2)) {
+    MaskWebSocketFramePayloadByBytes(
+        masking_key, frame_offset % kMaskingKeyLength, data, end);
+    return;
+  }
+  const size_t data_modulus =
+      reinterpret_cast<size_t>(data) % kPackedMaskKeySize;
+  char* const aligned_begin =
+      data_modulus == 0 ? data : (data + kPackedMaskKeySize - data_modulus);
+  // Guaranteed by the above check for small data_size.
+  DCHECK(aligned_begin < end);
+  MaskWebSocketFramePayloadByBytes(
+      masking_key, frame_offset % kMaskingKeyLength, data, aligned_begin);
+  const size_t end_modulus = reinterpret_cast<size_t>(end) % kPackedMaskKeySize;
+  char* const aligned_end = end - end_modulus;
+  // Guaranteed by the above check for small data_size.
+  DCHECK(aligned_end > aligned_begin);
+  // Create a version of the mask which is rotated by the appropriate offset
+  // for our alignment. The "trick" here is that 0 XORed with the mask will
+  // give the value of the mask for the appropriate byte.
+  char realigned_mask[kMaskingKeyLength] = {};
+  MaskWebSocketFramePayloadByBytes(
+      masking_key,
+      (frame_offset + aligned_begin - data) % kMaskingKeyLength,
+      realigned_mask,
+      realigned_mask + kMaskingKeyLength);
+
+  for (size_t i = 0; i < kPackedMaskKeySize; i += kMaskingKeyLength) {
+    // memcpy() is allegedly blessed by the C++ standard for type-punning.
+    memcpy(reinterpret_cast<char*>(&packed_mask_key) + i,
+           realigned_mask,
+           kMaskingKeyLength);
+  }
+
+  // The main loop.
+  for (char* merged = aligned_begin; merged != aligned_end;
+       merged += kPackedMaskKeySize) {
+    // This is not quite standard-compliant C++. However, the standard-compliant
+    // equivalent (using memcpy()) compiles to slower code using g++. In
+    // practice, this will work for the compilers and architectures currently
+    // supported by Chromium, and the tests are extremely unlikely to pass if a
+    // future compiler/architecture breaks it.
+    *reinterpret_cast<PackedType*>(merged) ^= packed_mask_key;
+  }
+
+  MaskWebSocketFramePayloadByBytes(
+      masking_key,
+      (frame_offset + (aligned_end - data)) % kMaskingKeyLength,
+      aligned_end,
+      end);
+}
+
+#if defined(WEBSOCKET_MASKING_USE_AVX2)
+
+// Masks 32 bytes at a time. Must only be called if the CPU supports AVX2.
+__attribute__((target("avx2"))) void MaskWebSocketFramePayloadAVX2(
+    const WebSocketMaskingKey& masking_key,
+    uint64_t frame_offset,
+    char* const data,
+    int data_size) {
+  MaskWebSocketFramePayloadPacked<WidePackedMaskType>(masking_key,
+                                                      frame_offset, data,
+                                                      data_size);
+}
+
+// Which masking implementation to use, decided once per process.
+struct MaskingImplementation {
+  MaskingImplementation()
+      : has_avx2(base::CPU().has_avx2()), use_avx2(has_avx2) {}
+
+  const bool has_avx2;
+  bool use_avx2;
+};
+
+base::LazyInstance<MaskingImplementation>::Leaky g_masking_implementation =
+    LAZY_INSTANCE_INITIALIZER;
+
+#endif  // defined(WEBSOCKET_MASKING_USE_AVX2)
+
 }  // namespace
 
 std::unique_ptr<WebSocketFrameHeader> WebSocketFrameHeader::Clone() const {
@@ -181,72 +290,30 @@ void MaskWebSocketFramePayload(const WebSocketMaskingKey& masking_key,
                                uint64_t frame_offset,
                                char* const data,
                                int data_size) {
-  static const size_t kMaskingKeyLength =
-      WebSocketFrameHeader::kMaskingKeyLength;
-
   DCHECK_GE(data_size, 0);
 
-  // Most of the masking is done in chunks of sizeof(PackedMaskType), except for
-  // the beginning and the end of the buffer which may be unaligned.
-  // PackedMaskType must be a multiple of kMaskingKeyLength in size.
-  PackedMaskType packed_mask_key;
-  static const size_t kPackedMaskKeySize = sizeof(packed_mask_key);
-  static_assert((kPackedMaskKeySize >= kMaskingKeyLength &&
-                 kPackedMaskKeySize % kMaskingKeyLength == 0),
-                "PackedMaskType size is not a multiple of mask length");
-  char* const end = data + data_size;
-  // If the buffer is too small for the vectorised version to be useful, revert
-  // to the byte-at-a-time implementation early.
-  if (data_size <= static_cast<int>(kPackedMaskKeySize * 2)) {
-    MaskWebSocketFramePayloadByBytes(
-        masking_key, frame_offset % kMaskingKeyLength, data, end);
+#if defined(WEBSOCKET_MASKING_USE_AVX2)
+  // The wider vectors only pay off once the payload covers a few of them.
+  if (data_size > static_cast<int>(sizeof(WidePackedMaskType) * 2) &&
+      g_masking_implementation.Get().use_avx2) {
+    MaskWebSocketFramePayloadAVX2(masking_key, frame_offset, data, data_size);
     return;
   }
-  const size_t data_modulus =
-      reinterpret_cast<size_t>(data) % kPackedMaskKeySize;
-  char* const aligned_begin =
-      data_modulus == 0 ? data : (data + kPackedMaskKeySize - data_modulus);
-  // Guaranteed by the above check for small data_size.
-  DCHECK(aligned_begin < end);
-  MaskWebSocketFramePayloadByBytes(
-      masking_key, frame_offset % kMaskingKeyLength, data, aligned_begin);
-  const size_t end_modulus = reinterpret_cast<size_t>(end) % kPackedMaskKeySize;
-  char* const aligned_end = end - end_modulus;
-  // Guaranteed by the above check for small data_size.
-  DCHECK(aligned_end > aligned_begin);
-  // Create a version of the mask which is rotated by the appropriate offset
-  // for our alignment. The "trick" here is that 0 XORed with the mask will
-  // give the value of the mask for the appropriate byte.
-  char realigned_mask[kMaskingKeyLength] = {};
-  MaskWebSocketFramePayloadByBytes(
-      masking_key,
-      (frame_offset + aligned_begin - data) % kMaskingKeyLength,
-      realigned_mask,
-      realigned_mask + kMaskingKeyLength);
+#endif  // defined(WEBSOCKET_MASKING_USE_AVX2)
 
-  for (size_t i = 0; i < kPackedMaskKeySize; i += kMaskingKeyLength) {
-    // memcpy() is allegedly blessed by the C++ standard for type-punning.
-    memcpy(reinterpret_cast<char*>(&packed_mask_key) + i,
-           realigned_mask,
-           kMaskingKeyLength);
-  }
-
-  // The main loop.
-  for (char* merged = aligned_begin; merged != aligned_end;
-       merged += kPackedMaskKeySize) {
-    // This is not quite standard-compliant C++. However, the standard-compliant
-    // equivalent (using memcpy()) compiles to slower code using g++. In
-    // practice, this will work for the compilers and architectures currently
-    // supported by Chromium, and the tests are extremely unlikely to pass if a
-    // future compiler/architecture breaks it.
-    *reinterpret_cast<PackedMaskType*>(merged) ^= packed_mask_key;
-  }
+  MaskWebSocketFramePayloadPacked<PackedMaskType>(masking_key, frame_offset,
+                                                  data, data_size);
+}
 
-  MaskWebSocketFramePayloadByBytes(
-      masking_key,
-      (frame_offset + (aligned_end - data)) % kMaskingKeyLength,
-      aligned_end,
-      end);
+bool SetWebSocketMaskingAVX2EnabledForTesting(bool enabled) {
+#if defined(WEBSOCKET_MASKING_USE_AVX2)
+  MaskingImplementation* implementation = g_masking_implementation.Pointer();
+  bool old_enabled = implementation->use_avx2;
+  implementation->use_avx2 = enabled && implementation->has_avx2;
+  return old_enabled;
+#else
+  return false;
+#endif  // defined(WEBSOCKET_MASKING_USE_AVX2)
 }
 
 }  // namespace net
@@ -192,6 +192,12 @@ NET_EXPORT void MaskWebSocketFramePayload(
     char* data,
     int data_size);
 
+// MaskWebSocketFramePayload() uses AVX2 for large payloads when the CPU
+// supports it. This turns that off or back on, so that tests and benchmarks
+// can cover both implementations, and returns the previous setting. It has no
+// effect on CPUs without AVX2, which always use the baseline implementation.
+NET_EXPORT_PRIVATE bool SetWebSocketMaskingAVX2EnabledForTesting(bool enabled);
+
 }  // namespace net
 
 #endif  // NET_WEBSOCKETS_WEBSOCKET_FRAME_H_
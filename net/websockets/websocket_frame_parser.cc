@@ -33,10 +33,28 @@ const uint64_t kPayloadLengthWithEightByteExtendedLengthField = 127;
 
 namespace net {
 
+namespace {
+
+// Payload data of a frame that stays in the buffer it was read into, and
+// keeps that buffer alive.
+class PayloadIOBuffer : public IOBufferWithSize {
+ public:
+  PayloadIOBuffer(IOBuffer* buffer, char* data, int size)
+      : IOBufferWithSize(data, size), buffer_(buffer) {}
+
+ private:
+  ~PayloadIOBuffer() override {
+    // |data_| is owned by |buffer_|.
+    data_ = nullptr;
+  }
+
+  const scoped_refptr<IOBuffer> buffer_;
+};
+
+}  // namespace
+
 WebSocketFrameParser::WebSocketFrameParser()
-    : current_read_pos_(0),
-      frame_offset_(0),
-      websocket_error_(kWebSocketNormalClosure) {
+    : frame_offset_(0), websocket_error_(kWebSocketNormalClosure) {
   std::fill(masking_key_.key,
             masking_key_.key + WebSocketFrameHeader::kMaskingKeyLength,
             '\0');
@@ -48,66 +66,116 @@ bool WebSocketFrameParser::Decode(
     const char* data,
     size_t length,
     std::vector<std::unique_ptr<WebSocketFrameChunk>>* frame_chunks) {
+  return DecodeInternal(nullptr, data, length, frame_chunks);
+}
+
+bool WebSocketFrameParser::DecodeInPlace(
+    IOBuffer* buffer,
+    size_t length,
+    std::vector<std::unique_ptr<WebSocketFrameChunk>>* frame_chunks) {
+  DCHECK(buffer);
+  return DecodeInternal(buffer, buffer->data(), length, frame_chunks);
+}
+
+bool WebSocketFrameParser::DecodeInternal(
+    IOBuffer* buffer,
+    const char* data,
+    size_t length,
+    std::vector<std::unique_ptr<WebSocketFrameChunk>>* frame_chunks) {
   if (websocket_error_ != kWebSocketNormalClosure)
     return false;
   if (!length)
     return true;
 
-  // TODO(yutak): Remove copy.
-  buffer_.insert(buffer_.end(), data, data + length);
-
-  while (current_read_pos_ < buffer_.size()) {
+  const char* current = data;
+  const char* const end = data + length;
+  while (current < end) {
     bool first_chunk = false;
     if (!current_frame_header_.get()) {
-      DecodeFrameHeader();
+      current += DecodeFrameHeader(current, end);
       if (websocket_error_ != kWebSocketNormalClosure)
         return false;
-      // If frame header is incomplete, then carry over the remaining
-      // data to the next round of Decode().
-      if (!current_frame_header_.get())
+      // If frame header is incomplete, then it was carried over to the next
+      // round of Decode().
+      if (!current_frame_header_.get()) {
+        DCHECK(current == end);
         break;
+      }
       first_chunk = true;
     }
 
     std::unique_ptr<WebSocketFrameChunk> frame_chunk =
-        DecodeFramePayload(first_chunk);
+        DecodeFramePayload(first_chunk, buffer, &current, end);
     DCHECK(frame_chunk.get());
     frame_chunks->push_back(std::move(frame_chunk));
 
     if (current_frame_header_.get()) {
-      DCHECK(current_read_pos_ == buffer_.size());
+      DCHECK(current == end);
       break;
     }
   }
 
-  // Drain unnecessary data. TODO(yutak): Remove copy. (but how?)
-  buffer_.erase(buffer_.begin(), buffer_.begin() + current_read_pos_);
-  current_read_pos_ = 0;
+  return true;
+}
 
-  // Sanity check: the size of carried-over data should not exceed
-  // the maximum possible length of a frame header.
+size_t WebSocketFrameParser::DecodeFrameHeader(const char* data,
+                                               const char* end) {
+  // The maximum possible length of a frame header.
   static const size_t kMaximumFrameHeaderSize =
       WebSocketFrameHeader::kBaseHeaderSize +
       WebSocketFrameHeader::kMaximumExtendedLengthSize +
       WebSocketFrameHeader::kMaskingKeyLength;
-  DCHECK_LT(buffer_.size(), kMaximumFrameHeaderSize);
 
-  return true;
+  DCHECK(!current_frame_header_.get());
+
+  size_t available = end - data;
+  size_t carried_over = header_buffer_.size();
+  size_t header_size;
+  if (carried_over) {
+    // Complete the carried over header with as much as any header could need.
+    DCHECK_LT(carried_over, kMaximumFrameHeaderSize);
+    size_t appended =
+        std::min(available, kMaximumFrameHeaderSize - carried_over);
+    header_buffer_.insert(header_buffer_.end(), data, data + appended);
+    header_size = ParseFrameHeader(&header_buffer_.front(),
+                                   &header_buffer_.front() +
+                                       header_buffer_.size());
+  } else {
+    header_size = ParseFrameHeader(data, end);
+  }
+
+  if (websocket_error_ != kWebSocketNormalClosure) {
+    header_buffer_.clear();
+    current_frame_header_.reset();
+    frame_offset_ = 0;
+    return available;
+  }
+
+  if (!current_frame_header_.get()) {
+    // Carry over the remaining data to the next round of Decode(). If
+    // |header_buffer_| was not empty, all of |data| has been appended to it
+    // already, since a full header would have fit.
+    if (!carried_over)
+      header_buffer_.assign(data, end);
+    DCHECK_LT(header_buffer_.size(), kMaximumFrameHeaderSize);
+    return available;
+  }
+
+  header_buffer_.clear();
+  DCHECK_GT(header_size, carried_over);
+  return header_size - carried_over;
 }
 
-void WebSocketFrameParser::DecodeFrameHeader() {
+size_t WebSocketFrameParser::ParseFrameHeader(const char* start,
+                                              const char* end) {
   typedef WebSocketFrameHeader::OpCode OpCode;
   static const int kMaskingKeyLength = WebSocketFrameHeader::kMaskingKeyLength;
 
-  DCHECK(!current_frame_header_.get());
-
-  const char* start = &buffer_.front() + current_read_pos_;
   const char* current = start;
-  const char* end = &buffer_.front() + buffer_.size();
 
   // Header needs 2 bytes at minimum.
   if (end - current < 2)
-    return;
+    return 0;
 
   uint8_t first_byte = *current++;
   uint8_t second_byte = *current++;
@@ -122,7 +190,7 @@ void WebSocketFrameParser::DecodeFrameHeader() {
   uint64_t payload_length = second_byte & kPayloadLengthMask;
   if (payload_length == kPayloadLengthWithTwoByteExtendedLengthField) {
     if (end - current < 2)
-      return;
+      return 0;
     uint16_t payload_length_16;
     base::ReadBigEndian(current, &payload_length_16);
     current += 2;
@@ -131,7 +199,7 @@ void WebSocketFrameParser::DecodeFrameHeader() {
       websocket_error_ = kWebSocketErrorProtocolError;
   } else if (payload_length == kPayloadLengthWithEightByteExtendedLengthField) {
     if (end - current < 8)
-      return;
+      return 0;
     base::ReadBigEndian(current, &payload_length);
     current += 8;
     if (payload_length <= UINT16_MAX ||
@@ -141,17 +209,12 @@ void WebSocketFrameParser::DecodeFrameHeader() {
       websocket_error_ = kWebSocketErrorMessageTooBig;
     }
   }
-  if (websocket_error_ != kWebSocketNormalClosure) {
-    buffer_.clear();
-    current_read_pos_ = 0;
-    current_frame_header_.reset();
-    frame_offset_ = 0;
-    return;
-  }
+  if (websocket_error_ != kWebSocketNormalClosure)
+    return 0;
 
   if (masked) {
     if (end - current < kMaskingKeyLength)
-      return;
+      return 0;
     std::copy(current, current + kMaskingKeyLength, masking_key_.key);
     current += kMaskingKeyLength;
   } else {
@@ -165,16 +228,19 @@ void WebSocketFrameParser::DecodeFrameHeader() {
   current_frame_header_->reserved3 = reserved3;
   current_frame_header_->masked = masked;
   current_frame_header_->payload_length = payload_length;
-  current_read_pos_ += current - start;
   DCHECK_EQ(0u, frame_offset_);
+  return current - start;
 }
 
 std::unique_ptr<WebSocketFrameChunk> WebSocketFrameParser::DecodeFramePayload(
-    bool first_chunk) {
+    bool first_chunk,
+    IOBuffer* buffer,
+    const char** data,
+    const char* end) {
   // The cast here is safe because |payload_length| is already checked to be
   // less than std::numeric_limits<int>::max() when the header is parsed.
   int next_size = static_cast<int>(
-      std::min(static_cast<uint64_t>(buffer_.size() - current_read_pos_),
+      std::min(static_cast<uint64_t>(end - *data),
                current_frame_header_->payload_length - frame_offset_));
 
   std::unique_ptr<WebSocketFrameChunk> frame_chunk(new WebSocketFrameChunk);
@@ -183,17 +249,21 @@ std::unique_ptr<WebSocketFrameChunk> WebSocketFrameParser::DecodeFramePayload(
   }
   frame_chunk->final_chunk = false;
   if (next_size) {
-    frame_chunk->data = new IOBufferWithSize(static_cast<int>(next_size));
-    char* io_data = frame_chunk->data->data();
-    memcpy(io_data, &buffer_.front() + current_read_pos_, next_size);
+    if (buffer) {
+      frame_chunk->data = new PayloadIOBuffer(
+          buffer, buffer->data() + (*data - buffer->data()), next_size);
+    } else {
+      frame_chunk->data = new IOBufferWithSize(static_cast<int>(next_size));
+      memcpy(frame_chunk->data->data(), *data, next_size);
+    }
     if (current_frame_header_->masked) {
       // The masking function is its own inverse, so we use the same function to
       // unmask as to mask.
       MaskWebSocketFramePayload(
-          masking_key_, frame_offset_, io_data, next_size);
+          masking_key_, frame_offset_, frame_chunk->data->data(), next_size);
     }
 
-    current_read_pos_ += next_size;
+    *data += next_size;
     frame_offset_ += next_size;
   }
 
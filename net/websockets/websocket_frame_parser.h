@@ -19,6 +19,8 @@
 
 namespace net {
 
+class IOBuffer;
+
 // Parses WebSocket frames from byte stream.
 //
 // Specification of WebSocket frame format is available at
@@ -42,6 +44,16 @@ class NET_EXPORT WebSocketFrameParser {
               size_t length,
               std::vector<std::unique_ptr<WebSocketFrameChunk>>* frame_chunks);
 
+  // Like Decode(), but decodes the first |length| bytes of |buffer|, and the
+  // payload data of the parsed frames refers to |buffer| rather than being
+  // copied. Masked payloads are unmasked in place. The chunks keep |buffer|
+  // alive; the caller must not write to it again until they are gone, which
+  // it can check with HasOneRef().
+  bool DecodeInPlace(
+      IOBuffer* buffer,
+      size_t length,
+      std::vector<std::unique_ptr<WebSocketFrameChunk>>* frame_chunks);
+
   // Returns kWebSocketNormalClosure if the parser has not failed to decode
   // WebSocket frames. Otherwise returns WebSocketError which is defined in
   // websocket_errors.h. We can convert net::WebSocketError to net::Error by
@@ -49,27 +61,43 @@ class NET_EXPORT WebSocketFrameParser {
   WebSocketError websocket_error() const { return websocket_error_; }
 
  private:
-  // Tries to decode a frame header from |current_read_pos_|.
-  // If successful, this function updates |current_read_pos_|,
-  // |current_frame_header_|, and |masking_key_| (if available).
-  // This function may set |failed_| to true if it observes a corrupt frame.
-  // If there is not enough data in the remaining buffer to parse a frame
-  // header, this function returns without doing anything.
-  void DecodeFrameHeader();
-
-  // Decodes frame payload and creates a WebSocketFrameChunk object.
-  // This function updates |current_read_pos_| and |frame_offset_| after
-  // parsing. This function returns a frame object even if no payload data is
+  // Implements Decode() and DecodeInPlace(). |data| must point into |buffer|
+  // if |buffer| is not null.
+  bool DecodeInternal(
+      IOBuffer* buffer,
+      const char* data,
+      size_t length,
+      std::vector<std::unique_ptr<WebSocketFrameChunk>>* frame_chunks);
+
+  // Tries to decode a frame header from the bytes carried over in
+  // |header_buffer_| followed by [|data|, |end|), and returns the number of
+  // bytes of |data| it used.
+  // If successful, this function sets |current_frame_header_| and
+  // |masking_key_| (if available).
+  // This function may set |websocket_error_| if it observes a corrupt frame.
+  // If there is not enough data to parse a frame header, this function
+  // carries over all of |data| to the next round of Decode().
+  size_t DecodeFrameHeader(const char* data, const char* end);
+
+  // Parses a complete frame header from [|start|, |end|), and returns its
+  // size. Returns 0 if the header is incomplete or corrupt.
+  size_t ParseFrameHeader(const char* start, const char* end);
+
+  // Decodes frame payload from [|*data|, |end|) and creates a
+  // WebSocketFrameChunk object, copying the payload unless |buffer| is not
+  // null. This function updates |*data| and |frame_offset_| after parsing.
+  // This function returns a frame object even if no payload data is
   // available at this moment, so the receiver could make use of frame header
   // information. If the end of frame is reached, this function clears
-  // |current_frame_header_|, |frame_offset_| and |masking_key_|.
-  std::unique_ptr<WebSocketFrameChunk> DecodeFramePayload(bool first_chunk);
-
-  // Internal buffer to store the data to parse.
-  std::vector<char> buffer_;
-
-  // Position in |buffer_| where the next round of parsing starts.
-  size_t current_read_pos_;
+  // |current_frame_header_| and |frame_offset_|.
+  std::unique_ptr<WebSocketFrameChunk> DecodeFramePayload(bool first_chunk,
+                                                          IOBuffer* buffer,
+                                                          const char** data,
+                                                          const char* end);
+
+  // The beginning of a frame header that was split between two rounds of
+  // Decode(). Payload data is never stored here.
+  std::vector<char> header_buffer_;
 
   // Frame header and masking key of the current frame.
   // |masking_key_| is filled with zeros if the current frame is not masked.
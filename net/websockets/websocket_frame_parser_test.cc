@@ -100,6 +100,63 @@ TEST(WebSocketFrameParserTest, DecodeMaskedFrame) {
   EXPECT_TRUE(std::equal(kHello, kHello + kHelloLength, frame->data->data()));
 }
 
+TEST(WebSocketFrameParserTest, DecodeInPlace) {
+  scoped_refptr<IOBufferWithSize> buffer =
+      new IOBufferWithSize(kHelloFrameLength + kMaskedHelloFrameLength);
+  memcpy(buffer->data(), kHelloFrame, kHelloFrameLength);
+  memcpy(buffer->data() + kHelloFrameLength, kMaskedHelloFrame,
+         kMaskedHelloFrameLength);
+
+  WebSocketFrameParser parser;
+
+  std::vector<std::unique_ptr<WebSocketFrameChunk>> frames;
+  EXPECT_TRUE(parser.DecodeInPlace(buffer.get(), buffer->size(), &frames));
+  EXPECT_EQ(kWebSocketNormalClosure, parser.websocket_error());
+  ASSERT_EQ(2u, frames.size());
+  EXPECT_FALSE(buffer->HasOneRef());
+
+  // The payloads are not copied, and the masked one is unmasked in place.
+  for (const auto& frame : frames) {
+    EXPECT_TRUE(frame->final_chunk);
+    ASSERT_EQ(static_cast<int>(kHelloLength), frame->data->size());
+    EXPECT_TRUE(
+        std::equal(kHello, kHello + kHelloLength, frame->data->data()));
+  }
+  EXPECT_EQ(buffer->data() + 2, frames[0]->data->data());
+  EXPECT_EQ(buffer->data() + kHelloFrameLength + 6, frames[1]->data->data());
+
+  frames.clear();
+  EXPECT_TRUE(buffer->HasOneRef());
+}
+
+// A header split between two buffers is carried over, but payload data still
+// refers to the buffers.
+TEST(WebSocketFrameParserTest, DecodeInPlaceSplitHeader) {
+  static const size_t kSplit = 3;
+  scoped_refptr<IOBufferWithSize> buffer1 = new IOBufferWithSize(kSplit);
+  memcpy(buffer1->data(), kMaskedHelloFrame, kSplit);
+  scoped_refptr<IOBufferWithSize> buffer2 =
+      new IOBufferWithSize(kMaskedHelloFrameLength - kSplit);
+  memcpy(buffer2->data(), kMaskedHelloFrame + kSplit, buffer2->size());
+
+  WebSocketFrameParser parser;
+
+  std::vector<std::unique_ptr<WebSocketFrameChunk>> frames;
+  EXPECT_TRUE(parser.DecodeInPlace(buffer1.get(), buffer1->size(), &frames));
+  EXPECT_TRUE(frames.empty());
+  EXPECT_TRUE(buffer1->HasOneRef());
+
+  EXPECT_TRUE(parser.DecodeInPlace(buffer2.get(), buffer2->size(), &frames));
+  ASSERT_EQ(1u, frames.size());
+  ASSERT_TRUE(frames[0]->header);
+  EXPECT_TRUE(frames[0]->header->masked);
+  EXPECT_TRUE(frames[0]->final_chunk);
+  ASSERT_EQ(static_cast<int>(kHelloLength), frames[0]->data->size());
+  EXPECT_EQ(buffer2->data() + 6 - kSplit, frames[0]->data->data());
+  EXPECT_TRUE(
+      std::equal(kHello, kHello + kHelloLength, frames[0]->data->data()));
+}
+
 TEST(WebSocketFrameParserTest, DecodeManyFrames) {
   struct Input {
     const char* frame;
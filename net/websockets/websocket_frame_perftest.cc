@@ -5,10 +5,15 @@
 #include "net/websockets/websocket_frame.h"
 
 #include <algorithm>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/test/perf_time_logger.h"
+#include "net/base/io_buffer.h"
+#include "net/websockets/websocket_frame_parser.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -25,9 +30,22 @@ static_assert(arraysize(kMaskingKey) ==
 
 class WebSocketFrameTestMaskBenchmark : public ::testing::Test {
  protected:
+  // Runs the benchmark with and without AVX2. Without AVX2 support in the
+  // CPU, both runs use the baseline implementation.
   void Benchmark(const char* const name,
                  const char* const payload,
                  size_t size) {
+    bool old_avx2_enabled = SetWebSocketMaskingAVX2EnabledForTesting(false);
+    BenchmarkOnce(name, payload, size);
+    SetWebSocketMaskingAVX2EnabledForTesting(true);
+    BenchmarkOnce((std::string(name) + "_avx2").c_str(), payload, size);
+    SetWebSocketMaskingAVX2EnabledForTesting(old_avx2_enabled);
+  }
+
+ private:
+  void BenchmarkOnce(const char* const name,
+                     const char* const payload,
+                     size_t size) {
     std::vector<char> scratch(payload, payload + size);
     WebSocketMaskingKey masking_key;
     std::copy(kMaskingKey,
@@ -61,6 +79,57 @@ TEST_F(WebSocketFrameTestMaskBenchmark, Benchmark31BytePayload) {
   Benchmark("Frame_mask_31_payload", &payload.front(), payload.size());
 }
 
+const int kParseIterations = 2000;
+const int kReadSize = 32 * 1024;
+const int kParsePayloadSize = 4 * 1024;
+
+class WebSocketFrameParserBenchmark : public ::testing::Test {
+ protected:
+  // Parses kParseIterations reads, each of them full of unmasked binary
+  // frames, as received from a server.
+  void Benchmark(const char* const name, bool in_place) {
+    WebSocketFrameHeader header(WebSocketFrameHeader::kOpCodeBinary);
+    header.final = true;
+    header.payload_length = kParsePayloadSize;
+    std::vector<char> frame(GetWebSocketFrameHeaderSize(header) +
+                            kParsePayloadSize, 'a');
+    ASSERT_LT(0, WriteWebSocketFrameHeader(header, nullptr, &frame.front(),
+                                           frame.size()));
+    std::vector<char> input;
+    while (input.size() + frame.size() <= static_cast<size_t>(kReadSize))
+      input.insert(input.end(), frame.begin(), frame.end());
+
+    WebSocketFrameParser parser;
+    std::vector<std::unique_ptr<WebSocketFrameChunk>> frame_chunks;
+    scoped_refptr<IOBuffer> read_buffer = new IOBuffer(kReadSize);
+    base::PerfTimeLogger timer(name);
+    for (int x = 0; x < kParseIterations; ++x) {
+      // Like WebSocketBasicStream, which reads into the same buffer unless
+      // frames still refer to it.
+      if (!read_buffer->HasOneRef())
+        read_buffer = new IOBuffer(kReadSize);
+      memcpy(read_buffer->data(), &input.front(), input.size());
+      if (in_place) {
+        ASSERT_TRUE(parser.DecodeInPlace(read_buffer.get(), input.size(),
+                                         &frame_chunks));
+      } else {
+        ASSERT_TRUE(
+            parser.Decode(read_buffer->data(), input.size(), &frame_chunks));
+      }
+      frame_chunks.clear();
+    }
+    timer.Done();
+  }
+};
+
+TEST_F(WebSocketFrameParserBenchmark, BenchmarkDecode) {
+  Benchmark("Frame_parse_copy", false);
+}
+
+TEST_F(WebSocketFrameParserBenchmark, BenchmarkDecodeInPlace) {
+  Benchmark("Frame_parse_in_place", true);
+}
+
 }  // namespace
 
 }  // namespace net
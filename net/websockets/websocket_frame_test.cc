@@ -266,7 +266,10 @@ TEST(WebSocketFrameTest, MaskPayload) {
 // maximum vector size we want to test again. This might need reconsidering if
 // MaskWebSocketFramePayload() is ever optimised for a dedicated vector
 // architecture.
-TEST(WebSocketFrameTest, MaskPayloadAlignment) {
+//
+// Chunks go up to the whole scratch buffer, so that the AVX2 implementation,
+// which needs more than two vectors of data, is covered too.
+void TestMaskPayloadAlignment() {
   // This reflects what might be implemented in the future, rather than
   // the current implementation. FMA3 and FMA4 support 256-bit vector ops.
   static const size_t kMaxVectorSizeInBits = 256;
@@ -307,7 +310,7 @@ TEST(WebSocketFrameTest, MaskPayloadAlignment) {
       char* const aligned_scratch = scratch.get() + alignment;
       const size_t aligned_len = std::min(kScratchBufferSize - alignment,
                                           kTestInputSize - frame_offset);
-      for (size_t chunk_size = 1; chunk_size < kMaxVectorSize; ++chunk_size) {
+      for (size_t chunk_size = 1; chunk_size <= aligned_len; ++chunk_size) {
         memcpy(aligned_scratch, kTestInput + frame_offset, aligned_len);
         for (size_t chunk_start = 0; chunk_start < aligned_len;
              chunk_start += chunk_size) {
@@ -330,6 +333,19 @@ TEST(WebSocketFrameTest, MaskPayloadAlignment) {
   }
 }
 
+TEST(WebSocketFrameTest, MaskPayloadAlignment) {
+  bool old_avx2_enabled = SetWebSocketMaskingAVX2EnabledForTesting(false);
+  TestMaskPayloadAlignment();
+  SetWebSocketMaskingAVX2EnabledForTesting(old_avx2_enabled);
+}
+
+// On CPUs without AVX2, this covers the baseline implementation again.
+TEST(WebSocketFrameTest, MaskPayloadAlignmentAVX2) {
+  bool old_avx2_enabled = SetWebSocketMaskingAVX2EnabledForTesting(true);
+  TestMaskPayloadAlignment();
+  SetWebSocketMaskingAVX2EnabledForTesting(old_avx2_enabled);
+}
+
 // "IsKnownDataOpCode" is currently implemented in an "obviously correct"
 // manner, but we test is anyway in case it changes to a more complex
 // implementation in future.
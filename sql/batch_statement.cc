@@ -0,0 +1,94 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sql/batch_statement.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "sql/transaction.h"
+
+namespace sql {
+
+BatchStatement::BatchStatement(scoped_refptr<Connection::StatementRef> ref)
+    : connection_(ref->connection()), statement_(ref), num_rows_(0) {}
+
+BatchStatement::~BatchStatement() {}
+
+void BatchStatement::BindInt64Column(int col,
+                                     const std::vector<int64_t>& values) {
+  AddColumn(col, COLUMN_INT64, &values, values.size());
+}
+
+void BatchStatement::BindDoubleColumn(int col,
+                                      const std::vector<double>& values) {
+  AddColumn(col, COLUMN_DOUBLE, &values, values.size());
+}
+
+void BatchStatement::BindStringColumn(int col,
+                                      const std::vector<std::string>& values) {
+  AddColumn(col, COLUMN_STRING, &values, values.size());
+}
+
+bool BatchStatement::Run() {
+  if (!is_valid())
+    return false;
+
+  Transaction transaction(connection_);
+  const bool succeeded =
+      transaction.Begin() && RunRows() && transaction.Commit();
+
+  // The bound strings point into the columns, which the caller may free once
+  // this returns.
+  statement_.Reset(true);
+  return succeeded;
+}
+
+void BatchStatement::AddColumn(int col,
+                               ColumnType type,
+                               const void* values,
+                               size_t size) {
+  DCHECK(columns_.empty() || size == num_rows_)
+      << "All columns must have the same number of rows.";
+  num_rows_ = columns_.empty() ? size : std::min(num_rows_, size);
+  columns_.push_back({col, type, values});
+}
+
+bool BatchStatement::BindRow(size_t row) {
+  for (const Column& column : columns_) {
+    bool bound = false;
+    switch (column.type) {
+      case COLUMN_INT64:
+        bound = statement_.BindInt64(
+            column.col,
+            (*static_cast<const std::vector<int64_t>*>(column.values))[row]);
+        break;
+      case COLUMN_DOUBLE:
+        bound = statement_.BindDouble(
+            column.col,
+            (*static_cast<const std::vector<double>*>(column.values))[row]);
+        break;
+      case COLUMN_STRING:
+        bound = statement_.BindStringNoCopy(
+            column.col,
+            (*static_cast<const std::vector<std::string>*>(
+                column.values))[row]);
+        break;
+    }
+    if (!bound)
+      return false;
+  }
+  return true;
+}
+
+bool BatchStatement::RunRows() {
+  for (size_t row = 0; row < num_rows_; ++row) {
+    if (!BindRow(row) || !statement_.Run())
+      return false;
+    statement_.Reset(false);
+  }
+  return true;
+}
+
+}  // namespace sql
@@ -0,0 +1,92 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SQL_BATCH_STATEMENT_H_
+#define SQL_BATCH_STATEMENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "sql/connection.h"
+#include "sql/sql_export.h"
+#include "sql/statement.h"
+
+namespace sql {
+
+// Runs a statement once per row of columnar data, all inside one transaction.
+// This is meant for bulk imports, which would otherwise pay for a transaction,
+// or at least for copying every bound string, per row.
+//
+// Each column holds the values of one parameter, one value per row. Strings
+// are bound without being copied, so the columns must stay valid and
+// unchanged until Run() returns.
+//
+// Normal usage:
+//   std::vector<int64_t> ids = ...;
+//   std::vector<std::string> urls = ...;
+//   sql::BatchStatement batch(db_.GetCachedStatement(
+//       SQL_FROM_HERE, "INSERT INTO urls (id, url) VALUES (?, ?)"));
+//   batch.BindInt64Column(0, ids);
+//   batch.BindStringColumn(1, urls);
+//   if (!batch.Run())
+//     return false;
+class SQL_EXPORT BatchStatement {
+ public:
+  explicit BatchStatement(scoped_refptr<Connection::StatementRef> ref);
+  ~BatchStatement();
+
+  // Returns true if the statement can be executed.
+  bool is_valid() const { return statement_.is_valid(); }
+
+  // These take a 0-based parameter index. Every column must have the same
+  // number of rows, and every parameter of the statement must be bound.
+  void BindInt64Column(int col, const std::vector<int64_t>& values);
+  void BindDoubleColumn(int col, const std::vector<double>& values);
+  void BindStringColumn(int col, const std::vector<std::string>& values);
+
+  // Runs the statement for every row in a transaction, which is committed if
+  // every row succeeds and rolled back otherwise. Returns true if the rows
+  // were committed. If this is called within another transaction, the rows
+  // are only committed along with it. The columns may be freed afterwards.
+  bool Run();
+
+ private:
+  enum ColumnType {
+    COLUMN_INT64,
+    COLUMN_DOUBLE,
+    COLUMN_STRING,
+  };
+
+  struct Column {
+    int col;
+    ColumnType type;
+    const void* values;  // Points to a std::vector of |type|.
+  };
+
+  void AddColumn(int col, ColumnType type, const void* values, size_t size);
+
+  // Binds the values of |row|.
+  bool BindRow(size_t row);
+
+  // Binds and runs every row, stopping at the first failure.
+  bool RunRows();
+
+  // The connection that owns the statement, or null if it is invalid.
+  Connection* connection_;
+
+  Statement statement_;
+  std::vector<Column> columns_;
+  size_t num_rows_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchStatement);
+};
+
+}  // namespace sql
+
+#endif  // SQL_BATCH_STATEMENT_H_
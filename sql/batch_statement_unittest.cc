@@ -0,0 +1,161 @@
+// Copyright 2016 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sql/batch_statement.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/format_macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "sql/connection.h"
+#include "sql/correct_sql_test_base.h"
+#include "sql/statement.h"
+#include "sql/test/scoped_error_expecter.h"
+#include "sql/transaction.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/sqlite/sqlite3.h"
+
+namespace {
+
+using SQLBatchStatementTest = sql::SQLTestBase;
+
+const char kCreateSql[] =
+    "CREATE TABLE urls (id INTEGER PRIMARY KEY, score REAL, url TEXT)";
+const char kInsertSql[] = "INSERT INTO urls (id, score, url) VALUES (?, ?, ?)";
+
+// Fills the columns with |num_rows| rows.
+void MakeRows(size_t num_rows,
+              std::vector<int64_t>* ids,
+              std::vector<double>* scores,
+              std::vector<std::string>* urls) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    ids->push_back(i + 1);
+    scores->push_back(i / 2.0);
+    urls->push_back(
+        base::StringPrintf("https://www.example.com/page/%" PRIuS, i));
+  }
+}
+
+}  // namespace
+
+TEST_F(SQLBatchStatementTest, Run) {
+  ASSERT_TRUE(db().Execute(kCreateSql));
+
+  std::vector<int64_t> ids;
+  std::vector<double> scores;
+  std::vector<std::string> urls;
+  MakeRows(3, &ids, &scores, &urls);
+  sql::BatchStatement batch(db().GetUniqueStatement(kInsertSql));
+  ASSERT_TRUE(batch.is_valid());
+  batch.BindInt64Column(0, ids);
+  batch.BindDoubleColumn(1, scores);
+  batch.BindStringColumn(2, urls);
+  ASSERT_TRUE(batch.Run());
+  EXPECT_FALSE(db().transaction_nesting());
+
+  sql::Statement s(
+      db().GetUniqueStatement("SELECT id, score, url FROM urls ORDER BY id"));
+  for (size_t i = 0; i < ids.size(); ++i) {
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(ids[i], s.ColumnInt64(0));
+    EXPECT_EQ(scores[i], s.ColumnDouble(1));
+    EXPECT_EQ(urls[i], s.ColumnString(2));
+  }
+  EXPECT_FALSE(s.Step());
+}
+
+// The bound strings don't outlive Run(), so a cached statement doesn't keep
+// pointers into freed columns.
+TEST_F(SQLBatchStatementTest, ClearsBindings) {
+  const sql::StatementID id(SQL_FROM_HERE);
+  {
+    std::vector<int64_t> ids;
+    std::vector<double> scores;
+    std::vector<std::string> urls;
+    MakeRows(1, &ids, &scores, &urls);
+    sql::BatchStatement batch(db().GetCachedStatement(id, "SELECT ?, ?, ?"));
+    batch.BindInt64Column(0, ids);
+    batch.BindDoubleColumn(1, scores);
+    batch.BindStringColumn(2, urls);
+    ASSERT_TRUE(batch.Run());
+  }
+
+  sql::Statement s(db().GetCachedStatement(id, "SELECT ?, ?, ?"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(sql::COLUMN_TYPE_NULL, s.ColumnType(2));
+}
+
+// A failing row rolls back the rows before it.
+TEST_F(SQLBatchStatementTest, RollsBackOnFailure) {
+  ASSERT_TRUE(db().Execute(kCreateSql));
+
+  std::vector<int64_t> ids;
+  std::vector<double> scores;
+  std::vector<std::string> urls;
+  MakeRows(3, &ids, &scores, &urls);
+  ids[2] = ids[0];
+  sql::BatchStatement batch(db().GetUniqueStatement(kInsertSql));
+  batch.BindInt64Column(0, ids);
+  batch.BindDoubleColumn(1, scores);
+  batch.BindStringColumn(2, urls);
+  {
+    sql::test::ScopedErrorExpecter expecter;
+    expecter.ExpectError(SQLITE_CONSTRAINT);
+    EXPECT_FALSE(batch.Run());
+    ASSERT_TRUE(expecter.SawExpectedErrors());
+  }
+  EXPECT_FALSE(db().transaction_nesting());
+
+  sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM urls"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(0, s.ColumnInt(0));
+}
+
+// Compares importing a million rows one statement at a time against a
+// BatchStatement. This takes a few seconds, so it only runs when asked to,
+// with --gtest_also_run_disabled_tests.
+TEST_F(SQLBatchStatementTest, DISABLED_ImportOneMillionRows) {
+  const size_t kNumRows = 1000000;
+  std::vector<int64_t> ids;
+  std::vector<double> scores;
+  std::vector<std::string> urls;
+  MakeRows(kNumRows, &ids, &scores, &urls);
+
+  ASSERT_TRUE(db().Execute(kCreateSql));
+  {
+    base::PerfTimeLogger timer("SQL_import_1M_rows_statement");
+    sql::Transaction transaction(&db());
+    ASSERT_TRUE(transaction.Begin());
+    for (size_t i = 0; i < kNumRows; ++i) {
+      sql::Statement s(db().GetCachedStatement(SQL_FROM_HERE, kInsertSql));
+      s.BindInt64(0, ids[i]);
+      s.BindDouble(1, scores[i]);
+      s.BindString(2, urls[i]);
+      ASSERT_TRUE(s.Run());
+    }
+    ASSERT_TRUE(transaction.Commit());
+    timer.Done();
+  }
+
+  ASSERT_TRUE(db().Execute("DELETE FROM urls"));
+  {
+    base::PerfTimeLogger timer("SQL_import_1M_rows_batch");
+    sql::BatchStatement batch(
+        db().GetCachedStatement(SQL_FROM_HERE, kInsertSql));
+    batch.BindInt64Column(0, ids);
+    batch.BindDoubleColumn(1, scores);
+    batch.BindStringColumn(2, urls);
+    ASSERT_TRUE(batch.Run());
+    timer.Done();
+  }
+
+  sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM urls"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(static_cast<int64_t>(kNumRows), s.ColumnInt64(0));
+}
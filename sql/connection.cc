@@ -47,6 +47,10 @@ namespace {
 // TODO(shess): Better story on this.  http://crbug.com/56559
 const int kBusyTimeoutSeconds = 1;
 
+// Enough for every statement of most databases, while bounding the memory
+// held by the few that build statements on the fly.
+const size_t kDefaultStatementCacheSize = 256;
+
 class ScopedBusyTimeout {
  public:
   explicit ScopedBusyTimeout(sqlite3* db)
@@ -330,6 +334,7 @@ Connection::Connection()
       cache_size_(0),
       exclusive_locking_(false),
       restrict_to_user_(false),
+      statement_cache_(kDefaultStatementCacheSize),
       transaction_nesting_(0),
       needs_rollback_(false),
       in_memory_(false),
@@ -349,6 +354,13 @@ Connection::~Connection() {
   Close();
 }
 
+void Connection::set_statement_cache_size(size_t statement_cache_size) {
+  DCHECK(!db_);
+  DCHECK_GT(statement_cache_size, 0u);
+  CachedStatementMap statement_cache(statement_cache_size);
+  statement_cache_.Swap(statement_cache);
+}
+
 void Connection::RecordEvent(Events event, size_t count) {
   for (size_t i = 0; i < count; ++i) {
     UMA_HISTOGRAM_ENUMERATION("Sqlite.Stats", event, EVENT_MAX_VALUE);
@@ -441,7 +453,7 @@ void Connection::CloseInternal(bool forced) {
   // sqlite3_close() needs all prepared statements to be finalized.
 
   // Release cached statements.
-  statement_cache_.clear();
+  statement_cache_.Clear();
 
   // With cached statements released, in-use statements will remain.
   // Closing the database while statements are in use is an API
@@ -1424,13 +1436,13 @@ bool Connection::ExecuteWithTimeout(const char* sql, base::TimeDelta timeout) {
 }
 
 bool Connection::HasCachedStatement(const StatementID& id) const {
-  return statement_cache_.find(id) != statement_cache_.end();
+  return statement_cache_.Peek(id) != statement_cache_.end();
 }
 
 scoped_refptr<Connection::StatementRef> Connection::GetCachedStatement(
     const StatementID& id,
     const char* sql) {
-  CachedStatementMap::iterator i = statement_cache_.find(id);
+  CachedStatementMap::iterator i = statement_cache_.Get(id);
   if (i != statement_cache_.end()) {
     // Statement is in the cache. It should still be active (we're the only
     // one invalidating cached statements, and we'll remove it from the cache
@@ -1438,12 +1450,16 @@ scoped_refptr<Connection::StatementRef> Connection::GetCachedStatement(
     // case it still has some stuff bound.
     DCHECK(i->second->is_valid());
     sqlite3_reset(i->second->stmt());
+    if (memory_dump_provider_)
+      memory_dump_provider_->RecordStatementCacheHit();
     return i->second;
   }
 
+  if (memory_dump_provider_)
+    memory_dump_provider_->RecordStatementCacheMiss();
   scoped_refptr<StatementRef> statement = GetUniqueStatement(sql);
   if (statement->is_valid())
-    statement_cache_[id] = statement;  // Only cache valid statements.
+    statement_cache_.Put(id, statement);  // Only cache valid statements.
   return statement;
 }
 
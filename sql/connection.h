@@ -7,7 +7,6 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -15,6 +14,7 @@
 
 #include "base/callback.h"
 #include "base/compiler_specific.h"
+#include "base/containers/mru_cache.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -32,6 +32,7 @@ class HistogramBase;
 
 namespace sql {
 
+class BatchStatement;
 class ConnectionMemoryDumpProvider;
 class Recovery;
 class Statement;
@@ -153,6 +154,11 @@ class SQL_EXPORT Connection {
   // Call to opt out of memory-mapped file I/O.
   void set_mmap_disabled() { mmap_disabled_ = true; }
 
+  // Sets the number of statements GetCachedStatement() keeps prepared. Past
+  // that, the least recently used statement is dropped from the cache, and is
+  // finalized once it's no longer in use. This must be called before Open().
+  void set_statement_cache_size(size_t statement_cache_size);
+
   // Set an error-handling callback.  On errors, the error number (and
   // statement, if available) will be passed to the callback.
   //
@@ -496,6 +502,7 @@ class SQL_EXPORT Connection {
 
   // Statement accesses StatementRef which we don't want to expose to everybody
   // (they should go through Statement).
+  friend class BatchStatement;
   friend class Statement;
 
   friend class test::ScopedCommitHook;
@@ -729,9 +736,9 @@ class SQL_EXPORT Connection {
   bool exclusive_locking_;
   bool restrict_to_user_;
 
-  // All cached statements. Keeping a reference to these statements means that
-  // they'll remain active.
-  typedef std::map<StatementID, scoped_refptr<StatementRef> >
+  // The most recently used cached statements. Keeping a reference to these
+  // statements means that they'll remain active.
+  typedef base::MRUCache<StatementID, scoped_refptr<StatementRef>>
       CachedStatementMap;
   CachedStatementMap statement_cache_;
 
@@ -15,7 +15,10 @@ namespace sql {
 ConnectionMemoryDumpProvider::ConnectionMemoryDumpProvider(
     sqlite3* db,
     const std::string& name)
-    : db_(db), connection_name_(name) {}
+    : db_(db),
+      connection_name_(name),
+      statement_cache_hits_(0),
+      statement_cache_misses_(0) {}
 
 ConnectionMemoryDumpProvider::~ConnectionMemoryDumpProvider() {}
 
@@ -24,6 +27,18 @@ void ConnectionMemoryDumpProvider::ResetDatabase() {
   db_ = nullptr;
 }
 
+void ConnectionMemoryDumpProvider::RecordStatementCacheHit() {
+  base::subtle::NoBarrier_Store(
+      &statement_cache_hits_,
+      base::subtle::NoBarrier_Load(&statement_cache_hits_) + 1);
+}
+
+void ConnectionMemoryDumpProvider::RecordStatementCacheMiss() {
+  base::subtle::NoBarrier_Store(
+      &statement_cache_misses_,
+      base::subtle::NoBarrier_Load(&statement_cache_misses_) + 1);
+}
+
 bool ConnectionMemoryDumpProvider::OnMemoryDump(
     const base::trace_event::MemoryDumpArgs& args,
     base::trace_event::ProcessMemoryDump* pmd) {
@@ -71,6 +86,12 @@ bool ConnectionMemoryDumpProvider::OnMemoryDump(
   dump->AddScalar("statement_size",
                   base::trace_event::MemoryAllocatorDump::kUnitsBytes,
                   statement_size);
+  dump->AddScalar("statement_cache_hits",
+                  base::trace_event::MemoryAllocatorDump::kUnitsObjects,
+                  base::subtle::NoBarrier_Load(&statement_cache_hits_));
+  dump->AddScalar("statement_cache_misses",
+                  base::trace_event::MemoryAllocatorDump::kUnitsObjects,
+                  base::subtle::NoBarrier_Load(&statement_cache_misses_));
   return true;
 }
 
@@ -7,6 +7,7 @@
 
 #include <string>
 
+#include "base/atomicops.h"
 #include "base/macros.h"
 #include "base/synchronization/lock.h"
 #include "base/trace_event/memory_dump_provider.h"
@@ -23,6 +24,11 @@ class ConnectionMemoryDumpProvider
 
   void ResetDatabase();
 
+  // Count Connection::GetCachedStatement() calls that found the statement in
+  // the cache, and those that had to prepare it.
+  void RecordStatementCacheHit();
+  void RecordStatementCacheMiss();
+
   // base::trace_event::MemoryDumpProvider implementation.
   bool OnMemoryDump(
       const base::trace_event::MemoryDumpArgs& args,
@@ -33,6 +39,11 @@ class ConnectionMemoryDumpProvider
   base::Lock lock_;
   std::string connection_name_;
 
+  // Only written on the connection's thread, and read without |lock_| when
+  // dumping.
+  base::subtle::AtomicWord statement_cache_hits_;
+  base::subtle::AtomicWord statement_cache_misses_;
+
   DISALLOW_COPY_AND_ASSIGN(ConnectionMemoryDumpProvider);
 };
 
@@ -311,6 +311,47 @@ TEST_F(SQLConnectionTest, CachedStatement) {
   EXPECT_FALSE(db().HasCachedStatement(SQL_FROM_HERE));
 }
 
+// The statement cache only keeps the most recently used statements.
+TEST_F(SQLConnectionTest, CachedStatementEviction) {
+  db().Close();
+  db().set_statement_cache_size(2);
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo(a, b) VALUES (12, 13)"));
+
+  sql::StatementID id1("foo", 1);
+  sql::StatementID id2("foo", 2);
+  sql::StatementID id3("foo", 3);
+  {
+    sql::Statement s(db().GetCachedStatement(id1, "SELECT a FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+  }
+  {
+    sql::Statement s(db().GetCachedStatement(id2, "SELECT b FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+  }
+
+  // Using |id1| again makes |id2| the least recently used statement.
+  sql::Statement s1(db().GetCachedStatement(id1, "SELECT a FROM foo"));
+  ASSERT_TRUE(s1.is_valid());
+  {
+    sql::Statement s(db().GetCachedStatement(id3, "SELECT a, b FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+  }
+  EXPECT_TRUE(db().HasCachedStatement(id1));
+  EXPECT_FALSE(db().HasCachedStatement(id2));
+  EXPECT_TRUE(db().HasCachedStatement(id3));
+
+  // A statement that's evicted while in use keeps working.
+  {
+    sql::Statement s(db().GetCachedStatement(id2, "SELECT b FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+    EXPECT_FALSE(db().HasCachedStatement(id1));
+    ASSERT_TRUE(s1.Step());
+    EXPECT_EQ(12, s1.ColumnInt(0));
+  }
+}
+
 TEST_F(SQLConnectionTest, IsSQLValidTest) {
   ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
   ASSERT_TRUE(db().IsSQLValid("SELECT a FROM foo"));
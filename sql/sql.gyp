@@ -20,6 +20,8 @@
       ],
       'defines': [ 'SQL_IMPLEMENTATION' ],
       'sources': [
+        'batch_statement.cc',
+        'batch_statement.h',
         'connection.cc',
         'connection.h',
         'connection_memory_dump_provider.cc',
@@ -90,6 +92,7 @@
         '../third_party/sqlite/sqlite.gyp:sqlite',
       ],
       'sources': [
+        'batch_statement_unittest.cc',
         'connection_unittest.cc',
         'meta_table_unittest.cc',
         'recovery_unittest.cc',
@@ -199,6 +199,18 @@ bool Statement::BindBlob(int col, const void* val, int val_len) {
       sqlite3_bind_blob(ref_->stmt(), col + 1, val, val_len, SQLITE_TRANSIENT));
 }
 
+bool Statement::BindStringNoCopy(int col, const base::StringPiece& val) {
+  DCHECK(!stepped_);
+  if (!is_valid())
+    return false;
+
+  return CheckOk(sqlite3_bind_text(ref_->stmt(),
+                                   col + 1,
+                                   val.data(),
+                                   val.size(),
+                                   SQLITE_STATIC));
+}
+
 int Statement::ColumnCount() const {
   if (!is_valid())
     return 0;
@@ -12,6 +12,7 @@
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/strings/string16.h"
+#include "base/strings/string_piece.h"
 #include "sql/connection.h"
 #include "sql/sql_export.h"
 
@@ -112,6 +113,11 @@ class SQL_EXPORT Statement {
   bool BindString16(int col, const base::string16& value);
   bool BindBlob(int col, const void* value, int value_len);
 
+  // Like BindString(), but |val| isn't copied, so its data must stay valid and
+  // unchanged until the parameter is bound again or the statement is reset
+  // with |clear_bound_vars|.
+  bool BindStringNoCopy(int col, const base::StringPiece& val);
+
   // Retrieving ----------------------------------------------------------------
 
   // Returns the number of output columns in the result.